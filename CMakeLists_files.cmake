@@ -70,6 +70,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/blackoil/blackoilbrinemodules.hh
              opm/models/blackoil/blackoilfoammodules.hh
              opm/models/blackoil/blackoilindices.hh
+             opm/models/blackoil/blackoiljacobiansparsity.hh
              opm/models/blackoil/blackoillocalresidual.hh
              opm/models/blackoil/blackoilnewtonmethod.hh
              opm/models/blackoil/blackoilonephaseindices.hh
@@ -78,6 +79,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/blackoil/blackoilproperties.hh
              opm/models/blackoil/blackoilprimaryvariables.hh
              opm/models/blackoil/blackoilproblem.hh
+             opm/models/blackoil/blackoilpvttables.hh
              opm/models/blackoil/blackoilenergymodules.hh
              opm/models/blackoil/blackoiltwophaseindices.hh
              opm/models/blackoil/blackoilpolymermodules.hh
@@ -100,6 +102,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretefracture/discretefracturemodel.hh
              opm/models/discretefracture/discretefractureintensivequantities.hh
              opm/models/discretefracture/discretefracturelocalresidual.hh
+             opm/models/discretefracture/discretefracturenewtonmethod.hh
              opm/models/discretization/vcfv/vcfvbaseoutputmodule.hh
              opm/models/discretization/vcfv/vcfvdiscretization.hh
              opm/models/discretization/vcfv/p1fegradientcalculator.hh
@@ -108,7 +111,15 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/vcfv/vcfvstencil.hh
              opm/models/discretization/common/fvbasenewtonmethod.hh
              opm/models/discretization/common/fvbasenewtonconvergencewriter.hh
+             opm/models/discretization/common/fvbasenewtonconvergencetracewriter.hh
+             opm/models/discretization/common/fvbasetimestepcontroller.hh
              opm/models/discretization/common/fvbaseintensivequantities.hh
+             opm/models/discretization/common/fvbaseintensivequantityarrays.hh
+             opm/models/discretization/common/fvbasevalueonlyintensivequantitycache.hh
+             opm/models/discretization/common/fvbaseboundarycache.hh
+             opm/models/discretization/common/fvbaseboundaryfacelist.hh
+             opm/models/discretization/common/fvbasesourcecache.hh
+             opm/models/discretization/common/fvbasedofparameterarray.hh
              opm/models/discretization/common/fvbaseconstraintscontext.hh
              opm/models/discretization/common/baseauxiliarymodule.hh
              opm/models/discretization/common/fvbaseelementcontext.hh
@@ -120,6 +131,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbaseproperties.hh
              opm/models/discretization/common/fvbaseextensivequantities.hh
              opm/models/discretization/common/fvbaselinearizer.hh
+             opm/models/discretization/common/fvbaseconstraintsmap.hh
              opm/models/discretization/common/restrictprolong.hh
              opm/models/discretization/common/fvbasediscretization.hh
              opm/models/discretization/common/fvbasegradientcalculator.hh
@@ -128,6 +140,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/linearizationtype.hh
              opm/models/discretization/ecfv/ecfvgridcommhandlefactory.hh
              opm/models/discretization/ecfv/ecfvstencil.hh
+             opm/models/discretization/ecfv/ecfvstructuredlayout.hh
              opm/models/discretization/ecfv/ecfvbaseoutputmodule.hh
              opm/models/discretization/ecfv/ecfvdiscretization.hh
              opm/models/discretization/ecfv/ecfvproperties.hh
@@ -143,6 +156,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/immiscible/immisciblelocalresidual.hh
              opm/models/immiscible/immiscibleproperties.hh
              opm/models/immiscible/immisciblemodel.hh
+             opm/models/immiscible/immisciblesequentialnewtonmethod.hh
              opm/models/immiscible/immiscibleboundaryratevector.hh
              opm/models/immiscible/immiscibleratevector.hh
              opm/models/immiscible/immiscibleindices.hh
@@ -150,13 +164,22 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/immiscible/immiscibleprimaryvariables.hh
              opm/models/immiscible/immiscibleintensivequantities.hh
              opm/models/io/vtktensorfunction.hh
+             opm/models/io/artreader.hh
+             opm/models/io/artvanguard.hh
              opm/models/io/dgfvanguard.hh
+             opm/models/io/gridcache.hh
+             opm/models/io/vtkcornerindextable.hh
              opm/models/io/vtkscalarfunction.hh
              opm/models/io/vtkenergymodule.hh
              opm/models/io/restart.hh
              opm/models/io/cubegridvanguard.hh
+             opm/models/io/distributedstructuredgrid.hh
              opm/models/io/baseoutputwriter.hh
              opm/models/io/vtkmultiwriter.hh
+             opm/models/io/xdmfwriter.hh
+             opm/models/io/sampledoutputwriter.hh
+             opm/models/io/insituoutputwriter.hh
+             opm/models/io/timeseriesoutput.hh
              opm/models/io/vtkmultiphasemodule.hh
              opm/models/io/vtkdiscretefracturemodule.hh
              opm/models/io/vtkdiffusionmodule.hh
@@ -186,11 +209,17 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/nonlinear/nullconvergencewriter.hh
              opm/models/nonlinear/newtonmethod.hh
              opm/models/parallel/mpiutil.hh
+             opm/models/parallel/nonblockingsum.hh
              opm/models/parallel/tasklets.hh
+             opm/models/parallel/communicationthread.hh
+             opm/models/parallel/mpmcqueue.hh
              opm/models/parallel/threadmanager.hh
+             opm/models/parallel/threadphases.hh
              opm/models/parallel/gridcommhandles.hh
              opm/models/parallel/mpibuffer.hh
              opm/models/parallel/threadedentityiterator.hh
+             opm/models/parallel/chunkedentityiterator.hh
+             opm/models/parallel/blockvectorkernels.hh
              opm/models/pvs/pvsboundaryratevector.hh
              opm/models/pvs/pvsratevector.hh
              opm/models/pvs/pvsindices.hh
@@ -219,9 +248,21 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/utils/prefetch.hh
              opm/models/utils/parametersystem.hh
              opm/models/utils/simulator.hh
+             opm/models/utils/multilevelmontecarlo.hh
+             opm/models/utils/pararealdriver.hh
              opm/models/utils/quadraturegeometries.hh
              opm/models/utils/alignedallocator.hh
+             opm/models/utils/compressedblockvector.hh
+             opm/models/utils/deferredconstructionallocator.hh
+             opm/models/utils/segmentcachedeval.hh
              opm/models/utils/timer.hh
+             opm/models/utils/lightweighttimer.hh
+             opm/models/utils/perfcounters.hh
+             opm/models/utils/instrumentation.hh
+             opm/models/utils/memoryaccounting.hh
+             opm/models/utils/mappedarray.hh
+             opm/models/utils/eventtracer.hh
+             opm/models/utils/hilbertcurve.hh
              opm/models/utils/signum.hh
              opm/models/utils/genericguard.hh
              opm/models/utils/basicproperties.hh
@@ -232,20 +273,34 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/linearsolverreport.hh
              opm/simulators/linalg/istlsparsematrixadapter.hh
              opm/simulators/linalg/istlpreconditionerwrappers.hh
+             opm/simulators/linalg/recyclinggmressolver.hh
              opm/simulators/linalg/residreductioncriterion.hh
              opm/simulators/linalg/overlappingbcrsmatrix.hh
              opm/simulators/linalg/blacklist.hh
              opm/simulators/linalg/parallelbasebackend.hh
              opm/simulators/linalg/overlappingblockvector.hh
              opm/simulators/linalg/parallelbicgstabbackend.hh
+             opm/simulators/linalg/parallelgmresbackend.hh
              opm/simulators/linalg/nullborderlistmanager.hh
              opm/simulators/linalg/overlappingoperator.hh
+             opm/simulators/linalg/auxiliaryschurcomplement.hh
              opm/simulators/linalg/elementborderlistfromgrid.hh
              opm/simulators/linalg/combinedcriterion.hh
+             opm/simulators/linalg/cprpreconditioner.hh
+             opm/simulators/linalg/geometricmultigridpreconditioner.hh
+             opm/simulators/linalg/fractureblockpreconditioner.hh
              opm/simulators/linalg/bicgstabsolver.hh
              opm/simulators/linalg/globalindices.hh
+             opm/simulators/linalg/gmressolver.hh
              opm/simulators/linalg/superlubackend.hh
+             opm/simulators/linalg/scalarcsrmatrix.hh
+             opm/simulators/linalg/subdomaincoarsespace.hh
+             opm/simulators/linalg/umfpackbackend.hh
+             opm/simulators/linalg/offloadbackend.hh
              opm/simulators/linalg/matrixblock.hh
+             opm/simulators/linalg/mixedprecisionpreconditioner.hh
+             opm/simulators/linalg/threadedilu0preconditioner.hh
+             opm/simulators/linalg/flexiblegmressolver.hh
              opm/simulators/linalg/istlsolverwrappers.hh
              opm/simulators/linalg/overlaptypes.hh
              opm/simulators/linalg/overlappingpreconditioner.hh
@@ -0,0 +1,129 @@
+#! /bin/bash
+#
+# Compares the results of the benchmarks with the ones of a baseline and reports the
+# metrics which regressed. Both files are the CSV files written by runbenchmark.sh; if
+# a benchmark was run repeatedly, the median of the repetitions is compared.
+#
+# A metric of a benchmark is considered to have regressed if its median exceeds the
+# median of the baseline by more than the relative tolerance and by more than three
+# times the scaled median absolute deviation (MAD) of the baseline, i.e., by more than
+# the noise of the baseline measurements. The exit code is 1 if any metric regressed.
+#
+# Usage:
+#
+# comparebenchmarks.sh BASELINE_FILE RESULT_FILE [TIME_TOLERANCE [MEMORY_TOLERANCE]]
+#
+usage() {
+    echo "Usage:"
+    echo
+    echo "comparebenchmarks.sh BASELINE_FILE RESULT_FILE [TIME_TOLERANCE [MEMORY_TOLERANCE]]"
+    echo "where the tolerances are the relative increases of the timings and of the peak"
+    echo "memory which are accepted (default: 0.1 and 0.05)."
+};
+
+if test "$#" -lt 2; then
+    echo "Wrong number of parameters"
+    echo
+    usage
+    exit 1
+fi
+
+BASELINE_FILE="$1"
+RESULT_FILE="$2"
+TIME_TOLERANCE="${3:-0.1}"
+MEMORY_TOLERANCE="${4:-0.05}"
+
+for FILE in "$BASELINE_FILE" "$RESULT_FILE"; do
+    if ! test -s "$FILE"; then
+        echo "File '$FILE' does not exist or is empty"
+        echo
+        usage
+        exit 1
+    fi
+done
+
+awk -F, -v timeTol="$TIME_TOLERANCE" -v memTol="$MEMORY_TOLERANCE" '
+    # the median of the space separated values of a string
+    function median(s,    n, v, i, j, tmp) {
+        n = split(s, v, " ");
+        for (i = 2; i <= n; ++i) {
+            tmp = v[i];
+            for (j = i - 1; j >= 1 && v[j] + 0 > tmp + 0; --j)
+                v[j + 1] = v[j];
+            v[j + 1] = tmp;
+        }
+        if (n == 0)
+            return "";
+        return (n % 2) ? v[(n + 1)/2] : (v[n/2] + v[n/2 + 1])/2;
+    }
+
+    # the median absolute deviation, scaled to be comparable to the standard deviation
+    function mad(s, med,    n, v, i, dev) {
+        n = split(s, v, " ");
+        dev = "";
+        for (i = 1; i <= n; ++i)
+            dev = dev " " ((v[i] > med) ? v[i] - med : med - v[i]);
+        return 1.4826*median(dev);
+    }
+
+    FNR == 1 {
+        # the columns are looked up by name, so the files may stem from different
+        # revisions of runbenchmark.sh
+        delete col;
+        for (i = 1; i <= NF; ++i)
+            col[$i] = i;
+        isBaseline = (FILENAME == ARGV[1]);
+        next;
+    }
+
+    {
+        key = $col["benchmark"] " (refinements: " $col["refinements"] ", processes: " \
+              $col["processes"] ", threads: " $col["threads"] ")";
+        if (!(key in seen)) {
+            seen[key] = 1;
+            keys[++numKeys] = key;
+        }
+        for (m = 1; m <= numMetrics; ++m) {
+            if (!(metrics[m] in col) || $col[metrics[m]] == "")
+                continue;
+            if (isBaseline)
+                base[key, m] = base[key, m] " " $col[metrics[m]];
+            else
+                cur[key, m] = cur[key, m] " " $col[metrics[m]];
+        }
+    }
+
+    BEGIN {
+        numMetrics = split("linearization_time solve_time output_time simulation_time peak_memory", metrics, " ");
+        split("assembly solve output total memory", labels, " ");
+        numRegressions = 0;
+    }
+
+    END {
+        for (k = 1; k <= numKeys; ++k) {
+            key = keys[k];
+            for (m = 1; m <= numMetrics; ++m) {
+                if (!((key, m) in base) || !((key, m) in cur))
+                    continue;
+                baseMed = median(base[key, m]);
+                curMed = median(cur[key, m]);
+                noise = 3*mad(base[key, m], baseMed);
+                tol = (metrics[m] == "peak_memory") ? memTol : timeTol;
+                limit = baseMed + ((tol*baseMed > noise) ? tol*baseMed : noise);
+                status = "ok";
+                if (curMed > limit) {
+                    status = "REGRESSION";
+                    ++numRegressions;
+                }
+                printf "%-70s %-8s %12.4g -> %12.4g (%+6.1f%%) %s\n",
+                       key, labels[m], baseMed, curMed,
+                       (baseMed > 0) ? (curMed - baseMed)/baseMed*100 : 0, status;
+            }
+        }
+
+        if (numRegressions > 0) {
+            printf "%d performance regressions found\n", numRegressions;
+            exit 1;
+        }
+        print "No performance regressions found";
+    }' "$BASELINE_FILE" "$RESULT_FILE"
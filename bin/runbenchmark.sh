@@ -0,0 +1,101 @@
+#! /bin/bash
+#
+# Runs a simulator of the test directory as a benchmark and appends the
+# timings reported by its timing receipt to a CSV file.
+#
+# Usage:
+#
+# runbenchmark.sh RESULT_FILE BINARY_NAME REFINEMENTS PROCESSES THREADS [SIM_ARGS]
+#
+usage() {
+    echo "Usage:"
+    echo
+    echo "runbenchmark.sh RESULT_FILE BINARY_NAME REFINEMENTS PROCESSES THREADS [SIM_ARGS]"
+    echo "where REFINEMENTS is the number of global grid refinements, PROCESSES the number of MPI"
+    echo "processes and THREADS the number of threads per process which ought to be used."
+};
+
+# extract the first number which follows a given label in the timing receipt
+receiptValue()
+{
+    grep "^ *$1" "$LOG_FILE" | head -n1 | sed "s/^ *$1 *\([0-9.e+\-]*\).*/\1/"
+}
+
+# make sure we have at least 5 parameters
+if test "$#" -lt 5; then
+    echo "Wrong number of parameters"
+    echo
+    usage
+    exit 1
+fi
+
+RESULT_FILE="$1"
+BINARY_NAME="$2"
+REFINEMENTS="$3"
+NUM_PROCS="$4"
+NUM_THREADS="$5"
+SIM_ARGS="${@:6:100}"
+
+# find the binary in the build directory
+BINARY=$(find . -type f -perm -0111 -name "$BINARY_NAME")
+NUM_BINARIES=$(echo "$BINARY" | wc -w | tr -d '[:space:]')
+if test "$NUM_BINARIES" != "1"; then
+    echo "No binary file found or binary file is non-unique (is: $BINARY)"
+    echo
+    usage
+    exit 1
+fi
+
+ARGS="--grid-global-refinements=$REFINEMENTS --threads-per-process=$NUM_THREADS $SIM_ARGS"
+if test "$NUM_PROCS" -gt 1; then
+    COMMAND="mpirun -np $NUM_PROCS $BINARY"
+else
+    COMMAND="$BINARY"
+fi
+
+echo "######################"
+echo "# Benchmarking '$BINARY_NAME' (refinements: $REFINEMENTS, processes: $NUM_PROCS, threads: $NUM_THREADS)"
+echo "######################"
+echo "executing \"$COMMAND $ARGS\""
+
+RND="$(dd if=/dev/urandom bs=20 count=1 2> /dev/null | md5sum | cut -d" " -f1)"
+LOG_FILE="benchmark-$RND.log"
+$COMMAND $ARGS > "$LOG_FILE"
+if test "$?" != "0"; then
+    echo "Executing the binary failed!"
+    tail -n 20 "$LOG_FILE"
+    rm "$LOG_FILE"
+    exit 1
+fi
+
+SETUP_TIME=$(receiptValue "Setup time:")
+SIM_TIME=$(receiptValue "Simulation time:")
+LINEARIZE_TIME=$(receiptValue "Linearization time:")
+SOLVE_TIME=$(receiptValue "Linear solve time:")
+UPDATE_TIME=$(receiptValue "Newton update time:")
+WRITE_TIME=$(receiptValue "Output write time:")
+NUM_DOF=$(receiptValue "Number of degrees of freedom:")
+NUM_TIMESTEPS=$(receiptValue "Number of time steps:")
+NUM_ITERATIONS=$(receiptValue "Number of Newton iterations:")
+PEAK_MEMORY=$(receiptValue "First process' peak memory:")
+rm "$LOG_FILE"
+
+if test -z "$SIM_TIME" || test -z "$NUM_DOF" || test -z "$NUM_ITERATIONS"; then
+    echo "Could not find the timing receipt in the output of $BINARY_NAME"
+    exit 1
+fi
+
+DOF_RATE=$(awk "BEGIN { print ($NUM_DOF*$NUM_ITERATIONS)/$SIM_TIME }")
+ITERATION_RATE=$(awk "BEGIN { print $NUM_ITERATIONS/$SIM_TIME }")
+
+# the columns of the result file are not supposed to change so that the results obtained
+# for different revisions and machines can be compared. new columns are only appended.
+if ! test -s "$RESULT_FILE"; then
+    echo "benchmark,refinements,processes,threads,dofs,time_steps,newton_iterations,setup_time,simulation_time,linearization_time,solve_time,update_time,output_time,dof_iterations_per_second,newton_iterations_per_second,peak_memory" > "$RESULT_FILE"
+fi
+echo "$BINARY_NAME,$REFINEMENTS,$NUM_PROCS,$NUM_THREADS,$NUM_DOF,$NUM_TIMESTEPS,$NUM_ITERATIONS,$SETUP_TIME,$SIM_TIME,$LINEARIZE_TIME,$SOLVE_TIME,$UPDATE_TIME,$WRITE_TIME,$DOF_RATE,$ITERATION_RATE,$PEAK_MEMORY" >> "$RESULT_FILE"
+
+echo "Degrees of freedom: $NUM_DOF, Newton iterations: $NUM_ITERATIONS, simulation time: $SIM_TIME seconds"
+echo "Throughput: $DOF_RATE DOF iterations per second, $ITERATION_RATE Newton iterations per second"
+
+exit 0
@@ -0,0 +1,172 @@
+#! /bin/bash
+#
+# Runs a simulator of the test directory for all combinations of a list of MPI process
+# counts and a list of thread counts, writes the timings of the runs to CSV files and
+# prints the parallel efficiencies of the simulation and of its phases.
+#
+# For strong scaling, the problem is the same for all runs. For weak scaling, the number
+# of cells in x direction, which must be specified as '--cells-x=N' in the simulator
+# arguments, is multiplied by the number of workers (i.e., processes times threads), so
+# that the number of cells per worker stays constant.
+#
+# Usage:
+#
+# runscalingstudy.sh MODE RESULT_FILE BINARY_NAME PROCESSES THREADS [SIM_ARGS]
+#
+usage() {
+    echo "Usage:"
+    echo
+    echo "runscalingstudy.sh MODE RESULT_FILE BINARY_NAME PROCESSES THREADS [SIM_ARGS]"
+    echo "where MODE is either 'strong' or 'weak', PROCESSES and THREADS are comma separated"
+    echo "lists of the numbers of MPI processes and threads per process which ought to be used."
+    echo "The timings of the instrumented regions are written to RESULT_FILE.regions.csv."
+};
+
+# extract the first number which follows a given label in the timing receipt
+receiptValue()
+{
+    grep "^ *$1" "$LOG_FILE" | head -n1 | sed "s/^ *$1 *\([0-9.e+\-]*\).*/\1/"
+}
+
+# make sure we have at least 5 parameters
+if test "$#" -lt 5; then
+    echo "Wrong number of parameters"
+    echo
+    usage
+    exit 1
+fi
+
+MODE="$1"
+RESULT_FILE="$2"
+BINARY_NAME="$3"
+PROCESSES_LIST="$(echo "$4" | tr ',;' '  ')"
+THREADS_LIST="$(echo "$5" | tr ',;' '  ')"
+SIM_ARGS="${@:6:100}"
+REGION_FILE="$RESULT_FILE.regions.csv"
+
+if test "$MODE" != "strong" && test "$MODE" != "weak"; then
+    echo "Unknown scaling mode '$MODE'"
+    echo
+    usage
+    exit 1
+fi
+
+# the number of cells in x direction of the problem which is solved by a single worker
+BASE_CELLS_X=""
+if test "$MODE" = "weak"; then
+    BASE_CELLS_X=$(echo " $SIM_ARGS " | sed -n "s/.* --cells-x=\([0-9]*\) .*/\1/p")
+    if test -z "$BASE_CELLS_X"; then
+        echo "Weak scaling requires the '--cells-x=N' simulator argument"
+        echo
+        usage
+        exit 1
+    fi
+    SIM_ARGS=$(echo " $SIM_ARGS " | sed "s/ --cells-x=[0-9]* / /")
+fi
+
+# find the binary in the build directory
+BINARY=$(find . -type f -perm -0111 -name "$BINARY_NAME")
+NUM_BINARIES=$(echo "$BINARY" | wc -w | tr -d '[:space:]')
+if test "$NUM_BINARIES" != "1"; then
+    echo "No binary file found or binary file is non-unique (is: $BINARY)"
+    echo
+    usage
+    exit 1
+fi
+
+# the columns of the result files are not supposed to change so that the results
+# obtained for different revisions and machines can be compared
+echo "mode,benchmark,processes,threads,cells_x,dofs,newton_iterations,simulation_time,linearization_time,solve_time,update_time" > "$RESULT_FILE"
+echo "mode,benchmark,processes,threads,region,time,count" > "$REGION_FILE"
+
+RND="$(dd if=/dev/urandom bs=20 count=1 2> /dev/null | md5sum | cut -d" " -f1)"
+LOG_FILE="scaling-$RND.log"
+INSTRUMENTATION_FILE="scaling-$RND.csv"
+
+for NUM_PROCS in $PROCESSES_LIST; do
+    for NUM_THREADS in $THREADS_LIST; do
+        NUM_WORKERS=$((NUM_PROCS*NUM_THREADS))
+        ARGS="--threads-per-process=$NUM_THREADS --enable-instrumentation=true --instrumentation-output-file=$INSTRUMENTATION_FILE $SIM_ARGS"
+        CELLS_X=""
+        if test "$MODE" = "weak"; then
+            CELLS_X=$((BASE_CELLS_X*NUM_WORKERS))
+            ARGS="--cells-x=$CELLS_X $ARGS"
+        fi
+
+        if test "$NUM_PROCS" -gt 1; then
+            COMMAND="mpirun -np $NUM_PROCS $BINARY"
+            RANK0_INSTRUMENTATION_FILE="$INSTRUMENTATION_FILE.0"
+        else
+            COMMAND="$BINARY"
+            RANK0_INSTRUMENTATION_FILE="$INSTRUMENTATION_FILE"
+        fi
+
+        echo "######################"
+        echo "# $MODE scaling of '$BINARY_NAME' (processes: $NUM_PROCS, threads: $NUM_THREADS)"
+        echo "######################"
+        echo "executing \"$COMMAND $ARGS\""
+
+        $COMMAND $ARGS > "$LOG_FILE"
+        if test "$?" != "0"; then
+            echo "Executing the binary failed!"
+            tail -n 20 "$LOG_FILE"
+            rm -f "$LOG_FILE" "$INSTRUMENTATION_FILE"*
+            exit 1
+        fi
+
+        SIM_TIME=$(receiptValue "Simulation time:")
+        LINEARIZE_TIME=$(receiptValue "Linearization time:")
+        SOLVE_TIME=$(receiptValue "Linear solve time:")
+        UPDATE_TIME=$(receiptValue "Newton update time:")
+        NUM_DOF=$(receiptValue "Number of degrees of freedom:")
+        NUM_ITERATIONS=$(receiptValue "Number of Newton iterations:")
+        rm "$LOG_FILE"
+
+        if test -z "$SIM_TIME" || test -z "$NUM_DOF" || test -z "$NUM_ITERATIONS"; then
+            echo "Could not find the timing receipt in the output of $BINARY_NAME"
+            rm -f "$INSTRUMENTATION_FILE"*
+            exit 1
+        fi
+
+        echo "$MODE,$BINARY_NAME,$NUM_PROCS,$NUM_THREADS,$CELLS_X,$NUM_DOF,$NUM_ITERATIONS,$SIM_TIME,$LINEARIZE_TIME,$SOLVE_TIME,$UPDATE_TIME" >> "$RESULT_FILE"
+
+        # the instrumented regions of the first process. only the totals over all
+        # threads are considered, i.e. the rows which do not specify a thread
+        if test -f "$RANK0_INSTRUMENTATION_FILE"; then
+            awk -F, -v prefix="$MODE,$BINARY_NAME,$NUM_PROCS,$NUM_THREADS" \
+                'NR > 1 && $2 == "" { print prefix "," $1 "," $3 "," $4 }' \
+                "$RANK0_INSTRUMENTATION_FILE" >> "$REGION_FILE"
+        fi
+        rm -f "$INSTRUMENTATION_FILE"*
+    done
+done
+
+# print the efficiencies relative to the first run. for strong scaling, the efficiency
+# is T_1*W_1/(T_n*W_n), for weak scaling it is T_1/T_n, where T are the wall clock times
+# and W the numbers of workers of the runs.
+echo
+echo "$MODE scaling of '$BINARY_NAME' (efficiencies relative to the first run)"
+awk -F, -v mode="$MODE" '
+    function efficiency(t, baseT, w) {
+        if (t <= 0)
+            return 0;
+        return (mode == "strong") ? (baseT*baseW)/(t*w) : baseT/t;
+    }
+    NR == 1 {
+        printf "%9s %8s %12s %12s %10s %10s %10s %10s\n",
+               "processes", "threads", "dofs", "time [s]", "speedup",
+               "E(total)", "E(linear.)", "E(solve)";
+        next;
+    }
+    {
+        w = $3*$4;
+        if (NR == 2) {
+            baseW = w; baseSim = $8; baseLin = $9; baseSolve = $10;
+        }
+        printf "%9d %8d %12d %12.3f %10.2f %10.2f %10.2f %10.2f\n",
+               $3, $4, $6, $8, ($8 > 0) ? baseSim/$8 : 0,
+               efficiency($8, baseSim, w), efficiency($9, baseLin, w),
+               efficiency($10, baseSolve, w);
+    }' "$RESULT_FILE"
+
+exit 0
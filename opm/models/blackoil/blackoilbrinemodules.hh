@@ -266,8 +266,8 @@ public:
         return static_cast<Scalar>(0.0);
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void serializeEntity(const Model& model, Stream& outstream, const DofEntity& dof)
     {
         if (!enableBrine)
             return;
@@ -277,8 +277,8 @@ public:
         outstream << priVars[saltConcentrationIdx];
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void deserializeEntity(Model& model, Stream& instream, const DofEntity& dof)
     {
         if (!enableBrine)
             return;
@@ -298,18 +298,24 @@ public:
                                            unsigned timeIdx)
     {
         unsigned pvtnumRegionIdx = elemCtx.problem().pvtRegionIndex(elemCtx, scvIdx, timeIdx);
-        return referencePressure_[pvtnumRegionIdx];
+        return referencePressure(pvtnumRegionIdx);
     }
 
+    static const Scalar& referencePressure(unsigned pvtnumRegionIdx)
+    { return referencePressure_[pvtnumRegionIdx]; }
+
 
     static const TabulatedFunction& bdensityTable(const ElementContext& elemCtx,
                                                   unsigned scvIdx,
                                                   unsigned timeIdx)
     {
         unsigned pvtnumRegionIdx = elemCtx.problem().pvtRegionIndex(elemCtx, scvIdx, timeIdx);
-        return bdensityTable_[pvtnumRegionIdx];
+        return bdensityTable(pvtnumRegionIdx);
     }
 
+    static const TabulatedFunction& bdensityTable(unsigned pvtnumRegionIdx)
+    { return bdensityTable_[pvtnumRegionIdx]; }
+
     static bool hasBDensityTables()
     {
         return !bdensityTable_.empty();
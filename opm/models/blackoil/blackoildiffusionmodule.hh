@@ -390,6 +390,7 @@ class BlackOilDiffusionExtensiveQuantities<TypeTag, /*enableDiffusion=*/true>
 
     using DimVector = Dune::FieldVector<Scalar, dimWorld>;
     using DimEvalVector = Dune::FieldVector<Evaluation, dimWorld>;
+    using Toolbox = MathToolbox<Evaluation>;
 
 protected:
     /*!
@@ -419,7 +420,17 @@ protected:
             if (FluidSystem::waterPhaseIdx == phaseIdx) {
                 continue;
             }
-            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+
+            // addDiffusiveFlux() skips phases which are absent on both sides of the face
+            if (Toolbox::value(intQuantsInside.fluidState().saturation(phaseIdx)) <= 0.0
+                && Toolbox::value(intQuantsOutside.fluidState().saturation(phaseIdx)) <= 0.0) {
+                continue;
+            }
+
+            // only the solvent and the solute components of a phase diffuse
+            const unsigned diffusiveCompIdx[2] = { FluidSystem::solventComponentIndex(phaseIdx),
+                                                   FluidSystem::soluteComponentIndex(phaseIdx) };
+            for (unsigned compIdx : diffusiveCompIdx) {
                 moleFractionGradientNormal_[phaseIdx][compIdx] =
                     (intQuantsOutside.fluidState().moleFraction(phaseIdx, compIdx)
                      -
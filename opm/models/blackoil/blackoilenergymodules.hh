@@ -288,8 +288,8 @@ public:
         return std::abs(scalarValue(resid[contiEnergyEqIdx]));
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void serializeEntity(const Model& model, Stream& outstream, const DofEntity& dof)
     {
         if (!enableEnergy)
             return;
@@ -299,8 +299,8 @@ public:
         outstream << priVars[temperatureIdx];
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void deserializeEntity(Model& model, Stream& instream, const DofEntity& dof)
     {
         if (!enableEnergy)
             return;
@@ -468,8 +468,8 @@ public:
         return std::abs(Toolbox::scalarValue(resid[contiZfracEqIdx]));
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void serializeEntity(const Model& model, Stream& outstream, const DofEntity& dof)
     {
         if (!enableExtbo)
             return;
@@ -480,8 +480,8 @@ public:
         outstream << priVars[zFractionIdx];
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void deserializeEntity(Model& model, Stream& instream, const DofEntity& dof)
     {
         if (!enableExtbo)
             return;
@@ -497,6 +497,90 @@ public:
         priVars1 = priVars0[zFractionIdx];
     }
 
+    /*!
+     * \brief The position of a (pressure, z-fraction) point in the sampling points of
+     *        the pressure dependent tables of a PVT region.
+     *
+     * The BO, BG, RS, RV, X, Y, VISCO and VISCG tables of a PVT region are sampled at
+     * the same points, so the segments and the interpolation weights only need to be
+     * determined once per point. They are then applied to all tables which are
+     * required.
+     */
+    template <typename Value>
+    struct TableLocation
+    {
+        unsigned zSegmentIdx;
+        unsigned pressureSegmentIdx[2];
+        Value alpha;
+        Value beta[2];
+    };
+
+    /*!
+     * \brief Locate a point in the sampling points of the pressure dependent tables.
+     */
+    template <typename Value>
+    static TableLocation<Value> locate(unsigned pvtRegionIdx, const Value& pressure, const Value& z)
+    {
+        // all tables share the sampling points of BO
+        const auto& table = BO_[pvtRegionIdx];
+#ifndef NDEBUG
+        if (!table.applies(z, pressure))
+            throw NumericalIssue("Attempt to get undefined table value ("
+                                 + std::to_string(MathToolbox<Value>::scalarValue(z)) + ", "
+                                 + std::to_string(MathToolbox<Value>::scalarValue(pressure)) + ")");
+#endif
+
+        TableLocation<Value> loc;
+        loc.zSegmentIdx = table.xSegmentIndex(z);
+        loc.alpha = table.xToAlpha(z, loc.zSegmentIdx);
+        for (unsigned k = 0; k < 2; ++k) {
+            unsigned zSampleIdx = loc.zSegmentIdx + k;
+            loc.pressureSegmentIdx[k] = table.ySegmentIndex(pressure, zSampleIdx);
+            loc.beta[k] = table.yToBeta(pressure, zSampleIdx, loc.pressureSegmentIdx[k]);
+        }
+        return loc;
+    }
+
+    template <typename Value>
+    static Value xVolume(unsigned pvtRegionIdx, const TableLocation<Value>& loc) {
+        return interpolate_(X_[pvtRegionIdx], loc);
+    }
+
+    template <typename Value>
+    static Value yVolume(unsigned pvtRegionIdx, const TableLocation<Value>& loc) {
+        return interpolate_(Y_[pvtRegionIdx], loc);
+    }
+
+    template <typename Value>
+    static Value oilViscosity(unsigned pvtRegionIdx, const TableLocation<Value>& loc) {
+        return interpolate_(VISCO_[pvtRegionIdx], loc);
+    }
+
+    template <typename Value>
+    static Value gasViscosity(unsigned pvtRegionIdx, const TableLocation<Value>& loc) {
+        return interpolate_(VISCG_[pvtRegionIdx], loc);
+    }
+
+    template <typename Value>
+    static Value bo(unsigned pvtRegionIdx, const TableLocation<Value>& loc) {
+        return interpolate_(BO_[pvtRegionIdx], loc);
+    }
+
+    template <typename Value>
+    static Value bg(unsigned pvtRegionIdx, const TableLocation<Value>& loc) {
+        return interpolate_(BG_[pvtRegionIdx], loc);
+    }
+
+    template <typename Value>
+    static Value rs(unsigned pvtRegionIdx, const TableLocation<Value>& loc) {
+        return interpolate_(RS_[pvtRegionIdx], loc);
+    }
+
+    template <typename Value>
+    static Value rv(unsigned pvtRegionIdx, const TableLocation<Value>& loc) {
+        return interpolate_(RV_[pvtRegionIdx], loc);
+    }
+
     template <typename Value>
     static Value xVolume(unsigned pvtRegionIdx, const Value& pressure, const Value& z) {
         return X_[pvtRegionIdx].eval(z, pressure);
@@ -566,6 +650,22 @@ public:
     }
 
 private:
+    // bilinear interpolation of a table using the weights of a location, this is the
+    // same as UniformXTabulated2DFunction::eval()
+    template <typename Value>
+    static Value interpolate_(const Tabulated2DFunction& table, const TableLocation<Value>& loc)
+    {
+        unsigned i = loc.zSegmentIdx;
+        unsigned j1 = loc.pressureSegmentIdx[0];
+        unsigned j2 = loc.pressureSegmentIdx[1];
+
+        const Value s1 =
+            table.valueAt(i, j1)*(1.0 - loc.beta[0]) + table.valueAt(i, j1 + 1)*loc.beta[0];
+        const Value s2 =
+            table.valueAt(i + 1, j2)*(1.0 - loc.beta[1]) + table.valueAt(i + 1, j2 + 1)*loc.beta[1];
+        return s1*(1.0 - loc.alpha) + s2*loc.alpha;
+    }
+
     static std::vector<Tabulated2DFunction> X_;
     static std::vector<Tabulated2DFunction> Y_;
     static std::vector<Tabulated2DFunction> PBUB_RS_;
@@ -686,26 +786,31 @@ public:
 
         zFraction_ = priVars.makeEvaluation(zFractionIdx, timeIdx);
 
-        oilViscosity_ = ExtboModule::oilViscosity(pvtRegionIdx, fs.pressure(oilPhaseIdx), zFraction_);
-        gasViscosity_ = ExtboModule::gasViscosity(pvtRegionIdx, fs.pressure(gasPhaseIdx), zFraction_);
+        // the tables only need to be located once per pressure, the oil phase pressure
+        // is also the bubble point pressure unless the oil is undersaturated
+        const auto oilLoc = ExtboModule::locate(pvtRegionIdx, fs.pressure(oilPhaseIdx), zFraction_);
+        const auto gasLoc = ExtboModule::locate(pvtRegionIdx, fs.pressure(gasPhaseIdx), zFraction_);
 
-        bo_ = ExtboModule::bo(pvtRegionIdx, fs.pressure(oilPhaseIdx), zFraction_);
-        bg_ = ExtboModule::bg(pvtRegionIdx, fs.pressure(gasPhaseIdx), zFraction_);
+        oilViscosity_ = ExtboModule::oilViscosity(pvtRegionIdx, oilLoc);
+        gasViscosity_ = ExtboModule::gasViscosity(pvtRegionIdx, gasLoc);
+
+        bo_ = ExtboModule::bo(pvtRegionIdx, oilLoc);
+        bg_ = ExtboModule::bg(pvtRegionIdx, gasLoc);
 
         bz_ = ExtboModule::bg(pvtRegionIdx, fs.pressure(oilPhaseIdx), Evaluation{0.99});
 
         if (FluidSystem::enableDissolvedGas())
-            rs_ = ExtboModule::rs(pvtRegionIdx, fs.pressure(oilPhaseIdx), zFraction_);
+            rs_ = ExtboModule::rs(pvtRegionIdx, oilLoc);
         else
             rs_ = 0.0;
 
         if (FluidSystem::enableVaporizedOil())
-            rv_ = ExtboModule::rv(pvtRegionIdx, fs.pressure(gasPhaseIdx), zFraction_);
+            rv_ = ExtboModule::rv(pvtRegionIdx, gasLoc);
         else
             rv_ = 0.0;
 
-        xVolume_ = ExtboModule::xVolume(pvtRegionIdx, fs.pressure(oilPhaseIdx), zFraction_);
-        yVolume_ = ExtboModule::yVolume(pvtRegionIdx, fs.pressure(oilPhaseIdx), zFraction_);
+        xVolume_ = ExtboModule::xVolume(pvtRegionIdx, oilLoc);
+        yVolume_ = ExtboModule::yVolume(pvtRegionIdx, oilLoc);
 
         Evaluation pbub = fs.pressure(oilPhaseIdx);
 
@@ -727,17 +832,17 @@ public:
            } else {
              pbub = ExtboModule::pbubRs(pvtRegionIdx, zFraction_, rs_);
            }
-           bo_ = ExtboModule::bo(pvtRegionIdx, pbub, zFraction_) + ExtboModule::oilCmp(pvtRegionIdx, zFraction_)*(fs.pressure(oilPhaseIdx)-pbub);
+           const auto pbubLoc = ExtboModule::locate(pvtRegionIdx, pbub, zFraction_);
+           bo_ = ExtboModule::bo(pvtRegionIdx, pbubLoc) + ExtboModule::oilCmp(pvtRegionIdx, zFraction_)*(fs.pressure(oilPhaseIdx)-pbub);
 
-           xVolume_ = ExtboModule::xVolume(pvtRegionIdx, pbub, zFraction_);
+           xVolume_ = ExtboModule::xVolume(pvtRegionIdx, pbubLoc);
         }
 
         if (priVars.primaryVarsMeaning() == PrimaryVariables::Sw_pg_Rv) {
            rv_ = priVars.makeEvaluation(Indices::compositionSwitchIdx, timeIdx);
-           Evaluation rvsat = ExtboModule::rv(pvtRegionIdx, pbub, zFraction_);
-           bg_ = ExtboModule::bg(pvtRegionIdx, pbub, zFraction_) + ExtboModule::gasCmp(pvtRegionIdx, zFraction_)*(rv_-rvsat);
-
-           yVolume_ = ExtboModule::yVolume(pvtRegionIdx, pbub, zFraction_);
+           // pbub is the oil phase pressure here, i.e., yVolume_ is already correct
+           Evaluation rvsat = ExtboModule::rv(pvtRegionIdx, oilLoc);
+           bg_ = ExtboModule::bg(pvtRegionIdx, oilLoc) + ExtboModule::gasCmp(pvtRegionIdx, zFraction_)*(rv_-rvsat);
         }
     }
 
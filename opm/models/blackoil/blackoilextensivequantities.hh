@@ -35,6 +35,8 @@
 #include "blackoildiffusionmodule.hh"
 #include <opm/models/common/multiphasebaseextensivequantities.hh>
 
+#include <type_traits>
+
 namespace Opm {
 
 /*!
@@ -65,6 +67,19 @@ class BlackOilExtensiveQuantities
     enum { enableDiffusion = getPropValue<TypeTag, Properties::EnableDiffusion>() };
     using DiffusionExtensiveQuantities = BlackOilDiffusionExtensiveQuantities<TypeTag, enableDiffusion>;
 
+    // the extensions which are disabled at compile time must not add any storage
+    static_assert(getPropValue<TypeTag, Properties::EnableSolvent>()
+                  || std::is_empty<BlackOilSolventExtensiveQuantities<TypeTag>>::value,
+                  "The extensive quantities of the disabled solvent extension must be empty");
+    static_assert(getPropValue<TypeTag, Properties::EnablePolymer>()
+                  || std::is_empty<BlackOilPolymerExtensiveQuantities<TypeTag>>::value,
+                  "The extensive quantities of the disabled polymer extension must be empty");
+    static_assert(getPropValue<TypeTag, Properties::EnableEnergy>()
+                  || std::is_empty<BlackOilEnergyExtensiveQuantities<TypeTag>>::value,
+                  "The extensive quantities of the disabled energy extension must be empty");
+    static_assert(enableDiffusion || std::is_empty<DiffusionExtensiveQuantities>::value,
+                  "The extensive quantities of the disabled diffusion extension must be empty");
+
 
 public:
     /*!
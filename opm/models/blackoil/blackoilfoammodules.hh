@@ -31,6 +31,7 @@
 #include "blackoilproperties.hh"
 //#include <opm/models/io/vtkblackoilfoammodule.hh>
 #include <opm/models/common/quantitycallbacks.hh>
+#include <opm/models/utils/segmentcachedeval.hh>
 
 #include <opm/material/common/Tabulated1DFunction.hpp>
 //#include <opm/material/common/IntervalTabulated2DFunction.hpp>
@@ -372,8 +373,8 @@ public:
         return static_cast<Scalar>(0.0);
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void serializeEntity(const Model& model, Stream& outstream, const DofEntity& dof)
     {
         if (!enableFoam)
             return;
@@ -383,8 +384,8 @@ public:
         outstream << priVars[foamConcentrationIdx];
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void deserializeEntity(Model& model, Stream& instream, const DofEntity& dof)
     {
         if (!enableFoam)
             return;
@@ -404,41 +405,56 @@ public:
                                         unsigned timeIdx)
     {
         unsigned satnumRegionIdx = elemCtx.problem().satnumRegionIndex(elemCtx, scvIdx, timeIdx);
-        return foamRockDensity_[satnumRegionIdx];
+        return foamRockDensity(satnumRegionIdx);
     }
 
+    static const Scalar foamRockDensity(unsigned satnumRegionIdx)
+    { return foamRockDensity_[satnumRegionIdx]; }
+
     static bool foamAllowDesorption(const ElementContext& elemCtx,
                                     unsigned scvIdx,
                                     unsigned timeIdx)
     {
         unsigned satnumRegionIdx = elemCtx.problem().satnumRegionIndex(elemCtx, scvIdx, timeIdx);
-        return foamAllowDesorption_[satnumRegionIdx];
+        return foamAllowDesorption(satnumRegionIdx);
     }
 
+    static bool foamAllowDesorption(unsigned satnumRegionIdx)
+    { return foamAllowDesorption_[satnumRegionIdx]; }
+
     static const TabulatedFunction& adsorbedFoamTable(const ElementContext& elemCtx,
                                                       unsigned scvIdx,
                                                       unsigned timeIdx)
     {
        unsigned satnumRegionIdx = elemCtx.problem().satnumRegionIndex(elemCtx, scvIdx, timeIdx);
-       return adsorbedFoamTable_[satnumRegionIdx];
+       return adsorbedFoamTable(satnumRegionIdx);
     }
 
+    static const TabulatedFunction& adsorbedFoamTable(unsigned satnumRegionIdx)
+    { return adsorbedFoamTable_[satnumRegionIdx]; }
+
     static const TabulatedFunction& gasMobilityMultiplierTable(const ElementContext& elemCtx,
                                                                unsigned scvIdx,
                                                                unsigned timeIdx)
     {
        unsigned pvtnumRegionIdx = elemCtx.problem().pvtRegionIndex(elemCtx, scvIdx, timeIdx);
-       return gasMobilityMultiplierTable_[pvtnumRegionIdx];
+       return gasMobilityMultiplierTable(pvtnumRegionIdx);
     }
 
+    static const TabulatedFunction& gasMobilityMultiplierTable(unsigned pvtnumRegionIdx)
+    { return gasMobilityMultiplierTable_[pvtnumRegionIdx]; }
+
     static const FoamCoefficients& foamCoefficients(const ElementContext& elemCtx,
                                                     const unsigned scvIdx,
                                                     const unsigned timeIdx)
     {
         unsigned satnumRegionIdx = elemCtx.problem().satnumRegionIndex(elemCtx, scvIdx, timeIdx);
-        return foamCoefficients_[satnumRegionIdx];
+        return foamCoefficients(satnumRegionIdx);
     }
 
+    static const FoamCoefficients& foamCoefficients(unsigned satnumRegionIdx)
+    { return foamCoefficients_[satnumRegionIdx]; }
+
 private:
     static std::vector<Scalar> foamRockDensity_;
     static std::vector<bool> foamAllowDesorption_;
@@ -499,6 +515,15 @@ class BlackOilFoamIntensiveQuantities
     static constexpr int gasPhaseIdx = FluidSystem::gasPhaseIdx;
 
 public:
+    /*!
+     * \brief Start the table searches at the segments which were used for the degree
+     *        of freedom by a previous update.
+     */
+    void foamSegmentsFromHint_(const BlackOilFoamIntensiveQuantities& hint)
+    {
+        gasMobilitySegmentIdx_ = hint.gasMobilitySegmentIdx_;
+        adsorbedSegmentIdx_ = hint.adsorbedSegmentIdx_;
+    }
 
     /*!
      * \brief Update the intensive properties needed to handle polymers from the
@@ -513,13 +538,18 @@ public:
         foamConcentration_ = priVars.makeEvaluation(foamConcentrationIdx, timeIdx);
         const auto& fs = asImp_().fluidState_;
 
+        // look up the region indices only once. the PVT region index has already been
+        // determined by the black-oil intensive quantities.
+        unsigned satnumRegionIdx = elemCtx.problem().satnumRegionIndex(elemCtx, dofIdx, timeIdx);
+        unsigned pvtnumRegionIdx = asImp_().pvtRegionIndex();
+
         // Compute gas mobility reduction factor
         Evaluation mobilityReductionFactor = 1.0;
         if (false) {
             // The functional model is used.
             // TODO: allow this model.
             // In order to do this we must allow transport to be in the water phase, not just the gas phase.
-            const auto& foamCoefficients = FoamModule::foamCoefficients(elemCtx, dofIdx, timeIdx);
+            const auto& foamCoefficients = FoamModule::foamCoefficients(satnumRegionIdx);
 
             const Scalar fm_mob = foamCoefficients.fm_mob;
 
@@ -551,18 +581,19 @@ public:
             // The tabular model is used.
             // Note that the current implementation only includes the effect of foam concentration (FOAMMOB),
             // and not the optional pressure dependence (FOAMMOBP) or shear dependence (FOAMMOBS).
-            const auto& gasMobilityMultiplier = FoamModule::gasMobilityMultiplierTable(elemCtx, dofIdx, timeIdx);
-            mobilityReductionFactor = gasMobilityMultiplier.eval(foamConcentration_, /* extrapolate = */ true);
+            const auto& gasMobilityMultiplier = FoamModule::gasMobilityMultiplierTable(pvtnumRegionIdx);
+            mobilityReductionFactor = segmentCachedEval(gasMobilityMultiplier, foamConcentration_,
+                                                        gasMobilitySegmentIdx_);
         }
 
         // adjust gas mobility
         asImp_().mobility_[gasPhaseIdx] *= mobilityReductionFactor;
 
-        foamRockDensity_ = FoamModule::foamRockDensity(elemCtx, dofIdx, timeIdx);
+        foamRockDensity_ = FoamModule::foamRockDensity(satnumRegionIdx);
 
-        const auto& adsorbedFoamTable = FoamModule::adsorbedFoamTable(elemCtx, dofIdx, timeIdx);
-        foamAdsorbed_ = adsorbedFoamTable.eval(foamConcentration_, /*extrapolate=*/true);
-        if (!FoamModule::foamAllowDesorption(elemCtx, dofIdx, timeIdx)) {
+        const auto& adsorbedFoamTable = FoamModule::adsorbedFoamTable(satnumRegionIdx);
+        foamAdsorbed_ = segmentCachedEval(adsorbedFoamTable, foamConcentration_, adsorbedSegmentIdx_);
+        if (!FoamModule::foamAllowDesorption(satnumRegionIdx)) {
             throw std::runtime_error("Foam module does not support the 'no desorption' option.");
         }
     }
@@ -583,6 +614,10 @@ protected:
     Evaluation foamConcentration_;
     Scalar foamRockDensity_;
     Evaluation foamAdsorbed_;
+
+    // the segments of the tables which were used by the last update
+    unsigned gasMobilitySegmentIdx_ = 0;
+    unsigned adsorbedSegmentIdx_ = 0;
 };
 
 template <class TypeTag>
@@ -593,6 +628,10 @@ class BlackOilFoamIntensiveQuantities<TypeTag, false>
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
 
 public:
+    template <class IntensiveQuantities>
+    void foamSegmentsFromHint_(const IntensiveQuantities& hint OPM_UNUSED)
+    { }
+
     void foamPropertiesUpdate_(const ElementContext& elemCtx OPM_UNUSED,
                                   unsigned scvIdx OPM_UNUSED,
                                   unsigned timeIdx OPM_UNUSED)
@@ -36,11 +36,13 @@
 #include "blackoilbrinemodules.hh"
 #include "blackoilenergymodules.hh"
 #include "blackoildiffusionmodule.hh"
+#include "blackoilpvttables.hh"
 #include <opm/material/fluidstates/BlackOilFluidState.hpp>
 #include <opm/material/common/Valgrind.hpp>
 #include <dune/common/fmatrix.hh>
 
 #include <cstring>
+#include <type_traits>
 #include <utility>
 
 namespace Opm {
@@ -104,6 +106,25 @@ class BlackOilIntensiveQuantities
     using FluxIntensiveQuantities = typename FluxModule::FluxIntensiveQuantities;
     using FluidState = BlackOilFluidState<Evaluation, FluidSystem, enableTemperature, enableEnergy, compositionSwitchEnabled,  enableBrine, Indices::numPhases >;
     using DiffusionIntensiveQuantities = BlackOilDiffusionIntensiveQuantities<TypeTag, enableDiffusion>;
+    using PvtTables = BlackOilPvtTables<TypeTag>;
+
+    // the extensions which are disabled at compile time must not add any per-DOF
+    // storage to the intensive quantities. (the empty base class optimization then
+    // makes them vanish entirely.)
+    static_assert(enableSolvent || std::is_empty<BlackOilSolventIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled solvent extension must be empty");
+    static_assert(enableExtbo || std::is_empty<BlackOilExtboIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled extended black-oil extension must be empty");
+    static_assert(enablePolymer || std::is_empty<BlackOilPolymerIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled polymer extension must be empty");
+    static_assert(enableFoam || std::is_empty<BlackOilFoamIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled foam extension must be empty");
+    static_assert(enableBrine || std::is_empty<BlackOilBrineIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled brine extension must be empty");
+    static_assert(enableEnergy || std::is_empty<BlackOilEnergyIntensiveQuantities<TypeTag>>::value,
+                  "The intensive quantities of the disabled energy extension must be empty");
+    static_assert(enableDiffusion || std::is_empty<DiffusionIntensiveQuantities>::value,
+                  "The intensive quantities of the disabled diffusion extension must be empty");
 
 public:
     BlackOilIntensiveQuantities()
@@ -125,6 +146,17 @@ public:
     {
         ParentType::update(elemCtx, dofIdx, timeIdx);
 
+        // the objects of the element context are reused for different degrees of
+        // freedom, so the table segments which they remember are usually the ones of
+        // some other cell. if the quantities of the previous iteration are available
+        // for this degree of freedom, their segments are much better starting points.
+        const auto* hint = elemCtx.thermodynamicHint(dofIdx, timeIdx);
+        if (hint && hint != this) {
+            asImp_().solventSegmentsFromHint_(*hint);
+            asImp_().polymerSegmentsFromHint_(*hint);
+            asImp_().foamSegmentsFromHint_(*hint);
+        }
+
         const auto& problem = elemCtx.problem();
         const auto& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
 
@@ -233,10 +265,7 @@ public:
             if (FluidSystem::enableDissolvedGas()) {
                 Scalar RsMax = elemCtx.problem().maxGasDissolutionFactor(timeIdx, globalSpaceIdx);
                 const Evaluation& RsSat = enableExtbo ? asImp_().rs() :
-                    FluidSystem::saturatedDissolutionFactor(fluidState_,
-                                                            oilPhaseIdx,
-                                                            pvtRegionIdx,
-                                                            SoMax);
+                    saturatedDissolutionFactor_(oilPhaseIdx, pvtRegionIdx, SoMax);
                 fluidState_.setRs(min(RsMax, RsSat));
             }
             else if (compositionSwitchEnabled)
@@ -245,10 +274,7 @@ public:
             if (FluidSystem::enableVaporizedOil()) {
                 Scalar RvMax = elemCtx.problem().maxOilVaporizationFactor(timeIdx, globalSpaceIdx);
                 const Evaluation& RvSat = enableExtbo ? asImp_().rv() :
-                    FluidSystem::saturatedDissolutionFactor(fluidState_,
-                                                            gasPhaseIdx,
-                                                            pvtRegionIdx,
-                                                            SoMax);
+                    saturatedDissolutionFactor_(gasPhaseIdx, pvtRegionIdx, SoMax);
                 fluidState_.setRv(min(RvMax, RvSat));
             }
             else if (compositionSwitchEnabled)
@@ -267,10 +293,7 @@ public:
                 // for the gravity correction anyway
                 Scalar RvMax = elemCtx.problem().maxOilVaporizationFactor(timeIdx, globalSpaceIdx);
                 const auto& RvSat = enableExtbo ? asImp_().rv() :
-                    FluidSystem::saturatedDissolutionFactor(fluidState_,
-                                                            gasPhaseIdx,
-                                                            pvtRegionIdx,
-                                                            SoMax);
+                    saturatedDissolutionFactor_(gasPhaseIdx, pvtRegionIdx, SoMax);
 
                 fluidState_.setRv(min(RvMax, RvSat));
             }
@@ -286,10 +309,7 @@ public:
                 // the gravity correction anyway
                 Scalar RsMax = elemCtx.problem().maxGasDissolutionFactor(timeIdx, globalSpaceIdx);
                 const auto& RsSat = enableExtbo ? asImp_().rs() :
-                    FluidSystem::saturatedDissolutionFactor(fluidState_,
-                                                            oilPhaseIdx,
-                                                            pvtRegionIdx,
-                                                            SoMax);
+                    saturatedDissolutionFactor_(oilPhaseIdx, pvtRegionIdx, SoMax);
 
                 fluidState_.setRs(min(RsMax, RsSat));
             } else {
@@ -311,10 +331,18 @@ public:
             if (!FluidSystem::phaseIsActive(phaseIdx))
                 continue;
 
-            const auto& b = FluidSystem::inverseFormationVolumeFactor(fluidState_, phaseIdx, pvtRegionIdx);
+            Evaluation b;
+            Evaluation mu;
+            if (PvtTables::enabled()) {
+                b = PvtTables::inverseFormationVolumeFactor(fluidState_, phaseIdx, pvtRegionIdx);
+                mu = PvtTables::viscosity(fluidState_, phaseIdx, pvtRegionIdx);
+            }
+            else {
+                b = FluidSystem::inverseFormationVolumeFactor(fluidState_, phaseIdx, pvtRegionIdx);
+                mu = FluidSystem::viscosity(fluidState_, paramCache, phaseIdx);
+            }
             fluidState_.setInvB(phaseIdx, b);
 
-            const auto& mu = FluidSystem::viscosity(fluidState_, paramCache, phaseIdx);
             if (enableExtbo && phaseIdx == oilPhaseIdx)
               mobility_[phaseIdx] /= asImp_().oilViscosity();
             else if (enableExtbo && phaseIdx == gasPhaseIdx)
@@ -474,6 +502,18 @@ private:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
+    // returns the saturated gas dissolution factor (oil phase) or the saturated oil
+    // vaporization factor (gas phase), using the PVT lookup tables if possible
+    Evaluation saturatedDissolutionFactor_(unsigned phaseIdx,
+                                           unsigned pvtRegionIdx,
+                                           const Evaluation& SoMax) const
+    {
+        if (PvtTables::enabled() && PvtTables::tabulatesSaturatedFactors())
+            return PvtTables::saturatedDissolutionFactor(fluidState_, phaseIdx, pvtRegionIdx);
+
+        return FluidSystem::saturatedDissolutionFactor(fluidState_, phaseIdx, pvtRegionIdx, SoMax);
+    }
+
     FluidState fluidState_;
     Scalar referencePorosity_;
     Evaluation porosity_;
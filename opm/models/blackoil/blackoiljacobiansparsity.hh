@@ -0,0 +1,86 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilJacobianSparsity
+ */
+#ifndef EWOMS_BLACK_OIL_JACOBIAN_SPARSITY_HH
+#define EWOMS_BLACK_OIL_JACOBIAN_SPARSITY_HH
+
+#include "blackoilproperties.hh"
+
+namespace Opm {
+
+/*!
+ * \ingroup BlackOilModel
+ *
+ * \brief The entries of the Jacobian blocks of the black-oil model which are always
+ *        zero for the enabled extension modules.
+ *
+ * The polymer primary variables only alter the mobility of the water phase, so they do
+ * not enter the conservation equations of oil and gas. Likewise, the foam concentration
+ * only alters the mobility of the gas phase, so it does not enter the conservation
+ * equation of water. The other extensions modify the properties of the fluids and thus
+ * potentially couple to all equations.
+ *
+ * The pattern only holds if the problem does not introduce any additional coupling,
+ * e.g. via source terms. It can be used for the linear operator of the solver via
+ * \code
+ * template<class TypeTag>
+ * struct JacobianBlockSparsity<TypeTag, TTag::YourTypeTag>
+ * { using type = Opm::BlackOilJacobianSparsity<TypeTag>; };
+ * \endcode
+ */
+template <class TypeTag>
+struct BlackOilJacobianSparsity
+{
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+
+    static constexpr bool isNonZero(int eqIdx, int pvIdx)
+    {
+        if (Indices::enablePolymer
+            && (pvIdx == Indices::polymerConcentrationIdx
+                || pvIdx == Indices::polymerMoleWeightIdx))
+            return !isEquationOf_(eqIdx, Indices::oilEnabled, FluidSystem::oilCompIdx)
+                && !isEquationOf_(eqIdx, Indices::gasEnabled, FluidSystem::gasCompIdx);
+
+        if (Indices::foamConcentrationIdx >= 0 && pvIdx == Indices::foamConcentrationIdx)
+            return !isEquationOf_(eqIdx, Indices::waterEnabled, FluidSystem::waterCompIdx);
+
+        return true;
+    }
+
+private:
+    static constexpr bool isEquationOf_(int eqIdx, bool compEnabled, unsigned compIdx)
+    {
+        return compEnabled
+            && eqIdx == static_cast<int>(Indices::conti0EqIdx
+                                         + Indices::canonicalToActiveComponentIndex(compIdx));
+    }
+};
+
+} // namespace Opm
+
+#endif
@@ -77,7 +77,12 @@ class BlackOilLocalResidual : public GetPropType<TypeTag, Properties::DiscLocalR
     static const bool compositionSwitchEnabled = (compositionSwitchIdx >= 0);
 
     static constexpr bool blackoilConserveSurfaceVolume = getPropValue<TypeTag, Properties::BlackoilConserveSurfaceVolume>();
+    static constexpr bool enableSolvent = getPropValue<TypeTag, Properties::EnableSolvent>();
+    static constexpr bool enableExtbo = getPropValue<TypeTag, Properties::EnableExtbo>();
+    static constexpr bool enablePolymer = getPropValue<TypeTag, Properties::EnablePolymer>();
     static constexpr bool enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>();
+    static constexpr bool enableFoam = getPropValue<TypeTag, Properties::EnableFoam>();
+    static constexpr bool enableBrine = getPropValue<TypeTag, Properties::EnableBrine>();
     static constexpr bool enableDiffusion = getPropValue<TypeTag, Properties::EnableDiffusion>();
 
     using Toolbox = MathToolbox<Evaluation>;
@@ -144,23 +149,32 @@ public:
 
         adaptMassConservationQuantities_(storage, intQuants.pvtRegionIndex());
 
+        // the extension modules which are disabled at compile time are not
+        // instantiated at all.
+        //
         // deal with solvents (if present)
-        SolventModule::addStorage(storage, intQuants);
+        if constexpr (enableSolvent)
+            SolventModule::addStorage(storage, intQuants);
 
         // deal with zFracton (if present)
-        ExtboModule::addStorage(storage, intQuants);
+        if constexpr (enableExtbo)
+            ExtboModule::addStorage(storage, intQuants);
 
         // deal with polymer (if present)
-        PolymerModule::addStorage(storage, intQuants);
+        if constexpr (enablePolymer)
+            PolymerModule::addStorage(storage, intQuants);
 
         // deal with energy (if present)
-        EnergyModule::addStorage(storage, intQuants);
+        if constexpr (enableEnergy)
+            EnergyModule::addStorage(storage, intQuants);
 
         // deal with foam (if present)
-        FoamModule::addStorage(storage, intQuants);
+        if constexpr (enableFoam)
+            FoamModule::addStorage(storage, intQuants);
 
         // deal with salt (if present)
-        BrineModule::addStorage(storage, intQuants);
+        if constexpr (enableBrine)
+            BrineModule::addStorage(storage, intQuants);
     }
 
     /*!
@@ -181,6 +195,10 @@ public:
             if (!FluidSystem::phaseIsActive(phaseIdx))
                 continue;
 
+            // immobile phases do not transport anything
+            if (extQuants.phaseIsImmobile(phaseIdx))
+                continue;
+
             unsigned upIdx = static_cast<unsigned>(extQuants.upstreamIndex(phaseIdx));
             const IntensiveQuantities& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
             unsigned pvtRegionIdx = up.pvtRegionIndex();
@@ -191,24 +209,31 @@ public:
         }
 
         // deal with solvents (if present)
-        SolventModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableSolvent)
+            SolventModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
 
         // deal with zFracton (if present)
-        ExtboModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableExtbo)
+            ExtboModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
 
         // deal with polymer (if present)
-        PolymerModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enablePolymer)
+            PolymerModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
 
         // deal with energy (if present)
-        EnergyModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableEnergy)
+            EnergyModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
 
         // deal with foam (if present)
-        FoamModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableFoam)
+            FoamModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
 
         // deal with salt (if present)
-        BrineModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableBrine)
+            BrineModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
 
-        DiffusionModule::addDiffusiveFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableDiffusion)
+            DiffusionModule::addDiffusiveFlux(flux, elemCtx, scvfIdx, timeIdx);
     }
 
     /*!
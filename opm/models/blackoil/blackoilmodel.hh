@@ -47,6 +47,7 @@
 #include "blackoilbrinemodules.hh"
 #include "blackoilextbomodules.hh"
 #include "blackoildarcyfluxmodule.hh"
+#include "blackoilpvttables.hh"
 
 #include <opm/models/common/multiphasebasemodel.hh>
 #include <opm/models/io/vtkcompositionmodule.hh>
@@ -155,6 +156,8 @@ struct EnablePolymer<TypeTag, TTag::BlackOilModel> { static constexpr bool value
 template<class TypeTag>
 struct EnablePolymerMW<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
 template<class TypeTag>
+struct PolymerShearMaxIterations<TypeTag, TTag::BlackOilModel> { static constexpr int value = 20; };
+template<class TypeTag>
 struct EnableFoam<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
 template<class TypeTag>
 struct EnableBrine<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
@@ -192,6 +195,27 @@ public:
 template<class TypeTag>
 struct BlackoilConserveSurfaceVolume<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
 
+// by default, the PVT properties are directly evaluated by the fluid system. if lookup
+// tables are enabled, they cover the pressure range between 1 and 1000 bar.
+template<class TypeTag>
+struct EnablePvtTables<TypeTag, TTag::BlackOilModel> { static constexpr bool value = false; };
+template<class TypeTag>
+struct PvtTableMinPressure<TypeTag, TTag::BlackOilModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e5;
+};
+template<class TypeTag>
+struct PvtTableMaxPressure<TypeTag, TTag::BlackOilModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1000e5;
+};
+template<class TypeTag>
+struct PvtTableNumPressures<TypeTag, TTag::BlackOilModel> { static constexpr int value = 512; };
+template<class TypeTag>
+struct PvtTableNumDissolutionFactors<TypeTag, TTag::BlackOilModel> { static constexpr int value = 64; };
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -287,6 +311,7 @@ class BlackOilModel
     using PolymerModule = BlackOilPolymerModule<TypeTag>;
     using EnergyModule = BlackOilEnergyModule<TypeTag>;
     using DiffusionModule = BlackOilDiffusionModule<TypeTag, enableDiffusion>;
+    using PvtTables = BlackOilPvtTables<TypeTag>;
 
 public:
     BlackOilModel(Simulator& simulator)
@@ -305,6 +330,7 @@ public:
         PolymerModule::registerParameters();
         EnergyModule::registerParameters();
         DiffusionModule::registerParameters();
+        PvtTables::registerParameters();
 
         // register runtime parameters of the VTK output modules
         VtkBlackOilModule<TypeTag>::registerParameters();
@@ -320,6 +346,16 @@ public:
     static std::string name()
     { return "blackoil"; }
 
+    /*!
+     * \copydoc FvBaseDiscretization::updateBegin
+     */
+    void updateBegin()
+    {
+        ParentType::updateBegin();
+
+        PolymerModule::resizeShearVelocityCache(static_cast<size_t>(this->gridView().size(/*codim=*/0)));
+    }
+
     /*!
      * \copydoc FvBaseDiscretization::primaryVarName
      */
@@ -467,6 +503,18 @@ public:
         return 1.0;
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::applyInitialSolution
+     *
+     * The PVT lookup tables are built here because the fluid system is only
+     * initialized by the problem.
+     */
+    void applyInitialSolution()
+    {
+        PvtTables::init();
+        ParentType::applyInitialSolution();
+    }
+
     /*!
      * \brief Write the current solution for a degree of freedom to a
      *        restart file.
@@ -475,8 +523,8 @@ public:
      *                  be serialized to
      * \param dof The Dune entity which's data should be serialized
      */
-    template <class DofEntity>
-    void serializeEntity(std::ostream& outstream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    void serializeEntity(Stream& outstream, const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
 
@@ -490,8 +538,8 @@ public:
             outstream << priVars[eqIdx] << " ";
 
         // write the pseudo primary variables
-        outstream << priVars.primaryVarsMeaning() << " ";
-        outstream << priVars.pvtRegionIndex() << " ";
+        outstream << static_cast<unsigned>(priVars.primaryVarsMeaning()) << " ";
+        outstream << static_cast<unsigned>(priVars.pvtRegionIndex()) << " ";
 
         SolventModule::serializeEntity(*this, outstream, dof);
         ExtboModule::serializeEntity(*this, outstream, dof);
@@ -507,8 +555,8 @@ public:
      *                  be deserialized from
      * \param dof The Dune entity which's data should be deserialized
      */
-    template <class DofEntity>
-    void deserializeEntity(std::istream& instream,
+    template <class Stream, class DofEntity>
+    void deserializeEntity(Stream& instream,
                            const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
@@ -551,6 +599,7 @@ public:
     template <class Restarter>
     void deserialize(Restarter& res)
     {
+        PvtTables::init();
         ParentType::deserialize(res);
 
         // set the PVT indices of the primary variables. This is also done by writing
@@ -580,6 +629,19 @@ protected:
     friend Discretization;
 */
 
+    /*!
+     * \copydoc FvBaseDiscretization::extrapolationAllowed_
+     */
+    bool extrapolationAllowed_(const PrimaryVariables& priVars,
+                               const PrimaryVariables& prevPriVars) const
+    {
+        // the meaning of the primary variables changes if a phase appears or
+        // disappears
+        return
+            priVars.primaryVarsMeaning() == prevPriVars.primaryVarsMeaning()
+            && priVars.pvtRegionIndex() == prevPriVars.pvtRegionIndex();
+    }
+
     template <class Context>
     void supplementInitialSolution_(PrimaryVariables& priVars,
                                     const Context& context,
@@ -35,6 +35,11 @@
 
 #include <opm/material/common/Unused.hpp>
 
+#include <array>
+#include <cassert>
+#include <limits>
+#include <vector>
+
 namespace Opm::Properties {
 
 template <class TypeTag, class MyTypeTag>
@@ -113,6 +118,7 @@ class BlackOilNewtonMethod : public GetPropType<TypeTag, Properties::DiscNewtonM
     using Indices = GetPropType<TypeTag, Properties::Indices>;
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     static const unsigned numEq = getPropValue<TypeTag, Properties::NumEq>();
 
@@ -127,6 +133,10 @@ public:
         tempMax_ = EWOMS_GET_PARAM(TypeTag, Scalar, TemperatureMax);
         tempMin_ = EWOMS_GET_PARAM(TypeTag, Scalar, TemperatureMin);
 
+        numPriVarsSwitched_ = 0;
+        numPriVarsSwitchedTo_.fill(0);
+        updateFailedSlot_ = -1;
+        numSwitchedSlot_ = -1;
     }
 
     /*!
@@ -138,6 +148,7 @@ public:
 
         wasSwitched_.resize(this->model().numTotalDof());
         std::fill(wasSwitched_.begin(), wasSwitched_.end(), false);
+        threadNumPriVarsSwitched_.resize(ThreadManager::maxThreads());
     }
 
     /*!
@@ -164,41 +175,66 @@ public:
     unsigned numPriVarsSwitched() const
     { return numPriVarsSwitched_; }
 
+    /*!
+     * \brief Returns the number of degrees of freedom for which the primary variables
+     *        were switched to a given meaning in the most recent iteration.
+     */
+    unsigned numPriVarsSwitchedTo(typename PrimaryVariables::PrimaryVarsMeaning meaning) const
+    {
+        if (meaning >= numSwitchTargets)
+            return 0;
+        return numPriVarsSwitchedTo_[meaning];
+    }
+
 protected:
     friend NewtonMethod<TypeTag>;
     friend ParentType;
 
     /*!
-     * \copydoc FvBaseNewtonMethod::beginIteration_
+     * \copydoc NewtonMethod::finishIterationChecks_
+     *
+     * In addition, this method adds up the number of DOF for which the
+     * interpretation changed over all processes.
      */
-    void beginIteration_()
+    void finishIterationChecks_()
     {
-        numPriVarsSwitched_ = 0;
-        ParentType::beginIteration_();
+        this->iterationChecks_.finish();
+
+        if (updateFailedSlot_ >= 0) {
+            bool updateFailed = this->iterationChecks_.value(static_cast<unsigned>(updateFailedSlot_)) > 0;
+            numPriVarsSwitched_ = 0;
+            for (unsigned targetIdx = 0; targetIdx < numSwitchTargets; ++targetIdx) {
+                unsigned slotIdx = static_cast<unsigned>(numSwitchedSlot_) + targetIdx;
+                numPriVarsSwitchedTo_[targetIdx] = this->iterationChecks_.value(slotIdx);
+                numPriVarsSwitched_ += numPriVarsSwitchedTo_[targetIdx];
+            }
+            updateFailedSlot_ = -1;
+            numSwitchedSlot_ = -1;
+
+            if (updateFailed) {
+                this->resetIterationChecks_();
+                throw NumericalIssue("A process did not succeed in adapting the primary variables");
+            }
+
+            this->endIterMsg() << ", num switched=" << numPriVarsSwitched_;
+            if (numPriVarsSwitched_ > 0)
+                this->endIterMsg() << " (to Sg: " << numPriVarsSwitchedTo_[PrimaryVariables::Sw_po_Sg]
+                                   << ", to Rs: " << numPriVarsSwitchedTo_[PrimaryVariables::Sw_po_Rs]
+                                   << ", to Rv: " << numPriVarsSwitchedTo_[PrimaryVariables::Sw_pg_Rv]
+                                   << ")";
+        }
+
+        ParentType::finishIterationChecks_();
     }
 
     /*!
-     * \copydoc FvBaseNewtonMethod::endIteration_
+     * \copydoc NewtonMethod::resetIterationChecks_
      */
-    void endIteration_(SolutionVector& uCurrentIter,
-                       const SolutionVector& uLastIter)
+    void resetIterationChecks_()
     {
-#if HAVE_MPI
-        // in the MPI enabled case we need to add up the number of DOF
-        // for which the interpretation changed over all processes.
-        int localSwitched = numPriVarsSwitched_;
-        MPI_Allreduce(&localSwitched,
-                      &numPriVarsSwitched_,
-                      /*num=*/1,
-                      MPI_INT,
-                      MPI_SUM,
-                      MPI_COMM_WORLD);
-#endif // HAVE_MPI
-
-        this->simulator_.model().newtonMethod().endIterMsg()
-            << ", num switched=" << numPriVarsSwitched_;
-
-        ParentType::endIteration_(uCurrentIter, uLastIter);
+        updateFailedSlot_ = -1;
+        numSwitchedSlot_ = -1;
+        ParentType::resetIterationChecks_();
     }
 
 public:
@@ -209,6 +245,8 @@ public:
     {
         const auto& comm = this->simulator_.gridView().comm();
 
+        for (auto& threadNumSwitched : threadNumPriVarsSwitched_)
+            threadNumSwitched.value.fill(0);
         int succeeded;
         try {
             ParentType::update_(nextSolution,
@@ -222,12 +260,21 @@ public:
                       << comm.rank() << "\n";
             succeeded = 0;
         }
-        succeeded = comm.min(succeeded);
-
-        if (!succeeded)
-            throw NumericalIssue("A process did not succeed in adapting the primary variables");
 
-        numPriVarsSwitched_ = comm.sum(numPriVarsSwitched_);
+        // the primary variables are updated by multiple threads, each of which counts
+        // the switches it has done
+        numPriVarsSwitchedTo_.fill(0);
+        for (const auto& threadNumSwitched : threadNumPriVarsSwitched_)
+            for (unsigned targetIdx = 0; targetIdx < numSwitchTargets; ++targetIdx)
+                numPriVarsSwitchedTo_[targetIdx] += threadNumSwitched.value[targetIdx];
+
+        // all of them are reduced over all processes together with the remaining
+        // checks of the iteration, see finishIterationChecks_(). the slots of the
+        // switch counts are consecutive.
+        updateFailedSlot_ = static_cast<int>(this->iterationChecks_.add(succeeded ? 0 : 1));
+        numSwitchedSlot_ = static_cast<int>(this->iterationChecks_.add(numPriVarsSwitchedTo_[0]));
+        for (unsigned targetIdx = 1; targetIdx < numSwitchTargets; ++targetIdx)
+            this->iterationChecks_.add(numPriVarsSwitchedTo_[targetIdx]);
     }
 
 protected:
@@ -380,8 +427,11 @@ protected:
         else
             wasSwitched_[globalDofIdx] = nextValue.adaptPrimaryVariables(this->problem(), globalDofIdx);
 
-        if (wasSwitched_[globalDofIdx])
-            ++ numPriVarsSwitched_;
+        if (wasSwitched_[globalDofIdx]) {
+            unsigned targetIdx = static_cast<unsigned>(nextValue.primaryVarsMeaning());
+            assert(targetIdx < numSwitchTargets);
+            ++ threadNumPriVarsSwitched_[ThreadManager::threadId()].value[targetIdx];
+        }
         if(projectSaturations_){
             nextValue.chopAndNormalizeSaturations();
         }
@@ -389,8 +439,37 @@ protected:
         nextValue.checkDefined();
     }
 
+    /*!
+     * \copydoc FvBaseNewtonMethod::primaryVariablesChange_
+     *
+     * If the meaning of the primary variables was switched, the cached intensive
+     * quantities of the degree of freedom are always stale.
+     */
+    Scalar primaryVariablesChange_(unsigned globalDofIdx,
+                                   const PrimaryVariables& nextValue,
+                                   const PrimaryVariables& currentValue) const
+    {
+        if (wasSwitched_[globalDofIdx])
+            return std::numeric_limits<Scalar>::infinity();
+
+        return ParentType::primaryVariablesChange_(globalDofIdx, nextValue, currentValue);
+    }
+
 private:
+    // the meanings of the primary variables to which a degree of freedom can be
+    // switched, i.e., Sw_po_Sg, Sw_po_Rs and Sw_pg_Rv
+    static constexpr unsigned numSwitchTargets = PrimaryVariables::OnePhase_p;
+
+    // the number of switches to each meaning done by a thread, padded to a cache line
+    // to avoid false sharing
+    struct alignas(64) ThreadNumSwitched
+    { std::array<int, numSwitchTargets> value{}; };
+
     int numPriVarsSwitched_;
+    std::array<int, numSwitchTargets> numPriVarsSwitchedTo_;
+    std::vector<ThreadNumSwitched> threadNumPriVarsSwitched_;
+    int updateFailedSlot_;
+    int numSwitchedSlot_;
 
     Scalar priVarOscilationThreshold_;
     Scalar dpMaxRel_;
@@ -401,8 +480,9 @@ private:
     Scalar tempMin_;
 
     // keep track of cells where the primary variable meaning has changed
-    // to detect and hinder oscillations
-    std::vector<bool> wasSwitched_;
+    // to detect and hinder oscillations. this is not a std::vector<bool> because its
+    // entries are written concurrently by multiple threads.
+    std::vector<unsigned char> wasSwitched_;
 };
 } // namespace Opm
 
@@ -31,6 +31,8 @@
 #include "blackoilproperties.hh"
 #include <opm/models/io/vtkblackoilpolymermodule.hh>
 #include <opm/models/common/quantitycallbacks.hh>
+#include <opm/models/utils/segmentcachedeval.hh>
+#include <opm/models/utils/instrumentation.hh>
 
 #include <opm/material/common/Tabulated1DFunction.hpp>
 #include <opm/material/common/IntervalTabulated2DFunction.hpp>
@@ -51,7 +53,11 @@
 
 #include <dune/common/fvector.hh>
 
+#include <array>
+#include <cmath>
+#include <limits>
 #include <string>
+#include <vector>
 
 namespace Opm {
 /*!
@@ -508,6 +514,10 @@ public:
             return;
 
         VtkBlackOilPolymerModule<TypeTag>::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, int, PolymerShearMaxIterations,
+                             "The maximum number of Newton iterations to compute the "
+                             "shear-thinning factor of a face");
     }
 
     /*!
@@ -694,8 +704,8 @@ public:
         return static_cast<Scalar>(0.0);
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void serializeEntity(const Model& model, Stream& outstream, const DofEntity& dof)
     {
         if (!enablePolymer)
             return;
@@ -706,8 +716,8 @@ public:
         outstream << priVars[polymerMoleWeightIdx];
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void deserializeEntity(Model& model, Stream& instream, const DofEntity& dof)
     {
         if (!enablePolymer)
             return;
@@ -834,6 +844,27 @@ public:
     static Evaluation computeShearFactor(const Evaluation& polymerConcentration,
                                          unsigned pvtnumRegionIdx,
                                          const Evaluation& v0)
+    {
+        Scalar logShearVelocity = std::numeric_limits<Scalar>::quiet_NaN();
+        return computeShearFactor(polymerConcentration, pvtnumRegionIdx, v0, logShearVelocity);
+    }
+
+    /*!
+     * \brief Computes the shear factor starting with the sheared velocity of a previous
+     *        computation.
+     *
+     * If logShearVelocity is finite, it is used as the initial value of the Newton
+     * method for the logarithm of the sheared velocity. This is usually the result of
+     * the computation for the same face in the previous iteration, which is close to
+     * the solution. If the Newton method does not converge from there, it is restarted
+     * from the logarithm of the unsheared velocity. On return, logShearVelocity holds
+     * the result.
+     */
+    template <class Evaluation>
+    static Evaluation computeShearFactor(const Evaluation& polymerConcentration,
+                                         unsigned pvtnumRegionIdx,
+                                         const Evaluation& v0,
+                                         Scalar& logShearVelocity)
     {
         using ToolboxLocal = MathToolbox<Evaluation>;
 
@@ -873,35 +904,104 @@ public:
 
         // Set up the function
         // u = log(v)
-        auto F = [&logShearEffectMultiplier, &v0AbsLog](const Evaluation& u) {
-            return u + logShearEffectMultiplier.eval(u, true) - v0AbsLog;
+        unsigned segmentIdx = 0;
+        auto F = [&logShearEffectMultiplier, &v0AbsLog, &segmentIdx](const Evaluation& u) {
+            return u + segmentCachedEval(logShearEffectMultiplier, u, segmentIdx) - v0AbsLog;
         };
         // and its derivative
         auto dF = [&logShearEffectMultiplier](const Evaluation& u) {
             return 1 + logShearEffectMultiplier.evalDerivative(u, true);
         };
 
-        // Solve F = 0 using Newton
-        // Use log(v0) as initial value for u
-        auto u = v0AbsLog;
-        bool converged = false;
-        // TODO make this into parameters
-        for (int i = 0; i < 20; ++i) {
-            auto f = F(u);
-            auto df = dF(u);
-            u -= f/df;
-            if (std::abs(scalarValue(f)) < 1e-12) {
-                converged = true;
-                break;
+        // Solve F = 0 using Newton. Since F is piecewise linear, the derivatives of the
+        // result are correct after a single step irrespective of the initial value.
+        static const auto maxIterations = EWOMS_GET_PARAM_HANDLE(TypeTag, int, PolymerShearMaxIterations);
+        unsigned numIterations = 0;
+        auto newtonSolve = [&F, &dF, &numIterations](Evaluation& u) {
+            for (int i = 0; i < *maxIterations; ++i) {
+                ++numIterations;
+                auto f = F(u);
+                auto df = dF(u);
+                u -= f/df;
+                if (std::abs(scalarValue(f)) < 1e-12)
+                    return true;
             }
+            return false;
+        };
+
+        Evaluation u;
+        bool converged = false;
+        bool warmStarted = std::isfinite(logShearVelocity);
+        if (warmStarted) {
+            u = ToolboxLocal::createConstant(v0, logShearVelocity);
+            converged = newtonSolve(u);
+        }
+        if (!converged) {
+            // use log(v0) as initial value for u
+            u = v0AbsLog;
+            converged = newtonSolve(u);
         }
+
+        if (Instrumentation::enabled()) {
+            static const unsigned solvesRegionIdx =
+                Instrumentation::regionIndex("polymer shear factor solves");
+            static const unsigned warmStartsRegionIdx =
+                Instrumentation::regionIndex("polymer shear factor warm starts");
+            static const unsigned iterationsRegionIdx =
+                Instrumentation::regionIndex("polymer shear factor iterations");
+            Instrumentation::addCount(solvesRegionIdx, 1);
+            Instrumentation::addCount(warmStartsRegionIdx, warmStarted ? 1 : 0);
+            Instrumentation::addCount(iterationsRegionIdx, numIterations);
+        }
+
         if (!converged) {
             throw std::runtime_error("Not able to compute shear velocity. \n");
         }
 
+        logShearVelocity = scalarValue(u);
+
         // return the shear factor
-        return exp(logShearEffectMultiplier.eval(u, /*extrapolate=*/true));
+        return exp(segmentCachedEval(logShearEffectMultiplier, u, segmentIdx));
+
+    }
+
+    /*!
+     * \brief Set the number of elements for which the sheared velocities of the faces
+     *        are remembered.
+     *
+     * This discards the remembered velocities if the number of elements changes.
+     */
+    static void resizeShearVelocityCache(size_t numElements)
+    {
+        if (!enablePolymer || !hasPlyshlog_)
+            return;
 
+        if (shearVelocityCache_.size() != numElements) {
+            shearVelocityCache_.clear();
+            shearVelocityCache_.resize(numElements);
+        }
+    }
+
+    /*!
+     * \brief Returns the logarithms of the sheared water and polymer velocities which
+     *        were computed for a face by the last linearization.
+     *
+     * The entries are NaN if no velocity was computed so far. The faces are identified
+     * by the global index of their interior element and their index within the
+     * element's stencil. If the cache has not been sized for the element, nullptr is
+     * returned. The entries of different elements may be accessed concurrently.
+     */
+    static std::array<Scalar, 2>* shearVelocities(unsigned elemIdx, unsigned scvfIdx)
+    {
+        if (elemIdx >= shearVelocityCache_.size())
+            return nullptr;
+
+        auto& elemEntries = shearVelocityCache_[elemIdx];
+        if (scvfIdx >= elemEntries.size()) {
+            const Scalar nan = std::numeric_limits<Scalar>::quiet_NaN();
+            elemEntries.resize(scvfIdx + 1, std::array<Scalar, 2>{nan, nan});
+        }
+        return &elemEntries[scvfIdx];
     }
 
     const Scalar molarMass() const
@@ -922,6 +1022,7 @@ private:
     static std::vector<std::vector<Scalar>> plyshlogShearEffectRefMultiplier_;
     static std::vector<std::vector<Scalar>> plyshlogShearEffectRefLogVelocity_;
     static std::vector<Scalar> shrate_;
+    static std::vector<std::vector<std::array<Scalar, 2>>> shearVelocityCache_;
     static bool hasShrate_;
     static bool hasPlyshlog_;
 
@@ -982,6 +1083,10 @@ template <class TypeTag, bool enablePolymerV>
 std::vector<typename BlackOilPolymerModule<TypeTag, enablePolymerV>::Scalar>
 BlackOilPolymerModule<TypeTag, enablePolymerV>::shrate_;
 
+template <class TypeTag, bool enablePolymerV>
+std::vector<std::vector<std::array<typename BlackOilPolymerModule<TypeTag, enablePolymerV>::Scalar, 2>>>
+BlackOilPolymerModule<TypeTag, enablePolymerV>::shearVelocityCache_;
+
 template <class TypeTag, bool enablePolymerV>
 bool
 BlackOilPolymerModule<TypeTag, enablePolymerV>::hasShrate_;
@@ -1036,6 +1141,16 @@ class BlackOilPolymerIntensiveQuantities
 
 
 public:
+    /*!
+     * \brief Start the table searches at the segments which were used for the degree
+     *        of freedom by a previous update.
+     */
+    void polymerSegmentsFromHint_(const BlackOilPolymerIntensiveQuantities& hint)
+    {
+        plyadsSegmentIdx_ = hint.plyadsSegmentIdx_;
+        plyviscSegmentIdx_ = hint.plyviscSegmentIdx_;
+        plyviscMaxSegmentIdx_ = hint.plyviscMaxSegmentIdx_;
+    }
 
     /*!
      * \brief Update the intensive properties needed to handle polymers from the
@@ -1057,7 +1172,7 @@ public:
         // permeability reduction due to polymer
         const Scalar& maxAdsorbtion = PolymerModule::plyrockMaxAdsorbtion(elemCtx, dofIdx, timeIdx);
         const auto& plyadsAdsorbedPolymer = PolymerModule::plyadsAdsorbedPolymer(elemCtx, dofIdx, timeIdx);
-        polymerAdsorption_ = plyadsAdsorbedPolymer.eval(polymerConcentration_, /*extrapolate=*/true);
+        polymerAdsorption_ = segmentCachedEval(plyadsAdsorbedPolymer, polymerConcentration_, plyadsSegmentIdx_);
         if (PolymerModule::plyrockAdsorbtionIndex(elemCtx, dofIdx, timeIdx) == PolymerModule::NoDesorption) {
             const Scalar& maxPolymerAdsorption = elemCtx.problem().maxPolymerAdsorption(elemCtx, dofIdx, timeIdx);
             polymerAdsorption_ = std::max(Evaluation(maxPolymerAdsorption) , polymerAdsorption_);
@@ -1072,11 +1187,13 @@ public:
             const auto& fs = asImp_().fluidState_;
             const Evaluation& muWater = fs.viscosity(waterPhaseIdx);
             const auto& viscosityMultiplier = PolymerModule::plyviscViscosityMultiplierTable(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityMixture = viscosityMultiplier.eval(polymerConcentration_, /*extrapolate=*/true) * muWater;
+            const Evaluation viscosityMixture =
+                segmentCachedEval(viscosityMultiplier, polymerConcentration_, plyviscSegmentIdx_) * muWater;
 
             // Do the Todd-Longstaff mixing
             const Scalar plymixparToddLongstaff = PolymerModule::plymixparToddLongstaff(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityPolymer = viscosityMultiplier.eval(cmax, /*extrapolate=*/true) * muWater;
+            const Evaluation viscosityPolymer =
+                segmentCachedEval(viscosityMultiplier, cmax, plyviscMaxSegmentIdx_) * muWater;
             const Evaluation viscosityPolymerEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(viscosityPolymer, 1.0 - plymixparToddLongstaff);
             const Evaluation viscosityWaterEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(muWater, 1.0 - plymixparToddLongstaff);
 
@@ -1151,6 +1268,11 @@ protected:
     Evaluation polymerViscosityCorrection_;
     Evaluation waterViscosityCorrection_;
 
+    // the segments of the PLYADS and PLYVISC tables which were used by the last update.
+    // they are usually still valid during the next Newton iteration.
+    unsigned plyadsSegmentIdx_ = 0;
+    unsigned plyviscSegmentIdx_ = 0;
+    unsigned plyviscMaxSegmentIdx_ = 0;
 
 };
 
@@ -1162,6 +1284,10 @@ class BlackOilPolymerIntensiveQuantities<TypeTag, false>
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
 
 public:
+    template <class IntensiveQuantities>
+    void polymerSegmentsFromHint_(const IntensiveQuantities& hint OPM_UNUSED)
+    { }
+
     void polymerPropertiesUpdate_(const ElementContext& elemCtx OPM_UNUSED,
                                   unsigned scvIdx OPM_UNUSED,
                                   unsigned timeIdx OPM_UNUSED)
@@ -1263,6 +1389,18 @@ public:
         const auto& intQuantsIn = elemCtx.intensiveQuantities(interiorDofIdx, timeIdx);
         const auto& intQuantsEx = elemCtx.intensiveQuantities(exteriorDofIdx, timeIdx);
 
+        // without polymer, the water is not subject to shear thinning
+        if (scalarValue(intQuantsIn.polymerConcentration()) <= 0.0
+            && scalarValue(intQuantsEx.polymerConcentration()) <= 0.0)
+        {
+            if (Instrumentation::enabled()) {
+                static const unsigned skippedRegionIdx =
+                    Instrumentation::regionIndex("skipped polymer shear factor solves");
+                Instrumentation::addCount(skippedRegionIdx, 1);
+            }
+            return;
+        }
+
         // compute water velocity from flux
         Evaluation poroAvg = intQuantsIn.porosity()*0.5 + intQuantsEx.porosity()*0.5;
         unsigned pvtnumRegionIdx = elemCtx.problem().pvtRegionIndex(elemCtx, scvfIdx, timeIdx);
@@ -1292,15 +1430,28 @@ public:
             }
         }
 
-        // compute share factors for water and polymer
+        // compute share factors for water and polymer. the sheared velocities of the
+        // last linearization are used as initial guesses if they are available.
+        unsigned elemIdx = elemCtx.globalSpaceIndex(/*spaceIdx=*/0, timeIdx);
+        auto* shearVelocities = PolymerModule::shearVelocities(elemIdx, scvfIdx);
+        const Scalar nan = std::numeric_limits<Scalar>::quiet_NaN();
+        std::array<Scalar, 2> logShearVelocities{nan, nan};
+        if (shearVelocities)
+            logShearVelocities = *shearVelocities;
+
         waterShearFactor_ =
             PolymerModule::computeShearFactor(up.polymerConcentration(),
                                               pvtnumRegionIdx,
-                                              waterVolumeVelocity);
+                                              waterVolumeVelocity,
+                                              logShearVelocities[0]);
         polymerShearFactor_ =
             PolymerModule::computeShearFactor(up.polymerConcentration(),
                                               pvtnumRegionIdx,
-                                              waterVolumeVelocity*up.polymerViscosityCorrection());
+                                              waterVolumeVelocity*up.polymerViscosityCorrection(),
+                                              logShearVelocities[1]);
+
+        if (shearVelocities)
+            *shearVelocities = logShearVelocities;
 
     }
 
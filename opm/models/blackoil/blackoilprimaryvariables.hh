@@ -358,7 +358,8 @@ public:
      */
     bool adaptPrimaryVariables(const Problem& problem, unsigned globalDofIdx, Scalar eps = 0.0)
     {
-        static const Scalar thresholdWaterFilledCell = 1.0 - eps;
+        // this must not be static because eps differs between the calls
+        const Scalar thresholdWaterFilledCell = 1.0 - eps;
 
         // this function accesses quite a few black-oil specific low-level functions
         // directly for better performance (instead of going the canonical way through
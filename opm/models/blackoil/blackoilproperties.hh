@@ -49,6 +49,10 @@ struct EnablePolymer { using type = UndefinedProperty; };
 //! Enable the tracking polymer molecular weight tracking and related functionalities
 template<class TypeTag, class MyTypeTag>
 struct EnablePolymerMW { using type = UndefinedProperty; };
+//! The maximum number of Newton iterations to compute the shear-thinning factor of a
+//! face for polymer
+template<class TypeTag, class MyTypeTag>
+struct PolymerShearMaxIterations { using type = UndefinedProperty; };
 //! Enable surface volume scaling
 template<class TypeTag, class MyTypeTag>
 struct BlackoilConserveSurfaceVolume { using type = UndefinedProperty; };
@@ -75,6 +79,27 @@ struct EnableTemperature { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct BlackOilEnergyScalingFactor { using type = UndefinedProperty; };
 
+//! Use dense lookup tables instead of the fluid system for the PVT properties
+template<class TypeTag, class MyTypeTag>
+struct EnablePvtTables { using type = UndefinedProperty; };
+
+//! The smallest pressure covered by the PVT lookup tables [Pa]
+template<class TypeTag, class MyTypeTag>
+struct PvtTableMinPressure { using type = UndefinedProperty; };
+
+//! The largest pressure covered by the PVT lookup tables [Pa]
+template<class TypeTag, class MyTypeTag>
+struct PvtTableMaxPressure { using type = UndefinedProperty; };
+
+//! The number of pressure sample points of the PVT lookup tables
+template<class TypeTag, class MyTypeTag>
+struct PvtTableNumPressures { using type = UndefinedProperty; };
+
+//! The number of sample points for the gas dissolution and oil vaporization factors of
+//! the PVT lookup tables
+template<class TypeTag, class MyTypeTag>
+struct PvtTableNumDissolutionFactors { using type = UndefinedProperty; };
+
 
 } // namespace Opm::Properties
 
@@ -0,0 +1,492 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilPvtTables
+ */
+#ifndef EWOMS_BLACK_OIL_PVT_TABLES_HH
+#define EWOMS_BLACK_OIL_PVT_TABLES_HH
+
+#include "blackoilproperties.hh"
+
+#include <opm/models/utils/parametersystem.hh>
+
+#include <opm/material/fluidstates/BlackOilFluidState.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \ingroup BlackOilModel
+ *
+ * \brief Optional dense lookup tables for the PVT properties of the black-oil model.
+ *
+ * If enabled, the formation volume factors, the viscosities, the saturated dissolution
+ * factors and the saturation pressures of all PVT regions are sampled from the fluid
+ * system on a uniformly spaced grid of pressures (and of dissolution factors for the
+ * quantities which depend on the fluid composition) once the fluid system has been
+ * initialized. During the simulation, these quantities are then obtained by linear or
+ * bilinear interpolation. Because the sample points are equidistant, finding the
+ * relevant interval does not require a search and the interpolation only involves a
+ * few multiply-add operations without any data dependent branches. Outside of the
+ * tabulated range, the values are extrapolated linearly.
+ *
+ * The tables exhibit an interpolation error which depends on their resolution, and
+ * they assume isothermal conditions. For this reason, they are not available for
+ * models which consider temperature, salt or the extended black-oil formulation.
+ */
+template <class TypeTag>
+class BlackOilPvtTables
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    using FluidState = BlackOilFluidState<Scalar,
+                                          FluidSystem,
+                                          /*enableTemperature=*/false,
+                                          /*enableEnergy=*/false,
+                                          /*enableDissolution=*/true,
+                                          /*enableBrine=*/false,
+                                          Indices::numPhases>;
+    using ParameterCache = typename FluidSystem::template ParameterCache<Scalar>;
+
+    struct RegionTables
+    {
+        Scalar minPressure;
+        Scalar invPressureSpacing;
+        unsigned numPressures;
+
+        Scalar invRsSpacing;
+        unsigned numRs;
+
+        Scalar invRvSpacing;
+        unsigned numRv;
+
+        // quantities which only depend on the pressure
+        std::vector<Scalar> saturatedRs;
+        std::vector<Scalar> saturatedRv;
+        std::vector<Scalar> waterInvB;
+        std::vector<Scalar> waterMu;
+
+        // quantities which depend on the pressure and on the gas dissolution factor
+        // (oil) or the oil vaporization factor (gas). The pressure is the slow index.
+        std::vector<Scalar> oilInvB;
+        std::vector<Scalar> oilMu;
+        std::vector<Scalar> gasInvB;
+        std::vector<Scalar> gasMu;
+
+        // quantities which only depend on the fluid composition
+        std::vector<Scalar> oilSaturationPressure;
+        std::vector<Scalar> gasSaturationPressure;
+    };
+
+public:
+    //! Specifies whether the tables can be used with the model at all
+    static constexpr bool applicable =
+        !getPropValue<TypeTag, Properties::EnableTemperature>()
+        && !getPropValue<TypeTag, Properties::EnableEnergy>()
+        && !getPropValue<TypeTag, Properties::EnableBrine>()
+        && !getPropValue<TypeTag, Properties::EnableExtbo>();
+
+    /*!
+     * \brief Register all run-time parameters for the PVT tables.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnablePvtTables,
+                             "Use dense lookup tables for the PVT properties of the "
+                             "black-oil model instead of evaluating the fluid system");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PvtTableMinPressure,
+                             "The smallest pressure covered by the PVT lookup tables [Pa]");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PvtTableMaxPressure,
+                             "The largest pressure covered by the PVT lookup tables [Pa]");
+        EWOMS_REGISTER_PARAM(TypeTag, int, PvtTableNumPressures,
+                             "The number of pressure sample points of the PVT lookup tables");
+        EWOMS_REGISTER_PARAM(TypeTag, int, PvtTableNumDissolutionFactors,
+                             "The number of sample points for the gas dissolution and oil "
+                             "vaporization factors of the PVT lookup tables");
+    }
+
+    /*!
+     * \brief Build the lookup tables for all PVT regions.
+     *
+     * This method must be called after the fluid system has been fully initialized. If
+     * the tables are disabled, it does nothing.
+     */
+    static void init()
+    {
+        enabled_ = EWOMS_GET_PARAM(TypeTag, bool, EnablePvtTables);
+        regionTables_.clear();
+        if (!enabled_)
+            return;
+
+        if (!applicable)
+            throw std::runtime_error("Tabulated PVT properties are not available for black-oil "
+                                     "models which consider temperature, salt or the extended "
+                                     "black-oil formulation");
+
+        Scalar minPressure = EWOMS_GET_PARAM(TypeTag, Scalar, PvtTableMinPressure);
+        Scalar maxPressure = EWOMS_GET_PARAM(TypeTag, Scalar, PvtTableMaxPressure);
+        int numPressures = EWOMS_GET_PARAM(TypeTag, int, PvtTableNumPressures);
+        int numDissolutionFactors = EWOMS_GET_PARAM(TypeTag, int, PvtTableNumDissolutionFactors);
+        if (!(maxPressure > minPressure))
+            throw std::runtime_error("The maximum pressure of the PVT tables must be larger "
+                                     "than their minimum pressure");
+        if (numPressures < 2 || numDissolutionFactors < 2)
+            throw std::runtime_error("The PVT tables require at least two sample points "
+                                     "for each of their axes");
+
+        tabulatesSaturatedFactors_ = true;
+        regionTables_.resize(FluidSystem::numRegions());
+        for (unsigned regionIdx = 0; regionIdx < regionTables_.size(); ++regionIdx)
+            initRegion_(regionIdx,
+                        minPressure,
+                        maxPressure,
+                        static_cast<unsigned>(numPressures),
+                        static_cast<unsigned>(numDissolutionFactors));
+    }
+
+    /*!
+     * \brief Returns true iff the PVT properties ought to be taken from the tables.
+     */
+    static bool enabled()
+    { return applicable && enabled_; }
+
+    /*!
+     * \brief Returns true iff the saturated dissolution factors are tabulated.
+     *
+     * This is not the case if they depend on the oil saturation, i.e., if the VAPPARS
+     * mechanism is used.
+     */
+    static bool tabulatesSaturatedFactors()
+    { return tabulatesSaturatedFactors_; }
+
+    /*!
+     * \brief Returns the inverse formation volume factor of a fluid phase.
+     */
+    template <class FluidStateT, class LhsEval = typename FluidStateT::Scalar>
+    static LhsEval inverseFormationVolumeFactor(const FluidStateT& fluidState,
+                                                unsigned phaseIdx,
+                                                unsigned regionIdx)
+    {
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& t = regionTables_[regionIdx];
+        switch (phaseIdx) {
+        case oilPhaseIdx:
+            return bilinear_(t.oilInvB, t, t.numRs, t.invRsSpacing, p, decay<LhsEval>(fluidState.Rs()));
+        case gasPhaseIdx:
+            return bilinear_(t.gasInvB, t, t.numRv, t.invRvSpacing, p, decay<LhsEval>(fluidState.Rv()));
+        default:
+            return linear_(t.waterInvB, t, p);
+        }
+    }
+
+    /*!
+     * \brief Returns the dynamic viscosity of a fluid phase [Pa s].
+     */
+    template <class FluidStateT, class LhsEval = typename FluidStateT::Scalar>
+    static LhsEval viscosity(const FluidStateT& fluidState,
+                             unsigned phaseIdx,
+                             unsigned regionIdx)
+    {
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& t = regionTables_[regionIdx];
+        switch (phaseIdx) {
+        case oilPhaseIdx:
+            return bilinear_(t.oilMu, t, t.numRs, t.invRsSpacing, p, decay<LhsEval>(fluidState.Rs()));
+        case gasPhaseIdx:
+            return bilinear_(t.gasMu, t, t.numRv, t.invRvSpacing, p, decay<LhsEval>(fluidState.Rv()));
+        default:
+            return linear_(t.waterMu, t, p);
+        }
+    }
+
+    /*!
+     * \brief Returns the gas dissolution factor of saturated oil (phaseIdx is the oil
+     *        phase) or the oil vaporization factor of saturated gas (phaseIdx is the gas
+     *        phase).
+     */
+    template <class FluidStateT, class LhsEval = typename FluidStateT::Scalar>
+    static LhsEval saturatedDissolutionFactor(const FluidStateT& fluidState,
+                                              unsigned phaseIdx,
+                                              unsigned regionIdx)
+    {
+        const auto& p = decay<LhsEval>(fluidState.pressure(phaseIdx));
+        const auto& t = regionTables_[regionIdx];
+        if (phaseIdx == oilPhaseIdx)
+            return linear_(t.saturatedRs, t, p);
+        return linear_(t.saturatedRv, t, p);
+    }
+
+    /*!
+     * \brief Returns the bubble point pressure of oil for a given gas dissolution factor.
+     */
+    template <class Evaluation>
+    static Evaluation oilSaturationPressure(unsigned regionIdx, const Evaluation& Rs)
+    {
+        const auto& t = regionTables_[regionIdx];
+        unsigned idx;
+        Evaluation alpha;
+        segment_(Rs, Scalar(0.0), t.invRsSpacing, t.numRs, idx, alpha);
+        return lerp_(t.oilSaturationPressure.data() + idx, alpha);
+    }
+
+    /*!
+     * \brief Returns the dew point pressure of gas for a given oil vaporization factor.
+     */
+    template <class Evaluation>
+    static Evaluation gasSaturationPressure(unsigned regionIdx, const Evaluation& Rv)
+    {
+        const auto& t = regionTables_[regionIdx];
+        unsigned idx;
+        Evaluation alpha;
+        segment_(Rv, Scalar(0.0), t.invRvSpacing, t.numRv, idx, alpha);
+        return lerp_(t.gasSaturationPressure.data() + idx, alpha);
+    }
+
+private:
+    static void initRegion_(unsigned regionIdx,
+                            Scalar minPressure,
+                            Scalar maxPressure,
+                            unsigned numPressures,
+                            unsigned numDissolutionFactors)
+    {
+        bool oilActive = FluidSystem::phaseIsActive(oilPhaseIdx);
+        bool gasActive = FluidSystem::phaseIsActive(gasPhaseIdx);
+        bool waterActive = FluidSystem::phaseIsActive(waterPhaseIdx);
+        bool dissolvedGas = oilActive && gasActive && FluidSystem::enableDissolvedGas();
+        bool vaporizedOil = oilActive && gasActive && FluidSystem::enableVaporizedOil();
+
+        auto& t = regionTables_[regionIdx];
+        Scalar pressureSpacing = (maxPressure - minPressure)/(numPressures - 1);
+        t.minPressure = minPressure;
+        t.invPressureSpacing = 1.0/pressureSpacing;
+        t.numPressures = numPressures;
+        t.numRs = numDissolutionFactors;
+        t.numRv = numDissolutionFactors;
+
+        FluidState fs;
+        fs.setPvtRegionIndex(regionIdx);
+        for (unsigned phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx)
+            if (FluidSystem::phaseIsActive(phaseIdx))
+                fs.setSaturation(phaseIdx, 0.0);
+        if (oilActive)
+            fs.setSaturation(oilPhaseIdx, 1.0);
+        fs.setRs(0.0);
+        fs.setRv(0.0);
+
+        ParameterCache paramCache;
+        paramCache.setRegionIndex(regionIdx);
+        if (oilActive)
+            paramCache.setMaxOilSat(1.0);
+
+        const auto setPressure = [&fs](Scalar p) {
+            for (unsigned phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx)
+                if (FluidSystem::phaseIsActive(phaseIdx))
+                    fs.setPressure(phaseIdx, p);
+        };
+
+        const auto saturatedFactor = [&fs, regionIdx](unsigned phaseIdx) {
+            return FluidSystem::saturatedDissolutionFactor(fs, phaseIdx, regionIdx, /*maxOilSaturation=*/1.0);
+        };
+
+        t.saturatedRs.assign(numPressures, 0.0);
+        t.saturatedRv.assign(numPressures, 0.0);
+        for (unsigned pIdx = 0; pIdx < numPressures; ++pIdx) {
+            setPressure(minPressure + pIdx*pressureSpacing);
+            if (dissolvedGas)
+                t.saturatedRs[pIdx] = saturatedFactor(oilPhaseIdx);
+            if (vaporizedOil)
+                t.saturatedRv[pIdx] = saturatedFactor(gasPhaseIdx);
+        }
+
+        // the saturated dissolution factors can only be tabulated if they do not depend
+        // on the oil saturation
+        if (dissolvedGas || vaporizedOil) {
+            setPressure(0.5*(minPressure + maxPressure));
+            Scalar RsRef = dissolvedGas ? saturatedFactor(oilPhaseIdx) : 0.0;
+            Scalar RvRef = vaporizedOil ? saturatedFactor(gasPhaseIdx) : 0.0;
+            fs.setSaturation(oilPhaseIdx, 0.5);
+            Scalar Rs = dissolvedGas ? saturatedFactor(oilPhaseIdx) : 0.0;
+            Scalar Rv = vaporizedOil ? saturatedFactor(gasPhaseIdx) : 0.0;
+            fs.setSaturation(oilPhaseIdx, 1.0);
+            if (Rs != RsRef || Rv != RvRef)
+                tabulatesSaturatedFactors_ = false;
+        }
+
+        // the axes of the dissolution factors cover the range of the saturated curves.
+        // if the fluid system does not consider dissolution, the axes are arbitrary
+        // because the fluid system then ignores the composition.
+        Scalar maxRs = *std::max_element(t.saturatedRs.begin(), t.saturatedRs.end());
+        Scalar maxRv = *std::max_element(t.saturatedRv.begin(), t.saturatedRv.end());
+        if (!(maxRs > 0.0))
+            maxRs = 1.0;
+        if (!(maxRv > 0.0))
+            maxRv = 1.0;
+        Scalar RsSpacing = maxRs/(t.numRs - 1);
+        Scalar RvSpacing = maxRv/(t.numRv - 1);
+        t.invRsSpacing = 1.0/RsSpacing;
+        t.invRvSpacing = 1.0/RvSpacing;
+
+        t.waterInvB.assign(numPressures, 1.0);
+        t.waterMu.assign(numPressures, 1.0);
+        t.oilInvB.assign(numPressures*t.numRs, 1.0);
+        t.oilMu.assign(numPressures*t.numRs, 1.0);
+        t.gasInvB.assign(numPressures*t.numRv, 1.0);
+        t.gasMu.assign(numPressures*t.numRv, 1.0);
+        for (unsigned pIdx = 0; pIdx < numPressures; ++pIdx) {
+            setPressure(minPressure + pIdx*pressureSpacing);
+
+            if (waterActive) {
+                paramCache.updateAll(fs);
+                t.waterInvB[pIdx] = FluidSystem::inverseFormationVolumeFactor(fs, waterPhaseIdx, regionIdx);
+                t.waterMu[pIdx] = FluidSystem::viscosity(fs, paramCache, waterPhaseIdx);
+            }
+
+            if (oilActive) {
+                for (unsigned RsIdx = 0; RsIdx < t.numRs; ++RsIdx) {
+                    fs.setRs(dissolvedGas ? RsIdx*RsSpacing : 0.0);
+                    paramCache.updateAll(fs);
+                    unsigned idx = pIdx*t.numRs + RsIdx;
+                    t.oilInvB[idx] = FluidSystem::inverseFormationVolumeFactor(fs, oilPhaseIdx, regionIdx);
+                    t.oilMu[idx] = FluidSystem::viscosity(fs, paramCache, oilPhaseIdx);
+                }
+                fs.setRs(0.0);
+            }
+
+            if (gasActive) {
+                for (unsigned RvIdx = 0; RvIdx < t.numRv; ++RvIdx) {
+                    fs.setRv(vaporizedOil ? RvIdx*RvSpacing : 0.0);
+                    paramCache.updateAll(fs);
+                    unsigned idx = pIdx*t.numRv + RvIdx;
+                    t.gasInvB[idx] = FluidSystem::inverseFormationVolumeFactor(fs, gasPhaseIdx, regionIdx);
+                    t.gasMu[idx] = FluidSystem::viscosity(fs, paramCache, gasPhaseIdx);
+                }
+                fs.setRv(0.0);
+            }
+        }
+
+        // the saturation pressures as functions of the fluid composition
+        t.oilSaturationPressure.assign(t.numRs, 0.0);
+        t.gasSaturationPressure.assign(t.numRv, 0.0);
+        setPressure(0.5*(minPressure + maxPressure));
+        if (dissolvedGas) {
+            for (unsigned RsIdx = 0; RsIdx < t.numRs; ++RsIdx) {
+                fs.setRs(RsIdx*RsSpacing);
+                t.oilSaturationPressure[RsIdx] = FluidSystem::saturationPressure(fs, oilPhaseIdx, regionIdx);
+            }
+            fs.setRs(0.0);
+        }
+        if (vaporizedOil) {
+            for (unsigned RvIdx = 0; RvIdx < t.numRv; ++RvIdx) {
+                fs.setRv(RvIdx*RvSpacing);
+                t.gasSaturationPressure[RvIdx] = FluidSystem::saturationPressure(fs, gasPhaseIdx, regionIdx);
+            }
+            fs.setRv(0.0);
+        }
+    }
+
+    // determine the interval of an equidistant axis and the position within it. values
+    // outside of the axis are mapped to the first or the last interval, i.e., they are
+    // extrapolated.
+    template <class Evaluation>
+    static void segment_(const Evaluation& x,
+                         Scalar xMin,
+                         Scalar invSpacing,
+                         unsigned numSamples,
+                         unsigned& idx,
+                         Evaluation& alpha)
+    {
+        const Evaluation& xi = (x - xMin)*invSpacing;
+
+        // the order of the min() and max() operations maps NaNs to the first interval
+        Scalar clampedXi = std::max(Scalar(0.0), std::min(Scalar(getValue(xi)), Scalar(numSamples - 2)));
+        idx = static_cast<unsigned>(clampedXi);
+        alpha = xi - Scalar(idx);
+    }
+
+    template <class Evaluation>
+    static Evaluation lerp_(const Scalar* values, const Evaluation& alpha)
+    { return values[0] + alpha*(values[1] - values[0]); }
+
+    template <class Evaluation>
+    static Evaluation linear_(const std::vector<Scalar>& values,
+                              const RegionTables& t,
+                              const Evaluation& p)
+    {
+        unsigned idx;
+        Evaluation alpha;
+        segment_(p, t.minPressure, t.invPressureSpacing, t.numPressures, idx, alpha);
+        return lerp_(values.data() + idx, alpha);
+    }
+
+    template <class Evaluation>
+    static Evaluation bilinear_(const std::vector<Scalar>& values,
+                                const RegionTables& t,
+                                unsigned numR,
+                                Scalar invRSpacing,
+                                const Evaluation& p,
+                                const Evaluation& R)
+    {
+        unsigned pIdx;
+        unsigned RIdx;
+        Evaluation alpha;
+        Evaluation beta;
+        segment_(p, t.minPressure, t.invPressureSpacing, t.numPressures, pIdx, alpha);
+        segment_(R, Scalar(0.0), invRSpacing, numR, RIdx, beta);
+
+        const Scalar* row0 = values.data() + pIdx*numR + RIdx;
+        const Scalar* row1 = row0 + numR;
+        const Evaluation& f0 = lerp_(row0, beta);
+        const Evaluation& f1 = lerp_(row1, beta);
+        return f0 + alpha*(f1 - f0);
+    }
+
+    static std::vector<RegionTables> regionTables_;
+    static bool enabled_;
+    static bool tabulatesSaturatedFactors_;
+};
+
+template <class TypeTag>
+std::vector<typename BlackOilPvtTables<TypeTag>::RegionTables>
+BlackOilPvtTables<TypeTag>::regionTables_;
+
+template <class TypeTag>
+bool BlackOilPvtTables<TypeTag>::enabled_ = false;
+
+template <class TypeTag>
+bool BlackOilPvtTables<TypeTag>::tabulatesSaturatedFactors_ = true;
+
+} // namespace Opm
+
+#endif
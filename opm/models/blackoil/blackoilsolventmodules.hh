@@ -31,6 +31,7 @@
 #include "blackoilproperties.hh"
 #include <opm/models/io/vtkblackoilsolventmodule.hh>
 #include <opm/models/common/quantitycallbacks.hh>
+#include <opm/models/utils/segmentcachedeval.hh>
 
 #include <opm/material/fluidsystems/blackoilpvt/SolventPvt.hpp>
 #include <opm/material/common/Tabulated1DFunction.hpp>
@@ -643,8 +644,8 @@ public:
         return std::abs(Toolbox::scalarValue(resid[contiSolventEqIdx]));
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void serializeEntity(const Model& model, Stream& outstream, const DofEntity& dof)
     {
         if (!enableSolvent)
             return;
@@ -655,8 +656,8 @@ public:
         outstream << priVars[solventSaturationIdx];
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class Stream, class DofEntity>
+    static void deserializeEntity(Model& model, Stream& instream, const DofEntity& dof)
     {
         if (!enableSolvent)
             return;
@@ -883,8 +884,33 @@ class BlackOilSolventIntensiveQuantities
     static constexpr int waterPhaseIdx = FluidSystem::waterPhaseIdx;
     static constexpr double cutOff = 1e-12;
 
+    // the tables for which the segment used by the last update is remembered
+    enum {
+        pmiscTableIdx,
+        miscTableIdx,
+        sorwmisTableIdx,
+        sgcwmisTableIdx,
+        msfnKrsgTableIdx,
+        msfnKroTableIdx,
+        sof2KrnTableIdx,
+        ssfnKrgTableIdx,
+        ssfnKrsTableIdx,
+        tlPMixTableIdx,
+        numCachedTables
+    };
+
 
 public:
+    /*!
+     * \brief Start the table searches at the segments which were used for the degree
+     *        of freedom by a previous update.
+     */
+    void solventSegmentsFromHint_(const BlackOilSolventIntensiveQuantities& hint)
+    {
+        for (unsigned tableIdx = 0; tableIdx < numCachedTables; ++tableIdx)
+            tableSegmentIdx_[tableIdx] = hint.tableSegmentIdx_[tableIdx];
+    }
+
     /*!
      * \brief Called before the saturation functions are doing their magic
      *
@@ -901,7 +927,8 @@ public:
         hydrocarbonSaturation_ = fs.saturation(gasPhaseIdx);
 
         // apply a cut-off. Don't waste calculations if no solvent
-        if (solventSaturation().value() < cutOff)
+        hasSolvent_ = solventSaturation().value() >= cutOff;
+        if (!hasSolvent_)
             return;
 
         // make the saturation of the gas phase which is used by the saturation functions
@@ -928,13 +955,13 @@ public:
         solventMobility_ = 0.0;
 
         // apply a cut-off. Don't waste calculations if no solvent
-        if (solventSaturation().value() < cutOff)
+        if (!hasSolvent_)
             return;
 
         // Pressure effects on capillary pressure miscibility
         if (SolventModule::isMiscible()) {
             const Evaluation& p = fs.pressure(oilPhaseIdx); // or gas pressure?
-            const Evaluation pmisc = SolventModule::pmisc(elemCtx, dofIdx, timeIdx).eval(p, /*extrapolate=*/true);
+            const Evaluation pmisc = tableEval_(SolventModule::pmisc(elemCtx, dofIdx, timeIdx), p, pmiscTableIdx);
             const Evaluation& pgImisc = fs.pressure(gasPhaseIdx);
 
             // compute capillary pressure for miscible fluid
@@ -971,7 +998,7 @@ public:
             const auto& misc = SolventModule::misc(elemCtx, dofIdx, timeIdx);
             const auto& pmisc = SolventModule::pmisc(elemCtx, dofIdx, timeIdx);
             const Evaluation& p = fs.pressure(oilPhaseIdx); // or gas pressure?
-            const Evaluation miscibility = misc.eval(Fsolgas, /*extrapolate=*/true) * pmisc.eval(p, /*extrapolate=*/true);
+            const Evaluation miscibility = tableEval_(misc, Fsolgas, miscTableIdx) * tableEval_(pmisc, p, pmiscTableIdx);
 
             // TODO adjust endpoints of sn and ssg
             unsigned cellIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
@@ -985,8 +1012,8 @@ public:
             const auto& sorwmis = SolventModule::sorwmis(elemCtx, dofIdx, timeIdx);
             const auto& sgcwmis = SolventModule::sgcwmis(elemCtx, dofIdx, timeIdx);
 
-            Evaluation sor = miscibility * sorwmis.eval(sw,  /*extrapolate=*/true) + (1.0 - miscibility) * sogcr;
-            Evaluation sgc = miscibility * sgcwmis.eval(sw,  /*extrapolate=*/true) + (1.0 - miscibility) * sgcr;
+            Evaluation sor = miscibility * tableEval_(sorwmis, sw, sorwmisTableIdx) + (1.0 - miscibility) * sogcr;
+            Evaluation sgc = miscibility * tableEval_(sgcwmis, sw, sgcwmisTableIdx) + (1.0 - miscibility) * sgcr;
 
             const Evaluation oilGasSolventSat = gasSolventSat + fs.saturation(oilPhaseIdx);
             const Evaluation zero = 0.0;
@@ -1001,8 +1028,9 @@ public:
             const auto& msfnKrsg = SolventModule::msfnKrsg(elemCtx, dofIdx, timeIdx);
             const auto& sof2Krn = SolventModule::sof2Krn(elemCtx, dofIdx, timeIdx);
 
-            const Evaluation mkrgt = msfnKrsg.eval(F_totalGas, /*extrapolate=*/true) * sof2Krn.eval(oilGasSolventSat, /*extrapolate=*/true);
-            const Evaluation mkro = msfnKro.eval(F_totalGas, /*extrapolate=*/true) * sof2Krn.eval(oilGasSolventSat, /*extrapolate=*/true);
+            const Evaluation krn = tableEval_(sof2Krn, oilGasSolventSat, sof2KrnTableIdx);
+            const Evaluation mkrgt = tableEval_(msfnKrsg, F_totalGas, msfnKrsgTableIdx) * krn;
+            const Evaluation mkro = tableEval_(msfnKro, F_totalGas, msfnKroTableIdx) * krn;
 
             Evaluation& kro = asImp_().mobility_[oilPhaseIdx];
             Evaluation& krg = asImp_().mobility_[gasPhaseIdx];
@@ -1021,8 +1049,8 @@ public:
         const auto& ssfnKrs = SolventModule::ssfnKrs(elemCtx, dofIdx, timeIdx);
 
         Evaluation& krg = asImp_().mobility_[gasPhaseIdx];
-        solventMobility_ = krg * ssfnKrs.eval(Fsolgas, /*extrapolate=*/true);
-        krg *= ssfnKrg.eval(Fhydgas, /*extrapolate=*/true);
+        solventMobility_ = krg * tableEval_(ssfnKrs, Fsolgas, ssfnKrsTableIdx);
+        krg *= tableEval_(ssfnKrg, Fhydgas, ssfnKrgTableIdx);
 
     }
 
@@ -1059,6 +1087,15 @@ public:
     const Evaluation& solventSaturation() const
     { return solventSaturation_; }
 
+    /*!
+     * \brief Returns true if the solvent saturation is above the cut-off.
+     *
+     * If this is not the case, the solvent is immobile and does not influence the
+     * hydrocarbon phases, i.e., the plain black-oil quantities are used.
+     */
+    bool hasSolvent() const
+    { return hasSolvent_; }
+
     const Evaluation& solventDensity() const
     { return solventDensity_; }
 
@@ -1087,7 +1124,7 @@ private:
 
         // Don't waste calculations if no solvent
         // Apply a cut-off for small and negative solvent saturations
-        if (solventSaturation() < cutOff)
+        if (!hasSolvent_)
             return;
 
         auto& fs = asImp_().fluidState_;
@@ -1098,9 +1135,10 @@ private:
         const Evaluation& sw = fs.saturation(waterPhaseIdx);
 
         const Evaluation zero = 0.0;
-        const Evaluation oilEffSat = std::max(fs.saturation(oilPhaseIdx) - sorwmis.eval(sw,  /*extrapolate=*/true),zero);
-        const Evaluation gasEffSat = std::max(fs.saturation(gasPhaseIdx) - sgcwmis.eval(sw,  /*extrapolate=*/true),zero);
-        const Evaluation solventEffSat = std::max(solventSaturation() - sgcwmis.eval(sw,  /*extrapolate=*/true),zero);
+        const Evaluation sgcwmisValue = tableEval_(sgcwmis, sw, sgcwmisTableIdx);
+        const Evaluation oilEffSat = std::max(fs.saturation(oilPhaseIdx) - tableEval_(sorwmis, sw, sorwmisTableIdx),zero);
+        const Evaluation gasEffSat = std::max(fs.saturation(gasPhaseIdx) - sgcwmisValue,zero);
+        const Evaluation solventEffSat = std::max(solventSaturation() - sgcwmisValue,zero);
 
         const Evaluation oilGasSolventEffSat =  oilEffSat + gasEffSat + solventEffSat;
         const Evaluation oilSolventEffSat = oilEffSat + solventEffSat;
@@ -1136,7 +1174,8 @@ private:
         // The pressureMixingParameter is not implemented in ecl100.
         const Evaluation& po = fs.pressure(oilPhaseIdx);
         const auto& tlPMixTable = SolventModule::tlPMixTable(elemCtx, scvIdx, timeIdx);
-        const Evaluation tlMixParamMu = SolventModule::tlMixParamViscosity(elemCtx, scvIdx, timeIdx) * tlPMixTable.eval(po,  /*extrapolate=*/true);
+        const Evaluation tlPMix = tableEval_(tlPMixTable, po, tlPMixTableIdx);
+        const Evaluation tlMixParamMu = SolventModule::tlMixParamViscosity(elemCtx, scvIdx, timeIdx) * tlPMix;
 
         Evaluation muOilEff = pow(muOil,1.0 - tlMixParamMu) * pow(muMixOilSolvent, tlMixParamMu);
         Evaluation muGasEff = pow(muGas,1.0 - tlMixParamMu) * pow(muMixSolventGas, tlMixParamMu);
@@ -1150,7 +1189,7 @@ private:
         // Mixing parameter for density
         // The pressureMixingParameter represent the miscibility of the solvent while the mixingParameterDenisty the effect of the porous media.
         // The pressureMixingParameter is not implemented in ecl100.
-        const Evaluation tlMixParamRho = SolventModule::tlMixParamDensity(elemCtx, scvIdx, timeIdx) * tlPMixTable.eval(po,  /*extrapolate=*/true);
+        const Evaluation tlMixParamRho = SolventModule::tlMixParamDensity(elemCtx, scvIdx, timeIdx) * tlPMix;
 
         // compute effective viscosities for density calculations. These have to
         // be recomputed as a different mixing parameter may be used.
@@ -1205,7 +1244,7 @@ private:
 
         // account for pressure effects
         const auto& pmiscTable = SolventModule::pmisc(elemCtx, scvIdx, timeIdx);
-        const Evaluation pmisc = pmiscTable.eval(po, /*extrapolate=*/true);
+        const Evaluation pmisc = tableEval_(pmiscTable, po, pmiscTableIdx);
 
         // copy the unmodified invB factors
         const Evaluation bo = fs.invB(oilPhaseIdx);
@@ -1248,6 +1287,12 @@ protected:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
+    // evaluate one of the solvent tables, starting with the segment which was used
+    // for it during the previous update
+    template <class TabulatedFunction>
+    Evaluation tableEval_(const TabulatedFunction& table, const Evaluation& x, unsigned tableIdx)
+    { return segmentCachedEval(table, x, tableSegmentIdx_[tableIdx]); }
+
     Evaluation hydrocarbonSaturation_;
     Evaluation solventSaturation_;
     Evaluation solventDensity_;
@@ -1256,6 +1301,9 @@ protected:
     Evaluation solventInvFormationVolumeFactor_;
 
     Scalar solventRefDensity_;
+
+    bool hasSolvent_ = false;
+    unsigned tableSegmentIdx_[numCachedTables] = {};
 };
 
 template <class TypeTag>
@@ -1267,6 +1315,10 @@ class BlackOilSolventIntensiveQuantities<TypeTag, false>
 
 
 public:
+    template <class IntensiveQuantities>
+    void solventSegmentsFromHint_(const IntensiveQuantities& hint OPM_UNUSED)
+    { }
+
     void solventPreSatFuncUpdate_(const ElementContext& elemCtx OPM_UNUSED,
                                   unsigned scvIdx OPM_UNUSED,
                                   unsigned timeIdx OPM_UNUSED)
@@ -1285,6 +1337,9 @@ public:
     const Evaluation& solventSaturation() const
     { throw std::runtime_error("solventSaturation() called but solvents are disabled"); }
 
+    bool hasSolvent() const
+    { return false; }
+
     const Evaluation& solventDensity() const
     { throw std::runtime_error("solventDensity() called but solvents are disabled"); }
 
@@ -1349,6 +1404,9 @@ public:
         unsigned i = scvf.interiorIndex();
         unsigned j = scvf.exteriorIndex();
 
+        if (noSolventFlux_(elemCtx, i, j, timeIdx))
+            return;
+
         // calculate the "raw" pressure gradient
         DimEvalVector solventPGrad;
         pressureCallback.setPhaseIndex(gasPhaseIdx);
@@ -1359,7 +1417,8 @@ public:
         Valgrind::CheckDefined(solventPGrad);
 
         // correct the pressure gradients by the gravitational acceleration
-        if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity)) {
+        static const auto enableGravity = EWOMS_GET_PARAM_HANDLE(TypeTag, bool, EnableGravity);
+        if (*enableGravity) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
@@ -1449,6 +1508,9 @@ public:
         unsigned exteriorDofIdx = extQuants.exteriorIndex();
         assert(interiorDofIdx != exteriorDofIdx);
 
+        if (noSolventFlux_(elemCtx, interiorDofIdx, exteriorDofIdx, timeIdx))
+            return;
+
         const auto& intQuantsIn = elemCtx.intensiveQuantities(interiorDofIdx, timeIdx);
         const auto& intQuantsEx = elemCtx.intensiveQuantities(exteriorDofIdx, timeIdx);
 
@@ -1526,6 +1588,25 @@ public:
     { solventVolumeFlux_ = solventVolumeFlux; }
 
 private:
+    // if there is no solvent on either side of a face, the solvent mobilities are zero
+    // without any derivatives and so is the flux. In this case the potential gradient
+    // does not need to be computed.
+    bool noSolventFlux_(const ElementContext& elemCtx,
+                        unsigned interiorDofIdx,
+                        unsigned exteriorDofIdx,
+                        unsigned timeIdx)
+    {
+        if (elemCtx.intensiveQuantities(interiorDofIdx, timeIdx).hasSolvent()
+            || elemCtx.intensiveQuantities(exteriorDofIdx, timeIdx).hasSolvent())
+            return false;
+
+        // use the same upstream convention as for a vanishing potential gradient
+        solventUpstreamDofIdx_ = std::min(interiorDofIdx, exteriorDofIdx);
+        solventDownstreamDofIdx_ = std::max(interiorDofIdx, exteriorDofIdx);
+        solventVolumeFlux_ = 0.0;
+        return true;
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
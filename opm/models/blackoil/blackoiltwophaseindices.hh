@@ -132,7 +132,7 @@ struct BlackOilTwoPhaseIndices
     //////////////////////
 
     //! \brief returns the index of "active" component
-    static unsigned canonicalToActiveComponentIndex(unsigned compIdx)
+    static constexpr unsigned canonicalToActiveComponentIndex(unsigned compIdx)
     {
         // assumes canonical oil = 0, water = 1, gas = 2;
         if(!gasEnabled) {
@@ -151,7 +151,7 @@ struct BlackOilTwoPhaseIndices
         return compIdx-1;
     }
 
-    static unsigned activeToCanonicalComponentIndex(unsigned compIdx)
+    static constexpr unsigned activeToCanonicalComponentIndex(unsigned compIdx)
     {
         // assumes canonical oil = 0, water = 1, gas = 2;
         assert(compIdx < 2);
@@ -32,6 +32,7 @@
 
 #include "multiphasebaseproperties.hh"
 #include <opm/models/common/quantitycallbacks.hh>
+#include <opm/models/utils/instrumentation.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Unused.hpp>
@@ -41,6 +42,8 @@
 #include <dune/common/fmatrix.hh>
 
 #include <cmath>
+#include <cstdint>
+#include <type_traits>
 
 namespace Opm {
 
@@ -83,16 +86,75 @@ class DarcyBaseProblem
 /*!
  * \ingroup FluxModules
  * \brief Provides the intensive quantities for the Darcy flux module
+ *
+ * Besides this, it records for which fluid phases the mobility is zero, so that the
+ * fluxes of immobile phases do not need to be evaluated.
  */
 template <class TypeTag>
 class DarcyIntensiveQuantities
 {
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using Implementation = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+
+    static_assert(numPhases <= 16, "The immobile phases are stored as a bit mask");
+
+public:
+    /*!
+     * \brief Returns true if the mobility of a fluid phase is zero.
+     *
+     * \param phaseIdx The index of the fluid phase
+     * \param considerDerivatives If true, the derivatives of the mobility must be zero
+     *                            as well
+     */
+    bool mobilityIsZero(unsigned phaseIdx, bool considerDerivatives) const
+    {
+        const auto mask = considerDerivatives ? zeroMobilityMask_ : zeroMobilityValueMask_;
+        return (mask >> phaseIdx) & 1;
+    }
+
 protected:
-    void update_(const ElementContext& elemCtx OPM_UNUSED,
+    void update_(const ElementContext& elemCtx,
                  unsigned dofIdx OPM_UNUSED,
                  unsigned timeIdx OPM_UNUSED)
-    { }
+    {
+        // this must be called after the mobilities have been computed
+        const auto& intQuants = static_cast<const Implementation&>(*this);
+
+        zeroMobilityMask_ = 0;
+        zeroMobilityValueMask_ = 0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!elemCtx.model().phaseIsConsidered(phaseIdx))
+                continue;
+
+            const Evaluation& mobility = intQuants.mobility(phaseIdx);
+            if (scalarValue(mobility) != 0.0)
+                continue;
+
+            zeroMobilityValueMask_ |= static_cast<std::uint16_t>(1 << phaseIdx);
+            if (derivativesAreZero_(mobility))
+                zeroMobilityMask_ |= static_cast<std::uint16_t>(1 << phaseIdx);
+        }
+    }
+
+private:
+    static bool derivativesAreZero_(const Evaluation& x)
+    {
+        if constexpr (std::is_same<Evaluation, Scalar>::value)
+            return true;
+        else {
+            for (int varIdx = 0; varIdx < x.size(); ++varIdx)
+                if (x.derivative(varIdx) != 0.0)
+                    return false;
+            return true;
+        }
+    }
+
+    std::uint16_t zeroMobilityMask_;
+    std::uint16_t zeroMobilityValueMask_;
 };
 
 /*!
@@ -124,6 +186,7 @@ class DarcyExtensiveQuantities
 
     enum { dimWorld = GridView::dimensionworld };
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { useTwoPointFluxApproximation = getPropValue<TypeTag, Properties::UseTwoPointFluxApproximation>() };
 
     using Toolbox = MathToolbox<Evaluation>;
     using ParameterCache = typename FluidSystem::template ParameterCache<Evaluation>;
@@ -169,6 +232,17 @@ public:
     const Evaluation& volumeFlux(unsigned phaseIdx) const
     { return volumeFlux_[phaseIdx]; }
 
+    /*!
+     * \brief Returns true if a fluid phase is immobile at the face.
+     *
+     * In this case, the volume flux of the phase and all its derivatives are zero, so
+     * the fluxes which are transported by the phase do not need to be evaluated.
+     *
+     * \param phaseIdx The index of the fluid phase
+     */
+    bool phaseIsImmobile(unsigned phaseIdx) const
+    { return phaseIsImmobile_[phaseIdx]; }
+
 protected:
     short upstreamIndex_(unsigned phaseIdx) const
     { return upstreamDofIdx_[phaseIdx]; }
@@ -185,8 +259,17 @@ protected:
                              unsigned faceIdx,
                              unsigned timeIdx)
     {
+        // only calculateFluxes_() is able to tell whether a phase is immobile
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            phaseIsImmobile_[phaseIdx] = false;
+
+        if (useTwoPointFluxApproximation) {
+            calculateTwoPointGradients_(elemCtx, faceIdx, timeIdx);
+            return;
+        }
+
         const auto& gradCalc = elemCtx.gradientCalculator();
-        PressureCallback<TypeTag> pressureCallback(elemCtx);
+        PhasePressuresCallback<TypeTag> pressuresCallback(elemCtx);
 
         const auto& scvf = elemCtx.stencil(timeIdx).interiorFace(faceIdx);
         const auto& faceNormal = scvf.normal();
@@ -197,23 +280,18 @@ protected:
         exteriorDofIdx_ = static_cast<short>(j);
         unsigned focusDofIdx = elemCtx.focusDofIndex();
 
-        // calculate the "raw" pressure gradient
+        // calculate the "raw" pressure gradients of all phases in a single pass
+        gradCalc.calculateGradients(potentialGrad_, elemCtx, faceIdx, pressuresCallback);
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            if (!elemCtx.model().phaseIsConsidered(phaseIdx)) {
+            if (!elemCtx.model().phaseIsConsidered(phaseIdx))
                 Valgrind::SetUndefined(potentialGrad_[phaseIdx]);
-                continue;
-            }
-
-            pressureCallback.setPhaseIndex(phaseIdx);
-            gradCalc.calculateGradient(potentialGrad_[phaseIdx],
-                                       elemCtx,
-                                       faceIdx,
-                                       pressureCallback);
-            Valgrind::CheckDefined(potentialGrad_[phaseIdx]);
+            else
+                Valgrind::CheckDefined(potentialGrad_[phaseIdx]);
         }
 
         // correct the pressure gradients by the gravitational acceleration
-        if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity)) {
+        static const auto enableGravity = EWOMS_GET_PARAM_HANDLE(TypeTag, bool, EnableGravity);
+        if (*enableGravity) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
@@ -288,9 +366,14 @@ protected:
             }
         }
 
-        Valgrind::SetUndefined(K_);
-        elemCtx.problem().intersectionIntrinsicPermeability(K_, elemCtx, faceIdx, timeIdx);
-        Valgrind::CheckDefined(K_);
+        // the permeability and the upstream directions only depend on the values of the
+        // intensive quantities, so they are retained if only the focus has changed
+        bool refocusing = elemCtx.refocusingExtensiveQuantities();
+        if (!refocusing) {
+            Valgrind::SetUndefined(K_);
+            elemCtx.problem().intersectionIntrinsicPermeability(K_, elemCtx, faceIdx, timeIdx);
+            Valgrind::CheckDefined(K_);
+        }
 
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!elemCtx.model().phaseIsConsidered(phaseIdx)) {
@@ -299,17 +382,166 @@ protected:
             }
 
             // determine the upstream and downstream DOFs
-            Evaluation tmp = 0.0;
-            for (unsigned dimIdx = 0; dimIdx < faceNormal.size(); ++dimIdx)
-                tmp += potentialGrad_[phaseIdx][dimIdx]*faceNormal[dimIdx];
+            if (!refocusing) {
+                Scalar tmp = 0.0;
+                for (unsigned dimIdx = 0; dimIdx < faceNormal.size(); ++dimIdx)
+                    tmp += Toolbox::value(potentialGrad_[phaseIdx][dimIdx])*faceNormal[dimIdx];
+
+                if (tmp > 0) {
+                    upstreamDofIdx_[phaseIdx] = exteriorDofIdx_;
+                    downstreamDofIdx_[phaseIdx] = interiorDofIdx_;
+                }
+                else {
+                    upstreamDofIdx_[phaseIdx] = interiorDofIdx_;
+                    downstreamDofIdx_[phaseIdx] = exteriorDofIdx_;
+                }
+            }
 
-            if (tmp > 0) {
-                upstreamDofIdx_[phaseIdx] = exteriorDofIdx_;
-                downstreamDofIdx_[phaseIdx] = interiorDofIdx_;
+            // we only carry the derivatives along if the upstream DOF is the one which
+            // we currently focus on
+            const auto& up = elemCtx.intensiveQuantities(upstreamDofIdx_[phaseIdx], timeIdx);
+            if (upstreamDofIdx_[phaseIdx] == static_cast<int>(focusDofIdx))
+                mobility_[phaseIdx] = up.mobility(phaseIdx);
+            else
+                mobility_[phaseIdx] = Toolbox::value(up.mobility(phaseIdx));
+        }
+    }
+
+    /*!
+     * \brief Calculate the potential differences which are required to determine the
+     *        volumetric fluxes using the two-point flux approximation
+     *
+     * The potential gradient at the face is approximated by the potential difference of
+     * the two adjacent degrees of freedom divided by their distance. Since the intrinsic
+     * permeability is assumed to be diagonal, the volumetric flux is then given by the
+     * mobility, the potential difference and the transmissibility n^T K d / |d|^2 of
+     * the face, i.e., neither the gradient calculator nor tensor products are required.
+     */
+    void calculateTwoPointGradients_(const ElementContext& elemCtx,
+                                     unsigned faceIdx,
+                                     unsigned timeIdx)
+    {
+        const auto& scvf = elemCtx.stencil(timeIdx).interiorFace(faceIdx);
+        const auto& faceNormal = scvf.normal();
+
+        unsigned i = scvf.interiorIndex();
+        unsigned j = scvf.exteriorIndex();
+        interiorDofIdx_ = static_cast<short>(i);
+        exteriorDofIdx_ = static_cast<short>(j);
+        unsigned focusDofIdx = elemCtx.focusDofIndex();
+
+        const auto& intQuantsIn = elemCtx.intensiveQuantities(i, timeIdx);
+        const auto& intQuantsEx = elemCtx.intensiveQuantities(j, timeIdx);
+
+        const auto& posIn = elemCtx.pos(i, timeIdx);
+        const auto& posEx = elemCtx.pos(j, timeIdx);
+        const auto& posFace = scvf.integrationPos();
+
+        // the distance between the centers of the control volumes
+        DimVector distVecIn(posIn);
+        DimVector distVecEx(posEx);
+        DimVector distVecTotal(posEx);
+
+        distVecIn -= posFace;
+        distVecEx -= posFace;
+        distVecTotal -= posIn;
+        Scalar absDistTotalSquared = distVecTotal.two_norm2();
+
+        // the transmissibility and the upstream directions only depend on the values of
+        // the intensive quantities, so they are retained if only the focus has changed
+        bool refocusing = elemCtx.refocusingExtensiveQuantities();
+        if (!refocusing) {
+            Valgrind::SetUndefined(K_);
+            elemCtx.problem().intersectionIntrinsicPermeability(K_, elemCtx, faceIdx, timeIdx);
+            Valgrind::CheckDefined(K_);
+
+#ifndef NDEBUG
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                for (unsigned dim2Idx = 0; dim2Idx < dimWorld; ++dim2Idx)
+                    assert(dimIdx == dim2Idx || K_[dimIdx][dim2Idx] == 0.0);
+#endif
+
+            transmissibility_ = 0.0;
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                transmissibility_ += faceNormal[dimIdx]*K_[dimIdx][dimIdx]*distVecTotal[dimIdx];
+            transmissibility_ /= absDistTotalSquared;
+        }
+
+        Scalar distTimesNormal = distVecTotal*faceNormal;
+        static const auto enableGravity = EWOMS_GET_PARAM_HANDLE(TypeTag, bool, EnableGravity);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!elemCtx.model().phaseIsConsidered(phaseIdx)) {
+                Valgrind::SetUndefined(potentialGrad_[phaseIdx]);
+                continue;
             }
-            else {
-                upstreamDofIdx_[phaseIdx] = interiorDofIdx_;
-                downstreamDofIdx_[phaseIdx] = exteriorDofIdx_;
+
+            // the difference of the pressures. the derivatives are only carried along
+            // for the degree of freedom which we currently focus on
+            Evaluation& potentialDiff = potentialDiff_[phaseIdx];
+            if (std::is_same<Scalar, Evaluation>::value ||
+                exteriorDofIdx_ == static_cast<int>(focusDofIdx))
+                potentialDiff = intQuantsEx.fluidState().pressure(phaseIdx);
+            else
+                potentialDiff = Toolbox::value(intQuantsEx.fluidState().pressure(phaseIdx));
+
+            if (std::is_same<Scalar, Evaluation>::value ||
+                interiorDofIdx_ == static_cast<int>(focusDofIdx))
+                potentialDiff -= intQuantsIn.fluidState().pressure(phaseIdx);
+            else
+                potentialDiff -= Toolbox::value(intQuantsIn.fluidState().pressure(phaseIdx));
+
+            // correct the pressure difference by the hydrostatic pressures at the
+            // integration point of the face
+            if (*enableGravity) {
+                const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
+                const auto& gEx = elemCtx.problem().gravity(elemCtx, j, timeIdx);
+
+                Evaluation pStatIn;
+                if (std::is_same<Scalar, Evaluation>::value ||
+                    interiorDofIdx_ == static_cast<int>(focusDofIdx))
+                {
+                    const Evaluation& rhoIn = intQuantsIn.fluidState().density(phaseIdx);
+                    pStatIn = - rhoIn*(gIn*distVecIn);
+                }
+                else {
+                    Scalar rhoIn = Toolbox::value(intQuantsIn.fluidState().density(phaseIdx));
+                    pStatIn = - rhoIn*(gIn*distVecIn);
+                }
+
+                Evaluation pStatEx;
+                if (std::is_same<Scalar, Evaluation>::value ||
+                    exteriorDofIdx_ == static_cast<int>(focusDofIdx))
+                {
+                    const Evaluation& rhoEx = intQuantsEx.fluidState().density(phaseIdx);
+                    pStatEx = - rhoEx*(gEx*distVecEx);
+                }
+                else {
+                    Scalar rhoEx = Toolbox::value(intQuantsEx.fluidState().density(phaseIdx));
+                    pStatEx = - rhoEx*(gEx*distVecEx);
+                }
+
+                potentialDiff += pStatEx - pStatIn;
+
+                if (!isfinite(potentialDiff)) {
+                    throw NumericalIssue("Non-finite potential gradient for phase '"
+                                         +std::string(FluidSystem::phaseName(phaseIdx))+"'");
+                }
+            }
+
+            // the potential gradient is parallel to the vector between the two centers
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                potentialGrad_[phaseIdx][dimIdx] = potentialDiff*(distVecTotal[dimIdx]/absDistTotalSquared);
+
+            // determine the upstream and downstream DOFs
+            if (!refocusing) {
+                if (Toolbox::value(potentialDiff)*distTimesNormal > 0) {
+                    upstreamDofIdx_[phaseIdx] = exteriorDofIdx_;
+                    downstreamDofIdx_[phaseIdx] = interiorDofIdx_;
+                }
+                else {
+                    upstreamDofIdx_[phaseIdx] = interiorDofIdx_;
+                    downstreamDofIdx_[phaseIdx] = exteriorDofIdx_;
+                }
             }
 
             // we only carry the derivatives along if the upstream DOF is the one which
@@ -334,22 +566,22 @@ protected:
                                      unsigned timeIdx,
                                      const FluidState& fluidState)
     {
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            phaseIsImmobile_[phaseIdx] = false;
+
         const auto& gradCalc = elemCtx.gradientCalculator();
-        BoundaryPressureCallback<TypeTag, FluidState> pressureCallback(elemCtx, fluidState);
+        BoundaryPhasePressuresCallback<TypeTag, FluidState> pressuresCallback(elemCtx, fluidState);
 
-        // calculate the pressure gradient
+        // calculate the pressure gradients of all phases in a single pass
+        gradCalc.calculateBoundaryGradients(potentialGrad_,
+                                            elemCtx,
+                                            boundaryFaceIdx,
+                                            pressuresCallback);
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            if (!elemCtx.model().phaseIsConsidered(phaseIdx)) {
+            if (!elemCtx.model().phaseIsConsidered(phaseIdx))
                 Valgrind::SetUndefined(potentialGrad_[phaseIdx]);
-                continue;
-            }
-
-            pressureCallback.setPhaseIndex(phaseIdx);
-            gradCalc.calculateBoundaryGradient(potentialGrad_[phaseIdx],
-                                               elemCtx,
-                                               boundaryFaceIdx,
-                                               pressureCallback);
-            Valgrind::CheckDefined(potentialGrad_[phaseIdx]);
+            else
+                Valgrind::CheckDefined(potentialGrad_[phaseIdx]);
         }
 
         const auto& scvf = elemCtx.stencil(timeIdx).boundaryFace(boundaryFaceIdx);
@@ -363,7 +595,8 @@ protected:
         K_ = intQuantsIn.intrinsicPermeability();
 
         // correct the pressure gradients by the gravitational acceleration
-        if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity)) {
+        static const auto enableGravity = EWOMS_GET_PARAM_HANDLE(TypeTag, bool, EnableGravity);
+        if (*enableGravity) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
@@ -463,12 +696,38 @@ protected:
         const DimVector& normal = scvf.normal();
         Valgrind::CheckDefined(normal);
 
+        unsigned focusDofIdx = elemCtx.focusDofIndex();
+        unsigned numConsidered = 0;
+        unsigned numImmobile = 0;
         for (unsigned phaseIdx=0; phaseIdx < numPhases; phaseIdx++) {
             filterVelocity_[phaseIdx] = 0.0;
             volumeFlux_[phaseIdx] = 0.0;
             if (!elemCtx.model().phaseIsConsidered(phaseIdx))
                 continue;
 
+            // if the mobility of the upstream DOF is zero, so is the volume flux. its
+            // derivatives only matter if the upstream DOF is the one we focus on.
+            ++ numConsidered;
+            unsigned upIdx = static_cast<unsigned>(upstreamDofIdx_[phaseIdx]);
+            const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
+            bool considerDerivatives = !std::is_same<Scalar, Evaluation>::value && upIdx == focusDofIdx;
+            if (up.mobilityIsZero(phaseIdx, considerDerivatives)) {
+                phaseIsImmobile_[phaseIdx] = true;
+                ++ numImmobile;
+                continue;
+            }
+
+            if (useTwoPointFluxApproximation) {
+                // the permeability is diagonal, so the filter velocity does not require
+                // a matrix-vector product and the volume flux is given by the
+                // transmissibility of the face
+                for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                    filterVelocity_[phaseIdx][dimIdx] =
+                        - mobility_[phaseIdx]*(potentialGrad_[phaseIdx][dimIdx]*K_[dimIdx][dimIdx]);
+                volumeFlux_[phaseIdx] = - mobility_[phaseIdx]*(potentialDiff_[phaseIdx]*transmissibility_);
+                continue;
+            }
+
             asImp_().calculateFilterVelocity_(phaseIdx);
             Valgrind::CheckDefined(filterVelocity_[phaseIdx]);
 
@@ -476,6 +735,16 @@ protected:
             for (unsigned i = 0; i < normal.size(); ++i)
                 volumeFlux_[phaseIdx] += filterVelocity_[phaseIdx][i] * normal[i];
         }
+
+        // report the rate at which the fluxes of immobile phases are skipped
+        if (Instrumentation::enabled()) {
+            static const unsigned consideredRegionIdx =
+                Instrumentation::regionIndex("interior face phase fluxes");
+            static const unsigned immobileRegionIdx =
+                Instrumentation::regionIndex("skipped immobile phase fluxes");
+            Instrumentation::addCount(consideredRegionIdx, numConsidered);
+            Instrumentation::addCount(immobileRegionIdx, numImmobile);
+        }
     }
 
     /*!
@@ -549,6 +818,14 @@ protected:
     // pressure potential gradients of all phases [Pa / m]
     EvalDimVector potentialGrad_[numPhases];
 
+    // potential differences between the exterior and the interior DOF for the two-point
+    // flux approximation [Pa] and the transmissibility of the face per area [m]
+    Evaluation potentialDiff_[numPhases];
+    Scalar transmissibility_;
+
+    // whether the volume fluxes of the phases are zero including their derivatives
+    bool phaseIsImmobile_[numPhases];
+
     // upstream, downstream, interior and exterior DOFs
     short upstreamDofIdx_[numPhases];
     short downstreamDofIdx_[numPhases];
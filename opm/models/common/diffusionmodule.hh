@@ -115,17 +115,24 @@ public:
         const auto& fluidStateJ = context.intensiveQuantities(extQuants.exteriorIndex(), timeIdx).fluidState();
 
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!extQuants.phaseDiffuses(phaseIdx))
+                continue;
+
             // arithmetic mean of the phase's molar density
             Evaluation rhoMolar = fluidStateI.molarDensity(phaseIdx);
             rhoMolar += Toolbox::value(fluidStateJ.molarDensity(phaseIdx));
             rhoMolar /= 2;
 
-            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                if (!extQuants.componentDiffuses(phaseIdx, compIdx))
+                    continue;
+
                 // mass flux due to molecular diffusion
                 flux[conti0EqIdx + compIdx] +=
                     -rhoMolar
                     * extQuants.moleFractionGradientNormal(phaseIdx, compIdx)
                     * extQuants.effectiveDiffusionCoefficient(phaseIdx, compIdx);
+            }
         }
     }
 };
@@ -358,7 +365,6 @@ class DiffusionExtensiveQuantities<TypeTag, /*enableDiffusion=*/true>
     enum { numComponents = getPropValue<TypeTag, Properties::NumComponents>() };
 
     using DimVector = Dune::FieldVector<Scalar, dimWorld>;
-    using DimEvalVector = Dune::FieldVector<Evaluation, dimWorld>;
 
 protected:
     /*!
@@ -367,36 +373,45 @@ protected:
      */
     void update_(const ElementContext& elemCtx, unsigned faceIdx, unsigned timeIdx)
     {
+        using Toolbox = Opm::MathToolbox<Evaluation>;
+
         const auto& gradCalc = elemCtx.gradientCalculator();
         Opm::MoleFractionCallback<TypeTag> moleFractionCallback(elemCtx);
 
-        const auto& face = elemCtx.stencil(timeIdx).interiorFace(faceIdx);
-        const auto& normal = face.normal();
         const auto& extQuants = elemCtx.extensiveQuantities(faceIdx, timeIdx);
 
         const auto& intQuantsInside = elemCtx.intensiveQuantities(extQuants.interiorIndex(), timeIdx);
         const auto& intQuantsOutside = elemCtx.intensiveQuantities(extQuants.exteriorIndex(), timeIdx);
 
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            if (!elemCtx.model().phaseIsConsidered(phaseIdx))
+            // there is no diffusion within a phase which is absent on both sides of the
+            // face
+            phaseDiffuses_[phaseIdx] =
+                elemCtx.model().phaseIsConsidered(phaseIdx)
+                && (Toolbox::value(intQuantsInside.fluidState().saturation(phaseIdx)) > 0.0
+                    || Toolbox::value(intQuantsOutside.fluidState().saturation(phaseIdx)) > 0.0);
+            if (!phaseDiffuses_[phaseIdx])
                 continue;
 
             moleFractionCallback.setPhaseIndex(phaseIdx);
             for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
                 moleFractionCallback.setComponentIndex(compIdx);
 
-                DimEvalVector moleFractionGradient(0.0);
-                gradCalc.calculateGradient(moleFractionGradient,
-                                           elemCtx,
-                                           faceIdx,
-                                           moleFractionCallback);
-
-                moleFractionGradientNormal_[phaseIdx][compIdx] = 0.0;
-                for (unsigned i = 0; i < normal.size(); ++i)
-                    moleFractionGradientNormal_[phaseIdx][compIdx] +=
-                        normal[i]*moleFractionGradient[i];
+                moleFractionGradientNormal_[phaseIdx][compIdx] =
+                    gradCalc.calculateNormalGradient(elemCtx, faceIdx, moleFractionCallback);
                 Opm::Valgrind::CheckDefined(moleFractionGradientNormal_[phaseIdx][compIdx]);
 
+                // components which are not present or which are uniformly distributed
+                // (including the derivatives of their mole fractions) do not diffuse
+                componentDiffuses_[phaseIdx][compIdx] =
+                    !Toolbox::isSame(moleFractionGradientNormal_[phaseIdx][compIdx],
+                                     Toolbox::createConstant(0.0),
+                                     /*tolerance=*/0.0);
+                if (!componentDiffuses_[phaseIdx][compIdx]) {
+                    effectiveDiffusionCoefficient_[phaseIdx][compIdx] = 0.0;
+                    continue;
+                }
+
                 // use the arithmetic average for the effective
                 // diffusion coefficients.
                 effectiveDiffusionCoefficient_[phaseIdx][compIdx] =
@@ -437,10 +452,13 @@ protected:
         assert(dist > 0);
 
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-            if (!elemCtx.model().phaseIsConsidered(phaseIdx))
+            phaseDiffuses_[phaseIdx] = elemCtx.model().phaseIsConsidered(phaseIdx);
+            if (!phaseDiffuses_[phaseIdx])
                 continue;
 
             for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                componentDiffuses_[phaseIdx][compIdx] = true;
+
                 // calculate mole fraction gradient using two-point
                 // gradients
                 moleFractionGradientNormal_[phaseIdx][compIdx] =
@@ -480,9 +498,36 @@ public:
     const Evaluation& effectiveDiffusionCoefficient(unsigned phaseIdx, unsigned compIdx) const
     { return effectiveDiffusionCoefficient_[phaseIdx][compIdx]; }
 
+    /*!
+     * \brief Returns true if a fluid phase can exhibit diffusive fluxes at the face.
+     *
+     * This is not the case if the phase is not considered by the model or if it is
+     * absent on both sides of the face. In this case, the mole fraction gradients and
+     * diffusion coefficients of the phase are undefined.
+     *
+     * \copydoc Doxygen::phaseIdxParam
+     */
+    bool phaseDiffuses(unsigned phaseIdx) const
+    { return phaseDiffuses_[phaseIdx]; }
+
+    /*!
+     * \brief Returns true if a component of a diffusive phase exhibits a diffusive flux
+     *        at the face.
+     *
+     * This is not the case if the gradient of its mole fraction and all derivatives of
+     * the gradient are zero.
+     *
+     * \copydoc Doxygen::phaseIdxParam
+     * \copydoc Doxygen::compIdxParam
+     */
+    bool componentDiffuses(unsigned phaseIdx, unsigned compIdx) const
+    { return componentDiffuses_[phaseIdx][compIdx]; }
+
 private:
     Evaluation moleFractionGradientNormal_[numPhases][numComponents];
     Evaluation effectiveDiffusionCoefficient_[numPhases][numComponents];
+    bool phaseDiffuses_[numPhases];
+    bool componentDiffuses_[numPhases][numComponents];
 };
 
 } // namespace Opm
@@ -407,6 +407,7 @@ public:
                                  unsigned timeIdx)
     {
         const auto& extQuants = context.extensiveQuantities(spaceIdx, timeIdx);
+        unsigned focusDofIdx = context.focusDofIndex();
 
         // advective energy flux in all phases
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
@@ -417,10 +418,18 @@ public:
             unsigned upIdx = static_cast<unsigned>(extQuants.upstreamIndex(phaseIdx));
             const IntensiveQuantities& up = context.intensiveQuantities(upIdx, timeIdx);
 
-            flux[energyEqIdx] +=
-                extQuants.volumeFlux(phaseIdx)
-                * up.fluidState().enthalpy(phaseIdx)
-                * up.fluidState().density(phaseIdx);
+            // the derivatives of the upstream quantities are only required if the
+            // upstream DOF is the one which is currently focused on
+            if (upIdx == focusDofIdx)
+                flux[energyEqIdx] +=
+                    extQuants.volumeFlux(phaseIdx)
+                    * up.fluidState().enthalpy(phaseIdx)
+                    * up.fluidState().density(phaseIdx);
+            else
+                flux[energyEqIdx] +=
+                    extQuants.volumeFlux(phaseIdx)
+                    * (Toolbox::value(up.fluidState().enthalpy(phaseIdx))
+                       * Toolbox::value(up.fluidState().density(phaseIdx)));
         }
     }
 
@@ -452,10 +461,16 @@ public:
             unsigned upIdx = static_cast<unsigned>(extQuants.upstreamIndex(phaseIdx));
             const IntensiveQuantities& up = context.intensiveQuantities(upIdx, timeIdx);
 
-            flux[energyEqIdx] +=
-                extQuants.fractureVolumeFlux(phaseIdx)
-                * up.fluidState().enthalpy(phaseIdx)
-                * up.fluidState().density(phaseIdx);
+            if (upIdx == context.focusDofIndex())
+                flux[energyEqIdx] +=
+                    extQuants.fractureVolumeFlux(phaseIdx)
+                    * up.fluidState().enthalpy(phaseIdx)
+                    * up.fluidState().density(phaseIdx);
+            else
+                flux[energyEqIdx] +=
+                    extQuants.fractureVolumeFlux(phaseIdx)
+                    * (Toolbox::value(up.fluidState().enthalpy(phaseIdx))
+                       * Toolbox::value(up.fluidState().density(phaseIdx)));
         }
     }
 
@@ -620,17 +635,7 @@ protected:
                                     unsigned timeIdx)
     {
         const auto& priVars = context.primaryVars(spaceIdx, timeIdx);
-        Evaluation val;
-        if (std::is_same<Evaluation, Scalar>::value) // finite differences
-            val = Toolbox::createConstant(priVars[temperatureIdx]);
-        else {
-            // automatic differentiation
-            if (timeIdx == 0)
-                val = Toolbox::createVariable(priVars[temperatureIdx], temperatureIdx);
-            else
-                val = Toolbox::createConstant(priVars[temperatureIdx]);
-        }
-        fluidState.setTemperature(val);
+        fluidState.setTemperature(priVars.makeEvaluation(temperatureIdx, timeIdx));
     }
 
     /*!
@@ -749,10 +754,10 @@ class EnergyExtensiveQuantities<TypeTag, /*enableEnergy=*/true>
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using Toolbox = Opm::MathToolbox<Evaluation>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
 
     enum { dimWorld = GridView::dimensionworld };
-    using EvalDimVector = Dune::FieldVector<Evaluation, dimWorld>;
     using DimVector = Dune::FieldVector<Scalar, dimWorld>;
 
 protected:
@@ -762,30 +767,40 @@ protected:
      */
     void update_(const ElementContext& elemCtx, unsigned faceIdx, unsigned timeIdx)
     {
-        const auto& gradCalc = elemCtx.gradientCalculator();
-        Opm::TemperatureCallback<TypeTag> temperatureCallback(elemCtx);
-
-        EvalDimVector temperatureGrad;
-        gradCalc.calculateGradient(temperatureGrad,
-                                   elemCtx,
-                                   faceIdx,
-                                   temperatureCallback);
-
-        // scalar product of temperature gradient and scvf normal
-        const auto& face = elemCtx.stencil(/*timeIdx=*/0).interiorFace(faceIdx);
-
-        temperatureGradNormal_ = 0;
-        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
-            temperatureGradNormal_ += (face.normal()[dimIdx]*temperatureGrad[dimIdx]);
-
         const auto& extQuants = elemCtx.extensiveQuantities(faceIdx, timeIdx);
         const auto& intQuantsInside = elemCtx.intensiveQuantities(extQuants.interiorIndex(), timeIdx);
         const auto& intQuantsOutside = elemCtx.intensiveQuantities(extQuants.exteriorIndex(), timeIdx);
 
-        // arithmetic mean
-        thermalConductivity_ =
-            0.5 * (intQuantsInside.thermalConductivity() + intQuantsOutside.thermalConductivity());
+        // arithmetic mean. only the quantities of the DOF which is currently focused on
+        // need to carry their derivatives.
+        unsigned focusDofIdx = elemCtx.focusDofIndex();
+        if (extQuants.interiorIndex() == focusDofIdx)
+            thermalConductivity_ =
+                0.5 * (intQuantsInside.thermalConductivity()
+                       + Toolbox::value(intQuantsOutside.thermalConductivity()));
+        else if (extQuants.exteriorIndex() == focusDofIdx)
+            thermalConductivity_ =
+                0.5 * (Toolbox::value(intQuantsInside.thermalConductivity())
+                       + intQuantsOutside.thermalConductivity());
+        else
+            thermalConductivity_ =
+                0.5 * (Toolbox::value(intQuantsInside.thermalConductivity())
+                       + Toolbox::value(intQuantsOutside.thermalConductivity()));
         Opm::Valgrind::CheckDefined(thermalConductivity_);
+
+        // if the face does not conduct any heat, the conductive flux and all its
+        // derivatives are zero regardless of the temperature gradient
+        if (Toolbox::isSame(thermalConductivity_, Toolbox::createConstant(0.0), /*tolerance=*/0.0)) {
+            temperatureGradNormal_ = 0.0;
+            return;
+        }
+
+        // scalar product of temperature gradient and scvf normal. the conductivity is
+        // isotropic, so only the normal component of the gradient is needed and the
+        // gradient calculator can use precomputed weights for it.
+        const auto& gradCalc = elemCtx.gradientCalculator();
+        Opm::TemperatureCallback<TypeTag> temperatureCallback(elemCtx);
+        temperatureGradNormal_ = gradCalc.calculateNormalGradient(elemCtx, faceIdx, temperatureCallback);
     }
 
     template <class Context, class FluidState>
@@ -232,6 +232,10 @@ class ForchheimerExtensiveQuantities
     using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
     using DimEvalMatrix = Dune::FieldMatrix<Evaluation, dimWorld, dimWorld>;
 
+    // the maximum number of Newton iterations used to determine the velocity for
+    // anisotropic permeabilities
+    static constexpr unsigned maxForchheimerIterations_ = 50;
+
 public:
     /*!
      * \brief Return the Ergun coefficent at the face's integration point.
@@ -433,9 +437,32 @@ protected:
 
     void calculateForchheimerFlux_(unsigned phaseIdx)
     {
-        // initial guess: filter velocity is zero
         DimEvalVector& velocity = this->filterVelocity_[phaseIdx];
-        velocity = 0.0;
+
+        // if the square root of the permeability is the same in all directions, the
+        // Forchheimer velocity is parallel to the Darcy velocity and can be calculated
+        // in closed form
+        bool isotropic = true;
+        for (unsigned dimIdx = 1; dimIdx < dimWorld; ++dimIdx)
+            isotropic = isotropic && sqrtK_[dimIdx] == sqrtK_[0];
+        if (isotropic) {
+            isotropicForchheimerVelocity_(velocity, phaseIdx, sqrtK_[0]);
+            return;
+        }
+
+        // initial guess: the closed-form solution for an isotropic medium whose
+        // permeability is averaged using the direction of the Darcy velocity
+        const auto& pGrad = this->potentialGrad_[phaseIdx];
+        Scalar weightSum = 0.0;
+        Scalar sqrtKSum = 0.0;
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+            Scalar w = Toolbox::scalarValue(pGrad[dimIdx])*this->K_[dimIdx][dimIdx];
+            weightSum += w*w;
+            sqrtKSum += w*w*sqrtK_[dimIdx];
+        }
+        isotropicForchheimerVelocity_(velocity,
+                                      phaseIdx,
+                                      (weightSum > 0.0) ? sqrtKSum/weightSum : sqrtK_[0]);
 
         // the change of velocity between two consecutive Newton iterations
         DimEvalVector deltaV(1e5);
@@ -448,9 +475,11 @@ protected:
         // search by means of the Newton method for a root of Forchheimer equation
         unsigned newtonIter = 0;
         while (deltaV.one_norm() > 1e-11) {
-            if (newtonIter >= 50)
-                throw NumericalIssue("Could not determine Forchheimer velocity within "
-                                     +std::to_string(newtonIter)+" iterations");
+            if (newtonIter >= maxForchheimerIterations_)
+                throw NumericalIssue("Could not determine Forchheimer velocity of phase '"
+                                     +std::string(FluidSystem::phaseName(phaseIdx))+"' within "
+                                     +std::to_string(newtonIter)+" iterations (last change: "
+                                     +std::to_string(Toolbox::scalarValue(deltaV.one_norm()))+")");
             ++newtonIter;
 
             // calculate the residual and its Jacobian matrix
@@ -459,7 +488,50 @@ protected:
             // newton method
             gradResid.solve(deltaV, residual);
             velocity -= deltaV;
+
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+                if (!isfinite(velocity[dimIdx]))
+                    throw NumericalIssue("Non-finite Forchheimer velocity for phase '"
+                                         +std::string(FluidSystem::phaseName(phaseIdx))+"'");
+            }
+        }
+    }
+
+    /*!
+     * \brief Calculate the Forchheimer velocity of a phase for a permeability whose
+     *        square root is the same in all directions.
+     *
+     * In this case, the Forchheimer equation reads v (1 + sqrt(K) beta |v|) = v_D, where
+     * v_D is the Darcy velocity and beta is the product of the density, the
+     * mobility-passability ratio and the Ergun coefficient. Since v is parallel to v_D,
+     * this is a quadratic equation for |v| whose positive root yields
+     *
+     * v = 2 v_D / (1 + sqrt(1 + 4 sqrt(K) beta |v_D|)).
+     */
+    void isotropicForchheimerVelocity_(DimEvalVector& velocity,
+                                       unsigned phaseIdx,
+                                       Scalar sqrtK) const
+    {
+        const auto& mobility = this->mobility_[phaseIdx];
+        const auto& pGrad = this->potentialGrad_[phaseIdx];
+
+        // the Darcy velocity
+        Evaluation absDarcyVel = 0.0;
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+            velocity[dimIdx] = - mobility*pGrad[dimIdx]*this->K_[dimIdx][dimIdx];
+            absDarcyVel += velocity[dimIdx]*velocity[dimIdx];
         }
+
+        // the derivatives of the square root of 0 are undefined. in this case, the
+        // Forchheimer velocity is identical to the Darcy velocity
+        if (absDarcyVel <= 0.0)
+            return;
+        absDarcyVel = Toolbox::sqrt(absDarcyVel);
+
+        const auto& beta = density_[phaseIdx]*mobilityPassabilityRatio_[phaseIdx]*ergunCoefficient_;
+        const Evaluation& factor = 2.0/(1.0 + Toolbox::sqrt(1.0 + 4.0*sqrtK*beta*absDarcyVel));
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+            velocity[dimIdx] *= factor;
     }
 
     void forchheimerResid_(DimEvalVector& residual, unsigned phaseIdx) const
@@ -494,15 +566,7 @@ protected:
         // -> sqrtK_.usmv(density*mobilityPassabilityRatio*ergunCoefficient_*velocity.two_norm(),
         //                velocity,
         //                residual);
-        Evaluation absVel = 0.0;
-        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
-            absVel += velocity[dimIdx]*velocity[dimIdx];
-        // the derivatives of the square root of 0 are undefined, so we must guard
-        // against this case
-        if (absVel <= 0.0)
-            absVel = 0.0;
-        else
-            absVel = Toolbox::sqrt(absVel);
+        const Evaluation& absVel = absVelocity_(velocity);
         const auto& alpha = density*mobilityPassabilityRatio*ergunCoefficient_*absVel;
         for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
             residual[dimIdx] += sqrtK_[dimIdx]*alpha*velocity[dimIdx];
@@ -513,23 +577,40 @@ protected:
                                DimEvalMatrix& gradResid,
                                unsigned phaseIdx)
     {
-        // TODO (?) use AD for this.
-        DimEvalVector& velocity = this->filterVelocity_[phaseIdx];
+        const DimEvalVector& velocity = this->filterVelocity_[phaseIdx];
         forchheimerResid_(residual, phaseIdx);
 
-        Scalar eps = 1e-11;
-        DimEvalVector tmp;
+        // the derivatives of residual_i = v_i + mobility K_i (grad p)_i + sqrt(K_i) beta
+        // |v| v_i with regard to v_j are given by delta_ij (1 + sqrt(K_i) beta |v|) +
+        // sqrt(K_i) beta v_i v_j / |v|
+        const auto& beta = density_[phaseIdx]*mobilityPassabilityRatio_[phaseIdx]*ergunCoefficient_;
+        const Evaluation& absVel = absVelocity_(velocity);
         for (unsigned i = 0; i < dimWorld; ++i) {
-            Scalar coordEps = std::max(eps, Toolbox::scalarValue(velocity[i]) * (1 + eps));
-            velocity[i] += coordEps;
-            forchheimerResid_(tmp, phaseIdx);
-            tmp -= residual;
-            tmp /= coordEps;
-            gradResid[i] = tmp;
-            velocity[i] -= coordEps;
+            const Evaluation& sqrtKBeta = sqrtK_[i]*beta;
+            for (unsigned j = 0; j < dimWorld; ++j) {
+                if (i == j)
+                    gradResid[i][j] = 1.0 + sqrtKBeta*absVel;
+                else
+                    gradResid[i][j] = 0.0;
+
+                if (absVel > 0.0)
+                    gradResid[i][j] += sqrtKBeta*velocity[i]*velocity[j]/absVel;
+            }
         }
     }
 
+    Evaluation absVelocity_(const DimEvalVector& velocity) const
+    {
+        Evaluation absVel = 0.0;
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+            absVel += velocity[dimIdx]*velocity[dimIdx];
+        // the derivatives of the square root of 0 are undefined, so we must guard
+        // against this case
+        if (absVel <= 0.0)
+            return 0.0;
+        return Toolbox::sqrt(absVel);
+    }
+
     /*!
      * \brief Check whether all off-diagonal entries of a tensor are zero.
      *
@@ -45,6 +45,11 @@
 #include <opm/material/thermal/NullSolidEnergyLaw.hpp>
 #include <opm/material/common/Unused.hpp>
 
+#include <dune/common/fvector.hh>
+
+#include <array>
+#include <vector>
+
 namespace Opm {
 template <class TypeTag>
 class MultiPhaseBaseModel;
@@ -85,6 +90,26 @@ struct NumComponents<TypeTag, TTag::MultiPhaseBaseModel> { static constexpr int
 template<class TypeTag>
 struct BaseProblem<TypeTag, TTag::MultiPhaseBaseModel> { using type = MultiPhaseBaseProblem<TypeTag>; };
 
+//! Refine the elements at fronts with a relative variation above 20%
+template<class TypeTag>
+struct GridAdaptationRefineTolerance<TypeTag, TTag::MultiPhaseBaseModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.2;
+};
+
+//! Coarsen the elements with a relative variation below 2.5%
+template<class TypeTag>
+struct GridAdaptationCoarsenTolerance<TypeTag, TTag::MultiPhaseBaseModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.025;
+};
+
+//! Refine the elements of the macro grid at most twice
+template<class TypeTag>
+struct GridAdaptationMaxLevel<TypeTag, TTag::MultiPhaseBaseModel> { static constexpr int value = 2; };
+
 //! By default, use the Darcy relation to determine the phase velocity
 template<class TypeTag>
 struct FluxModule<TypeTag, TTag::MultiPhaseBaseModel> { using type = DarcyFluxModule<TypeTag>; };
@@ -139,6 +164,10 @@ struct ThermalConductionLawParams<TypeTag, TTag::MultiPhaseBaseModel>
 template<class TypeTag>
 struct EnableGravity<TypeTag, TTag::MultiPhaseBaseModel> { static constexpr bool value = false; };
 
+//! reconstruct the potential gradients using the gradient calculator by default
+template<class TypeTag>
+struct UseTwoPointFluxApproximation<TypeTag, TTag::MultiPhaseBaseModel> { static constexpr bool value = false; };
+
 
 } // namespace Opm::Properties
 
@@ -168,10 +197,29 @@ class MultiPhaseBaseModel : public GetPropType<TypeTag, Properties::Discretizati
 
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
     enum { numComponents = FluidSystem::numComponents };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using DimVector = Dune::FieldVector<Scalar, dimWorld>;
 
 public:
+    /*!
+     * rief The quantities of an interior face of an element which are kept from the
+     *        linearization.
+     */
+    struct RetainedFlux
+    {
+        //! The global indices of the degrees of freedom on both sides of the face
+        unsigned interiorDofIdx;
+        unsigned exteriorDofIdx;
+
+        Scalar extrusionFactor;
+        std::array<Scalar, numPhases> volumeFlux;
+        std::array<DimVector, numPhases> filterVelocity;
+    };
+
     MultiPhaseBaseModel(Simulator& simulator)
         : ParentType(simulator)
+        , retainedFluxesValid_(false)
     { }
 
     /*!
@@ -207,7 +255,10 @@ public:
 
         storage = 0;
 
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->gridView());
+        const auto& elementSeeds = this->elementSeeds();
+        ChunkedEntityIterator<GridView, /*codim=*/0>
+            chunkedElemIt(elementSeeds, this->threadedElementChunkSize(),
+                          this->staticElementPartition());
         std::mutex mutex;
 #ifdef _OPENMP
 #pragma omp parallel
@@ -217,39 +268,105 @@ public:
             // moved in front of the #pragma!
             unsigned threadId = ThreadManager::threadId();
             ElementContext elemCtx(this->simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
             EqVector tmp;
 
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    continue; // ignore ghost and overlap elements
-
-                elemCtx.updateStencil(elem);
-                elemCtx.updateIntensiveQuantities(/*timeIdx=*/0);
-
-                const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+            size_t beginIdx, endIdx;
+            while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                    if (!elementSeeds.isInterior(elemIdx))
+                        continue; // ignore ghost and overlap elements
+                    const Element elem = elementSeeds.entity(elemIdx);
+
+                    elemCtx.updateStencil(elem);
+                    elemCtx.updateIntensiveQuantities(/*timeIdx=*/0);
+
+                    const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+
+                    for (unsigned dofIdx = 0; dofIdx < elemCtx.numDof(/*timeIdx=*/0); ++dofIdx) {
+                        const auto& scv = stencil.subControlVolume(dofIdx);
+                        const auto& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+
+                        tmp = 0;
+                        this->localResidual(threadId).addPhaseStorage(tmp,
+                                                                      elemCtx,
+                                                                      dofIdx,
+                                                                      /*timeIdx=*/0,
+                                                                      phaseIdx);
+                        tmp *= scv.volume()*intQuants.extrusionFactor();
+
+                        mutex.lock();
+                        storage += tmp;
+                        mutex.unlock();
+                    }
+                }
+            }
+        }
 
-                for (unsigned dofIdx = 0; dofIdx < elemCtx.numDof(/*timeIdx=*/0); ++dofIdx) {
-                    const auto& scv = stencil.subControlVolume(dofIdx);
-                    const auto& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+        storage = this->gridView_.comm().sum(storage);
+    }
 
-                    tmp = 0;
-                    this->localResidual(threadId).addPhaseStorage(tmp,
-                                                                  elemCtx,
-                                                                  dofIdx,
-                                                                  /*timeIdx=*/0,
-                                                                  phaseIdx);
-                    tmp *= scv.volume()*intQuants.extrusionFactor();
+    /*!
+     * \copydoc FvBaseDiscretization::beginFluxRetention
+     */
+    void beginFluxRetention()
+    {
+        retainedFluxesValid_ = false;
+        retainedFluxes_.resize(this->elementMapper().size());
+    }
 
-                    mutex.lock();
-                    storage += tmp;
-                    mutex.unlock();
-                }
+    /*!
+     * \copydoc FvBaseDiscretization::retainFluxes
+     */
+    void retainFluxes(const ElementContext& elemCtx)
+    {
+        unsigned elemIdx = static_cast<unsigned>(this->elementMapper().index(elemCtx.element()));
+        auto& faceFluxes = retainedFluxes_[elemIdx];
+        faceFluxes.resize(elemCtx.numInteriorFaces(/*timeIdx=*/0));
+        for (unsigned faceIdx = 0; faceIdx < faceFluxes.size(); ++faceIdx) {
+            const auto& extQuants = elemCtx.extensiveQuantities(faceIdx, /*timeIdx=*/0);
+            auto& flux = faceFluxes[faceIdx];
+            flux.interiorDofIdx = elemCtx.globalSpaceIndex(extQuants.interiorIndex(), /*timeIdx=*/0);
+            flux.exteriorDofIdx = elemCtx.globalSpaceIndex(extQuants.exteriorIndex(), /*timeIdx=*/0);
+            flux.extrusionFactor = extQuants.extrusionFactor();
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                flux.volumeFlux[phaseIdx] = getValue(extQuants.volumeFlux(phaseIdx));
+                const auto& v = extQuants.filterVelocity(phaseIdx);
+                for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                    flux.filterVelocity[phaseIdx][dimIdx] = getValue(v[dimIdx]);
             }
         }
+    }
 
-        storage = this->gridView_.comm().sum(storage);
+    /*!
+     * \copydoc FvBaseDiscretization::endFluxRetention
+     */
+    void endFluxRetention()
+    { retainedFluxesValid_ = true; }
+
+    /*!
+     * \brief Returns true if the fluxes of the faces of the last linearization are
+     *        available.
+     *
+     * This requires the RetainLinearizationFluxes parameter to be true. Note that the
+     * fluxes correspond to the solution before the last Newton update, i.e., they lag
+     * behind the current solution by up to the tolerance of the Newton method.
+     */
+    bool hasRetainedFluxes() const
+    {
+        return retainedFluxesValid_
+            && retainedFluxes_.size() == this->elementMapper().size();
+    }
+
+    /*!
+     * \brief Returns the fluxes of the interior faces of an element which were kept
+     *        from the last linearization.
+     *
+     * The faces are ordered like the interior faces of the element's stencil.
+     */
+    const std::vector<RetainedFlux>& retainedFluxes(const Element& elem) const
+    {
+        assert(hasRetainedFluxes());
+        return retainedFluxes_[this->elementMapper().index(elem)];
     }
 
     void registerOutputModules_()
@@ -264,6 +381,11 @@ public:
 private:
     const Implementation& asImp_() const
     { return *static_cast<const Implementation *>(this); }
+
+    // the fluxes of the interior faces of each element, indexed by the element mapper
+    // (only used if the RetainLinearizationFluxes parameter is true)
+    std::vector<std::vector<RetainedFlux> > retainedFluxes_;
+    bool retainedFluxesValid_;
 };
 } // namespace Opm
 
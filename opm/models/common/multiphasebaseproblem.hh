@@ -32,6 +32,7 @@
 
 #include <opm/models/discretization/common/fvbaseproblem.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/parallel/threadmanager.hh>
 
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/common/Means.hpp>
@@ -40,6 +41,9 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+#include <vector>
+
 namespace Opm {
 
 /*!
@@ -68,6 +72,7 @@ class MultiPhaseBaseProblem
 
     enum { dimWorld = GridView::dimensionworld };
     enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { numComponents = getPropValue<TypeTag, Properties::NumComponents>() };
     using DimVector = Dune::FieldVector<Scalar, dimWorld>;
     using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
 //! \endcond
@@ -89,6 +94,14 @@ public:
 
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableGravity,
                              "Use the gravity correction for the pressure gradients.");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, GridAdaptationRefineTolerance,
+                             "The relative variation of the saturations or mole fractions "
+                             "within the stencil of an element above which it is refined");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, GridAdaptationCoarsenTolerance,
+                             "The relative variation of the saturations and mole fractions "
+                             "within the stencil of an element below which it is coarsened");
+        EWOMS_REGISTER_PARAM(TypeTag, int, GridAdaptationMaxLevel,
+                             "The maximum refinement level of the elements");
     }
 
     /*!
@@ -301,56 +314,63 @@ public:
     /*!
      * \brief Mark grid cells for refinement or coarsening
      *
+     * Elements are refined at fronts: The indicator of an element is the largest
+     * relative variation of the saturations and of the mole fractions of the phases
+     * amongst the degrees of freedom of its stencil. Elements whose indicator exceeds
+     * GridAdaptationRefineTolerance are refined unless they already exhibit the
+     * maximum level, elements whose indicator is below GridAdaptationCoarsenTolerance
+     * are coarsened. The indicators are computed by all threads, only the marking is
+     * done sequentially.
+     *
      * \return The number of elements marked for refinement or coarsening.
      */
     unsigned markForGridAdaptation()
     {
-        using Toolbox = MathToolbox<Evaluation>;
-
-        unsigned numMarked = 0;
-        ElementContext elemCtx( this->simulator() );
-        auto gridView = this->simulator().vanguard().gridView();
-        auto& grid = this->simulator().vanguard().grid();
-        auto elemIt = gridView.template begin</*codim=*/0, Dune::Interior_Partition>();
-        auto elemEndIt = gridView.template end</*codim=*/0, Dune::Interior_Partition>();
-        for (; elemIt != elemEndIt; ++elemIt)
+        auto& simulator = this->simulator();
+        const auto& elementSeeds = simulator.model().elementSeeds();
+        const Scalar refineTol = EWOMS_GET_PARAM(TypeTag, Scalar, GridAdaptationRefineTolerance);
+        const Scalar coarsenTol = EWOMS_GET_PARAM(TypeTag, Scalar, GridAdaptationCoarsenTolerance);
+        const int maxLevel = EWOMS_GET_PARAM(TypeTag, int, GridAdaptationMaxLevel);
+
+        // the mark of each element: 1 for refinement, -1 for coarsening
+        size_t numElements = elementSeeds.size();
+        std::vector<signed char> marks(numElements, 0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
         {
-            const auto& element = *elemIt ;
-            elemCtx.updateAll( element );
-
-            // HACK: this should better be part of an AdaptionCriterion class
-            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-                Scalar minSat = 1e100 ;
-                Scalar maxSat = -1e100;
-                size_t nDofs = elemCtx.numDof(/*timeIdx=*/0);
-                for (unsigned dofIdx = 0; dofIdx < nDofs; ++dofIdx)
-                {
-                    const auto& intQuant = elemCtx.intensiveQuantities( dofIdx, /*timeIdx=*/0 );
-                    minSat = std::min(minSat,
-                                      Toolbox::value(intQuant.fluidState().saturation(phaseIdx)));
-                    maxSat = std::max(maxSat,
-                                      Toolbox::value(intQuant.fluidState().saturation(phaseIdx)));
-                }
-
-                const Scalar indicator =
-                    (maxSat - minSat)/(std::max<Scalar>(0.01, maxSat+minSat)/2);
-                if( indicator > 0.2 && element.level() < 2 ) {
-                    grid.mark( 1, element );
-                    ++ numMarked;
-                }
-                else if ( indicator < 0.025 ) {
-                    grid.mark( -1, element );
-                    ++ numMarked;
-                }
-                else
-                {
-                    grid.mark( 0, element );
-                }
+            ElementContext elemCtx(simulator);
+            size_t beginIdx, endIdx;
+            ThreadManager::threadRange(numElements, ThreadManager::threadId(), beginIdx, endIdx);
+            for (size_t idx = beginIdx; idx < endIdx; ++idx) {
+                if (!elementSeeds.isInterior(idx))
+                    continue;
+
+                const auto& element = elementSeeds.entity(idx);
+                elemCtx.updateStencil(element);
+                elemCtx.updateIntensiveQuantities(/*timeIdx=*/0);
+
+                const Scalar indicator = adaptationIndicator_(elemCtx);
+                if (indicator > refineTol && element.level() < maxLevel)
+                    marks[idx] = 1;
+                else if (indicator < coarsenTol && element.level() > 0)
+                    marks[idx] = -1;
             }
         }
 
+        auto& grid = simulator.vanguard().grid();
+        unsigned numMarked = 0;
+        for (size_t idx = 0; idx < numElements; ++idx) {
+            if (!elementSeeds.isInterior(idx))
+                continue;
+
+            grid.mark(marks[idx], elementSeeds.entity(idx));
+            if (marks[idx] != 0)
+                ++ numMarked;
+        }
+
         // get global sum so that every proc is on the same page
-        numMarked = this->simulator().vanguard().grid().comm().sum( numMarked );
+        numMarked = grid.comm().sum( numMarked );
 
         return numMarked;
     }
@@ -392,6 +412,40 @@ private:
         if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity))
             gravity_[dimWorld-1]  = -9.81;
     }
+
+    // the largest relative variation of the saturations and mole fractions amongst
+    // the degrees of freedom of an element's stencil
+    Scalar adaptationIndicator_(const ElementContext& elemCtx) const
+    {
+        using Toolbox = MathToolbox<Evaluation>;
+
+        size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
+        auto relativeVariation = [&elemCtx, numDof](auto quantity) -> Scalar
+        {
+            Scalar minValue = 1e100;
+            Scalar maxValue = -1e100;
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                const auto& fs = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).fluidState();
+                const Scalar value = Toolbox::value(quantity(fs));
+                minValue = std::min(minValue, value);
+                maxValue = std::max(maxValue, value);
+            }
+            return (maxValue - minValue)/(std::max<Scalar>(0.01, maxValue + minValue)/2);
+        };
+
+        Scalar indicator = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            indicator = std::max(indicator,
+                                 relativeVariation([phaseIdx](const auto& fs)
+                                                   { return fs.saturation(phaseIdx); }));
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                indicator = std::max(indicator,
+                                     relativeVariation([phaseIdx, compIdx](const auto& fs)
+                                                       { return fs.moleFraction(phaseIdx, compIdx); }));
+        }
+
+        return indicator;
+    }
 };
 
 } // namespace Opm
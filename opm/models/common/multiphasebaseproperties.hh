@@ -80,6 +80,22 @@ struct EnableGravity { using type = UndefinedProperty; };
 //! Enable diffusive fluxes?
 template<class TypeTag, class MyTypeTag>
 struct EnableDiffusion { using type = UndefinedProperty; };
+//! Calculate the Darcy fluxes over the interior faces using the two-point flux
+//! approximation. This requires the intrinsic permeability to be diagonal.
+template<class TypeTag, class MyTypeTag>
+struct UseTwoPointFluxApproximation { using type = UndefinedProperty; };
+
+//! The relative variation of the saturations or mole fractions within the stencil of an
+//! element above which the element is refined
+template<class TypeTag, class MyTypeTag>
+struct GridAdaptationRefineTolerance { using type = UndefinedProperty; };
+//! The relative variation of the saturations and mole fractions within the stencil of an
+//! element below which the element is coarsened
+template<class TypeTag, class MyTypeTag>
+struct GridAdaptationCoarsenTolerance { using type = UndefinedProperty; };
+//! The maximum refinement level of the elements
+template<class TypeTag, class MyTypeTag>
+struct GridAdaptationMaxLevel { using type = UndefinedProperty; };
 
 } // namespace Opm::Properties
 
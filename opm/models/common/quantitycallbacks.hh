@@ -30,6 +30,7 @@
 #define EWOMS_QUANTITY_CALLBACKS_HH
 
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/common/multiphasebaseproperties.hh>
 
 #include <opm/material/common/MathToolbox.hpp>
 #include <opm/material/common/Valgrind.hpp>
@@ -185,6 +186,102 @@ private:
     unsigned short phaseIdx_;
 };
 
+/*!
+ * \ingroup Discretization
+ *
+ * \brief Callback class for the pressures of all phases.
+ *
+ * In contrast to PressureCallback, the values of all phases are returned by a single
+ * call. The gradient calculators use this to determine the gradients of all phases in
+ * one pass over the flux approximation points.
+ */
+template <class TypeTag>
+class PhasePressuresCallback
+{
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+
+    using IQFluidState = decltype(std::declval<IntensiveQuantities>().fluidState());
+    using ResultRawType = decltype(std::declval<IQFluidState>().pressure(0));
+
+public:
+    using ResultType = typename std::remove_const<typename std::remove_reference<ResultRawType>::type>::type;
+    using ResultValueType = typename MathToolbox<ResultType>::ValueType;
+
+    static constexpr unsigned numFields = getPropValue<TypeTag, Properties::NumPhases>();
+
+    PhasePressuresCallback(const ElementContext& elemCtx)
+        : elemCtx_(elemCtx)
+    {}
+
+    /*!
+     * \brief Set the pressures of all phases given the index of a degree of freedom
+     *        within an element context.
+     */
+    template <class Values>
+    void operator()(Values& values, unsigned dofIdx) const
+    {
+        const auto& fs = elemCtx_.intensiveQuantities(dofIdx, /*timeIdx=*/0).fluidState();
+        for (unsigned phaseIdx = 0; phaseIdx < numFields; ++phaseIdx)
+            values[phaseIdx] = fs.pressure(phaseIdx);
+    }
+
+private:
+    const ElementContext& elemCtx_;
+};
+
+/*!
+ * \ingroup Discretization
+ *
+ * \brief Callback class for the pressures of all phases on the grid boundary.
+ */
+template <class TypeTag, class FluidState>
+class BoundaryPhasePressuresCallback
+{
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+
+    using IQRawFluidState = decltype(std::declval<IntensiveQuantities>().fluidState());
+    using IQFluidState = typename std::remove_const<typename std::remove_reference<IQRawFluidState>::type>::type;
+    using IQScalar = typename IQFluidState::Scalar;
+
+public:
+    using ResultType = IQScalar;
+
+    static constexpr unsigned numFields = getPropValue<TypeTag, Properties::NumPhases>();
+
+    BoundaryPhasePressuresCallback(const ElementContext& elemCtx, const FluidState& boundaryFs)
+        : elemCtx_(elemCtx)
+        , boundaryFs_(boundaryFs)
+    {}
+
+    /*!
+     * \brief Set the pressures of all phases given the index of a degree of freedom
+     *        within an element context.
+     */
+    template <class Values>
+    void operator()(Values& values, unsigned dofIdx) const
+    {
+        const auto& fs = elemCtx_.intensiveQuantities(dofIdx, /*timeIdx=*/0).fluidState();
+        for (unsigned phaseIdx = 0; phaseIdx < numFields; ++phaseIdx)
+            values[phaseIdx] = fs.pressure(phaseIdx);
+    }
+
+    /*!
+     * \brief Set the pressures of all phases on the boundary.
+     */
+    template <class Values>
+    void boundaryValues(Values& values) const
+    {
+        for (unsigned phaseIdx = 0; phaseIdx < numFields; ++phaseIdx)
+            values[phaseIdx] = boundaryFs_.pressure(phaseIdx);
+    }
+
+private:
+    const ElementContext& elemCtx_;
+    const FluidState& boundaryFs_;
+};
+
 /*!
  * \ingroup Discretization
  *
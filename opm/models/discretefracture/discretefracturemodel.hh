@@ -36,6 +36,7 @@
 #include "discretefractureextensivequantities.hh"
 #include "discretefracturelocalresidual.hh"
 #include "discretefractureproblem.hh"
+#include "discretefracturenewtonmethod.hh"
 
 #include <opm/models/immiscible/immisciblemodel.hh>
 #include <opm/models/io/vtkdiscretefracturemodule.hh>
@@ -74,6 +75,19 @@ struct LocalResidual<TypeTag, TTag::DiscreteFractureModel> { using type = Opm::D
 // template<class TypeTag>
 // struct BaseProblem<TypeTag, TTag::DiscreteFractureModel> { using type = DiscreteFractureBaseProblem<TypeTag>; };
 
+//! Use the Newton method which limits the saturation updates of the fracture vertices
+template<class TypeTag>
+struct NewtonMethod<TypeTag, TTag::DiscreteFractureModel>
+{ using type = Opm::DiscreteFractureNewtonMethod<TypeTag>; };
+
+//! Saturations of fracture vertices change by at most 20% per Newton iteration
+template<class TypeTag>
+struct FractureMaxSaturationChange<TypeTag, TTag::DiscreteFractureModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.2;
+};
+
 //! the PrimaryVariables property
 template<class TypeTag>
 struct PrimaryVariables<TypeTag, TTag::DiscreteFractureModel>
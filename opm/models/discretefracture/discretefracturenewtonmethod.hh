@@ -0,0 +1,139 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::DiscreteFractureNewtonMethod
+ */
+#ifndef EWOMS_DISCRETE_FRACTURE_NEWTON_METHOD_HH
+#define EWOMS_DISCRETE_FRACTURE_NEWTON_METHOD_HH
+
+#include "discretefractureproperties.hh"
+
+#include <opm/models/nonlinear/newtonmethod.hh>
+#include <opm/models/utils/parametersystem.hh>
+
+#include <opm/material/common/Unused.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Opm {
+
+/*!
+ * \ingroup DiscreteFractureModel
+ *
+ * \brief A Newton method for the discrete fracture model which limits the change of
+ *        the saturations of the degrees of freedom that are cut by a fracture.
+ *
+ * The fractures and the matrix share their degrees of freedom: the state inside the
+ * fractures is determined from the primary variables of the matrix by requiring
+ * that the phase pressures are identical. Since the pore volume of the fractures is
+ * small and their permeability is high, the fracture saturations react much more
+ * strongly to a Newton update than the ones of the matrix and the overshoots in the
+ * fracture vertices are what usually causes the Newton method to fail, i.e., the
+ * time step to be cut for the whole domain. The saturation updates of these degrees
+ * of freedom are thus scaled down such that no saturation changes by more than
+ * FractureMaxSaturationChange in a single iteration. Everything else is updated
+ * normally.
+ */
+template <class TypeTag>
+class DiscreteFractureNewtonMethod : public GetPropType<TypeTag, Properties::DiscNewtonMethod>
+{
+    using ParentType = GetPropType<TypeTag, Properties::DiscNewtonMethod>;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+    using EqVector = GetPropType<TypeTag, Properties::EqVector>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { saturation0Idx = Indices::saturation0Idx };
+
+public:
+    DiscreteFractureNewtonMethod(Simulator& simulator)
+        : ParentType(simulator)
+    {
+        maxSaturationChange_ = EWOMS_GET_PARAM(TypeTag, Scalar, FractureMaxSaturationChange);
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the Newton method.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, FractureMaxSaturationChange,
+                             "The maximum change of any saturation of a degree of "
+                             "freedom which is cut by a fracture in a single Newton "
+                             "iteration");
+    }
+
+protected:
+    friend NewtonMethod<TypeTag>;
+    friend ParentType;
+
+    /*!
+     * \copydoc FvBaseNewtonMethod::updatePrimaryVariables_
+     */
+    void updatePrimaryVariables_(unsigned globalDofIdx,
+                                 PrimaryVariables& nextValue,
+                                 const PrimaryVariables& currentValue,
+                                 const EqVector& update,
+                                 const EqVector& currentResidual OPM_UNUSED)
+    {
+        nextValue = currentValue;
+        nextValue -= update;
+
+        const auto& fractureMapper = this->simulator_.problem().fractureMapper();
+        if (!fractureMapper.isFractureVertex(globalDofIdx))
+            return;
+
+        // the saturation of the last phase is not a primary variable, but it changes
+        // by the negative sum of the others
+        Scalar lastSatDelta = 0.0;
+        Scalar maxSatDelta = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases - 1; ++phaseIdx) {
+            maxSatDelta = std::max(maxSatDelta, std::abs(update[saturation0Idx + phaseIdx]));
+            lastSatDelta += update[saturation0Idx + phaseIdx];
+        }
+        maxSatDelta = std::max(maxSatDelta, std::abs(lastSatDelta));
+
+        if (maxSatDelta <= maxSaturationChange_)
+            return;
+
+        Scalar satAlpha = maxSaturationChange_/maxSatDelta;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases - 1; ++phaseIdx)
+            nextValue[saturation0Idx + phaseIdx] =
+                currentValue[saturation0Idx + phaseIdx] - satAlpha*update[saturation0Idx + phaseIdx];
+    }
+
+private:
+    Scalar maxSaturationChange_;
+};
+
+} // namespace Opm
+
+#endif
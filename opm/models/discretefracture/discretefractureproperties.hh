@@ -39,6 +39,10 @@ namespace Opm::Properties {
 template<class TypeTag, class MyTypeTag>
 struct UseTwoPointGradients { using type = UndefinedProperty; };
 
+//! The maximum change of the saturations of fracture vertices in a Newton iteration
+template<class TypeTag, class MyTypeTag>
+struct FractureMaxSaturationChange { using type = UndefinedProperty; };
+
 } // namespace Opm::Properties
 
 #endif
@@ -30,13 +30,21 @@
 #include <opm/models/utils/propertysystem.hh>
 
 #include <algorithm>
-#include <set>
+#include <cassert>
+#include <vector>
 
 namespace Opm {
 
 /*!
  * \ingroup DiscreteFractureModel
  * \brief Stores the topology of fractures.
+ *
+ * The fracture edges are first collected using addFractureEdge(). Once all of them
+ * are known, finalize() must be called. This converts them to flat arrays: each
+ * vertex gets a flag that tells whether a fracture cuts through it, and each vertex
+ * gets the sorted list of the vertices with a larger index to which it is connected
+ * by a fracture edge. The queries, which are done for every sub-control volume and
+ * every face at each linearization, then only read a few array entries.
  */
 template <class TypeTag>
 class FractureMapper
@@ -63,19 +71,65 @@ public:
      * \brief Constructor
      */
     FractureMapper()
+        : finalized_(true)
     {}
 
     /*!
      * \brief Marks an edge as having a fracture.
      *
+     * finalize() must be called after the last fracture edge has been added.
+     *
      * \param vertexIdx1 The index of the edge's first vertex.
      * \param vertexIdx2 The index of the edge's second vertex.
      */
     void addFractureEdge(unsigned vertexIdx1, unsigned vertexIdx2)
     {
-        fractureEdges_.insert(FractureEdge(vertexIdx1, vertexIdx2));
-        fractureVertices_.insert(vertexIdx1);
-        fractureVertices_.insert(vertexIdx2);
+        fractureEdges_.emplace_back(vertexIdx1, vertexIdx2);
+
+        unsigned maxVertexIdx = std::max(vertexIdx1, vertexIdx2);
+        if (maxVertexIdx >= isFractureVertex_.size())
+            isFractureVertex_.resize(maxVertexIdx + 1, /*value=*/0);
+        isFractureVertex_[vertexIdx1] = 1;
+        isFractureVertex_[vertexIdx2] = 1;
+
+        finalized_ = false;
+    }
+
+    /*!
+     * \brief Creates the flat lookup arrays for the fracture edges.
+     *
+     * This needs to be called once after all fracture edges have been added, i.e.,
+     * after the grid has been loaded.
+     */
+    void finalize()
+    {
+        std::sort(fractureEdges_.begin(), fractureEdges_.end());
+        fractureEdges_.erase(std::unique(fractureEdges_.begin(), fractureEdges_.end()),
+                             fractureEdges_.end());
+
+        // the edges are now sorted by their first vertex, i.e., the edges of each
+        // vertex are contiguous and sorted by their second vertex
+        size_t numVertices = isFractureVertex_.size();
+        edgeOffsets_.assign(numVertices + 1, 0);
+        for (const auto& edge : fractureEdges_)
+            ++edgeOffsets_[edge.i_ + 1];
+        for (size_t vertexIdx = 0; vertexIdx < numVertices; ++vertexIdx)
+            edgeOffsets_[vertexIdx + 1] += edgeOffsets_[vertexIdx];
+
+        edgeNeighbors_.resize(fractureEdges_.size());
+        for (size_t edgeIdx = 0; edgeIdx < fractureEdges_.size(); ++edgeIdx)
+            edgeNeighbors_[edgeIdx] = fractureEdges_[edgeIdx].j_;
+
+        finalized_ = true;
+    }
+
+    /*!
+     * \brief Returns the number of fracture edges.
+     */
+    size_t numFractureEdges() const
+    {
+        assert(finalized_);
+        return edgeNeighbors_.size();
     }
 
     /*!
@@ -84,7 +138,10 @@ public:
      * \param vertexIdx The index of the vertex.
      */
     bool isFractureVertex(unsigned vertexIdx) const
-    { return fractureVertices_.count(vertexIdx) > 0; }
+    {
+        return vertexIdx < isFractureVertex_.size()
+            && isFractureVertex_[vertexIdx];
+    }
 
     /*!
      * \brief Returns true iff a fracture is associated with a given edge.
@@ -93,14 +150,42 @@ public:
      * \param vertex2Idx The index of the second vertex of the edge.
      */
     bool isFractureEdge(unsigned vertex1Idx, unsigned vertex2Idx) const
+    { return fractureEdgeIndex(vertex1Idx, vertex2Idx) >= 0; }
+
+    /*!
+     * \brief Returns the index of a fracture edge or -1 if there is no fracture on the
+     *        edge.
+     *
+     * The fracture edges are numbered consecutively from zero to numFractureEdges() - 1,
+     * so this can be used to store per-fracture quantities like the aperture in flat
+     * arrays.
+     *
+     * \param vertex1Idx The index of the first vertex of the edge.
+     * \param vertex2Idx The index of the second vertex of the edge.
+     */
+    int fractureEdgeIndex(unsigned vertex1Idx, unsigned vertex2Idx) const
     {
+        assert(finalized_);
+
         FractureEdge tmp(vertex1Idx, vertex2Idx);
-        return fractureEdges_.count(tmp) > 0;
+        if (!isFractureVertex(tmp.i_) || !isFractureVertex(tmp.j_))
+            return -1;
+
+        // vertices are only connected to a handful of others, so a linear search is
+        // sufficient
+        for (unsigned edgeIdx = edgeOffsets_[tmp.i_]; edgeIdx < edgeOffsets_[tmp.i_ + 1]; ++edgeIdx)
+            if (edgeNeighbors_[edgeIdx] == tmp.j_)
+                return static_cast<int>(edgeIdx);
+
+        return -1;
     }
 
 private:
-    std::set<FractureEdge> fractureEdges_;
-    std::set<unsigned> fractureVertices_;
+    std::vector<FractureEdge> fractureEdges_;
+    std::vector<unsigned char> isFractureVertex_;
+    std::vector<unsigned> edgeOffsets_;
+    std::vector<unsigned> edgeNeighbors_;
+    bool finalized_;
 };
 
 } // namespace Opm
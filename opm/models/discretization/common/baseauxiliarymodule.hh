@@ -49,6 +49,18 @@ namespace Opm {
  *
  * For example, these equations can be wells, non-neighboring connections, interfaces
  * between model domains, etc.
+ *
+ * Modules whose equations couple to many degrees of freedom of the grid (e.g., wells
+ * with many perforations) can keep their equations out of the global matrix. Such
+ * modules return true from isEliminated() and zero from numDofs(); they store the
+ * couplings to the grid (B and C) and the Jacobian of their own equations (D)
+ * themselves. linearize() then subtracts B D^-1 r_aux from the residual of the grid,
+ * the linear solver applies the Schur complement A - B D^-1 C via
+ * applySchurComplement(), and postSolve() recovers the update of the auxiliary
+ * unknowns from the one of the grid. The degrees of freedom which are coupled to an
+ * eliminated module must be in the interior of the process' grid partition, and only
+ * the linear solver backends which are based on ParallelBaseBackend consider the
+ * Schur complement.
  */
 template <class TypeTag>
 class BaseAuxiliaryModule
@@ -120,6 +132,26 @@ public:
     virtual void postSolve(GlobalEqVector& residual OPM_UNUSED)
     {};
 
+    /*!
+     * \brief Returns true if the equations of the module are not part of the global
+     *        system of equations but eliminated using their Schur complement.
+     */
+    virtual bool isEliminated() const
+    { return false; }
+
+    /*!
+     * \brief Apply the Schur complement of the eliminated auxiliary equations.
+     *
+     * This computes y -= B D^-1 C x. Both vectors are indexed like the degrees of
+     * freedom of the grid. This is only called if isEliminated() returns true.
+     *
+     * \param x The vector to which the Schur complement is applied
+     * \param y The vector to which the result is added
+     */
+    virtual void applySchurComplement(const GlobalEqVector& x OPM_UNUSED,
+                                      GlobalEqVector& y OPM_UNUSED) const
+    {}
+
 private:
     int dofOffset_;
 };
@@ -30,6 +30,8 @@
 
 #include "fvbaseproperties.hh"
 
+#include <opm/models/utils/instrumentation.hh>
+
 #include <opm/material/densead/Math.hpp>
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Unused.hpp>
@@ -40,6 +42,8 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+
 namespace Opm {
 // forward declaration
 template<class TypeTag>
@@ -111,6 +115,7 @@ private:
 public:
     FvBaseAdLocalLinearizer()
         : internalElemContext_(0)
+        , numBufferEnlargements_(0)
     { }
 
     // copying local linearizer objects around is a very bad idea, so we explicitly
@@ -173,9 +178,21 @@ public:
      */
     void linearize(ElementContext& elemCtx, const Element& elem)
     {
+        Instrumentation::Region region(Instrumentation::localLinearizationRegion);
         elemCtx.updateStencil(elem);
         elemCtx.updateAllIntensiveQuantities();
 
+        // the intensive quantities of the value-only cache do not exhibit any
+        // derivatives, so they need to be recomputed for the degrees of freedom which
+        // may be focused on
+        if (model_().valueOnlyIntensiveQuantityCache()) {
+            unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx)
+                elemCtx.updateIntensiveQuantities(elemCtx.primaryVars(dofIdx, /*timeIdx=*/0),
+                                                  dofIdx,
+                                                  /*timeIdx=*/0);
+        }
+
         // update the weights of the primary variables for the context
         model_().updatePVWeights(elemCtx);
 
@@ -183,11 +200,18 @@ public:
         resize_(elemCtx);
         reset_(elemCtx);
 
-        // compute the local residual and its Jacobian
+        // compute the local residual and its Jacobian. the derivatives are seeded for
+        // the primary variables of the focused degree of freedom only, i.e., a single
+        // pass is required for the element centered discretization. since the values of
+        // the intensive quantities are the same for all passes, the extensive quantities
+        // only need to update their derivatives after the first pass.
         unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned focusDofIdx = 0; focusDofIdx < numPrimaryDof; focusDofIdx++) {
             elemCtx.setFocusDofIndex(focusDofIdx);
-            elemCtx.updateAllExtensiveQuantities();
+            if (focusDofIdx == 0)
+                elemCtx.updateAllExtensiveQuantities();
+            else
+                elemCtx.updateAllExtensiveQuantitiesForFocus();
 
             // calculate the local residual
             localResidual_.eval(elemCtx);
@@ -230,6 +254,15 @@ public:
     const ScalarVectorBlock& residual(unsigned dofIdx) const
     { return residual_[dofIdx]; }
 
+    /*!
+     * \brief Returns the number of times the local Jacobian had to be enlarged.
+     *
+     * This number is supposed to stay constant once all elements of the grid have been
+     * linearized once.
+     */
+    unsigned numBufferEnlargements() const
+    { return numBufferEnlargements_; }
+
 protected:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
@@ -253,16 +286,29 @@ protected:
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
 
         residual_.resize(numDof);
-        jacobian_.setSize(numDof, numPrimaryDof);
+
+        // the local Jacobian is only accessed by index, so it is never shrunk. this
+        // avoids re-allocating its rows for each element if the stencil sizes vary
+        if (jacobian_.N() < numDof || jacobian_.M() < numPrimaryDof) {
+            jacobian_.setSize(std::max(numDof, jacobian_.N()),
+                              std::max(numPrimaryDof, jacobian_.M()));
+            ++ numBufferEnlargements_;
+        }
     }
 
     /*!
      * \brief Reset the all relevant internal attributes to 0
+     *
+     * The local Jacobian does not need to be reset because all of its blocks which
+     * belong to the element are overwritten by updateLocalLinearization_(). Since the
+     * matrix is never shrunk, resetting it would also touch the blocks of the largest
+     * stencil seen so far.
      */
-    void reset_(const ElementContext& elemCtx OPM_UNUSED)
+    void reset_(const ElementContext& elemCtx)
     {
-        residual_ = 0.0;
-        jacobian_ = 0.0;
+        size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            residual_[dofIdx] = 0.0;
     }
 
     /*!
@@ -301,6 +347,7 @@ protected:
 
     ScalarLocalBlockVector residual_;
     ScalarLocalBlockMatrix jacobian_;
+    unsigned numBufferEnlargements_;
 };
 
 } // namespace Opm
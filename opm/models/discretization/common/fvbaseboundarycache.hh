@@ -0,0 +1,133 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseBoundaryCache
+ */
+#ifndef EWOMS_FV_BASE_BOUNDARY_CACHE_HH
+#define EWOMS_FV_BASE_BOUNDARY_CACHE_HH
+
+#include "fvbaseproperties.hh"
+
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <dune/common/fvector.hh>
+
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Stores the boundary rates of the boundary segments of all elements which do
+ *        not depend on the solution.
+ *
+ * The entries are indexed by the index of the element and the index of the boundary
+ * segment within the element's stencil. Only the values of the rates are stored
+ * because rates which do not depend on the solution do not exhibit any derivatives.
+ * All entries become invalid if invalidate() is called, which the discretization does
+ * at the beginning of each attempt to compute a time step.
+ *
+ * The entries of different elements may be accessed concurrently.
+ */
+template <class TypeTag>
+class FvBaseBoundaryCache
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+    struct Entry
+    {
+        Dune::FieldVector<Scalar, numEq> values;
+        unsigned epoch = 0;
+    };
+
+public:
+    /*!
+     * \brief Set the number of elements for which boundary rates are stored.
+     */
+    void resize(size_t numElements)
+    {
+        if (entries_.size() != numElements)
+            entries_.resize(numElements);
+    }
+
+    /*!
+     * \brief Mark all entries as invalid.
+     */
+    void invalidate()
+    { ++ epoch_; }
+
+    /*!
+     * \brief Retrieve the boundary rates of a boundary segment.
+     *
+     * \return false if no valid rates are stored for the segment
+     */
+    template <class BoundaryRateVector>
+    bool load(BoundaryRateVector& values, unsigned elemIdx, unsigned boundaryFaceIdx) const
+    {
+        if (elemIdx >= entries_.size())
+            return false;
+
+        const auto& elemEntries = entries_[elemIdx];
+        if (boundaryFaceIdx >= elemEntries.size() || elemEntries[boundaryFaceIdx].epoch != epoch_)
+            return false;
+
+        const auto& entry = elemEntries[boundaryFaceIdx];
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            values[eqIdx] = entry.values[eqIdx];
+        return true;
+    }
+
+    /*!
+     * \brief Store the boundary rates of a boundary segment.
+     */
+    template <class BoundaryRateVector>
+    void store(const BoundaryRateVector& values, unsigned elemIdx, unsigned boundaryFaceIdx)
+    {
+        using Toolbox = MathToolbox<typename BoundaryRateVector::field_type>;
+
+        if (elemIdx >= entries_.size())
+            return; // the cache has not been sized for the grid yet
+
+        auto& elemEntries = entries_[elemIdx];
+        if (boundaryFaceIdx >= elemEntries.size())
+            elemEntries.resize(boundaryFaceIdx + 1);
+
+        auto& entry = elemEntries[boundaryFaceIdx];
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            entry.values[eqIdx] = Toolbox::value(values[eqIdx]);
+        entry.epoch = epoch_;
+    }
+
+private:
+    std::vector<std::vector<Entry> > entries_;
+    unsigned epoch_ = 1;
+};
+
+} // namespace Opm
+
+#endif
@@ -52,6 +52,7 @@ class FvBaseBoundaryContext
     using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
     using ExtensiveQuantities = GetPropType<TypeTag, Properties::ExtensiveQuantities>;
     using GradientCalculator = GetPropType<TypeTag, Properties::GradientCalculator>;
+    using BoundaryRateVector = GetPropType<TypeTag, Properties::BoundaryRateVector>;
 
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Element = typename GridView::template Codim<0>::Entity;
@@ -266,6 +267,35 @@ public:
     IntersectionIterator& intersectionIt()
     { return intersectionIt_; }
 
+    /*!
+     * \brief Evaluate the boundary conditions of a boundary segment.
+     *
+     * If the boundary cache of the model is enabled, the rates of segments for which
+     * the problem states that they do not depend on the solution are only evaluated
+     * once per time step.
+     *
+     * \param values Stores the rates over the boundary segment.
+     * \param boundaryFaceIdx The local index of the boundary segment
+     * \param timeIdx The index used by the time discretization.
+     */
+    void boundaryRates(BoundaryRateVector& values, unsigned boundaryFaceIdx, unsigned timeIdx) const
+    {
+        const auto& model = this->model();
+        if (!model.enableBoundaryCache() || timeIdx != 0) {
+            problem().boundary(values, *this, boundaryFaceIdx, timeIdx);
+            return;
+        }
+
+        auto& cache = model.boundaryCache();
+        unsigned elemIdx = static_cast<unsigned>(model.elementMapper().index(element()));
+        if (cache.load(values, elemIdx, boundaryFaceIdx))
+            return;
+
+        problem().boundary(values, *this, boundaryFaceIdx, timeIdx);
+        if (!problem().boundaryDependsOnSolution(*this, boundaryFaceIdx, timeIdx))
+            cache.store(values, elemIdx, boundaryFaceIdx);
+    }
+
 protected:
     const ElementContext& elemCtx_;
     IntersectionIterator intersectionIt_;
@@ -0,0 +1,181 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseBoundaryFaceList
+ */
+#ifndef EWOMS_FV_BASE_BOUNDARY_FACE_LIST_HH
+#define EWOMS_FV_BASE_BOUNDARY_FACE_LIST_HH
+
+#include "fvbaseproperties.hh"
+
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/common/fvector.hh>
+
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief A compact list of the intersections of all elements which do not have a
+ *        neighbor, i.e., which are on the boundary of the process' grid partition.
+ *
+ * The list is built once for each version of the grid. The intersections of an element
+ * are stored consecutively in the order in which the grid view's intersection iterator
+ * visits them, i.e., in the order of the boundary faces of the element-centered
+ * stencil. It also tells whether an element is on the domain's boundary without
+ * iterating over its intersections.
+ */
+template <class TypeTag>
+class FvBaseBoundaryFaceList
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+
+    enum { dimWorld = GridView::dimensionworld };
+
+public:
+    using GlobalPosition = Dune::FieldVector<typename GridView::ctype, dimWorld>;
+
+    struct Face
+    {
+        //! The position of the intersection within the ones of its element
+        unsigned short intersectionIdx;
+        //! The index of the boundary segment of the intersection, -1 if it is on the
+        //! boundary of the process' grid partition but not on the domain's boundary
+        int boundarySegmentIdx;
+        //! The area of the intersection
+        Scalar area;
+        //! The unit outer normal at the center of the intersection
+        GlobalPosition normal;
+    };
+
+    /*!
+     * \brief Build the list for the current version of the grid.
+     */
+    template <class ElementMapper>
+    void update(const GridView& gridView, const ElementMapper& elementMapper)
+    {
+        size_t numElements = static_cast<size_t>(gridView.size(/*codim=*/0));
+        std::vector<unsigned> numFaces(numElements, 0);
+        std::vector<Face> faces;
+        onBoundary_.assign(numElements, 0);
+
+        // the elements are not necessarily visited in the order of their indices, so
+        // the faces are first collected and then sorted by the element index
+        std::vector<unsigned> faceElemIdx;
+        for (const auto& elem : elements(gridView)) {
+            unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+            unsigned short intersectionIdx = 0;
+            for (const auto& intersection : intersections(gridView, elem)) {
+                if (!intersection.neighbor()) {
+                    Face face;
+                    face.intersectionIdx = intersectionIdx;
+                    face.boundarySegmentIdx =
+                        intersection.boundary()
+                        ? static_cast<int>(intersection.boundarySegmentIndex())
+                        : -1;
+                    face.area = intersection.geometry().volume();
+                    face.normal = intersection.centerUnitOuterNormal();
+                    faces.push_back(face);
+                    faceElemIdx.push_back(elemIdx);
+                    ++numFaces[elemIdx];
+                    if (intersection.boundary())
+                        onBoundary_[elemIdx] = 1;
+                }
+                ++intersectionIdx;
+            }
+        }
+
+        offsets_.resize(numElements + 1);
+        offsets_[0] = 0;
+        for (size_t elemIdx = 0; elemIdx < numElements; ++elemIdx)
+            offsets_[elemIdx + 1] = offsets_[elemIdx] + numFaces[elemIdx];
+
+        faces_.resize(faces.size());
+        std::vector<unsigned> nextFace(offsets_.begin(), offsets_.end() - 1);
+        for (size_t i = 0; i < faces.size(); ++i)
+            faces_[nextFace[faceElemIdx[i]]++] = faces[i];
+    }
+
+    /*!
+     * \brief Returns true if the list was built for a grid with a given number of
+     *        elements.
+     */
+    bool isValid(size_t numElements) const
+    { return offsets_.size() == numElements + 1; }
+
+    /*!
+     * \brief Returns true if an element has any intersection on the domain's boundary.
+     *
+     * This corresponds to the hasBoundaryIntersections() method of the element, i.e.,
+     * intersections which are only on the boundary of the process' grid partition are
+     * not considered.
+     */
+    bool onBoundary(unsigned elemIdx) const
+    { return onBoundary_[elemIdx] != 0; }
+
+    /*!
+     * \brief Returns the number of intersections of an element without a neighbor.
+     */
+    unsigned numFaces(unsigned elemIdx) const
+    { return offsets_[elemIdx + 1] - offsets_[elemIdx]; }
+
+    /*!
+     * \brief Returns an intersection of an element without a neighbor.
+     *
+     * \param elemIdx The index of the element
+     * \param localFaceIdx The index of the intersection within the element's ones
+     *                     which do not have a neighbor
+     */
+    const Face& face(unsigned elemIdx, unsigned localFaceIdx) const
+    { return faces_[offsets_[elemIdx] + localFaceIdx]; }
+
+    /*!
+     * \brief Returns the total number of intersections without a neighbor.
+     */
+    size_t size() const
+    { return faces_.size(); }
+
+    /*!
+     * \brief Returns the number of bytes held by the list.
+     */
+    size_t memoryUsage() const
+    {
+        return offsets_.capacity()*sizeof(unsigned)
+            + faces_.capacity()*sizeof(Face)
+            + onBoundary_.capacity();
+    }
+
+private:
+    std::vector<unsigned> offsets_;
+    std::vector<Face> faces_;
+    std::vector<unsigned char> onBoundary_;
+};
+
+} // namespace Opm
+
+#endif
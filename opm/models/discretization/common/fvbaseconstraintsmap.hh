@@ -0,0 +1,144 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseConstraintsMap
+ */
+#ifndef EWOMS_FV_BASE_CONSTRAINTS_MAP_HH
+#define EWOMS_FV_BASE_CONSTRAINTS_MAP_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief The constraints of the degrees of freedom, stored in a flat array which is
+ *        sorted by the index of the constrained degree of freedom.
+ *
+ * Besides indexed access to the entries, this provides the subset of the interface of
+ * std::map which is required to look up the constraints of a degree of freedom.
+ */
+template <class Constraints>
+class FvBaseConstraintsMap
+{
+public:
+    using value_type = std::pair<unsigned, Constraints>;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    bool empty() const
+    { return entries_.empty(); }
+
+    size_t size() const
+    { return entries_.size(); }
+
+    const_iterator begin() const
+    { return entries_.begin(); }
+
+    const_iterator end() const
+    { return entries_.end(); }
+
+    /*!
+     * \brief Returns the entry with a given position in the array.
+     */
+    const value_type& operator[](size_t idx) const
+    { return entries_[idx]; }
+
+    /*!
+     * \brief Returns an iterator to the constraints of a degree of freedom or end() if it
+     *        is not constrained.
+     */
+    const_iterator find(unsigned dofIdx) const
+    {
+        auto it = std::lower_bound(entries_.begin(), entries_.end(), dofIdx,
+                                   [](const value_type& entry, unsigned idx)
+                                   { return entry.first < idx; });
+        if (it != entries_.end() && it->first == dofIdx)
+            return it;
+        return entries_.end();
+    }
+
+    /*!
+     * \brief Returns 1 if a degree of freedom is constrained, else 0.
+     */
+    size_t count(unsigned dofIdx) const
+    { return (find(dofIdx) != end()) ? 1 : 0; }
+
+    /*!
+     * \brief Returns the constraints of a degree of freedom.
+     *
+     * An exception is thrown if the degree of freedom is not constrained.
+     */
+    const Constraints& at(unsigned dofIdx) const
+    {
+        auto it = find(dofIdx);
+        if (it == end())
+            throw std::out_of_range("Degree of freedom is not constrained");
+        return it->second;
+    }
+
+    void clear()
+    { entries_.clear(); }
+
+    /*!
+     * \brief Replace the contents by the entries collected by several threads.
+     *
+     * The entries of each thread may be in arbitrary order. If a degree of freedom is
+     * specified multiple times, the first entry of the lowest thread is used. The
+     * per-thread arrays are cleared.
+     */
+    void assign(std::vector<std::vector<value_type> >& threadEntries)
+    {
+        size_t numEntries = 0;
+        for (const auto& entries : threadEntries)
+            numEntries += entries.size();
+
+        entries_.clear();
+        entries_.reserve(numEntries);
+        for (auto& entries : threadEntries) {
+            entries_.insert(entries_.end(), entries.begin(), entries.end());
+            entries.clear();
+        }
+
+        std::stable_sort(entries_.begin(), entries_.end(),
+                         [](const value_type& a, const value_type& b)
+                         { return a.first < b.first; });
+        auto newEnd = std::unique(entries_.begin(), entries_.end(),
+                                  [](const value_type& a, const value_type& b)
+                                  { return a.first == b.first; });
+        entries_.erase(newEnd, entries_.end());
+    }
+
+private:
+    std::vector<value_type> entries_;
+};
+
+} // namespace Opm
+
+#endif
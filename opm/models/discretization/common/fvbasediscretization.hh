@@ -42,18 +42,32 @@
 #include "fvbasediscretization.hh"
 #include "fvbasegradientcalculator.hh"
 #include "fvbasenewtonmethod.hh"
+#include "fvbasetimestepcontroller.hh"
 #include "fvbaseprimaryvariables.hh"
 #include "fvbaseintensivequantities.hh"
+#include "fvbaseintensivequantityarrays.hh"
+#include "fvbasevalueonlyintensivequantitycache.hh"
+#include "fvbaseboundarycache.hh"
+#include "fvbaseboundaryfacelist.hh"
+#include "fvbasesourcecache.hh"
 #include "fvbaseextensivequantities.hh"
 #include "baseauxiliarymodule.hh"
 
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
+#include <opm/models/parallel/blockvectorkernels.hh>
+#include <opm/models/parallel/chunkedentityiterator.hh>
+#include <opm/models/discretization/ecfv/ecfvstructuredlayout.hh>
 #include <opm/simulators/linalg/nullborderlistmanager.hh>
 #include <opm/models/utils/simulator.hh>
 #include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/compressedblockvector.hh>
+#include <opm/models/utils/deferredconstructionallocator.hh>
+#include <opm/models/utils/memoryaccounting.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
+#include <opm/models/utils/pffgridvector.hh>
+#include <opm/models/utils/prefetch.hh>
 #include <opm/models/io/vtkprimaryvarsmodule.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
 
@@ -66,6 +80,7 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 #include <dune/istl/bvector.hh>
+#include <dune/grid/common/rangegenerators.hh>
 
 #if HAVE_DUNE_FEM
 #include <dune/fem/space/common/adaptationmanager.hh>
@@ -74,10 +89,16 @@
 #include <dune/fem/misc/capabilities.hh>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <limits>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace Opm {
@@ -220,6 +241,60 @@ template<class TypeTag>
 struct ThreadsPerProcess<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
 template<class TypeTag>
 struct UseLinearizationLock<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
+template<class TypeTag>
+struct UseLinearizationColoring<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct ThreadedElementChunkSize<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 16; };
+template<class TypeTag>
+struct EnablePartialRelinearization<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct StencilCacheMaxMemory<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 0; };
+template<class TypeTag>
+struct EnablePackedElementSolution<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct EnableHilbertElementOrder<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct LinearizationPrefetchDistance<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
+template<class TypeTag>
+struct EnableOwnerComputesLinearization<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct RetainLinearizationFluxes<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct PinThreads<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct AsyncThreadsPerProcess<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
+template<class TypeTag>
+struct AsyncThreadCpus<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+template<class TypeTag>
+struct ThreadPhaseSettings<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+template<class TypeTag>
+struct AutoTuneThreadPhases<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct EnableCommunicationThread<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct EnableNumaFirstTouch<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct EnableWarmTimeStepRetry<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+template<class TypeTag>
+struct SolutionExtrapolationOrder<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 0; };
+
+//! By default, the time step size is controlled using the number of Newton iterations
+template<class TypeTag>
+struct TimeStepController<TypeTag, TTag::FvBaseDiscretization> { using type = FvBaseTimeStepController<TypeTag>; };
+template<class TypeTag>
+struct TimeStepControl<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = "iteration-count"; };
+template<class TypeTag>
+struct TimeStepControlTolerance<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.1;
+};
+template<class TypeTag>
+struct PartialRelinearizationTolerance<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-10;
+};
 
 /*!
  * \brief Linearizer for the global system of equations.
@@ -247,6 +322,15 @@ struct MinTimeStepSize<TypeTag, TTag::FvBaseDiscretization>
 template<class TypeTag>
 struct EnableGridAdaptation<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+//! Redistribute the grid if the most loaded process exhibits 20% more elements than
+//! the average after an adaptation
+template<class TypeTag>
+struct GridAdaptationMaxLoadImbalance<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1.2;
+};
+
 //! By default, write the simulation output to the current working directory
 template<class TypeTag>
 struct OutputDir<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = "."; };
@@ -261,14 +345,70 @@ struct EnableVtkOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr b
 template<class TypeTag>
 struct EnableAsyncVtkOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
 
+//! By default, the VTK output is prepared by the main thread
+template<class TypeTag>
+struct EnableOverlappedVtkOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
 //! Set the format of the VTK output to ASCII by default
 template<class TypeTag>
 struct VtkOutputFormat<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = Dune::VTK::ascii; };
 
+//! Use the format given by the VtkOutputFormat property unless specified otherwise
+template<class TypeTag>
+struct VtkOutputType<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+
+//! Write the visualization output as VTK files by default
+template<class TypeTag>
+struct EnableXdmfOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! Write the full visualization output after each time step by default
+template<class TypeTag>
+struct VtkOutputAtEpisodeEndOnly<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! Do not write the sampled output by default
+template<class TypeTag>
+struct EnableSampledOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! If enabled, write the sampled output after each time step
+template<class TypeTag>
+struct SampledOutputInterval<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
+
+//! Sample every tenth element by default
+template<class TypeTag>
+struct SampledOutputStride<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 10; };
+
+//! Sample the whole grid by default
+template<class TypeTag>
+struct SampledOutputRegion<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+
+//! Write all fields of the sampled elements by default
+template<class TypeTag>
+struct SampledOutputFields<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+
+//! Do not write a time series of reduced quantities by default
+template<class TypeTag>
+struct EnableTimeSeriesOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! Keep the spatial parameters in the main memory by default
+template<class TypeTag>
+struct StaticDataMappingDir<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = ""; };
+
 // disable caching the storage term by default
 template<class TypeTag>
 struct EnableStorageCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+// keep the solution of the previous time level uncompressed by default
+template<class TypeTag>
+struct PreviousSolutionCompression<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = "none"; };
+
+// evaluate the boundary conditions for each linearization by default
+template<class TypeTag>
+struct EnableBoundaryCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+// evaluate the source terms for each linearization by default
+template<class TypeTag>
+struct EnableSourceCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
 // disable constraints by default
 template<class TypeTag>
 struct EnableConstraints<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
@@ -280,6 +420,14 @@ struct EnableConstraints<TypeTag, TTag::FvBaseDiscretization> { static constexpr
 template<class TypeTag>
 struct EnableIntensiveQuantityCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+//! by default, only the intensive quantities objects are cached
+template<class TypeTag>
+struct EnableIntensiveQuantityArrays<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+//! by default, the cached intensive quantities include their derivatives
+template<class TypeTag>
+struct EnableValueOnlyIntensiveQuantityCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
 // do not use thermodynamic hints by default. If you enable this, make sure to also
 // enable the intensive quantity cache above to avoid getting an exception...
 template<class TypeTag>
@@ -370,10 +518,20 @@ class FvBaseDiscretization
         historySize = getPropValue<TypeTag, Properties::TimeDiscHistorySize>(),
     };
 
-    using IntensiveQuantitiesVector = std::vector<IntensiveQuantities, aligned_allocator<IntensiveQuantities, alignof(IntensiveQuantities)> >;
+    using IntensiveQuantitiesAllocator = DeferredConstructionAllocator<IntensiveQuantities, alignof(IntensiveQuantities)>;
+    using IntensiveQuantitiesVector = std::vector<IntensiveQuantities, IntensiveQuantitiesAllocator>;
+    using IntensiveQuantityArrays = FvBaseIntensiveQuantityArrays<TypeTag>;
+    static constexpr bool enableIntensiveQuantityArrays = getPropValue<TypeTag, Properties::EnableIntensiveQuantityArrays>();
+    using ValueOnlyIntensiveQuantityCache = FvBaseValueOnlyIntensiveQuantityCache<TypeTag>;
+    using BoundaryCache = FvBaseBoundaryCache<TypeTag>;
+    using BoundaryFaceList = FvBaseBoundaryFaceList<TypeTag>;
+    using SourceCache = FvBaseSourceCache<TypeTag>;
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeedList = EntitySeedList<GridView, /*codim=*/0>;
+    using StructuredLayout = EcfvStructuredLayout<GridView>;
+    using ChunkedElementIterator = ChunkedEntityIterator<GridView, /*codim=*/0>;
 
     using Toolbox = MathToolbox<Evaluation>;
     using VectorBlock = Dune::FieldVector<Evaluation, numEq>;
@@ -411,6 +569,13 @@ class FvBaseDiscretization
     using RestrictProlong = Dune::Fem::RestrictProlongTuple< DiscreteFunctionRestrictProlong,  ProblemRestrictProlongOperator >;
     // adaptation classes
     using AdaptationManager = Dune::Fem::AdaptationManager<Grid, RestrictProlong  >;
+
+    // the persistent ids of the grid entities are used to find the degrees of freedom
+    // whose cached quantities survive an adaptation. they are attached to the elements
+    // for the element centered and to the vertices for the vertex centered scheme.
+    using GlobalId = typename Grid::GlobalIdSet::IdType;
+    static constexpr int dofCodim_ =
+        std::is_same<Discretization, EcfvDiscretization<TypeTag> >::value ? 0 : GridView::dimension;
 #else
     using DiscreteFunction = BlockVectorWrapper ;
     using DiscreteFunctionSpace = size_t             ;
@@ -428,6 +593,7 @@ public:
         , gridView_(simulator.gridView())
         , elementMapper_(gridView_, Dune::mcmgElementLayout())
         , vertexMapper_(gridView_, Dune::mcmgVertexLayout())
+        , elementSeeds_(gridView_)
         , newtonMethod_(simulator)
         , localLinearizer_(ThreadManager::maxThreads())
         , linearizer_(new Linearizer())
@@ -438,8 +604,26 @@ public:
 #endif
         , enableGridAdaptation_( EWOMS_GET_PARAM(TypeTag, bool, EnableGridAdaptation) )
         , enableIntensiveQuantityCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityCache))
+        , valueOnlyIntensiveQuantityCache_(enableIntensiveQuantityCache_
+                                           && EWOMS_GET_PARAM(TypeTag, bool, EnableValueOnlyIntensiveQuantityCache))
         , enableStorageCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache))
+        , enableBoundaryCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableBoundaryCache))
+        , enableSourceCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableSourceCache))
         , enableThermodynamicHints_(EWOMS_GET_PARAM(TypeTag, bool, EnableThermodynamicHints))
+        , threadedElementChunkSize_(static_cast<size_t>(std::max(1, EWOMS_GET_PARAM(TypeTag, int, ThreadedElementChunkSize))))
+        , stencilCacheMaxMemory_(static_cast<size_t>(std::max(0, EWOMS_GET_PARAM(TypeTag, int, StencilCacheMaxMemory)))*1024*1024)
+        , stencilCacheMemory_(0)
+        , enablePackedSolution_(EWOMS_GET_PARAM(TypeTag, bool, EnablePackedElementSolution))
+        , packedSolutionActive_(false)
+        , enableNumaFirstTouch_(EWOMS_GET_PARAM(TypeTag, bool, EnableNumaFirstTouch))
+        , enableWarmTimeStepRetry_(EWOMS_GET_PARAM(TypeTag, bool, EnableWarmTimeStepRetry))
+        , retryingTimeStep_(false)
+        , previousStorageCached_(false)
+        , compressPreviousSolution_(false)
+        , previousSolutionCompression_(CompressedSolutionVector::Mode::Delta)
+        , previousSolutionCompressed_(false)
+        , numExtrapolationLevels_(0)
+        , solutionExtrapolated_(false)
     {
 #if HAVE_DUNE_FEM
         if (enableGridAdaptation_ && !Dune::Fem::Capabilities::isLocallyAdaptive<Grid>::v)
@@ -450,28 +634,61 @@ public:
             throw std::invalid_argument("Grid adaptation currently requires the presence of the "
                                         "dune-fem module");
 #endif
-        bool isEcfv = std::is_same<Discretization, EcfvDiscretization<TypeTag> >::value;
-        if (enableGridAdaptation_ && !isEcfv)
-            throw std::invalid_argument("Grid adaptation currently only works for the "
-                                        "element-centered finite volume discretization (is: "
-                                        +Dune::className<Discretization>()+")");
+
+        if (valueOnlyIntensiveQuantityCache_ && !ValueOnlyIntensiveQuantityCache::supported())
+            throw std::invalid_argument("The value-only intensive quantity cache requires the "
+                                        "intensive quantities to be trivially copyable");
 
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
+        std::fill(localStorageValid_, localStorageValid_ + historySize, false);
+
+        const std::string compression = EWOMS_GET_PARAM(TypeTag, std::string, PreviousSolutionCompression);
+        if (compression != "none") {
+            if (!previousSolutionCompressible_())
+                throw std::invalid_argument("Compressing the previous solution requires the "
+                                            "primary variables to be trivially copyable and "
+                                            "is not available if dune-fem is used");
+            if (!enableStorageCache_)
+                throw std::invalid_argument("Compressing the previous solution requires the "
+                                            "storage cache to be enabled");
+            previousSolutionCompression_ = CompressedSolutionVector::modeFromString(compression);
+            compressPreviousSolution_ = true;
+        }
+
+        int extrapolationOrder = EWOMS_GET_PARAM(TypeTag, int, SolutionExtrapolationOrder);
+        if (extrapolationOrder < 0 || extrapolationOrder > 2)
+            throw std::invalid_argument("The order of the solution extrapolation must be 0, 1 "
+                                        "or 2 (is: "+std::to_string(extrapolationOrder)+")");
+        for (int levelIdx = 0; levelIdx < extrapolationOrder; ++levelIdx) {
+            extrapolationSolutions_.emplace_back(new SolutionVector());
+            extrapolationTimes_.push_back(0.0);
+        }
+
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableHilbertElementOrder))
+            elementSeeds_.sortByHilbertCurve();
+        updateStructuredLayout_();
 
         size_t numDof = asImp_().numGridDof();
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
             solution_[timeIdx].reset(new DiscreteFunction("solution", space_));
 
-            if (storeIntensiveQuantities()) {
-                intensiveQuantityCache_[timeIdx].resize(numDof);
+            if (storeIntensiveQuantities() && timeIdx < numCachedTimeLevels_()) {
+                if (valueOnlyIntensiveQuantityCache_)
+                    valueOnlyCache_[timeIdx].resize(numDof);
+                else
+                    resizeIntensiveQuantityCache_(intensiveQuantityCache_[timeIdx], numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof, /*value=*/false);
+                intensiveQuantityCacheFilled_[timeIdx].resize(numDof, /*value=*/false);
+                if (enableIntensiveQuantityArrays)
+                    intensiveQuantityArrays_[timeIdx].resize(numDof);
             }
 
-            if (enableStorageCache_)
+            if (enableStorageCache_ && timeIdx > 0)
                 storageCache_[timeIdx].resize(numDof);
         }
 
         resizeAndResetIntensiveQuantitiesCache_();
+        clearStencilCache();
         asImp_().registerOutputModules_();
     }
 
@@ -503,11 +720,52 @@ public:
         VtkPrimaryVarsModule<TypeTag>::registerParameters();
 
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableGridAdaptation, "Enable adaptive grid refinement/coarsening");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, GridAdaptationMaxLoadImbalance,
+                             "The largest acceptable ratio of the number of elements of the "
+                             "most loaded process and the average after adapting the grid");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableVtkOutput, "Global switch for turning on writing VTK files");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableThermodynamicHints, "Enable thermodynamic hints");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityCache, "Turn on caching of intensive quantities");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableValueOnlyIntensiveQuantityCache,
+                             "Only cache the values of the intensive quantities in a compact "
+                             "form, i.e., without their derivatives");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStorageCache, "Store previous storage terms and avoid re-calculating them.");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, PreviousSolutionCompression,
+                             "Keep the solution of the previous time level in a compressed "
+                             "form once its storage terms are cached: 'none', 'float' "
+                             "(lossy) or 'delta' (lossless). Requires the storage cache");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableBoundaryCache,
+                             "Evaluate the boundary conditions which do not depend on the "
+                             "solution only once per time step");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableSourceCache,
+                             "Evaluate the source terms which do not depend on the "
+                             "solution only once per time step");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, OutputDir, "The directory to which result files are written");
+        EWOMS_REGISTER_PARAM(TypeTag, int, ThreadedElementChunkSize,
+                             "The number of consecutive elements handed to a thread at once "
+                             "by multi-threaded loops over the grid");
+        EWOMS_REGISTER_PARAM(TypeTag, int, StencilCacheMaxMemory,
+                             "The maximum memory in megabytes used to keep the stencils of "
+                             "the grid elements between linearizations (0 disables the "
+                             "stencil cache)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnablePackedElementSolution,
+                             "Gather the primary variables of the stencils of all elements "
+                             "into a contiguous array before linearizing the domain");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableHilbertElementOrder,
+                             "Traverse the elements along a Hilbert space-filling curve in "
+                             "the multi-threaded loops over the grid");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableNumaFirstTouch,
+                             "Construct the cached quantities of the degrees of freedom in "
+                             "the threads which later work on them and statically assign "
+                             "the elements to the threads of the loops over the grid");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableWarmTimeStepRetry,
+                             "Reuse the intensive quantities and storage terms of the "
+                             "previous time level if a time step is retried");
+        EWOMS_REGISTER_PARAM(TypeTag, int, SolutionExtrapolationOrder,
+                             "The order of the extrapolation of the solutions of the last "
+                             "time steps which is used as the initial guess of the Newton "
+                             "method (0: use the solution of the last time step, 1: linear, "
+                             "2: quadratic)");
     }
 
     /*!
@@ -568,9 +826,14 @@ public:
         // sum up the volumes of the grid partitions
         gridTotalVolume_ = gridView_.comm().sum(gridTotalVolume_);
 
+        // finishInit() is called again whenever the grid changes, so the list of the
+        // boundary intersections always corresponds to the current grid
+        boundaryFaceList_.update(gridView_, asImp_().elementMapper());
+
         linearizer_->init(simulator_);
         for (unsigned threadId = 0; threadId < ThreadManager::maxThreads(); ++threadId)
             localLinearizer_[threadId].init(simulator_);
+        threadElementContexts_.clear();
 
         resizeAndResetIntensiveQuantitiesCache_();
         if (storeIntensiveQuantities()) {
@@ -591,6 +854,11 @@ public:
     /*!
      * \brief Applies the initial solution for all degrees of freedom to which the model
      *        applies.
+     *
+     * The elements are visited by all threads concurrently, so the problem's initial()
+     * method must be thread-safe like the other methods which are called during
+     * linearization. Afterwards, the intensive quantities of the initial solution are
+     * evaluated and cached for all time levels.
      */
     void applyInitialSolution()
     {
@@ -598,34 +866,70 @@ public:
         SolutionVector& uCur = asImp_().solution(/*timeIdx=*/0);
         uCur = Scalar(0.0);
 
-        ElementContext elemCtx(simulator_);
-
-        // iterate through the grid and evaluate the initial condition
-        ElementIterator elemIt = gridView_.template begin</*codim=*/0>();
-        const ElementIterator& elemEndIt = gridView_.template end</*codim=*/0>();
-        for (; elemIt != elemEndIt; ++elemIt) {
-            const Element& elem = *elemIt;
-            // ignore everything which is not in the interior if the
-            // current process' piece of the grid
-            if (elem.partitionType() != Dune::InteriorEntity)
-                continue;
-
-            // deal with the current element
-            elemCtx.updateStencil(elem);
+        // if the primary degrees of freedom are shared by multiple elements, the threads
+        // claim them, so that the initial condition of each one is only evaluated once
+        static constexpr bool dofsAreShared =
+            !std::is_same<Discretization, EcfvDiscretization<TypeTag> >::value;
+        size_t numDof = asImp_().numGridDof();
+        std::unique_ptr<std::atomic<bool>[]> dofClaimed;
+        if (dofsAreShared) {
+            dofClaimed.reset(new std::atomic<bool>[numDof]);
+            for (size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                dofClaimed[dofIdx].store(false, std::memory_order_relaxed);
+        }
 
-            // loop over all element vertices, i.e. sub control volumes
-            for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); dofIdx++)
-            {
-                // map the local degree of freedom index to the global one
-                unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+        // to avoid a race condition if two threads handle an exception at the same time,
+        // we use an explicit lock to control access to the exception storage object
+        // amongst thread-local handlers
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
 
-                // let the problem do the dirty work of nailing down
-                // the initial solution.
-                simulator_.problem().initial(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
-                asImp_().supplementInitialSolution_(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
-                uCur[globalIdx].checkDefined();
+        // iterate through the grid and evaluate the initial condition
+        ChunkedElementIterator chunkedElemIt(elementSeeds_, threadedElementChunkSize_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            try {
+                ElementContext elemCtx(simulator_);
+                size_t beginIdx, endIdx;
+                while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                    for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                        // ignore everything which is not in the interior if the
+                        // current process' piece of the grid
+                        if (!elementSeeds_.isInterior(elemIdx))
+                            continue;
+
+                        // deal with the current element
+                        elemCtx.updateStencil(elementSeeds_.entity(elemIdx));
+
+                        // loop over all element vertices, i.e. sub control volumes
+                        for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); dofIdx++) {
+                            // map the local degree of freedom index to the global one
+                            unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                            if (dofsAreShared
+                                && dofClaimed[globalIdx].exchange(true, std::memory_order_relaxed))
+                                continue; // another thread takes care of this DOF
+
+                            // let the problem do the dirty work of nailing down
+                            // the initial solution.
+                            simulator_.problem().initial(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
+                            asImp_().supplementInitialSolution_(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
+                            uCur[globalIdx].checkDefined();
+                        }
+                    }
+                }
             }
-        }
+            // an exception must not escape the parallel block, so it is stored and
+            // rethrown after the block has been left
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+        } // parallel block
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
 
         // synchronize the ghost DOFs (if necessary)
         asImp_().syncOverlap();
@@ -636,6 +940,14 @@ public:
         for (unsigned timeIdx = 1; timeIdx < historySize; ++timeIdx)
             solution(timeIdx) = solution(/*timeIdx=*/0);
 
+        // evaluate the intensive quantities of the initial solution using all threads,
+        // so that the initial output and the first time step find them in the cache
+        if (storeIntensiveQuantities()) {
+            invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+            for (unsigned timeIdx = 1; timeIdx < numCachedTimeLevels_(); ++timeIdx)
+                copyValidIntensiveQuantities_(timeIdx, /*srcTimeIdx=*/0);
+        }
+
 #ifndef NDEBUG
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx)  {
             const auto& sol = solution(timeIdx);
@@ -648,10 +960,28 @@ public:
     /*!
      * \brief Allows to improve the performance by prefetching all data which is
      *        associated with a given element.
-     */
-    void prefetch(const Element& elem OPM_UNUSED) const
+     *
+     * This prefetches the primary variables, the cached intensive quantities and the
+     * rows of the Jacobian matrix of the degrees of freedom of the element's
+     * stencil. Since determining the stencil is expensive, this requires the stencil
+     * cache to be enabled. If it is not, only the data of the degree of freedom which
+     * corresponds to the element itself is prefetched for the element-centered finite
+     * volume discretization. (Of course, prefetching does not change the results.)
+     */
+    void prefetch(const Element& elem) const
     {
-        // do nothing by default
+        if (packedSolutionActive_)
+            packedSolution_->prefetch(elem);
+
+        unsigned elemIdx = elementMapper_.index(elem);
+        const Stencil* stencil = cachedStencil(elemIdx);
+        if (stencil) {
+            unsigned numDof = stencil->numDof();
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                prefetchDof_(stencil->globalSpaceIndex(dofIdx));
+        }
+        else if (std::is_same<Discretization, EcfvDiscretization<TypeTag> >::value)
+            prefetchDof_(elemIdx);
     }
 
     /*!
@@ -675,27 +1005,44 @@ public:
      * relations while updating the intensive quantities. (This may yield a major
      * performance boost depending on how the physical models require.)
      *
-     * \attention If no up-to date intensive quantities are available, or if hints have been
-     *            disabled, this method will return 0.
+     * If the cached intensive quantities of the degree of freedom are not up to date,
+     * the ones of an earlier solution are returned if the cache holds any. This is
+     * usually the case if the cache has been invalidated by a Newton update.
+     *
+     * \attention If the cache does not hold any intensive quantities for the degree of
+     *            freedom, if hints have been disabled, or if the value-only intensive
+     *            quantity cache is used, this method will return 0.
      *
      * \param globalIdx The global space index for the entity where a hint is requested.
      * \param timeIdx The index used by the time discretization.
      */
     const IntensiveQuantities* thermodynamicHint(unsigned globalIdx, unsigned timeIdx) const
     {
-        if (!enableThermodynamicHints_)
+        if (!enableThermodynamicHints_ || valueOnlyIntensiveQuantityCache_)
             return 0;
 
         // the intensive quantities cache doubles as thermodynamic hint
-        return cachedIntensiveQuantities(globalIdx, timeIdx);
+        const IntensiveQuantities* intQuants = cachedIntensiveQuantities(globalIdx, timeIdx);
+        if (intQuants)
+            return intQuants;
+
+        // entries which are not up to date are still good starting points as long as
+        // they have been calculated for some solution
+        if (!enableIntensiveQuantityCache_
+            || timeIdx >= numCachedTimeLevels_()
+            || !intensiveQuantityCacheFilled_[timeIdx][globalIdx])
+            return 0;
+
+        return &intensiveQuantityCache_[timeIdx][globalIdx];
     }
 
     /*!
      * \brief Return the cached intensive quantities for a entity on the
      *        grid at given time.
      *
-     * \attention If no up-to date intensive quantities are available,
-     *            this method will return 0.
+     * \attention If no up-to date intensive quantities are available, or if the
+     *            value-only intensive quantity cache is used, this method will return
+     *            0. In the latter case, loadCachedIntensiveQuantities() must be used.
      *
      * \param globalIdx The global space index for the entity where a
      *                  hint is requested.
@@ -703,18 +1050,62 @@ public:
      */
     const IntensiveQuantities* cachedIntensiveQuantities(unsigned globalIdx, unsigned timeIdx) const
     {
-        if (!enableIntensiveQuantityCache_ ||
-            !intensiveQuantityCacheUpToDate_[timeIdx][globalIdx])
-            return 0;
-
-        if (timeIdx > 0 && enableStorageCache_)
+        if (!enableIntensiveQuantityCache_
+            || valueOnlyIntensiveQuantityCache_
+            || timeIdx >= numCachedTimeLevels_())
             // with the storage cache enabled, only the intensive quantities for the most
             // recent time step are cached!
             return 0;
 
+        if (!intensiveQuantityCacheUpToDate_[timeIdx][globalIdx])
+            return 0;
+
         return &intensiveQuantityCache_[timeIdx][globalIdx];
     }
 
+    /*!
+     * \brief Copy the cached intensive quantities for a entity on the grid at given
+     *        time into an object.
+     *
+     * In contrast to cachedIntensiveQuantities(), this also works for the value-only
+     * intensive quantity cache.
+     *
+     * \return false if no up-to date intensive quantities are available
+     *
+     * \param intQuants The object into which the intensive quantities are copied.
+     * \param globalIdx The global space index for the entity.
+     * \param timeIdx The index used by the time discretization.
+     */
+    bool loadCachedIntensiveQuantities(IntensiveQuantities& intQuants,
+                                       unsigned globalIdx,
+                                       unsigned timeIdx) const
+    {
+        if (!valueOnlyIntensiveQuantityCache_) {
+            const IntensiveQuantities* cachedIntQuants = cachedIntensiveQuantities(globalIdx, timeIdx);
+            if (!cachedIntQuants)
+                return false;
+
+            intQuants = *cachedIntQuants;
+            return true;
+        }
+
+        if (timeIdx >= numCachedTimeLevels_() || !intensiveQuantityCacheUpToDate_[timeIdx][globalIdx])
+            return false;
+
+        valueOnlyCache_[timeIdx].load(globalIdx, intQuants);
+        return true;
+    }
+
+    /*!
+     * \brief Returns true if the value-only intensive quantity cache is used.
+     *
+     * If this is the case, the intensive quantities which are stored in the cache must
+     * be computed without derivatives. The ones which are loaded from the cache also do
+     * not exhibit any.
+     */
+    bool valueOnlyIntensiveQuantityCache() const
+    { return valueOnlyIntensiveQuantityCache_; }
+
     /*!
      * \brief Update the intensive quantity cache for a entity on the grid at given time.
      *
@@ -727,11 +1118,35 @@ public:
                                          unsigned globalIdx,
                                          unsigned timeIdx) const
     {
-        if (!storeIntensiveQuantities())
+        if (!storeIntensiveQuantities() || timeIdx >= numCachedTimeLevels_())
             return;
 
-        intensiveQuantityCache_[timeIdx][globalIdx] = intQuants;
+        if (valueOnlyIntensiveQuantityCache_)
+            valueOnlyCache_[timeIdx].store(globalIdx, intQuants);
+        else
+            intensiveQuantityCache_[timeIdx][globalIdx] = intQuants;
+        if constexpr (enableIntensiveQuantityArrays)
+            intensiveQuantityArrays_[timeIdx].update(globalIdx, intQuants);
         intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = true;
+        intensiveQuantityCacheFilled_[timeIdx][globalIdx] = true;
+    }
+
+    /*!
+     * \brief Return the most important cached intensive quantities of all degrees of
+     *        freedom in a structure-of-arrays layout.
+     *
+     * An entry of the arrays is only meaningful if cachedIntensiveQuantities() returns
+     * a non-null pointer for the same degree of freedom. The arrays are only available
+     * if the EnableIntensiveQuantityArrays property is true.
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
+    const IntensiveQuantityArrays& intensiveQuantityArrays(unsigned timeIdx) const
+    {
+        static_assert(enableIntensiveQuantityArrays,
+                      "The EnableIntensiveQuantityArrays property must be true to use "
+                      "intensiveQuantityArrays()");
+        return intensiveQuantityArrays_[timeIdx];
     }
 
     /*!
@@ -745,7 +1160,7 @@ public:
                                                   unsigned timeIdx,
                                                   bool newValue) const
     {
-        if (!storeIntensiveQuantities())
+        if (!storeIntensiveQuantities() || timeIdx >= numCachedTimeLevels_())
             return;
 
         intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = newValue;
@@ -765,26 +1180,251 @@ public:
         }
     }
 
+    /*!
+     * \brief Invalidate the whole intensive quantity cache for time index and
+     *        recalculate all of its entries from the current solution.
+     *
+     * The cache is refreshed by all threads of the process using one element context
+     * per thread.
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
     void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx) const
     {
         invalidateIntensiveQuantitiesCache(timeIdx);
+        updateIntensiveQuantitiesCache(timeIdx);
+    }
+
+    /*!
+     * \brief Recalculate all entries of the intensive quantity cache for a time index
+     *        which are not up to date.
+     *
+     * Entries which are still valid are left alone, so this is cheap if only a few
+     * degrees of freedom have been invalidated using
+     * setIntensiveQuantitiesCacheEntryValidity().
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
+    void updateIntensiveQuantitiesCache(unsigned timeIdx) const
+    {
+        if (!storeIntensiveQuantities())
+            // there is nothing we could store the results in
+            return;
+
+        // create the per-thread context objects
+        if (threadElementContexts_.size() != ThreadManager::maxThreads()) {
+            threadElementContexts_.clear();
+            for (unsigned threadId = 0; threadId < ThreadManager::maxThreads(); ++threadId)
+                threadElementContexts_.emplace_back(new ElementContext(simulator_));
+        }
+
+        // for the element centered finite volume method, each element is the only
+        // primary degree of freedom of its own stencil. for other discretizations, the
+        // primary degrees of freedom are shared by multiple elements, so the threads
+        // need to claim them to avoid calculating and storing them more than once.
+        static constexpr bool dofsAreShared =
+            !std::is_same<Discretization, EcfvDiscretization<TypeTag> >::value;
+        size_t numDof = asImp_().numGridDof();
+        std::unique_ptr<std::atomic<bool>[]> dofClaimed;
+        if (dofsAreShared) {
+            dofClaimed.reset(new std::atomic<bool>[numDof]);
+            for (size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                dofClaimed[dofIdx].store(false, std::memory_order_relaxed);
+        }
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        ChunkedElementIterator chunkedElemIt(elementSeeds_, threadedElementChunkSize_);
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
         {
-            ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                elemCtx.updatePrimaryStencil(elem);
-                elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            ElementContext& elemCtx = *threadElementContexts_[ThreadManager::threadId()];
+            size_t beginIdx, endIdx;
+            while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                    // if the element is its own and only primary degree of freedom, the
+                    // validity of the cache entry can be checked without creating the
+                    // element. this makes refreshing a partially invalidated cache cheap.
+                    if (!dofsAreShared) {
+                        unsigned globalIdx = elementSeeds_.index(elemIdx);
+                        if (intensiveQuantityCacheUpToDate_[timeIdx][globalIdx])
+                            continue;
+                    }
+
+                    const Element elem = elementSeeds_.entity(elemIdx);
+
+                    elemCtx.updatePrimaryStencil(elem);
+
+                    size_t numPrimaryDof = elemCtx.numPrimaryDof(timeIdx);
+                    for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
+                        if (dofsAreShared
+                            && dofClaimed[globalIdx].exchange(true, std::memory_order_relaxed))
+                            continue; // another thread takes care of this DOF
+                        if (intensiveQuantityCacheUpToDate_[timeIdx][globalIdx])
+                            continue; // nothing to do
+
+                        elemCtx.updateDofIntensiveQuantities(dofIdx, timeIdx);
+                    }
+                }
             }
         }
     }
 
+    /*!
+     * \brief Prepare the stencil of a newly created element context.
+     *
+     * Discretizations may use this to attach data to the stencil which is shared by
+     * all element contexts. By default, nothing is done.
+     */
+    void initStencil(Stencil& stencil OPM_UNUSED) const
+    { }
+
+    /*!
+     * \brief Return the cached stencil of an element.
+     *
+     * \attention If the stencil of the element is not cached, this method returns 0.
+     *
+     * \param elemIdx The index of the element as given by the element mapper
+     */
+    const Stencil* cachedStencil(unsigned elemIdx) const
+    {
+        if (stencilCache_.empty())
+            return 0;
+
+        return stencilCache_[elemIdx].get();
+    }
+
+    /*!
+     * \brief Add the stencil of an element to the stencil cache.
+     *
+     * The stencil is only stored if this does not exceed the memory limit given by the
+     * StencilCacheMaxMemory parameter. The stencils of different elements may be added
+     * concurrently.
+     *
+     * \param stencil The stencil which has been updated for the element
+     * \param elemIdx The index of the element as given by the element mapper
+     */
+    void updateCachedStencil(const Stencil& stencil, unsigned elemIdx) const
+    {
+        if (stencilCache_.empty() || stencilCache_[elemIdx])
+            return;
+
+        size_t bytes = stencil.memoryUsage();
+        if (stencilCacheMemory_.fetch_add(bytes) + bytes > stencilCacheMaxMemory_) {
+            // the memory limit has been reached
+            stencilCacheMemory_ -= bytes;
+            return;
+        }
+
+        stencilCache_[elemIdx].reset(new Stencil(stencil));
+    }
+
+    /*!
+     * \brief Remove all stencils from the stencil cache.
+     *
+     * This needs to be called whenever the grid is modified.
+     */
+    void clearStencilCache()
+    {
+        stencilCache_.clear();
+        stencilCacheMemory_ = 0;
+        if (stencilCacheMaxMemory_ > 0)
+            stencilCache_.resize(static_cast<size_t>(gridView_.size(/*codim=*/0)));
+    }
+
+    /*!
+     * \brief Returns the number of bytes which are currently used by the stencil cache.
+     */
+    size_t stencilCacheMemory() const
+    { return stencilCacheMemory_; }
+
+    /*!
+     * \brief Record the memory held by the major data structures of the model and of
+     *        its linear solver with the MemoryAccounting.
+     */
+    void recordMemoryUsage() const
+    {
+        size_t solutionMemory = 0;
+        size_t cacheMemory = 0;
+        size_t storageMemory = 0;
+        for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
+            if (solution_[timeIdx])
+                solutionMemory += solution_[timeIdx]->blockVector().size()*sizeof(PrimaryVariables);
+            cacheMemory +=
+                intensiveQuantityCache_[timeIdx].capacity()*sizeof(IntensiveQuantities)
+                + valueOnlyCache_[timeIdx].memoryUsage()
+                + intensiveQuantityCacheUpToDate_[timeIdx].capacity()
+                + intensiveQuantityCacheFilled_[timeIdx].capacity();
+            storageMemory += storageCache_[timeIdx].size()*sizeof(EqVector);
+        }
+        for (const auto& extrapolationSolution : extrapolationSolutions_)
+            if (extrapolationSolution)
+                solutionMemory += extrapolationSolution->size()*sizeof(PrimaryVariables);
+        solutionMemory += compressedPreviousSolution_.memoryUsage();
+
+        size_t outputMemory = 0;
+        for (const auto* mod : outputModules_)
+            outputMemory += mod->bufferMemory();
+
+        MemoryAccounting::record("solution history", solutionMemory);
+        MemoryAccounting::record("intensive quantity cache", cacheMemory);
+        MemoryAccounting::record("storage cache", storageMemory);
+        MemoryAccounting::record("Jacobian matrix", linearizer_->memoryUsage());
+        MemoryAccounting::record("stencil cache", stencilCacheMemory_);
+        MemoryAccounting::record("boundary face list", boundaryFaceList_.memoryUsage());
+        MemoryAccounting::record("output buffers", outputMemory);
+        newtonMethod_.linearSolver().recordMemoryUsage();
+    }
+
+    /*!
+     * \brief Gather the most recent solution into the packed per-element solution.
+     *
+     * Until releasePackedSolution() is called, the element contexts read the primary
+     * variables of the most recent solution from this copy, i.e., the primary variables
+     * of all elements are streamed sequentially if the elements are visited in the
+     * order of their indices. The solution must thus not be modified in the meantime.
+     * If the EnablePackedElementSolution parameter is false, this is a no-op.
+     */
+    void updatePackedSolution()
+    {
+        if (!enablePackedSolution_)
+            return;
+
+        if (!packedSolution_) {
+            // establish the layout of the packed solution
+            packedSolution_.reset(new PackedSolution(gridView_, asImp_().dofMapper()));
+            packedSolution_->update([](PrimaryVariables&, const Stencil&, unsigned) { });
+        }
+
+        const auto& sol = solution(/*timeIdx=*/0);
+        packedSolution_->refresh([&sol](PrimaryVariables& dest, unsigned globalIdx)
+                                 { dest = sol[globalIdx]; });
+        packedSolutionActive_ = true;
+    }
+
+    /*!
+     * \brief Stop using the packed per-element solution.
+     */
+    void releasePackedSolution()
+    { packedSolutionActive_ = false; }
+
+    /*!
+     * \brief Return the primary variables of the most recent solution for the stencil of
+     *        an element.
+     *
+     * \attention If the packed solution is not in use, this method returns 0.
+     *
+     * \param elem The element for which the primary variables are requested
+     */
+    const PrimaryVariables* packedSolution(const Element& elem) const
+    {
+        if (!packedSolutionActive_)
+            return 0;
+
+        return packedSolution_->elementData(elem);
+    }
+
     /*!
      * \brief Move the intensive quantities for a given time index to the back.
      *
@@ -805,16 +1445,27 @@ public:
             return;
         }
 
-        assert(numSlots > 0);
-
-        for (unsigned timeIdx = 0; timeIdx < historySize - numSlots; ++ timeIdx) {
-            intensiveQuantityCache_[timeIdx + numSlots] = intensiveQuantityCache_[timeIdx];
-            intensiveQuantityCacheUpToDate_[timeIdx + numSlots] = intensiveQuantityCacheUpToDate_[timeIdx];
+        assert(0 < numSlots && numSlots < historySize);
+
+        // rotate the history instead of copying it: swapping the vectors only exchanges
+        // their buffers, so the objects of the oldest time levels end up in the most
+        // recent slots where they get overwritten below.
+        for (int timeIdx = historySize - 1; timeIdx >= static_cast<int>(numSlots); -- timeIdx) {
+            std::swap(intensiveQuantityCache_[timeIdx], intensiveQuantityCache_[timeIdx - numSlots]);
+            std::swap(valueOnlyCache_[timeIdx], valueOnlyCache_[timeIdx - numSlots]);
+            std::swap(intensiveQuantityCacheUpToDate_[timeIdx], intensiveQuantityCacheUpToDate_[timeIdx - numSlots]);
+            std::swap(intensiveQuantityCacheFilled_[timeIdx], intensiveQuantityCacheFilled_[timeIdx - numSlots]);
+            if constexpr (enableIntensiveQuantityArrays)
+                std::swap(intensiveQuantityArrays_[timeIdx], intensiveQuantityArrays_[timeIdx - numSlots]);
         }
 
         // the cache for the most recent time indices do not need to be invalidated
         // because the solution for them did not change (TODO: that assumes that there is
-        // no post-processing of the solution after a time step! fix it?)
+        // no post-processing of the solution after a time step! fix it?). Only the
+        // entries which are up to date need to be copied, everything else will be
+        // recomputed anyway.
+        for (unsigned timeIdx = 0; timeIdx < numSlots; ++ timeIdx)
+            copyValidIntensiveQuantities_(/*dstTimeIdx=*/timeIdx, /*srcTimeIdx=*/numSlots);
     }
 
     /*!
@@ -827,36 +1478,86 @@ public:
     { return enableStorageCache_; }
 
     /*!
-     * \brief Set the value of enable storage cache
-     *
-     * Be aware that calling the *CachedStorage() methods if the storage cache is
-     * disabled will crash the program.
+     * \brief Returns true iff the boundary rates which do not depend on the solution are
+     *        cached for each time step.
      */
-    void setEnableStorageCache(bool enableStorageCache)
-    { enableStorageCache_= enableStorageCache; }
+    bool enableBoundaryCache() const
+    { return enableBoundaryCache_; }
 
     /*!
-     * \brief Retrieve an entry of the cache for the storage term.
-     *
-     * This is supposed to represent a DOF's total amount of conservation quantities per
-     * volume unit at a given time. The user is responsible for making sure that the
-     * value of this is correct and that it can be used before this method is called.
+     * \brief Returns the cache of the boundary rates which do not depend on the
+     *        solution.
      *
-     * \param globalDofIdx The index of the relevant degree of freedom in a grid-global vector
-     * \param timeIdx The relevant index for the time discretization
+     * The entries of an element may only be modified by the thread which currently
+     * handles the element.
      */
-    const EqVector& cachedStorage(unsigned globalIdx, unsigned timeIdx) const
-    {
-        assert(enableStorageCache_);
-        return storageCache_[timeIdx][globalIdx];
-    }
+    BoundaryCache& boundaryCache() const
+    { return boundaryCache_; }
 
     /*!
-     * \brief Set an entry of the cache for the storage term.
+     * \brief Returns the list of the intersections of all elements which do not have a
+     *        neighbor.
      *
-     * This is supposed to represent a DOF's total amount of conservation quantities per
-     * volume unit at a given time. The user is responsible for making sure that the
-     * storage cache is enabled before this method is called.
+     * It is built by finishInit() for each version of the grid.
+     */
+    const BoundaryFaceList& boundaryFaceList() const
+    { return boundaryFaceList_; }
+
+    /*!
+     * \brief Returns true iff the source terms which do not depend on the solution are
+     *        cached for each time step.
+     */
+    bool enableSourceCache() const
+    { return enableSourceCache_; }
+
+    /*!
+     * \brief Returns the cache of the source terms which do not depend on the solution.
+     *
+     * The entries of an element may only be modified by the thread which currently
+     * handles the element.
+     */
+    SourceCache& sourceCache() const
+    { return sourceCache_; }
+
+    /*!
+     * \brief Set the value of enable storage cache
+     *
+     * Be aware that calling the *CachedStorage() methods if the storage cache is
+     * disabled will crash the program.
+     */
+    void setEnableStorageCache(bool enableStorageCache)
+    {
+        if (enableStorageCache_ == enableStorageCache)
+            return;
+
+        // the intensive quantities of the previous time levels are only cached if the
+        // storage term is not
+        enableStorageCache_ = enableStorageCache;
+        resizeAndResetIntensiveQuantitiesCache_();
+    }
+
+    /*!
+     * \brief Retrieve an entry of the cache for the storage term.
+     *
+     * This is supposed to represent a DOF's total amount of conservation quantities per
+     * volume unit at a given time. The user is responsible for making sure that the
+     * value of this is correct and that it can be used before this method is called.
+     *
+     * \param globalDofIdx The index of the relevant degree of freedom in a grid-global vector
+     * \param timeIdx The relevant index for the time discretization
+     */
+    const EqVector& cachedStorage(unsigned globalIdx, unsigned timeIdx) const
+    {
+        assert(enableStorageCache_);
+        return storageCache_[timeIdx][globalIdx];
+    }
+
+    /*!
+     * \brief Set an entry of the cache for the storage term.
+     *
+     * This is supposed to represent a DOF's total amount of conservation quantities per
+     * volume unit at a given time. The user is responsible for making sure that the
+     * storage cache is enabled before this method is called.
      *
      * \param globalDofIdx The index of the relevant degree of freedom in a grid-global vector
      * \param timeIdx The relevant index for the time discretization
@@ -893,10 +1594,11 @@ public:
      */
     Scalar globalResidual(GlobalEqVector& dest) const
     {
-        dest = 0;
+        BlockVectorKernels::fill(dest, 0.0);
 
+        constexpr bool useLock = getPropValue<TypeTag, Properties::UseLinearizationLock>();
         std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        ChunkedElementIterator chunkedElemIt(elementSeeds_, threadedElementChunkSize_);
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -905,27 +1607,33 @@ public:
             // moved in front of the #pragma!
             unsigned threadId = ThreadManager::threadId();
             ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
             LocalEvalBlockVector residual, storageTerm;
 
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    continue;
+            size_t beginIdx, endIdx;
+            while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                    if (!elementSeeds_.isInterior(elemIdx))
+                        continue;
+                    const Element elem = elementSeeds_.entity(elemIdx);
 
-                elemCtx.updateAll(elem);
-                residual.resize(elemCtx.numDof(/*timeIdx=*/0));
-                storageTerm.resize(elemCtx.numPrimaryDof(/*timeIdx=*/0));
-                asImp_().localResidual(threadId).eval(residual, elemCtx);
-
-                size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
-                mutex.lock();
-                for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
-                    unsigned globalI = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                        dest[globalI][eqIdx] += Toolbox::value(residual[dofIdx][eqIdx]);
+                    elemCtx.updateAll(elem);
+                    residual.resize(elemCtx.numDof(/*timeIdx=*/0));
+                    storageTerm.resize(elemCtx.numPrimaryDof(/*timeIdx=*/0));
+                    asImp_().localResidual(threadId).eval(residual, elemCtx);
+
+                    // if elements do not share primary degrees of freedom, each element
+                    // owns its rows and no lock is required
+                    size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                    if (useLock)
+                        mutex.lock();
+                    for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                        unsigned globalI = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                            dest[globalI][eqIdx] += Toolbox::value(residual[dofIdx][eqIdx]);
+                    }
+                    if (useLock)
+                        mutex.unlock();
                 }
-                mutex.unlock();
             }
         }
 
@@ -940,7 +1648,7 @@ public:
         // entirely correct, since the residual for the finite volumes
         // which are on the boundary are counted once for every
         // process. As often in life: shit happens (, we don't care)...
-        Scalar result2 = dest.two_norm2();
+        Scalar result2 = BlockVectorKernels::dot(dest, dest);
         result2 = asImp_().gridView().comm().sum(result2);
 
         return std::sqrt(result2);
@@ -950,51 +1658,25 @@ public:
      * \brief Compute the integral over the domain of the storage
      *        terms of all conservation quantities.
      *
+     * The partial sum of the local process is kept for the solutions of previous time
+     * steps because these do not change until the next call of solution() for a
+     * non-const model. If the storage term of the previous time step is cached for
+     * the linearization, it is summed up directly instead of being recalculated.
+     *
      * \copydetails Doxygen::storageParam
      */
     void globalStorage(EqVector& storage, unsigned timeIdx = 0) const
     {
-        storage = 0;
+        if (timeIdx == 0 || !localStorageValid_[timeIdx]) {
+            if (timeIdx == 1 && enableStorageCache_ && previousStorageCached_)
+                sumCachedStorage_(localStorage_[timeIdx]);
+            else
+                evalLocalStorage_(localStorage_[timeIdx], timeIdx);
 
-        std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-        {
-            // Attention: the variables below are thread specific and thus cannot be
-            // moved in front of the #pragma!
-            unsigned threadId = ThreadManager::threadId();
-            ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            LocalEvalBlockVector elemStorage;
-
-            // in this method, we need to disable the storage cache because we want to
-            // evaluate the storage term for other time indices than the most recent one
-            elemCtx.setEnableStorageCache(false);
-
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    continue; // ignore ghost and overlap elements
-
-                elemCtx.updateStencil(elem);
-                elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
-
-                size_t numPrimaryDof = elemCtx.numPrimaryDof(timeIdx);
-                elemStorage.resize(numPrimaryDof);
-
-                localResidual(threadId).evalStorage(elemStorage, elemCtx, timeIdx);
-
-                mutex.lock();
-                for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx)
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                        storage[eqIdx] += Toolbox::value(elemStorage[dofIdx][eqIdx]);
-                mutex.unlock();
-            }
+            localStorageValid_[timeIdx] = (timeIdx > 0);
         }
 
-        storage = gridView_.comm().sum(storage);
+        storage = gridView_.comm().sum(localStorage_[timeIdx]);
     }
 
     /*!
@@ -1038,10 +1720,18 @@ public:
             if (eIt->partitionType() != Dune::InteriorEntity)
                 continue; // ignore ghost and overlap elements
 
-            elemCtx.updateAll(*eIt);
+            // the extensive quantities are only required to evaluate the boundary
+            // conditions
+            bool onBoundary = eIt->hasBoundaryIntersections();
+            if (onBoundary)
+                elemCtx.updateAll(*eIt);
+            else {
+                elemCtx.updatePrimaryStencil(*eIt);
+                elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            }
 
             // handle the boundary terms
-            if (elemCtx.onBoundary()) {
+            if (onBoundary && elemCtx.onBoundary()) {
                 BoundaryContext boundaryCtx(elemCtx);
 
                 for (unsigned faceIdx = 0; faceIdx < boundaryCtx.numBoundaryFaces(/*timeIdx=*/0); ++faceIdx) {
@@ -1146,20 +1836,33 @@ public:
      * \param timeIdx The index of the solution used by the time discretization.
      */
     const SolutionVector& solution(unsigned timeIdx) const
-    { return solution_[timeIdx]->blockVector(); }
+    {
+        restorePreviousSolution_(timeIdx);
+        return solution_[timeIdx]->blockVector();
+    }
 
     /*!
      * \copydoc solution(int) const
      */
     SolutionVector& solution(unsigned timeIdx)
-    { return solution_[timeIdx]->blockVector(); }
+    {
+        // the solution may be modified, so the sum of its storage terms must be
+        // recalculated
+        localStorageValid_[timeIdx] = false;
+        restorePreviousSolution_(timeIdx);
+        return solution_[timeIdx]->blockVector();
+    }
 
   protected:
     /*!
      * \copydoc solution(int) const
      */
     SolutionVector& mutableSolution(unsigned timeIdx) const
-    { return solution_[timeIdx]->blockVector(); }
+    {
+        localStorageValid_[timeIdx] = false;
+        restorePreviousSolution_(timeIdx);
+        return solution_[timeIdx]->blockVector();
+    }
 
   public:
     /*!
@@ -1225,6 +1928,45 @@ public:
     Scalar eqWeight(unsigned globalVertexIdx OPM_UNUSED, unsigned eqIdx OPM_UNUSED) const
     { return 1.0; }
 
+    /*!
+     * \brief Evaluate the relative weights of the primary variables of all degrees of
+     *        freedom of the grid and store them in a contiguous array.
+     *
+     * Depending on the model, evaluating primaryVarWeight() can be relatively
+     * expensive, so the Newton method calls this once per iteration and then uses
+     * cachedPrimaryVarWeight() for all weights it needs.
+     */
+    void updatePrimaryVarWeights()
+    {
+        size_t numGridDof = asImp_().numGridDof();
+        primaryVarWeights_.resize(numGridDof*numEq);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            size_t beginIdx, endIdx;
+            ThreadManager::threadRange(numGridDof, ThreadManager::threadId(), beginIdx, endIdx);
+            for (size_t dofIdx = beginIdx; dofIdx < endIdx; ++dofIdx) {
+                Scalar* weights = primaryVarWeights_.data() + dofIdx*numEq;
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                    weights[pvIdx] = asImp_().primaryVarWeight(static_cast<unsigned>(dofIdx), pvIdx);
+            }
+        }
+    }
+
+    /*!
+     * \brief Returns the relative weight of a primary variable as of the last call of
+     *        updatePrimaryVarWeights().
+     *
+     * \param globalDofIdx The global index of the degree of freedom
+     * \param pvIdx The index of the primary variable
+     */
+    Scalar cachedPrimaryVarWeight(unsigned globalDofIdx, unsigned pvIdx) const
+    {
+        assert(static_cast<size_t>(globalDofIdx)*numEq + pvIdx < primaryVarWeights_.size());
+        return primaryVarWeights_[static_cast<size_t>(globalDofIdx)*numEq + pvIdx];
+    }
+
     /*!
      * \brief Returns the relative error between two vectors of
      *        primary variables.
@@ -1347,7 +2089,22 @@ public:
      *        which the actual model can overload.
      */
     void updateBegin()
-    { }
+    {
+        // the boundary conditions may depend on the time and the time step size
+        if (enableBoundaryCache_) {
+            boundaryCache_.resize(static_cast<size_t>(gridView_.size(/*codim=*/0)));
+            boundaryCache_.invalidate();
+        }
+
+        // the same applies to the source terms
+        if (enableSourceCache_) {
+            sourceCache_.resize(static_cast<size_t>(gridView_.size(/*codim=*/0)));
+            sourceCache_.invalidate();
+        }
+
+        if (!extrapolationSolutions_.empty())
+            extrapolateSolution_();
+    }
 
     /*!
      * \brief Called by the update() method if it was
@@ -1356,6 +2113,15 @@ public:
     void updateSuccessful()
     { }
 
+    /*!
+     * \brief Update the data structures of the discretization which depend on the grid.
+     *
+     * This is called by adaptGrid() after the grid has been modified and the mappers
+     * have been updated, but before the model is re-initialized.
+     */
+    void gridChanged()
+    { }
+
     /*!
      * \brief Called by the update() method when the grid should be refined.
      */
@@ -1369,14 +2135,61 @@ public:
             // check if problem allows for adaptation and cells were marked
             if( simulator_.problem().markForGridAdaptation() )
             {
+                // remember which entities carry the cached intensive quantities
+                std::vector<std::pair<GlobalId, unsigned> > oldDofIds;
+                std::vector<GlobalId> oldElementIds;
+                if (storeIntensiveQuantities())
+                    saveEntityIds_(oldDofIds, oldElementIds);
+
                 // adapt the grid and load balance if necessary
+                int oldGridSequenceNumber = simulator_.vanguard().gridSequenceNumber();
                 adaptationManager().adapt();
 
-                // if the grid has potentially changed, we need to re-create the
-                // supporting data structures.
+                // refinement tends to concentrate the elements on a few processes. if
+                // the partition has become too unbalanced, the grid is redistributed and
+                // the solution is migrated along with it.
+                auto& vanguard = simulator_.vanguard();
+                if (gridView_.comm().size() > 1
+                    && vanguard.loadImbalance() > EWOMS_GET_PARAM(TypeTag, Scalar, GridAdaptationMaxLoadImbalance))
+                    vanguard.loadBalanceAdaptedGrid();
+
+                // the marks do not necessarily change the grid, e.g., if all marked
+                // elements already exhibit the minimum or maximum refinement level. in
+                // this case, all data structures stay valid, i.e., the linearizer and the
+                // linear solver keep their matrices. since the re-initialization involves
+                // communication, the processes must agree on this.
+                int gridModified =
+                    simulator_.vanguard().gridSequenceNumber() != oldGridSequenceNumber;
+                if (!gridView_.comm().max(gridModified))
+                    return;
+
+                // if the grid has changed, we need to re-create the supporting data
+                // structures.
                 elementMapper_.update();
                 vertexMapper_.update();
+                elementSeeds_.update(gridView_);
+                if (EWOMS_GET_PARAM(TypeTag, bool, EnableHilbertElementOrder))
+                    elementSeeds_.sortByHilbertCurve();
+                updateStructuredLayout_();
+                clearStencilCache();
+                packedSolution_.reset();
                 resetLinearizer();
+                asImp_().gridChanged();
+
+                // the cache entries of the old grid are moved aside because finishInit()
+                // re-allocates the cache for the new one
+                IntensiveQuantitiesVector oldCache[historySize];
+                ValueOnlyIntensiveQuantityCache oldValueOnlyCache[historySize];
+                std::vector<unsigned char> oldUpToDate[historySize];
+                std::vector<unsigned char> oldFilled[historySize];
+                if (storeIntensiveQuantities()) {
+                    for (unsigned timeIdx = 0; timeIdx < numCachedTimeLevels_(); ++timeIdx) {
+                        std::swap(oldCache[timeIdx], intensiveQuantityCache_[timeIdx]);
+                        std::swap(oldValueOnlyCache[timeIdx], valueOnlyCache_[timeIdx]);
+                        std::swap(oldUpToDate[timeIdx], intensiveQuantityCacheUpToDate_[timeIdx]);
+                        std::swap(oldFilled[timeIdx], intensiveQuantityCacheFilled_[timeIdx]);
+                    }
+                }
 
                 // this is a bit hacky because it supposes that Problem::finishInit()
                 // works fine multiple times in a row.
@@ -1384,6 +2197,19 @@ public:
                 // TODO: move this to Problem::gridChanged()
                 finishInit();
 
+                // the intensive quantities of the degrees of freedom which were not
+                // affected by the adaptation do not need to be recalculated
+                if (storeIntensiveQuantities()) {
+                    const auto& oldDofIndices = oldDofIndices_(oldDofIds, oldElementIds);
+                    for (unsigned timeIdx = 0; timeIdx < numCachedTimeLevels_(); ++timeIdx)
+                        transferIntensiveQuantities_(timeIdx,
+                                                     oldDofIndices,
+                                                     oldCache[timeIdx],
+                                                     oldValueOnlyCache[timeIdx],
+                                                     oldUpToDate[timeIdx],
+                                                     oldFilled[timeIdx]);
+                }
+
                 // notify the problem that the grid has changed
                 //
                 // TODO: come up with a mechanism to access the unadapted data structures
@@ -1410,8 +2236,18 @@ public:
         // Reset the current solution to the one of the
         // previous time step so that we can start the next
         // update at a physically meaningful solution.
-        solution(/*timeIdx=*/0) = solution(/*timeIdx=*/1);
-        invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+        copySolution_(/*dstTimeIdx=*/0, /*srcTimeIdx=*/1);
+
+        // the retry starts at the solution of the previous time level, so the cached
+        // intensive quantities of that level are also valid for the current one. (the
+        // cache of the previous time level is not maintained if the storage term is
+        // cached, though.)
+        retryingTimeStep_ =
+            enableWarmTimeStepRetry_ && (!enableStorageCache() || previousStorageCached_);
+        if (retryingTimeStep_ && storeIntensiveQuantities() && !enableStorageCache())
+            copyValidIntensiveQuantities_(/*dstTimeIdx=*/0, /*srcTimeIdx=*/1);
+        else
+            invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
 
 #ifndef NDEBUG
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
@@ -1436,8 +2272,17 @@ public:
         // at this point we can adapt the grid
         asImp_().adaptGrid();
 
-        // make the current solution the previous one.
-        solution(/*timeIdx=*/1) = solution(/*timeIdx=*/0);
+        // remember the solution which is about to be overwritten if the initial guess
+        // of the Newton method is extrapolated
+        if (!extrapolationSolutions_.empty())
+            pushExtrapolationLevel_();
+
+        // make the current solution the previous one. (both solutions are identical
+        // afterwards, so one copy is needed regardless of how the history is stored.)
+        copySolution_(/*dstTimeIdx=*/1, /*srcTimeIdx=*/0);
+        retryingTimeStep_ = false;
+        previousStorageCached_ = false;
+        solutionExtrapolated_ = false;
 
         // shift the intensive quantities cache by one position in the
         // history
@@ -1472,6 +2317,59 @@ public:
                                  "does not support restart files. (deserialize() method unimplemented)");
     }
 
+    /*!
+     * \brief Write the state of the model into an in-memory snapshot.
+     *
+     * In addition to the data which is written to restart files, this includes the
+     * primary variables of the auxiliary degrees of freedom. Snapshots must be taken
+     * between two time steps.
+     *
+     * \param res The serializer object. It must use the binary format.
+     */
+    template <class Restarter>
+    void serializeSnapshot(Restarter& res)
+    {
+        asImp_().serialize(res);
+
+        const auto& sol = solution(/*timeIdx=*/0);
+        size_t numGridDof = asImp_().numGridDof();
+        res.serializeBinarySection("Auxiliary DOFs", [&](auto& stream) {
+            for (size_t dofIdx = numGridDof; dofIdx < sol.size(); ++dofIdx)
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    stream << sol[dofIdx][eqIdx];
+        });
+    }
+
+    /*!
+     * \brief Restore the state of the model from an in-memory snapshot.
+     *
+     * Since the simulation is resumed at a time level which is different from the
+     * current one, all cached quantities are discarded.
+     *
+     * \param res The deserializer object
+     */
+    template <class Restarter>
+    void deserializeSnapshot(Restarter& res)
+    {
+        asImp_().deserialize(res);
+
+        auto& sol = solution(/*timeIdx=*/0);
+        size_t numGridDof = asImp_().numGridDof();
+        res.deserializeBinarySection("Auxiliary DOFs", [&](auto& stream) {
+            for (size_t dofIdx = numGridDof; dofIdx < sol.size(); ++dofIdx)
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    stream >> sol[dofIdx][eqIdx];
+        });
+
+        copySolution_(/*dstTimeIdx=*/1, /*srcTimeIdx=*/0);
+        retryingTimeStep_ = false;
+        previousStorageCached_ = false;
+        solutionExtrapolated_ = false;
+        numExtrapolationLevels_ = 0;
+        for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx)
+            invalidateIntensiveQuantitiesCache(timeIdx);
+    }
+
     /*!
      * \brief Write the current solution for a degree of freedom to a
      *        restart file.
@@ -1480,8 +2378,8 @@ public:
      *                  be serialized to
      * \param dof The Dune entity which's data should be serialized
      */
-    template <class DofEntity>
-    void serializeEntity(std::ostream& outstream,
+    template <class Stream, class DofEntity>
+    void serializeEntity(Stream& outstream,
                          const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
@@ -1505,8 +2403,8 @@ public:
      *                  be deserialized from
      * \param dof The Dune entity which's data should be deserialized
      */
-    template <class DofEntity>
-    void deserializeEntity(std::istream& instream,
+    template <class Stream, class DofEntity>
+    void deserializeEntity(Stream& instream,
                            const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
@@ -1564,6 +2462,97 @@ public:
     const ElementMapper& elementMapper() const
     { return elementMapper_; }
 
+    /*!
+     * \brief Returns the seeds of all elements of the local grid partition.
+     *
+     * The list is only re-created if the grid changes. It is used to distribute the
+     * elements amongst the threads of multi-threaded loops over the grid.
+     */
+    const ElementSeedList& elementSeeds() const
+    { return elementSeeds_; }
+
+    /*!
+     * \brief Returns the lattice which is formed by the elements of the local grid
+     *        partition.
+     *
+     * The layout is only structured for the ECFV discretization on Cartesian grids.
+     * In this case, the degrees of freedom are the elements, so their neighbors follow
+     * from index arithmetic.
+     */
+    const StructuredLayout& structuredLayout() const
+    { return structuredLayout_; }
+
+    /*!
+     * \brief Returns the number of consecutive elements which are handed to a thread
+     *        at once by multi-threaded loops over the grid.
+     */
+    size_t threadedElementChunkSize() const
+    { return threadedElementChunkSize_; }
+
+    /*!
+     * \brief Returns true if the multi-threaded loops over the grid must statically
+     *        partition the elements amongst the threads.
+     *
+     * This is the case if the EnableNumaFirstTouch parameter is true: The data of the
+     * degrees of freedom is then first touched using the same partition.
+     */
+    bool staticElementPartition() const
+    { return enableNumaFirstTouch_; }
+
+    /*!
+     * \brief Returns true if the storage term of the first Newton iteration of a time
+     *        step may be used as the one of the previous time level.
+     *
+     * This is the case if the problem allows it and if the initial guess of the Newton
+     * method is the solution of the previous time step, i.e., it was not extrapolated.
+     */
+    bool recycleFirstIterationStorage() const
+    { return !solutionExtrapolated_ && simulator_.problem().recycleFirstIterationStorage(); }
+
+    /*!
+     * \brief Returns true if the current time step is retried after a failed attempt and
+     *        the data of the previous time level which is still valid ought to be reused.
+     *
+     * In this case, the cached storage terms of the previous time level are kept and the
+     * Newton method does not recalculate the cached intensive quantities which are
+     * already up to date in its first iteration.
+     */
+    bool retryingTimeStep() const
+    { return retryingTimeStep_; }
+
+    /*!
+     * \brief Specify whether the cached storage terms of the previous time level have been
+     *        calculated for all degrees of freedom.
+     *
+     * This is done by the Newton method once the linearization of its first iteration
+     * completed.
+     */
+    void setPreviousStorageCached(bool yesno)
+    { previousStorageCached_ = yesno; }
+
+    /*!
+     * \brief Compress the solution of the previous time level if this is enabled by the
+     *        PreviousSolutionCompression parameter.
+     *
+     * This only happens once the storage terms of the previous time level have been
+     * cached, because the solution is then only needed to restart a failed time step and
+     * by some heuristics. Its memory is released and it is transparently restored by the
+     * next call of solution() for the previous time level. This must not be called while
+     * other threads access the solution.
+     */
+    void compressPreviousSolution()
+    {
+        if constexpr (previousSolutionCompressible_()) {
+            if (!compressPreviousSolution_ || !previousStorageCached_ || previousSolutionCompressed_)
+                return;
+
+            compressedPreviousSolution_.compress(solution_[/*timeIdx=*/1]->blockVector(),
+                                                 previousSolutionCompression_);
+            solution_[/*timeIdx=*/1].reset(new DiscreteFunction("solution", /*size=*/0));
+            previousSolutionCompressed_.store(true, std::memory_order_release);
+        }
+    }
+
     /*!
      * \brief Resets the Jacobian matrix linearizer, so that the
      *        boundary types can be altered.
@@ -1614,6 +2603,35 @@ public:
     void updatePVWeights(const ElementContext& elemCtx OPM_UNUSED) const
     { }
 
+    /*!
+     * \brief Called by the linearizer before the elements are linearized if the
+     *        RetainLinearizationFluxes parameter is true.
+     *
+     * Models which keep the fluxes of the faces of the elements must consider them to
+     * be invalid until endFluxRetention() is called. By default, no fluxes are kept.
+     */
+    void beginFluxRetention()
+    { }
+
+    /*!
+     * \brief Keep the fluxes of the faces of an element which has just been linearized.
+     *
+     * This is called concurrently for different elements. The extensive quantities of
+     * the context correspond to the linearized solution, or to a perturbation of it by
+     * the numeric epsilon if finite differences are used.
+     *
+     * \copydetails Doxygen::ecfvElemCtxParam
+     */
+    void retainFluxes(const ElementContext& elemCtx OPM_UNUSED)
+    { }
+
+    /*!
+     * \brief Called by the linearizer after all elements have been linearized
+     *        successfully if the RetainLinearizationFluxes parameter is true.
+     */
+    void endFluxRetention()
+    { }
+
     /*!
      * \brief Add an module for writing visualization output after a timestep.
      */
@@ -1716,46 +2734,97 @@ public:
     /*!
      * \brief Prepare the quantities relevant for the current solution
      *        to be appended to the output writers.
+     *
+     * If a solution snapshot is specified, the quantities are calculated from it instead
+     * of the current solution and the caches of the model are not used. In this case,
+     * the method may be called by a thread that runs concurrently to the simulation,
+     * and it does not spawn any threads itself.
      */
-    void prepareOutputFields() const
+    void prepareOutputFields(const SolutionVector* solutionSnapshot = nullptr) const
     {
+        // determine the modules which actually write something. the others are skipped
+        // altogether, and if no module is left, the grid does not need to be visited.
+        std::vector<BaseOutputModule<TypeTag>*> activeModules;
         bool needFullContextUpdate = false;
-        auto modIt = outputModules_.begin();
-        const auto& modEndIt = outputModules_.end();
-        for (; modIt != modEndIt; ++modIt) {
-            (*modIt)->allocBuffers();
-            needFullContextUpdate = needFullContextUpdate || (*modIt)->needExtensiveQuantities();
+        for (auto* mod : outputModules_) {
+            if (!mod->hasEnabledFields())
+                continue;
+
+            activeModules.push_back(mod);
+            mod->setConcurrentOutput(solutionSnapshot != nullptr);
+            mod->allocBuffers();
+            needFullContextUpdate = needFullContextUpdate || mod->needExtensiveQuantities();
         }
 
+        if (activeModules.empty())
+            return;
+
+        // the modules write the quantities of the primary degrees of freedom of an
+        // element into their buffers. if these are not unique to the element or if a
+        // module accumulates quantities of the faces into the buffers of the neighboring
+        // degrees of freedom, the buffers are updated under a lock. the element contexts,
+        // which dominate the cost of preparing the output, are updated by all threads
+        // concurrently, though.
+        std::mutex bufferMutex;
+
+        // to avoid a race condition if two threads handle an exception at the same time,
+        // we use an explicit lock to control access to the exception storage object
+        // amongst thread-local handlers
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
         // iterate over grid
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        ChunkedElementIterator chunkedElemIt(elementSeeds_, threadedElementChunkSize_);
 #ifdef _OPENMP
-#pragma omp parallel
+#pragma omp parallel if(!solutionSnapshot)
 #endif
         {
-            ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const auto& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    // ignore non-interior entities
-                    continue;
-
-                if (needFullContextUpdate)
-                    elemCtx.updateAll(elem);
-                else {
-                    elemCtx.updatePrimaryStencil(elem);
-                    elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            try {
+                ElementContext elemCtx(simulator_);
+                elemCtx.setSolutionSnapshot(solutionSnapshot);
+                size_t beginIdx, endIdx;
+                while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                    for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                        if (!elementSeeds_.isInterior(elemIdx))
+                            // ignore non-interior entities
+                            continue;
+                        const Element elem = elementSeeds_.entity(elemIdx);
+
+                        if (needFullContextUpdate && solutionSnapshot) {
+                            // the snapshot only covers the most recent solution
+                            elemCtx.updateStencil(elem);
+                            elemCtx.updateIntensiveQuantities(/*timeIdx=*/0);
+                            elemCtx.updateExtensiveQuantities(/*timeIdx=*/0);
+                        }
+                        else if (needFullContextUpdate)
+                            elemCtx.updateAll(elem);
+                        else {
+                            elemCtx.updatePrimaryStencil(elem);
+                            elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+                        }
+
+                        bool dofsShared = elemCtx.numPrimaryDof(/*timeIdx=*/0) > 1;
+                        for (auto* mod : activeModules) {
+                            if (dofsShared || mod->writesNeighborDofs()) {
+                                std::lock_guard<std::mutex> guard(bufferMutex);
+                                mod->processElement(elemCtx);
+                            }
+                            else
+                                mod->processElement(elemCtx);
+                        }
+                    }
                 }
-
-                // we cannot reuse the "modIt" variable here because the code here might
-                // be threaded and "modIt" is is the same for all threads, i.e., if a
-                // given thread modifies it, the changes affect all threads.
-                auto modIt2 = outputModules_.begin();
-                for (; modIt2 != modEndIt; ++modIt2)
-                    (*modIt2)->processElement(elemCtx);
             }
-        }
+            // an exception must not escape the parallel block, so it is stored and
+            // rethrown after the block has been left
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+        } // parallel block
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
     }
 
     /*!
@@ -1767,7 +2836,8 @@ public:
         auto modIt = outputModules_.begin();
         const auto& modEndIt = outputModules_.end();
         for (; modIt != modEndIt; ++modIt)
-            (*modIt)->commitBuffers(writer);
+            if ((*modIt)->hasEnabledFields())
+                (*modIt)->commitBuffers(writer);
     }
 
     /*!
@@ -1872,12 +2942,375 @@ public:
     { return updateTimer_; }
 
 protected:
+    void prefetchDof_(unsigned globalIdx) const
+    {
+        if (!packedSolutionActive_)
+            ::Opm::prefetch</*temporalLocality=*/1>(solution(/*timeIdx=*/0)[globalIdx]);
+        if (enableIntensiveQuantityCache_ && !valueOnlyIntensiveQuantityCache_)
+            ::Opm::prefetch</*temporalLocality=*/1>(intensiveQuantityCache_[/*timeIdx=*/0][globalIdx]);
+        linearizer_->prefetchJacobianRow(globalIdx);
+    }
+
+    // the allocator of the intensive quantity cache defers the construction of new
+    // objects. if NUMA-aware first touch is enabled, each of them is constructed by the
+    // thread to which the corresponding element is assigned by the static partition of
+    // the grid loops. this is only exact for the element-centered finite volume
+    // discretization; for others the degrees of freedom themselves get partitioned.
+    void resizeIntensiveQuantityCache_(IntensiveQuantitiesVector& cache, size_t numDof) const
+    {
+        size_t oldSize = std::min(cache.size(), numDof);
+        cache.resize(numDof);
+
+        if (!enableNumaFirstTouch_) {
+            for (size_t dofIdx = oldSize; dofIdx < numDof; ++dofIdx)
+                IntensiveQuantitiesAllocator::constructDeferred(&cache[dofIdx]);
+            return;
+        }
+
+        bool isEcfv =
+            std::is_same<Discretization, EcfvDiscretization<TypeTag> >::value
+            && elementSeeds_.size() == numDof;
+        size_t numEntities = isEcfv ? elementSeeds_.size() : numDof;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            size_t beginIdx, endIdx;
+            ThreadManager::threadRange(numEntities, ThreadManager::threadId(), beginIdx, endIdx);
+            for (size_t idx = beginIdx; idx < endIdx; ++idx) {
+                size_t dofIdx = isEcfv ? elementSeeds_.index(idx) : idx;
+                if (dofIdx >= oldSize)
+                    IntensiveQuantitiesAllocator::constructDeferred(&cache[dofIdx]);
+            }
+        }
+    }
+
+    /*!
+     * \brief Copy the solution of a time level to another one.
+     *
+     * The copy is done by the threads which "own" the respective degrees of freedom, so
+     * that the memory pages of the solution vectors do not migrate between NUMA nodes.
+     */
+    // calculate the integral of the storage terms over the interior elements of the
+    // local process
+    void evalLocalStorage_(EqVector& storage, unsigned timeIdx) const
+    {
+        storage = 0;
+
+        std::mutex mutex;
+        ChunkedElementIterator chunkedElemIt(elementSeeds_, threadedElementChunkSize_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            // Attention: the variables below are thread specific and thus cannot be
+            // moved in front of the #pragma!
+            unsigned threadId = ThreadManager::threadId();
+            ElementContext elemCtx(simulator_);
+            LocalEvalBlockVector elemStorage;
+            EqVector threadStorage(0.0);
+
+            // in this method, we need to disable the storage cache because we want to
+            // evaluate the storage term for other time indices than the most recent one
+            elemCtx.setEnableStorageCache(false);
+
+            size_t beginIdx, endIdx;
+            while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                    if (!elementSeeds_.isInterior(elemIdx))
+                        continue; // ignore ghost and overlap elements
+                    const Element elem = elementSeeds_.entity(elemIdx);
+
+                    // the storage term only depends on the primary degrees of freedom
+                    elemCtx.updatePrimaryStencil(elem);
+                    elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
+
+                    size_t numPrimaryDof = elemCtx.numPrimaryDof(timeIdx);
+                    elemStorage.resize(numPrimaryDof);
+
+                    localResidual(threadId).evalStorage(elemStorage, elemCtx, timeIdx);
+
+                    for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx)
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                            threadStorage[eqIdx] += Toolbox::value(elemStorage[dofIdx][eqIdx]);
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(mutex);
+            storage += threadStorage;
+        }
+    }
+
+    // calculate the integral of the cached storage terms of the previous time step
+    // over the interior elements of the local process. the cache stores the storage
+    // terms per unit volume.
+    void sumCachedStorage_(EqVector& storage) const
+    {
+        storage = 0;
+
+        std::mutex mutex;
+        ChunkedElementIterator chunkedElemIt(elementSeeds_, threadedElementChunkSize_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementContext elemCtx(simulator_);
+            EqVector threadStorage(0.0);
+
+            size_t beginIdx, endIdx;
+            while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                    if (!elementSeeds_.isInterior(elemIdx))
+                        continue; // ignore ghost and overlap elements
+                    const Element elem = elementSeeds_.entity(elemIdx);
+
+                    elemCtx.updatePrimaryStencil(elem);
+
+                    size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                        Scalar alpha =
+                            elemCtx.stencil(/*timeIdx=*/0).subControlVolume(dofIdx).volume()
+                            * simulator_.problem().extrusionFactor(elemCtx, dofIdx, /*timeIdx=*/0);
+
+                        const auto& dofStorage = storageCache_[/*timeIdx=*/1][globalIdx];
+                        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                            threadStorage[eqIdx] += dofStorage[eqIdx]*alpha;
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(mutex);
+            storage += threadStorage;
+        }
+    }
+
+    void copySolution_(unsigned dstTimeIdx, unsigned srcTimeIdx)
+    {
+        // a compressed solution which is about to be overwritten does not need to be
+        // restored. its empty vector is reallocated below.
+        if (dstTimeIdx == 1 && previousSolutionCompressed_) {
+            compressedPreviousSolution_.clear();
+            previousSolutionCompressed_ = false;
+        }
+
+        auto& dst = solution(dstTimeIdx);
+        const auto& src = solution(srcTimeIdx);
+        if (dst.size() != src.size()) {
+            // the grid was adapted: the vectors need to be reallocated
+            dst = src;
+            return;
+        }
+
+        BlockVectorKernels::copy(dst, src);
+    }
+
+#if HAVE_DUNE_FEM
+    // store the persistent ids of the entities which carry the degrees of freedom and
+    // their indices, as well as the ids of the elements (vertex centered scheme only),
+    // sorted by id
+    void saveEntityIds_(std::vector<std::pair<GlobalId, unsigned> >& dofIds,
+                        std::vector<GlobalId>& elementIds) const
+    {
+        const auto& idSet = simulator_.vanguard().grid().globalIdSet();
+        const auto& dofMapper = asImp_().dofMapper();
+
+        dofIds.clear();
+        for (const auto& entity : entities(gridView_, Dune::Codim<dofCodim_>()))
+            dofIds.emplace_back(idSet.id(entity), static_cast<unsigned>(dofMapper.index(entity)));
+        std::sort(dofIds.begin(), dofIds.end());
+
+        elementIds.clear();
+        if (dofCodim_ == 0)
+            return; // the degrees of freedom are the elements
+
+        for (const auto& elem : elements(gridView_))
+            elementIds.push_back(idSet.id(elem));
+        std::sort(elementIds.begin(), elementIds.end());
+    }
+
+    // determine the index which each degree of freedom of the adapted grid exhibited
+    // before the adaptation. the result is -1 for new degrees of freedom as well as
+    // for the vertices of new elements, because the control volumes of the latter
+    // have changed.
+    std::vector<int> oldDofIndices_(const std::vector<std::pair<GlobalId, unsigned> >& dofIds,
+                                    const std::vector<GlobalId>& elementIds) const
+    {
+        const auto& idSet = simulator_.vanguard().grid().globalIdSet();
+        const auto& dofMapper = asImp_().dofMapper();
+
+        std::vector<int> result(asImp_().numGridDof(), -1);
+        for (const auto& entity : entities(gridView_, Dune::Codim<dofCodim_>())) {
+            const GlobalId& id = idSet.id(entity);
+            auto it = std::lower_bound(dofIds.begin(), dofIds.end(), id,
+                                       [](const std::pair<GlobalId, unsigned>& entry,
+                                          const GlobalId& value)
+                                       { return entry.first < value; });
+            if (it != dofIds.end() && it->first == id)
+                result[dofMapper.index(entity)] = static_cast<int>(it->second);
+        }
+
+        if (dofCodim_ == 0)
+            return result;
+
+        for (const auto& elem : elements(gridView_)) {
+            if (std::binary_search(elementIds.begin(), elementIds.end(), idSet.id(elem)))
+                continue;
+
+            unsigned numDof = elem.subEntities(dofCodim_);
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                result[dofMapper.subIndex(elem, dofIdx, dofCodim_)] = -1;
+        }
+
+        return result;
+    }
+
+    // move the cached intensive quantities of a time level from the cache of the grid
+    // before adaptation to the one of the adapted grid
+    void transferIntensiveQuantities_(unsigned timeIdx,
+                                      const std::vector<int>& oldDofIndices,
+                                      IntensiveQuantitiesVector& oldCache,
+                                      const ValueOnlyIntensiveQuantityCache& oldValueOnlyCache,
+                                      const std::vector<unsigned char>& oldUpToDate,
+                                      const std::vector<unsigned char>& oldFilled)
+    {
+        auto& upToDate = intensiveQuantityCacheUpToDate_[timeIdx];
+        auto& filled = intensiveQuantityCacheFilled_[timeIdx];
+        size_t numDof = oldDofIndices.size();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            size_t beginIdx, endIdx;
+            ThreadManager::threadRange(numDof, ThreadManager::threadId(), beginIdx, endIdx);
+            for (size_t dofIdx = beginIdx; dofIdx < endIdx; ++dofIdx) {
+                int oldIdx = oldDofIndices[dofIdx];
+                if (oldIdx < 0 || !oldFilled[static_cast<size_t>(oldIdx)])
+                    continue;
+
+                unsigned newIdx = static_cast<unsigned>(dofIdx);
+                unsigned srcIdx = static_cast<unsigned>(oldIdx);
+                upToDate[dofIdx] = oldUpToDate[srcIdx];
+                filled[dofIdx] = true;
+                if (valueOnlyIntensiveQuantityCache_) {
+                    valueOnlyCache_[timeIdx].assignEntry(newIdx, oldValueOnlyCache, srcIdx);
+                    if constexpr (enableIntensiveQuantityArrays) {
+                        if (upToDate[dofIdx]) {
+                            IntensiveQuantities intQuants;
+                            oldValueOnlyCache.load(srcIdx, intQuants);
+                            intensiveQuantityArrays_[timeIdx].update(newIdx, intQuants);
+                        }
+                    }
+                    continue;
+                }
+
+                intensiveQuantityCache_[timeIdx][dofIdx] = std::move(oldCache[srcIdx]);
+                if constexpr (enableIntensiveQuantityArrays) {
+                    if (upToDate[dofIdx])
+                        intensiveQuantityArrays_[timeIdx].update(newIdx, intensiveQuantityCache_[timeIdx][dofIdx]);
+                }
+            }
+        }
+    }
+#endif
+
+    /*!
+     * \brief Copy the up-to-date entries of the intensive quantity cache of a time
+     *        level to the ones of another time level.
+     *
+     * Entries which are not up to date are only marked as such for the destination.
+     */
+    void copyValidIntensiveQuantities_(unsigned dstTimeIdx, unsigned srcTimeIdx)
+    {
+        const auto& srcCache = intensiveQuantityCache_[srcTimeIdx];
+        const auto& srcUpToDate = intensiveQuantityCacheUpToDate_[srcTimeIdx];
+        auto& dstCache = intensiveQuantityCache_[dstTimeIdx];
+        auto& dstUpToDate = intensiveQuantityCacheUpToDate_[dstTimeIdx];
+        auto& dstFilled = intensiveQuantityCacheFilled_[dstTimeIdx];
+        assert(dstCache.size() == srcCache.size());
+        assert(valueOnlyCache_[dstTimeIdx].size() == valueOnlyCache_[srcTimeIdx].size());
+
+        dstUpToDate = srcUpToDate;
+        size_t numDof = srcUpToDate.size();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            size_t beginIdx, endIdx;
+            ThreadManager::threadRange(numDof, ThreadManager::threadId(), beginIdx, endIdx);
+            for (size_t dofIdx = beginIdx; dofIdx < endIdx; ++dofIdx) {
+                if (!srcUpToDate[dofIdx])
+                    continue;
+
+                dstFilled[dofIdx] = true;
+                if (valueOnlyIntensiveQuantityCache_) {
+                    valueOnlyCache_[dstTimeIdx].assignEntry(dofIdx, valueOnlyCache_[srcTimeIdx]);
+                    if constexpr (enableIntensiveQuantityArrays) {
+                        IntensiveQuantities intQuants;
+                        valueOnlyCache_[srcTimeIdx].load(dofIdx, intQuants);
+                        intensiveQuantityArrays_[dstTimeIdx].update(dofIdx, intQuants);
+                    }
+                    continue;
+                }
+
+                dstCache[dofIdx] = srcCache[dofIdx];
+                if constexpr (enableIntensiveQuantityArrays)
+                    intensiveQuantityArrays_[dstTimeIdx].update(dofIdx, srcCache[dofIdx]);
+            }
+        }
+    }
+
+    // the solution of the previous time level can only be compressed if it is not
+    // managed by dune-fem and if its blocks can be copied bytewise
+    static constexpr bool previousSolutionCompressible_()
+    {
+        return CompressedSolutionVector::supported()
+            && std::is_same<DiscreteFunction, BlockVectorWrapper>::value;
+    }
+
+    // decompress the solution of the previous time level if it is accessed while being
+    // compressed. the lock is only taken if the solution is compressed, so concurrent
+    // accesses are cheap.
+    void restorePreviousSolution_(unsigned timeIdx) const
+    {
+        if (timeIdx != 1 || !previousSolutionCompressed_.load(std::memory_order_acquire))
+            return;
+
+        if constexpr (previousSolutionCompressible_()) {
+            std::lock_guard<std::mutex> guard(previousSolutionMutex_);
+            if (!previousSolutionCompressed_.load(std::memory_order_relaxed))
+                return; // another thread was faster
+
+            std::unique_ptr<DiscreteFunction> restored(new DiscreteFunction("solution", /*size=*/0));
+            compressedPreviousSolution_.decompress(restored->blockVector());
+            solution_[/*timeIdx=*/1] = std::move(restored);
+            compressedPreviousSolution_.clear();
+            previousSolutionCompressed_.store(false, std::memory_order_release);
+        }
+    }
+
+    // the number of time levels for which intensive quantities are cached. if the storage
+    // term is cached, the intensive quantities of the previous time levels are never
+    // accessed, so their memory is spared.
+    unsigned numCachedTimeLevels_() const
+    { return enableStorageCache_ ? 1 : historySize; }
+
+    // determine whether the degrees of freedom form a Cartesian lattice. this is
+    // only the case for element centered discretizations.
+    void updateStructuredLayout_()
+    {
+        structuredLayout_ = StructuredLayout();
+        if (std::is_same<Discretization, EcfvDiscretization<TypeTag> >::value)
+            structuredLayout_.update(gridView_, elementMapper_);
+    }
+
     void resizeAndResetIntensiveQuantitiesCache_()
     {
-        // allocate the storage cache
+        // allocate the storage cache. the storage term of the most recent time level is
+        // never cached because it depends on the current iterative solution
         if (enableStorageCache()) {
             size_t numDof = asImp_().numGridDof();
-            for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
+            for (unsigned timeIdx = 1; timeIdx < historySize; ++timeIdx) {
                 storageCache_[timeIdx].resize(numDof);
             }
         }
@@ -1886,8 +3319,25 @@ protected:
         if (storeIntensiveQuantities()) {
             size_t numDof = asImp_().numGridDof();
             for(unsigned timeIdx=0; timeIdx<historySize; ++timeIdx) {
-                intensiveQuantityCache_[timeIdx].resize(numDof);
+                if (timeIdx >= numCachedTimeLevels_()) {
+                    // release the memory of the time levels which are not cached
+                    IntensiveQuantitiesVector().swap(intensiveQuantityCache_[timeIdx]);
+                    valueOnlyCache_[timeIdx] = ValueOnlyIntensiveQuantityCache();
+                    std::vector<unsigned char>().swap(intensiveQuantityCacheUpToDate_[timeIdx]);
+                    std::vector<unsigned char>().swap(intensiveQuantityCacheFilled_[timeIdx]);
+                    if constexpr (enableIntensiveQuantityArrays)
+                        intensiveQuantityArrays_[timeIdx] = IntensiveQuantityArrays();
+                    continue;
+                }
+
+                if (valueOnlyIntensiveQuantityCache_)
+                    valueOnlyCache_[timeIdx].resize(numDof);
+                else
+                    resizeIntensiveQuantityCache_(intensiveQuantityCache_[timeIdx], numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof);
+                intensiveQuantityCacheFilled_[timeIdx].assign(numDof, /*value=*/false);
+                if (enableIntensiveQuantityArrays)
+                    intensiveQuantityArrays_[timeIdx].resize(numDof);
                 invalidateIntensiveQuantitiesCache(timeIdx);
             }
         }
@@ -1899,6 +3349,118 @@ protected:
                                     unsigned timeIdx OPM_UNUSED)
     { }
 
+    /*!
+     * \brief Returns true if the primary variables of a degree of freedom at two
+     *        subsequent time levels may be used to extrapolate the solution.
+     *
+     * Models which switch the meaning of their primary variables are supposed to
+     * overload this method and to return false if the switching state differs.
+     *
+     * \param priVars The primary variables of the more recent time level
+     * \param prevPriVars The primary variables of the older time level
+     */
+    bool extrapolationAllowed_(const PrimaryVariables& priVars OPM_UNUSED,
+                               const PrimaryVariables& prevPriVars OPM_UNUSED) const
+    { return true; }
+
+    /*!
+     * \brief Store the solution of the previous time level for the extrapolation of the
+     *        initial guess of the Newton method.
+     *
+     * This is called by advanceTimeLevel() before the solution of the previous time
+     * level gets overwritten.
+     */
+    void pushExtrapolationLevel_()
+    {
+        const auto& prevSolution = solution(/*timeIdx=*/1);
+        if (numExtrapolationLevels_ > 0 &&
+            extrapolationSolutions_[0]->size() != prevSolution.size())
+            // the grid was adapted. the old time levels cannot be used anymore
+            numExtrapolationLevels_ = 0;
+
+        // the buffer of the oldest time level is reused for the new one
+        std::rotate(extrapolationSolutions_.begin(),
+                    extrapolationSolutions_.end() - 1,
+                    extrapolationSolutions_.end());
+        std::rotate(extrapolationTimes_.begin(),
+                    extrapolationTimes_.end() - 1,
+                    extrapolationTimes_.end());
+
+        *extrapolationSolutions_[0] = prevSolution;
+        extrapolationTimes_[0] = simulator_.time();
+        numExtrapolationLevels_ =
+            std::min<unsigned>(numExtrapolationLevels_ + 1,
+                               static_cast<unsigned>(extrapolationSolutions_.size()));
+    }
+
+    /*!
+     * \brief Replace the current solution by the extrapolation of the solutions of the
+     *        last time levels to the end of the current time step.
+     *
+     * The extrapolation uses Lagrange polynomials, so time steps of different size are
+     * handled correctly. Degrees of freedom for which the model does not allow the
+     * extrapolation keep the solution of the previous time step.
+     */
+    void extrapolateSolution_()
+    {
+        unsigned order = numExtrapolationLevels_;
+        auto& curSolution = solution(/*timeIdx=*/0);
+        const auto& prevSolution = solution(/*timeIdx=*/1);
+        if (order == 0 || extrapolationSolutions_[0]->size() != prevSolution.size())
+            return;
+
+        // the time levels used by the extrapolation, most recent one first
+        const SolutionVector* levels[3] = { &prevSolution, nullptr, nullptr };
+        Scalar times[3] = { simulator_.time(), 0.0, 0.0 };
+        for (unsigned levelIdx = 0; levelIdx < order; ++levelIdx) {
+            levels[levelIdx + 1] = extrapolationSolutions_[levelIdx].get();
+            times[levelIdx + 1] = extrapolationTimes_[levelIdx];
+        }
+
+        // the weights of the Lagrange polynomials at the end of the time step
+        Scalar t = simulator_.time() + simulator_.timeStepSize();
+        Scalar weights[3];
+        for (unsigned i = 0; i <= order; ++i) {
+            weights[i] = 1.0;
+            for (unsigned j = 0; j <= order; ++j)
+                if (j != i)
+                    weights[i] *= (t - times[j])/(times[i] - times[j]);
+        }
+
+        size_t numDof = prevSolution.size();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            size_t beginIdx, endIdx;
+            ThreadManager::threadRange(numDof, ThreadManager::threadId(), beginIdx, endIdx);
+            for (size_t dofIdx = beginIdx; dofIdx < endIdx; ++dofIdx) {
+                bool allowed = true;
+                for (unsigned levelIdx = 0; allowed && levelIdx < order; ++levelIdx)
+                    allowed = asImp_().extrapolationAllowed_((*levels[levelIdx])[dofIdx],
+                                                             (*levels[levelIdx + 1])[dofIdx]);
+                if (!allowed)
+                    continue;
+
+                // the extrapolated primary variables keep the meaning of the ones of the
+                // previous time step
+                auto& priVars = curSolution[dofIdx];
+                for (unsigned pvIdx = 0; pvIdx < priVars.size(); ++pvIdx) {
+                    Scalar value = 0.0;
+                    for (unsigned i = 0; i <= order; ++i)
+                        value += weights[i]*(*levels[i])[dofIdx][pvIdx];
+                    priVars[pvIdx] = value;
+                }
+            }
+        }
+
+        // the cached intensive quantities do not correspond to the extrapolated
+        // solution anymore, and neither does its storage term to the one of the previous
+        // time level
+        invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+        solutionExtrapolated_ = true;
+    }
+
     /*!
      * \brief Register all output modules which make sense for the model.
      *
@@ -1941,6 +3503,12 @@ protected:
     ElementMapper elementMapper_;
     VertexMapper vertexMapper_;
 
+    // the seeds of all elements, used by the multi-threaded loops over the grid
+    ElementSeedList elementSeeds_;
+
+    // the lattice of the elements if the grid is Cartesian
+    StructuredLayout structuredLayout_;
+
     // a vector with all auxiliary equations to be considered
     std::vector<BaseAuxiliaryModule<TypeTag>*> auxEqModules_;
 
@@ -1958,9 +3526,23 @@ protected:
     Linearizer *linearizer_;
 
     // cur is the current iterative solution, prev the converged
-    // solution of the previous time step
+    // solution of the previous time step. the validity flags are not stored as
+    // std::vector<bool> because its entries cannot be written concurrently by multiple
+    // threads.
     mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
-    mutable std::vector<bool> intensiveQuantityCacheUpToDate_[historySize];
+    mutable ValueOnlyIntensiveQuantityCache valueOnlyCache_[historySize];
+    mutable BoundaryCache boundaryCache_;
+    BoundaryFaceList boundaryFaceList_;
+    mutable SourceCache sourceCache_;
+    mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
+    // whether an entry of the cache has ever been calculated, i.e., whether it can be
+    // used as a thermodynamic hint
+    mutable std::vector<unsigned char> intensiveQuantityCacheFilled_[historySize];
+    mutable IntensiveQuantityArrays intensiveQuantityArrays_[historySize];
+
+    // the element contexts used by invalidateAndUpdateIntensiveQuantities(), one for
+    // each thread
+    mutable std::vector<std::unique_ptr<ElementContext> > threadElementContexts_;
 
     DiscreteFunctionSpace space_;
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
@@ -1975,14 +3557,60 @@ protected:
 
     Scalar gridTotalVolume_;
     std::vector<Scalar> dofTotalVolume_;
+
+    // the weights of the primary variables of all degrees of freedom of the grid, see
+    // updatePrimaryVarWeights()
+    std::vector<Scalar> primaryVarWeights_;
     std::vector<bool> isLocalDof_;
 
     mutable GlobalEqVector storageCache_[historySize];
 
     bool enableGridAdaptation_;
     bool enableIntensiveQuantityCache_;
+    bool valueOnlyIntensiveQuantityCache_;
     bool enableStorageCache_;
+    bool enableBoundaryCache_;
+    bool enableSourceCache_;
     bool enableThermodynamicHints_;
+    size_t threadedElementChunkSize_;
+
+    // the stencils of the grid elements indexed by the element mapper (empty if the
+    // stencil cache is disabled)
+    size_t stencilCacheMaxMemory_;
+    mutable std::vector<std::unique_ptr<Stencil> > stencilCache_;
+    mutable std::atomic<size_t> stencilCacheMemory_;
+
+    // the primary variables of the stencils of all elements, stored contiguously
+    using PackedSolution = PffGridVector<GridView, Stencil, PrimaryVariables, DofMapper>;
+    bool enablePackedSolution_;
+    bool packedSolutionActive_;
+    std::unique_ptr<PackedSolution> packedSolution_;
+
+    bool enableNumaFirstTouch_;
+
+    bool enableWarmTimeStepRetry_;
+    bool retryingTimeStep_;
+    bool previousStorageCached_;
+
+    // the compressed solution of the previous time level, see compressPreviousSolution()
+    using CompressedSolutionVector = CompressedBlockVector<SolutionVector>;
+    bool compressPreviousSolution_;
+    typename CompressedSolutionVector::Mode previousSolutionCompression_;
+    mutable CompressedSolutionVector compressedPreviousSolution_;
+    mutable std::atomic<bool> previousSolutionCompressed_;
+    mutable std::mutex previousSolutionMutex_;
+
+    // the integrals of the storage terms over the local process for each time level.
+    // the ones of the previous time levels are kept until the solution is modified.
+    mutable EqVector localStorage_[historySize];
+    mutable bool localStorageValid_[historySize];
+
+    // the solutions of the time levels before the previous one and the times at which
+    // they were reached, most recent one first
+    std::vector<std::unique_ptr<SolutionVector> > extrapolationSolutions_;
+    std::vector<Scalar> extrapolationTimes_;
+    unsigned numExtrapolationLevels_;
+    bool solutionExtrapolated_;
 };
 } // namespace Opm
 
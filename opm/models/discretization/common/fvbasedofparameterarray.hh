@@ -0,0 +1,138 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseDofParameterArray
+ */
+#ifndef EWOMS_FV_BASE_DOF_PARAMETER_ARRAY_HH
+#define EWOMS_FV_BASE_DOF_PARAMETER_ARRAY_HH
+
+#include "fvbaseproperties.hh"
+
+#include <opm/models/utils/mappedarray.hh>
+#include <opm/models/utils/parametersystem.hh>
+
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Stores a spatial parameter for each degree of freedom of the grid.
+ *
+ * Problems usually determine their spatial parameters like the intrinsic
+ * permeability, the porosity or the parameters of the material law based on the
+ * position of a degree of freedom. Since this is done for each degree of freedom in
+ * each linearization, it is often considerably cheaper to evaluate them once when the
+ * problem is initialized or the grid has changed, and to look them up using the global
+ * index of the degree of freedom afterwards. Parameters which are objects of a few
+ * distinct kinds are best served by storing an index or a pointer to the object.
+ *
+ * The lookup is done using the global space index of the context, so for boundary
+ * contexts the value of the degree of freedom in the interior of the boundary segment
+ * is returned.
+ *
+ * If the StaticDataMappingDir parameter is not empty, parameters which are trivially
+ * copyable are kept in a memory-mapped file in this directory instead of the main
+ * memory (see Opm::MappedArray).
+ */
+template <class TypeTag, class Data>
+class FvBaseDofParameterArray
+{
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+
+public:
+    /*!
+     * \brief Evaluate the parameter for all degrees of freedom of the grid.
+     *
+     * \param simulator The simulator whose grid ought to be considered
+     * \param evalFn A function object which is called as evalFn(elemCtx, dofIdx) for
+     *               each degree of freedom and returns its parameter. The stencil of
+     *               the element context is up to date, but its intensive quantities
+     *               are not.
+     */
+    template <class EvalFn>
+    void update(const Simulator& simulator, const EvalFn& evalFn)
+    {
+        size_t numDof = simulator.model().numGridDof();
+        mappedData_.clear();
+        data_.resize(numDof);
+        std::vector<unsigned char> visited(numDof, 0);
+
+        ElementContext elemCtx(simulator);
+        const auto& gridView = simulator.gridView();
+        auto elemIt = gridView.template begin</*codim=*/0>();
+        const auto& elemEndIt = gridView.template end</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            elemCtx.updateStencil(*elemIt);
+            unsigned numElemDof = static_cast<unsigned>(elemCtx.numPrimaryDof(/*timeIdx=*/0));
+            for (unsigned dofIdx = 0; dofIdx < numElemDof; ++dofIdx) {
+                unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                if (visited[globalDofIdx])
+                    continue;
+
+                data_[globalDofIdx] = evalFn(elemCtx, dofIdx);
+                visited[globalDofIdx] = 1;
+            }
+        }
+
+        if constexpr (std::is_trivially_copyable<Data>::value) {
+            const std::string& mappingDir = EWOMS_GET_PARAM(TypeTag, std::string, StaticDataMappingDir);
+            if (!mappingDir.empty()) {
+                mappedData_.assign(data_, mappingDir);
+                std::vector<Data>().swap(data_);
+            }
+        }
+    }
+
+    /*!
+     * \brief Returns the parameter of a degree of freedom given an execution context.
+     */
+    template <class Context>
+    const Data& get(const Context& context, unsigned spaceIdx, unsigned timeIdx) const
+    { return (*this)[context.globalSpaceIndex(spaceIdx, timeIdx)]; }
+
+    /*!
+     * \brief Returns the parameter of a degree of freedom given its global index.
+     */
+    const Data& operator[](unsigned globalDofIdx) const
+    { return mappedData_.empty() ? data_[globalDofIdx] : mappedData_[globalDofIdx]; }
+
+    /*!
+     * \brief Returns the number of degrees of freedom for which the parameter is stored.
+     */
+    size_t size() const
+    { return mappedData_.empty() ? data_.size() : mappedData_.size(); }
+
+private:
+    std::vector<Data> data_;
+    MappedArray<Data> mappedData_;
+};
+
+} // namespace Opm
+
+#endif
@@ -32,11 +32,13 @@
 
 #include <opm/models/discretization/common/linearizationtype.hh>
 #include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/instrumentation.hh>
 
 #include <opm/material/common/Unused.hpp>
 
 #include <dune/common/fvector.hh>
 
+#include <cassert>
 #include <vector>
 
 namespace Opm {
@@ -95,11 +97,17 @@ public:
         : gridView_(simulator.gridView())
         , stencil_(gridView_, simulator.model().dofMapper() )
     {
+        simulator.model().initStencil(stencil_);
+
         // remember the simulator object
         simulatorPtr_ = &simulator;
+        stencilPtr_ = &stencil_;
+        solutionSnapshot_ = nullptr;
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
+        numBufferEnlargements_ = 0;
+        refocusingExtensiveQuantities_ = false;
     }
 
     static void *operator new(size_t size)
@@ -133,14 +141,21 @@ public:
         // remember the current element
         elemPtr_ = &elem;
 
-        // update the stencil. the center gradients are quite expensive to calculate and
-        // most models don't need them, so that we only do this if the model explicitly
-        // enables them
-        stencil_.update(elem);
+        // use the stencil cached by the model if it is available. else, update the
+        // stencil. the center gradients are quite expensive to calculate and most models
+        // don't need them, so that we only do this if the model explicitly enables them
+        unsigned elemIdx = static_cast<unsigned>(model().elementMapper().index(elem));
+        stencilPtr_ = solutionSnapshot_ ? nullptr : model().cachedStencil(elemIdx);
+        if (!stencilPtr_) {
+            stencil_.update(elem);
+            if (!solutionSnapshot_)
+                model().updateCachedStencil(stencil_, elemIdx);
+            stencilPtr_ = &stencil_;
+        }
 
         // resize the arrays containing the flux and the volume variables
-        dofVars_.resize(stencil_.numDof());
-        extensiveQuantities_.resize(stencil_.numInteriorFaces());
+        reserveDofVars_(stencilPtr_->numDof());
+        reserveExtensiveQuantities_(stencilPtr_->numInteriorFaces());
     }
 
     /*!
@@ -156,8 +171,9 @@ public:
 
         // update the finite element geometry
         stencil_.updatePrimaryTopology(elem);
+        stencilPtr_ = &stencil_;
 
-        dofVars_.resize(stencil_.numPrimaryDof());
+        reserveDofVars_(stencil_.numPrimaryDof());
     }
 
     /*!
@@ -173,6 +189,7 @@ public:
 
         // update the finite element geometry
         stencil_.updateTopology(elem);
+        stencilPtr_ = &stencil_;
     }
 
     /*!
@@ -225,6 +242,24 @@ public:
     void updateIntensiveQuantities(const PrimaryVariables& priVars, unsigned dofIdx, unsigned timeIdx)
     { asImp_().updateSingleIntQuants_(priVars, dofIdx, timeIdx); }
 
+    /*!
+     * \brief Compute the intensive quantities of a single sub-control volume of the
+     *        current element for a single time index from the global solution.
+     *
+     * In contrast to the overload which takes the primary variables as argument, this
+     * method considers the intensive quantities cache of the model.
+     *
+     * \param dofIdx The local index in the current element of the sub-control volume
+     *               which should be updated.
+     * \param timeIdx The index of the solution vector used by the time discretization.
+     */
+    void updateDofIntensiveQuantities(unsigned dofIdx, unsigned timeIdx)
+    {
+        const SolutionVector& globalSol = globalSolution_(timeIdx);
+        unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
+        updateDofIntensiveQuantities_(dofIdx, timeIdx, globalSol[globalIdx]);
+    }
+
     /*!
      * \brief Compute the extensive quantities of all sub-control volume
      *        faces of the current element for all time indices.
@@ -232,6 +267,31 @@ public:
     void updateAllExtensiveQuantities()
     { asImp_().updateExtensiveQuantities(/*timeIdx=*/0); }
 
+    /*!
+     * \brief Re-compute the extensive quantities of all sub-control volume faces of the
+     *        current element after the focus has been moved to another degree of freedom.
+     *
+     * This may only be called if the extensive quantities have been computed by
+     * updateAllExtensiveQuantities() using the same intensive quantities before, i.e.,
+     * only the degree of freedom for which derivatives are considered differs. The
+     * extensive quantities may then retain everything which merely depends on the
+     * values of the intensive quantities, e.g., the upstream directions.
+     */
+    void updateAllExtensiveQuantitiesForFocus()
+    {
+        RefocusingGuard_ guard(refocusingExtensiveQuantities_);
+        asImp_().updateExtensiveQuantities(/*timeIdx=*/0);
+    }
+
+    /*!
+     * \brief Returns true if the extensive quantities are currently being re-computed
+     *        because the focus has been moved to another degree of freedom.
+     *
+     * \copydetails updateAllExtensiveQuantitiesForFocus()
+     */
+    bool refocusingExtensiveQuantities() const
+    { return refocusingExtensiveQuantities_; }
+
     /*!
      * \brief Compute the extensive quantities of all sub-control volume
      *        faces of the current element for a single time index.
@@ -241,6 +301,7 @@ public:
      */
     void updateExtensiveQuantities(unsigned timeIdx)
     {
+        Instrumentation::Region region(Instrumentation::fluxRegion);
         gradientCalculator_.prepare(/*context=*/asImp_(), timeIdx);
 
         for (unsigned fluxIdx = 0; fluxIdx < numInteriorFaces(timeIdx); fluxIdx++) {
@@ -268,6 +329,26 @@ public:
     unsigned focusDofIndex() const
     { return focusDofIdx_; }
 
+    /*!
+     * \brief Specify a copy of the model's current solution from which the intensive
+     *        quantities for the most recent time index are calculated.
+     *
+     * If a snapshot is set, the element context neither considers nor modifies the
+     * intensive quantity and stencil caches of the model. This allows to use it on a
+     * separate thread while the model is modified, e.g., for preparing the output of a
+     * time step while the next one is already being simulated. Passing a null pointer
+     * reverts to the solution of the model.
+     */
+    void setSolutionSnapshot(const SolutionVector* snapshot)
+    { solutionSnapshot_ = snapshot; }
+
+    /*!
+     * \brief Returns the solution snapshot used by the element context or a null
+     *        pointer if the solution of the model is used.
+     */
+    const SolutionVector* solutionSnapshot() const
+    { return solutionSnapshot_; }
+
     /*!
      * \brief Returns the linearization type.
      *
@@ -339,7 +420,7 @@ public:
      *                time discretization.
      */
     const Stencil& stencil(unsigned timeIdx OPM_UNUSED) const
-    { return stencil_; }
+    { return *stencilPtr_; }
 
     /*!
      * \brief Return the position of a local entities in global coordinates
@@ -350,7 +431,7 @@ public:
      *                time discretization.
      */
     const GlobalPosition& pos(unsigned dofIdx, unsigned timeIdx OPM_UNUSED) const
-    { return stencil_.subControlVolume(dofIdx).globalPos(); }
+    { return stencilPtr_->subControlVolume(dofIdx).globalPos(); }
 
     /*!
      * \brief Return the global spatial index for a sub-control volume
@@ -392,9 +473,17 @@ public:
     /*!
      * \brief Returns whether the current element is on the domain's
      *        boundary.
+     *
+     * This is looked up in the model's list of boundary intersections, so the
+     * intersections of the element do not need to be iterated.
      */
     bool onBoundary() const
-    { return element().hasBoundaryIntersections(); }
+    {
+        const auto& faceList = model().boundaryFaceList();
+        if (!faceList.isValid(static_cast<size_t>(gridView().size(/*codim=*/0))))
+            return element().hasBoundaryIntersections();
+        return faceList.onBoundary(static_cast<unsigned>(model().elementMapper().index(element())));
+    }
 
     /*!
      * \brief Return a reference to the intensive quantities of a
@@ -411,7 +500,7 @@ public:
 #ifndef NDEBUG
         assert(dofIdx < numDof(timeIdx));
 
-        if (enableStorageCache_ && timeIdx != 0 && problem().recycleFirstIterationStorage())
+        if (enableStorageCache_ && timeIdx != 0 && model().recycleFirstIterationStorage())
             throw std::logic_error("If caching of the storage term is enabled, only the intensive quantities "
                                    "for the most-recent substep (i.e. time index 0) are available!");
 #endif
@@ -507,6 +596,16 @@ public:
         stashedDofIdx_ = -1;
     }
 
+    /*!
+     * \brief Returns the number of times the internal arrays of the context had to be
+     *        enlarged.
+     *
+     * The arrays are sized for the largest stencil which has been seen so far, so this
+     * number is supposed to stay constant after the first linearization of the grid.
+     */
+    unsigned numBufferEnlargements() const
+    { return numBufferEnlargements_; }
+
     /*!
      * \brief Return a reference to the gradient calculation class of
      *        the chosen spatial discretization.
@@ -555,43 +654,128 @@ protected:
      */
     void updateIntensiveQuantities_(unsigned timeIdx, size_t numDof)
     {
+        // if the model provides a packed copy of the most recent solution, the primary
+        // variables of the element's DOFs are stored contiguously
+        const PrimaryVariables* packedSol = nullptr;
+        if (timeIdx == 0 && !solutionSnapshot_)
+            packedSol = model().packedSolution(*elemPtr_);
+
+        if (packedSol) {
+            for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++)
+                updateDofIntensiveQuantities_(dofIdx, timeIdx, packedSol[dofIdx]);
+            return;
+        }
+
         // update the intensive quantities for the whole history
-        const SolutionVector& globalSol = model().solution(timeIdx);
+        const SolutionVector& globalSol = globalSolution_(timeIdx);
 
         // update the non-gradient quantities
-        for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++) {
-            unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
-            const PrimaryVariables& dofSol = globalSol[globalIdx];
-            dofVars_[dofIdx].priVars[timeIdx] = dofSol;
-
-            dofVars_[dofIdx].thermodynamicHint[timeIdx] =
-                model().thermodynamicHint(globalIdx, timeIdx);
-
-            const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
-            if (cachedIntQuants) {
-                dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
-            }
-            else {
-                updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
-                model().updateCachedIntensiveQuantities(dofVars_[dofIdx].intensiveQuantities[timeIdx],
-                                                        globalIdx,
-                                                        timeIdx);
-            }
+        for (unsigned dofIdx = 0; dofIdx < numDof; dofIdx++)
+            updateDofIntensiveQuantities_(dofIdx, timeIdx, globalSol[globalSpaceIndex(dofIdx, timeIdx)]);
+    }
+
+    void updateDofIntensiveQuantities_(unsigned dofIdx,
+                                       unsigned timeIdx,
+                                       const PrimaryVariables& dofSol)
+    {
+        unsigned globalIdx = globalSpaceIndex(dofIdx, timeIdx);
+        dofVars_[dofIdx].priVars[timeIdx] = dofSol;
+
+        if (solutionSnapshot_) {
+            // the caches of the model may be modified concurrently
+            dofVars_[dofIdx].thermodynamicHint[timeIdx] = nullptr;
+            updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
+            return;
+        }
+
+        dofVars_[dofIdx].thermodynamicHint[timeIdx] =
+            model().thermodynamicHint(globalIdx, timeIdx);
+
+        auto& intQuants = dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        if (model().loadCachedIntensiveQuantities(intQuants, globalIdx, timeIdx))
+            return;
+
+        if (model().valueOnlyIntensiveQuantityCache()) {
+            // the value-only cache must not be given any derivatives
+            DerivativesDisabledGuard_ guard;
+            updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
         }
+        else
+            updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
+        model().updateCachedIntensiveQuantities(intQuants, globalIdx, timeIdx);
+    }
+
+    // disables the derivatives of the evaluations created from primary variables on the
+    // current thread for its lifetime, even if an exception is thrown
+    struct DerivativesDisabledGuard_
+    {
+        DerivativesDisabledGuard_()
+            : wasEnabled_(PrimaryVariables::derivativesEnabled())
+        { PrimaryVariables::setDerivativesEnabled(false); }
+
+        ~DerivativesDisabledGuard_()
+        { PrimaryVariables::setDerivativesEnabled(wasEnabled_); }
+
+        bool wasEnabled_;
+    };
+
+    // flags the extensive quantities as being re-computed for another focus for its
+    // lifetime, even if an exception is thrown
+    struct RefocusingGuard_
+    {
+        explicit RefocusingGuard_(bool& flag)
+            : flag_(flag)
+        { flag_ = true; }
+
+        ~RefocusingGuard_()
+        { flag_ = false; }
+
+        bool& flag_;
+    };
+
+    const SolutionVector& globalSolution_(unsigned timeIdx) const
+    {
+        if (solutionSnapshot_) {
+            // snapshots only exist for the most recent solution
+            assert(timeIdx == 0);
+            return *solutionSnapshot_;
+        }
+
+        return model().solution(timeIdx);
     }
 
     void updateSingleIntQuants_(const PrimaryVariables& priVars, unsigned dofIdx, unsigned timeIdx)
     {
 #ifndef NDEBUG
-        if (enableStorageCache_ && timeIdx != 0 && problem().recycleFirstIterationStorage())
+        if (enableStorageCache_ && timeIdx != 0 && model().recycleFirstIterationStorage())
             throw std::logic_error("If caching of the storage term is enabled, only the intensive quantities "
                                    "for the most-recent substep (i.e. time index 0) are available!");
 #endif
 
+        Instrumentation::Region region(Instrumentation::intensiveQuantitiesRegion);
         dofVars_[dofIdx].priVars[timeIdx] = priVars;
         dofVars_[dofIdx].intensiveQuantities[timeIdx].update(/*context=*/asImp_(), dofIdx, timeIdx);
     }
 
+    // the arrays for the quantities of the degrees of freedom and of the faces are never
+    // shrunk. since the objects are only accessed by index, this avoids destroying and
+    // re-creating them whenever the size of the stencil changes between two elements.
+    void reserveDofVars_(size_t numDof)
+    {
+        if (dofVars_.size() < numDof) {
+            dofVars_.resize(numDof);
+            ++ numBufferEnlargements_;
+        }
+    }
+
+    void reserveExtensiveQuantities_(size_t numFaces)
+    {
+        if (extensiveQuantities_.size() < numFaces) {
+            extensiveQuantities_.resize(numFaces);
+            ++ numBufferEnlargements_;
+        }
+    }
+
     IntensiveQuantities intensiveQuantitiesStashed_;
     PrimaryVariables priVarsStashed_;
 
@@ -604,10 +788,15 @@ protected:
     const Element *elemPtr_;
     const GridView gridView_;
     Stencil stencil_;
+    // points either to stencil_ or to the stencil of the element cached by the model
+    const Stencil *stencilPtr_;
+    const SolutionVector *solutionSnapshot_;
 
     int stashedDofIdx_;
     int focusDofIdx_;
+    unsigned numBufferEnlargements_;
     bool enableStorageCache_;
+    bool refocusingExtensiveQuantities_;
 };
 
 } // namespace Opm
@@ -30,6 +30,7 @@
 
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/instrumentation.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 
 #include <opm/material/common/MathToolbox.hpp>
@@ -41,6 +42,7 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
 #include <limits>
 
 namespace Opm {
@@ -162,6 +164,8 @@ public:
     // for their implementation of std::vector, although the method is never called...)
     FvBaseFdLocalLinearizer(const FvBaseFdLocalLinearizer&)
         : internalElemContext_(0)
+        , numBufferEnlargements_(0)
+        , numericDifferenceMethod_(1)
     {}
 
 #else
@@ -172,6 +176,8 @@ public:
 public:
     FvBaseFdLocalLinearizer()
         : internalElemContext_(0)
+        , numBufferEnlargements_(0)
+        , numericDifferenceMethod_(1)
     { }
 
     ~FvBaseFdLocalLinearizer()
@@ -200,6 +206,10 @@ public:
         simulatorPtr_ = &simulator;
         delete internalElemContext_;
         internalElemContext_ = new ElementContext(simulator);
+
+        // the parameter is evaluated for every partial derivative, so it is retrieved
+        // only once here
+        numericDifferenceMethod_ = EWOMS_GET_PARAM(TypeTag, int, NumericDifferenceMethod);
     }
 
     /*!
@@ -234,6 +244,7 @@ public:
      */
     void linearize(ElementContext& elemCtx, const Element& elem)
     {
+        Instrumentation::Region region(Instrumentation::localLinearizationRegion);
         elemCtx.updateAll(elem);
 
         // update the weights of the primary variables for the context
@@ -243,8 +254,14 @@ public:
         reset_(elemCtx);
 
         // calculate the local residual
+        localResidual_.setReusePreviousStorage(false);
         localResidual_.eval(residual_, elemCtx);
 
+        // the perturbations only affect the current solution, so the storage terms of
+        // the previous time step which were calculated for the unperturbed residual
+        // stay valid for all partial derivatives of the element
+        localResidual_.setReusePreviousStorage(true);
+
         // calculate the local jacobian matrix
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; dofIdx++) {
@@ -255,6 +272,8 @@ public:
                 updateLocalJacobian_(elemCtx, dofIdx, pvIdx);
             }
         }
+
+        localResidual_.setReusePreviousStorage(false);
     }
 
     /*!
@@ -318,6 +337,15 @@ public:
     const ScalarVectorBlock& residual(unsigned dofIdx) const
     { return residual_[dofIdx]; }
 
+    /*!
+     * \brief Returns the number of times the local Jacobian had to be enlarged.
+     *
+     * This number is supposed to stay constant once all elements of the grid have been
+     * linearized once.
+     */
+    unsigned numBufferEnlargements() const
+    { return numBufferEnlargements_; }
+
 protected:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
@@ -331,12 +359,6 @@ protected:
     const Model& model_() const
     { return simulatorPtr_->model(); }
 
-    /*!
-     * \brief Returns the numeric difference method which is applied.
-     */
-    static int numericDifferenceMethod_()
-    { return EWOMS_GET_PARAM(TypeTag, int, NumericDifferenceMethod); }
-
     /*!
      * \brief Resize all internal attributes to the size of the
      *        element.
@@ -347,7 +369,14 @@ protected:
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
 
         residual_.resize(numDof);
-        jacobian_.setSize(numDof, numPrimaryDof);
+
+        // the local Jacobian is only accessed by index, so it is never shrunk. this
+        // avoids re-allocating its rows for each element if the stencil sizes vary
+        if (jacobian_.N() < numDof || jacobian_.M() < numPrimaryDof) {
+            jacobian_.setSize(std::max(numDof, jacobian_.N()),
+                              std::max(numPrimaryDof, jacobian_.M()));
+            ++ numBufferEnlargements_;
+        }
 
         derivResidual_.resize(numDof);
     }
@@ -421,7 +450,7 @@ protected:
         Scalar eps = asImp_().numericEpsilon(elemCtx, dofIdx, pvIdx);
         Scalar delta = 0.0;
 
-        if (numericDifferenceMethod_() >= 0) {
+        if (numericDifferenceMethod_ >= 0) {
             // we are not using backward differences, i.e. we need to
             // calculate f(x + \epsilon)
 
@@ -441,7 +470,7 @@ protected:
             derivResidual_ = residual_;
         }
 
-        if (numericDifferenceMethod_() <= 0) {
+        if (numericDifferenceMethod_ <= 0) {
             // we are not using forward differences, i.e. we don't
             // need to calculate f(x - \epsilon)
 
@@ -510,6 +539,11 @@ protected:
     LocalEvalBlockVector residual_;
     LocalEvalBlockVector derivResidual_;
     ScalarLocalBlockMatrix jacobian_;
+    unsigned numBufferEnlargements_;
+
+    // the numeric difference method which is applied (the value of the
+    // NumericDifferenceMethod parameter)
+    int numericDifferenceMethod_;
 
     LocalResidual localResidual_;
 };
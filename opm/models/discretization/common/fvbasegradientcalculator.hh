@@ -34,6 +34,11 @@
 
 #include <dune/common/fvector.hh>
 
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
 namespace Opm {
 template<class TypeTag>
 class EcfvDiscretization;
@@ -75,12 +80,59 @@ public:
      * \brief Precomputes the common values to calculate gradients and values of
      *        quantities at every interior flux approximation point.
      *
+     * The weights of the two-point approximation only depend on the geometry of the
+     * stencil, so they are computed once here instead of for each quantity whose value
+     * or gradient is calculated at a flux approximation point.
+     *
      * \param elemCtx The current execution context
      * \param timeIdx The index used by the time discretization.
      */
     template <bool prepareValues = true, bool prepareGradients = true>
-    void prepare(const ElementContext& elemCtx OPM_UNUSED, unsigned timeIdx OPM_UNUSED)
-    { /* noting to do */ }
+    void prepare(const ElementContext& elemCtx, unsigned timeIdx)
+    {
+        const auto& stencil = elemCtx.stencil(timeIdx);
+        size_t numFaces = stencil.numInteriorFaces();
+
+        if (prepareValues) {
+            valueWeights_.resize(numFaces);
+            for (unsigned fapIdx = 0; fapIdx < numFaces; ++fapIdx) {
+                auto& weights = valueWeights_[fapIdx];
+                computeDistances_(weights.interiorDistance, weights.exteriorDistance, elemCtx, fapIdx);
+                weights.totalDistance = weights.interiorDistance + weights.exteriorDistance;
+            }
+        }
+
+        if (prepareGradients) {
+            gradientWeights_.resize(numFaces);
+            normalGradientWeights_.resize(numFaces);
+            for (unsigned fapIdx = 0; fapIdx < numFaces; ++fapIdx) {
+                const auto& face = stencil.interiorFace(fapIdx);
+                const auto& interiorPos = stencil.subControlVolume(face.interiorIndex()).globalPos();
+                const auto& exteriorPos = stencil.subControlVolume(face.exteriorIndex()).globalPos();
+
+                Scalar distSquared = 0.0;
+                for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+                    Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
+                    distSquared += tmp*tmp;
+                }
+
+                // the gradient is the normalized directional vector between the two
+                // centers times the ratio of the difference of the values and their
+                // distance, i.e., d/abs(d) * delta y / abs(d) = d*delta y / abs(d)^2.
+                for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+                    Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
+                    gradientWeights_[fapIdx][dimIdx] = tmp/distSquared;
+                }
+
+                // the projection of the gradient onto the face normal only needs a
+                // single weight
+                normalGradientWeights_[fapIdx] = 0.0;
+                for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                    normalGradientWeights_[fapIdx] +=
+                        gradientWeights_[fapIdx][dimIdx]*face.normal()[dimIdx];
+            }
+        }
+    }
 
     /*!
      * \brief Calculates the value of an arbitrary scalar quantity at any interior flux
@@ -102,9 +154,10 @@ public:
         using RawReturnType = decltype(quantityCallback.operator()(0));
         using ReturnType = typename std::remove_const<typename std::remove_reference<RawReturnType>::type>::type;
 
-        Scalar interiorDistance;
-        Scalar exteriorDistance;
-        computeDistances_(interiorDistance, exteriorDistance, elemCtx, fapIdx);
+        assert(fapIdx < valueWeights_.size());
+        const auto& weights = valueWeights_[fapIdx];
+        Scalar interiorDistance = weights.interiorDistance;
+        Scalar exteriorDistance = weights.exteriorDistance;
 
         const auto& face = elemCtx.stencil(/*timeIdx=*/0).interiorFace(fapIdx);
         auto i = face.interiorIndex();
@@ -123,7 +176,7 @@ public:
         else
             value += getValue(quantityCallback(j))*exteriorDistance;
 
-        value /= interiorDistance + exteriorDistance;
+        value /= weights.totalDistance;
 
         return value;
     }
@@ -148,9 +201,10 @@ public:
         using RawReturnType = decltype(quantityCallback.operator()(0));
         using ReturnType = typename std::remove_const<typename std::remove_reference<RawReturnType>::type>::type;
 
-        Scalar interiorDistance;
-        Scalar exteriorDistance;
-        computeDistances_(interiorDistance, exteriorDistance, elemCtx, fapIdx);
+        assert(fapIdx < valueWeights_.size());
+        const auto& weights = valueWeights_[fapIdx];
+        Scalar interiorDistance = weights.interiorDistance;
+        Scalar exteriorDistance = weights.exteriorDistance;
 
         const auto& face = elemCtx.stencil(/*timeIdx=*/0).interiorFace(fapIdx);
         auto i = face.interiorIndex();
@@ -181,9 +235,8 @@ public:
                 value[k] += getValue(dofVal[k])*exteriorDistance;
         }
 
-        Scalar totDistance = interiorDistance + exteriorDistance;
         for (int k = 0; k < value.size(); ++k)
-            value[k] /= totDistance;
+            value[k] /= weights.totalDistance;
 
         return value;
     }
@@ -212,9 +265,6 @@ public:
         auto j = face.exteriorIndex();
         auto focusIdx = elemCtx.focusDofIndex();
 
-        const auto& interiorPos = stencil.subControlVolume(i).globalPos();
-        const auto& exteriorPos = stencil.subControlVolume(j).globalPos();
-
         Evaluation deltay;
         if (i == focusIdx) {
             deltay =
@@ -231,22 +281,105 @@ public:
                 getValue(quantityCallback(j))
                 - getValue(quantityCallback(i));
 
-        Scalar distSquared = 0.0;
-        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
-            Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
-            distSquared += tmp*tmp;
-        }
+        // the weights are the directional vector between the centers of the sub-control
+        // volumes divided by their squared distance (cf. prepare())
+        assert(fapIdx < gradientWeights_.size());
+        const auto& weights = gradientWeights_[fapIdx];
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+            quantityGrad[dimIdx] = deltay*weights[dimIdx];
+    }
 
-        // divide the gradient by the squared distance between the centers of the
-        // sub-control volumes: the gradient is the normalized directional vector between
-        // the two centers times the ratio of the difference of the values and their
-        // distance, i.e., d/abs(d) * delta y / abs(d) = d*delta y / abs(d)^2.
-        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
-            Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
-            quantityGrad[dimIdx] = deltay*(tmp/distSquared);
+    /*!
+     * \brief Calculates the gradients of several quantities at any flux approximation
+     *        point in a single pass.
+     *
+     * The result is the same as calling calculateGradient() for each quantity, but the
+     * geometric weights are only looked up once and the callback is only called once per
+     * degree of freedom for all quantities.
+     *
+     * \param quantityGrads The gradients of the quantities, indexed by the quantity
+     * \param elemCtx The current execution context
+     * \param fapIdx The local index of the flux approximation point
+     *               in the current element's stencil.
+     * \param quantitiesCallback A callable object which sets the values of all
+     *               quantities given the index of a degree of freedom. It must
+     *               provide the number of quantities as the numFields constant.
+     */
+    template <class QuantitiesCallback, class GradientArray>
+    void calculateGradients(GradientArray& quantityGrads,
+                            const ElementContext& elemCtx,
+                            unsigned fapIdx,
+                            const QuantitiesCallback& quantitiesCallback) const
+    {
+        constexpr unsigned numFields = QuantitiesCallback::numFields;
+        using ResultType = typename QuantitiesCallback::ResultType;
+
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        const auto& face = stencil.interiorFace(fapIdx);
+
+        auto i = face.interiorIndex();
+        auto j = face.exteriorIndex();
+        auto focusIdx = elemCtx.focusDofIndex();
+
+        std::array<ResultType, numFields> valuesI;
+        std::array<ResultType, numFields> valuesJ;
+        quantitiesCallback(valuesI, i);
+        quantitiesCallback(valuesJ, j);
+
+        assert(fapIdx < gradientWeights_.size());
+        const auto& weights = gradientWeights_[fapIdx];
+        for (unsigned fieldIdx = 0; fieldIdx < numFields; ++fieldIdx) {
+            Evaluation deltay;
+            if (i == focusIdx)
+                deltay = getValue(valuesJ[fieldIdx]) - valuesI[fieldIdx];
+            else if (j == focusIdx)
+                deltay = valuesJ[fieldIdx] - getValue(valuesI[fieldIdx]);
+            else
+                deltay = getValue(valuesJ[fieldIdx]) - getValue(valuesI[fieldIdx]);
+
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                quantityGrads[fieldIdx][dimIdx] = deltay*weights[dimIdx];
         }
     }
 
+    /*!
+     * \brief Calculates the scalar product of the gradient of an arbitrary scalar
+     *        quantity and the normal of an interior flux approximation point.
+     *
+     * This is equivalent to calling calculateGradient() and multiplying the result
+     * with the normal of the face, but it avoids the vector arithmetic.
+     *
+     * \param elemCtx The current execution context
+     * \param fapIdx The local index of the flux approximation point
+     *               in the current element's stencil.
+     * \param quantityCallback A callable object returning the value
+     *               of the quantity given the index of a degree of
+     *               freedom
+     */
+    template <class QuantityCallback>
+    Evaluation calculateNormalGradient(const ElementContext& elemCtx,
+                                       unsigned fapIdx,
+                                       const QuantityCallback& quantityCallback) const
+    {
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        const auto& face = stencil.interiorFace(fapIdx);
+
+        auto i = face.interiorIndex();
+        auto j = face.exteriorIndex();
+        auto focusIdx = elemCtx.focusDofIndex();
+
+        Evaluation deltay;
+        if (i == focusIdx)
+            deltay = getValue(quantityCallback(j)) - quantityCallback(i);
+        else if (j == focusIdx)
+            deltay = quantityCallback(j) - getValue(quantityCallback(i));
+        else
+            deltay = getValue(quantityCallback(j)) - getValue(quantityCallback(i));
+
+        assert(fapIdx < normalGradientWeights_.size());
+        return deltay*normalGradientWeights_[fapIdx];
+    }
+
     /*!
      * \brief Calculates the value of an arbitrary quantity at any
      *        flux approximation point on the grid boundary.
@@ -319,6 +452,60 @@ public:
         }
     }
 
+    /*!
+     * \brief Calculates the gradients of several quantities at any flux approximation
+     *        point on the boundary in a single pass.
+     *
+     * \param quantityGrads The gradients of the quantities, indexed by the quantity
+     * \param elemCtx The current execution context
+     * \param faceIdx The local index of the flux approximation point
+     *                in the current element's stencil.
+     * \param quantitiesCallback A callable object which sets the values of all
+     *               quantities given the index of a degree of freedom and which
+     *               provides their values on the boundary via boundaryValues()
+     */
+    template <class QuantitiesCallback, class GradientArray>
+    void calculateBoundaryGradients(GradientArray& quantityGrads,
+                                    const ElementContext& elemCtx,
+                                    unsigned faceIdx,
+                                    const QuantitiesCallback& quantitiesCallback) const
+    {
+        constexpr unsigned numFields = QuantitiesCallback::numFields;
+        using ResultType = typename QuantitiesCallback::ResultType;
+
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        const auto& face = stencil.boundaryFace(faceIdx);
+
+        std::array<ResultType, numFields> boundaryValues;
+        std::array<ResultType, numFields> interiorValues;
+        quantitiesCallback.boundaryValues(boundaryValues);
+        quantitiesCallback(interiorValues, face.interiorIndex());
+
+        const auto& boundaryFacePos = face.integrationPos();
+        const auto& interiorPos = stencil.subControlVolume(face.interiorIndex()).center();
+
+        // see calculateBoundaryGradient()
+        DimVector weights;
+        Scalar distSquared = 0;
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+            weights[dimIdx] = boundaryFacePos[dimIdx] - interiorPos[dimIdx];
+            distSquared += weights[dimIdx]*weights[dimIdx];
+        }
+        weights /= distSquared;
+
+        bool interiorIsFocus = (face.interiorIndex() == elemCtx.focusDofIndex());
+        for (unsigned fieldIdx = 0; fieldIdx < numFields; ++fieldIdx) {
+            Evaluation deltay;
+            if (interiorIsFocus)
+                deltay = boundaryValues[fieldIdx] - interiorValues[fieldIdx];
+            else
+                deltay = getValue(boundaryValues[fieldIdx]) - getValue(interiorValues[fieldIdx]);
+
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                quantityGrads[fieldIdx][dimIdx] = deltay*weights[dimIdx];
+        }
+    }
+
 private:
     void computeDistances_(Scalar& interiorDistance,
                            Scalar& exteriorDistance,
@@ -352,6 +539,19 @@ private:
         interiorDistance = std::sqrt(std::abs(interiorDistance));
         exteriorDistance = std::sqrt(std::abs(exteriorDistance));
     }
+
+    struct ValueWeights
+    {
+        Scalar interiorDistance;
+        Scalar exteriorDistance;
+        Scalar totalDistance;
+    };
+
+    // the weights of the two-point approximation for each interior flux approximation
+    // point of the current element
+    std::vector<ValueWeights> valueWeights_;
+    std::vector<DimVector> gradientWeights_;
+    std::vector<Scalar> normalGradientWeights_;
 };
 } // namespace Opm
 
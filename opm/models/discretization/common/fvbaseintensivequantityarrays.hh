@@ -0,0 +1,128 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseIntensiveQuantityArrays
+ */
+#ifndef EWOMS_FV_BASE_INTENSIVE_QUANTITY_ARRAYS_HH
+#define EWOMS_FV_BASE_INTENSIVE_QUANTITY_ARRAYS_HH
+
+#include "fvbaseproperties.hh"
+
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Stores the most frequently used intensive quantities of all degrees of freedom
+ *        in a structure-of-arrays layout.
+ *
+ * Each quantity of each fluid phase is stored in a separate contiguous array indexed by
+ * the global index of the degree of freedom. Compared to accessing the full intensive
+ * quantities objects, this allows kernels which only need a few quantities for many
+ * degrees of freedom to access memory in a streaming fashion.
+ *
+ * The arrays are filled by the discretization alongside the intensive quantity cache,
+ * so an entry is valid if and only if the corresponding cache entry is.
+ */
+template <class TypeTag>
+class FvBaseIntensiveQuantityArrays
+{
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+
+public:
+    /*!
+     * \brief Set the number of degrees of freedom for which quantities are stored.
+     */
+    void resize(size_t numDof)
+    {
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            pressure_[phaseIdx].resize(numDof);
+            saturation_[phaseIdx].resize(numDof);
+            density_[phaseIdx].resize(numDof);
+            mobility_[phaseIdx].resize(numDof);
+        }
+    }
+
+    /*!
+     * \brief Returns the number of degrees of freedom for which quantities are stored.
+     */
+    size_t size() const
+    { return pressure_[0].size(); }
+
+    /*!
+     * \brief Copy the quantities of a degree of freedom out of its intensive quantities.
+     *
+     * Different degrees of freedom may be updated concurrently.
+     */
+    void update(unsigned globalIdx, const IntensiveQuantities& intQuants)
+    {
+        const auto& fs = intQuants.fluidState();
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            pressure_[phaseIdx][globalIdx] = fs.pressure(phaseIdx);
+            saturation_[phaseIdx][globalIdx] = fs.saturation(phaseIdx);
+            density_[phaseIdx][globalIdx] = fs.density(phaseIdx);
+            mobility_[phaseIdx][globalIdx] = intQuants.mobility(phaseIdx);
+        }
+    }
+
+    /*!
+     * \brief Returns the pressures of a fluid phase of all degrees of freedom.
+     */
+    const std::vector<Evaluation>& pressure(unsigned phaseIdx) const
+    { return pressure_[phaseIdx]; }
+
+    /*!
+     * \brief Returns the saturations of a fluid phase of all degrees of freedom.
+     */
+    const std::vector<Evaluation>& saturation(unsigned phaseIdx) const
+    { return saturation_[phaseIdx]; }
+
+    /*!
+     * \brief Returns the densities of a fluid phase of all degrees of freedom.
+     */
+    const std::vector<Evaluation>& density(unsigned phaseIdx) const
+    { return density_[phaseIdx]; }
+
+    /*!
+     * \brief Returns the mobilities of a fluid phase of all degrees of freedom.
+     */
+    const std::vector<Evaluation>& mobility(unsigned phaseIdx) const
+    { return mobility_[phaseIdx]; }
+
+private:
+    std::vector<Evaluation> pressure_[numPhases];
+    std::vector<Evaluation> saturation_[numPhases];
+    std::vector<Evaluation> density_[numPhases];
+    std::vector<Evaluation> mobility_[numPhases];
+};
+
+} // namespace Opm
+
+#endif
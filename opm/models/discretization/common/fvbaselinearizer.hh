@@ -28,12 +28,20 @@
 #ifndef EWOMS_FV_BASE_LINEARIZER_HH
 #define EWOMS_FV_BASE_LINEARIZER_HH
 
+#include "fvbaseconstraintsmap.hh"
 #include "fvbaseproperties.hh"
 #include "linearizationtype.hh"
 
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
+#include <opm/models/parallel/threadphases.hh>
+#include <opm/models/parallel/blockvectorkernels.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
+#include <opm/models/parallel/chunkedentityiterator.hh>
+#include <opm/models/utils/eventtracer.hh>
+#include <opm/models/utils/instrumentation.hh>
+#include <opm/models/utils/genericguard.hh>
+#include <opm/models/utils/prefetch.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
 
 #include <opm/material/common/Exceptions.hpp>
@@ -42,13 +50,20 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <type_traits>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 #include <thread>
+#include <map>
 #include <set>
 #include <exception>   // current_exception, rethrow_exception
 #include <mutex>
+#include <atomic>
 
 namespace Opm {
 // forward declarations
@@ -84,6 +99,7 @@ class FvBaseLinearizer
     using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
     using Constraints = GetPropType<TypeTag, Properties::Constraints>;
+    using ConstraintsMap = FvBaseConstraintsMap<Constraints>;
     using Stencil = GetPropType<TypeTag, Properties::Stencil>;
     using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
@@ -93,6 +109,7 @@ class FvBaseLinearizer
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeed = typename Element::EntitySeed;
 
     using Vector = GlobalEqVector;
 
@@ -106,6 +123,110 @@ class FvBaseLinearizer
 
     static const bool linearizeNonLocalElements = getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
 
+    // the local linearization of an element: the global indices of the degrees of
+    // freedom in its stencil (the primary ones first), the residual of its primary
+    // degrees of freedom and the derivatives of these w.r.t. all degrees of freedom.
+    struct ElementLinearization
+    {
+        size_t numPrimaryDof = 0;
+        std::vector<unsigned> globalIdx;
+        std::vector<VectorBlock> residual;
+        std::vector<MatrixBlock> jacobian;
+    };
+
+    using GlobalId = typename GridView::Grid::GlobalIdSet::IdType;
+
+    // an entry of a matrix row which is sent to the process which owns the row
+    struct GhostRowEntry
+    {
+        GlobalId colId;
+        MatrixBlock value;
+    };
+
+    // adds the entries which a process has linearized for the rows of its non-interior
+    // elements to the rows of the processes which own these elements
+    class GhostRowsHandle_
+        : public Dune::CommDataHandleIF<GhostRowsHandle_, GhostRowEntry>
+    {
+    public:
+        GhostRowsHandle_(IstlMatrix& matrix,
+                         const ElementMapper& elementMapper,
+                         const std::vector<unsigned>& elemDof,
+                         const std::vector<GlobalId>& dofGlobalId,
+                         const std::vector<unsigned char>& isInteriorDof,
+                         const std::map<GlobalId, unsigned>& globalIdToDof)
+            : matrix_(matrix)
+            , elementMapper_(elementMapper)
+            , elemDof_(elemDof)
+            , dofGlobalId_(dofGlobalId)
+            , isInteriorDof_(isInteriorDof)
+            , globalIdToDof_(globalIdToDof)
+        {}
+
+        bool contains(int dim OPM_UNUSED, int codim) const
+        { return codim == 0; }
+
+        bool fixedsize(int dim OPM_UNUSED, int codim OPM_UNUSED) const
+        { return false; }
+
+        template <class EntityType>
+        size_t size(const EntityType& e) const
+        {
+            // only the columns of the interior degrees of freedom have been linearized
+            const auto& row = matrix_[rowIdx_(e)];
+            size_t n = 0;
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                n += isInteriorDof_[colIt.index()];
+            return n;
+        }
+
+        template <class MessageBufferImp, class EntityType>
+        void gather(MessageBufferImp& buff, const EntityType& e) const
+        {
+            const auto& row = matrix_[rowIdx_(e)];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                if (!isInteriorDof_[colIt.index()])
+                    continue;
+
+                GhostRowEntry entry;
+                entry.colId = dofGlobalId_[colIt.index()];
+                entry.value = *colIt;
+                buff.write(entry);
+            }
+        }
+
+        template <class MessageBufferImp, class EntityType>
+        void scatter(MessageBufferImp& buff, const EntityType& e, size_t n)
+        {
+            auto& row = matrix_[rowIdx_(e)];
+            for (size_t i = 0; i < n; ++i) {
+                GhostRowEntry entry;
+                buff.read(entry);
+
+                // the columns of the sender are neighbors of the row's element, so they
+                // are always part of the local grid partition
+                auto dofIt = globalIdToDof_.find(entry.colId);
+                if (dofIt == globalIdToDof_.end())
+                    continue;
+                auto colIt = row.find(dofIt->second);
+                if (colIt != row.end())
+                    *colIt += entry.value;
+            }
+        }
+
+    private:
+        template <class EntityType>
+        unsigned rowIdx_(const EntityType& e) const
+        { return elemDof_[static_cast<unsigned>(elementMapper_.index(e))]; }
+
+        IstlMatrix& matrix_;
+        const ElementMapper& elementMapper_;
+        const std::vector<unsigned>& elemDof_;
+        const std::vector<GlobalId>& dofGlobalId_;
+        const std::vector<unsigned char>& isInteriorDof_;
+        const std::map<GlobalId, unsigned>& globalIdToDof_;
+    };
+
     // copying the linearizer is not a good idea
     FvBaseLinearizer(const FvBaseLinearizer&);
 //! \endcond
@@ -115,6 +236,13 @@ public:
         : jacobian_()
     {
         simulatorPtr_ = 0;
+        useColoring_ = false;
+        usePartialRelinearization_ = false;
+        partialRelinearizationTolerance_ = 0.0;
+        numRelinearizedElements_ = 0;
+        prefetchDistance_ = 1;
+        ownerComputes_ = false;
+        retainFluxes_ = false;
     }
 
     ~FvBaseLinearizer()
@@ -129,7 +257,32 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, bool, UseLinearizationColoring,
+                             "Assemble the global Jacobian color by color without "
+                             "locking in multi-threaded simulations");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnablePartialRelinearization,
+                             "Only relinearize the elements which are affected by a "
+                             "changed degree of freedom after the first Newton iteration "
+                             "of a time step (ignored if coloring is used)");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PartialRelinearizationTolerance,
+                             "The change of the primary variables below which a degree of "
+                             "freedom is considered unchanged by the partial "
+                             "relinearization");
+        EWOMS_REGISTER_PARAM(TypeTag, int, LinearizationPrefetchDistance,
+                             "The number of elements by which the data required to "
+                             "linearize an element is prefetched ahead of time (0 disables "
+                             "prefetching)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableOwnerComputesLinearization,
+                             "Only linearize the interior elements of each process and "
+                             "send the Jacobian entries of the process boundary faces to "
+                             "the processes which own the neighboring elements (only "
+                             "used by the element-centered finite volume discretization)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, RetainLinearizationFluxes,
+                             "Keep the fluxes of the faces of the last linearization so "
+                             "that the velocities do not need to be computed again for "
+                             "the output");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -143,6 +296,18 @@ public:
     void init(Simulator& simulator)
     {
         simulatorPtr_ = &simulator;
+        useColoring_ = EWOMS_GET_PARAM(TypeTag, bool, UseLinearizationColoring);
+        usePartialRelinearization_ =
+            EWOMS_GET_PARAM(TypeTag, bool, EnablePartialRelinearization) && !useColoring_;
+        partialRelinearizationTolerance_ =
+            EWOMS_GET_PARAM(TypeTag, Scalar, PartialRelinearizationTolerance);
+        prefetchDistance_ =
+            static_cast<size_t>(std::max(0, EWOMS_GET_PARAM(TypeTag, int, LinearizationPrefetchDistance)));
+        ownerComputes_ =
+            linearizeNonLocalElements
+            && EWOMS_GET_PARAM(TypeTag, bool, EnableOwnerComputesLinearization)
+            && simulator.gridView().comm().size() > 1;
+        retainFluxes_ = EWOMS_GET_PARAM(TypeTag, bool, RetainLinearizationFluxes);
         eraseMatrix();
         auto it = elementCtx_.begin();
         const auto& endIt = elementCtx_.end();
@@ -222,6 +387,57 @@ public:
             throw NumericalIssue("A process did not succeed in linearizing the system");
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain for the current solution
+     *        without linearizing it.
+     *
+     * The result is the same as the residual of linearizeDomain(), but the Jacobian
+     * matrix is not touched. Since none of the degrees of freedom is focused on, the
+     * storage and flux terms are computed without propagating derivatives. Note that
+     * the auxiliary equations are not considered and that the residuals of the degrees
+     * of freedom on the process boundaries are not summed up.
+     *
+     * \param dest The vector which receives the residual
+     */
+    void evaluateResidual(GlobalEqVector& dest)
+    {
+        if (!jacobian_)
+            initFirstIteration_();
+
+        int succeeded;
+        try {
+            evaluateResidual_(dest);
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = gridView_().comm().min(succeeded);
+
+        if (!succeeded)
+            throw NumericalIssue("A process did not succeed in evaluating the residual");
+    }
+
+    /*!
+     * \brief Evaluate the residual of the spatial domain for the current solution and
+     *        store it in the residual vector of the linearizer.
+     *
+     * \copydetails evaluateResidual(GlobalEqVector&)
+     */
+    void evaluateResidual()
+    { evaluateResidual(residual_); }
+
     void finalize()
     { jacobian_->finalize(); }
 
@@ -265,6 +481,47 @@ public:
     SparseMatrixAdapter& jacobian()
     { return *jacobian_; }
 
+    /*!
+     * \brief Returns the number of bytes held by the global Jacobian matrix and the
+     *        right-hand side.
+     */
+    size_t memoryUsage() const
+    {
+        using VectorBlock = typename GlobalEqVector::block_type;
+        size_t result = residual_.size()*sizeof(VectorBlock);
+        for (const auto& threadResidual : threadResiduals_)
+            result += threadResidual.size()*sizeof(VectorBlock);
+
+        if (jacobian_) {
+            using IstlMatrix = typename SparseMatrixAdapter::IstlMatrix;
+            const IstlMatrix& matrix = jacobian_->istlMatrix();
+            result +=
+                matrix.nonzeroes()*(sizeof(typename IstlMatrix::block_type)
+                                    + sizeof(typename IstlMatrix::size_type))
+                + matrix.N()*sizeof(typename IstlMatrix::row_type);
+        }
+        return result;
+    }
+
+    /*!
+     * \brief Prefetch a row of the global Jacobian matrix into the cache.
+     *
+     * If the Jacobian matrix has not been allocated yet, this is a no-op.
+     *
+     * \param rowIdx The global index of the degree of freedom which corresponds to the row
+     */
+    void prefetchJacobianRow(unsigned rowIdx) const
+    {
+        if (!jacobian_)
+            return;
+
+        const auto& row = jacobian_->istlMatrix()[rowIdx];
+        if (row.size() > 0)
+            // the blocks of a row are stored contiguously and they will be written to
+            ::Opm::prefetch</*temporalLocality=*/1, /*writeOnly=*/1>(*row.begin(),
+                                                                     static_cast<unsigned>(row.size()));
+    }
+
     /*!
      * \brief Return constant reference to global residual vector.
      */
@@ -287,9 +544,27 @@ public:
      *
      * (This object is only non-empty if the EnableConstraints property is true.)
      */
-    const std::map<unsigned, Constraints>& constraintsMap() const
+    const ConstraintsMap& constraintsMap() const
     { return constraintsMap_; }
 
+    /*!
+     * \brief Returns the number of element colors used for lock-free assembly.
+     *
+     * (This is zero if the UseLinearizationColoring parameter is false or if the system
+     * has not been linearized yet.)
+     */
+    size_t numElementColors() const
+    { return elementColors_.size(); }
+
+    /*!
+     * \brief Returns the number of elements which were linearized from scratch by the
+     *        most recent linearization of the spatial domain.
+     *
+     * (This is only meaningful if the EnablePartialRelinearization parameter is true.)
+     */
+    size_t numRelinearizedElements() const
+    { return numRelinearizedElements_; }
+
 private:
     Simulator& simulator_()
     { return *simulatorPtr_; }
@@ -319,61 +594,325 @@ private:
     {
         // initialize the BCRS matrix for the Jacobian of the residual function
         createMatrix_();
+        createScatterMap_();
+        if (ownerComputes_)
+            createGhostRowMaps_();
 
         // initialize the Jacobian matrix and the vector for the residual function
         residual_.resize(model_().numTotalDof());
         resetSystem_();
 
+        // if elements share primary degrees of freedom, each thread adds the local
+        // residuals to its own right-hand side, so the residual never needs to be
+        // locked. this trades memory for scalability.
+        threadResiduals_.clear();
+        if (getPropValue<TypeTag, Properties::UseLinearizationLock>() && ThreadManager::maxThreads() > 1) {
+            threadResiduals_.resize(ThreadManager::maxThreads());
+            for (auto& threadResidual : threadResiduals_) {
+                threadResidual.resize(model_().numTotalDof());
+                BlockVectorKernels::fill(threadResidual, 0.0);
+            }
+        }
+
         // create the per-thread context objects
         elementCtx_.resize(ThreadManager::maxThreads());
         for (unsigned threadId = 0; threadId != ThreadManager::maxThreads(); ++ threadId)
             elementCtx_[threadId] = new ElementContext(simulator_());
+
+        // the coloring only depends on the grid, so it is recomputed only if the
+        // matrix gets recreated
+        elementColors_.clear();
+        if (useColoring_)
+            computeElementColoring_();
+
+        // the cached local linearizations refer to the old grid
+        elementLinearizations_.clear();
+    }
+
+    // partition the elements which need to be linearized into sets ("colors") such
+    // that no two elements of the same color share any degree of freedom in their
+    // stencils. this is done using a simple greedy algorithm.
+    void computeElementColoring_()
+    {
+        Stencil stencil(gridView_(), model_().dofMapper());
+        size_t numGridDof = model_().numGridDof();
+
+        // first, determine the degrees of freedom in the stencil of each element and
+        // the elements which touch each degree of freedom. both are stored in a
+        // compressed row format.
+        const auto& elementSeeds = model_().elementSeeds();
+        std::vector<unsigned> elemIndices;
+        std::vector<unsigned> elemDofOffsets(1, 0);
+        std::vector<unsigned> elemDofs;
+        std::vector<unsigned> dofElemOffsets(numGridDof + 1, 0);
+
+        for (size_t seedIdx = 0; seedIdx < elementSeeds.size(); ++seedIdx) {
+            if (!isLinearized_(seedIdx))
+                continue;
+
+            stencil.updateTopology(elementSeeds.entity(seedIdx));
+            for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                unsigned globalIdx = stencil.globalSpaceIndex(dofIdx);
+                elemDofs.push_back(globalIdx);
+                ++ dofElemOffsets[globalIdx + 1];
+            }
+            elemDofOffsets.push_back(static_cast<unsigned>(elemDofs.size()));
+            elemIndices.push_back(static_cast<unsigned>(seedIdx));
+        }
+
+        for (size_t dofIdx = 0; dofIdx < numGridDof; ++dofIdx)
+            dofElemOffsets[dofIdx + 1] += dofElemOffsets[dofIdx];
+
+        size_t numElements = elemIndices.size();
+        std::vector<unsigned> dofElems(dofElemOffsets.back());
+        std::vector<unsigned> dofElemFill(dofElemOffsets.begin(), dofElemOffsets.end() - 1);
+        for (unsigned elemIdx = 0; elemIdx < numElements; ++elemIdx)
+            for (unsigned i = elemDofOffsets[elemIdx]; i < elemDofOffsets[elemIdx + 1]; ++i)
+                dofElems[dofElemFill[elemDofs[i]]++] = elemIdx;
+
+        // then, assign each element the smallest color which is not yet used by any of
+        // the elements it shares a degree of freedom with
+        static constexpr unsigned noColor = std::numeric_limits<unsigned>::max();
+        std::vector<unsigned> elemColor(numElements, noColor);
+        std::vector<unsigned> colorBlockedBy;
+        for (unsigned elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+            for (unsigned i = elemDofOffsets[elemIdx]; i < elemDofOffsets[elemIdx + 1]; ++i) {
+                unsigned globalIdx = elemDofs[i];
+                for (unsigned j = dofElemOffsets[globalIdx]; j < dofElemOffsets[globalIdx + 1]; ++j) {
+                    unsigned otherColor = elemColor[dofElems[j]];
+                    if (otherColor != noColor)
+                        colorBlockedBy[otherColor] = elemIdx;
+                }
+            }
+
+            unsigned color = 0;
+            while (color < colorBlockedBy.size() && colorBlockedBy[color] == elemIdx)
+                ++ color;
+            if (color == colorBlockedBy.size()) {
+                colorBlockedBy.push_back(noColor);
+                elementColors_.emplace_back();
+            }
+
+            elemColor[elemIdx] = color;
+            elementColors_[color].push_back(elemIndices[elemIdx]);
+        }
     }
 
-    // Construct the BCRS matrix for the Jacobian of the residual function
+    // Construct the BCRS matrix for the Jacobian of the residual function. this is only
+    // done for the first linearization and after the grid or the auxiliary equations
+    // were changed (see eraseMatrix()); the overlapping matrix of the linear solver is
+    // likewise kept until the sequence number of the grid changes.
+    //
+    // the sparsity pattern is assembled in a compressed row format: the first pass over
+    // the grid counts the (possibly duplicate) neighbors of each degree of freedom, the
+    // second one stores them in a single contiguous array. the duplicates are then
+    // removed by sorting each row. compared to a std::set per row, this avoids
+    // allocating a tree node for every non-zero entry of the matrix.
     void createMatrix_()
     {
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
+        size_t numDof = model.numTotalDof();
 
-        // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
+        // the auxiliary modules specify their neighbors using one set per degree of
+        // freedom. these sets are only created if there are auxiliary modules.
         using NeighborSet = std::set< unsigned >;
-        std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
+        std::vector<NeighborSet> auxNeighbors;
+        size_t numAuxMod = model.numAuxiliaryModules();
+        if (numAuxMod > 0) {
+            auxNeighbors.resize(numDof);
+            for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+                model.auxiliaryModule(auxModIdx)->addNeighbors(auxNeighbors);
+        }
+
+        // first pass: count the number of neighbors of each degree of freedom
+        std::vector<size_t> rowOffsets(numDof + 1, 0);
+        forEachStencilEntry_([&rowOffsets](unsigned rowIdx, unsigned)
+                             { ++ rowOffsets[rowIdx + 1]; });
+        for (size_t dofIdx = 0; dofIdx < auxNeighbors.size(); ++dofIdx)
+            rowOffsets[dofIdx + 1] += auxNeighbors[dofIdx].size();
+        for (size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            rowOffsets[dofIdx + 1] += rowOffsets[dofIdx];
+
+        // second pass: store the neighbors
+        std::vector<unsigned> columnIndices(rowOffsets.back());
+        std::vector<size_t> rowFill(rowOffsets.begin(), rowOffsets.end() - 1);
+        forEachStencilEntry_([&columnIndices, &rowFill](unsigned rowIdx, unsigned colIdx)
+                             { columnIndices[rowFill[rowIdx]++] = colIdx; });
+        for (size_t dofIdx = 0; dofIdx < auxNeighbors.size(); ++dofIdx)
+            for (unsigned colIdx : auxNeighbors[dofIdx])
+                columnIndices[rowFill[dofIdx]++] = colIdx;
+        auxNeighbors.clear();
+
+        // sort the neighbors of each degree of freedom and remove the duplicates. the
+        // rows are independent, so this is done concurrently.
+        std::vector<size_t> rowSizes(numDof);
+        static const unsigned sortPhaseIdx = ThreadPhases::phaseIndex("sparsity pattern", true);
+        ThreadPhases::Scope sortPhase(sortPhaseIdx, numDof);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(sortPhase.numThreads()) schedule(runtime)
+#endif
+        for (long dofIdx = 0; dofIdx < static_cast<long>(numDof); ++dofIdx) {
+            auto rowBegin = columnIndices.begin() + static_cast<long>(rowOffsets[dofIdx]);
+            auto rowEnd = columnIndices.begin() + static_cast<long>(rowOffsets[dofIdx + 1]);
+            std::sort(rowBegin, rowEnd);
+            rowSizes[dofIdx] = static_cast<size_t>(std::unique(rowBegin, rowEnd) - rowBegin);
+        }
+
+        // compact the column indices. since the rows can only shrink, this can be done
+        // in place.
+        size_t numNonZeros = 0;
+        for (size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            size_t oldOffset = rowOffsets[dofIdx];
+            rowOffsets[dofIdx] = numNonZeros;
+            for (size_t i = 0; i < rowSizes[dofIdx]; ++i)
+                columnIndices[numNonZeros + i] = columnIndices[oldOffset + i];
+            numNonZeros += rowSizes[dofIdx];
+        }
+        rowOffsets[numDof] = numNonZeros;
+        columnIndices.resize(numNonZeros);
+
+        // allocate raw matrix
+        jacobian_.reset(new SparseMatrixAdapter(simulator_()));
+
+        // create matrix structure based on sparsity pattern
+        jacobian_->reserve(rowOffsets, columnIndices);
+    }
+
+    // call a function for all pairs of primary degrees of freedom and the degrees of
+    // freedom in their stencils. pairs may be visited multiple times.
+    template <class Functor>
+    void forEachStencilEntry_(Functor func) const
+    {
+        // on Cartesian grids, the neighbors follow from the lattice
+        const auto& structuredLayout = model_().structuredLayout();
+        if (structuredLayout.isStructured()) {
+            unsigned numDof = static_cast<unsigned>(model_().numGridDof());
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                func(dofIdx, dofIdx);
+                structuredLayout.forEachNeighbor(dofIdx, [&func, dofIdx](unsigned neighborIdx)
+                                                 { func(dofIdx, neighborIdx); });
+            }
+            return;
+        }
+
+        Stencil stencil(gridView_(), model_().dofMapper());
 
         ElementIterator elemIt = gridView_().template begin<0>();
         const ElementIterator elemEndIt = gridView_().template end<0>();
         for (; elemIt != elemEndIt; ++elemIt) {
             const Element& elem = *elemIt;
-            stencil.update(elem);
+            // only the connectivity is required to determine the sparsity pattern, so
+            // the geometric quantities of the stencil are not computed here
+            stencil.updateTopology(elem);
 
             for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
                 unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
 
+                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx)
+                    func(myIdx, stencil.globalSpaceIndex(dofIdx));
+            }
+        }
+    }
+
+    // determine the addresses of the blocks of the Jacobian matrix to which the local
+    // linearization of each element is added. they are stored in the same order as the
+    // local Jacobian is traversed, i.e., for all primary degrees of freedom of an
+    // element, the blocks of all degrees of freedom in its stencil. this way, the scatter
+    // does not need to search the rows of the BCRS matrix for the column indices.
+    void createScatterMap_()
+    {
+        Stencil stencil(gridView_(), model_().dofMapper());
+        const auto& elementSeeds = model_().elementSeeds();
+
+        scatterOffsets_.resize(elementSeeds.size() + 1);
+        scatterBlocks_.clear();
+        scatterOffsets_[0] = 0;
+        for (size_t elemIdx = 0; elemIdx < elementSeeds.size(); ++elemIdx) {
+            stencil.updateTopology(elementSeeds.entity(elemIdx));
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                unsigned globI = stencil.globalSpaceIndex(primaryDofIdx);
                 for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
+                    unsigned globJ = stencil.globalSpaceIndex(dofIdx);
+                    scatterBlocks_.push_back(jacobian_->blockAddress(globJ, globI));
                 }
             }
+            scatterOffsets_[elemIdx + 1] = scatterBlocks_.size();
         }
+    }
 
-        // add the additional neighbors and degrees of freedom caused by the auxiliary
-        // equations
-        size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+    // returns true if the local linearization of an element is added to the global
+    // linear system of equations of the process
+    bool isLinearized_(const Element& elem) const
+    {
+        return
+            (linearizeNonLocalElements && !ownerComputes_)
+            || elem.partitionType() == Dune::InteriorEntity;
+    }
 
-        // allocate raw matrix
-        jacobian_.reset(new SparseMatrixAdapter(simulator_()));
+    // same as above for the element with a given index in the element seeds of the
+    // model. this does not need to create the element.
+    bool isLinearized_(size_t elemIdx) const
+    {
+        return
+            (linearizeNonLocalElements && !ownerComputes_)
+            || model_().elementSeeds().isInterior(elemIdx);
+    }
 
-        // create matrix structure based on sparsity pattern
-        jacobian_->reserve(sparsityPattern);
+    // determine the global identifiers of the degrees of freedom which are required to
+    // send the rows of the non-interior elements to their owners. this only works if
+    // each element exhibits exactly one degree of freedom.
+    void createGhostRowMaps_()
+    {
+        Stencil stencil(gridView_(), model_().dofMapper());
+        const auto& globalIdSet = gridView_().grid().globalIdSet();
+        size_t numGridDof = model_().numGridDof();
+
+        elemDof_.resize(static_cast<size_t>(gridView_().size(/*codim=*/0)));
+        dofGlobalId_.resize(numGridDof);
+        isInteriorDof_.assign(model_().numTotalDof(), 0);
+        globalIdToDof_.clear();
+
+        ElementIterator elemIt = gridView_().template begin<0>();
+        const ElementIterator elemEndIt = gridView_().template end<0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
+            const Element& elem = *elemIt;
+            stencil.updateTopology(elem);
+            if (stencil.numPrimaryDof() != 1)
+                throw std::logic_error("The owner-computes linearization requires a "
+                                       "discretization with one degree of freedom per "
+                                       "element");
+
+            unsigned dofIdx = stencil.globalSpaceIndex(/*dofIdx=*/0);
+            GlobalId id = globalIdSet.id(elem);
+            elemDof_[static_cast<unsigned>(elementMapper_().index(elem))] = dofIdx;
+            dofGlobalId_[dofIdx] = id;
+            isInteriorDof_[dofIdx] = elem.partitionType() == Dune::InteriorEntity;
+            globalIdToDof_[id] = dofIdx;
+        }
+    }
+
+    // add the rows of the non-interior elements, which only contain the derivatives with
+    // regard to the interior degrees of freedom, to the rows of the processes which own
+    // them. all entries for a peer process are sent in a single message.
+    void addGhostRowsToOwners_()
+    {
+        Instrumentation::Region region(Instrumentation::overlapSyncRegion);
+        EventTracer::Scope traceScope("ghost row exchange", "mpi");
+        GhostRowsHandle_ handle(jacobian_->istlMatrix(),
+                                elementMapper_(),
+                                elemDof_,
+                                dofGlobalId_,
+                                isInteriorDof_,
+                                globalIdToDof_);
+        gridView_().communicate(handle,
+                                Dune::InteriorBorder_All_Interface,
+                                Dune::BackwardCommunication);
     }
 
     // reset the global linear system of equations.
     void resetSystem_()
     {
-        residual_ = 0.0;
+        BlockVectorKernels::fill(residual_, 0.0);
         // zero all matrix entries
         jacobian_->clear();
     }
@@ -386,42 +925,51 @@ private:
             // constraints are not explictly enabled, so we don't need to consider them!
             return;
 
-        constraintsMap_.clear();
+        // each thread collects the constraints of its elements, these are then merged
+        // into the sorted array
+        std::vector<std::vector<typename ConstraintsMap::value_type> >
+            threadConstraints(ThreadManager::maxThreads());
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        const auto& elementSeeds = model_().elementSeeds();
+        ChunkedEntityIterator<GridView, /*codim=*/0>
+            chunkedElemIt(elementSeeds, model_().threadedElementChunkSize(),
+                          model_().staticElementPartition());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
         {
             unsigned threadId = ThreadManager::threadId();
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                // create an element context (the solution-based quantities are not
-                // available here!)
-                const Element& elem = *elemIt;
-                ElementContext& elemCtx = *elementCtx_[threadId];
-                elemCtx.updateStencil(elem);
-
-                // check if the problem wants to constrain any degree of the current
-                // element's freedom. if yes, add the constraint to the map.
-                for (unsigned primaryDofIdx = 0;
-                     primaryDofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0);
-                     ++ primaryDofIdx)
-                {
-                    Constraints constraints;
-                    elemCtx.problem().constraints(constraints,
-                                                  elemCtx,
-                                                  primaryDofIdx,
-                                                  /*timeIdx=*/0);
-                    if (constraints.isActive()) {
-                        unsigned globI = elemCtx.globalSpaceIndex(primaryDofIdx, /*timeIdx=*/0);
-                        constraintsMap_[globI] = constraints;
-                        continue;
+            size_t beginIdx, endIdx;
+            while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                    // create an element context (the solution-based quantities are not
+                    // available here!)
+                    const Element elem = elementSeeds.entity(elemIdx);
+                    ElementContext& elemCtx = *elementCtx_[threadId];
+                    elemCtx.updateStencil(elem);
+
+                    // check if the problem wants to constrain any degree of the current
+                    // element's freedom. if yes, add the constraint to the map.
+                    for (unsigned primaryDofIdx = 0;
+                         primaryDofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                         ++ primaryDofIdx)
+                    {
+                        Constraints constraints;
+                        elemCtx.problem().constraints(constraints,
+                                                      elemCtx,
+                                                      primaryDofIdx,
+                                                      /*timeIdx=*/0);
+                        if (constraints.isActive()) {
+                            unsigned globI = elemCtx.globalSpaceIndex(primaryDofIdx, /*timeIdx=*/0);
+                            threadConstraints[threadId].emplace_back(globI, constraints);
+                        }
                     }
                 }
             }
         }
+
+        constraintsMap_.assign(threadConstraints);
     }
 
     // linearize the whole system
@@ -437,6 +985,40 @@ private:
 
         applyConstraintsToSolution_();
 
+        // the solution is not modified while the domain is linearized, so the element
+        // contexts may read it from the packed per-element copy
+        model_().updatePackedSolution();
+        auto releasePackedSolutionFn = [this]() -> void
+                                       { this->model_().releasePackedSolution(); };
+        auto packedSolutionGuard = Opm::make_guard(releasePackedSolutionFn);
+
+        if (retainFluxes_)
+            model_().beginFluxRetention();
+
+        if (useColoring_) {
+            linearizeColored_();
+            if (retainFluxes_)
+                model_().endFluxRetention();
+            if (ownerComputes_)
+                addGhostRowsToOwners_();
+            applyConstraintsToLinearization_();
+            return;
+        }
+
+        // the local linearizations of the previous iteration can only be reused within
+        // a time step because the storage term of the previous time step, the time step
+        // size and the constraints may be different for each time step.
+        const auto& elementSeeds = model_().elementSeeds();
+        bool partialRelinearization = false;
+        if (usePartialRelinearization_) {
+            partialRelinearization =
+                model_().newtonMethod().numIterations() > 0
+                && elementLinearizations_.size() == elementSeeds.size();
+            updateChangedDofs_(partialRelinearization);
+            elementLinearizations_.resize(elementSeeds.size());
+        }
+        std::atomic<size_t> numRelinearizedElements(0);
+
         // to avoid a race condition if two threads handle an exception at the same time,
         // we use an explicit lock to control access to the exception storage object
         // amongst thread-local handlers
@@ -447,33 +1029,46 @@ private:
         std::exception_ptr exceptionPtr = nullptr;
 
         // relinearize the elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        ChunkedEntityIterator<GridView, /*codim=*/0>
+            chunkedElemIt(elementSeeds, model_().threadedElementChunkSize(),
+                          model_().staticElementPartition());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
         {
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            ElementIterator nextElemIt = elemIt;
+            size_t beginIdx, endIdx;
             try {
-                for (; !threadedElemIt.isFinished(elemIt); elemIt = nextElemIt) {
-                    // give the model and the problem a chance to prefetch the data required
-                    // to linearize the next element, but only if we need to consider it
-                    nextElemIt = threadedElemIt.increment();
-                    if (!threadedElemIt.isFinished(nextElemIt)) {
-                        const auto& nextElem = *nextElemIt;
-                        if (linearizeNonLocalElements
-                            || nextElem.partitionType() == Dune::InteriorEntity)
-                        {
-                            model_().prefetch(nextElem);
-                            problem_().prefetch(nextElem);
+                while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                    EventTracer::Scope traceScope("linearize chunk", "linearization");
+
+                    // the elements at the beginning of the chunk are not covered by
+                    // the look-ahead of the loop below
+                    size_t headEndIdx = std::min(endIdx, beginIdx + prefetchDistance_);
+                    for (size_t elemIdx = beginIdx + 1; elemIdx < headEndIdx; ++elemIdx)
+                        prefetchElement_(elementSeeds.entity(elemIdx));
+
+                    for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                        // give the model and the problem a chance to prefetch the data
+                        // required to linearize the element which is prefetchDistance_
+                        // elements ahead in the chunk
+                        if (prefetchDistance_ > 0 && elemIdx + prefetchDistance_ < endIdx)
+                            prefetchElement_(elementSeeds.entity(elemIdx + prefetchDistance_));
+
+                        if (!isLinearized_(elemIdx))
+                            continue;
+
+                        // the element is only created if it actually needs to be
+                        // linearized
+                        if (!usePartialRelinearization_)
+                            linearizeElement_(elemIdx, elementSeeds.entity(elemIdx));
+                        else if (partialRelinearization && !elementChanged_(elemIdx))
+                            addElementLinearization_(elemIdx, elementLinearizations_[elemIdx]);
+                        else {
+                            linearizeElement_(elemIdx, elementSeeds.entity(elemIdx),
+                                              elementLinearizations_[elemIdx]);
+                            ++ numRelinearizedElements;
                         }
                     }
-
-                    const Element& elem = *elemIt;
-                    if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
-                        continue;
-
-                    linearizeElement_(elem);
                 }
             }
             // If an exception occurs in the parallel block, it won't escape the
@@ -488,7 +1083,7 @@ private:
             catch(...) {
                 std::lock_guard<std::mutex> take(exceptionLock);
                 exceptionPtr = std::current_exception();
-                threadedElemIt.setFinished();
+                chunkedElemIt.setFinished();
             }
         }  // parallel block
 
@@ -496,14 +1091,195 @@ private:
         // a valid exception if one occurred in one of the threads; rethrow
         // it here to let the outer handler take care of it properly
         if(exceptionPtr) {
+            discardThreadResiduals_();
             std::rethrow_exception(exceptionPtr);
         }
 
+        numRelinearizedElements_ = numRelinearizedElements;
+        if (retainFluxes_)
+            model_().endFluxRetention();
+
+        addThreadResiduals_(residual_);
+
+        if (ownerComputes_)
+            addGhostRowsToOwners_();
+
         applyConstraintsToLinearization_();
     }
 
+    // evaluate the residual of the whole domain without touching the Jacobian
+    void evaluateResidual_(GlobalEqVector& dest)
+    {
+        BlockVectorKernels::fill(dest, 0.0);
+
+        applyConstraintsToSolution_();
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        const auto& elementSeeds = model_().elementSeeds();
+        ChunkedEntityIterator<GridView, /*codim=*/0>
+            chunkedElemIt(elementSeeds, model_().threadedElementChunkSize(),
+                          model_().staticElementPartition());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            size_t beginIdx, endIdx;
+            try {
+                while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                    EventTracer::Scope traceScope("residual chunk", "linearization");
+                    for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                        if (isLinearized_(elemIdx))
+                            evaluateElementResidual_(elementSeeds.entity(elemIdx), dest);
+                    }
+                }
+            }
+            // see linearize_() for why exceptions are handled this way
+            catch(...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                chunkedElemIt.setFinished();
+            }
+        }  // parallel block
+
+        if(exceptionPtr) {
+            discardThreadResiduals_();
+            std::rethrow_exception(exceptionPtr);
+        }
+
+        addThreadResiduals_(dest);
+
+        // make the residual of the constraint degrees of freedom zero
+        if (enableConstraints_()) {
+            for (const auto& constraint : constraintsMap_)
+                dest[constraint.first] = 0.0;
+        }
+    }
+
+    // evaluate the local residual of an element and add it to the global one
+    void evaluateElementResidual_(const Element& elem, GlobalEqVector& dest)
+    {
+        unsigned threadId = ThreadManager::threadId();
+
+        ElementContext *elementCtx = elementCtx_[threadId];
+        auto& localResidual = model_().localLinearizer(threadId).localResidual();
+
+        elementCtx->updateStencil(elem);
+        elementCtx->updateAllIntensiveQuantities();
+
+        // do not focus on any degree of freedom, i.e., no derivatives are considered
+        elementCtx->setFocusDofIndex(std::numeric_limits<unsigned>::max());
+        elementCtx->updateAllExtensiveQuantities();
+        localResidual.eval(*elementCtx);
+
+        // no lock is required, see threadResidual_()
+        auto& residual = threadResidual_(dest);
+        size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+            unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+            const auto& localResid = localResidual.residual(primaryDofIdx);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                residual[globI][eqIdx] += Toolbox::value(localResid[eqIdx]);
+        }
+    }
+
+    // determine the degrees of freedom whose solution changed significantly since the
+    // local linearizations of their elements were cached. if the elements are not
+    // partially relinearized, all degrees of freedom are considered to be changed.
+    void updateChangedDofs_(bool partialRelinearization)
+    {
+        const auto& sol = model_().solution(/*timeIdx=*/0);
+        size_t numGridDof = model_().numGridDof();
+        if (!partialRelinearization) {
+            linearizedSolution_ = sol;
+            dofChanged_.assign(numGridDof, 1);
+            return;
+        }
+
+        for (size_t dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            const auto& curValue = sol[dofIdx];
+            auto& linearizedValue = linearizedSolution_[dofIdx];
+
+            Scalar change = 0.0;
+            for (unsigned pvIdx = 0; pvIdx < curValue.size(); ++pvIdx) {
+                Scalar delta = std::abs(curValue[pvIdx] - linearizedValue[pvIdx]);
+                Scalar scale = std::max<Scalar>(1.0, std::abs(linearizedValue[pvIdx]));
+                change = std::max(change, delta/scale);
+            }
+
+            // all elements which contain the degree of freedom in their stencil get
+            // relinearized, so the new solution becomes the reference
+            dofChanged_[dofIdx] = (change > partialRelinearizationTolerance_);
+            if (dofChanged_[dofIdx])
+                linearizedValue = curValue;
+        }
+    }
+
+    // returns true if the stencil of an element contains a changed degree of freedom
+    bool elementChanged_(size_t elemIdx) const
+    {
+        for (unsigned globalIdx : elementLinearizations_[elemIdx].globalIdx)
+            if (dofChanged_[globalIdx])
+                return true;
+
+        return false;
+    }
+
+    // linearize the whole system one element color at a time. since the elements of a
+    // color do not share any degrees of freedom, no locking is required.
+    void linearizeColored_()
+    {
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::atomic<bool> failed(false);
+
+        static const unsigned colorPhaseIdx = ThreadPhases::phaseIndex("colored linearization", true);
+        const auto& elementSeeds = model_().elementSeeds();
+        for (const auto& elemIndices : elementColors_) {
+            int numElements = static_cast<int>(elemIndices.size());
+            ThreadPhases::Scope colorPhase(colorPhaseIdx, elemIndices.size());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(colorPhase.numThreads()) schedule(runtime)
+#endif
+            for (int i = 0; i < numElements; ++i) {
+                // an OpenMP loop cannot be left prematurely, so we simply skip the
+                // remaining elements if any thread has failed
+                if (failed)
+                    continue;
+
+                try {
+                    size_t elemIdx = elemIndices[static_cast<size_t>(i)];
+                    const Element elem = elementSeeds.entity(elemIdx);
+                    size_t aheadIdx = static_cast<size_t>(i) + prefetchDistance_;
+                    if (prefetchDistance_ > 0 && aheadIdx < elemIndices.size())
+                        prefetchElement_(elementSeeds.entity(elemIndices[aheadIdx]));
+                    linearizeElement_(elemIdx, elem);
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                    failed = true;
+                }
+            }
+
+            if (exceptionPtr)
+                std::rethrow_exception(exceptionPtr);
+        }
+    }
+
     // linearize an element in the interior of the process' grid partition
-    void linearizeElement_(const Element& elem)
+    // give the model and the problem a chance to prefetch the data required to linearize
+    // an element, but only if we need to consider it
+    void prefetchElement_(const Element& elem) const
+    {
+        if (isLinearized_(elem)) {
+            model_().prefetch(elem);
+            problem_().prefetch(elem);
+        }
+    }
+
+    void linearizeElement_(size_t elemIdx, const Element& elem)
     {
         unsigned threadId = ThreadManager::threadId();
 
@@ -512,28 +1288,133 @@ private:
 
         // the actual work of linearization is done by the local linearizer class
         localLinearizer.linearize(*elementCtx, elem);
+        if (retainFluxes_)
+            model_().retainFluxes(*elementCtx);
+
+        // update the right hand side and the Jacobian matrix. if the elements are
+        // colored, there are no concurrent writes to the same locations. otherwise, the
+        // right hand side is not locked either, see threadResidual_().
+        Instrumentation::Region region(Instrumentation::globalScatterRegion);
+        size_t numDof = elementCtx->numDof(/*timeIdx=*/0);
+        size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+        auto& residual = useColoring_ ? residual_ : threadResidual_(residual_);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+            unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+            residual[globI] += localLinearizer.residual(primaryDofIdx);
+        }
 
-        // update the right hand side and the Jacobian matrix
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        bool useLock = getPropValue<TypeTag, Properties::UseLinearizationLock>() && !useColoring_;
+        if (useLock)
             globalMatrixMutex_.lock();
 
+        MatrixBlock* const* blocks = scatterBlocks_.data() + scatterOffsets_[elemIdx];
+        assert(scatterOffsets_[elemIdx + 1] - scatterOffsets_[elemIdx] == numDof*numPrimaryDof);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx)
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++ dofIdx)
+                *blocks[primaryDofIdx*numDof + dofIdx] += localLinearizer.jacobian(dofIdx, primaryDofIdx);
+
+        if (useLock)
+            globalMatrixMutex_.unlock();
+    }
+
+    // linearize an element like above, but store the local linearization of the
+    // element so that it can be reused by later iterations
+    void linearizeElement_(size_t elemIdx, const Element& elem, ElementLinearization& elemLin)
+    {
+        unsigned threadId = ThreadManager::threadId();
+
+        ElementContext *elementCtx = elementCtx_[threadId];
+        auto& localLinearizer = model_().localLinearizer(threadId);
+
+        localLinearizer.linearize(*elementCtx, elem);
+        if (retainFluxes_)
+            model_().retainFluxes(*elementCtx);
+
+        size_t numDof = elementCtx->numDof(/*timeIdx=*/0);
         size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+        elemLin.numPrimaryDof = numPrimaryDof;
+        elemLin.globalIdx.resize(numDof);
+        elemLin.residual.resize(numPrimaryDof);
+        elemLin.jacobian.resize(numDof*numPrimaryDof);
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++ dofIdx)
+            elemLin.globalIdx[dofIdx] = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
+
         for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
-            unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+            elemLin.residual[primaryDofIdx] = localLinearizer.residual(primaryDofIdx);
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++ dofIdx)
+                elemLin.jacobian[primaryDofIdx*numDof + dofIdx] =
+                    localLinearizer.jacobian(dofIdx, primaryDofIdx);
+        }
+
+        addElementLinearization_(elemIdx, elemLin);
+    }
+
+    // add the cached local linearization of an element to the global system of
+    // equations
+    void addElementLinearization_(size_t elemIdx, const ElementLinearization& elemLin)
+    {
+        Instrumentation::Region region(Instrumentation::globalScatterRegion);
+        auto& residual = threadResidual_(residual_);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < elemLin.numPrimaryDof; ++ primaryDofIdx)
+            residual[elemLin.globalIdx[primaryDofIdx]] += elemLin.residual[primaryDofIdx];
+
+        bool useLock = getPropValue<TypeTag, Properties::UseLinearizationLock>();
+        if (useLock)
+            globalMatrixMutex_.lock();
 
-            // update the right hand side
-            residual_[globI] += localLinearizer.residual(primaryDofIdx);
+        // the local Jacobian is stored in the same order as the scatter map
+        size_t numDof = elemLin.globalIdx.size();
+        MatrixBlock* const* blocks = scatterBlocks_.data() + scatterOffsets_[elemIdx];
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < elemLin.numPrimaryDof; ++ primaryDofIdx)
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++ dofIdx)
+                *blocks[primaryDofIdx*numDof + dofIdx] += elemLin.jacobian[primaryDofIdx*numDof + dofIdx];
 
-            // update the global Jacobian matrix
-            for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx) {
-                unsigned globJ = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
+        if (useLock)
+            globalMatrixMutex_.unlock();
+    }
+
+    // returns the vector to which the current thread adds its local residuals. if
+    // elements do not share any primary degree of freedom (i.e., the linearization does
+    // not need to be locked), each element owns its rows, so they are added directly.
+    // otherwise, the per-thread right-hand sides are used, which are added up by
+    // addThreadResiduals_() after all elements have been handled.
+    GlobalEqVector& threadResidual_(GlobalEqVector& globalResidual)
+    {
+        if (threadResiduals_.empty())
+            return globalResidual;
+        return threadResiduals_[ThreadManager::threadId()];
+    }
+
+    // add the per-thread right-hand sides to a vector and reset them. each thread
+    // handles a contiguous range of the rows of all of them.
+    void addThreadResiduals_(GlobalEqVector& dest)
+    {
+        if (threadResiduals_.empty())
+            return;
 
-                jacobian_->addToBlock(globJ, globI, localLinearizer.jacobian(dofIdx, primaryDofIdx));
+        size_t numDof = dest.size();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            size_t beginIdx, endIdx;
+            ThreadManager::threadRange(numDof, ThreadManager::threadId(), beginIdx, endIdx);
+            for (auto& threadResidual : threadResiduals_) {
+                assert(threadResidual.size() == numDof);
+                for (size_t dofIdx = beginIdx; dofIdx < endIdx; ++dofIdx) {
+                    dest[dofIdx] += threadResidual[dofIdx];
+                    threadResidual[dofIdx] = 0.0;
+                }
             }
         }
+    }
 
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
-            globalMatrixMutex_.unlock();
+    // reset the per-thread right-hand sides without using their contributions, e.g.
+    // if the linearization was aborted
+    void discardThreadResiduals_()
+    {
+        for (auto& threadResidual : threadResiduals_)
+            BlockVectorKernels::fill(threadResidual, 0.0);
     }
 
     // apply the constraints to the solution. (i.e., the solution of constraint degrees
@@ -547,11 +1428,17 @@ private:
         auto& sol = model_().solution(/*timeIdx=*/0);
         auto& oldSol = model_().solution(/*timeIdx=*/1);
 
-        auto it = constraintsMap_.begin();
-        const auto& endIt = constraintsMap_.end();
-        for (; it != endIt; ++it) {
-            sol[it->first] = it->second;
-            oldSol[it->first] = it->second;
+        // each degree of freedom is constrained at most once, so the entries can be
+        // processed concurrently
+        int numConstraints = static_cast<int>(constraintsMap_.size());
+        ThreadPhases::Scope phase(constraintsPhaseIdx_(), constraintsMap_.size());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(phase.numThreads()) schedule(runtime)
+#endif
+        for (int i = 0; i < numConstraints; ++i) {
+            const auto& constraint = constraintsMap_[static_cast<size_t>(i)];
+            sol[constraint.first] = constraint.second;
+            oldSol[constraint.first] = constraint.second;
         }
     }
 
@@ -562,10 +1449,13 @@ private:
         if (!enableConstraints_())
             return;
 
-        auto it = constraintsMap_.begin();
-        const auto& endIt = constraintsMap_.end();
-        for (; it != endIt; ++it) {
-            unsigned constraintDofIdx = it->first;
+        int numConstraints = static_cast<int>(constraintsMap_.size());
+        ThreadPhases::Scope phase(constraintsPhaseIdx_(), constraintsMap_.size());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(phase.numThreads()) schedule(runtime)
+#endif
+        for (int i = 0; i < numConstraints; ++i) {
+            unsigned constraintDofIdx = constraintsMap_[static_cast<size_t>(i)].first;
 
             // reset the column of the Jacobian matrix
             // put an identity matrix on the main diagonal of the Jacobian
@@ -579,12 +1469,18 @@ private:
     static bool enableConstraints_()
     { return getPropValue<TypeTag, Properties::EnableConstraints>(); }
 
+    static unsigned constraintsPhaseIdx_()
+    {
+        static const unsigned phaseIdx = ThreadPhases::phaseIndex("constraints", true);
+        return phaseIdx;
+    }
+
     Simulator *simulatorPtr_;
     std::vector<ElementContext*> elementCtx_;
 
     // The constraint equations (only non-empty if the
     // EnableConstraints property is true)
-    std::map<unsigned, Constraints> constraintsMap_;
+    ConstraintsMap constraintsMap_;
 
     // the jacobian matrix
     std::unique_ptr<SparseMatrixAdapter> jacobian_;
@@ -592,9 +1488,50 @@ private:
     // the right-hand side
     GlobalEqVector residual_;
 
+    // the right-hand sides to which the threads add their local residuals (only
+    // non-empty if the UseLinearizationLock property is true and multiple threads are
+    // used)
+    std::vector<GlobalEqVector> threadResiduals_;
+
     LinearizationType linearizationType_;
 
     std::mutex globalMatrixMutex_;
+
+    // the indices of the elements to be linearized in the element seeds of the model,
+    // grouped by color (only non-empty if the UseLinearizationColoring parameter is true)
+    bool useColoring_;
+    std::vector<std::vector<unsigned> > elementColors_;
+
+    // the addresses of the Jacobian blocks to which the local linearization of each
+    // element is added, indexed like the element seeds of the model
+    std::vector<size_t> scatterOffsets_;
+    std::vector<MatrixBlock*> scatterBlocks_;
+
+    // the cached local linearizations indexed like the element seeds of the model, the
+    // solution they correspond to and the degrees of freedom which changed since then
+    // (only used if the EnablePartialRelinearization parameter is true)
+    bool usePartialRelinearization_;
+    Scalar partialRelinearizationTolerance_;
+    size_t prefetchDistance_;
+    std::vector<ElementLinearization> elementLinearizations_;
+    SolutionVector linearizedSolution_;
+    std::vector<unsigned char> dofChanged_;
+    size_t numRelinearizedElements_;
+
+    // the degree of freedom of each element, the global identifiers of the degrees of
+    // freedom and whether they are interior (only used if the
+    // EnableOwnerComputesLinearization parameter is true)
+    bool ownerComputes_;
+    std::vector<unsigned> elemDof_;
+    std::vector<GlobalId> dofGlobalId_;
+    std::vector<unsigned char> isInteriorDof_;
+    std::map<GlobalId, unsigned> globalIdToDof_;
+
+    // pass the element contexts of the linearized elements to the model so that it can
+    // keep the fluxes of their faces (only true if the RetainLinearizationFluxes
+    // parameter is true). elements which are not relinearized by the partial
+    // relinearization keep the fluxes of the iteration in which they were linearized.
+    bool retainFluxes_;
 };
 
 } // namespace Opm
@@ -32,6 +32,7 @@
 
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/instrumentation.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/Unused.hpp>
@@ -44,6 +45,7 @@
 #include <dune/common/classname.hh>
 
 #include <cmath>
+#include <vector>
 
 namespace Opm {
 /*!
@@ -83,12 +85,14 @@ private:
 
     // copying the local residual class is not a good idea
     FvBaseLocalResidual(const FvBaseLocalResidual& )
+        : reusePreviousStorage_(false)
     {}
 
 public:
     using LocalEvalBlockVector = Dune::BlockVector<EvalVector, aligned_allocator<EvalVector, alignof(EvalVector)> >;
 
     FvBaseLocalResidual()
+        : reusePreviousStorage_(false)
     { }
 
     ~FvBaseLocalResidual()
@@ -100,6 +104,18 @@ public:
     static void registerParameters()
     { }
 
+    /*!
+     * \brief Specify whether the storage terms of the previous time step which were
+     *        calculated by the last evaluation are reused.
+     *
+     * This is only valid if the element and the solutions of the previous time steps
+     * are the same as for the last evaluation, e.g. if the residual of an element is
+     * evaluated repeatedly for perturbed primary variables of the current solution. If
+     * the storage cache of the model is enabled, this has no effect.
+     */
+    void setReusePreviousStorage(bool yesno)
+    { reusePreviousStorage_ = yesno; }
+
     /*!
      * \brief Return the result of the eval() call using internal
      *        storage.
@@ -164,7 +180,10 @@ public:
         residual = 0.0;
 
         // evaluate the flux terms
-        asImp_().evalFluxes(residual, elemCtx, /*timeIdx=*/0);
+        {
+            Instrumentation::Region region(Instrumentation::fluxRegion);
+            asImp_().evalFluxes(residual, elemCtx, /*timeIdx=*/0);
+        }
 
         // evaluate the storage and the source terms
         asImp_().evalVolumeTerms_(residual, elemCtx);
@@ -465,7 +484,7 @@ protected:
         BoundaryRateVector values;
 
         Valgrind::SetUndefined(values);
-        boundaryCtx.problem().boundary(values, boundaryCtx, boundaryFaceIdx, timeIdx);
+        boundaryCtx.boundaryRates(values, boundaryFaceIdx, timeIdx);
         Valgrind::CheckDefined(values);
 
         const auto& stencil = boundaryCtx.stencil(timeIdx);
@@ -484,6 +503,37 @@ protected:
             residual[dofIdx][eqIdx] += values[eqIdx];
     }
 
+    /*!
+     * \brief Evaluate the source term of a sub-control volume.
+     *
+     * If the source cache of the model is enabled, the source terms for which the
+     * problem states that they do not depend on the solution are only evaluated once per
+     * time step.
+     *
+     * \return false if the source term is known to be zero
+     */
+    bool evalSource_(RateVector& sourceRate,
+                     const ElementContext& elemCtx,
+                     unsigned dofIdx) const
+    {
+        const auto& model = elemCtx.model();
+        if (!model.enableSourceCache()) {
+            asImp_().computeSource(sourceRate, elemCtx, dofIdx, /*timeIdx=*/0);
+            return true;
+        }
+
+        auto& cache = model.sourceCache();
+        unsigned elemIdx = static_cast<unsigned>(model.elementMapper().index(elemCtx.element()));
+        bool isZero;
+        if (cache.load(sourceRate, isZero, elemIdx, dofIdx))
+            return !isZero;
+
+        asImp_().computeSource(sourceRate, elemCtx, dofIdx, /*timeIdx=*/0);
+        if (!elemCtx.problem().sourceDependsOnSolution(elemCtx, dofIdx, /*timeIdx=*/0))
+            cache.store(sourceRate, elemIdx, dofIdx);
+        return true;
+    }
+
     /*!
      * \brief Add the change in the storage terms and the source term
      *        to the local residual of all sub-control volumes of the
@@ -501,6 +551,10 @@ protected:
 
         // evaluate the volumetric terms (storage + source terms)
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        bool reusePreviousStorage =
+            reusePreviousStorage_ && previousStorage_.size() == numPrimaryDof;
+        if (!reusePreviousStorage)
+            previousStorage_.resize(numPrimaryDof);
         for (unsigned dofIdx=0; dofIdx < numPrimaryDof; dofIdx++) {
             Scalar extrusionFactor =
                 elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
@@ -537,9 +591,10 @@ protected:
                 const auto& model = elemCtx.model();
                 unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
                 if (model.newtonMethod().numIterations() == 0 &&
-                    !elemCtx.haveStashedIntensiveQuantities())
+                    !elemCtx.haveStashedIntensiveQuantities() &&
+                    !model.retryingTimeStep())
                 {
-                    if (!elemCtx.problem().recycleFirstIterationStorage()) {
+                    if (!model.recycleFirstIterationStorage()) {
                         // we re-calculate the storage term for the solution of the
                         // previous time step from scratch instead of using the one of
                         // the first iteration of the current time step.
@@ -571,12 +626,17 @@ protected:
                     Valgrind::CheckDefined(tmp2);
                 }
             }
+            else if (reusePreviousStorage)
+                // the storage term of the previous time step has been calculated by the
+                // last evaluation for the same element
+                tmp2 = previousStorage_[dofIdx];
             else {
                 // if the mass storage at the beginning of the time step is not cached,
                 // we re-calculate it from scratch.
                 tmp2 = 0.0;
                 asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
                 Valgrind::CheckDefined(tmp2);
+                previousStorage_[dofIdx] = tmp2;
             }
 
             // Use the implicit Euler time discretization
@@ -592,7 +652,8 @@ protected:
             Valgrind::CheckDefined(residual[dofIdx]);
 
             // deal with the source term
-            asImp_().computeSource(sourceRate, elemCtx, dofIdx, /*timeIdx=*/0);
+            if (!evalSource_(sourceRate, elemCtx, dofIdx))
+                continue;
 
             // if the model uses extensive quantities in its storage term, and we use
             // automatic differention and current DOF is also not the one we currently
@@ -635,6 +696,10 @@ private:
     { return *static_cast<const Implementation*>(this); }
 
     LocalEvalBlockVector internalResidual_;
+
+    // the storage terms of the previous time step calculated by the last evaluation
+    bool reusePreviousStorage_;
+    mutable std::vector<EqVector> previousStorage_;
 };
 
 } // namespace Opm
@@ -0,0 +1,338 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseNewtonConvergenceTraceWriter
+ */
+#ifndef EWOMS_FV_BASE_NEWTON_CONVERGENCE_TRACE_WRITER_HH
+#define EWOMS_FV_BASE_NEWTON_CONVERGENCE_TRACE_WRITER_HH
+
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <opm/material/common/Unused.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! \cond SKIP_THIS
+namespace Opm::Properties {
+
+// forward declaration of the required property tags
+template<class TypeTag, class MyTypeTag>
+struct SolutionVector;
+template<class TypeTag, class MyTypeTag>
+struct GlobalEqVector;
+template<class TypeTag, class MyTypeTag>
+struct NewtonMethod;
+template<class TypeTag, class MyTypeTag>
+struct NumEq;
+template<class TypeTag, class MyTypeTag>
+struct NewtonConvergenceTraceWorstDofs;
+template<class TypeTag, class MyTypeTag>
+struct NewtonConvergenceTraceFieldStride;
+
+} // namespace Opm::Properties
+//! \endcond
+
+namespace Opm {
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Writes a compact binary trace of the convergence of the Newton scheme for
+ *        models using a finite volume discretization
+ *
+ * In contrast to FvBaseNewtonConvergenceWriter, which writes VTK files with all fields
+ * for each iteration, this writer only records the norms of the residual and of the
+ * update for each equation together with the degrees of freedom which exhibit the
+ * largest residuals and updates. The complete fields are written only for every n-th
+ * iteration as specified by the NewtonConvergenceTraceFieldStride parameter. This keeps
+ * the overhead low enough to leave the trace enabled for large simulations.
+ *
+ * Each process writes the file "$OUTPUT_DIR/$NAME-convergence-$RANK.bin" with the
+ * following layout, where all quantities use the native byte order and the indices of
+ * the degrees of freedom are the ones local to the process:
+ *
+ * - Header: char[8] "OPMCONV1", uint32 numEq, uint32 numWorst, uint64 numDof
+ * - For each Newton iteration:
+ *   - int32 timeStepIdx, int32 iteration, float64 time, uint32 hasFields
+ *   - For each equation: float64 residual 2-norm, residual max-norm, update 2-norm,
+ *     update max-norm
+ *   - For each equation: numWorst pairs of (uint32 dofIdx, float64 residual), ordered by
+ *     descending magnitude. Unused pairs have the index 0xffffffff.
+ *   - The same for the update
+ *   - If hasFields is non-zero: numDof*numEq float64 values of the residual followed by
+ *     the same number of values of the update
+ *
+ * Degrees of freedom which are not owned by the process are not considered.
+ */
+template <class TypeTag>
+class FvBaseNewtonConvergenceTraceWriter
+{
+    using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using NewtonMethod = GetPropType<TypeTag, Properties::NewtonMethod>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+    using WorstEntry = std::pair<double, std::uint32_t>;
+
+public:
+    FvBaseNewtonConvergenceTraceWriter(NewtonMethod& nm)
+        : newtonMethod_(nm)
+    {
+        timeStepIdx_ = 0;
+        iteration_ = 0;
+        numWritten_ = 0;
+        numWorst_ = 0;
+        fieldStride_ = 0;
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the convergence writer.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, NewtonConvergenceTraceWorstDofs,
+                             "The number of degrees of freedom with the largest residuals "
+                             "and updates which are recorded for each equation by the "
+                             "convergence trace");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, NewtonConvergenceTraceFieldStride,
+                             "Write the complete residual and update to the convergence "
+                             "trace for every n-th Newton iteration (0 means never)");
+    }
+
+    /*!
+     * \brief Called by the Newton method before the actual algorithm
+     *        is started for any given timestep.
+     */
+    void beginTimeStep()
+    {
+        ++timeStepIdx_;
+        iteration_ = 0;
+    }
+
+    /*!
+     * \brief Called by the Newton method before an iteration of the
+     *        Newton algorithm is started.
+     */
+    void beginIteration()
+    {
+        ++ iteration_;
+        if (!outStream_.is_open())
+            open_();
+    }
+
+    /*!
+     * \brief Record the residual and the Newton update of the current iteration.
+     *
+     * Called after the linear solution is found for an iteration.
+     *
+     * \param uLastIter The solution vector of the previous iteration.
+     * \param deltaU The negative difference between the solution
+     *        vectors of the previous and the current iteration.
+     */
+    void writeFields(const SolutionVector& uLastIter OPM_UNUSED,
+                     const GlobalEqVector& deltaU)
+    {
+        const auto& model = newtonMethod_.problem().model();
+        const auto& residual = model.linearizer().residual();
+        size_t numDof = model.numGridDof();
+
+        bool writeFields = fieldStride_ > 0 && numWritten_ % fieldStride_ == 0;
+        ++numWritten_;
+
+        buffer_.clear();
+        append_<std::int32_t>(timeStepIdx_);
+        append_<std::int32_t>(iteration_);
+        append_<double>(newtonMethod_.problem().simulator().time());
+        append_<std::uint32_t>(writeFields ? 1 : 0);
+
+        // calculate the norms and find the worst degrees of freedom in a single pass
+        // over the vectors
+        double norms[numEq][4] = {};
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            worstResidual_[eqIdx].clear();
+            worstUpdate_[eqIdx].clear();
+        }
+        for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            if (!model.isLocalDof(dofIdx))
+                continue;
+
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                double r = std::abs(static_cast<double>(residual[dofIdx][eqIdx]));
+                double d = std::abs(static_cast<double>(deltaU[dofIdx][eqIdx]));
+
+                norms[eqIdx][0] += r*r;
+                norms[eqIdx][1] = std::max(norms[eqIdx][1], r);
+                norms[eqIdx][2] += d*d;
+                norms[eqIdx][3] = std::max(norms[eqIdx][3], d);
+
+                insertWorst_(worstResidual_[eqIdx], r, dofIdx);
+                insertWorst_(worstUpdate_[eqIdx], d, dofIdx);
+            }
+        }
+
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            append_<double>(std::sqrt(norms[eqIdx][0]));
+            append_<double>(norms[eqIdx][1]);
+            append_<double>(std::sqrt(norms[eqIdx][2]));
+            append_<double>(norms[eqIdx][3]);
+        }
+
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            appendWorst_(worstResidual_[eqIdx], residual, eqIdx);
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            appendWorst_(worstUpdate_[eqIdx], deltaU, eqIdx);
+
+        if (writeFields) {
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    append_<double>(residual[dofIdx][eqIdx]);
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx)
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    append_<double>(deltaU[dofIdx][eqIdx]);
+        }
+
+        outStream_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    }
+
+    /*!
+     * \brief Called by the Newton method after an iteration of the
+     *        Newton algorithm has been completed.
+     */
+    void endIteration()
+    {}
+
+    /*!
+     * \brief Called by the Newton method after Newton algorithm
+     *        has been completed for any given timestep.
+     *
+     * This method is called regardless of whether the Newton method
+     * converged or not.
+     */
+    void endTimeStep()
+    {
+        iteration_ = 0;
+        if (outStream_.is_open())
+            outStream_.flush();
+    }
+
+private:
+    void open_()
+    {
+        const auto& problem = newtonMethod_.problem();
+        numWorst_ = EWOMS_GET_PARAM(TypeTag, unsigned, NewtonConvergenceTraceWorstDofs);
+        fieldStride_ = EWOMS_GET_PARAM(TypeTag, unsigned, NewtonConvergenceTraceFieldStride);
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            worstResidual_[eqIdx].reserve(numWorst_ + 1);
+            worstUpdate_[eqIdx].reserve(numWorst_ + 1);
+        }
+
+        std::string fileName =
+            problem.outputDir() + "/" + problem.name() + "-convergence-"
+            + std::to_string(problem.gridView().comm().rank()) + ".bin";
+        outStream_.open(fileName, std::ios::binary | std::ios::trunc);
+        if (!outStream_)
+            throw std::runtime_error("Could not open file '"+fileName+"' for writing "
+                                     "the convergence trace");
+
+        buffer_.clear();
+        const char magic[8] = { 'O', 'P', 'M', 'C', 'O', 'N', 'V', '1' };
+        buffer_.insert(buffer_.end(), magic, magic + sizeof(magic));
+        append_<std::uint32_t>(numEq);
+        append_<std::uint32_t>(numWorst_);
+        append_<std::uint64_t>(problem.model().numGridDof());
+        outStream_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    }
+
+    // keep the numWorst_ entries with the largest magnitudes as a min-heap
+    void insertWorst_(std::vector<WorstEntry>& heap, double value, unsigned dofIdx) const
+    {
+        if (numWorst_ == 0)
+            return;
+
+        if (heap.size() < numWorst_) {
+            heap.emplace_back(value, dofIdx);
+            std::push_heap(heap.begin(), heap.end(), std::greater<WorstEntry>());
+        }
+        else if (value > heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<WorstEntry>());
+            heap.back() = WorstEntry(value, dofIdx);
+            std::push_heap(heap.begin(), heap.end(), std::greater<WorstEntry>());
+        }
+    }
+
+    void appendWorst_(std::vector<WorstEntry>& heap, const GlobalEqVector& v, unsigned eqIdx)
+    {
+        // sorting the min-heap in ascending order of std::greater gives the entries in
+        // descending order of their magnitude
+        std::sort_heap(heap.begin(), heap.end(), std::greater<WorstEntry>());
+        for (unsigned i = 0; i < numWorst_; ++i) {
+            if (i < heap.size()) {
+                append_<std::uint32_t>(heap[i].second);
+                append_<double>(v[heap[i].second][eqIdx]);
+            }
+            else {
+                append_<std::uint32_t>(std::numeric_limits<std::uint32_t>::max());
+                append_<double>(0.0);
+            }
+        }
+    }
+
+    template <class T, class From>
+    void append_(const From& value)
+    {
+        T tmp = static_cast<T>(value);
+        const char* bytes = reinterpret_cast<const char*>(&tmp);
+        buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+    }
+
+    int timeStepIdx_;
+    int iteration_;
+    unsigned numWritten_;
+    unsigned numWorst_;
+    unsigned fieldStride_;
+
+    std::vector<WorstEntry> worstResidual_[numEq];
+    std::vector<WorstEntry> worstUpdate_[numEq];
+    std::vector<char> buffer_;
+    std::ofstream outStream_;
+
+    NewtonMethod& newtonMethod_;
+};
+
+} // namespace Opm
+
+#endif
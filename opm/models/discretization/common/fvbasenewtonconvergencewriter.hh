@@ -80,6 +80,12 @@ public:
     ~FvBaseNewtonConvergenceWriter()
     { delete vtkMultiWriter_; }
 
+    /*!
+     * \brief Register all run-time parameters of the convergence writer.
+     */
+    static void registerParameters()
+    {}
+
     /*!
      * \brief Called by the Newton method before the actual algorithm
      *        is started for any given timestep.
@@ -28,10 +28,21 @@
 #ifndef EWOMS_FV_BASE_NEWTON_METHOD_HH
 #define EWOMS_FV_BASE_NEWTON_METHOD_HH
 
+#include "fvbaseproperties.hh"
 #include "fvbasenewtonconvergencewriter.hh"
+#include "fvbasenewtonconvergencetracewriter.hh"
 
 #include <opm/models/nonlinear/newtonmethod.hh>
 #include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/eventtracer.hh>
+#include <opm/models/utils/instrumentation.hh>
+
+#include <opm/material/common/Unused.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
 
 namespace Opm {
 
@@ -40,6 +51,9 @@ class FvBaseNewtonMethod;
 
 template <class TypeTag>
 class FvBaseNewtonConvergenceWriter;
+
+template <class TypeTag>
+class EcfvDiscretization;
 } // namespace Opm
 
 namespace Opm::Properties {
@@ -54,6 +68,25 @@ struct FvBaseNewtonMethod { using InheritsFrom = std::tuple<NewtonMethod>; };
 template<class TypeTag, class MyTypeTag>
 struct DiscNewtonMethod { using type = UndefinedProperty; };
 
+//! Only invalidate the cached intensive quantities of the degrees of freedom which
+//! changed significantly during a Newton update
+template<class TypeTag, class MyTypeTag>
+struct EnableIncrementalIntensiveQuantitiesUpdate { using type = UndefinedProperty; };
+
+//! The change of the primary variables of a degree of freedom below which its cached
+//! intensive quantities are kept if the update is incremental
+template<class TypeTag, class MyTypeTag>
+struct IntensiveQuantitiesUpdateTolerance { using type = UndefinedProperty; };
+
+//! The number of degrees of freedom with the largest residuals and updates which are
+//! recorded for each equation by the convergence trace
+template<class TypeTag, class MyTypeTag>
+struct NewtonConvergenceTraceWorstDofs { using type = UndefinedProperty; };
+
+//! Write the complete fields to the convergence trace for every n-th Newton iteration
+template<class TypeTag, class MyTypeTag>
+struct NewtonConvergenceTraceFieldStride { using type = UndefinedProperty; };
+
 // set default values
 template<class TypeTag>
 struct DiscNewtonMethod<TypeTag, TTag::FvBaseNewtonMethod>
@@ -67,6 +100,25 @@ template<class TypeTag>
 struct NewtonConvergenceWriter<TypeTag, TTag::FvBaseNewtonMethod>
 { using type = FvBaseNewtonConvergenceWriter<TypeTag>; };
 
+template<class TypeTag>
+struct EnableIncrementalIntensiveQuantitiesUpdate<TypeTag, TTag::FvBaseNewtonMethod>
+{ static constexpr bool value = false; };
+
+template<class TypeTag>
+struct IntensiveQuantitiesUpdateTolerance<TypeTag, TTag::FvBaseNewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-10;
+};
+
+template<class TypeTag>
+struct NewtonConvergenceTraceWorstDofs<TypeTag, TTag::FvBaseNewtonMethod>
+{ static constexpr unsigned value = 5; };
+
+template<class TypeTag>
+struct NewtonConvergenceTraceFieldStride<TypeTag, TTag::FvBaseNewtonMethod>
+{ static constexpr unsigned value = 0; };
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -93,12 +145,32 @@ class FvBaseNewtonMethod : public NewtonMethod<TypeTag>
     using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
-
+    using Discretization = GetPropType<TypeTag, Properties::Discretization>;
 
 public:
     FvBaseNewtonMethod(Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        incrementalIntQuantsUpdate_ = EWOMS_GET_PARAM(TypeTag, bool, EnableIncrementalIntensiveQuantitiesUpdate);
+        intQuantsUpdateTolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, IntensiveQuantitiesUpdateTolerance);
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the Newton method.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIncrementalIntensiveQuantitiesUpdate,
+                             "Only recalculate the cached intensive quantities of the "
+                             "degrees of freedom which changed significantly in a Newton "
+                             "iteration and of their neighbors");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, IntensiveQuantitiesUpdateTolerance,
+                             "The change of the primary variables of a degree of freedom "
+                             "below which its cached intensive quantities are kept if "
+                             "incremental updates are enabled");
+    }
 
 protected:
     friend class NewtonMethod<TypeTag>;
@@ -127,26 +199,142 @@ protected:
     {
         ParentType::update_(nextSolution, currentSolution, solutionUpdate, currentResidual);
 
+        if (!model_().storeIntensiveQuantities())
+            return;
+
         // make sure that the intensive quantities get recalculated at the next
         // linearization
-        if (model_().storeIntensiveQuantities()) {
+        if (!incrementalIntQuantsUpdate_) {
             for (unsigned dofIdx = 0; dofIdx < model_().numGridDof(); ++dofIdx)
                 model_().setIntensiveQuantitiesCacheEntryValidity(dofIdx,
                                                                   /*timeIdx=*/0,
                                                                   /*valid=*/false);
+            return;
+        }
+
+        // only invalidate the degrees of freedom which changed significantly and their
+        // neighbors. the solution of non-local degrees of freedom is overwritten by
+        // the process which owns them, so we do not know how much they will change.
+        const auto& jacobian = model_().linearizer().jacobian().istlMatrix();
+        unsigned numGridDof = model_().numGridDof();
+        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            if (model_().isLocalDof(dofIdx)
+                && asImp_().primaryVariablesChange_(dofIdx,
+                                                    nextSolution[dofIdx],
+                                                    currentSolution[dofIdx])
+                   <= intQuantsUpdateTolerance_)
+                continue;
+
+            const auto& row = jacobian[dofIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                unsigned neighborIdx = static_cast<unsigned>(colIt.index());
+                if (neighborIdx < numGridDof)
+                    model_().setIntensiveQuantitiesCacheEntryValidity(neighborIdx,
+                                                                      /*timeIdx=*/0,
+                                                                      /*valid=*/false);
+            }
         }
     }
 
+    /*!
+     * \brief Returns a measure for the change of the primary variables of a degree of
+     *        freedom during a Newton update.
+     *
+     * This is used to decide whether the cached intensive quantities of a degree of
+     * freedom can be kept if incremental updates are enabled. The default is the
+     * maximum of the changes of all primary variables, each relative to the magnitude
+     * of its value if it is larger than one.
+     *
+     * \param globalDofIdx The global index of the degree of freedom
+     * \param nextValue The primary variables after the update
+     * \param currentValue The primary variables before the update
+     */
+    Scalar primaryVariablesChange_(unsigned globalDofIdx OPM_UNUSED,
+                                   const PrimaryVariables& nextValue,
+                                   const PrimaryVariables& currentValue) const
+    {
+        Scalar result = 0.0;
+        for (unsigned pvIdx = 0; pvIdx < nextValue.size(); ++pvIdx) {
+            Scalar delta = std::abs(nextValue[pvIdx] - currentValue[pvIdx]);
+            Scalar scale = std::max<Scalar>(1.0, std::abs(currentValue[pvIdx]));
+            result = std::max(result, delta/scale);
+        }
+
+        return result;
+    }
+
     /*!
      * \brief Indicates the beginning of a Newton iteration.
      */
     void beginIteration_()
     {
-        model_().syncOverlap();
+        {
+            Instrumentation::Region region(Instrumentation::overlapSyncRegion);
+            EventTracer::Scope traceScope("overlap sync", "mpi");
+            model_().syncOverlap();
+        }
 
         ParentType::beginIteration_();
     }
 
+    /*!
+     * \brief Linearize the global non-linear system of equations.
+     *
+     * If the storage term is cached, the linearization of the first iteration also
+     * calculates the storage terms of the previous time level. Afterwards, the solution
+     * of the previous time level can be compressed.
+     */
+    void linearizeDomain_()
+    {
+        ParentType::linearizeDomain_();
+
+        if (this->numIterations() == 0 && model_().enableStorageCache()) {
+            model_().setPreviousStorageCached(true);
+            model_().compressPreviousSolution();
+        }
+    }
+
+    /*!
+     * \brief Recalculate the cached intensive quantities of all degrees of freedom.
+     *
+     * This uses all threads and is done after the overlap has been synchronized, so the
+     * linearizer finds all intensive quantities of the current solution in the cache. If
+     * the cache is disabled, they are calculated on the fly during linearization.
+     */
+    void updateIntensiveQuantities_()
+    {
+        if (!model_().storeIntensiveQuantities())
+            return;
+
+        if (incrementalIntQuantsUpdate_ && this->numIterations() > 0)
+            // update_() invalidated the entries which need to be recalculated
+            model_().updateIntensiveQuantitiesCache(/*timeIdx=*/0);
+        else if (this->numIterations() == 0 && model_().retryingTimeStep())
+            // updateFailed() kept the entries which are still valid for the retry
+            model_().updateIntensiveQuantitiesCache(/*timeIdx=*/0);
+        else
+            model_().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+    }
+
+    /*!
+     * \brief Returns true if local Newton iterations ought to be done on the subdomain
+     *        of each process before the global Newton iterations.
+     *
+     * This is only done for parallel runs of the element centered finite volume
+     * discretization without auxiliary equations: The row of each element is then
+     * complete on the process which owns it, whereas the rows of vertices on the
+     * process border are distributed over multiple processes and auxiliary equations
+     * (e.g. wells) may couple the degrees of freedom of different processes.
+     */
+    bool useSubdomainSolves_() const
+    {
+        return
+            this->subdomainIterations_ > 0
+            && std::is_same<Discretization, EcfvDiscretization<TypeTag> >::value
+            && this->simulator_.gridView().comm().size() > 1
+            && model_().numAuxiliaryModules() == 0;
+    }
+
     /*!
      * \brief Returns a reference to the model.
      */
@@ -160,6 +348,9 @@ protected:
     { return ParentType::model(); }
 
 private:
+    bool incrementalIntQuantsUpdate_;
+    Scalar intQuantsUpdateTolerance_;
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
@@ -58,6 +58,12 @@ class FvBasePrimaryVariables
     using Toolbox = MathToolbox<Evaluation>;
     using ParentType = Dune::FieldVector<Scalar, numEq>;
 
+    static bool& derivativesEnabled_()
+    {
+        static thread_local bool enabled = true;
+        return enabled;
+    }
+
 public:
     FvBasePrimaryVariables()
         : ParentType()
@@ -93,13 +99,31 @@ public:
             return (*this)[varIdx]; // finite differences
         else {
             // automatic differentiation
-            if (timeIdx == linearizationType.time)
+            if (timeIdx == linearizationType.time && derivativesEnabled_())
                 return Toolbox::createVariable((*this)[varIdx], varIdx);
             else
                 return Toolbox::createConstant((*this)[varIdx]);
         }
     }
 
+    /*!
+     * \brief Specify whether the evaluations which are created by makeEvaluation() on
+     *        the calling thread exhibit derivatives.
+     *
+     * If derivatives are disabled, all evaluations are constants. This is used to
+     * compute intensive quantities of which only the values are required. By default,
+     * derivatives are enabled.
+     */
+    static void setDerivativesEnabled(bool yesno)
+    { derivativesEnabled_() = yesno; }
+
+    /*!
+     * \brief Returns true if the evaluations which are created by makeEvaluation() on
+     *        the calling thread exhibit derivatives.
+     */
+    static bool derivativesEnabled()
+    { return derivativesEnabled_(); }
+
     /*!
      * \brief Assign the primary variables "somehow" from a fluid state
      *
@@ -31,16 +31,24 @@
 #include "fvbaseproperties.hh"
 
 #include <opm/models/io/vtkmultiwriter.hh>
+#include <opm/models/io/sampledoutputwriter.hh>
+#include <opm/models/io/insituoutputwriter.hh>
+#include <opm/models/io/timeseriesoutput.hh>
 #include <opm/models/io/restart.hh>
+#include <opm/models/parallel/tasklets.hh>
 #include <opm/models/discretization/common/restrictprolong.hh>
+#include <opm/models/discretization/common/fvbasedofparameterarray.hh>
 
 #include <opm/material/common/Unused.hpp>
 #include <dune/common/fvector.hh>
 
+#include <algorithm>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <string>
 
+#include <sys/resource.h>
 #include <sys/stat.h>
 
 namespace Opm::Properties {
@@ -70,12 +78,16 @@ private:
 
     static const int vtkOutputFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
     using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkOutputFormat>;
+    using SampledOutputWriter = ::Opm::SampledOutputWriter<GridView>;
+    using InSituOutputWriter = ::Opm::InSituOutputWriter<GridView>;
+    using TimeSeriesOutput = ::Opm::TimeSeriesOutput<TypeTag>;
 
     using Model = GetPropType<TypeTag, Properties::Model>;
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
     using NewtonMethod = GetPropType<TypeTag, Properties::NewtonMethod>;
+    using TimeStepController = GetPropType<TypeTag, Properties::TimeStepController>;
 
     using VertexMapper = GetPropType<TypeTag, Properties::VertexMapper>;
     using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
@@ -84,6 +96,7 @@ private:
     using BoundaryRateVector = GetPropType<TypeTag, Properties::BoundaryRateVector>;
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using Constraints = GetPropType<TypeTag, Properties::Constraints>;
+    using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
 
     enum {
         dim = GridView::dimension,
@@ -97,6 +110,39 @@ private:
     using CoordScalar = typename GridView::Grid::ctype;
     using GlobalPosition = Dune::FieldVector<CoordScalar, dimWorld>;
 
+    // prepares and writes the VTK output for a snapshot of the solution
+    class OutputTasklet : public TaskletInterface
+    {
+    public:
+        OutputTasklet(FvBaseProblem& problem,
+                      unsigned snapshotIdx,
+                      Scalar time,
+                      bool writeFull,
+                      bool writeSampled,
+                      bool writeInSitu)
+            : problem_(problem)
+            , snapshotIdx_(snapshotIdx)
+            , time_(time)
+            , writeFull_(writeFull)
+            , writeSampled_(writeSampled)
+            , writeInSitu_(writeInSitu)
+        { }
+
+        void run() final
+        {
+            problem_.writeOutputFields_(&problem_.outputSnapshots_[snapshotIdx_],
+                                        time_, writeFull_, writeSampled_, writeInSitu_);
+        }
+
+    private:
+        FvBaseProblem& problem_;
+        unsigned snapshotIdx_;
+        Scalar time_;
+        bool writeFull_;
+        bool writeSampled_;
+        bool writeInSitu_;
+    };
+
 public:
     // the default restriction and prolongation for adaptation is simply an empty one
     using RestrictProlongOperator = EmptyRestrictProlong ;
@@ -121,7 +167,11 @@ public:
         , boundingBoxMin_(std::numeric_limits<double>::max())
         , boundingBoxMax_(-std::numeric_limits<double>::max())
         , simulator_(simulator)
+        , timeStepController_(simulator)
         , defaultVtkWriter_(0)
+        , sampledOutputInterval_(1)
+        , overlappedOutput_(false)
+        , nextOutputSnapshotIdx_(0)
     {
         // calculate the bounding box of the local partition of the grid view
         VertexIterator vIt = gridView_.template begin<dim>();
@@ -139,6 +189,13 @@ public:
             boundingBoxMax_[i] = gridView_.comm().max(boundingBoxMax_[i]);
         }
 
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableTimeSeriesOutput)) {
+            timeSeriesOutput_.reset(
+                new TimeSeriesOutput(simulator_,
+                                     asImp_().outputDir() + "/" + asImp_().name() + "-timeseries.csv"));
+            timeSeriesOutput_->addStorageQuantities();
+        }
+
         if (enableVtkOutput_()) {
             bool asyncVtkOutput =
                 simulator_.gridView().comm().size() == 1 &&
@@ -156,11 +213,41 @@ public:
 
             defaultVtkWriter_ =
                 new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name());
+
+            const std::string& vtkOutputType = EWOMS_GET_PARAM(TypeTag, std::string, VtkOutputType);
+            if (!vtkOutputType.empty())
+                defaultVtkWriter_->setOutputType(VtkMultiWriter::outputTypeFromString(vtkOutputType));
+            if (EWOMS_GET_PARAM(TypeTag, bool, EnableXdmfOutput))
+                defaultVtkWriter_->enableXdmfOutput();
+
+            // the output modules are run by the asynchronous threads of the simulator
+            // which hand the buffers to the thread of the VTK writer afterwards
+            overlappedOutput_ =
+                asyncVtkOutput && EWOMS_GET_PARAM(TypeTag, bool, EnableOverlappedVtkOutput);
+
+            if (EWOMS_GET_PARAM(TypeTag, bool, EnableSampledOutput)) {
+                sampledOutputWriter_.reset(
+                    new SampledOutputWriter(gridView_,
+                                            outputDir,
+                                            asImp_().name(),
+                                            EWOMS_GET_PARAM(TypeTag, unsigned, SampledOutputStride),
+                                            EWOMS_GET_PARAM(TypeTag, std::string, SampledOutputRegion),
+                                            EWOMS_GET_PARAM(TypeTag, std::string, SampledOutputFields)));
+                sampledOutputInterval_ =
+                    std::max(1u, EWOMS_GET_PARAM(TypeTag, unsigned, SampledOutputInterval));
+            }
         }
     }
 
     ~FvBaseProblem()
-    { delete defaultVtkWriter_; }
+    {
+        // make sure that the output thread does not access the VTK writer anymore
+        waitForOutput_();
+        delete defaultVtkWriter_;
+
+        // the in-situ pipeline may still work on the buffers of the output modules
+        inSituOutputWriter_.reset();
+    }
 
     /*!
      * \brief Registers all available parameters for the problem and
@@ -169,6 +256,8 @@ public:
     static void registerParameters()
     {
         Model::registerParameters();
+        TimeStepController::registerParameters();
+        TimeSeriesOutput::registerParameters();
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, MaxTimeStepSize,
                              "The maximum size to which all time steps are limited to [s]");
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, MinTimeStepSize,
@@ -178,6 +267,41 @@ public:
                              "before the simulation bails out");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableAsyncVtkOutput,
                              "Dispatch a separate thread to write the VTK output");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, VtkOutputType,
+                             "The format of the VTK output files. Possible values are "
+                             "'ascii', 'base64', 'appended-raw' and 'appended-base64'. If "
+                             "empty, the compile-time default of the model is used");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableXdmfOutput,
+                             "Write the visualization output of all processes into a single "
+                             "binary file per time step which is indexed by an XDMF file "
+                             "instead of writing VTK files");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableOverlappedVtkOutput,
+                             "Run the VTK output modules on a snapshot of the solution "
+                             "using a separate thread. This requires asynchronous VTK output");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, VtkOutputAtEpisodeEndOnly,
+                             "Only write the full visualization output at the end of "
+                             "episodes and for the initial solution");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableSampledOutput,
+                             "Additionally write a spatially decimated subset of the "
+                             "visualization output which is intended for monitoring");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, SampledOutputInterval,
+                             "The number of time steps between two data sets of the "
+                             "sampled output");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, SampledOutputStride,
+                             "Only every k-th interior element of each process is part "
+                             "of the sampled output");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, SampledOutputRegion,
+                             "A comma separated list of the minimum and maximum "
+                             "coordinates of the bounding box which contains the centers "
+                             "of the sampled elements. If empty, the whole grid is sampled");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, SampledOutputFields,
+                             "A comma separated list of the fields which are part of the "
+                             "sampled output. If empty, all fields are written");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, StaticDataMappingDir,
+                             "The directory in which the spatial parameters of the degrees "
+                             "of freedom are kept in memory-mapped files which the "
+                             "operating system may page out. If empty, they are kept in "
+                             "the main memory");
         EWOMS_REGISTER_PARAM(TypeTag, bool, ContinueOnConvergenceError,
                              "Continue with a non-converged solution instead of giving up "
                              "if we encounter a time step size smaller than the minimum time "
@@ -304,8 +428,17 @@ public:
         elementMapper_.update();
         vertexMapper_.update();
 
-        if (enableVtkOutput_())
+        if (enableVtkOutput_()) {
+            waitForOutput_();
             defaultVtkWriter_->gridChanged();
+            if (sampledOutputWriter_)
+                sampledOutputWriter_->gridChanged();
+        }
+
+        if (inSituOutputWriter_) {
+            waitForOutput_();
+            inSituOutputWriter_->gridChanged();
+        }
     }
 
     /*!
@@ -324,6 +457,26 @@ public:
                   unsigned timeIdx OPM_UNUSED) const
     { throw std::logic_error("Problem does not provide a boundary() method"); }
 
+    /*!
+     * \brief Returns true if the rates of a boundary segment depend on the solution.
+     *
+     * This is called after boundary() for the same segment. If it returns false, the
+     * rates may be cached for the current time step, i.e., they may only depend on
+     * the position and the time. This is only used if the EnableBoundaryCache
+     * parameter is true. By default, all boundary segments are considered to depend on
+     * the solution.
+     *
+     * \param context The object representing the execution context from
+     *                which this method is called.
+     * \param spaceIdx The local index of the spatial entity which represents the boundary segment.
+     * \param timeIdx The index used for the time discretization
+     */
+    template <class Context>
+    bool boundaryDependsOnSolution(const Context& context OPM_UNUSED,
+                                   unsigned spaceIdx OPM_UNUSED,
+                                   unsigned timeIdx OPM_UNUSED) const
+    { return true; }
+
     /*!
      * \brief Evaluate the constraints for a control volume.
      *
@@ -360,6 +513,29 @@ public:
                 unsigned timeIdx OPM_UNUSED) const
     { throw std::logic_error("Problem does not provide a source() method"); }
 
+    /*!
+     * \brief Returns true if the source term of a sub-control volume depends on the
+     *        solution.
+     *
+     * This is called after source() for the same sub-control volume. If it returns
+     * false, the source term may be cached for the current time step, i.e., it may only
+     * depend on the position and the time, and it is not evaluated at all for the
+     * remaining linearizations of the time step if it is zero. This is only used if the
+     * EnableSourceCache parameter is true. By default, all source terms are considered
+     * to depend on the solution.
+     *
+     * \param context The object representing the execution context from
+     *                which this method is called.
+     * \param spaceIdx The local index of the spatial entity which represents
+     *                 the sub-control volume.
+     * \param timeIdx The index used for the time discretization
+     */
+    template <class Context>
+    bool sourceDependsOnSolution(const Context& context OPM_UNUSED,
+                                 unsigned spaceIdx OPM_UNUSED,
+                                 unsigned timeIdx OPM_UNUSED) const
+    { return true; }
+
     /*!
      * \brief Evaluate the initial value for a control volume.
      *
@@ -471,14 +647,27 @@ public:
         Scalar updateTime = simulator().updateTimer().realTimeElapsed();
         unsigned numProcesses = static_cast<unsigned>(this->gridView().comm().size());
         unsigned threadsPerProcess = ThreadManager::maxThreads();
+        unsigned numNewtonIterations = simulator().numNewtonIterations();
+
+        // count each degree of freedom only on the process which owns it
+        size_t numDof = 0;
+        for (unsigned dofIdx = 0; dofIdx < model().numGridDof(); ++dofIdx)
+            if (model().isLocalDof(dofIdx))
+                ++ numDof;
+        numDof = this->gridView().comm().sum(numDof);
+
         if (gridView().comm().rank() == 0) {
             std::cout << std::setprecision(3)
                       << "Simulation of problem '" << asImp_().name() << "' finished.\n"
                       << "\n"
                       << "------------------------ Timing receipt ------------------------\n"
                       << "Setup time: " << setupTime << " seconds" << Simulator::humanReadableTime(setupTime)
-                      << ", " << setupTime/(executionTime + setupTime)*100 << "%\n"
-                      << "Simulation time: " << executionTime << " seconds" << Simulator::humanReadableTime(executionTime)
+                      << ", " << setupTime/(executionTime + setupTime)*100 << "%\n";
+            for (const auto& phase : simulator().setupPhaseTimes())
+                std::cout << "    " << phase.first << " time: " << phase.second << " seconds"
+                          << Simulator::humanReadableTime(phase.second)
+                          << ", " << phase.second/setupTime*100 << "%\n";
+            std::cout << "Simulation time: " << executionTime << " seconds" << Simulator::humanReadableTime(executionTime)
                       << ", " << executionTime/(executionTime + setupTime)*100 << "%\n"
                       << "    Linearization time: " << linearizeTime << " seconds" << Simulator::humanReadableTime(linearizeTime)
                       << ", " << linearizeTime/executionTime*100 << "%\n"
@@ -493,7 +682,17 @@ public:
                       << "First process' simulation CPU time: "  << localCpuTime << " seconds" <<  Simulator::humanReadableTime(localCpuTime) << "\n"
                       << "Number of processes: " << numProcesses << "\n"
                       << "Threads per processes: " << threadsPerProcess << "\n"
-                      << "Total CPU time: " << globalCpuTime << " seconds" << Simulator::humanReadableTime(globalCpuTime) << "\n"
+                      << "Number of degrees of freedom: " << numDof << "\n"
+                      << "Number of time steps: " << simulator().timeStepIndex() << "\n"
+                      << "Number of Newton iterations: " << numNewtonIterations << "\n"
+                      << "Throughput: " << numDof*numNewtonIterations/executionTime << " DOF iterations per second, "
+                      << numNewtonIterations/executionTime << " Newton iterations per second\n";
+            std::cout << "First process' peak memory: " << peakMemory_()/(1024.0*1024.0) << " MB\n";
+            size_t stencilCacheMemory = model().stencilCacheMemory();
+            if (stencilCacheMemory > 0)
+                std::cout << "First process' stencil cache memory: "
+                          << stencilCacheMemory/(1024.0*1024.0) << " MB\n";
+            std::cout << "Total CPU time: " << globalCpuTime << " seconds" << Simulator::humanReadableTime(globalCpuTime) << "\n"
                       << "\n"
                       << "Note 1: If not stated otherwise, all times are wall clock times\n"
                       << "Note 2: Taxes and administrative overhead are "
@@ -596,7 +795,7 @@ public:
             return nextTimeStepSize_;
 
         Scalar dtNext = std::min(EWOMS_GET_PARAM(TypeTag, Scalar, MaxTimeStepSize),
-                                 newtonMethod().suggestTimeStepSize(simulator().timeStepSize()));
+                                 timeStepController_.suggestTimeStepSize(simulator().timeStepSize()));
 
         if (dtNext < simulator().maxTimeStepSize()
             && simulator().maxTimeStepSize() < dtNext*2)
@@ -638,7 +837,10 @@ public:
      *        model should be prepared to do the next time integration.
      */
     void advanceTimeLevel()
-    { model().advanceTimeLevel(); }
+    {
+        timeStepController_.timeStepAccepted();
+        model().advanceTimeLevel();
+    }
 
     /*!
      * \brief The problem name.
@@ -717,6 +919,18 @@ public:
      */
     const NewtonMethod& newtonMethod() const
     { return model().newtonMethod(); }
+
+    /*!
+     * \brief Returns the object which determines the size of the next time step.
+     */
+    TimeStepController& timeStepController()
+    { return timeStepController_; }
+
+    /*!
+     * \brief Returns the object which determines the size of the next time step.
+     */
+    const TimeStepController& timeStepController() const
+    { return timeStepController_; }
     // \}
 
     /*!
@@ -756,8 +970,12 @@ public:
     template <class Restarter>
     void serialize(Restarter& res)
     {
-        if (enableVtkOutput_())
+        if (enableVtkOutput_()) {
+            waitForOutput_();
             defaultVtkWriter_->serialize(res);
+            if (sampledOutputWriter_)
+                sampledOutputWriter_->serialize(res);
+        }
     }
 
     /*!
@@ -773,33 +991,87 @@ public:
     template <class Restarter>
     void deserialize(Restarter& res)
     {
-        if (enableVtkOutput_())
+        if (enableVtkOutput_()) {
+            waitForOutput_();
             defaultVtkWriter_->deserialize(res);
+            if (sampledOutputWriter_)
+                sampledOutputWriter_->deserialize(res);
+        }
     }
 
     /*!
      * \brief Write the relevant secondary variables of the current
      *        solution into an VTK output file.
      *
+     * Depending on the parameters, the full output is only written at the end of
+     * episodes and the sampled output is only written for some time steps.
+     *
      * \param verbose Specify if a message should be printed whenever a file is written
      */
     void writeOutput(bool verbose = true)
     {
-        if (!enableVtkOutput_())
+        // calculate the time _after_ the time was updated
+        Scalar t = simulator().time() + simulator().timeStepSize();
+
+        if (timeSeriesOutput_) {
+            timeSeriesOutput_->update(t);
+            timeSeriesOutput_->write();
+        }
+
+        // the initial solution is written with a time step index of -1
+        int timeStepIdx = simulator().timeStepIndex();
+        bool writeFull =
+            enableVtkOutput_()
+            && (timeStepIdx < 0
+                || !EWOMS_GET_PARAM(TypeTag, bool, VtkOutputAtEpisodeEndOnly)
+                || simulator().episodeWillBeOver());
+        bool writeSampled =
+            sampledOutputWriter_
+            && static_cast<unsigned>(timeStepIdx + 1) % sampledOutputInterval_ == 0;
+        bool writeInSitu = static_cast<bool>(inSituOutputWriter_);
+        if (!writeFull && !writeSampled && !writeInSitu)
             return;
 
-        if (verbose && gridView().comm().rank() == 0)
+        if (verbose && writeFull && gridView().comm().rank() == 0)
             std::cout << "Writing visualization results for the current time step.\n"
                       << std::flush;
 
-        // calculate the time _after_ the time was updated
-        Scalar t = simulator().time() + simulator().timeStepSize();
+        if (overlappedOutput_) {
+            // copy the solution to the snapshot which is not used by the output of the
+            // previous time step and let the output thread do the rest of the work
+            unsigned snapshotIdx = nextOutputSnapshotIdx_;
+            nextOutputSnapshotIdx_ = 1 - snapshotIdx;
+            if (outputTasklets_[snapshotIdx])
+                outputTasklets_[snapshotIdx]->waitUntilFinished();
+
+            outputSnapshots_[snapshotIdx] = model().solution(/*timeIdx=*/0);
+
+            // the output of the time steps must be written in order
+            auto tasklet = std::make_shared<OutputTasklet>(*this, snapshotIdx, t,
+                                                           writeFull, writeSampled,
+                                                           writeInSitu);
+            tasklet->addDependency(outputTasklets_[1 - snapshotIdx]);
+            tasklet->setPriority(TaskletInterface::Priority::Low);
+            outputTasklets_[snapshotIdx] = tasklet;
+            simulator_.taskletRunner().dispatch(tasklet);
+            return;
+        }
 
-        defaultVtkWriter_->beginWrite(t);
-        model().prepareOutputFields();
-        model().appendOutputFields(*defaultVtkWriter_);
-        defaultVtkWriter_->endWrite();
+        writeOutputFields_(/*solutionSnapshot=*/nullptr, t, writeFull, writeSampled, writeInSitu);
+    }
 
+    /*!
+     * \brief Hand the visualization output of all subsequent time steps to an in-situ
+     *        pipeline, e.g. for monitoring the simulation without writing files.
+     *
+     * The pipeline is called for every time step by a separate thread and it receives
+     * the buffers of the output modules without copying them. This works independently
+     * of the VTK output, which may thus be disabled. \see InSituOutputWriter
+     */
+    void setInSituPipeline(typename InSituOutputWriter::Pipeline pipeline)
+    {
+        waitForOutput_();
+        inSituOutputWriter_.reset(new InSituOutputWriter(gridView_, std::move(pipeline)));
     }
 
     /*!
@@ -809,6 +1081,15 @@ public:
     VtkMultiWriter& defaultVtkWriter() const
     { return defaultVtkWriter_; }
 
+    /*!
+     * \brief Returns the time series of reduced quantities or nullptr if it is disabled.
+     *
+     * Problems can use this to add quantities and regions to the time series after
+     * the problem has been constructed.
+     */
+    TimeSeriesOutput* timeSeriesOutput()
+    { return timeSeriesOutput_.get(); }
+
 protected:
     Scalar nextTimeStepSize_;
 
@@ -816,6 +1097,19 @@ private:
     bool enableVtkOutput_() const
     { return EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput); }
 
+    // the maximum resident set size of the process in bytes
+    static double peakMemory_()
+    {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0.0;
+#ifdef __APPLE__
+        return static_cast<double>(usage.ru_maxrss);
+#else
+        return 1024.0*static_cast<double>(usage.ru_maxrss);
+#endif
+    }
+
     //! Returns the implementation of the problem (i.e. static polymorphism)
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -824,6 +1118,47 @@ private:
     const Implementation& asImp_() const
     { return *static_cast<const Implementation *>(this); }
 
+    // wait until the output thread has processed all solution snapshots
+    void waitForOutput_()
+    {
+        for (auto& tasklet : outputTasklets_) {
+            if (tasklet)
+                tasklet->waitUntilFinished();
+            tasklet.reset();
+        }
+    }
+
+    // run the output modules and hand their results to the writers of the requested
+    // outputs. this is called by the output thread if the output is overlapped
+    void writeOutputFields_(const SolutionVector* solutionSnapshot,
+                            Scalar t,
+                            bool writeFull,
+                            bool writeSampled,
+                            bool writeInSitu)
+    {
+        if (writeFull)
+            defaultVtkWriter_->beginWrite(t);
+        if (writeSampled)
+            sampledOutputWriter_->beginWrite(t);
+        if (writeInSitu)
+            inSituOutputWriter_->beginWrite(t);
+
+        model().prepareOutputFields(solutionSnapshot);
+
+        if (writeFull) {
+            model().appendOutputFields(*defaultVtkWriter_);
+            defaultVtkWriter_->endWrite();
+        }
+        if (writeSampled) {
+            model().appendOutputFields(*sampledOutputWriter_);
+            sampledOutputWriter_->endWrite();
+        }
+        if (writeInSitu) {
+            model().appendOutputFields(*inSituOutputWriter_);
+            inSituOutputWriter_->endWrite();
+        }
+    }
+
     // Grid management stuff
     const GridView gridView_;
     ElementMapper elementMapper_;
@@ -833,7 +1168,22 @@ private:
 
     // Attributes required for the actual simulation
     Simulator& simulator_;
+    TimeStepController timeStepController_;
     mutable VtkMultiWriter *defaultVtkWriter_;
+
+    // the time series of reduced quantities and the decimated output for monitoring
+    // the simulation
+    std::unique_ptr<TimeSeriesOutput> timeSeriesOutput_;
+    std::unique_ptr<SampledOutputWriter> sampledOutputWriter_;
+    unsigned sampledOutputInterval_;
+    std::unique_ptr<InSituOutputWriter> inSituOutputWriter_;
+
+    // if the output is overlapped with the simulation, the output modules are run by
+    // tasklets which alternately work on two solution snapshots
+    bool overlappedOutput_;
+    std::shared_ptr<TaskletInterface> outputTasklets_[2];
+    SolutionVector outputSnapshots_[2];
+    unsigned nextOutputSnapshotIdx_;
 };
 
 } // namespace Opm
@@ -189,6 +189,32 @@ struct ThreadManager { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct ThreadsPerProcess { using type = UndefinedProperty; };
 
+//! The number of threads of a process which are dedicated to asynchronous work
+template<class TypeTag, class MyTypeTag>
+struct AsyncThreadsPerProcess { using type = UndefinedProperty; };
+
+//! Bind the threads of a process to individual CPUs
+template<class TypeTag, class MyTypeTag>
+struct PinThreads { using type = UndefinedProperty; };
+
+//! The CPUs to which the threads for asynchronous work are bound
+template<class TypeTag, class MyTypeTag>
+struct AsyncThreadCpus { using type = UndefinedProperty; };
+
+//! The number of threads and the schedules of individual parallel phases, see
+//! Opm::ThreadPhases
+template<class TypeTag, class MyTypeTag>
+struct ThreadPhaseSettings { using type = UndefinedProperty; };
+
+//! Determine the number of threads and the schedules of the parallel phases which are
+//! not configured explicitly by measuring their first executions
+template<class TypeTag, class MyTypeTag>
+struct AutoTuneThreadPhases { using type = UndefinedProperty; };
+
+//! Dedicate a thread of each process to the communication with the peer processes
+template<class TypeTag, class MyTypeTag>
+struct EnableCommunicationThread { using type = UndefinedProperty; };
+
 //! use locking to prevent race conditions when linearizing the global system of
 //! equations in multi-threaded mode. (setting this property to true is always save, but
 //! it may slightly deter performance in multi-threaded simlations and some
@@ -196,6 +222,87 @@ struct ThreadsPerProcess { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct UseLinearizationLock { using type = UndefinedProperty; };
 
+//! assemble the global system of equations color by color in multi-threaded mode. The
+//! elements of a color do not share any degree of freedom in their stencils, so their
+//! contributions can be scattered into the global Jacobian without any locking.
+template<class TypeTag, class MyTypeTag>
+struct UseLinearizationColoring { using type = UndefinedProperty; };
+
+//! The number of consecutive elements which a thread grabs at once in multi-threaded
+//! loops over the grid
+template<class TypeTag, class MyTypeTag>
+struct ThreadedElementChunkSize { using type = UndefinedProperty; };
+
+//! Only relinearize the elements whose stencil contains a degree of freedom that
+//! changed since the last Newton iteration and reuse the cached local linearization of
+//! all other elements
+template<class TypeTag, class MyTypeTag>
+struct EnablePartialRelinearization { using type = UndefinedProperty; };
+
+//! The maximum amount of memory in megabytes which may be used to keep the stencils of
+//! the grid elements between linearizations (0 disables the stencil cache)
+template<class TypeTag, class MyTypeTag>
+struct StencilCacheMaxMemory { using type = UndefinedProperty; };
+
+//! Gather the primary variables of the stencils of all elements into a contiguous array
+//! before the domain is linearized
+template<class TypeTag, class MyTypeTag>
+struct EnablePackedElementSolution { using type = UndefinedProperty; };
+
+//! Construct the cached quantities of the degrees of freedom in the threads which
+//! later work on them and statically assign the elements to the threads of the loops
+//! over the grid, so that they mostly access memory of their own NUMA node
+template<class TypeTag, class MyTypeTag>
+struct EnableNumaFirstTouch { using type = UndefinedProperty; };
+
+//! Keep the intensive quantities of the previous time level valid for the current one if
+//! a time step is retried with a smaller step size instead of recalculating all of them
+template<class TypeTag, class MyTypeTag>
+struct EnableWarmTimeStepRetry { using type = UndefinedProperty; };
+
+//! The order of the polynomial which extrapolates the solutions of the last time steps to
+//! obtain the initial guess of the Newton method (0: use the solution of the last time step)
+template<class TypeTag, class MyTypeTag>
+struct SolutionExtrapolationOrder { using type = UndefinedProperty; };
+
+//! The class which determines the size of the next time step
+template<class TypeTag, class MyTypeTag>
+struct TimeStepController { using type = UndefinedProperty; };
+
+//! The strategy of the default time step controller
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControl { using type = UndefinedProperty; };
+
+//! The targeted maximum relative change of the primary variables over a time step for
+//! the PID time step control
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControlTolerance { using type = UndefinedProperty; };
+
+//! Traverse the elements along a Hilbert space-filling curve instead of using the order
+//! of the grid in the multi-threaded loops over the grid
+template<class TypeTag, class MyTypeTag>
+struct EnableHilbertElementOrder { using type = UndefinedProperty; };
+
+//! The number of elements by which the linearizer prefetches the data required to
+//! linearize an element ahead of time (0 disables prefetching)
+template<class TypeTag, class MyTypeTag>
+struct LinearizationPrefetchDistance { using type = UndefinedProperty; };
+
+//! Only linearize the interior elements of each process and send the Jacobian entries
+//! of the process boundary faces to the processes which own the neighboring elements
+template<class TypeTag, class MyTypeTag>
+struct EnableOwnerComputesLinearization { using type = UndefinedProperty; };
+
+//! The change of the primary variables of a degree of freedom below which it is not
+//! considered to have changed by the partial relinearization
+template<class TypeTag, class MyTypeTag>
+struct PartialRelinearizationTolerance { using type = UndefinedProperty; };
+
+//! Keep the volumetric fluxes of the faces of the most recent linearization so that
+//! the output of velocities does not need to compute them again
+template<class TypeTag, class MyTypeTag>
+struct RetainLinearizationFluxes { using type = UndefinedProperty; };
+
 // high-level simulation control
 
 /*!
@@ -207,6 +314,15 @@ struct UseLinearizationLock { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableGridAdaptation { using type = UndefinedProperty; };
 
+/*!
+ * \brief The largest acceptable ratio of the number of elements of the most loaded
+ *        process and the average number of elements per process after adapting the grid.
+ *
+ * If the ratio is exceeded, the grid is redistributed.
+ */
+template<class TypeTag, class MyTypeTag>
+struct GridAdaptationMaxLoadImbalance { using type = UndefinedProperty; };
+
 /*!
  * \brief The directory to which simulation output ought to be written to.
  */
@@ -234,6 +350,18 @@ struct EnableVtkOutput { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableAsyncVtkOutput { using type = UndefinedProperty; };
 
+/*!
+ * \brief Prepare the VTK output of a time step on a separate thread
+ *
+ * I.e., the solution is copied and the output modules process the copy while the
+ * simulation already continues with the next time step. This has only an effect if the
+ * VTK output is written asynchronously. Since the output modules then run
+ * concurrently to the simulation, they must not depend on quantities which are
+ * modified by it.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableOverlappedVtkOutput { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify the format the VTK output is written to disk
  *
@@ -246,6 +374,83 @@ struct EnableAsyncVtkOutput { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct VtkOutputFormat { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specify the format of the VTK output at runtime
+ *
+ * Possible values are "ascii", "base64", "appended-raw" and "appended-base64". If the
+ * value is empty, the format specified by the VtkOutputFormat property is used.
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkOutputType { using type = UndefinedProperty; };
+
+/*!
+ * \brief Write the visualization output of all processes into a single binary file per
+ *        time step which is described by an XDMF file instead of writing VTK files.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableXdmfOutput { using type = UndefinedProperty; };
+
+/*!
+ * \brief Only write the full visualization output at the end of episodes
+ *
+ * This is useful in conjunction with the sampled output if frequent monitoring, but
+ * only rare complete snapshots of the solution are required.
+ */
+template<class TypeTag, class MyTypeTag>
+struct VtkOutputAtEpisodeEndOnly { using type = UndefinedProperty; };
+
+/*!
+ * \brief Write a spatially decimated subset of the visualization output
+ *
+ * The sampled output is written independently of the full visualization output as a
+ * cloud of points located at the centers of the sampled elements. It requires
+ * EnableVtkOutput to be true.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableSampledOutput { using type = UndefinedProperty; };
+
+//! The number of time steps between two data sets of the sampled output
+template<class TypeTag, class MyTypeTag>
+struct SampledOutputInterval { using type = UndefinedProperty; };
+
+//! Only every k-th interior element of each process is part of the sampled output
+template<class TypeTag, class MyTypeTag>
+struct SampledOutputStride { using type = UndefinedProperty; };
+
+/*!
+ * \brief The bounding box which must contain the centers of the sampled elements
+ *
+ * This is a comma separated list of the minimum coordinates followed by the maximum
+ * coordinates. If it is empty, the whole grid is sampled.
+ */
+template<class TypeTag, class MyTypeTag>
+struct SampledOutputRegion { using type = UndefinedProperty; };
+
+//! A comma separated list of the fields which are part of the sampled output. If empty,
+//! all fields are written.
+template<class TypeTag, class MyTypeTag>
+struct SampledOutputFields { using type = UndefinedProperty; };
+
+/*!
+ * \brief Write the integrals of the storage terms and of further quantities over the
+ *        regions of the grid to a time series file
+ *
+ * \see Opm::TimeSeriesOutput
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableTimeSeriesOutput { using type = UndefinedProperty; };
+
+/*!
+ * \brief The directory in which the spatial parameters of the degrees of freedom are kept
+ *        in memory-mapped files.
+ *
+ * If empty, they are kept in the main memory.
+ *
+ * \see Opm::FvBaseDofParameterArray
+ */
+template<class TypeTag, class MyTypeTag>
+struct StaticDataMappingDir { using type = UndefinedProperty; };
+
 //! Specify whether the some degrees of fredom can be constraint
 template<class TypeTag, class MyTypeTag>
 struct EnableConstraints { using type = UndefinedProperty; };
@@ -293,6 +498,31 @@ struct ContinueOnConvergenceError { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableIntensiveQuantityCache { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specify whether the most important intensive quantities of the cache should
+ *        additionally be stored in a structure-of-arrays layout.
+ *
+ * If enabled, the pressures, saturations, densities and mobilities of all fluid phases
+ * are available as contiguous arrays via the intensiveQuantityArrays() method of the
+ * model. This requires the intensive quantity cache to be enabled at runtime and the
+ * intensive quantities to provide the fluidState() and mobility() methods.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableIntensiveQuantityArrays { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specify whether the intensive quantity cache should only store the values of
+ *        the intensive quantities.
+ *
+ * The cached objects are computed without derivatives and are stored in a compact
+ * form, which reduces the memory required by the cache considerably if automatic
+ * differentiation is used. In turn, the intensive quantities of the primary degrees of
+ * freedom need to be recomputed when linearizing, and the cache cannot be accessed
+ * using pointers, i.e., it does not provide thermodynamic hints.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableValueOnlyIntensiveQuantityCache { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify whether the storage terms for previous solutions should be cached.
  *
@@ -302,6 +532,36 @@ struct EnableIntensiveQuantityCache { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableStorageCache { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specify how the solution of the previous time level is kept once its storage
+ *        terms have been cached.
+ *
+ * Possible values are "none", "float" (lossy) and "delta" (lossless). This only has an
+ * effect if the storage cache is enabled.
+ */
+template<class TypeTag, class MyTypeTag>
+struct PreviousSolutionCompression { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specify whether the boundary rates which do not depend on the solution should
+ *        be cached for each time step.
+ *
+ * Which boundary segments this applies to is decided by the
+ * boundaryDependsOnSolution() method of the problem.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableBoundaryCache { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specify whether the source terms which do not depend on the solution should
+ *        be cached for each time step.
+ *
+ * Which sub-control volumes this applies to is decided by the
+ * sourceDependsOnSolution() method of the problem.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableSourceCache { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify whether to use the already calculated solutions as
  *        starting values of the intensive quantities.
@@ -0,0 +1,144 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseSourceCache
+ */
+#ifndef EWOMS_FV_BASE_SOURCE_CACHE_HH
+#define EWOMS_FV_BASE_SOURCE_CACHE_HH
+
+#include "fvbaseproperties.hh"
+
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <dune/common/fvector.hh>
+
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Stores the source terms of the sub-control volumes of all elements which do
+ *        not depend on the solution.
+ *
+ * The entries are indexed by the index of the element and the local index of the
+ * sub-control volume. Only the values of the source terms are stored because sources
+ * which do not depend on the solution do not exhibit any derivatives. Besides this,
+ * the cache records whether a source term is zero, so that the local residual can skip
+ * these sub-control volumes altogether. All entries become invalid if invalidate() is
+ * called, which the discretization does at the beginning of each attempt to compute a
+ * time step.
+ *
+ * The entries of different elements may be accessed concurrently.
+ */
+template <class TypeTag>
+class FvBaseSourceCache
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+    struct Entry
+    {
+        Dune::FieldVector<Scalar, numEq> values;
+        unsigned epoch = 0;
+        bool isZero = false;
+    };
+
+public:
+    /*!
+     * \brief Set the number of elements for which source terms are stored.
+     */
+    void resize(size_t numElements)
+    {
+        if (entries_.size() != numElements)
+            entries_.resize(numElements);
+    }
+
+    /*!
+     * \brief Mark all entries as invalid.
+     */
+    void invalidate()
+    { ++ epoch_; }
+
+    /*!
+     * \brief Retrieve the source term of a sub-control volume.
+     *
+     * If the source term is zero, isZero is set to true and the values are not
+     * touched.
+     *
+     * \return false if no valid source term is stored for the sub-control volume
+     */
+    template <class RateVector>
+    bool load(RateVector& values, bool& isZero, unsigned elemIdx, unsigned dofIdx) const
+    {
+        if (elemIdx >= entries_.size())
+            return false;
+
+        const auto& elemEntries = entries_[elemIdx];
+        if (dofIdx >= elemEntries.size() || elemEntries[dofIdx].epoch != epoch_)
+            return false;
+
+        const auto& entry = elemEntries[dofIdx];
+        isZero = entry.isZero;
+        if (!isZero)
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                values[eqIdx] = entry.values[eqIdx];
+        return true;
+    }
+
+    /*!
+     * \brief Store the source term of a sub-control volume.
+     */
+    template <class RateVector>
+    void store(const RateVector& values, unsigned elemIdx, unsigned dofIdx)
+    {
+        using Toolbox = MathToolbox<typename RateVector::field_type>;
+
+        if (elemIdx >= entries_.size())
+            return; // the cache has not been sized for the grid yet
+
+        auto& elemEntries = entries_[elemIdx];
+        if (dofIdx >= elemEntries.size())
+            elemEntries.resize(dofIdx + 1);
+
+        auto& entry = elemEntries[dofIdx];
+        entry.isZero = true;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            entry.values[eqIdx] = Toolbox::value(values[eqIdx]);
+            entry.isZero = entry.isZero && entry.values[eqIdx] == 0.0;
+        }
+        entry.epoch = epoch_;
+    }
+
+private:
+    std::vector<std::vector<Entry> > entries_;
+    unsigned epoch_ = 1;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,208 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseTimeStepController
+ */
+#ifndef EWOMS_FV_BASE_TIME_STEP_CONTROLLER_HH
+#define EWOMS_FV_BASE_TIME_STEP_CONTROLLER_HH
+
+#include "fvbaseproperties.hh"
+
+#include <opm/models/utils/parametersystem.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace Opm {
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Determines the size of the next time step.
+ *
+ * The strategy is selected by the TimeStepControl parameter:
+ *
+ * - "iteration-count": Scale the last time step size depending on how much the number
+ *   of Newton iterations deviates from the targeted one, see
+ *   NewtonMethod::suggestTimeStepSize(). This is the default.
+ * - "pid": Control the maximum relative change of the primary variables over a time
+ *   step using the PID controller of Gustafsson and Söderlind. The change of the
+ *   primary variables is scaled by their magnitude if it exceeds one.
+ * - "pid+iteration-count": Use the smaller one of the time step sizes proposed by the
+ *   two strategies above.
+ *
+ * Different strategies can be plugged in using the TimeStepController property.
+ */
+template <class TypeTag>
+class FvBaseTimeStepController
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+
+    enum ControlType {
+        iterationCountControl,
+        pidControl,
+        pidIterationCountControl
+    };
+
+public:
+    FvBaseTimeStepController(Simulator& simulator)
+        : simulator_(simulator)
+    {
+        const std::string control = EWOMS_GET_PARAM(TypeTag, std::string, TimeStepControl);
+        if (control == "iteration-count")
+            controlType_ = iterationCountControl;
+        else if (control == "pid")
+            controlType_ = pidControl;
+        else if (control == "pid+iteration-count")
+            controlType_ = pidIterationCountControl;
+        else
+            throw std::invalid_argument("Unknown time step control '"+control+"'. Possible "
+                                        "values are 'iteration-count', 'pid' and "
+                                        "'pid+iteration-count'");
+
+        tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlTolerance);
+        if (!(tolerance_ > 0.0))
+            throw std::invalid_argument("The tolerance of the time step control must be "
+                                        "positive");
+
+        // the controller starts out as if the change of the solution was exactly the
+        // targeted one for the previous time steps
+        for (unsigned i = 0; i < numErrors; ++i)
+            errors_[i] = tolerance_;
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the time step controller.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, TimeStepControl,
+                             "The strategy used to determine the size of the next time "
+                             "step. Possible values are 'iteration-count', 'pid' and "
+                             "'pid+iteration-count'");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlTolerance,
+                             "The targeted maximum relative change of the primary "
+                             "variables over a time step if the PID time step control "
+                             "is used");
+    }
+
+    /*!
+     * \brief Called after a time step has been accepted.
+     *
+     * This happens before the model advances its time level, i.e., the solution of the
+     * previous time step is still available.
+     */
+    void timeStepAccepted()
+    {
+        if (controlType_ == iterationCountControl)
+            return;
+
+        for (unsigned i = 0; i < numErrors - 1; ++i)
+            errors_[i] = errors_[i + 1];
+        errors_[numErrors - 1] = relativeSolutionChange_();
+    }
+
+    /*!
+     * \brief Returns the size of the next time step.
+     *
+     * \param dt The size of the last time step
+     */
+    Scalar suggestTimeStepSize(Scalar dt) const
+    {
+        if (controlType_ == iterationCountControl)
+            return simulator_.model().newtonMethod().suggestTimeStepSize(dt);
+        else if (controlType_ == pidControl)
+            return pidTimeStepSize_(dt);
+
+        return std::min(simulator_.model().newtonMethod().suggestTimeStepSize(dt),
+                        pidTimeStepSize_(dt));
+    }
+
+protected:
+    // the number of time steps for which the error is kept
+    static constexpr unsigned numErrors = 3;
+
+    Scalar pidTimeStepSize_(Scalar dt) const
+    {
+        // the errors of the last three time steps. the current one is bounded from below
+        // to limit the growth of the time step size if the solution does hardly change
+        Scalar e0 = errors_[0];
+        Scalar e1 = errors_[1];
+        Scalar e2 = std::max(errors_[2], 1e-3*tolerance_);
+
+        // if the change of the solution was too large, only the integral part is used
+        if (e2 > tolerance_)
+            return std::max(simulator_.problem().minTimeStepSize(), dt*tolerance_/e2);
+
+        // the gains have been determined by numerical experiments
+        const Scalar kP = 0.075;
+        const Scalar kI = 0.175;
+        const Scalar kD = 0.01;
+        e0 = std::max(e0, 1e-3*tolerance_);
+        e1 = std::max(e1, 1e-3*tolerance_);
+        Scalar factor =
+            std::pow(e1/e2, kP)
+            * std::pow(tolerance_/e2, kI)
+            * std::pow(e1*e1/(e0*e2), kD);
+
+        return std::max(simulator_.problem().minTimeStepSize(), dt*factor);
+    }
+
+    // the maximum change of the primary variables between the two time levels. changes
+    // of primary variables larger than one in magnitude are taken relative to them.
+    Scalar relativeSolutionChange_() const
+    {
+        const auto& model = simulator_.model();
+        const auto& curSolution = model.solution(/*timeIdx=*/0);
+        const auto& prevSolution = model.solution(/*timeIdx=*/1);
+
+        Scalar result = 0.0;
+        for (unsigned dofIdx = 0; dofIdx < curSolution.size(); ++dofIdx) {
+            if (!model.isLocalDof(dofIdx))
+                continue;
+
+            const auto& priVars = curSolution[dofIdx];
+            const auto& prevPriVars = prevSolution[dofIdx];
+            for (unsigned pvIdx = 0; pvIdx < priVars.size(); ++pvIdx) {
+                Scalar delta = std::abs(priVars[pvIdx] - prevPriVars[pvIdx]);
+                Scalar scale = std::max<Scalar>(1.0, std::abs(prevPriVars[pvIdx]));
+                result = std::max(result, delta/scale);
+            }
+        }
+
+        return simulator_.gridView().comm().max(result);
+    }
+
+    Simulator& simulator_;
+    ControlType controlType_;
+    Scalar tolerance_;
+    Scalar errors_[numErrors];
+};
+
+} // namespace Opm
+
+#endif
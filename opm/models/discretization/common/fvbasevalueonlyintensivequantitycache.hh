@@ -0,0 +1,177 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseValueOnlyIntensiveQuantityCache
+ */
+#ifndef EWOMS_FV_BASE_VALUE_ONLY_INTENSIVE_QUANTITY_CACHE_HH
+#define EWOMS_FV_BASE_VALUE_ONLY_INTENSIVE_QUANTITY_CACHE_HH
+
+#include "fvbaseproperties.hh"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Stores intensive quantities objects of all degrees of freedom whose
+ *        evaluations only carry values in a compact form.
+ *
+ * If the intensive quantities are computed without seeding the derivatives of the
+ * primary variables, all derivatives of their evaluations are zero. Since these make
+ * up most of the memory of the objects if automatic differentiation is used, the
+ * objects are stored as a bit mask which states which of their machine words are
+ * non-zero followed by the non-zero words only. Storing objects which exhibit
+ * non-zero derivatives is possible, but does not save any memory.
+ *
+ * This requires the intensive quantities to be trivially copyable, see supported().
+ */
+template <class TypeTag>
+class FvBaseValueOnlyIntensiveQuantityCache
+{
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+
+    using Word = std::uint64_t;
+    static constexpr size_t numWords = (sizeof(IntensiveQuantities) + sizeof(Word) - 1)/sizeof(Word);
+    static constexpr size_t numMaskWords = (numWords + 63)/64;
+
+public:
+    /*!
+     * \brief Returns true if the intensive quantities of the model can be stored.
+     */
+    static constexpr bool supported()
+    { return std::is_trivially_copyable<IntensiveQuantities>::value; }
+
+    /*!
+     * \brief Set the number of degrees of freedom for which objects are stored.
+     *
+     * The entries of new degrees of freedom are empty.
+     */
+    void resize(size_t numDof)
+    { entries_.resize(numDof); }
+
+    /*!
+     * \brief Returns the number of degrees of freedom for which objects are stored.
+     */
+    size_t size() const
+    { return entries_.size(); }
+
+    /*!
+     * \brief Store the intensive quantities of a degree of freedom.
+     *
+     * Different degrees of freedom may be stored concurrently.
+     */
+    void store(unsigned globalIdx, const IntensiveQuantities& intQuants)
+    {
+        std::array<Word, numWords> words;
+        words[numWords - 1] = 0;
+        std::memcpy(static_cast<void*>(words.data()),
+                    static_cast<const void*>(&intQuants),
+                    sizeof(IntensiveQuantities));
+
+        std::array<Word, numMaskWords> mask;
+        mask.fill(0);
+        size_t numNonZero = 0;
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx) {
+            if (words[wordIdx] != 0) {
+                mask[wordIdx/64] |= Word(1) << (wordIdx%64);
+                ++numNonZero;
+            }
+        }
+
+        // the capacity of the entry is retained, so storing an object of the same
+        // degree of freedom again usually does not allocate any memory
+        auto& entry = entries_[globalIdx];
+        entry.resize(numMaskWords + numNonZero);
+        std::copy(mask.begin(), mask.end(), entry.begin());
+        size_t nonZeroIdx = numMaskWords;
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+            if (words[wordIdx] != 0)
+                entry[nonZeroIdx++] = words[wordIdx];
+    }
+
+    /*!
+     * \brief Retrieve the intensive quantities of a degree of freedom.
+     *
+     * The entry must have been stored before.
+     */
+    void load(unsigned globalIdx, IntensiveQuantities& intQuants) const
+    {
+        const auto& entry = entries_[globalIdx];
+        assert(entry.size() >= numMaskWords);
+
+        std::array<Word, numWords> words;
+        words.fill(0);
+        size_t nonZeroIdx = numMaskWords;
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+            if (entry[wordIdx/64] & (Word(1) << (wordIdx%64)))
+                words[wordIdx] = entry[nonZeroIdx++];
+
+        std::memcpy(static_cast<void*>(&intQuants),
+                    static_cast<const void*>(words.data()),
+                    sizeof(IntensiveQuantities));
+    }
+
+    /*!
+     * \brief Copy the entry of a degree of freedom from another cache.
+     */
+    void assignEntry(unsigned globalIdx, const FvBaseValueOnlyIntensiveQuantityCache& other)
+    { entries_[globalIdx] = other.entries_[globalIdx]; }
+
+    /*!
+     * \brief Copy the entry of a degree of freedom with a different index from another
+     *        cache, e.g., the one of the grid before it was adapted.
+     */
+    void assignEntry(unsigned globalIdx,
+                     const FvBaseValueOnlyIntensiveQuantityCache& other,
+                     unsigned otherGlobalIdx)
+    { entries_[globalIdx] = other.entries_[otherGlobalIdx]; }
+
+    /*!
+     * \brief Returns the number of bytes which are used by the stored objects.
+     */
+    size_t memoryUsage() const
+    {
+        size_t result = entries_.capacity()*sizeof(Entry);
+        for (const auto& entry : entries_)
+            result += entry.capacity()*sizeof(Word);
+        return result;
+    }
+
+private:
+    using Entry = std::vector<Word>;
+    std::vector<Entry> entries_;
+};
+
+} // namespace Opm
+
+#endif
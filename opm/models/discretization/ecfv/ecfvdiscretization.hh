@@ -112,7 +112,9 @@ public:
 
 //! For the element centered finite volume method, ghost and overlap elements must be
 //! assembled to calculate the fluxes over the process boundary faces of the local
-//! process' grid partition
+//! process' grid partition (unless the EnableOwnerComputesLinearization parameter is
+//! set, in which case the corresponding Jacobian entries are received from the peer
+//! processes)
 template<class TypeTag>
 struct LinearizeNonLocalElements<TypeTag, TTag::EcfvDiscretization> { static constexpr bool value = true; };
 
@@ -128,6 +130,14 @@ namespace Opm {
  * \ingroup EcfvDiscretization
  *
  * \brief The base class for the element-centered finite-volume discretization scheme.
+ *
+ * The system of equations is linearized element by element: the flux over an interior
+ * face is evaluated by the element contexts of both adjacent elements. Note that this
+ * is not redundant if automatic differentiation is used, because each evaluation only
+ * yields the derivatives with regard to the primary variables of the element which is
+ * in focus, i.e., the two evaluations produce the two different columns of the
+ * Jacobian matrix. Evaluating each face only once would require evaluations which carry
+ * derivatives with regard to both adjacent degrees of freedom.
  */
 template<class TypeTag>
 class EcfvDiscretization : public FvBaseDiscretization<TypeTag>
@@ -173,20 +183,51 @@ public:
      * For the Element Centered Finite Volume discretization, this
      * method retrieves the primary variables corresponding to
      * overlap/ghost elements from their respective master process.
+     * Except for the first synchronization, only the primary variables
+     * which changed since the previous one are transferred.
      */
     void syncOverlap()
     {
-        // syncronize the solution on the ghost and overlap elements
-        using GhostSyncHandle = GridCommHandleGhostSync<PrimaryVariables,
-                                                        SolutionVector,
-                                                        DofMapper,
-                                                        /*commCodim=*/0>;
-
-        auto ghostSync = GhostSyncHandle(this->solution(/*timeIdx=*/0),
-                                         asImp_().dofMapper());
-        this->gridView().communicate(ghostSync,
-                                     Dune::InteriorBorder_All_Interface,
-                                     Dune::ForwardCommunication);
+        if (this->gridView().comm().size() == 1)
+            return;
+
+        auto& solution = this->solution(/*timeIdx=*/0);
+        if (lastSyncedSolution_.size() != solution.size()) {
+            // syncronize the solution on the ghost and overlap elements
+            using GhostSyncHandle = GridCommHandleGhostSync<PrimaryVariables,
+                                                            SolutionVector,
+                                                            DofMapper,
+                                                            /*commCodim=*/0>;
+
+            auto ghostSync = GhostSyncHandle(solution, asImp_().dofMapper());
+            this->gridView().communicate(ghostSync,
+                                         Dune::InteriorBorder_All_Interface,
+                                         Dune::ForwardCommunication);
+            lastSyncedSolution_.resize(solution.size());
+        }
+        else {
+            // only send the primary variables which changed since the last
+            // synchronization
+            using GhostSyncHandle = GridCommHandleChangedGhostSync<PrimaryVariables,
+                                                                   SolutionVector,
+                                                                   DofMapper,
+                                                                   /*commCodim=*/0>;
+
+            auto ghostSync = GhostSyncHandle(solution,
+                                             lastSyncedSolution_,
+                                             asImp_().dofMapper());
+            this->gridView().communicate(ghostSync,
+                                         Dune::InteriorBorder_All_Interface,
+                                         Dune::ForwardCommunication);
+        }
+
+        // remember the synchronized solution for the next time
+        size_t numDof = solution.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            lastSyncedSolution_[dofIdx] = solution[dofIdx];
     }
 
     /*!
@@ -219,6 +260,8 @@ private:
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    SolutionVector lastSyncedSolution_;
 };
 } // namespace Opm
 
@@ -378,6 +378,18 @@ public:
     const BoundaryFace& boundaryFace(unsigned bfIdx) const
     { return boundaryFaces_[bfIdx]; }
 
+    /*!
+     * \brief Returns the number of bytes of memory occupied by the stencil.
+     */
+    size_t memoryUsage() const
+    {
+        return sizeof(*this)
+            + elements_.capacity()*sizeof(Element)
+            + subControlVolumes_.capacity()*sizeof(SubControlVolume)
+            + interiorFaces_.capacity()*sizeof(SubControlVolumeFace)
+            + boundaryFaces_.capacity()*sizeof(BoundaryFace);
+    }
+
 protected:
     const GridView&       gridView_;
     const ElementMapper&  elementMapper_;
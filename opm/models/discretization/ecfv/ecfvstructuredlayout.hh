@@ -0,0 +1,263 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::EcfvStructuredLayout
+ */
+#ifndef EWOMS_ECFV_STRUCTURED_LAYOUT_HH
+#define EWOMS_ECFV_STRUCTURED_LAYOUT_HH
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup EcfvDiscretization
+ *
+ * \brief Describes the elements of the local grid partition if they form a Cartesian
+ *        lattice, e.g. for YaspGrid.
+ *
+ * The layout is structured if the elements are cubes whose centers form a tensor
+ * product lattice, if the index of each element is given by the lexicographic order
+ * of its lattice position (the first coordinate running fastest) and if the neighbors
+ * of each element are exactly the adjacent elements of the lattice. This is verified for the actual grid, so a layout is never wrongly
+ * considered structured, irrespective of the grid implementation.
+ *
+ * For structured layouts, the neighbors of an element follow from index arithmetic,
+ * i.e., the sparsity pattern of the Jacobian matrix is the one of a (2*dim + 1)-point
+ * stencil which can be determined without iterating over the grid. The lattice
+ * dimensions can also be used by preconditioners which exploit the structure.
+ */
+template <class GridView>
+class EcfvStructuredLayout
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using CoordScalar = typename GridView::ctype;
+
+public:
+    using Index = std::array<unsigned, dim>;
+
+    EcfvStructuredLayout()
+        : structured_(false)
+        , numElements_(0)
+        , tolerance_(0.0)
+    { dims_.fill(0); }
+
+    /*!
+     * \brief Determine whether the elements of a grid view form a Cartesian lattice.
+     *
+     * This must be called whenever the grid changes.
+     *
+     * \param gridView The grid view of the local grid partition
+     * \param elementMapper The mapper for the elements of the grid view
+     * \return true if the layout is structured
+     */
+    template <class ElementMapper>
+    bool update(const GridView& gridView, const ElementMapper& elementMapper)
+    {
+        structured_ = false;
+        numElements_ = static_cast<size_t>(gridView.size(/*codim=*/0));
+        dims_.fill(0);
+        if (dim != dimWorld || numElements_ == 0)
+            return false;
+
+        // the distinct center coordinates of the elements in each direction
+        std::array<std::vector<CoordScalar>, dim> centerCoords;
+        CoordScalar minExtent = std::numeric_limits<CoordScalar>::max();
+        for (const auto& elem : elements(gridView)) {
+            const auto& geometry = elem.geometry();
+            if (!geometry.type().isCube() || !geometry.affine())
+                return false;
+
+            const auto& center = geometry.center();
+            for (unsigned dimIdx = 0; dimIdx < dim; ++dimIdx) {
+                centerCoords[dimIdx].push_back(center[dimIdx]);
+                minExtent = std::min(minExtent, extent_(geometry, dimIdx));
+            }
+        }
+
+        // coordinates which are closer than a small fraction of the smallest element
+        // extent are considered to be the same
+        tolerance_ = 1e-6*minExtent;
+        size_t numLatticePoints = 1;
+        for (unsigned dimIdx = 0; dimIdx < dim; ++dimIdx) {
+            auto& coords = centerCoords[dimIdx];
+            std::sort(coords.begin(), coords.end());
+            const CoordScalar tol = tolerance_;
+            auto newEnd = std::unique(coords.begin(), coords.end(),
+                                      [tol](CoordScalar a, CoordScalar b)
+                                      { return b - a < tol; });
+            coords.erase(newEnd, coords.end());
+            dims_[dimIdx] = static_cast<unsigned>(coords.size());
+            numLatticePoints *= coords.size();
+        }
+
+        if (numLatticePoints != numElements_) {
+            dims_.fill(0);
+            return false;
+        }
+
+        // verify that the index of each element corresponds to its lattice position
+        // and that the neighbors of the elements are the adjacent lattice points
+        std::array<unsigned, 2*dim> neighbors;
+        for (const auto& elem : elements(gridView)) {
+            const auto& geometry = elem.geometry();
+            const auto& center = geometry.center();
+            Index latticeIdx;
+            for (unsigned dimIdx = 0; dimIdx < dim; ++dimIdx) {
+                const auto& coords = centerCoords[dimIdx];
+                auto it = std::lower_bound(coords.begin(), coords.end(),
+                                           center[dimIdx] - tolerance_);
+                if (it == coords.end() || std::abs(*it - center[dimIdx]) >= tolerance_) {
+                    dims_.fill(0);
+                    return false;
+                }
+                latticeIdx[dimIdx] = static_cast<unsigned>(it - coords.begin());
+            }
+
+            unsigned elemIdx = static_cast<unsigned>(elementMapper.index(elem));
+            if (elemIdx != index(latticeIdx)) {
+                dims_.fill(0);
+                return false;
+            }
+
+            unsigned numNeighbors = 0;
+            forEachNeighbor(elemIdx, [&neighbors, &numNeighbors](unsigned neighborIdx)
+                            { neighbors[numNeighbors++] = neighborIdx; });
+
+            unsigned numGridNeighbors = 0;
+            for (const auto& intersection : intersections(gridView, elem)) {
+                if (!intersection.neighbor())
+                    continue;
+
+                unsigned neighborIdx =
+                    static_cast<unsigned>(elementMapper.index(intersection.outside()));
+                ++numGridNeighbors;
+                if (std::find(neighbors.begin(), neighbors.begin() + numNeighbors, neighborIdx)
+                    == neighbors.begin() + numNeighbors)
+                {
+                    dims_.fill(0);
+                    return false;
+                }
+            }
+
+            if (numGridNeighbors != numNeighbors) {
+                dims_.fill(0);
+                return false;
+            }
+        }
+
+        structured_ = true;
+        return true;
+    }
+
+    /*!
+     * \brief Returns true if the elements form a Cartesian lattice.
+     */
+    bool isStructured() const
+    { return structured_; }
+
+    /*!
+     * \brief Returns the number of elements in each direction of the lattice.
+     */
+    const Index& dimensions() const
+    { return dims_; }
+
+    /*!
+     * \brief Returns the index of the element at a position of the lattice.
+     */
+    unsigned index(const Index& latticeIdx) const
+    {
+        unsigned result = 0;
+        for (int dimIdx = dim - 1; dimIdx >= 0; --dimIdx)
+            result = result*dims_[static_cast<unsigned>(dimIdx)] + latticeIdx[static_cast<unsigned>(dimIdx)];
+        return result;
+    }
+
+    /*!
+     * \brief Returns the position of an element in the lattice.
+     */
+    Index latticeIndex(unsigned elemIdx) const
+    {
+        Index result;
+        for (unsigned dimIdx = 0; dimIdx < dim; ++dimIdx) {
+            result[dimIdx] = elemIdx % dims_[dimIdx];
+            elemIdx /= dims_[dimIdx];
+        }
+        return result;
+    }
+
+    /*!
+     * \brief Call a function for the indices of all neighbors of an element.
+     *
+     * The neighbors are visited in the order of the faces of the Dune reference cube,
+     * i.e., the lower and the upper neighbor in the first direction come first.
+     */
+    template <class Functor>
+    void forEachNeighbor(unsigned elemIdx, Functor func) const
+    {
+        Index latticeIdx = latticeIndex(elemIdx);
+        unsigned stride = 1;
+        for (unsigned dimIdx = 0; dimIdx < dim; ++dimIdx) {
+            if (latticeIdx[dimIdx] > 0)
+                func(elemIdx - stride);
+            if (latticeIdx[dimIdx] + 1 < dims_[dimIdx])
+                func(elemIdx + stride);
+            stride *= dims_[dimIdx];
+        }
+    }
+
+private:
+    // the extent of an element in a direction
+    template <class Geometry>
+    static CoordScalar extent_(const Geometry& geometry, unsigned dimIdx)
+    {
+        CoordScalar minCoord = std::numeric_limits<CoordScalar>::max();
+        CoordScalar maxCoord = std::numeric_limits<CoordScalar>::lowest();
+        for (int cornerIdx = 0; cornerIdx < geometry.corners(); ++cornerIdx) {
+            CoordScalar coord = geometry.corner(cornerIdx)[dimIdx];
+            minCoord = std::min(minCoord, coord);
+            maxCoord = std::max(maxCoord, coord);
+        }
+        return maxCoord - minCoord;
+    }
+
+    bool structured_;
+    size_t numElements_;
+    Index dims_;
+    CoordScalar tolerance_;
+};
+
+} // namespace Opm
+
+#endif
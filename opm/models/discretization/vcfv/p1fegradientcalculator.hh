@@ -29,6 +29,7 @@
 #define EWOMS_P1FE_GRADIENT_CALCULATOR_HH
 
 #include "vcfvproperties.hh"
+#include "vcfvstencil.hh"
 
 #include <opm/models/discretization/common/fvbasegradientcalculator.hh>
 
@@ -43,6 +44,8 @@
 
 #include <dune/common/fvector.hh>
 
+#include <array>
+#include <type_traits>
 #include <vector>
 
 #ifdef HAVE_DUNE_LOCALFUNCTIONS
@@ -80,6 +83,7 @@ class P1FeGradientCalculator : public FvBaseGradientCalculator<TypeTag>
 
     using CoordScalar = typename GridView::ctype;
     using DimVector = Dune::FieldVector<Scalar, dim>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
 
 #if HAVE_DUNE_LOCALFUNCTIONS
     using LocalFiniteElementCache = Dune::PQkLocalFiniteElementCache<CoordScalar, Scalar, dim, 1>;
@@ -110,6 +114,31 @@ public:
             const LocalFiniteElement& localFE = feCache_.get(elemCtx.element().type());
             localFiniteElement_ = &localFE;
 
+            if constexpr (std::is_same<Stencil, VcfvStencil<CoordScalar, GridView> >::value) {
+                if (stencil.hasStoredShapeFunctions()) {
+                    // the shape functions have been evaluated when the geometry store
+                    // of the grid was built
+                    unsigned numVertices = static_cast<unsigned>(elemCtx.numDof(timeIdx));
+                    for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
+                        if (prepareValues) {
+                            p1Value_[faceIdx].resize(numVertices);
+                            for (unsigned vertIdx = 0; vertIdx < numVertices; vertIdx++)
+                                p1Value_[faceIdx][vertIdx] = stencil.storedShapeValue(faceIdx, vertIdx);
+                        }
+
+                        if (prepareGradients) {
+                            for (unsigned vertIdx = 0; vertIdx < numVertices; vertIdx++) {
+                                const auto& gradient = stencil.storedShapeGradient(faceIdx, vertIdx);
+                                for (unsigned dimIdx = 0; dimIdx < dim; ++dimIdx)
+                                    p1Gradient_[faceIdx][vertIdx][dimIdx] = gradient[dimIdx];
+                            }
+                        }
+                    }
+
+                    return;
+                }
+            }
+
             // loop over all face centeres
             for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
                 const auto& localFacePos = stencil.interiorFace(faceIdx).localPos();
@@ -296,6 +325,90 @@ public:
             ParentType::calculateGradient(quantityGrad, elemCtx, fapIdx, quantityCallback);
     }
 
+    /*!
+     * \brief Calculates the gradients of several quantities at any flux approximation
+     *        point in a single pass.
+     *
+     * \param quantityGrads The gradients of the quantities, indexed by the quantity
+     * \param elemCtx The current execution context
+     * \param fapIdx The local index of the flux approximation point
+     *               in the current element's stencil.
+     * \param quantitiesCallback A callable object which sets the values of all
+     *               quantities given the index of a degree of freedom
+     */
+    template <class QuantitiesCallback, class GradientArray>
+    void calculateGradients(GradientArray& quantityGrads EWOMS_NO_LOCALFUNCTIONS_UNUSED,
+                            const ElementContext& elemCtx EWOMS_NO_LOCALFUNCTIONS_UNUSED,
+                            unsigned fapIdx EWOMS_NO_LOCALFUNCTIONS_UNUSED,
+                            const QuantitiesCallback& quantitiesCallback EWOMS_NO_LOCALFUNCTIONS_UNUSED) const
+    {
+        if (getPropValue<TypeTag, Properties::UseP1FiniteElementGradients>()) {
+#if !HAVE_DUNE_LOCALFUNCTIONS
+            // The dune-localfunctions module is required for P1 finite element gradients
+            throw std::logic_error("The dune-localfunctions module is required in oder to use"
+                                   " finite element gradients");
+#else
+            constexpr unsigned numFields = QuantitiesCallback::numFields;
+            using QuantityType = typename QuantitiesCallback::ResultType;
+
+            for (unsigned fieldIdx = 0; fieldIdx < numFields; ++fieldIdx)
+                quantityGrads[fieldIdx] = 0.0;
+
+            std::array<QuantityType, numFields> dofValues;
+            for (unsigned vertIdx = 0; vertIdx < elemCtx.numDof(/*timeIdx=*/0); ++vertIdx) {
+                quantitiesCallback(dofValues, vertIdx);
+                const auto& tmp = p1Gradient_[fapIdx][vertIdx];
+                bool keepDerivatives =
+                    std::is_same<QuantityType, Scalar>::value
+                    || elemCtx.focusDofIndex() == vertIdx;
+                for (unsigned fieldIdx = 0; fieldIdx < numFields; ++fieldIdx) {
+                    for (int dimIdx = 0; dimIdx < dim; ++ dimIdx) {
+                        if (keepDerivatives)
+                            quantityGrads[fieldIdx][dimIdx] += dofValues[fieldIdx]*tmp[dimIdx];
+                        else
+                            quantityGrads[fieldIdx][dimIdx] +=
+                                scalarValue(dofValues[fieldIdx])*tmp[dimIdx];
+                    }
+                }
+            }
+#endif
+        }
+        else
+            ParentType::calculateGradients(quantityGrads, elemCtx, fapIdx, quantitiesCallback);
+    }
+
+    /*!
+     * \brief Calculates the scalar product of the gradient of an arbitrary quantity and
+     *        the normal of a flux approximation point.
+     *
+     * \param elemCtx The current execution context
+     * \param fapIdx The local index of the flux approximation point
+     *               in the current element's stencil.
+     * \param quantityCallback A callable object returning the value
+     *               of the quantity at an index of a degree of
+     *               freedom
+     */
+    template <class QuantityCallback>
+    Evaluation calculateNormalGradient(const ElementContext& elemCtx,
+                                       unsigned fapIdx,
+                                       const QuantityCallback& quantityCallback) const
+    {
+        if (getPropValue<TypeTag, Properties::UseP1FiniteElementGradients>()) {
+            // the finite element gradient depends on all vertices of the element, so
+            // there is nothing to gain from projecting it onto the normal directly
+            Dune::FieldVector<Evaluation, dim> quantityGrad;
+            calculateGradient(quantityGrad, elemCtx, fapIdx, quantityCallback);
+
+            const auto& normal = elemCtx.stencil(/*timeIdx=*/0).interiorFace(fapIdx).normal();
+            Evaluation result = 0.0;
+            for (unsigned dimIdx = 0; dimIdx < dim; ++dimIdx)
+                result += quantityGrad[dimIdx]*normal[dimIdx];
+            return result;
+        }
+        else
+            return ParentType::calculateNormalGradient(elemCtx, fapIdx, quantityCallback);
+    }
+
     /*!
      * \brief Calculates the value of an arbitrary quantity at any
      *        flux approximation point on the grid boundary.
@@ -338,6 +451,20 @@ public:
                                    const QuantityCallback& quantityCallback) const
     { ParentType::calculateBoundaryGradient(quantityGrad, elemCtx, fapIdx, quantityCallback); }
 
+    /*!
+     * \brief Calculates the gradients of several quantities at any flux approximation
+     *        point on the boundary in a single pass.
+     *
+     * Boundary gradients are always calculated using the two-point
+     * approximation.
+     */
+    template <class QuantitiesCallback, class GradientArray>
+    void calculateBoundaryGradients(GradientArray& quantityGrads,
+                                    const ElementContext& elemCtx,
+                                    unsigned fapIdx,
+                                    const QuantitiesCallback& quantitiesCallback) const
+    { ParentType::calculateBoundaryGradients(quantityGrads, elemCtx, fapIdx, quantitiesCallback); }
+
 #if HAVE_DUNE_LOCALFUNCTIONS
     static LocalFiniteElementCache& localFiniteElementCache()
     { return feCache_; }
@@ -39,6 +39,8 @@
 #include <opm/simulators/linalg/vertexborderlistfromgrid.hh>
 #include <opm/models/discretization/common/fvbasediscretization.hh>
 
+#include <memory>
+
 #if HAVE_DUNE_FEM
 #include <dune/fem/space/common/functionspace.hh>
 #include <dune/fem/space/lagrange.hh>
@@ -92,6 +94,10 @@ struct GridCommHandleFactory<TypeTag, TTag::VcfvDiscretization>
 template<class TypeTag>
 struct UseP1FiniteElementGradients<TypeTag, TTag::VcfvDiscretization> { static constexpr bool value = false; };
 
+//! Precompute the geometry of the stencils by default
+template<class TypeTag>
+struct EnableVcfvGeometryStore<TypeTag, TTag::VcfvDiscretization> { static constexpr bool value = true; };
+
 #if HAVE_DUNE_FEM
 //! Set the DiscreteFunctionSpace
 template<class TypeTag>
@@ -145,13 +151,34 @@ class VcfvDiscretization : public FvBaseDiscretization<TypeTag>
     using DofMapper = GetPropType<TypeTag, Properties::DofMapper>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
+    using GeometryStore = typename Stencil::GeometryStore;
 
     enum { dim = GridView::dimension };
 
 public:
     VcfvDiscretization(Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        // the geometry of the stencils only needs to be computed again if the grid
+        // gets adapted
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableVcfvGeometryStore))
+            geometryStore_.reset(new GeometryStore(this->gridView_,
+                                                   this->vertexMapper(),
+                                                   getPropValue<TypeTag, Properties::UseP1FiniteElementGradients>()));
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the model.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableVcfvGeometryStore,
+                             "Compute the geometry of the sub-control volumes of all "
+                             "elements once instead of whenever an element is visited");
+    }
 
     /*!
      * \brief Returns a string of discretization's human-readable name
@@ -172,6 +199,31 @@ public:
     const DofMapper& dofMapper() const
     { return this->vertexMapper(); }
 
+    /*!
+     * \copydoc FvBaseDiscretization::gridChanged
+     *
+     * The geometry of the stencils is re-computed for the adapted grid.
+     */
+    void gridChanged()
+    {
+        ParentType::gridChanged();
+
+        if (geometryStore_)
+            geometryStore_.reset(new GeometryStore(this->gridView_,
+                                                   this->vertexMapper(),
+                                                   getPropValue<TypeTag, Properties::UseP1FiniteElementGradients>()));
+    }
+
+    /*!
+     * \brief Attach the stencil of a newly created element context to the geometry
+     *        store of the grid.
+     */
+    void initStencil(Stencil& stencil) const
+    {
+        if (geometryStore_)
+            stencil.setGeometryStore(geometryStore_.get());
+    }
+
     /*!
      * \brief Serializes the current state of the model.
      *
@@ -202,6 +254,8 @@ private:
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    std::unique_ptr<GeometryStore> geometryStore_;
 };
 } // namespace Opm
 
@@ -85,6 +85,19 @@ public:
         using Handle = GridCommHandleSum<ValueType, ArrayType,  DofMapper, /*commCodim=*/dim>;
         return  std::shared_ptr<Handle>(new Handle(array, dofMapper));
     }
+    /*!
+     * \brief Return a handle which exchanges the values of several containers
+     *        for all overlapping degrees of freedom in a single communication.
+     *
+     * The containers are registered using the handle's addField() method.
+     */
+    template <class ValueType>
+    static std::shared_ptr<GridCommHandleMultiField<ValueType, DofMapper, /*commCodim=*/dim> >
+    multiFieldHandle(const DofMapper& dofMapper)
+    {
+        using Handle = GridCommHandleMultiField<ValueType, DofMapper, /*commCodim=*/dim>;
+        return  std::shared_ptr<Handle>(new Handle(dofMapper));
+    }
 };
 } // namespace Opm
 
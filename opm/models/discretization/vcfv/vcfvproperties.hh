@@ -46,6 +46,11 @@ struct VcfvDiscretization { using InheritsFrom = std::tuple<FvBaseDiscretization
 template<class TypeTag, class MyTypeTag>
 struct UseP1FiniteElementGradients { using type = UndefinedProperty; };
 
+//! Compute the geometry of the stencils of all elements once and copy it to the
+//! stencils instead of recalculating it whenever an element is visited
+template<class TypeTag, class MyTypeTag>
+struct EnableVcfvGeometryStore { using type = UndefinedProperty; };
+
 } // namespace Opm::Properties
 
 #endif
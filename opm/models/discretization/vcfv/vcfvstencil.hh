@@ -36,6 +36,7 @@
 #include <dune/grid/common/intersectioniterator.hh>
 #include <dune/grid/common/mcmgmapper.hh>
 #include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
 
 #if HAVE_DUNE_LOCALFUNCTIONS
 #include <dune/localfunctions/lagrange/pqkfactory.hh>
@@ -43,6 +44,7 @@
 
 #include <dune/common/version.hh>
 
+#include <algorithm>
 #include <vector>
 
 namespace Opm {
@@ -473,6 +475,7 @@ class VcfvStencil
     enum{maxNE = (dim < 3 ? 4 : 12)};
     enum{maxNF = (dim < 3 ? 1 : 6)};
     enum{maxBF = (dim < 3 ? 8 : 24)};
+    enum{maxNumCodim1 = 2*dim};
     using CoordScalar = typename GridView::ctype;
     using Element = typename GridView::Traits::template Codim<0>::Entity           ;
 public:
@@ -596,7 +599,7 @@ private:
         return normal.two_norm();
     }
 
-    void getFaceIndices(unsigned numElemVertices, unsigned k, unsigned& leftFace, unsigned& rightFace)
+    static void getFaceIndices(unsigned numElemVertices, unsigned k, unsigned& leftFace, unsigned& rightFace)
     {
         static const unsigned edgeToFaceTet[2][6] = {
             {1, 0, 3, 2, 1, 3},
@@ -639,7 +642,7 @@ private:
         }
     }
 
-    void getEdgeIndices(unsigned numElemVertices, unsigned face, unsigned vert, unsigned& leftEdge, unsigned& rightEdge)
+    static void getEdgeIndices(unsigned numElemVertices, unsigned face, unsigned vert, unsigned& leftEdge, unsigned& rightEdge)
     {
         static const int faceAndVertexToLeftEdgeTet[4][4] = {
                 { 0, 0, 2, -1},
@@ -722,6 +725,143 @@ private:
         }
     }
 
+    /*!
+     * \brief The local positions of the entities of a reference element and of the
+     *        integration points of the sub-control volume faces and boundary segments.
+     *
+     * These only depend on the type of the element, so they are determined once for
+     * each type instead of for each element. The stencil then only needs to apply the
+     * element's geometry mapping.
+     */
+    struct ReferenceTable_
+    {
+        explicit ReferenceTable_(const Dune::GeometryType& type)
+        {
+            const auto& refElem = Dune::ReferenceElements<CoordScalar, dim>::general(type);
+            numVertices = static_cast<unsigned>(refElem.size(dim));
+            numEdges = static_cast<unsigned>(refElem.size(dim - 1));
+            numCodim1 = static_cast<unsigned>(refElem.size(1));
+
+            elementLocal = refElem.position(0, 0);
+            for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx)
+                vertexLocal[vertIdx] = refElem.position(static_cast<int>(vertIdx), dim);
+            for (unsigned edgeIdx = 0; edgeIdx < numEdges; ++edgeIdx)
+                edgeLocal[edgeIdx] = refElem.position(static_cast<int>(edgeIdx), dim - 1);
+            for (unsigned faceIdx = 0; faceIdx < numCodim1; ++faceIdx)
+                codim1Local[faceIdx] = refElem.position(static_cast<int>(faceIdx), 1);
+
+            // the sub-control volume faces
+            for (unsigned k = 0; k < numEdges; ++k) {
+                unsigned short i = static_cast<unsigned short>(refElem.subEntity(static_cast<int>(k), dim-1, 0, dim));
+                unsigned short j = static_cast<unsigned short>(refElem.subEntity(static_cast<int>(k), dim-1, 1, dim));
+                if (numEdges == 4 && (i == 2 || j == 2))
+                    std::swap(i, j);
+                scvfVertices[k][0] = i;
+                scvfVertices[k][1] = j;
+
+                if (dim == 1)
+                    scvfIpLocal[k] = 0.5;
+                else if (dim == 2) {
+                    scvfIpLocal[k] = edgeLocal[k];
+                    scvfIpLocal[k] += elementLocal;
+                    scvfIpLocal[k] *= 0.5;
+                }
+                else if (dim == 3) {
+                    getFaceIndices(numVertices, k, scvfFaces[k][0], scvfFaces[k][1]);
+                    scvfIpLocal[k] = edgeLocal[k];
+                    scvfIpLocal[k] += elementLocal;
+                    scvfIpLocal[k] += codim1Local[scvfFaces[k][0]];
+                    scvfIpLocal[k] += codim1Local[scvfFaces[k][1]];
+                    scvfIpLocal[k] *= 0.25;
+                }
+            }
+
+            // the boundary segments of the faces
+            for (unsigned face = 0; face < numCodim1; ++face) {
+                numFaceVertices[face] = static_cast<unsigned>(refElem.size(static_cast<int>(face), 1, dim));
+                for (unsigned vertInFace = 0; vertInFace < numFaceVertices[face]; ++vertInFace) {
+                    unsigned short vertInElement =
+                        static_cast<unsigned short>(refElem.subEntity(static_cast<int>(face), 1, static_cast<int>(vertInFace), dim));
+                    faceVertices[face][vertInFace] = vertInElement;
+
+                    auto& ipLocal = boundaryIpLocal[face][vertInFace];
+                    ipLocal = vertexLocal[vertInElement];
+                    if (dim == 2) {
+                        ipLocal += codim1Local[face];
+                        ipLocal *= 0.5;
+                    }
+                    else if (dim == 3) {
+                        auto& edges = boundaryEdges[face][vertInFace];
+                        getEdgeIndices(numVertices, face, vertInElement, edges[0], edges[1]);
+                        ipLocal += codim1Local[face];
+                        ipLocal += edgeLocal[edges[0]];
+                        ipLocal += edgeLocal[edges[1]];
+                        ipLocal *= 0.25;
+                    }
+                }
+            }
+        }
+
+        unsigned numVertices;
+        unsigned numEdges;
+        unsigned numCodim1;
+
+        LocalPosition elementLocal;
+        LocalPosition vertexLocal[maxNC];
+        LocalPosition edgeLocal[maxNE];
+        LocalPosition codim1Local[maxNumCodim1];
+
+        // the vertices, the left and right faces (3D only) and the integration point of
+        // the sub-control volume face of each edge
+        unsigned short scvfVertices[maxNE][2];
+        unsigned scvfFaces[maxNE][2];
+        LocalPosition scvfIpLocal[maxNE];
+
+        // the vertices of each face, the left and right edges of the boundary segment of
+        // each face vertex (3D only) and its integration point
+        unsigned numFaceVertices[maxNumCodim1];
+        unsigned short faceVertices[maxNumCodim1][4];
+        unsigned boundaryEdges[maxNumCodim1][4][2];
+        LocalPosition boundaryIpLocal[maxNumCodim1][4];
+    };
+
+    static bool initLocalGeometries_()
+    {
+        VcfvScvGeometries<Scalar, /*dim=*/1, ElementType::cube>::init();
+        VcfvScvGeometries<Scalar, /*dim=*/2, ElementType::cube>::init();
+        VcfvScvGeometries<Scalar, /*dim=*/2, ElementType::simplex>::init();
+        VcfvScvGeometries<Scalar, /*dim=*/3, ElementType::cube>::init();
+        VcfvScvGeometries<Scalar, /*dim=*/3, ElementType::simplex>::init();
+        return true;
+    }
+
+    // returns the reference table for an element type. the tables are created on first
+    // use, which is thread safe for local static variables.
+    static const ReferenceTable_& referenceTable_(const Dune::GeometryType& type)
+    {
+        if (type.isSimplex()) {
+            static const ReferenceTable_ simplexTable(Dune::GeometryTypes::simplex(dim));
+            return simplexTable;
+        }
+        if (type.isCube()) {
+            static const ReferenceTable_ cubeTable(Dune::GeometryTypes::cube(dim));
+            return cubeTable;
+        }
+        if constexpr (dim == 3) {
+            if (type.isPyramid()) {
+                static const ReferenceTable_ pyramidTable(Dune::GeometryTypes::pyramid);
+                return pyramidTable;
+            }
+            if (type.isPrism()) {
+                static const ReferenceTable_ prismTable(Dune::GeometryTypes::prism);
+                return prismTable;
+            }
+        }
+
+        throw std::logic_error("Not implemented: VcfvStencil for elements of type "
+                               +std::to_string(type.id()));
+    }
+
 public:
     //! exported Mapper type
     using Mapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
@@ -810,24 +950,155 @@ public:
     //! compatibility alias
     using BoundaryFace = SubControlVolumeFace;
 
+    /*!
+     * \brief The geometric data of the stencils of all elements of a grid view.
+     *
+     * Computing the sub-control volumes and their faces requires to evaluate the
+     * element's geometry at several points and to iterate over its intersections. Since
+     * these quantities do not change as long as the grid is not modified, they can be
+     * computed once and stored in a compact per-element record. Stencils which are
+     * attached to a store using setGeometryStore() copy the record of their element
+     * instead of recalculating it. Optionally, the values and gradients of the P1
+     * shape functions at the integration points of the interior faces are stored as
+     * well.
+     */
+    class GeometryStore
+    {
+        friend class VcfvStencil;
+
+        struct ElementRecord
+        {
+            unsigned scvBegin;
+            unsigned faceBegin;
+            unsigned boundaryFaceBegin;
+            unsigned shapeBegin;
+            unsigned short numBoundaryFaces;
+        };
+
+    public:
+        GeometryStore(const GridView& gridView,
+                      const Mapper& vertexMapper,
+                      bool storeShapeFunctions)
+            : elementMapper_(gridView, Dune::mcmgElementLayout())
+            , storeShapeFunctions_(storeShapeFunctions)
+        {
+#if !HAVE_DUNE_LOCALFUNCTIONS
+            storeShapeFunctions_ = false;
+#endif // !HAVE_DUNE_LOCALFUNCTIONS
+
+            update_(gridView, vertexMapper);
+        }
+
+        /*!
+         * \brief Returns true if the values and gradients of the P1 shape functions
+         *        at the integration points of the interior faces are stored.
+         */
+        bool storesShapeFunctions() const
+        { return storeShapeFunctions_; }
+
+        /*!
+         * \brief Returns the number of bytes of memory occupied by the store.
+         */
+        size_t memoryUsage() const
+        {
+            return
+                records_.capacity()*sizeof(ElementRecord)
+                + scvVolumes_.capacity()*sizeof(Scalar)
+                + interiorFaces_.capacity()*sizeof(SubControlVolumeFace)
+                + boundaryFaces_.capacity()*sizeof(BoundaryFace)
+                + shapeValues_.capacity()*sizeof(Scalar)
+                + shapeGradients_.capacity()*sizeof(DimVector);
+        }
+
+    private:
+        void update_(const GridView& gridView, const Mapper& vertexMapper)
+        {
+            records_.resize(static_cast<size_t>(gridView.size(/*codim=*/0)));
+            scvVolumes_.clear();
+            interiorFaces_.clear();
+            boundaryFaces_.clear();
+            shapeValues_.clear();
+            shapeGradients_.clear();
+
+            // the stencil used to compute the records is not attached to a store
+            VcfvStencil stencil(gridView, vertexMapper);
+            auto elemIt = gridView.template begin</*codim=*/0>();
+            const auto& elemEndIt = gridView.template end</*codim=*/0>();
+            for (; elemIt != elemEndIt; ++elemIt) {
+                const auto& elem = *elemIt;
+                stencil.update(elem);
+
+                auto& record = records_[static_cast<size_t>(elementMapper_.index(elem))];
+                record.scvBegin = static_cast<unsigned>(scvVolumes_.size());
+                record.faceBegin = static_cast<unsigned>(interiorFaces_.size());
+                record.boundaryFaceBegin = static_cast<unsigned>(boundaryFaces_.size());
+                record.shapeBegin = static_cast<unsigned>(shapeValues_.size());
+                record.numBoundaryFaces = static_cast<unsigned short>(stencil.numBoundaryFaces());
+
+                for (unsigned scvIdx = 0; scvIdx < stencil.numDof(); ++scvIdx)
+                    scvVolumes_.push_back(stencil.subControlVolume(scvIdx).volume());
+                for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx)
+                    interiorFaces_.push_back(stencil.interiorFace(faceIdx));
+                for (unsigned bfIdx = 0; bfIdx < stencil.numBoundaryFaces(); ++bfIdx)
+                    boundaryFaces_.push_back(stencil.boundaryFace(bfIdx));
+
+#if HAVE_DUNE_LOCALFUNCTIONS
+                if (storeShapeFunctions_)
+                    addShapeFunctions_(stencil, elem);
+#endif // HAVE_DUNE_LOCALFUNCTIONS
+            }
+        }
+
+#if HAVE_DUNE_LOCALFUNCTIONS
+        void addShapeFunctions_(const VcfvStencil& stencil, const Element& elem)
+        {
+            const auto& localFE = feCache_.get(elem.type());
+            const auto& geom = elem.geometry();
+
+            std::vector<typename LocalBasisTraits::RangeType> values;
+            std::vector<ShapeJacobian> localGradient;
+            for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
+                const auto& localFacePos = stencil.interiorFace(faceIdx).localPos();
+                localFE.localBasis().evaluateFunction(localFacePos, values);
+                localFE.localBasis().evaluateJacobian(localFacePos, localGradient);
+                const auto& jacInvT = geom.jacobianInverseTransposed(localFacePos);
+
+                for (unsigned vertIdx = 0; vertIdx < stencil.numDof(); ++vertIdx) {
+                    DimVector gradient;
+                    jacInvT.mv(localGradient[vertIdx][0], gradient);
+
+                    shapeValues_.push_back(values[vertIdx][0]);
+                    shapeGradients_.push_back(gradient);
+                }
+            }
+        }
+#endif // HAVE_DUNE_LOCALFUNCTIONS
+
+        Mapper elementMapper_;
+        bool storeShapeFunctions_;
+
+        std::vector<ElementRecord> records_;
+        std::vector<Scalar> scvVolumes_;
+        std::vector<SubControlVolumeFace> interiorFaces_;
+        std::vector<BoundaryFace> boundaryFaces_;
+        // one entry for each pair of interior face and vertex
+        std::vector<Scalar> shapeValues_;
+        std::vector<DimVector> shapeGradients_;
+    };
+
     VcfvStencil(const GridView& gridView, const Mapper& mapper)
         : gridView_(gridView)
         , vertexMapper_(mapper )
         , element_(*gridView.template begin</*codim=*/0>())
+        , geometryStore_(nullptr)
+        , storeRecordIdx_(0)
     {
         // try to check if the mapper really maps the vertices
         assert(static_cast<int>(gridView.size(/*codim=*/dimWorld)) == static_cast<int>(mapper.size()));
 
-        static bool localGeometriesInitialized = false;
-        if (!localGeometriesInitialized) {
-            localGeometriesInitialized = true;
-
-            VcfvScvGeometries<Scalar, /*dim=*/1, ElementType::cube>::init();
-            VcfvScvGeometries<Scalar, /*dim=*/2, ElementType::cube>::init();
-            VcfvScvGeometries<Scalar, /*dim=*/2, ElementType::simplex>::init();
-            VcfvScvGeometries<Scalar, /*dim=*/3, ElementType::cube>::init();
-            VcfvScvGeometries<Scalar, /*dim=*/3, ElementType::simplex>::init();
-        }
+        // the local geometries of the sub-control volumes are set up by the first
+        // stencil. this is thread safe because it initializes a local static variable.
+        [[maybe_unused]] static const bool localGeometriesInitialized = initLocalGeometries_();
     }
 
     /*!
@@ -848,9 +1119,9 @@ public:
         // compute the local and global coordinates of the element
         const Geometry& geometry = e.geometry();
         geometryType_ = geometry.type();
-        const auto& referenceElement = Dune::ReferenceElements<CoordScalar,dim>::general(geometryType_);
+        const auto& table = referenceTable_(geometryType_);
         for (unsigned vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
-            subContVol[vertexIdx].local = referenceElement.position(static_cast<int>(vertexIdx), dim);
+            subContVol[vertexIdx].local = table.vertexLocal[vertexIdx];
             subContVol[vertexIdx].global = geometry.corner(static_cast<int>(vertexIdx));
         }
     }
@@ -863,33 +1134,56 @@ public:
         updateTopology(element);
     }
 
+    /*!
+     * \brief Attach the stencil to a store of precomputed geometric data.
+     *
+     * If a store is attached, update() copies the record of the element from the store
+     * instead of recalculating it. Passing a null pointer detaches the stencil.
+     */
+    void setGeometryStore(const GeometryStore* store)
+    { geometryStore_ = store; }
+
+    /*!
+     * \brief Returns the store of precomputed geometric data to which the stencil is
+     *        attached or a null pointer.
+     */
+    const GeometryStore* geometryStore() const
+    { return geometryStore_; }
+
     void update(const Element& e)
     {
+        if (geometryStore_) {
+            updateFromStore_(e);
+            return;
+        }
+
         updateTopology(e);
 
         const Geometry& geometry = e.geometry();
         geometryType_ = geometry.type();
 
-        const auto& referenceElement = Dune::ReferenceElements<CoordScalar,dim>::general(geometryType_);
+        // the local positions are taken from the table of the element type, so only the
+        // geometry mapping needs to be evaluated
+        const auto& table = referenceTable_(geometryType_);
 
         elementVolume = geometry.volume();
-        elementLocal = referenceElement.position(0,0);
+        elementLocal = table.elementLocal;
         elementGlobal = geometry.global(elementLocal);
 
         // corners:
         for (unsigned vert = 0; vert < numVertices; vert++) {
-            subContVol[vert].local = referenceElement.position(static_cast<int>(vert), dim);
+            subContVol[vert].local = table.vertexLocal[vert];
             subContVol[vert].global = geometry.global(subContVol[vert].local);
         }
 
         // edges:
         for (unsigned edge = 0; edge < numEdges; edge++) {
-            edgeCoord[edge] = geometry.global(referenceElement.position(static_cast<int>(edge), dim-1));
+            edgeCoord[edge] = geometry.global(table.edgeLocal[edge]);
         }
 
         // faces:
         for (unsigned face = 0; face < numFaces; face++) {
-            faceCoord[face] = geometry.global(referenceElement.position(static_cast<int>(face), 1));
+            faceCoord[face] = geometry.global(table.codim1Local[face]);
         }
 
         // fill sub control volume data use specialization for this
@@ -901,30 +1195,23 @@ public:
 
         // fill sub control volume face data:
         for (unsigned k = 0; k < numEdges; k++) { // begin loop over edges / sub control volume faces
-            unsigned short i = static_cast<unsigned short>(referenceElement.subEntity(static_cast<int>(k), dim-1, 0, dim));
-            unsigned short j = static_cast<unsigned short>(referenceElement.subEntity(static_cast<int>(k), dim-1, 1, dim));
-            if (numEdges == 4 && (i == 2 || j == 2))
-                std::swap(i, j);
+            unsigned short i = table.scvfVertices[k][0];
+            unsigned short j = table.scvfVertices[k][1];
             subContVolFace[k].i = i;
             subContVolFace[k].j = j;
 
-            // calculate the local integration point and
-            // the face normal. note that since dim is a
-            // constant which is known at compile time
-            // the compiler can optimize away all if
-            // cases which don't apply.
-            LocalPosition ipLocal_;
+            // the local integration point is taken from the table, only the face normal
+            // needs to be calculated. note that since dim is a constant which is known
+            // at compile time the compiler can optimize away all if cases which don't
+            // apply.
+            const LocalPosition& ipLocal_ = table.scvfIpLocal[k];
+            subContVolFace[k].ipLocal_ = ipLocal_;
             DimVector diffVec;
             if (dim==1) {
-                subContVolFace[k].ipLocal_ = 0.5;
                 subContVolFace[k].normal_ = 1.0;
                 subContVolFace[k].area_ = 1.0;
-                ipLocal_ = subContVolFace[k].ipLocal_;
             }
             else if (dim==2) {
-                ipLocal_ = referenceElement.position(static_cast<int>(k), dim-1) + elementLocal;
-                ipLocal_ *= 0.5;
-                subContVolFace[k].ipLocal_ = ipLocal_;
                 for (unsigned m = 0; m < dimWorld; ++m)
                     diffVec[m] = elementGlobal[m] - edgeCoord[k][m];
                 subContVolFace[k].normal_[0] = diffVec[1];
@@ -940,14 +1227,8 @@ public:
                 subContVolFace[k].normal_ /= subContVolFace[k].area_;
             }
             else if (dim==3) {
-                unsigned leftFace;
-                unsigned rightFace;
-                getFaceIndices(numVertices, k, leftFace, rightFace);
-                ipLocal_ = referenceElement.position(static_cast<int>(k), dim-1) + elementLocal
-                    + referenceElement.position(static_cast<int>(leftFace), 1)
-                    + referenceElement.position(static_cast<int>(rightFace), 1);
-                ipLocal_ *= 0.25;
-                subContVolFace[k].ipLocal_ = ipLocal_;
+                unsigned leftFace = table.scvfFaces[k][0];
+                unsigned rightFace = table.scvfFaces[k][1];
                 normalOfQuadrilateral3D(subContVolFace[k].normal_,
                                         edgeCoord[k], faceCoord[rightFace],
                                         elementGlobal, faceCoord[leftFace]);
@@ -968,32 +1249,23 @@ public:
                 continue;
 
             unsigned face = static_cast<unsigned>(intersection.indexInInside());
-            unsigned numVerticesOfFace = static_cast<unsigned>(referenceElement.size(static_cast<int>(face), 1, dim));
+            unsigned numVerticesOfFace = table.numFaceVertices[face];
             for (unsigned vertInFace = 0; vertInFace < numVerticesOfFace; vertInFace++)
             {
-                unsigned short vertInElement = static_cast<unsigned short>(referenceElement.subEntity(static_cast<int>(face), 1, static_cast<int>(vertInFace), dim));
+                unsigned short vertInElement = table.faceVertices[face][vertInFace];
                 unsigned bfIdx = numBoundarySegments_;
                 ++numBoundarySegments_;
 
+                boundaryFace_[bfIdx].ipLocal_ = table.boundaryIpLocal[face][vertInFace];
                 if (dim == 1) {
-                    boundaryFace_[bfIdx].ipLocal_ = referenceElement.position(static_cast<int>(vertInElement), dim);
                     boundaryFace_[bfIdx].area_ = 1.0;
                 }
                 else if (dim == 2) {
-                    boundaryFace_[bfIdx].ipLocal_ = referenceElement.position(static_cast<int>(vertInElement), dim)
-                        + referenceElement.position(static_cast<int>(face), 1);
-                    boundaryFace_[bfIdx].ipLocal_ *= 0.5;
                     boundaryFace_[bfIdx].area_ = 0.5 * intersection.geometry().volume();
                 }
                 else if (dim == 3) {
-                    unsigned leftEdge;
-                    unsigned rightEdge;
-                    getEdgeIndices(numVertices, face, vertInElement, leftEdge, rightEdge);
-                    boundaryFace_[bfIdx].ipLocal_ = referenceElement.position(static_cast<int>(vertInElement), dim)
-                        + referenceElement.position(static_cast<int>(face), 1)
-                        + referenceElement.position(static_cast<int>(leftEdge), dim-1)
-                        + referenceElement.position(static_cast<int>(rightEdge), dim-1);
-                    boundaryFace_[bfIdx].ipLocal_ *= 0.25;
+                    unsigned leftEdge = table.boundaryEdges[face][vertInFace][0];
+                    unsigned rightEdge = table.boundaryEdges[face][vertInFace][1];
                     boundaryFace_[bfIdx].area_ =
                         quadrilateralArea3D(subContVol[vertInElement].global,
                                             edgeCoord[rightEdge],
@@ -1059,6 +1331,35 @@ public:
     }
 #endif
 
+    /*!
+     * \brief Returns true if the values and gradients of the P1 shape functions at the
+     *        integration points of the interior faces are available from the store.
+     */
+    bool hasStoredShapeFunctions() const
+    { return geometryStore_ && geometryStore_->storesShapeFunctions(); }
+
+    /*!
+     * \brief Returns the stored value of the P1 shape function of a vertex at the
+     *        integration point of an interior face.
+     */
+    Scalar storedShapeValue(unsigned faceIdx, unsigned vertIdx) const
+    {
+        assert(hasStoredShapeFunctions());
+        const auto& record = geometryStore_->records_[storeRecordIdx_];
+        return geometryStore_->shapeValues_[record.shapeBegin + faceIdx*numVertices + vertIdx];
+    }
+
+    /*!
+     * \brief Returns the stored gradient of the P1 shape function of a vertex at the
+     *        integration point of an interior face.
+     */
+    const DimVector& storedShapeGradient(unsigned faceIdx, unsigned vertIdx) const
+    {
+        assert(hasStoredShapeFunctions());
+        const auto& record = geometryStore_->records_[storeRecordIdx_];
+        return geometryStore_->shapeGradients_[record.shapeBegin + faceIdx*numVertices + vertIdx];
+    }
+
     unsigned numDof() const
     { return numVertices; }
 
@@ -1086,6 +1387,12 @@ public:
     const BoundaryFace& boundaryFace(unsigned bfIdx) const
     { return boundaryFace_[bfIdx]; }
 
+    /*!
+     * \brief Returns the number of bytes of memory occupied by the stencil.
+     */
+    size_t memoryUsage() const
+    { return sizeof(*this); }
+
     /*!
      * \brief Return the global space index given the index of a degree of
      *        freedom.
@@ -1108,6 +1415,28 @@ public:
     }
 
 private:
+    void updateFromStore_(const Element& e)
+    {
+        updateTopology(e);
+
+        storeRecordIdx_ = static_cast<unsigned>(geometryStore_->elementMapper_.index(e));
+        const auto& record = geometryStore_->records_[storeRecordIdx_];
+
+        for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx)
+            subContVol[vertIdx].volume_ = geometryStore_->scvVolumes_[record.scvBegin + vertIdx];
+
+        std::copy_n(geometryStore_->interiorFaces_.begin() + record.faceBegin,
+                    numEdges,
+                    subContVolFace);
+
+        numBoundarySegments_ = record.numBoundaryFaces;
+        std::copy_n(geometryStore_->boundaryFaces_.begin() + record.boundaryFaceBegin,
+                    numBoundarySegments_,
+                    boundaryFace_);
+
+        updateScvGeometry(e);
+    }
+
 #if __GNUC__ || __clang__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpragmas"
@@ -1378,6 +1707,11 @@ private:
     //! number of faces (0 in < 3D)
     unsigned numFaces;
     Dune::GeometryType geometryType_;
+
+    //! the store of precomputed geometric data or a null pointer
+    const GeometryStore* geometryStore_;
+    //! the index of the element's record in the store
+    unsigned storeRecordIdx_;
 };
 
 #if HAVE_DUNE_LOCALFUNCTIONS
@@ -40,6 +40,9 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+#include <cmath>
+
 namespace Opm {
 
 /*!
@@ -106,34 +109,49 @@ public:
 
         const auto& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
         const auto& problem = elemCtx.problem();
-        Scalar flashTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, FlashTolerance);
+        static const auto flashTolerance = EWOMS_GET_PARAM_HANDLE(TypeTag, Scalar, FlashTolerance);
+        static const auto flashReuseTolerance = EWOMS_GET_PARAM_HANDLE(TypeTag, Scalar, FlashReuseTolerance);
 
         // extract the total molar densities of the components
         ComponentVector cTotal;
-        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
             cTotal[compIdx] = priVars.makeEvaluation(cTot0Idx + compIdx, timeIdx);
-
-        const auto *hint = elemCtx.thermodynamicHint(dofIdx, timeIdx);
-        if (hint) {
-            // use the same fluid state as the one of the hint, but
-            // make sure that we don't overwrite the temperature
-            // specified by the primary variables
-            Evaluation T = fluidState_.temperature(/*phaseIdx=*/0);
-            fluidState_.assign(hint->fluidState());
-            fluidState_.setTemperature(T);
+            flashTotalConcentrations_[compIdx] = getValue(cTotal[compIdx]);
         }
-        else
-            FlashSolver::guessInitial(fluidState_, cTotal);
 
-        // compute the phase compositions, densities and pressures
         typename FluidSystem::template ParameterCache<Evaluation> paramCache;
         const MaterialLawParams& materialParams =
             problem.materialLawParams(elemCtx, dofIdx, timeIdx);
-        FlashSolver::template solve<MaterialLaw>(fluidState_,
-                                                 materialParams,
-                                                 paramCache,
-                                                 cTotal,
-                                                 flashTolerance);
+
+        const auto *hint = elemCtx.thermodynamicHint(dofIdx, timeIdx);
+        if (hint && hint->flashInputMatches_(flashTotalConcentrations_,
+                                              getValue(fluidState_.temperature(/*phaseIdx=*/0)),
+                                              *flashReuseTolerance))
+        {
+            // the hint has been calculated for the same total concentrations and
+            // temperature, so the flash would yield the same result
+            fluidState_.assign(hint->fluidState());
+            paramCache.updateAll(fluidState_);
+        }
+        else {
+            if (hint) {
+                // use the same fluid state as the one of the hint, but
+                // make sure that we don't overwrite the temperature
+                // specified by the primary variables
+                Evaluation T = fluidState_.temperature(/*phaseIdx=*/0);
+                fluidState_.assign(hint->fluidState());
+                fluidState_.setTemperature(T);
+            }
+            else
+                FlashSolver::guessInitial(fluidState_, cTotal);
+
+            // compute the phase compositions, densities and pressures
+            FlashSolver::template solve<MaterialLaw>(fluidState_,
+                                                     materialParams,
+                                                     paramCache,
+                                                     cTotal,
+                                                     *flashTolerance);
+        }
 
         // calculate relative permeabilities
         MaterialLaw::relativePermeabilities(relativePermeability_,
@@ -205,7 +223,28 @@ public:
     { return porosity_; }
 
 private:
+    // returns true if the flash of these intensive quantities has been calculated for
+    // the same total concentrations and temperature within a relative tolerance
+    template <class ScalarVector>
+    bool flashInputMatches_(const ScalarVector& cTotal, Scalar T, Scalar tolerance) const
+    {
+        auto matches = [tolerance](Scalar a, Scalar b)
+        { return std::abs(a - b) <= tolerance*std::max(std::abs(a), std::abs(b)); };
+
+        if (!matches(getValue(fluidState_.temperature(/*phaseIdx=*/0)), T))
+            return false;
+
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            if (!matches(flashTotalConcentrations_[compIdx], cTotal[compIdx]))
+                return false;
+
+        return true;
+    }
+
     DimMatrix intrinsicPerm_;
+    // the total molar concentrations of the components for which the flash has been
+    // calculated
+    Dune::FieldVector<Scalar, numComponents> flashTotalConcentrations_;
     FluidState fluidState_;
     Evaluation porosity_;
     Evaluation relativePermeability_[numPhases];
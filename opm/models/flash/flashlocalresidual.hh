@@ -135,6 +135,10 @@ public:
 
         unsigned focusDofIdx = elemCtx.focusDofIndex();
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            // immobile phases do not transport anything
+            if (extQuants.phaseIsImmobile(phaseIdx))
+                continue;
+
             // data attached to upstream and the finite volume of the current phase
             unsigned upIdx = static_cast<unsigned>(extQuants.upstreamIndex(phaseIdx));
             const IntensiveQuantities& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
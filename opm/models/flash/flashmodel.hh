@@ -84,6 +84,15 @@ struct FlashTolerance<TypeTag, TTag::FlashModel>
     static constexpr type value = -1.0;
 };
 
+//! Only reuse the result of a flash calculation if its input did not change
+//! significantly
+template<class TypeTag>
+struct FlashReuseTolerance<TypeTag, TTag::FlashModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-12;
+};
+
 //! the Model property
 template<class TypeTag>
 struct Model<TypeTag, TTag::FlashModel> { using type = Opm::FlashModel<TypeTag>; };
@@ -237,6 +246,10 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, FlashTolerance,
                              "The maximum tolerance for the flash solver to "
                              "consider the solution converged");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, FlashReuseTolerance,
+                             "The relative change of the total concentrations and of the "
+                             "temperature of a degree of freedom below which the result of "
+                             "its last flash calculation is reused");
     }
 
     /*!
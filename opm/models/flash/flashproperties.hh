@@ -43,6 +43,10 @@ struct FlashSolver { using type = UndefinedProperty; };
 //! The maximum accepted error of the flash solver
 template<class TypeTag, class MyTypeTag>
 struct FlashTolerance { using type = UndefinedProperty; };
+//! The relative change of the total concentrations and of the temperature of a degree
+//! of freedom below which the result of its last flash calculation is reused
+template<class TypeTag, class MyTypeTag>
+struct FlashReuseTolerance { using type = UndefinedProperty; };
 
 } // namespace Opm::Properties
 
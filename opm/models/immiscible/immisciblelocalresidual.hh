@@ -138,6 +138,10 @@ public:
         ////////
         unsigned focusDofIdx = elemCtx.focusDofIndex();
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            // immobile phases do not transport anything
+            if (extQuants.phaseIsImmobile(phaseIdx))
+                continue;
+
             // data attached to upstream DOF of the current phase.
             unsigned upIdx = static_cast<unsigned>(extQuants.upstreamIndex(phaseIdx));
 
@@ -0,0 +1,358 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ImmiscibleSequentialNewtonMethod
+ */
+#ifndef EWOMS_IMMISCIBLE_SEQUENTIAL_NEWTON_METHOD_HH
+#define EWOMS_IMMISCIBLE_SEQUENTIAL_NEWTON_METHOD_HH
+
+#include "immiscibleproperties.hh"
+
+#include <opm/models/nonlinear/newtonmethod.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <opm/material/common/Exceptions.hpp>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace Opm {
+template <class TypeTag>
+class ImmiscibleSequentialNewtonMethod;
+}
+
+namespace Opm::Properties {
+
+namespace TTag {
+//! Type tag which makes an immiscible problem solve the linearized systems of
+//! equations of its Newton iterations sequentially for pressure and transport. It
+//! must be listed before the other type tags of the problem.
+struct ImmiscibleSequentialModel {};
+} // end namespace TTag
+
+template <class TypeTag, class MyTypeTag>
+struct DiscNewtonMethod;
+
+//! The number of Gauss-Seidel sweeps of the transport stage
+template<class TypeTag, class MyTypeTag>
+struct SequentialTransportSweeps { using type = UndefinedProperty; };
+
+//! The relative reduction of the residual of the pressure stage
+template<class TypeTag, class MyTypeTag>
+struct SequentialPressureTolerance { using type = UndefinedProperty; };
+
+//! The maximum number of linear iterations of the pressure stage
+template<class TypeTag, class MyTypeTag>
+struct SequentialPressureMaxIterations { using type = UndefinedProperty; };
+
+template<class TypeTag>
+struct NewtonMethod<TypeTag, TTag::ImmiscibleSequentialModel>
+{ using type = Opm::ImmiscibleSequentialNewtonMethod<TypeTag>; };
+
+template<class TypeTag>
+struct SequentialTransportSweeps<TypeTag, TTag::ImmiscibleSequentialModel>
+{ static constexpr int value = 3; };
+
+template<class TypeTag>
+struct SequentialPressureTolerance<TypeTag, TTag::ImmiscibleSequentialModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-3;
+};
+
+template<class TypeTag>
+struct SequentialPressureMaxIterations<TypeTag, TTag::ImmiscibleSequentialModel>
+{ static constexpr int value = 200; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+
+/*!
+ * \ingroup ImmiscibleModel
+ *
+ * \brief A Newton method for the immiscible model which solves the linearized systems
+ *        of equations sequentially for pressure and transport.
+ *
+ * Instead of solving the fully coupled linear system of each Newton iteration, the
+ * update is determined in two stages:
+ *
+ * - Pressure: A scalar pressure system is extracted by weighting the equations of each
+ *   degree of freedom such that its diagonal block only couples to the pressure
+ *   ("quasi-IMPES" weights). This system is solved using an AMG preconditioned
+ *   BiCGSTAB solver.
+ * - Transport: Starting from the pressure correction, the update of each degree of
+ *   freedom is calculated implicitly using its own diagonal block while the updates of
+ *   its neighbors are lagged. This amounts to a few Gauss-Seidel sweeps over the grid.
+ *
+ * Since the residual is always evaluated fully implicitly, the Newton method converges
+ * to the same solution as the fully coupled one, but each iteration is much cheaper.
+ * For strongly coupled or transport dominated problems more Newton iterations may be
+ * required, though. If the simulation uses more than a single process, the linear
+ * solver of the model is used.
+ */
+template <class TypeTag>
+class ImmiscibleSequentialNewtonMethod : public GetPropType<TypeTag, Properties::DiscNewtonMethod>
+{
+    using ParentType = GetPropType<TypeTag, Properties::DiscNewtonMethod>;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { pressure0Idx = Indices::pressure0Idx };
+
+    using BlockVector = Dune::FieldVector<Scalar, numEq>;
+    using BlockMatrix = Dune::FieldMatrix<Scalar, numEq, numEq>;
+
+    using PressureMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, 1, 1> >;
+    using PressureVector = Dune::BlockVector<Dune::FieldVector<Scalar, 1> >;
+    using PressureOperator = Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector>;
+    using PressureSmoother = Dune::SeqSSOR<PressureMatrix, PressureVector, PressureVector>;
+    using PressureAmg = Dune::Amg::AMG<PressureOperator, PressureVector, PressureSmoother>;
+
+public:
+    ImmiscibleSequentialNewtonMethod(Simulator& simulator)
+        : ParentType(simulator)
+    {
+        numTransportSweeps_ = EWOMS_GET_PARAM(TypeTag, unsigned, SequentialTransportSweeps);
+        pressureTolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, SequentialPressureTolerance);
+        pressureMaxIterations_ = EWOMS_GET_PARAM(TypeTag, int, SequentialPressureMaxIterations);
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the Newton method.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, SequentialTransportSweeps,
+                             "The number of Gauss-Seidel sweeps over the grid which are "
+                             "used to determine the update of the saturations");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, SequentialPressureTolerance,
+                             "The relative reduction of the residual of the pressure "
+                             "system which is required in each Newton iteration");
+        EWOMS_REGISTER_PARAM(TypeTag, int, SequentialPressureMaxIterations,
+                             "The maximum number of linear iterations used to solve the "
+                             "pressure system");
+    }
+
+protected:
+    friend NewtonMethod<TypeTag>;
+
+    /*!
+     * \copydoc NewtonMethod::solveLinear_
+     */
+    bool solveLinear_(const SolutionVector& u,
+                      const GlobalEqVector& b,
+                      GlobalEqVector& x)
+    {
+        // the overlap of the domain decomposition is only known to the linear solver
+        if (this->comm_.size() > 1)
+            return ParentType::solveLinear_(u, b, x);
+
+        const auto& A = this->model().linearizer().jacobian().istlMatrix();
+        size_t n = A.N();
+
+        computeWeights_(A);
+        extractPressureSystem_(A, b);
+
+        // pressure stage
+        PressureOperator pressureOperator(*pressureMatrix_);
+        PressureAmg pressureAmg(pressureOperator, pressureCriterion_(), pressureSmootherArgs_());
+        Dune::BiCGSTABSolver<PressureVector> pressureSolver(pressureOperator,
+                                                            pressureAmg,
+                                                            pressureTolerance_,
+                                                            pressureMaxIterations_,
+                                                            /*verbose=*/0);
+        Dune::InverseOperatorResult pressureResult;
+        pressureSol_ = 0.0;
+        pressureSolver.apply(pressureSol_, pressureRhs_, pressureResult);
+        if (!std::isfinite(pressureSol_.two_norm()))
+            return false;
+
+        if (this->verbose_())
+            this->endIterMsg() << ", " << pressureResult.iterations << " pressure iterations";
+
+        for (unsigned i = 0; i < n; ++i) {
+            x[i] = 0.0;
+            x[i][pressure0Idx] = pressureSol_[i][0];
+        }
+
+        // transport stage: update each degree of freedom implicitly using the lagged
+        // updates of its neighbors
+        invDiag_.resize(n);
+        for (unsigned i = 0; i < n; ++i) {
+            invDiag_[i] = A[i][i];
+            try {
+                invDiag_[i].invert();
+            }
+            catch (const Dune::FMatrixError&) {
+                throw NumericalIssue("Singular diagonal block in the transport stage of "
+                                     "the sequential Newton method");
+            }
+        }
+
+        BlockVector rhs;
+        for (unsigned sweepIdx = 0; sweepIdx < numTransportSweeps_; ++sweepIdx) {
+            for (unsigned i = 0; i < n; ++i) {
+                rhs = b[i];
+                const auto& row = A[i];
+                const auto& colEndIt = row.end();
+                for (auto colIt = row.begin(); colIt != colEndIt; ++colIt) {
+                    if (colIt.index() != i)
+                        colIt->mmv(x[colIt.index()], rhs);
+                }
+
+                invDiag_[i].mv(rhs, x[i]);
+            }
+        }
+
+        return std::isfinite(x.two_norm());
+    }
+
+private:
+    template <class Matrix>
+    void computeWeights_(const Matrix& A)
+    {
+        size_t n = A.N();
+        weights_.resize(n);
+
+        BlockVector unitVector(0.0);
+        unitVector[pressure0Idx] = 1.0;
+        for (unsigned rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const auto& diag = A[rowIdx][rowIdx];
+
+            BlockMatrix diagT;
+            for (int i = 0; i < numEq; ++i)
+                for (int j = 0; j < numEq; ++j)
+                    diagT[i][j] = diag[j][i];
+
+            try {
+                diagT.solve(weights_[rowIdx], unitVector);
+            }
+            catch (const Dune::FMatrixError&) {
+                // the diagonal block is singular. fall back to taking the sum of all
+                // equations
+                weights_[rowIdx] = 1.0;
+            }
+
+            // normalize the weights so that the scaling of the pressure system does not
+            // depend on the magnitude of the diagonal
+            Scalar maxWeight = weights_[rowIdx].infinity_norm();
+            if (maxWeight > 0.0)
+                weights_[rowIdx] /= maxWeight;
+        }
+    }
+
+    template <class Matrix>
+    void extractPressureSystem_(const Matrix& A, const GlobalEqVector& b)
+    {
+        size_t n = A.N();
+
+        // the sparsity pattern of the pressure matrix is the same as the one of the full
+        // system. it only needs to be recreated if the grid has changed
+        if (!pressureMatrix_ || pressureMatrix_->N() != n || pressureMatrix_->nonzeroes() != A.nonzeroes()) {
+            pressureMatrix_ = std::make_unique<PressureMatrix>(n, n, A.nonzeroes(), PressureMatrix::row_wise);
+
+            auto rowIt = pressureMatrix_->createbegin();
+            const auto& rowEndIt = pressureMatrix_->createend();
+            for (; rowIt != rowEndIt; ++rowIt) {
+                const auto& row = A[rowIt.index()];
+                const auto& colEndIt = row.end();
+                for (auto colIt = row.begin(); colIt != colEndIt; ++colIt)
+                    rowIt.insert(colIt.index());
+            }
+
+            pressureRhs_.resize(n);
+            pressureSol_.resize(n);
+        }
+
+        // p_ij = w_i^T A_ij e_p, b_i = w_i^T r_i
+        for (unsigned rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const auto& row = A[rowIdx];
+            const auto& colEndIt = row.end();
+            for (auto colIt = row.begin(); colIt != colEndIt; ++colIt) {
+                Scalar value = 0.0;
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    value += weights_[rowIdx][eqIdx]*(*colIt)[eqIdx][pressure0Idx];
+                (*pressureMatrix_)[rowIdx][colIt.index()] = value;
+            }
+
+            pressureRhs_[rowIdx] = weights_[rowIdx]*b[rowIdx];
+        }
+    }
+
+    auto pressureCriterion_() const
+    {
+        using CoarsenCriterion = Dune::Amg::
+            CoarsenCriterion<Dune::Amg::SymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal> >;
+        CoarsenCriterion coarsenCriterion(/*maxLevel=*/15, /*coarsenTarget=*/2000);
+        coarsenCriterion.setDefaultValuesIsotropic(/*dim=*/3, /*aggregateSizePerDim=*/2);
+        coarsenCriterion.setDebugLevel(0); // make the AMG shut up
+        coarsenCriterion.setMinCoarsenRate(1.05);
+        coarsenCriterion.setAccumulate(Dune::Amg::atOnceAccu);
+        coarsenCriterion.setSkipIsolated(false);
+        return coarsenCriterion;
+    }
+
+    auto pressureSmootherArgs_() const
+    {
+        typename Dune::Amg::SmootherTraits<PressureSmoother>::Arguments smootherArgs;
+        smootherArgs.iterations = 1;
+        smootherArgs.relaxationFactor = 1.0;
+        return smootherArgs;
+    }
+
+    unsigned numTransportSweeps_;
+    Scalar pressureTolerance_;
+    int pressureMaxIterations_;
+
+    std::vector<BlockVector> weights_;
+    std::vector<BlockMatrix> invDiag_;
+    std::unique_ptr<PressureMatrix> pressureMatrix_;
+    PressureVector pressureRhs_;
+    PressureVector pressureSol_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,318 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ArtReader
+ */
+#ifndef EWOMS_ART_READER_HH
+#define EWOMS_ART_READER_HH
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Reads two-dimensional grids with fractures in the ART file format.
+ *
+ * The file is read into memory at once and then parsed in place, i.e., without
+ * creating a string stream for each line. The result is the list of vertices, the
+ * list of triangles given by their vertex indices and the list of fracture edges,
+ * which can be used to create a grid and its fracture mapper directly.
+ */
+class ArtReader
+{
+    enum ParseMode { VertexSection, EdgeSection, ElementSection, Finished };
+
+public:
+    using Coordinate = std::array<double, 2>;
+    using Edge = std::pair<unsigned, unsigned>;
+    using Triangle = std::array<unsigned, 3>;
+
+    /*!
+     * \brief Reads an ART file.
+     *
+     * \param artFileName The name of the file to read
+     */
+    void read(const std::string& artFileName)
+    {
+        readBuffer_(artFileName);
+
+        vertices_.clear();
+        isFractureVertex_.clear();
+        edges_.clear();
+        fractureEdges_.clear();
+        elements_.clear();
+
+        ParseMode parseMode = VertexSection;
+        const char* pos = buffer_.data();
+        const char* end = buffer_.data() + buffer_.size() - 1; // skip the terminating '\0'
+        unsigned lineIdx = 0;
+        while (pos < end) {
+            ++lineIdx;
+            const char* lineEnd = std::find(pos, end, '\n');
+
+            // remove comments
+            const char* contentEnd = std::find(pos, lineEnd, '%');
+            parseLine_(parseMode, pos, contentEnd, lineIdx);
+
+            pos = lineEnd + 1;
+        }
+
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+    }
+
+    /*!
+     * \brief The coordinates of all vertices.
+     */
+    const std::vector<Coordinate>& vertices() const
+    { return vertices_; }
+
+    /*!
+     * \brief Returns true iff a vertex is located on a fracture.
+     */
+    bool isFractureVertex(unsigned vertexIdx) const
+    { return isFractureVertex_[vertexIdx]; }
+
+    /*!
+     * \brief The vertex indices of all edges which carry a fracture.
+     */
+    const std::vector<Edge>& fractureEdges() const
+    { return fractureEdges_; }
+
+    /*!
+     * \brief The vertex indices of all triangles.
+     *
+     * The vertices of each triangle are ordered in mathematically positive
+     * direction.
+     */
+    const std::vector<Triangle>& elements() const
+    { return elements_; }
+
+private:
+    void readBuffer_(const std::string& artFileName)
+    {
+        std::ifstream inStream(artFileName, std::ios::binary);
+        if (!inStream.is_open())
+            throw std::runtime_error("File '"+artFileName
+                                     +"' does not exist or is not readable");
+
+        inStream.seekg(0, std::ios::end);
+        std::streamoff fileSize = inStream.tellg();
+        inStream.seekg(0, std::ios::beg);
+
+        buffer_.resize(static_cast<size_t>(fileSize) + 1);
+        inStream.read(buffer_.data(), fileSize);
+        if (inStream.gcount() != fileSize)
+            throw std::runtime_error("Could not read file '"+artFileName+"'");
+
+        // the number parsing functions need a terminated string
+        buffer_.back() = '\0';
+    }
+
+    static const char* skipSpace_(const char* pos, const char* end)
+    {
+        while (pos < end && std::isspace(static_cast<unsigned char>(*pos)))
+            ++pos;
+        return pos;
+    }
+
+    [[noreturn]] static void throwParseError_(unsigned lineIdx, const std::string& msg)
+    { throw std::runtime_error("Line "+std::to_string(lineIdx)+" of the ART file: "+msg); }
+
+    void parseLine_(ParseMode& parseMode, const char* pos, const char* end, unsigned lineIdx)
+    {
+        pos = skipSpace_(pos, end);
+
+        // remove trailing whitespace
+        while (end > pos && std::isspace(static_cast<unsigned char>(*(end - 1))))
+            --end;
+
+        // skip empty lines
+        if (pos == end)
+            return;
+
+        // a section of the file is finished, go to the next one
+        if (end - pos == 1 && *pos == '$') {
+            if (parseMode == VertexSection)
+                parseMode = EdgeSection;
+            else if (parseMode == EdgeSection)
+                parseMode = ElementSection;
+            else if (parseMode == ElementSection)
+                parseMode = Finished;
+            return;
+        }
+
+        if (parseMode == VertexSection)
+            parseVertex_(pos, end, lineIdx);
+        else if (parseMode == EdgeSection)
+            parseEdge_(pos, end, lineIdx);
+        else if (parseMode == ElementSection)
+            parseElement_(pos, end, lineIdx);
+        else
+            throwParseError_(lineIdx, "Unexpected content after the last section");
+    }
+
+    void parseVertex_(const char* pos, const char* end, unsigned lineIdx)
+    {
+        // parse only the first two numbers as the vertex coordinate. the last number
+        // is the Z coordinate which we ignore (so far)
+        Coordinate coord;
+        for (unsigned i = 0; i < 2; ++i) {
+            // strtod() skips newlines, so make sure not to leave the current line
+            pos = skipSpace_(pos, end);
+            if (pos == end)
+                throwParseError_(lineIdx, "Missing vertex coordinate");
+
+            char* next;
+            coord[i] = std::strtod(pos, &next);
+            if (next == pos)
+                throwParseError_(lineIdx, "Invalid vertex coordinate");
+            pos = next;
+        }
+
+        vertices_.push_back(coord);
+        isFractureVertex_.push_back(0);
+    }
+
+    // parses the "DATA : IDX1 IDX2 ..." lines of the edge and element sections
+    template <class IndexArray>
+    static unsigned parseIndices_(IndexArray& indices,
+                                  int& dataVal,
+                                  const char* pos,
+                                  const char* end,
+                                  unsigned lineIdx)
+    {
+        char* next;
+        dataVal = static_cast<int>(std::strtol(pos, &next, 10));
+        if (next == pos)
+            throwParseError_(lineIdx, "Missing data value");
+
+        pos = skipSpace_(next, end);
+        if (pos == end || *pos != ':')
+            throwParseError_(lineIdx, "Expected ':'");
+        ++pos;
+
+        unsigned numIndices = 0;
+        while ((pos = skipSpace_(pos, end)) < end) {
+            long idx = std::strtol(pos, &next, 10);
+            if (next == pos || idx < 0)
+                throwParseError_(lineIdx, "Invalid index");
+            if (numIndices >= indices.size())
+                throwParseError_(lineIdx, "Too many indices");
+            indices[numIndices++] = static_cast<unsigned>(idx);
+            pos = next;
+        }
+
+        return numIndices;
+    }
+
+    void parseEdge_(const char* pos, const char* end, unsigned lineIdx)
+    {
+        // read the data attached to the edge and its vertex indices
+        std::array<unsigned, 2> vertIndices;
+        int dataVal;
+        if (parseIndices_(vertIndices, dataVal, pos, end, lineIdx) != 2)
+            throwParseError_(lineIdx, "An edge needs exactly two vertices");
+
+        if (vertIndices[0] >= vertices_.size() || vertIndices[1] >= vertices_.size())
+            throwParseError_(lineIdx, "Invalid vertex index");
+
+        Edge edge(vertIndices[0], vertIndices[1]);
+        edges_.push_back(edge);
+
+        // negative data values mark fractures
+        if (dataVal < 0) {
+            fractureEdges_.push_back(edge);
+            isFractureVertex_[edge.first] = 1;
+            isFractureVertex_[edge.second] = 1;
+        }
+    }
+
+    void parseElement_(const char* pos, const char* end, unsigned lineIdx)
+    {
+        // skip the data attached to an element and read its edge indices. so far, we
+        // only support triangles
+        std::array<unsigned, 3> edgeIndices;
+        int dataVal;
+        if (parseIndices_(edgeIndices, dataVal, pos, end, lineIdx) != 3)
+            throwParseError_(lineIdx, "Only triangles are supported");
+
+        // extract the vertex indices of the element
+        Triangle vertIndices;
+        unsigned numVertices = 0;
+        for (unsigned i = 0; i < 3; ++i) {
+            if (edgeIndices[i] >= edges_.size())
+                throwParseError_(lineIdx, "Invalid edge index");
+
+            const auto& edge = edges_[edgeIndices[i]];
+            for (unsigned vertIdx : {edge.first, edge.second}) {
+                if (std::find(vertIndices.begin(), vertIndices.begin() + numVertices, vertIdx)
+                    != vertIndices.begin() + numVertices)
+                    continue;
+                if (numVertices == 3)
+                    throwParseError_(lineIdx, "The edges do not form a triangle");
+                vertIndices[numVertices++] = vertIdx;
+            }
+        }
+        if (numVertices != 3)
+            throwParseError_(lineIdx, "The edges do not form a triangle");
+
+        // check whether the element's vertices are given in mathematically positive
+        // direction. if not, swap the last two.
+        const auto& x0 = vertices_[vertIndices[0]];
+        const auto& x1 = vertices_[vertIndices[1]];
+        const auto& x2 = vertices_[vertIndices[2]];
+        double det =
+            (x1[0] - x0[0])*(x2[1] - x0[1])
+            - (x1[1] - x0[1])*(x2[0] - x0[0]);
+        if (std::abs(det) <= 1e-50)
+            throwParseError_(lineIdx, "Degenerate triangle");
+        if (det < 0)
+            std::swap(vertIndices[2], vertIndices[1]);
+
+        elements_.push_back(vertIndices);
+    }
+
+    std::vector<char> buffer_;
+
+    std::vector<Coordinate> vertices_;
+    std::vector<unsigned char> isFractureVertex_;
+    std::vector<Edge> edges_;
+    std::vector<Edge> fractureEdges_;
+    std::vector<Triangle> elements_;
+};
+
+} // namespace Opm
+
+#endif
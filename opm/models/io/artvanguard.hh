@@ -0,0 +1,242 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ArtVanguard
+ */
+#ifndef EWOMS_ART_VANGUARD_HH
+#define EWOMS_ART_VANGUARD_HH
+
+#include <opm/models/discretefracture/fracturemapper.hh>
+#include <opm/models/io/artreader.hh>
+#include <opm/models/io/basevanguard.hh>
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/parametersystem.hh>
+
+#include <dune/grid/common/gridfactory.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/geometry/type.hh>
+#include <dune/common/fvector.hh>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <cassert>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Provides a simulator vanguard which creates a two-dimensional grid with
+ *        fractures by reading a file in the ART format.
+ *
+ * Compared to converting the ART file to DGF using the art2dgf utility and loading
+ * the result with the DgfVanguard, this avoids writing and parsing the intermediate
+ * file: The grid is created using the grid factory and the fracture mapper is filled
+ * directly from the fracture edges of the ART file.
+ */
+template <class TypeTag>
+class ArtVanguard : public BaseVanguard<TypeTag>
+{
+    using ParentType = BaseVanguard<TypeTag>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Grid = GetPropType<TypeTag, Properties::Grid>;
+    using FractureMapper = Opm::FractureMapper<TypeTag>;
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<typename Grid::LevelGridView>;
+
+    using GridPointer = std::unique_ptr<Grid>;
+    using CoordScalar = typename Grid::ctype;
+    using GlobalPosition = Dune::FieldVector<CoordScalar, Grid::dimensionworld>;
+
+    static_assert(Grid::dimension == 2 && Grid::dimensionworld == 2,
+                  "The ART file format only supports two-dimensional grids");
+
+public:
+    /*!
+     * \brief Register all run-time parameters for the ART simulator vanguard.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, GridFile,
+                             "The file name of the ART file to load");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, GridGlobalRefinements,
+                             "The number of global refinements of the grid "
+                             "executed after it was loaded");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, FractureElementLoadWeight,
+                             "The cost of an element cut by a fracture relative to the "
+                             "one of the remaining elements for load balancing");
+    }
+
+    /*!
+     * \brief Load the grid from the file.
+     */
+    ArtVanguard(Simulator& simulator)
+        : ParentType(simulator)
+    {
+        const std::string artFileName = EWOMS_GET_PARAM(TypeTag, std::string, GridFile);
+        unsigned numRefinments = EWOMS_GET_PARAM(TypeTag, unsigned, GridGlobalRefinements);
+        fractureElementLoadWeight_ = EWOMS_GET_PARAM(TypeTag, Scalar, FractureElementLoadWeight);
+
+        int myRank = 0;
+#if HAVE_MPI
+        MPI_Comm_rank(MPI_COMM_WORLD, &myRank);
+#endif
+
+        // like for the DGF parser, the grid is created on the first process and
+        // distributed by loadBalance()
+        ArtReader artReader;
+        if (myRank == 0)
+            artReader.read(artFileName);
+
+        Dune::GridFactory<Grid> factory;
+        for (const auto& coord : artReader.vertices()) {
+            GlobalPosition pos;
+            pos[0] = coord[0];
+            pos[1] = coord[1];
+            factory.insertVertex(pos);
+        }
+
+        std::vector<unsigned> elemVertices(3);
+        for (const auto& triangle : artReader.elements()) {
+            std::copy(triangle.begin(), triangle.end(), elemVertices.begin());
+            factory.insertElement(Dune::GeometryTypes::simplex(2), elemVertices);
+        }
+
+        gridPtr_ = factory.createGrid();
+
+        addFractures_(factory, artReader);
+
+        if (numRefinments > 0)
+            gridPtr_->globalRefine(static_cast<int>(numRefinments));
+
+        this->finalizeInit_();
+    }
+
+    /*!
+     * \brief Returns a reference to the grid.
+     */
+    Grid& grid()
+    { return *gridPtr_; }
+
+    /*!
+     * \brief Returns a reference to the grid.
+     */
+    const Grid& grid() const
+    { return *gridPtr_; }
+
+    /*!
+     * \brief Distributes the grid on all processes of a parallel
+     *        computation.
+     */
+    void loadBalance()
+    {
+        // the weights of the elements are determined using the vertex numbering of
+        // the macro grid, i.e., the one of the fracture mapper
+        if (useWeightedLoadBalancing())
+            macroVertexMapper_.reset(new VertexMapper(gridPtr_->levelGridView(/*level=*/0),
+                                                      Dune::mcmgVertexLayout()));
+
+        this->loadBalanceGrid_();
+        macroVertexMapper_.reset();
+    }
+
+    /*!
+     * \brief Returns true if the elements which are cut by fractures are more
+     *        expensive than the others.
+     */
+    bool useWeightedLoadBalancing() const
+    { return fractureElementLoadWeight_ != 1.0 && fractureMapper_.numFractureEdges() > 0; }
+
+    /*!
+     * \brief Returns the relative cost of an element of the macro grid.
+     */
+    template <class Element>
+    double elementLoadWeight(const Element& elem) const
+    {
+        assert(macroVertexMapper_);
+        for (unsigned vertexIdx = 0; vertexIdx < elem.subEntities(Grid::dimension); ++vertexIdx) {
+            unsigned globalIdx = static_cast<unsigned>(
+                macroVertexMapper_->subIndex(elem, vertexIdx, Grid::dimension));
+            if (fractureMapper_.isFractureVertex(globalIdx))
+                return fractureElementLoadWeight_;
+        }
+
+        return 1.0;
+    }
+
+    /*!
+     * \brief Returns the fracture mapper
+     *
+     * The fracture mapper determines the topology of the fractures.
+     */
+    FractureMapper& fractureMapper()
+    { return fractureMapper_; }
+
+    /*!
+     * \brief Returns the fracture mapper
+     *
+     * The fracture mapper determines the topology of the fractures.
+     */
+    const FractureMapper& fractureMapper() const
+    { return fractureMapper_; }
+
+protected:
+    void addFractures_(const Dune::GridFactory<Grid>& factory, const ArtReader& artReader)
+    {
+        using LevelGridView = typename Grid::LevelGridView;
+
+        const auto& fractureEdges = artReader.fractureEdges();
+        if (fractureEdges.empty())
+            return;
+
+        // the vertices of the grid are not necessarily numbered in the order in which
+        // they were inserted, so map the indices of the ART file to the ones of the
+        // vertex mapper
+        LevelGridView gridView = gridPtr_->levelGridView(/*level=*/0);
+        VertexMapper vertexMapper(gridView, Dune::mcmgVertexLayout());
+        std::vector<unsigned> artToMapperIdx(artReader.vertices().size());
+        for (const auto& vertex : vertices(gridView))
+            artToMapperIdx[factory.insertionIndex(vertex)] =
+                static_cast<unsigned>(vertexMapper.index(vertex));
+
+        for (const auto& edge : fractureEdges)
+            fractureMapper_.addFractureEdge(artToMapperIdx[edge.first],
+                                            artToMapperIdx[edge.second]);
+        fractureMapper_.finalize();
+    }
+
+private:
+    GridPointer    gridPtr_;
+    FractureMapper fractureMapper_;
+    Scalar fractureElementLoadWeight_;
+    std::unique_ptr<VertexMapper> macroVertexMapper_;
+};
+
+} // namespace Opm
+
+#endif
@@ -38,6 +38,7 @@
 #include <dune/istl/bvector.hh>
 #include <dune/common/fvector.hh>
 
+#include <map>
 #include <vector>
 #include <sstream>
 #include <string>
@@ -100,6 +101,7 @@ public:
 
     BaseOutputModule(const Simulator& simulator)
         : simulator_(simulator)
+        , concurrentOutput_(false)
     {}
 
     virtual ~BaseOutputModule()
@@ -143,6 +145,50 @@ public:
     virtual bool needExtensiveQuantities() const
     { return false; }
 
+    /*!
+     * \brief Returns true iff processElement() modifies the buffers of degrees of
+     *        freedom which are not primary degrees of freedom of the element.
+     *
+     * The elements are then passed to the module under a lock. By default, this is
+     * assumed to be the case if the module needs the extensive quantities.
+     */
+    virtual bool writesNeighborDofs() const
+    { return needExtensiveQuantities(); }
+
+    /*!
+     * \brief Specify whether the output fields are prepared from a snapshot of the
+     *        solution by a thread which runs concurrently to the simulation.
+     *
+     * In this case, the module must not use any state of the model besides the
+     * solution because the simulation may modify it at the same time. This is called
+     * before allocBuffers().
+     */
+    void setConcurrentOutput(bool yesno)
+    { concurrentOutput_ = yesno; }
+
+    /*!
+     * \brief Returns true iff the module writes at least one field.
+     *
+     * Modules for which this returns false are skipped entirely when the output fields
+     * are prepared, i.e., neither their buffers are allocated nor are the elements
+     * passed to processElement(). Since this is only safe if the module knows about all
+     * of its fields, this method returns 'true' by default.
+     */
+    virtual bool hasEnabledFields() const
+    { return true; }
+
+    /*!
+     * \brief Returns the number of bytes held by the buffers which were allocated
+     *        using the resize methods of this class.
+     */
+    size_t bufferMemory() const
+    {
+        size_t result = 0;
+        for (const auto& entry : bufferMemory_)
+            result += entry.second;
+        return result;
+    }
+
 protected:
     enum BufferType {
         //! Buffer contains data associated with the degrees of freedom
@@ -173,6 +219,7 @@ protected:
 
         buffer.resize(n);
         std::fill(buffer.begin(), buffer.end(), 0.0);
+        bufferMemory_[&buffer] = n*sizeof(ScalarBuffer::value_type);
     }
 
     /*!
@@ -194,6 +241,8 @@ protected:
         buffer.resize(n);
         Tensor nullMatrix(dimWorld, dimWorld, 0.0);
         std::fill(buffer.begin(), buffer.end(), nullMatrix);
+        bufferMemory_[&buffer] =
+            n*(sizeof(Tensor) + dimWorld*dimWorld*sizeof(ScalarBuffer::value_type));
     }
 
     /*!
@@ -217,6 +266,7 @@ protected:
             buffer[i].resize(n);
             std::fill(buffer[i].begin(), buffer[i].end(), 0.0);
         }
+        bufferMemory_[&buffer] = numEq*n*sizeof(ScalarBuffer::value_type);
     }
 
     /*!
@@ -240,6 +290,7 @@ protected:
             buffer[i].resize(n);
             std::fill(buffer[i].begin(), buffer[i].end(), 0.0);
         }
+        bufferMemory_[&buffer] = numPhases*n*sizeof(ScalarBuffer::value_type);
     }
 
     /*!
@@ -263,6 +314,7 @@ protected:
             buffer[i].resize(n);
             std::fill(buffer[i].begin(), buffer[i].end(), 0.0);
         }
+        bufferMemory_[&buffer] = numComponents*n*sizeof(ScalarBuffer::value_type);
     }
 
     /*!
@@ -288,6 +340,7 @@ protected:
                 std::fill(buffer[i][j].begin(), buffer[i][j].end(), 0.0);
             }
         }
+        bufferMemory_[&buffer] = numPhases*numComponents*n*sizeof(ScalarBuffer::value_type);
     }
 
     /*!
@@ -496,7 +549,16 @@ protected:
                                  const char *name)
     { baseWriter.attachTensorVertexData(buffer, name); }
 
+    bool concurrentOutput() const
+    { return concurrentOutput_; }
+
     const Simulator& simulator_;
+
+private:
+    bool concurrentOutput_;
+
+    // the number of bytes of each buffer which was resized by this class
+    std::map<const void*, size_t> bufferMemory_;
 };
 
 #if __GNUC__ || __clang__
@@ -31,18 +31,44 @@
 #include <opm/models/utils/parametersystem.hh>
 
 #include <dune/common/version.hh>
+#include <dune/grid/common/partitionset.hh>
+#include <dune/grid/common/rangegenerators.hh>
 
 #if HAVE_DUNE_FEM
 #include <dune/fem/space/common/dofmanager.hh>
 #endif
 
+#if HAVE_DUNE_ALUGRID
+#include <dune/alugrid/grid.hh>
+#endif
+
 #include <type_traits>
 #include <memory>
 
 namespace Opm {
 
+/*!
+ * \brief Specifies whether the partitioner of a grid can take per-element weights
+ *        into account.
+ */
+template <class Grid>
+struct SupportsWeightedLoadBalancing : public std::false_type {};
+
+#if HAVE_DUNE_ALUGRID
+template <int dim, int dimWorld, Dune::ALUGridElementType elType,
+          Dune::ALUGridRefinementType refinementType, class Comm>
+struct SupportsWeightedLoadBalancing<Dune::ALUGrid<dim, dimWorld, elType, refinementType, Comm> >
+    : public std::true_type {};
+#endif
+
 /*!
  * \brief Provides the base class for most (all?) simulator vanguards.
+ *
+ * If a vanguard knows that some elements are more expensive to linearize than others
+ * (e.g. because they are cut by fractures), it can override
+ * useWeightedLoadBalancing() and elementLoadWeight(). If the grid supports this, the
+ * elements of the macro grid are then distributed such that each process gets
+ * approximately the same total weight instead of the same number of elements.
  */
 template <class TypeTag>
 class BaseVanguard
@@ -106,11 +132,82 @@ public:
      */
     void loadBalance()
     {
-        asImp_().grid().loadBalance();
+        loadBalanceGrid_();
         updateGridView_();
     }
 
+#if HAVE_DUNE_FEM
+    /*!
+     * \brief Redistribute the grid after it has been adapted.
+     *
+     * In contrast to loadBalance(), the data which is registered with the DOF manager
+     * of dune-fem, i.e., the discrete functions of the restriction and prolongation
+     * operators used for the adaptation, is migrated along with the elements. The grid
+     * part and the grid view stay valid.
+     *
+     * \return true if the partition of the grid has changed
+     */
+    bool loadBalanceAdaptedGrid()
+    {
+        auto& grid = asImp_().grid();
+        return grid.loadBalance(Dune::Fem::DofManager<Grid>::instance(grid));
+    }
+#endif
+
+    /*!
+     * \brief Returns the ratio of the number of interior elements of the most loaded
+     *        process and the average number of interior elements per process.
+     *
+     * This is a collective operation.
+     */
+    double loadImbalance() const
+    {
+        double numElements = 0.0;
+        for ([[maybe_unused]] const auto& elem : elements(gridView(), Dune::Partitions::interior))
+            numElements += 1.0;
+
+        const auto& comm = gridView().comm();
+        double maxElements = comm.max(numElements);
+        double avgElements = comm.sum(numElements)/comm.size();
+        return (avgElements > 0.0) ? maxElements/avgElements : 1.0;
+    }
+
+    /*!
+     * \brief Returns true if the grid ought to be distributed using the weights of
+     *        elementLoadWeight().
+     */
+    bool useWeightedLoadBalancing() const
+    { return false; }
+
+    /*!
+     * \brief Returns the relative cost of an element of the macro grid.
+     *
+     * This is used if useWeightedLoadBalancing() returns true. By default, all elements
+     * are equally expensive.
+     */
+    template <class Element>
+    double elementLoadWeight([[maybe_unused]] const Element& elem) const
+    { return 1.0; }
+
 protected:
+    // distributes the grid, taking the weights of the elements into account if
+    // requested and possible
+    void loadBalanceGrid_()
+    {
+        auto& grid = asImp_().grid();
+        if constexpr (SupportsWeightedLoadBalancing<Grid>::value) {
+            if (asImp_().useWeightedLoadBalancing()) {
+                const auto& vanguard = asImp_();
+                auto weightFn = [&vanguard](const auto& elem) -> double
+                                { return vanguard.elementLoadWeight(elem); };
+                grid.repartition(weightFn);
+                return;
+            }
+        }
+
+        grid.loadBalance();
+    }
+
     // this method should be called after the grid has been allocated
     void finalizeInit_()
     {
@@ -28,6 +28,7 @@
 #define EWOMS_CUBE_GRID_VANGUARD_HH
 
 #include <opm/models/io/basevanguard.hh>
+#include <opm/models/io/distributedstructuredgrid.hh>
 #include <opm/models/utils/basicproperties.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
@@ -46,6 +47,10 @@ namespace Opm {
  *
  * A quadrilateral is a line segment in 1D, a rectangle in 2D and a
  * cube in 3D.
+ *
+ * For grids for which the structured grid factory is able to do so (YaspGrid and
+ * cube ALUGrids), each process only creates its own part of the grid and no load
+ * balancing is required.
  */
 template <class TypeTag>
 class CubeGridVanguard : public BaseVanguard<TypeTag>
@@ -55,7 +60,9 @@ class CubeGridVanguard : public BaseVanguard<TypeTag>
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using Grid = GetPropType<TypeTag, Properties::Grid>;
 
-    using GridPointer = std::unique_ptr<Grid>;
+    // depending on the grid, the structured grid factory returns a unique or a shared
+    // pointer
+    using GridPointer = std::shared_ptr<Grid>;
     using CoordScalar = typename Grid::ctype;
     enum { dimWorld = Grid::dimensionworld };
     using GlobalPosition = Dune::FieldVector<CoordScalar, dimWorld>;
@@ -118,6 +125,19 @@ public:
         this->finalizeInit_();
     }
 
+    /*!
+     * \brief Distribute the grid over all processes.
+     *
+     * This is a no-op if the grid was created in a distributed fashion.
+     */
+    void loadBalance()
+    {
+        if (CreatesDistributedCubeGrid<Grid>::value)
+            this->updateGridView_();
+        else
+            ParentType::loadBalance();
+    }
+
     /*!
      * \brief Returns a reference to the grid.
      */
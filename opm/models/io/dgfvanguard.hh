@@ -32,10 +32,17 @@
 #include <opm/models/discretefracture/fracturemapper.hh>
 
 #include <opm/models/io/basevanguard.hh>
+#include <opm/models/io/gridcache.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 
+#if HAVE_MPI
+#include <mpi.h>
+#endif
 
+#include <cassert>
+#include <cstdint>
+#include <memory>
 #include <type_traits>
 #include <string>
 
@@ -44,6 +51,12 @@ namespace Opm {
 /*!
  * \brief Provides a simulator vanguard which creates a grid by parsing a Dune Grid
  *        Format (DGF) file.
+ *
+ * If the EnableGridCache property is set, the macro grid is written to a binary cache
+ * file (the name of the DGF file with a ".cache" suffix) after it has been parsed.
+ * Later runs recreate the grid from this cache using the grid factory, unless the
+ * contents of the DGF file have changed. This requires a grid which provides a
+ * Dune::GridFactory for unstructured grids.
  */
 template <class TypeTag>
 class DgfVanguard : public BaseVanguard<TypeTag>
@@ -53,9 +66,12 @@ class DgfVanguard : public BaseVanguard<TypeTag>
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using Grid = GetPropType<TypeTag, Properties::Grid>;
     using FractureMapper = Opm::FractureMapper<TypeTag>;
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<typename Grid::LevelGridView>;
 
     using GridPointer = std::unique_ptr< Grid >;
 
+    enum { enableGridCache = getPropValue<TypeTag, Properties::EnableGridCache>() };
+
 public:
     /*!
      * \brief Register all run-time parameters for the DGF simulator vanguard.
@@ -67,6 +83,9 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, unsigned, GridGlobalRefinements,
                              "The number of global refinements of the grid "
                              "executed after it was loaded");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, FractureElementLoadWeight,
+                             "The cost of an element cut by a fracture relative to the "
+                             "one of the remaining elements for load balancing");
     }
 
     /*!
@@ -77,17 +96,12 @@ public:
     {
         const std::string dgfFileName = EWOMS_GET_PARAM(TypeTag, std::string, GridFile);
         unsigned numRefinments = EWOMS_GET_PARAM(TypeTag, unsigned, GridGlobalRefinements);
+        fractureElementLoadWeight_ = EWOMS_GET_PARAM(TypeTag, Scalar, FractureElementLoadWeight);
 
-        {
-            // create DGF GridPtr from a dgf file
-            Dune::GridPtr< Grid > dgfPointer( dgfFileName );
-
-            // this is only implemented for 2d currently
-            addFractures_( dgfPointer );
-
-            // store pointer to dune grid
-            gridPtr_.reset( dgfPointer.release() );
-        }
+        if constexpr (enableGridCache)
+            loadCached_(dgfFileName);
+        else
+            loadDgf_(dgfFileName);
 
         if (numRefinments > 0)
             gridPtr_->globalRefine(static_cast<int>(numRefinments));
@@ -115,7 +129,40 @@ public:
      * the DGF...
      */
     void loadBalance()
-    { gridPtr_->loadBalance(); }
+    {
+        // the weights of the elements are determined using the vertex numbering of
+        // the macro grid, i.e., the one of the fracture mapper
+        if (useWeightedLoadBalancing())
+            macroVertexMapper_.reset(new VertexMapper(gridPtr_->levelGridView(/*level=*/0),
+                                                      Dune::mcmgVertexLayout()));
+
+        this->loadBalanceGrid_();
+        macroVertexMapper_.reset();
+    }
+
+    /*!
+     * \brief Returns true if the elements which are cut by fractures are more
+     *        expensive than the others.
+     */
+    bool useWeightedLoadBalancing() const
+    { return fractureElementLoadWeight_ != 1.0 && fractureMapper_.numFractureEdges() > 0; }
+
+    /*!
+     * \brief Returns the relative cost of an element of the macro grid.
+     */
+    template <class Element>
+    double elementLoadWeight(const Element& elem) const
+    {
+        assert(macroVertexMapper_);
+        for (unsigned vertexIdx = 0; vertexIdx < elem.subEntities(Grid::dimension); ++vertexIdx) {
+            unsigned globalIdx = static_cast<unsigned>(
+                macroVertexMapper_->subIndex(elem, vertexIdx, Grid::dimension));
+            if (fractureMapper_.isFractureVertex(globalIdx))
+                return fractureElementLoadWeight_;
+        }
+
+        return 1.0;
+    }
 
     /*!
      * \brief Returns the fracture mapper
@@ -134,15 +181,91 @@ public:
     { return fractureMapper_; }
 
 protected:
-    void addFractures_(Dune::GridPtr<Grid>& dgfPointer)
+    void loadDgf_(const std::string& dgfFileName)
     {
-        using LevelGridView = typename Grid::LevelGridView;
+        // create DGF GridPtr from a dgf file
+        Dune::GridPtr< Grid > dgfPointer( dgfFileName );
+
+        // this is only implemented for 2d currently
+        addFractures_( dgfPointer );
+
+        // store pointer to dune grid
+        gridPtr_.reset( dgfPointer.release() );
+    }
+
+    void loadCached_(const std::string& dgfFileName)
+    {
+        using Cache = GridCache<Grid>;
+        const std::string cacheFileName = dgfFileName + ".cache";
+
+        int myRank = 0;
+#if HAVE_MPI
+        MPI_Comm_rank(MPI_COMM_WORLD, &myRank);
+#endif
+
+        // like the DGF parser, only the first process reads the grid. it also decides
+        // whether the cache can be used, and all others follow suit
+        Cache cache;
+        std::uint64_t dgfSize = 0;
+        std::uint64_t dgfHash = 0;
+        bool haveHash = false;
+        int useCache = 0;
+        if (myRank == 0) {
+            haveHash = Cache::hashFile(dgfFileName, dgfSize, dgfHash);
+            useCache = haveHash && cache.read(cacheFileName, dgfSize, dgfHash);
+        }
+#if HAVE_MPI
+        MPI_Bcast(&useCache, 1, MPI_INT, /*root=*/0, MPI_COMM_WORLD);
+#endif
+
+        if (!useCache) {
+            Dune::GridPtr< Grid > dgfPointer( dgfFileName );
+            addFractures_( dgfPointer );
+
+            if (myRank == 0 && haveHash) {
+                int numParams = dgfPointer.nofParameters(static_cast<int>(Grid::dimension));
+                cache.extract(*dgfPointer, static_cast<unsigned>(numParams),
+                              [&dgfPointer, numParams](const auto& vertex, auto outIt)
+                              {
+                                  const auto& params = dgfPointer.parameters(vertex);
+                                  for (int paramIdx = 0; paramIdx < numParams; ++paramIdx)
+                                      *outIt++ = params[static_cast<size_t>(paramIdx)];
+                              });
+                cache.write(cacheFileName, dgfSize, dgfHash);
+            }
+
+            gridPtr_.reset( dgfPointer.release() );
+            return;
+        }
 
+        // on all but the first process, the cache is empty, i.e., no vertices and
+        // elements are inserted into the factory
+        Dune::GridFactory<Grid> factory;
+        gridPtr_ = cache.createGrid(factory);
+
+        if (cache.numVertexParams() > 0)
+            addFractures_(*gridPtr_,
+                          [&factory, &cache](const auto& vertex)
+                          { return cache.vertexParams(factory.insertionIndex(vertex))[0] > 0; });
+    }
+
+    void addFractures_(Dune::GridPtr<Grid>& dgfPointer)
+    {
         // check if fractures are available (only 2d currently)
         if (dgfPointer.nofParameters(static_cast<int>(Grid::dimension)) == 0)
             return;
 
-        LevelGridView gridView = dgfPointer->levelGridView(/*level=*/0);
+        addFractures_(*dgfPointer,
+                      [&dgfPointer](const auto& vertex)
+                      { return dgfPointer.parameters(vertex)[0] > 0; });
+    }
+
+    template <class FractureVertexFn>
+    void addFractures_(const Grid& grid, FractureVertexFn isFractureVertex)
+    {
+        using LevelGridView = typename Grid::LevelGridView;
+
+        LevelGridView gridView = grid.levelGridView(/*level=*/0);
         const unsigned edgeCodim = Grid::dimension - 1;
 
         using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<LevelGridView>;
@@ -169,7 +292,7 @@ protected:
                     const auto vertex = element.template subEntity<Grid::dimension>(localVx);
 
                     // if vertex has parameter 1 insert as a fracture vertex
-                    if (dgfPointer.parameters( vertex )[ 0 ] > 0)
+                    if (isFractureVertex( vertex ))
                         vertexIndices.push_back(
                             static_cast<unsigned>(vertexMapper.subIndex(element,
                                                                         static_cast<int>(localVx),
@@ -180,11 +303,15 @@ protected:
                     fractureMapper_.addFractureEdge(vertexIndices[0], vertexIndices[1]);
             }
         }
+
+        fractureMapper_.finalize();
     }
 
 private:
     GridPointer    gridPtr_;
     FractureMapper fractureMapper_;
+    Scalar fractureElementLoadWeight_;
+    std::unique_ptr<VertexMapper> macroVertexMapper_;
 };
 
 } // namespace Opm
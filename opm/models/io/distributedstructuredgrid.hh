@@ -0,0 +1,69 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Helpers for creating structured grids which are distributed over all
+ *        processes right from the start.
+ */
+#ifndef EWOMS_DISTRIBUTED_STRUCTURED_GRID_HH
+#define EWOMS_DISTRIBUTED_STRUCTURED_GRID_HH
+
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#if HAVE_DUNE_ALUGRID
+#include <dune/alugrid/grid.hh>
+// specializes Dune::StructuredGridFactory for cube ALUGrids so that each process
+// only inserts its own part of the grid
+#include <dune/alugrid/common/structuredgridfactory.hh>
+#endif
+
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \brief Specifies whether Dune::StructuredGridFactory::createCubeGrid() creates a
+ *        grid which is already distributed over all processes.
+ *
+ * If this is the case, the grid does not need to be load balanced after it was
+ * created. For all other grids, the whole grid is created on the first process and
+ * needs to be distributed by loadBalance().
+ */
+template <class Grid>
+struct CreatesDistributedCubeGrid : public std::false_type {};
+
+// YaspGrid partitions itself when it is constructed
+template <int dim, class Coordinates>
+struct CreatesDistributedCubeGrid<Dune::YaspGrid<dim, Coordinates> > : public std::true_type {};
+
+#if HAVE_DUNE_ALUGRID
+template <int dim, int dimWorld, Dune::ALUGridRefinementType refinementType, class Comm>
+struct CreatesDistributedCubeGrid<Dune::ALUGrid<dim, dimWorld, Dune::cube, refinementType, Comm> >
+    : public std::true_type {};
+#endif
+
+} // namespace Opm
+
+#endif
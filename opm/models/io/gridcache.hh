@@ -0,0 +1,318 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::GridCache
+ */
+#ifndef EWOMS_GRID_CACHE_HH
+#define EWOMS_GRID_CACHE_HH
+
+#include <dune/grid/common/gridfactory.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/geometry/type.hh>
+#include <dune/common/fvector.hh>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief A binary on-disk cache of the macro grid read from a grid file.
+ *
+ * The cache stores the vertex coordinates, the vertex parameters and the element
+ * connectivity of the coarsest level of a grid. For grids that are expensive to
+ * parse, recreating them from the cache using the grid factory is much faster than
+ * reading the original file. To detect stale caches, the cache stores the size and a
+ * hash of the contents of the file from which it was created.
+ *
+ * The grid type must provide a Dune::GridFactory for unstructured grids.
+ */
+template <class Grid>
+class GridCache
+{
+    enum { dim = Grid::dimension };
+    enum { dimWorld = Grid::dimensionworld };
+
+    using GlobalPosition = Dune::FieldVector<typename Grid::ctype, dimWorld>;
+
+    // increase this if the layout of the cache files changes
+    static constexpr std::uint32_t formatVersion_ = 1;
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t dim;
+        std::uint32_t dimWorld;
+        std::uint32_t numVertexParams;
+        std::uint64_t sourceSize;
+        std::uint64_t sourceHash;
+        std::uint64_t numVertices;
+        std::uint64_t numElements;
+        std::uint64_t numCorners;
+    };
+
+public:
+    /*!
+     * \brief Computes the size and a 64 bit FNV-1a hash of the contents of a file.
+     *
+     * Returns false if the file cannot be read.
+     */
+    static bool hashFile(const std::string& fileName,
+                         std::uint64_t& fileSize,
+                         std::uint64_t& fileHash)
+    {
+        std::ifstream inStream(fileName, std::ios::binary);
+        if (!inStream.is_open())
+            return false;
+
+        fileSize = 0;
+        fileHash = 14695981039346656037ULL;
+        std::vector<char> buffer(1 << 20);
+        while (inStream) {
+            inStream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            std::streamsize n = inStream.gcount();
+            for (std::streamsize i = 0; i < n; ++i) {
+                fileHash ^= static_cast<unsigned char>(buffer[static_cast<size_t>(i)]);
+                fileHash *= 1099511628211ULL;
+            }
+            fileSize += static_cast<std::uint64_t>(n);
+        }
+
+        return true;
+    }
+
+    /*!
+     * \brief Extracts the coarsest level of a grid.
+     *
+     * \param grid The grid
+     * \param numVertexParams The number of parameters attached to each vertex
+     * \param vertexParams A functor which writes the parameters of a vertex to an
+     *                     output iterator, i.e., vertexParams(vertex, outIt)
+     */
+    template <class VertexParamsFn>
+    void extract(const Grid& grid, unsigned numVertexParams, VertexParamsFn vertexParams)
+    {
+        using LevelGridView = typename Grid::LevelGridView;
+        using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<LevelGridView>;
+
+        LevelGridView gridView = grid.levelGridView(/*level=*/0);
+        VertexMapper vertexMapper(gridView, Dune::mcmgVertexLayout());
+
+        numVertexParams_ = numVertexParams;
+        vertexCoords_.resize(vertexMapper.size()*dimWorld);
+        vertexParams_.resize(vertexMapper.size()*numVertexParams);
+        for (const auto& vertex : vertices(gridView)) {
+            size_t vertexIdx = static_cast<size_t>(vertexMapper.index(vertex));
+            const auto& pos = vertex.geometry().corner(0);
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                vertexCoords_[vertexIdx*dimWorld + dimIdx] = pos[dimIdx];
+            vertexParams(vertex, vertexParams_.begin() + static_cast<std::ptrdiff_t>(vertexIdx*numVertexParams));
+        }
+
+        elementTopologies_.clear();
+        elementOffsets_.assign(1, 0);
+        elementCorners_.clear();
+        for (const auto& element : elements(gridView)) {
+            elementTopologies_.push_back(element.type().id());
+            unsigned numCorners = element.subEntities(dim);
+            for (unsigned cornerIdx = 0; cornerIdx < numCorners; ++cornerIdx)
+                elementCorners_.push_back(
+                    static_cast<std::uint32_t>(vertexMapper.subIndex(element, cornerIdx, dim)));
+            elementOffsets_.push_back(static_cast<std::uint64_t>(elementCorners_.size()));
+        }
+    }
+
+    /*!
+     * \brief Creates the coarsest level of the grid using a grid factory.
+     *
+     * The vertex parameters of the resulting grid can afterwards be retrieved by
+     * vertexParams().
+     */
+    std::unique_ptr<Grid> createGrid(Dune::GridFactory<Grid>& factory) const
+    {
+        size_t numVertices = vertexCoords_.size()/dimWorld;
+        for (size_t vertexIdx = 0; vertexIdx < numVertices; ++vertexIdx) {
+            GlobalPosition pos;
+            for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
+                pos[dimIdx] = vertexCoords_[vertexIdx*dimWorld + dimIdx];
+            factory.insertVertex(pos);
+        }
+
+        std::vector<unsigned> corners;
+        for (size_t elemIdx = 0; elemIdx < elementTopologies_.size(); ++elemIdx) {
+            corners.assign(elementCorners_.begin() + static_cast<std::ptrdiff_t>(elementOffsets_[elemIdx]),
+                           elementCorners_.begin() + static_cast<std::ptrdiff_t>(elementOffsets_[elemIdx + 1]));
+            factory.insertElement(Dune::GeometryType(elementTopologies_[elemIdx], dim), corners);
+        }
+
+        return factory.createGrid();
+    }
+
+    /*!
+     * \brief Returns the parameters of a vertex given its insertion index.
+     */
+    const double* vertexParams(size_t insertionIdx) const
+    { return vertexParams_.data() + insertionIdx*numVertexParams_; }
+
+    /*!
+     * \brief Returns the number of parameters of each vertex.
+     */
+    unsigned numVertexParams() const
+    { return numVertexParams_; }
+
+    /*!
+     * \brief Writes the cache to a file.
+     *
+     * \param fileName The name of the cache file
+     * \param sourceSize The size of the file from which the grid was read
+     * \param sourceHash The hash of the file from which the grid was read
+     */
+    void write(const std::string& fileName,
+               std::uint64_t sourceSize,
+               std::uint64_t sourceHash) const
+    {
+        std::ofstream outStream(fileName, std::ios::binary);
+        if (!outStream.is_open())
+            // not being able to write the cache is not fatal
+            return;
+
+        Header header = makeHeader_(sourceSize, sourceHash);
+        outStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeVector_(outStream, vertexCoords_);
+        writeVector_(outStream, vertexParams_);
+        writeVector_(outStream, elementTopologies_);
+        writeVector_(outStream, elementOffsets_);
+        writeVector_(outStream, elementCorners_);
+    }
+
+    /*!
+     * \brief Reads the cache from a file.
+     *
+     * This returns false if the cache file does not exist, if it was written by an
+     * incompatible version or for a grid of another dimension, or if it was created
+     * from a different source file.
+     *
+     * \param fileName The name of the cache file
+     * \param sourceSize The size of the file from which the grid is to be read
+     * \param sourceHash The hash of the file from which the grid is to be read
+     */
+    bool read(const std::string& fileName,
+              std::uint64_t sourceSize,
+              std::uint64_t sourceHash)
+    {
+        std::ifstream inStream(fileName, std::ios::binary);
+        if (!inStream.is_open())
+            return false;
+
+        // read the whole file at once and copy the arrays out of the buffer
+        inStream.seekg(0, std::ios::end);
+        std::streamoff fileSize = inStream.tellg();
+        inStream.seekg(0, std::ios::beg);
+        if (fileSize < static_cast<std::streamoff>(sizeof(Header)))
+            return false;
+
+        std::vector<char> buffer(static_cast<size_t>(fileSize));
+        inStream.read(buffer.data(), fileSize);
+        if (inStream.gcount() != fileSize)
+            return false;
+
+        Header header;
+        std::memcpy(&header, buffer.data(), sizeof(header));
+        Header expectedHeader = makeHeader_(sourceSize, sourceHash);
+        if (std::memcmp(header.magic, expectedHeader.magic, sizeof(header.magic)) != 0
+            || header.version != expectedHeader.version
+            || header.dim != expectedHeader.dim
+            || header.dimWorld != expectedHeader.dimWorld
+            || header.sourceSize != sourceSize
+            || header.sourceHash != sourceHash)
+            return false;
+
+        numVertexParams_ = header.numVertexParams;
+        size_t offset = sizeof(header);
+        return readVector_(buffer, offset, vertexCoords_, header.numVertices*dimWorld)
+            && readVector_(buffer, offset, vertexParams_, header.numVertices*numVertexParams_)
+            && readVector_(buffer, offset, elementTopologies_, header.numElements)
+            && readVector_(buffer, offset, elementOffsets_, header.numElements + 1)
+            && readVector_(buffer, offset, elementCorners_, header.numCorners)
+            && offset == buffer.size();
+    }
+
+private:
+    Header makeHeader_(std::uint64_t sourceSize, std::uint64_t sourceHash) const
+    {
+        Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "EWOMSGRC", sizeof(header.magic));
+        header.version = formatVersion_;
+        header.dim = dim;
+        header.dimWorld = dimWorld;
+        header.numVertexParams = numVertexParams_;
+        header.sourceSize = sourceSize;
+        header.sourceHash = sourceHash;
+        header.numVertices = vertexCoords_.size()/dimWorld;
+        header.numElements = elementTopologies_.size();
+        header.numCorners = elementCorners_.size();
+        return header;
+    }
+
+    template <class T>
+    static void writeVector_(std::ostream& outStream, const std::vector<T>& data)
+    {
+        outStream.write(reinterpret_cast<const char*>(data.data()),
+                        static_cast<std::streamsize>(data.size()*sizeof(T)));
+    }
+
+    template <class T>
+    static bool readVector_(const std::vector<char>& buffer,
+                            size_t& offset,
+                            std::vector<T>& data,
+                            std::uint64_t size)
+    {
+        size_t numBytes = static_cast<size_t>(size)*sizeof(T);
+        if (offset + numBytes > buffer.size())
+            return false;
+
+        data.resize(static_cast<size_t>(size));
+        std::memcpy(data.data(), buffer.data() + offset, numBytes);
+        offset += numBytes;
+        return true;
+    }
+
+    unsigned numVertexParams_ = 0;
+    std::vector<double> vertexCoords_;
+    std::vector<double> vertexParams_;
+    std::vector<std::uint32_t> elementTopologies_;
+    std::vector<std::uint64_t> elementOffsets_;
+    std::vector<std::uint32_t> elementCorners_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,202 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::InSituOutputWriter
+ */
+#ifndef EWOMS_IN_SITU_OUTPUT_WRITER_HH
+#define EWOMS_IN_SITU_OUTPUT_WRITER_HH
+
+#include <opm/models/io/baseoutputwriter.hh>
+#include <opm/models/parallel/tasklets.hh>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Hands the visualization output to an in-situ pipeline instead of writing it
+ *        to disk.
+ *
+ * The pipeline is a function which is called once per data set, e.g. an adaptor to
+ * ParaView Catalyst or a streaming client. It receives the grid view and references to
+ * the buffers of the output modules, i.e., the fields are not copied. The pipeline is
+ * run by a separate thread, so it may take as long as the simulation needs to get to
+ * the next data set. The buffers must not be accessed after the pipeline returns.
+ */
+template <class GridView>
+class InSituOutputWriter : public BaseOutputWriter
+{
+    class PipelineTasklet : public TaskletInterface
+    {
+    public:
+        PipelineTasklet(InSituOutputWriter& writer)
+            : writer_(writer)
+        { }
+
+        void run() final
+        { writer_.pipeline_(writer_.dataSet_); }
+
+    private:
+        InSituOutputWriter& writer_;
+    };
+
+public:
+    using Scalar = BaseOutputWriter::Scalar;
+    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
+    using VectorBuffer = BaseOutputWriter::VectorBuffer;
+    using TensorBuffer = BaseOutputWriter::TensorBuffer;
+
+    enum FieldCenter { VertexCenter, ElementCenter };
+
+    /*!
+     * \brief A field of a data set. Exactly one of the buffer pointers is set.
+     */
+    struct Field
+    {
+        std::string name;
+        FieldCenter center;
+        const ScalarBuffer* scalars;
+        const VectorBuffer* vectors;
+        const TensorBuffer* tensors;
+    };
+
+    /*!
+     * \brief The data which is handed to the pipeline.
+     */
+    struct DataSet
+    {
+        const GridView* gridView;
+        double time;
+        int index;
+        std::vector<Field> fields;
+    };
+
+    using Pipeline = std::function<void(const DataSet&)>;
+
+    /*!
+     * \brief Create a writer which passes the data sets to a pipeline.
+     *
+     * \param gridView The grid view on which the fields are defined
+     * \param pipeline The function which processes the data sets
+     */
+    InSituOutputWriter(const GridView& gridView, Pipeline pipeline)
+        : gridView_(gridView)
+        , pipeline_(std::move(pipeline))
+        , curIndex_(0)
+        , taskletRunner_(/*numWorkers=*/1)
+    {}
+
+    ~InSituOutputWriter()
+    { taskletRunner_.barrier(); }
+
+    /*!
+     * \brief Wait until the pipeline is done with the previous data set because the
+     *        grid and thus the meaning of the buffers changes.
+     */
+    void gridChanged()
+    { taskletRunner_.barrier(); }
+
+    /*!
+     * \copydoc BaseOutputWriter::beginWrite
+     *
+     * This waits until the pipeline is done with the previous data set, so that its
+     * buffers can be modified afterwards.
+     */
+    void beginWrite(double t) override
+    {
+        taskletRunner_.barrier();
+
+        dataSet_.gridView = &gridView_;
+        dataSet_.time = t;
+        dataSet_.index = curIndex_;
+        dataSet_.fields.clear();
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarVertexData
+     */
+    void attachScalarVertexData(ScalarBuffer& buf, std::string name) override
+    { dataSet_.fields.push_back(Field{name, VertexCenter, &buf, nullptr, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarElementData
+     */
+    void attachScalarElementData(ScalarBuffer& buf, std::string name) override
+    { dataSet_.fields.push_back(Field{name, ElementCenter, &buf, nullptr, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorVertexData
+     */
+    void attachVectorVertexData(VectorBuffer& buf, std::string name) override
+    { dataSet_.fields.push_back(Field{name, VertexCenter, nullptr, &buf, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorElementData
+     */
+    void attachVectorElementData(VectorBuffer& buf, std::string name) override
+    { dataSet_.fields.push_back(Field{name, ElementCenter, nullptr, &buf, nullptr}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorVertexData
+     */
+    void attachTensorVertexData(TensorBuffer& buf, std::string name) override
+    { dataSet_.fields.push_back(Field{name, VertexCenter, nullptr, nullptr, &buf}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorElementData
+     */
+    void attachTensorElementData(TensorBuffer& buf, std::string name) override
+    { dataSet_.fields.push_back(Field{name, ElementCenter, nullptr, nullptr, &buf}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::endWrite
+     */
+    void endWrite(bool onlyDiscard = false) override
+    {
+        if (onlyDiscard) {
+            dataSet_.fields.clear();
+            return;
+        }
+
+        ++curIndex_;
+        auto tasklet = std::make_shared<PipelineTasklet>(*this);
+        tasklet->setPriority(TaskletInterface::Priority::Low);
+        taskletRunner_.dispatch(tasklet);
+    }
+
+private:
+    const GridView gridView_;
+    Pipeline pipeline_;
+
+    DataSet dataSet_;
+    int curIndex_;
+
+    TaskletRunner taskletRunner_;
+};
+} // namespace Opm
+
+#endif
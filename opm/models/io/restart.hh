@@ -27,18 +27,151 @@
 #ifndef EWOMS_RESTART_HH
 #define EWOMS_RESTART_HH
 
+#include <dune/common/parallel/mpihelper.hh>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace Opm {
 
+/*!
+ * \brief Writes the raw bytes of values into a binary restart file.
+ *
+ * This class provides the subset of the std::ostream interface which is used to
+ * serialize the data of individual entities. Strings are only used as separators by the
+ * text format, so they are ignored.
+ */
+class RestartBinaryOutputStream
+{
+public:
+    explicit RestartBinaryOutputStream(std::string& buffer)
+        : buffer_(buffer)
+    {}
+
+    bool good() const
+    { return true; }
+
+    template <class T>
+    typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                            RestartBinaryOutputStream&>::type
+    operator<<(const T& value)
+    {
+        buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        return *this;
+    }
+
+    RestartBinaryOutputStream& operator<<(const char*)
+    { return *this; }
+
+private:
+    std::string& buffer_;
+};
+
+/*!
+ * \brief Reads the raw bytes of values from a binary restart file.
+ *
+ * \copydetails RestartBinaryOutputStream
+ */
+class RestartBinaryInputStream
+{
+public:
+    RestartBinaryInputStream(const char* data, size_t size)
+        : data_(data)
+        , size_(size)
+        , pos_(0)
+        , failed_(false)
+    {}
+
+    bool good() const
+    { return !failed_; }
+
+    /*!
+     * \brief Returns true if all data has been read.
+     */
+    bool atEnd() const
+    { return pos_ == size_; }
+
+    template <class T>
+    typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                            RestartBinaryInputStream&>::type
+    operator>>(T& value)
+    {
+        if (failed_ || pos_ + sizeof(T) > size_) {
+            failed_ = true;
+            return *this;
+        }
+
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return *this;
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+    bool failed_;
+};
+
 /*!
  * \brief Load or save a state of a problem to/from the harddisk.
+ *
+ * Two file formats are supported: In the text format, each process writes a separate
+ * file and all data is formatted as text. In the binary format, all processes write
+ * their data into a common file. It starts with a fixed-size header which is followed by
+ * a table that stores the position and the size of the contiguous data block of each
+ * process. These blocks consist of sections which are protected by a checksum. The data
+ * of the grid entities is stored as raw bytes, i.e., reading and writing binary restart
+ * files is not limited by the conversion of numbers to text and back, but the files can
+ * only be read on machines which use the same representation of numbers.
+ *
+ * When a simulation is restarted, the format of the restart file is detected
+ * automatically.
+ *
+ * Instead of writing a file, the data block of the binary format can also be kept in
+ * memory as a snapshot of the simulation (see releaseSnapshot() and
+ * deserializeSnapshotBegin()).
+ *
+ * Binary restart files can also be written as deltas of a full one (see
+ * setDeltaBase()). For each entity section, such a file only stores the data of the
+ * entities whose serialized data differs from the one of the full file. The full file
+ * is referenced by name and is read automatically if a delta file is deserialized.
  */
 class Restart
 {
+    // the header at the beginning of binary restart files
+    struct BinaryHeader_ {
+        char magic[8];
+        uint32_t version;
+        uint32_t numProcesses;
+    };
+
+    // the position and size of the data block of a process in binary restart files
+    struct BinaryBlock_ {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    static const char* binaryMagic_()
+    { return "OPMRST\x1a\x01"; }
+
+    static const uint32_t binaryVersion_ = 1;
+
     /*!
      * \brief Create a magic cookie for restart files, so that it is
      *        unlikely to load a restart file for an incorrectly.
@@ -73,7 +206,8 @@ class Restart
     static const std::string restartFileName_(const GridView& gridView,
                                               const std::string& outputDir,
                                               const std::string& simName,
-                                              Scalar t)
+                                              Scalar t,
+                                              bool binary)
     {
         std::string dir = outputDir;
         if (dir == ".")
@@ -81,61 +215,185 @@ class Restart
         else if (!dir.empty() && dir.back() != '/')
             dir += "/";
 
-        int rank = gridView.comm().rank();
         std::ostringstream oss;
-        oss << dir << simName << "_time=" << t << "_rank=" << rank << ".ers";
+        if (binary)
+            // binary restart files are shared by all processes
+            oss << dir << simName << "_time=" << t << "_ranks=" << gridView.comm().size() << ".erb";
+        else {
+            int rank = gridView.comm().rank();
+            oss << dir << simName << "_time=" << t << "_rank=" << rank << ".ers";
+        }
         return oss.str();
     }
 
+    // the 64 bit FNV-1a hash of a sequence of bytes
+    static uint64_t checksum_(const char* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
 public:
+    /*!
+     * \brief The data of the entities of a full binary restart file which is required
+     *        to write delta restart files which refer to it.
+     */
+    class DeltaBase
+    {
+        friend class Restart;
+
+        struct EntitySection_ {
+            std::string data;
+            // the offset of the data of each entity plus the size of the data
+            std::vector<uint64_t> offsets;
+        };
+
+        std::string fileName_;
+        std::map<std::string, EntitySection_> entitySections_;
+    };
+
+    /*!
+     * \brief Create a restart object.
+     *
+     * \param binary Specifies whether newly written restart files use the binary
+     *               format. For reading restart files, this is ignored.
+     */
+    explicit Restart(bool binary = false)
+        : binary_(binary)
+        , recordDeltaBase_(false)
+    {}
+
+    /*!
+     * \brief Keep the entity data of the binary restart file which is written in
+     *        memory, so that delta restart files can refer to it.
+     *
+     * This must be called before serializeBegin(). The data is available using
+     * recordedDeltaBase() after the entities have been serialized.
+     */
+    void setRecordDeltaBase(bool yesno)
+    {
+        if (yesno && !binary_)
+            throw std::logic_error("Only binary restart files can serve as the base of "
+                                   "delta restart files");
+        recordDeltaBase_ = yesno;
+    }
+
+    /*!
+     * \brief Returns the entity data of the file which has been written if
+     *        setRecordDeltaBase() was enabled, else a null pointer.
+     */
+    std::shared_ptr<const DeltaBase> recordedDeltaBase() const
+    { return recordedDeltaBase_; }
+
+    /*!
+     * \brief Write the restart file as a delta of a full binary restart file.
+     *
+     * This must be called before serializeBegin(). The entity sections which have the
+     * same number of entities as in the full file only store the data of the entities
+     * which changed, all other sections are stored completely. The full file must be
+     * kept as long as the delta file is used.
+     */
+    void setDeltaBase(std::shared_ptr<const DeltaBase> base)
+    {
+        if (base && !binary_)
+            throw std::logic_error("Delta restart files must use the binary format");
+        deltaBase_ = std::move(base);
+    }
+
     /*!
      * \brief Returns the name of the file which is (de-)serialized.
      */
     const std::string& fileName() const
     { return fileName_; }
 
+    /*!
+     * \brief Returns true if the file which is (de-)serialized uses the binary format.
+     */
+    bool binary() const
+    { return binary_; }
+
     /*!
      * \brief Write the current state of the model to disk.
      */
     template <class Simulator>
     void serializeBegin(Simulator& simulator)
     {
-        const std::string magicCookie = magicRestartCookie_(simulator.gridView());
-        fileName_ = restartFileName_(simulator.gridView(),
+        const auto& gridView = simulator.gridView();
+        const std::string magicCookie = magicRestartCookie_(gridView);
+        fileName_ = restartFileName_(gridView,
                                      simulator.problem().outputDir(),
                                      simulator.problem().name(),
-                                     simulator.time());
+                                     simulator.time(),
+                                     binary_);
+        rank_ = gridView.comm().rank();
+        numProcesses_ = gridView.comm().size();
 
-        // open output file and write magic cookie
-        outStream_.open(fileName_.c_str());
-        outStream_.precision(20);
+        if (binary_) {
+            binaryBlock_.clear();
+            sectionStream_.str("");
+            sectionStream_.precision(20);
+            if (recordDeltaBase_) {
+                auto base = std::make_shared<DeltaBase>();
+                base->fileName_ = fileName_;
+                recordedDeltaBase_ = base;
+            }
+        }
+        else {
+            // open output file and write magic cookie
+            outStream_.open(fileName_.c_str());
+            outStream_.precision(20);
+        }
 
         serializeSectionBegin(magicCookie);
         serializeSectionEnd();
+
+        if (deltaBase_)
+            appendBinarySection_(deltaBaseCookie_(), deltaBase_->fileName_);
     }
 
     /*!
      * \brief The output stream to write the serialized data.
      */
     std::ostream& serializeStream()
-    { return outStream_; }
+    {
+        if (binary_)
+            return sectionStream_;
+        return outStream_;
+    }
 
     /*!
      * \brief Start a new section in the serialized output.
      */
     void serializeSectionBegin(const std::string& cookie)
-    { outStream_ << cookie << "\n"; }
+    {
+        if (binary_) {
+            sectionCookie_ = cookie;
+            sectionStream_.str("");
+        }
+        else
+            outStream_ << cookie << "\n";
+    }
 
     /*!
      * \brief End of a section in the serialized output.
      */
     void serializeSectionEnd()
-    { outStream_ << "\n"; }
+    {
+        if (binary_)
+            appendBinarySection_(sectionCookie_, sectionStream_.str());
+        else
+            outStream_ << "\n";
+    }
 
     /*!
      * \brief Serialize all leaf entities of a codim in a gridView.
      *
-     * The actual work is done by Serializer::serialize(Entity)
+     * The actual work is done by Serializer::serializeEntity(Stream, Entity). For the
+     * binary format, the stream is a RestartBinaryOutputStream.
      */
     template <int codim, class Serializer, class GridView>
     void serializeEntities(Serializer& serializer, const GridView& gridView)
@@ -143,13 +401,44 @@ public:
         std::ostringstream oss;
         oss << "Entities: Codim " << codim;
         std::string cookie = oss.str();
-        serializeSectionBegin(cookie);
 
         // write element data
         using Iterator = typename GridView::template Codim<codim>::Iterator;
 
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
+        if (binary_) {
+            std::string data;
+            std::vector<uint64_t> offsets;
+            RestartBinaryOutputStream binStream(data);
+            for (; it != endIt; ++it) {
+                offsets.push_back(data.size());
+                serializer.serializeEntity(binStream, *it);
+            }
+            offsets.push_back(data.size());
+
+            if (deltaBase_) {
+                auto baseIt = deltaBase_->entitySections_.find(cookie);
+                if (baseIt != deltaBase_->entitySections_.end()
+                    && baseIt->second.offsets.size() == offsets.size())
+                {
+                    appendBinarySection_(deltaCookie_(cookie),
+                                         entityDelta_(baseIt->second, data, offsets));
+                    return;
+                }
+            }
+
+            if (recordedDeltaBase_) {
+                auto& baseSection = recordedDeltaBase_->entitySections_[cookie];
+                baseSection.data = data;
+                baseSection.offsets = std::move(offsets);
+            }
+
+            appendBinarySection_(cookie, data);
+            return;
+        }
+
+        serializeSectionBegin(cookie);
         for (; it != endIt; ++it) {
             serializer.serializeEntity(outStream_, *it);
             outStream_ << "\n";
@@ -160,9 +449,149 @@ public:
 
     /*!
      * \brief Finish the restart file.
+     *
+     * For the binary format, this method must be called by all processes.
      */
     void serializeEnd()
-    { outStream_.close(); }
+    {
+        if (binary_)
+            writeBinaryFile_();
+        else
+            outStream_.close();
+    }
+
+    /*!
+     * \brief Do the collective part of finishing a binary restart file.
+     *
+     * This is an alternative to serializeEnd() which must be called by all processes.
+     * Afterwards, each process writes its data using writeBinaryBlock() without any
+     * communication, e.g. using a separate thread while the simulation continues.
+     */
+    void prepareBinaryFile()
+    {
+        if (!binary_)
+            throw std::logic_error("Only binary restart files can be written in two steps");
+
+        std::vector<BinaryBlock_> blocks;
+        computeBinaryBlocks_(blocks);
+        localBlockOffset_ = blocks[static_cast<size_t>(rank_)].offset;
+
+        // the first process creates the file and writes the header and the table of the
+        // data blocks
+        bool failed = false;
+        if (rank_ == 0) {
+            BinaryHeader_ header = binaryHeader_();
+            std::ofstream file(fileName_.c_str(), std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(blocks.data()),
+                       static_cast<std::streamsize>(blocks.size()*sizeof(BinaryBlock_)));
+            failed = !file.good();
+        }
+
+#if HAVE_MPI
+        if (numProcesses_ > 1)
+            MPI_Barrier(Dune::MPIHelper::getCommunicator());
+#endif
+
+        if (failed)
+            throw std::runtime_error("Could not write restart file '"+fileName_+"'");
+    }
+
+    /*!
+     * \brief Write the data of the local process into a binary restart file which has
+     *        been prepared by prepareBinaryFile().
+     *
+     * This does not communicate with the other processes.
+     */
+    void writeBinaryBlock()
+    {
+        std::fstream file(fileName_.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(localBlockOffset_));
+        file.write(binaryBlock_.data(), static_cast<std::streamsize>(binaryBlock_.size()));
+        if (!file.good())
+            throw std::runtime_error("Could not write restart file '"+fileName_+"'");
+        binaryBlock_.clear();
+    }
+
+    /*!
+     * \brief Finish the serialization without writing a file and return the
+     *        serialized data of the local process.
+     *
+     * This is only possible for the binary format. The result can be read using
+     * deserializeSnapshotBegin() by the same process for the same grid.
+     */
+    std::string releaseSnapshot()
+    {
+        if (!binary_)
+            throw std::logic_error("Snapshots can only be taken using the binary format");
+
+        std::string result;
+        result.swap(binaryBlock_);
+        return result;
+    }
+
+    /*!
+     * \brief Write a section which consists of raw values.
+     *
+     * The values are written by calling writer(stream) with a
+     * RestartBinaryOutputStream. This is only possible for the binary format.
+     */
+    template <class Writer>
+    void serializeBinarySection(const std::string& cookie, Writer writer)
+    {
+        if (!binary_)
+            throw std::logic_error("Section '"+cookie+"' can only be written using the "
+                                   "binary format");
+
+        std::string data;
+        RestartBinaryOutputStream binStream(data);
+        writer(binStream);
+        appendBinarySection_(cookie, data);
+    }
+
+    /*!
+     * \brief Read a section which has been written by serializeBinarySection().
+     *
+     * The values are read by calling reader(stream) with a RestartBinaryInputStream.
+     */
+    template <class Reader>
+    void deserializeBinarySection(const std::string& cookie, Reader reader)
+    {
+        if (!binary_)
+            throw std::logic_error("Section '"+cookie+"' can only be read using the "
+                                   "binary format");
+
+        const char* data;
+        size_t size;
+        nextBinarySection_(cookie, data, size);
+
+        RestartBinaryInputStream binStream(data, size);
+        reader(binStream);
+        if (!binStream.good())
+            throw std::runtime_error("Section '"+cookie+"' is corrupted");
+        if (!binStream.atEnd())
+            throw std::logic_error("Encountered unread values while deserializing");
+    }
+
+    /*!
+     * \brief Start reading a snapshot which has been returned by releaseSnapshot().
+     */
+    template <class Simulator>
+    void deserializeSnapshotBegin(Simulator& simulator, std::string snapshot)
+    {
+        const auto& gridView = simulator.gridView();
+        rank_ = gridView.comm().rank();
+        numProcesses_ = gridView.comm().size();
+        fileName_ = "";
+        binary_ = true;
+        binaryBlock_ = std::move(snapshot);
+        blockPos_ = 0;
+
+        const std::string magicCookie = magicRestartCookie_(gridView);
+
+        deserializeSectionBegin(magicCookie);
+        deserializeSectionEnd();
+    }
 
     /*!
      * \brief Start reading a restart file at a certain simulated
@@ -171,26 +600,65 @@ public:
     template <class Simulator, class Scalar>
     void deserializeBegin(Simulator& simulator, Scalar t)
     {
-        fileName_ = restartFileName_(simulator.gridView(), simulator.problem().outputDir(), simulator.problem().name(), t);
+        const auto& gridView = simulator.gridView();
+        rank_ = gridView.comm().rank();
+        numProcesses_ = gridView.comm().size();
 
-        // open input file and read magic cookie
-        inStream_.open(fileName_.c_str());
-        if (!inStream_.good()) {
-            throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+        // use the binary restart file if it exists
+        fileName_ = restartFileName_(gridView,
+                                     simulator.problem().outputDir(),
+                                     simulator.problem().name(),
+                                     t,
+                                     /*binary=*/true);
+        binary_ = std::ifstream(fileName_.c_str()).good();
+        if (binary_) {
+            readBinaryFile_(fileName_, binaryBlock_);
+            blockPos_ = 0;
         }
+        else {
+            fileName_ = restartFileName_(gridView,
+                                         simulator.problem().outputDir(),
+                                         simulator.problem().name(),
+                                         t,
+                                         /*binary=*/false);
+
+            // open input file and read magic cookie
+            inStream_.open(fileName_.c_str());
+            if (!inStream_.good()) {
+                throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+            }
 
-        // make sure that we don't open an empty file
-        inStream_.seekg(0, std::ios::end);
-        auto pos = inStream_.tellg();
-        if (pos == 0) {
-            throw std::runtime_error("Restart file '"+fileName_+"' is empty");
+            // make sure that we don't open an empty file
+            inStream_.seekg(0, std::ios::end);
+            auto pos = inStream_.tellg();
+            if (pos == 0) {
+                throw std::runtime_error("Restart file '"+fileName_+"' is empty");
+            }
+            inStream_.seekg(0, std::ios::beg);
         }
-        inStream_.seekg(0, std::ios::beg);
 
-        const std::string magicCookie = magicRestartCookie_(simulator.gridView());
+        const std::string magicCookie = magicRestartCookie_(gridView);
 
         deserializeSectionBegin(magicCookie);
         deserializeSectionEnd();
+
+        // delta restart files refer to a full one which provides the data of the
+        // entities that did not change
+        if (binary_ && peekBinarySectionCookie_() == deltaBaseCookie_()) {
+            const char* data;
+            size_t size;
+            nextBinarySection_(deltaBaseCookie_(), data, size);
+            std::string baseFileName(data, size);
+            readBinaryFile_(baseFileName, baseBlock_);
+
+            baseSections_.clear();
+            size_t pos = 0;
+            while (pos < baseBlock_.size()) {
+                std::string baseCookie;
+                readBinarySection_(baseBlock_, pos, baseFileName, baseCookie, data, size);
+                baseSections_[baseCookie] = std::make_pair(data, size);
+            }
+        }
     }
 
     /*!
@@ -198,13 +666,26 @@ public:
      *        deserialized.
      */
     std::istream& deserializeStream()
-    { return inStream_; }
+    {
+        if (binary_)
+            return sectionInStream_;
+        return inStream_;
+    }
 
     /*!
      * \brief Start reading a new section of the restart file.
      */
     void deserializeSectionBegin(const std::string& cookie)
     {
+        if (binary_) {
+            const char* data;
+            size_t size;
+            nextBinarySection_(cookie, data, size);
+            sectionInStream_.clear();
+            sectionInStream_.str(std::string(data, size));
+            return;
+        }
+
         if (!inStream_.good())
             throw std::runtime_error("Encountered unexpected EOF in restart file.");
         std::string buf;
@@ -219,7 +700,13 @@ public:
     void deserializeSectionEnd()
     {
         std::string dummy;
-        std::getline(inStream_, dummy);
+        if (binary_) {
+            // the remaining part of the section must only consist of whitespace
+            std::getline(sectionInStream_, dummy, '\0');
+        }
+        else
+            std::getline(inStream_, dummy);
+
         for (unsigned i = 0; i < dummy.length(); ++i) {
             if (!std::isspace(dummy[i])) {
                 throw std::logic_error("Encountered unread values while deserializing");
@@ -230,7 +717,8 @@ public:
     /*!
      * \brief Deserialize all leaf entities of a codim in a grid.
      *
-     * The actual work is done by Deserializer::deserialize(Entity)
+     * The actual work is done by Deserializer::deserializeEntity(Stream, Entity). For
+     * the binary format, the stream is a RestartBinaryInputStream.
      */
     template <int codim, class Deserializer, class GridView>
     void deserializeEntities(Deserializer& deserializer, const GridView& gridView)
@@ -238,14 +726,38 @@ public:
         std::ostringstream oss;
         oss << "Entities: Codim " << codim;
         std::string cookie = oss.str();
-        deserializeSectionBegin(cookie);
-
-        std::string curLine;
 
         // read entity data
         using Iterator = typename GridView::template Codim<codim>::Iterator;
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
+
+        if (binary_) {
+            const char* data;
+            size_t size;
+            if (peekBinarySectionCookie_() == deltaCookie_(cookie)) {
+                nextBinarySection_(deltaCookie_(cookie), data, size);
+                deserializeEntityDelta_<codim>(deserializer, gridView, cookie, data, size);
+                return;
+            }
+
+            nextBinarySection_(cookie, data, size);
+
+            RestartBinaryInputStream binStream(data, size);
+            for (; it != endIt; ++it) {
+                if (!binStream.good())
+                    throw std::runtime_error("Restart file is corrupted");
+                deserializer.deserializeEntity(binStream, *it);
+            }
+
+            if (!binStream.atEnd())
+                throw std::logic_error("Encountered unread values while deserializing");
+            return;
+        }
+
+        deserializeSectionBegin(cookie);
+
+        std::string curLine;
         for (; it != endIt; ++it) {
             if (!inStream_.good()) {
                 throw std::runtime_error("Restart file is corrupted");
@@ -263,12 +775,326 @@ public:
      * \brief Stop reading the restart file.
      */
     void deserializeEnd()
-    { inStream_.close(); }
+    {
+        if (binary_) {
+            binaryBlock_.clear();
+            baseBlock_.clear();
+            baseSections_.clear();
+        }
+        else
+            inStream_.close();
+    }
 
 private:
+    // append a section to the data block of the local process. the layout of a
+    // section is: cookie length, cookie, data size, data, checksum of the data
+    void appendBinarySection_(const std::string& cookie, const std::string& data)
+    {
+        uint64_t cookieSize = cookie.size();
+        uint64_t dataSize = data.size();
+        uint64_t checksum = checksum_(data.data(), data.size());
+
+        binaryBlock_.append(reinterpret_cast<const char*>(&cookieSize), sizeof(cookieSize));
+        binaryBlock_.append(cookie);
+        binaryBlock_.append(reinterpret_cast<const char*>(&dataSize), sizeof(dataSize));
+        binaryBlock_.append(data);
+        binaryBlock_.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    }
+
+    // read the next section of the data block of the local process
+    void nextBinarySection_(const std::string& cookie, const char*& data, size_t& size)
+    {
+        size_t pos = blockPos_;
+        std::string fileCookie;
+        readBinarySection_(binaryBlock_, pos, fileName_, fileCookie, data, size);
+        if (fileCookie != cookie)
+            throw std::runtime_error("Could not start section '"+cookie+"'");
+        blockPos_ = pos;
+    }
+
+    // read the section at a given position of a data block and advance the position
+    // to the next section
+    static void readBinarySection_(const std::string& block,
+                                   size_t& pos,
+                                   const std::string& fileName,
+                                   std::string& cookie,
+                                   const char*& data,
+                                   size_t& size)
+    {
+        uint64_t cookieSize;
+        readFromBlock_(block, pos, &cookieSize, sizeof(cookieSize));
+        if (pos + cookieSize > block.size())
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+        cookie.assign(block.data() + pos, cookieSize);
+        pos += cookieSize;
+
+        uint64_t dataSize;
+        readFromBlock_(block, pos, &dataSize, sizeof(dataSize));
+        if (pos + dataSize + sizeof(uint64_t) > block.size())
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+        data = block.data() + pos;
+        size = dataSize;
+        pos += dataSize;
+
+        uint64_t checksum;
+        readFromBlock_(block, pos, &checksum, sizeof(checksum));
+        if (checksum != checksum_(data, size))
+            throw std::runtime_error("The checksum of section '"+cookie+"' of restart file '"
+                                     +fileName+"' does not match");
+    }
+
+    // returns the cookie of the next section of the data block of the local process
+    // without reading the section (empty if there are no further sections)
+    std::string peekBinarySectionCookie_() const
+    {
+        uint64_t cookieSize;
+        if (blockPos_ + sizeof(cookieSize) > binaryBlock_.size())
+            return "";
+        std::memcpy(&cookieSize, binaryBlock_.data() + blockPos_, sizeof(cookieSize));
+        if (blockPos_ + sizeof(cookieSize) + cookieSize > binaryBlock_.size())
+            return "";
+        return std::string(binaryBlock_.data() + blockPos_ + sizeof(cookieSize), cookieSize);
+    }
+
+    static void readFromBlock_(const std::string& block, size_t& pos, void* dest, size_t size)
+    {
+        if (pos + size > block.size())
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+        std::memcpy(dest, block.data() + pos, size);
+        pos += size;
+    }
+
+    static const std::string& deltaBaseCookie_()
+    {
+        static const std::string cookie = "Delta Base";
+        return cookie;
+    }
+
+    static std::string deltaCookie_(const std::string& cookie)
+    { return "Delta "+cookie; }
+
+    // encode the data of an entity section relative to the one of the base file. the
+    // layout is: number of entities, a bitmap which marks the changed entities, the
+    // data of the changed entities
+    static std::string entityDelta_(const DeltaBase::EntitySection_& base,
+                                    const std::string& data,
+                                    const std::vector<uint64_t>& offsets)
+    {
+        uint64_t numEntities = offsets.size() - 1;
+        std::string bitmap((numEntities + 7)/8, '\0');
+        std::string changedData;
+        for (uint64_t entityIdx = 0; entityIdx < numEntities; ++entityIdx) {
+            uint64_t begin = offsets[entityIdx];
+            uint64_t size = offsets[entityIdx + 1] - begin;
+            uint64_t baseBegin = base.offsets[entityIdx];
+            uint64_t baseSize = base.offsets[entityIdx + 1] - baseBegin;
+            if (size == baseSize
+                && std::memcmp(data.data() + begin, base.data.data() + baseBegin, size) == 0)
+                continue;
+
+            bitmap[entityIdx/8] = static_cast<char>(bitmap[entityIdx/8] | (1 << (entityIdx%8)));
+            changedData.append(data, begin, size);
+        }
+
+        std::string result(reinterpret_cast<const char*>(&numEntities), sizeof(numEntities));
+        result += bitmap;
+        result += changedData;
+        return result;
+    }
+
+    // deserialize the entities of a delta section. the unchanged entities are read
+    // from the corresponding section of the base file. since the size of the data of
+    // an entity is not stored, all entities are read from the base data and the
+    // changed ones are overwritten afterwards.
+    template <int codim, class Deserializer, class GridView>
+    void deserializeEntityDelta_(Deserializer& deserializer,
+                                 const GridView& gridView,
+                                 const std::string& cookie,
+                                 const char* data,
+                                 size_t size)
+    {
+        auto baseIt = baseSections_.find(cookie);
+        if (baseIt == baseSections_.end())
+            throw std::runtime_error("The base of delta restart file '"+fileName_+"' does "
+                                     "not contain section '"+cookie+"'");
+
+        uint64_t numEntities;
+        if (size < sizeof(numEntities))
+            throw std::runtime_error("Restart file is corrupted");
+        std::memcpy(&numEntities, data, sizeof(numEntities));
+        size_t bitmapSize = static_cast<size_t>((numEntities + 7)/8);
+        if (size < sizeof(numEntities) + bitmapSize)
+            throw std::runtime_error("Restart file is corrupted");
+        const char* bitmap = data + sizeof(numEntities);
+
+        RestartBinaryInputStream baseStream(baseIt->second.first, baseIt->second.second);
+        RestartBinaryInputStream deltaStream(bitmap + bitmapSize,
+                                             size - sizeof(numEntities) - bitmapSize);
+
+        using Iterator = typename GridView::template Codim<codim>::Iterator;
+        Iterator it = gridView.template begin<codim>();
+        const Iterator& endIt = gridView.template end<codim>();
+        uint64_t entityIdx = 0;
+        for (; it != endIt; ++it, ++entityIdx) {
+            if (entityIdx >= numEntities || !baseStream.good() || !deltaStream.good())
+                throw std::runtime_error("Restart file is corrupted");
+
+            deserializer.deserializeEntity(baseStream, *it);
+            if (bitmap[entityIdx/8] & (1 << (entityIdx%8)))
+                deserializer.deserializeEntity(deltaStream, *it);
+        }
+
+        if (entityIdx != numEntities || !baseStream.atEnd() || !deltaStream.atEnd())
+            throw std::logic_error("Encountered unread values while deserializing");
+    }
+
+    // determine the position of the data blocks of all processes. this must be called
+    // by all processes
+    void computeBinaryBlocks_(std::vector<BinaryBlock_>& blocks) const
+    {
+        blocks.resize(static_cast<size_t>(numProcesses_));
+        uint64_t localSize = binaryBlock_.size();
+        std::vector<uint64_t> sizes(static_cast<size_t>(numProcesses_), localSize);
+#if HAVE_MPI
+        if (numProcesses_ > 1)
+            MPI_Allgather(&localSize, 1, MPI_UINT64_T,
+                          sizes.data(), 1, MPI_UINT64_T,
+                          Dune::MPIHelper::getCommunicator());
+#endif
+        uint64_t offset = sizeof(BinaryHeader_) + blocks.size()*sizeof(BinaryBlock_);
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            blocks[i].offset = offset;
+            blocks[i].size = sizes[i];
+            offset += sizes[i];
+        }
+    }
+
+    BinaryHeader_ binaryHeader_() const
+    {
+        BinaryHeader_ header;
+        std::memcpy(header.magic, binaryMagic_(), sizeof(header.magic));
+        header.version = binaryVersion_;
+        header.numProcesses = static_cast<uint32_t>(numProcesses_);
+        return header;
+    }
+
+    void writeBinaryFile_()
+    {
+        std::vector<BinaryBlock_> blocks;
+        computeBinaryBlocks_(blocks);
+        uint64_t localSize = binaryBlock_.size();
+        BinaryHeader_ header = binaryHeader_();
+
+#if HAVE_MPI
+        if (numProcesses_ > 1) {
+            MPI_Comm comm = Dune::MPIHelper::getCommunicator();
+            if (rank_ == 0)
+                MPI_File_delete(const_cast<char*>(fileName_.c_str()), MPI_INFO_NULL);
+            MPI_Barrier(comm);
+
+            MPI_File file;
+            if (MPI_File_open(comm, const_cast<char*>(fileName_.c_str()),
+                              MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS)
+                throw std::runtime_error("Could not open restart file '"+fileName_+"' for writing");
+
+            if (rank_ == 0) {
+                MPI_File_write_at(file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+                MPI_File_write_at(file, sizeof(header), blocks.data(),
+                                  static_cast<int>(blocks.size()*sizeof(BinaryBlock_)),
+                                  MPI_BYTE, MPI_STATUS_IGNORE);
+            }
+
+            // MPI uses int to specify the number of bytes, so large blocks are written in
+            // multiple chunks
+            const uint64_t maxChunkSize = 1ULL << 30;
+            uint64_t numChunks = (localSize + maxChunkSize - 1)/maxChunkSize;
+            MPI_Allreduce(MPI_IN_PLACE, &numChunks, 1, MPI_UINT64_T, MPI_MAX, comm);
+            const BinaryBlock_& localBlock = blocks[static_cast<size_t>(rank_)];
+            for (uint64_t chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx) {
+                uint64_t begin = std::min(localSize, chunkIdx*maxChunkSize);
+                uint64_t end = std::min(localSize, begin + maxChunkSize);
+                MPI_File_write_at_all(file,
+                                      static_cast<MPI_Offset>(localBlock.offset + begin),
+                                      const_cast<char*>(binaryBlock_.data() + begin),
+                                      static_cast<int>(end - begin),
+                                      MPI_BYTE,
+                                      MPI_STATUS_IGNORE);
+            }
+            MPI_File_close(&file);
+            binaryBlock_.clear();
+            return;
+        }
+#endif
+
+        std::ofstream file(fileName_.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(blocks.data()),
+                   static_cast<std::streamsize>(blocks.size()*sizeof(BinaryBlock_)));
+        file.write(binaryBlock_.data(), static_cast<std::streamsize>(binaryBlock_.size()));
+        if (!file.good())
+            throw std::runtime_error("Could not write restart file '"+fileName_+"'");
+        binaryBlock_.clear();
+    }
+
+    // read the data block of the local process. since each process only reads its own
+    // contiguous block, this does not need to be done collectively
+    void readBinaryFile_(const std::string& fileName, std::string& block) const
+    {
+        std::ifstream file(fileName.c_str(), std::ios::binary);
+
+        BinaryHeader_ header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file.good() || std::memcmp(header.magic, binaryMagic_(), sizeof(header.magic)) != 0)
+            throw std::runtime_error("File '"+fileName+"' is not a binary restart file");
+        if (header.version != binaryVersion_)
+            throw std::runtime_error("Binary restart file '"+fileName+"' uses an unsupported version "
+                                     "of the file format");
+        if (header.numProcesses != static_cast<uint32_t>(numProcesses_))
+            throw std::runtime_error("Binary restart file '"+fileName+"' was written by "
+                                     +std::to_string(header.numProcesses)+" processes, but "
+                                     +std::to_string(numProcesses_)+" are used");
+
+        BinaryBlock_ blockInfo;
+        file.seekg(static_cast<std::streamoff>(sizeof(header) + static_cast<size_t>(rank_)*sizeof(BinaryBlock_)));
+        file.read(reinterpret_cast<char*>(&blockInfo), sizeof(blockInfo));
+
+        block.resize(blockInfo.size);
+        file.seekg(static_cast<std::streamoff>(blockInfo.offset));
+        file.read(&block[0], static_cast<std::streamsize>(blockInfo.size));
+        if (!file.good())
+            throw std::runtime_error("Binary restart file '"+fileName+"' is corrupted");
+    }
+
     std::string fileName_;
     std::ifstream inStream_;
     std::ofstream outStream_;
+
+    bool binary_;
+    int rank_;
+    int numProcesses_;
+
+    // the data of the local process for binary restart files and the part of it which
+    // has already been read
+    std::string binaryBlock_;
+    size_t blockPos_;
+
+    // the entity data of the full file which is recorded while writing it, the full
+    // file which a delta file refers to while writing it, and the data block of the
+    // full file and its sections while reading a delta file
+    bool recordDeltaBase_;
+    std::shared_ptr<DeltaBase> recordedDeltaBase_;
+    std::shared_ptr<const DeltaBase> deltaBase_;
+    std::string baseBlock_;
+    std::map<std::string, std::pair<const char*, size_t> > baseSections_;
+
+    // the position of the data of the local process within a binary restart file which
+    // has been prepared by prepareBinaryFile()
+    uint64_t localBlockOffset_;
+
+    // the section which is currently written or read for binary restart files
+    std::string sectionCookie_;
+    std::ostringstream sectionStream_;
+    std::istringstream sectionInStream_;
 };
 } // namespace Opm
 
@@ -0,0 +1,516 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::SampledOutputWriter
+ */
+#ifndef EWOMS_SAMPLED_OUTPUT_WRITER_HH
+#define EWOMS_SAMPLED_OUTPUT_WRITER_HH
+
+#include <opm/models/io/baseoutputwriter.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/partitionset.hh>
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <list>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Writes a spatially decimated subset of the visualization output.
+ *
+ * This is intended for monitoring long simulations: Only every k-th interior element
+ * whose center is located within an optional bounding box is written, and optionally
+ * only a selection of the fields. The sampled elements are written as a cloud of points
+ * located at their centers using the VTK PolyData format, vertex centered fields are
+ * averaged over the corners of the sampled elements. Each process writes a separate
+ * file per time step, the first process maintains a collection file which can be
+ * opened by ParaView.
+ */
+template <class GridView>
+class SampledOutputWriter : public BaseOutputWriter
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+
+    using GlobalPosition = Dune::FieldVector<double, dimWorld>;
+
+    // the values of a field at the sampled elements
+    struct SampledField {
+        std::string name;
+        unsigned numComponents;
+        std::vector<double> values;
+    };
+
+public:
+    using Scalar = BaseOutputWriter::Scalar;
+    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
+    using VectorBuffer = BaseOutputWriter::VectorBuffer;
+    using TensorBuffer = BaseOutputWriter::TensorBuffer;
+
+    /*!
+     * \brief Create a writer for decimated output.
+     *
+     * \param gridView The grid view which is written
+     * \param outputDir The directory into which the files are written
+     * \param simName The prefix of the file names
+     * \param stride Only every stride-th interior element of a process is written
+     * \param region A comma separated list of the minimum and the maximum coordinates of
+     *               the bounding box which must contain the centers of the written
+     *               elements. If empty, the whole grid is sampled.
+     * \param fieldNames A comma separated list of the names of the fields which are
+     *                   written. If empty, all fields are written.
+     */
+    SampledOutputWriter(const GridView& gridView,
+                        const std::string& outputDir,
+                        const std::string& simName,
+                        unsigned stride,
+                        const std::string& region = "",
+                        const std::string& fieldNames = "")
+        : gridView_(gridView)
+        , elementMapper_(gridView, Dune::mcmgElementLayout())
+        , vertexMapper_(gridView, Dune::mcmgVertexLayout())
+        , stride_(std::max(1u, stride))
+        , curWriterNum_(0)
+    {
+        outputDir_ = outputDir;
+        if (outputDir == "")
+            outputDir_ = ".";
+
+        simName_ = (simName.empty()) ? "sim" : simName;
+        commRank_ = gridView.comm().rank();
+        commSize_ = gridView.comm().size();
+
+        regionMin_ = -std::numeric_limits<double>::max();
+        regionMax_ = std::numeric_limits<double>::max();
+        if (!region.empty()) {
+            const auto& coords = splitList_(region);
+            if (coords.size() != 2*dimWorld)
+                throw std::runtime_error("The region of the sampled output must be specified "
+                                         "by "+std::to_string(2*dimWorld)+" comma separated "
+                                         "coordinates, got '"+region+"'");
+            for (unsigned i = 0; i < dimWorld; ++i) {
+                regionMin_[i] = std::stod(coords[i]);
+                regionMax_[i] = std::stod(coords[dimWorld + i]);
+            }
+        }
+
+        for (const auto& name : splitList_(fieldNames))
+            fieldNames_.push_back(name);
+
+        updateSamples_();
+    }
+
+    /*!
+     * \brief Returns the number of the current output file.
+     */
+    int curWriterNum() const
+    { return curWriterNum_; }
+
+    /*!
+     * \brief Returns the number of elements written by the local process.
+     */
+    size_t numSamples() const
+    { return sampledElements_.size(); }
+
+    /*!
+     * \brief Updates the internal data structures after the grid was modified.
+     */
+    void gridChanged()
+    {
+        elementMapper_.update();
+        vertexMapper_.update();
+        updateSamples_();
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::beginWrite
+     */
+    void beginWrite(double t)
+    {
+        curTime_ = t;
+        fields_.clear();
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarVertexData
+     *
+     * The values of the sampled elements are copied, the buffer may thus be modified
+     * after this method has returned.
+     */
+    void attachScalarVertexData(ScalarBuffer& buf, std::string name)
+    {
+        if (!isSelected_(name))
+            return;
+
+        auto& field = addField_(name, /*numComponents=*/1);
+        for (size_t sampleIdx = 0; sampleIdx < sampledElements_.size(); ++sampleIdx)
+            field.values[sampleIdx] = averageVertexValues_(buf, sampleIdx);
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarElementData
+     *
+     * The values of the sampled elements are copied, the buffer may thus be modified
+     * after this method has returned.
+     */
+    void attachScalarElementData(ScalarBuffer& buf, std::string name)
+    {
+        if (!isSelected_(name))
+            return;
+
+        auto& field = addField_(name, /*numComponents=*/1);
+        for (size_t sampleIdx = 0; sampleIdx < sampledElements_.size(); ++sampleIdx)
+            field.values[sampleIdx] = buf[sampledElements_[sampleIdx]];
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorVertexData
+     */
+    void attachVectorVertexData(VectorBuffer& buf, std::string name)
+    {
+        if (isSelected_(name))
+            sampleVectorData_(buf, name, /*vertexCentered=*/true);
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorElementData
+     */
+    void attachVectorElementData(VectorBuffer& buf, std::string name)
+    {
+        if (isSelected_(name))
+            sampleVectorData_(buf, name, /*vertexCentered=*/false);
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorVertexData
+     *
+     * Like for the VTK output, each column of the tensors is written as a separate
+     * vector field.
+     */
+    void attachTensorVertexData(TensorBuffer& buf, std::string name)
+    { attachTensorData_(buf, name, /*vertexCentered=*/true); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorElementData
+     *
+     * Like for the VTK output, each column of the tensors is written as a separate
+     * vector field.
+     */
+    void attachTensorElementData(TensorBuffer& buf, std::string name)
+    { attachTensorData_(buf, name, /*vertexCentered=*/false); }
+
+    /*!
+     * \copydoc BaseOutputWriter::endWrite
+     */
+    void endWrite(bool onlyDiscard = false)
+    {
+        if (onlyDiscard) {
+            fields_.clear();
+            return;
+        }
+
+        writePieceFile_(pieceFileName_(commRank_));
+        fields_.clear();
+
+        if (commRank_ == 0) {
+            std::ostringstream entry;
+            entry.precision(16);
+            for (int rank = 0; rank < commSize_; ++rank)
+                entry << "   <DataSet timestep=\"" << curTime_ << "\" part=\"" << rank
+                      << "\" file=\"" << pieceFileName_(rank) << "\"/>\n";
+            timeStepEntries_ += entry.str();
+            writeCollectionFile_();
+        }
+
+        ++curWriterNum_;
+    }
+
+    /*!
+     * \brief Write the writer's state to a restart file.
+     */
+    template <class Restarter>
+    void serialize(Restarter& res)
+    {
+        res.serializeSectionBegin("SampledOutputWriter");
+        res.serializeStream() << curWriterNum_ << "\n";
+        if (commRank_ == 0) {
+            res.serializeStream() << timeStepEntries_.size() << "\n";
+            res.serializeStream().write(timeStepEntries_.data(),
+                                        static_cast<std::streamsize>(timeStepEntries_.size()));
+        }
+        res.serializeSectionEnd();
+    }
+
+    /*!
+     * \brief Read the writer's state from a restart file.
+     */
+    template <class Restarter>
+    void deserialize(Restarter& res)
+    {
+        res.deserializeSectionBegin("SampledOutputWriter");
+        res.deserializeStream() >> curWriterNum_;
+
+        std::string dummy;
+        std::getline(res.deserializeStream(), dummy);
+        if (commRank_ == 0) {
+            size_t len;
+            res.deserializeStream() >> len;
+            std::getline(res.deserializeStream(), dummy);
+            timeStepEntries_.resize(len);
+            res.deserializeStream().read(&timeStepEntries_[0], static_cast<std::streamsize>(len));
+        }
+        res.deserializeSectionEnd();
+    }
+
+private:
+    static std::vector<std::string> splitList_(const std::string& list)
+    {
+        std::vector<std::string> result;
+        std::istringstream iss(list);
+        std::string item;
+        while (std::getline(iss, item, ',')) {
+            // strip leading and trailing white space
+            const auto beginPos = item.find_first_not_of(" \t");
+            if (beginPos == std::string::npos)
+                continue;
+            const auto endPos = item.find_last_not_of(" \t");
+            result.push_back(item.substr(beginPos, endPos - beginPos + 1));
+        }
+
+        return result;
+    }
+
+    // determine the interior elements of the local process which are written
+    void updateSamples_()
+    {
+        sampledElements_.clear();
+        sampledVertices_.clear();
+        centers_.clear();
+
+        unsigned interiorIdx = 0;
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            if (interiorIdx++ % stride_ != 0)
+                continue;
+
+            const auto& center = elem.geometry().center();
+            bool inRegion = true;
+            for (unsigned i = 0; i < dimWorld; ++i)
+                inRegion = inRegion && regionMin_[i] <= center[i] && center[i] <= regionMax_[i];
+            if (!inRegion)
+                continue;
+
+            sampledElements_.push_back(static_cast<unsigned>(elementMapper_.index(elem)));
+            centers_.push_back(center);
+
+            sampledVertices_.emplace_back();
+            auto& vertices = sampledVertices_.back();
+            const unsigned numVertices = elem.subEntities(dim);
+            for (unsigned localVertIdx = 0; localVertIdx < numVertices; ++localVertIdx)
+                vertices.push_back(static_cast<unsigned>(
+                    vertexMapper_.subIndex(elem, static_cast<int>(localVertIdx), dim)));
+        }
+    }
+
+    bool isSelected_(const std::string& name) const
+    {
+        if (fieldNames_.empty())
+            return true;
+
+        return std::find(fieldNames_.begin(), fieldNames_.end(), name) != fieldNames_.end();
+    }
+
+    SampledField& addField_(const std::string& name, unsigned numComponents)
+    {
+        fields_.push_back(SampledField{name, numComponents, {}});
+        fields_.back().values.resize(numComponents*sampledElements_.size());
+        return fields_.back();
+    }
+
+    double averageVertexValues_(const ScalarBuffer& buf, size_t sampleIdx) const
+    {
+        const auto& vertices = sampledVertices_[sampleIdx];
+        double sum = 0.0;
+        for (unsigned vertIdx : vertices)
+            sum += buf[vertIdx];
+        return sum/std::max<size_t>(1, vertices.size());
+    }
+
+    void sampleVectorData_(const VectorBuffer& buf, const std::string& name, bool vertexCentered)
+    {
+        if (buf.empty())
+            return;
+
+        const unsigned numComponents = static_cast<unsigned>(buf[0].size());
+        auto& field = addField_(name, numComponents);
+        for (size_t sampleIdx = 0; sampleIdx < sampledElements_.size(); ++sampleIdx) {
+            double* value = &field.values[sampleIdx*numComponents];
+            if (!vertexCentered) {
+                const auto& v = buf[sampledElements_[sampleIdx]];
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    value[compIdx] = v[compIdx];
+                continue;
+            }
+
+            const auto& vertices = sampledVertices_[sampleIdx];
+            for (unsigned vertIdx : vertices)
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    value[compIdx] += buf[vertIdx][compIdx]/vertices.size();
+        }
+    }
+
+    void attachTensorData_(const TensorBuffer& buf, const std::string& name, bool vertexCentered)
+    {
+        if (!isSelected_(name) || buf.empty())
+            return;
+
+        // extract the columns of the tensors into vector buffers
+        const unsigned numCols = static_cast<unsigned>(buf[0].M());
+        for (unsigned colIdx = 0; colIdx < numCols; ++colIdx) {
+            VectorBuffer colBuf(buf.size());
+            for (size_t i = 0; i < buf.size(); ++i) {
+                colBuf[i].resize(buf[i].N());
+                for (unsigned rowIdx = 0; rowIdx < buf[i].N(); ++rowIdx)
+                    colBuf[i][rowIdx] = buf[i][rowIdx][colIdx];
+            }
+
+            std::ostringstream oss;
+            oss << name << "[" << colIdx << "]";
+            sampleVectorData_(colBuf, oss.str(), vertexCentered);
+        }
+    }
+
+    std::string pieceFileName_(int rank) const
+    {
+        std::ostringstream oss;
+        oss << simName_ << "-sampled";
+        if (commSize_ > 1)
+            oss << "-p" << std::setw(4) << std::setfill('0') << rank;
+        oss << "-" << std::setw(5) << std::setfill('0') << curWriterNum_ << ".vtp";
+        return oss.str();
+    }
+
+    void writePieceFile_(const std::string& fileName) const
+    {
+        std::ofstream file(outputDir_ + "/" + fileName);
+        file.precision(std::numeric_limits<double>::digits10 + 1);
+
+        const size_t numSamples = sampledElements_.size();
+        file << "<?xml version=\"1.0\"?>\n"
+             << "<VTKFile type=\"PolyData\" version=\"0.1\" byte_order=\"LittleEndian\">\n"
+             << " <PolyData>\n"
+             << "  <Piece NumberOfPoints=\"" << numSamples << "\" NumberOfVerts=\"" << numSamples
+             << "\" NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"0\">\n";
+
+        file << "   <PointData>\n";
+        for (const auto& field : fields_) {
+            file << "    <DataArray type=\"Float64\" Name=\"" << field.name
+                 << "\" NumberOfComponents=\"" << field.numComponents << "\" format=\"ascii\">\n";
+            for (double value : field.values)
+                file << value << " ";
+            file << "\n    </DataArray>\n";
+        }
+        file << "   </PointData>\n";
+
+        // VTK always uses three dimensional coordinates
+        file << "   <Points>\n"
+             << "    <DataArray type=\"Float64\" NumberOfComponents=\"3\" format=\"ascii\">\n";
+        for (const auto& center : centers_) {
+            for (unsigned i = 0; i < 3; ++i)
+                file << ((i < dimWorld) ? center[i] : 0.0) << " ";
+            file << "\n";
+        }
+        file << "    </DataArray>\n"
+             << "   </Points>\n";
+
+        // each point is a separate vertex cell
+        file << "   <Verts>\n"
+             << "    <DataArray type=\"Int64\" Name=\"connectivity\" format=\"ascii\">\n";
+        for (size_t i = 0; i < numSamples; ++i)
+            file << i << " ";
+        file << "\n    </DataArray>\n"
+             << "    <DataArray type=\"Int64\" Name=\"offsets\" format=\"ascii\">\n";
+        for (size_t i = 0; i < numSamples; ++i)
+            file << i + 1 << " ";
+        file << "\n    </DataArray>\n"
+             << "   </Verts>\n"
+             << "  </Piece>\n"
+             << " </PolyData>\n"
+             << "</VTKFile>\n";
+    }
+
+    // the collection file is rewritten completely for each time step so that it can
+    // always be opened, even if the simulation is aborted
+    void writeCollectionFile_() const
+    {
+        std::ofstream collectionFile(outputDir_ + "/" + simName_ + "-sampled.pvd");
+        collectionFile << "<?xml version=\"1.0\"?>\n"
+                       << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\">\n"
+                       << " <Collection>\n"
+                       << timeStepEntries_
+                       << " </Collection>\n"
+                       << "</VTKFile>\n";
+    }
+
+    const GridView gridView_;
+    ElementMapper elementMapper_;
+    VertexMapper vertexMapper_;
+
+    std::string outputDir_;
+    std::string simName_;
+    int commSize_; // number of processes in the communicator
+    int commRank_; // rank of the current process in the communicator
+
+    unsigned stride_;
+    GlobalPosition regionMin_;
+    GlobalPosition regionMax_;
+    std::vector<std::string> fieldNames_;
+
+    // the indices, corner vertices and centers of the written elements
+    std::vector<unsigned> sampledElements_;
+    std::vector<std::vector<unsigned>> sampledVertices_;
+    std::vector<GlobalPosition> centers_;
+
+    double curTime_;
+    int curWriterNum_;
+    std::list<SampledField> fields_;
+
+    // the entries of all time steps written so far. only used by the first process
+    std::string timeStepEntries_;
+};
+} // namespace Opm
+
+#endif
@@ -28,20 +28,20 @@
 #define EWOMS_STRUCTURED_GRID_VANGUARD_HH
 
 #include <opm/models/io/basevanguard.hh>
+#include <opm/models/io/distributedstructuredgrid.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 
 #include <dune/grid/yaspgrid.hh>
-#include <dune/grid/io/file/dgfparser/dgfyasp.hh>
 
 #if HAVE_DUNE_ALUGRID
 #include <dune/alugrid/grid.hh>
-#include <dune/alugrid/dgf.hh>
 #endif
 
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <array>
 #include <vector>
 #include <memory>
 
@@ -96,7 +96,9 @@ class StructuredGridVanguard : public BaseVanguard<TypeTag>
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using Grid = GetPropType<TypeTag, Properties::Grid>;
 
-    using GridPointer = std::unique_ptr<Grid>;
+    // depending on the grid, the structured grid factory returns a unique or a shared
+    // pointer
+    using GridPointer = std::shared_ptr<Grid>;
 
     static const int dim = Grid::dimension;
 
@@ -133,7 +135,7 @@ public:
     StructuredGridVanguard(Simulator& simulator)
         : ParentType(simulator)
     {
-        Dune::FieldVector<int, dim> cellRes;
+        std::array<unsigned, dim> cellRes;
 
         using GridScalar = double;
         Dune::FieldVector<GridScalar, dim> upperRight;
@@ -149,21 +151,10 @@ public:
             cellRes[2] = EWOMS_GET_PARAM(TypeTag, unsigned, CellsZ);
         }
 
-        std::stringstream dgffile;
-        dgffile << "DGF" << std::endl;
-        dgffile << "INTERVAL" << std::endl;
-        dgffile << lowerLeft  << std::endl;
-        dgffile << upperRight << std::endl;
-        dgffile << cellRes    << std::endl;
-        dgffile << "#" << std::endl;
-        dgffile << "GridParameter" << std::endl;
-        dgffile << "overlap 1" << std::endl;
-        dgffile << "#" << std::endl;
-        dgffile << "Simplex" << std::endl;
-        dgffile << "#" << std::endl;
-
-        // use DGF parser to create a grid from interval block
-        gridPtr_.reset( Dune::GridPtr< Grid >( dgffile ).release() );
+        // for YaspGrid and cube ALUGrids, each process only creates its own part of
+        // the grid. this avoids creating the whole grid on the first process and
+        // distributing it afterwards
+        gridPtr_ = Dune::StructuredGridFactory<Grid>::createCubeGrid(lowerLeft, upperRight, cellRes);
 
         unsigned numRefinements = EWOMS_GET_PARAM(TypeTag, unsigned, GridGlobalRefinements);
         gridPtr_->globalRefine(static_cast<int>(numRefinements));
@@ -171,6 +162,19 @@ public:
         this->finalizeInit_();
     }
 
+    /*!
+     * \brief Distribute the grid over all processes.
+     *
+     * This is a no-op if the grid was created in a distributed fashion.
+     */
+    void loadBalance()
+    {
+        if (CreatesDistributedCubeGrid<Grid>::value)
+            this->updateGridView_();
+        else
+            ParentType::loadBalance();
+    }
+
     /*!
      * \brief Return a reference to the grid object.
      */
@@ -0,0 +1,421 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::TimeSeriesOutput
+ */
+#ifndef EWOMS_TIME_SERIES_OUTPUT_HH
+#define EWOMS_TIME_SERIES_OUTPUT_HH
+
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/parallel/chunkedentityiterator.hh>
+#include <opm/models/parallel/threadmanager.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/grid/common/gridenums.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief The ways in which a quantity can be reduced over a region.
+ */
+enum class TimeSeriesReduction {
+    Integral, //!< The integral of the quantity over the region
+    Average, //!< The volume weighted average of the quantity over the region
+    Minimum, //!< The minimum of the quantity within the region
+    Maximum //!< The maximum of the quantity within the region
+};
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Computes reductions of quantities over regions of the grid and writes them
+ *        to a time series file.
+ *
+ * This is much cheaper than writing full fields if only integrated quantities are
+ * required for monitoring a simulation. The quantities are evaluated for the primary
+ * degrees of freedom of all interior elements using all threads, and the partial
+ * results of all processes are combined using a single collective operation. The
+ * first process then appends one line per call of write() to a file in CSV format.
+ *
+ * By default, the integrals of the storage terms of all conservation equations (i.e.,
+ * the total mass of each component for most models) over the whole grid are computed.
+ * Problems can add further quantities and subdivide the grid into regions.
+ */
+template <class TypeTag>
+class TimeSeriesOutput
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ChunkedElementIterator = ChunkedEntityIterator<GridView, /*codim=*/0>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+public:
+    /*!
+     * \brief Returns the value of a quantity for a primary degree of freedom of an
+     *        element context.
+     *
+     * The primary stencil and the intensive quantities of the most recent solution of
+     * the context are up to date. Integrated quantities are specified per unit volume.
+     */
+    using QuantityFunction = std::function<Scalar(const ElementContext&, unsigned dofIdx)>;
+
+    /*!
+     * \brief Returns the index of the region of a primary degree of freedom of an
+     *        element context.
+     */
+    using RegionFunction = std::function<unsigned(const ElementContext&, unsigned dofIdx)>;
+
+    TimeSeriesOutput(const Simulator& simulator, const std::string& fileName)
+        : simulator_(simulator)
+        , fileName_(fileName)
+        , regionNames_{"total"}
+        , storageQuantities_(false)
+        , time_(0.0)
+        , headerWritten_(false)
+    { }
+
+    /*!
+     * \brief Register all run-time parameters for the time series output.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableTimeSeriesOutput,
+                             "Write the integrals of the storage terms and of the "
+                             "quantities specified by the problem over the regions of "
+                             "the grid to a time series file");
+    }
+
+    /*!
+     * \brief Add the integrals of the storage terms of all conservation equations.
+     */
+    void addStorageQuantities()
+    { storageQuantities_ = true; }
+
+    /*!
+     * \brief Add a quantity which is reduced over each region.
+     *
+     * \param name The name of the quantity in the time series file
+     * \param reduction The way in which the quantity is reduced over the regions
+     * \param fn The function which evaluates the quantity
+     */
+    void addQuantity(const std::string& name, TimeSeriesReduction reduction, QuantityFunction fn)
+    {
+        if (headerWritten_)
+            throw std::logic_error("Quantities cannot be added to a time series after it "
+                                   "has been started");
+
+        quantities_.push_back(Quantity{name, reduction, std::move(fn)});
+    }
+
+    /*!
+     * \brief Subdivide the grid into regions.
+     *
+     * \param regionNames The names of the regions in the time series file
+     * \param fn The function which determines the region of a degree of freedom.
+     *           Degrees of freedom for which it returns an index beyond the number of
+     *           regions are not considered.
+     */
+    void setRegions(const std::vector<std::string>& regionNames, RegionFunction fn)
+    {
+        if (headerWritten_)
+            throw std::logic_error("The regions of a time series cannot be changed after "
+                                   "it has been started");
+
+        regionNames_ = regionNames;
+        regionFn_ = std::move(fn);
+    }
+
+    /*!
+     * \brief Returns the number of regions.
+     */
+    size_t numRegions() const
+    { return regionNames_.size(); }
+
+    /*!
+     * \brief Returns the number of reduced quantities including the storage terms.
+     */
+    size_t numQuantities() const
+    { return (storageQuantities_ ? numEq : 0) + quantities_.size(); }
+
+    /*!
+     * \brief Returns the reduced value of a quantity over a region as determined by the
+     *        most recent call of update().
+     *
+     * The storage terms come first if they are enabled. The values are available on all
+     * processes.
+     */
+    Scalar value(unsigned quantityIdx, unsigned regionIdx) const
+    { return values_[quantityIdx*numRegions() + regionIdx]; }
+
+    /*!
+     * \brief Evaluate all reductions for the current solution.
+     *
+     * This method must be called by all processes.
+     *
+     * \param time The time to which the current solution corresponds
+     */
+    void update(Scalar time)
+    {
+        time_ = time;
+
+        // the layout of the partial results: the integrals and averages use two slots
+        // (the integral of the quantity and the volume), the extrema use one
+        const size_t numSlots = 2*numQuantities()*numRegions();
+        std::vector<Scalar> localResult(numSlots);
+        initialize_(localResult);
+
+        const auto& model = simulator_.model();
+        const auto& elementSeeds = model.elementSeeds();
+        ChunkedElementIterator chunkedElemIt(elementSeeds, model.threadedElementChunkSize());
+        std::mutex resultMutex;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            unsigned threadId = ThreadManager::threadId();
+            ElementContext elemCtx(simulator_);
+            std::vector<Scalar> threadResult(numSlots);
+            initialize_(threadResult);
+            std::vector<Scalar> dofValues(numQuantities());
+
+            size_t beginIdx, endIdx;
+            while (chunkedElemIt.nextChunk(beginIdx, endIdx)) {
+                for (size_t elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                    if (!elementSeeds.isInterior(elemIdx))
+                        continue; // ignore ghost and overlap elements
+                    const Element elem = elementSeeds.entity(elemIdx);
+
+                    elemCtx.updatePrimaryStencil(elem);
+                    elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+
+                    size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                        unsigned regionIdx = regionFn_ ? regionFn_(elemCtx, dofIdx) : 0;
+                        if (regionIdx >= numRegions())
+                            continue;
+
+                        unsigned qIdx = 0;
+                        if (storageQuantities_) {
+                            Dune::FieldVector<Scalar, numEq> storage;
+                            model.localResidual(threadId).computeStorage(storage,
+                                                                         elemCtx,
+                                                                         dofIdx,
+                                                                         /*timeIdx=*/0);
+                            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                                dofValues[qIdx++] = storage[eqIdx];
+                        }
+                        for (const auto& quantity : quantities_)
+                            dofValues[qIdx++] = quantity.fn(elemCtx, dofIdx);
+
+                        Scalar volume =
+                            elemCtx.stencil(/*timeIdx=*/0).subControlVolume(dofIdx).volume()
+                            * elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
+                        accumulate_(threadResult, dofValues, regionIdx, volume);
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(resultMutex);
+            combine_(localResult, threadResult);
+        }
+
+        // gather the partial results of all processes using a single collective
+        // operation. since the result vector is small, combining it redundantly on
+        // all processes is cheaper than a separate reduction for each kind of extremum
+        const auto& comm = simulator_.gridView().comm();
+        std::vector<Scalar> allResults(numSlots*static_cast<size_t>(comm.size()));
+        comm.allgather(localResult.data(), static_cast<int>(numSlots), allResults.data());
+
+        std::vector<Scalar> globalResult(numSlots);
+        initialize_(globalResult);
+        for (int rank = 0; rank < comm.size(); ++rank) {
+            std::vector<Scalar> rankResult(allResults.begin() + rank*numSlots,
+                                           allResults.begin() + (rank + 1)*numSlots);
+            combine_(globalResult, rankResult);
+        }
+
+        values_.resize(numQuantities()*numRegions());
+        for (unsigned qIdx = 0; qIdx < numQuantities(); ++qIdx) {
+            for (unsigned regionIdx = 0; regionIdx < numRegions(); ++regionIdx) {
+                size_t idx = qIdx*numRegions() + regionIdx;
+                Scalar v = globalResult[2*idx];
+                if (reduction_(qIdx) == TimeSeriesReduction::Average)
+                    v = (globalResult[2*idx + 1] > 0.0) ? v/globalResult[2*idx + 1] : 0.0;
+                values_[idx] = v;
+            }
+        }
+    }
+
+    /*!
+     * \brief Append the values determined by the most recent call of update() to the
+     *        time series file.
+     *
+     * Only the first process actually writes the file.
+     */
+    void write()
+    {
+        if (simulator_.gridView().comm().rank() != 0)
+            return;
+
+        if (!headerWritten_) {
+            file_.open(fileName_);
+            file_ << "time";
+            for (unsigned qIdx = 0; qIdx < numQuantities(); ++qIdx)
+                for (const auto& regionName : regionNames_)
+                    file_ << "," << quantityName_(qIdx) << "[" << regionName << "]";
+            file_ << "\n";
+            file_.precision(std::numeric_limits<Scalar>::digits10 + 1);
+            headerWritten_ = true;
+        }
+
+        file_ << time_;
+        for (Scalar v : values_)
+            file_ << "," << v;
+        file_ << "\n" << std::flush;
+    }
+
+private:
+    struct Quantity {
+        std::string name;
+        TimeSeriesReduction reduction;
+        QuantityFunction fn;
+    };
+
+    TimeSeriesReduction reduction_(unsigned qIdx) const
+    {
+        if (storageQuantities_) {
+            if (qIdx < numEq)
+                return TimeSeriesReduction::Integral;
+            qIdx -= numEq;
+        }
+        return quantities_[qIdx].reduction;
+    }
+
+    std::string quantityName_(unsigned qIdx) const
+    {
+        if (storageQuantities_) {
+            if (qIdx < numEq)
+                return "storage_" + simulator_.model().eqName(qIdx);
+            qIdx -= numEq;
+        }
+        return quantities_[qIdx].name;
+    }
+
+    // set the partial results to the neutral element of their reductions
+    void initialize_(std::vector<Scalar>& result) const
+    {
+        for (unsigned qIdx = 0; qIdx < numQuantities(); ++qIdx) {
+            Scalar neutral = 0.0;
+            if (reduction_(qIdx) == TimeSeriesReduction::Minimum)
+                neutral = std::numeric_limits<Scalar>::max();
+            else if (reduction_(qIdx) == TimeSeriesReduction::Maximum)
+                neutral = -std::numeric_limits<Scalar>::max();
+
+            for (unsigned regionIdx = 0; regionIdx < numRegions(); ++regionIdx) {
+                size_t idx = qIdx*numRegions() + regionIdx;
+                result[2*idx] = neutral;
+                result[2*idx + 1] = 0.0;
+            }
+        }
+    }
+
+    void accumulate_(std::vector<Scalar>& result,
+                     const std::vector<Scalar>& dofValues,
+                     unsigned regionIdx,
+                     Scalar volume) const
+    {
+        for (unsigned qIdx = 0; qIdx < numQuantities(); ++qIdx) {
+            size_t idx = 2*(qIdx*numRegions() + regionIdx);
+            switch (reduction_(qIdx)) {
+            case TimeSeriesReduction::Integral:
+            case TimeSeriesReduction::Average:
+                result[idx] += dofValues[qIdx]*volume;
+                result[idx + 1] += volume;
+                break;
+            case TimeSeriesReduction::Minimum:
+                result[idx] = std::min(result[idx], dofValues[qIdx]);
+                break;
+            case TimeSeriesReduction::Maximum:
+                result[idx] = std::max(result[idx], dofValues[qIdx]);
+                break;
+            }
+        }
+    }
+
+    void combine_(std::vector<Scalar>& result, const std::vector<Scalar>& partial) const
+    {
+        for (unsigned qIdx = 0; qIdx < numQuantities(); ++qIdx) {
+            for (unsigned regionIdx = 0; regionIdx < numRegions(); ++regionIdx) {
+                size_t idx = 2*(qIdx*numRegions() + regionIdx);
+                switch (reduction_(qIdx)) {
+                case TimeSeriesReduction::Integral:
+                case TimeSeriesReduction::Average:
+                    result[idx] += partial[idx];
+                    result[idx + 1] += partial[idx + 1];
+                    break;
+                case TimeSeriesReduction::Minimum:
+                    result[idx] = std::min(result[idx], partial[idx]);
+                    break;
+                case TimeSeriesReduction::Maximum:
+                    result[idx] = std::max(result[idx], partial[idx]);
+                    break;
+                }
+            }
+        }
+    }
+
+    const Simulator& simulator_;
+    std::string fileName_;
+
+    std::vector<Quantity> quantities_;
+    std::vector<std::string> regionNames_;
+    RegionFunction regionFn_;
+    bool storageQuantities_;
+
+    Scalar time_;
+    std::vector<Scalar> values_;
+
+    bool headerWritten_;
+    std::ofstream file_;
+};
+
+} // namespace Opm
+
+#endif
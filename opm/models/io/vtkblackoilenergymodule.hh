@@ -188,10 +188,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (!enableEnergy)
             return;
 
@@ -208,6 +204,24 @@ public:
             this->commitPhaseBuffer_(baseWriter, "enthalpy_%s", fluidEnthalpies_);
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        if (!enableEnergy)
+            return false;
+
+        return
+            rockInternalEnergyOutput_() ||
+            totalThermalConductivityOutput_() ||
+            fluidInternalEnergiesOutput_() ||
+            fluidEnthalpiesOutput_();
+    }
+
 private:
     static bool rockInternalEnergyOutput_()
     {
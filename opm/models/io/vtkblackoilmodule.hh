@@ -35,6 +35,7 @@
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/blackoil/blackoilproperties.hh>
+#include <opm/models/blackoil/blackoilpvttables.hh>
 
 #include <dune/common/fvector.hh>
 
@@ -116,6 +117,7 @@ class VtkBlackOilModule : public BaseOutputModule<TypeTag>
 
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+    using PvtTables = BlackOilPvtTables<TypeTag>;
 
     static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
     using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
@@ -256,11 +258,13 @@ public:
                 if (oilVaporizationFactorOutput_())
                     oilVaporizationFactor_[globalDofIdx] = Rv;
                 if (oilSaturationPressureOutput_())
-                    oilSaturationPressure_[globalDofIdx] =
-                        FluidSystem::template saturationPressure<FluidState, Scalar>(fs, oilPhaseIdx, pvtRegionIdx);
+                    oilSaturationPressure_[globalDofIdx] = PvtTables::enabled()
+                        ? PvtTables::oilSaturationPressure(pvtRegionIdx, Rs)
+                        : FluidSystem::template saturationPressure<FluidState, Scalar>(fs, oilPhaseIdx, pvtRegionIdx);
                 if (gasSaturationPressureOutput_())
-                    gasSaturationPressure_[globalDofIdx] =
-                        FluidSystem::template saturationPressure<FluidState, Scalar>(fs, gasPhaseIdx, pvtRegionIdx);
+                    gasSaturationPressure_[globalDofIdx] = PvtTables::enabled()
+                        ? PvtTables::gasSaturationPressure(pvtRegionIdx, Rv)
+                        : FluidSystem::template saturationPressure<FluidState, Scalar>(fs, gasPhaseIdx, pvtRegionIdx);
                 if (saturatedOilGasDissolutionFactorOutput_())
                     saturatedOilGasDissolutionFactor_[globalDofIdx] = RsSat;
                 if (saturatedGasOilVaporizationFactorOutput_())
@@ -298,10 +302,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (gasDissolutionFactorOutput_())
             this->commitScalarBuffer_(baseWriter, "R_s", gasDissolutionFactor_);
         if (oilVaporizationFactorOutput_())
@@ -329,6 +329,28 @@ public:
             this->commitScalarBuffer_(baseWriter, "primary vars meaning", primaryVarsMeaning_);
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        return
+            gasDissolutionFactorOutput_() ||
+            oilVaporizationFactorOutput_() ||
+            oilFormationVolumeFactorOutput_() ||
+            gasFormationVolumeFactorOutput_() ||
+            waterFormationVolumeFactorOutput_() ||
+            oilSaturationPressureOutput_() ||
+            gasSaturationPressureOutput_() ||
+            saturatedOilGasDissolutionFactorOutput_() ||
+            saturatedGasOilVaporizationFactorOutput_() ||
+            saturationRatiosOutput_() ||
+            primaryVarsMeaningOutput_();
+    }
+
 private:
     static bool gasDissolutionFactorOutput_()
     {
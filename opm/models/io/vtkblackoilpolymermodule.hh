@@ -210,10 +210,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (!enablePolymer)
             return;
 
@@ -236,6 +232,26 @@ public:
             this->commitScalarBuffer_(baseWriter, "water viscosity correction", waterViscosityCorrection_);
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        if (!enablePolymer)
+            return false;
+
+        return
+            polymerConcentrationOutput_() ||
+            polymerDeadPoreVolumeOutput_() ||
+            polymerRockDensityOutput_() ||
+            polymerAdsorptionOutput_() ||
+            polymerViscosityCorrectionOutput_() ||
+            waterViscosityCorrectionOutput_();
+    }
+
 private:
     static bool polymerConcentrationOutput_()
     {
@@ -185,10 +185,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (!enableSolvent)
             return;
 
@@ -205,6 +201,24 @@ public:
             this->commitScalarBuffer_(baseWriter, "mobility_solvent", solventMobility_);
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        if (!enableSolvent)
+            return false;
+
+        return
+            solventSaturationOutput_() ||
+            solventDensityOutput_() ||
+            solventViscosityOutput_() ||
+            solventMobilityOutput_();
+    }
+
 private:
     static bool solventSaturationOutput_()
     {
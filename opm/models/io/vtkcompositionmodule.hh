@@ -231,11 +231,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (moleFracOutput_())
             this->commitPhaseComponentBuffer_(baseWriter, "moleFrac_%s^%s", moleFrac_);
         if (massFracOutput_())
@@ -253,6 +248,24 @@ public:
             this->commitPhaseComponentBuffer_(baseWriter, "fugacityCoeff_%s^%s", fugacityCoeff_);
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        return
+            massFracOutput_() ||
+            moleFracOutput_() ||
+            totalMassFracOutput_() ||
+            totalMoleFracOutput_() ||
+            molarityOutput_() ||
+            fugacityOutput_() ||
+            fugacityCoeffOutput_();
+    }
+
 private:
     static bool massFracOutput_()
     {
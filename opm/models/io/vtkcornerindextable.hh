@@ -0,0 +1,129 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::VtkCornerIndexTable
+ */
+#ifndef VTK_CORNER_INDEX_TABLE_HH
+#define VTK_CORNER_INDEX_TABLE_HH
+
+#include <dune/common/fvector.hh>
+#include <dune/geometry/referenceelements.hh>
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Stores the vertex indices of the corners of all elements of a grid view.
+ *
+ * The VTK writer of DUNE evaluates vertex centered fields for an element and the
+ * position of the vertex in the reference element. Finding the vertex index for such a
+ * point requires to search the corners of the reference element and to ask the vertex
+ * mapper for the index of the corner's sub-entity, both of which are comparatively
+ * expensive. Since this is done for each component of each field, the vertex indices of
+ * the corners are determined once per grid instead.
+ */
+template <class GridView, class ElementMapper, class VertexMapper>
+class VtkCornerIndexTable
+{
+    enum { dim = GridView::dimension };
+    using ctype = typename GridView::ctype;
+    using Element = typename GridView::template Codim<0>::Entity;
+    using LocalPosition = Dune::FieldVector<ctype, dim>;
+
+public:
+    VtkCornerIndexTable(const ElementMapper& elementMapper,
+                        const VertexMapper& vertexMapper)
+        : elementMapper_(elementMapper)
+        , vertexMapper_(vertexMapper)
+    {}
+
+    /*!
+     * \brief Determine the vertex indices of the corners of all elements.
+     *
+     * This must be called whenever the grid has changed, after the mappers have been
+     * updated.
+     */
+    void update(const GridView& gridView)
+    {
+        size_t numElements = elementMapper_.size();
+        cornerOffsets_.assign(numElements + 1, 0);
+        for (const auto& elem : elements(gridView))
+            cornerOffsets_[elementMapper_.index(elem) + 1] = elem.subEntities(dim);
+        for (size_t elemIdx = 0; elemIdx < numElements; ++elemIdx)
+            cornerOffsets_[elemIdx + 1] += cornerOffsets_[elemIdx];
+
+        cornerVertexIdx_.resize(cornerOffsets_.back());
+        for (const auto& elem : elements(gridView)) {
+            unsigned offset = cornerOffsets_[elementMapper_.index(elem)];
+            unsigned numCorners = elem.subEntities(dim);
+            for (unsigned cornerIdx = 0; cornerIdx < numCorners; ++cornerIdx)
+                cornerVertexIdx_[offset + cornerIdx] =
+                    static_cast<unsigned>(vertexMapper_.subIndex(elem, cornerIdx, dim));
+        }
+    }
+
+    /*!
+     * \brief Returns the index of the vertex of an element which is closest to a
+     *        position in the reference element.
+     */
+    unsigned vertexIndex(const Element& elem, const LocalPosition& xi) const
+    {
+        unsigned offset = cornerOffsets_[elementMapper_.index(elem)];
+        const auto& refElem = Dune::ReferenceElements<ctype, dim>::general(elem.type());
+        int numCorners = refElem.size(dim);
+
+        // the writer evaluates the fields exactly at the corners of the reference
+        // element, so the search stops at the first corner which matches
+        ctype minDist = std::numeric_limits<ctype>::max();
+        int closestIdx = 0;
+        for (int cornerIdx = 0; cornerIdx < numCorners; ++cornerIdx) {
+            LocalPosition delta = refElem.position(cornerIdx, dim);
+            delta -= xi;
+            ctype dist = delta.infinity_norm();
+            if (dist < minDist) {
+                minDist = dist;
+                closestIdx = cornerIdx;
+                if (dist < 1e-8)
+                    break;
+            }
+        }
+
+        return cornerVertexIdx_[offset + static_cast<unsigned>(closestIdx)];
+    }
+
+private:
+    const ElementMapper& elementMapper_;
+    const VertexMapper& vertexMapper_;
+    std::vector<unsigned> cornerOffsets_;
+    std::vector<unsigned> cornerVertexIdx_;
+};
+
+} // namespace Opm
+
+#endif
@@ -167,11 +167,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (tortuosityOutput_())
             this->commitPhaseBuffer_(baseWriter, "tortuosity", tortuosity_);
         if (diffusionCoefficientOutput_())
@@ -183,6 +178,20 @@ public:
                                               effectiveDiffusionCoefficient_);
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        return
+            tortuosityOutput_() ||
+            diffusionCoefficientOutput_() ||
+            effectiveDiffusionCoefficientOutput_();
+    }
+
 private:
     static bool tortuosityOutput_()
     {
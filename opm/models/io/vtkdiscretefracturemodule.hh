@@ -274,11 +274,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (saturationOutput_())
             this->commitPhaseBuffer_(baseWriter, "fractureSaturation_%s", fractureSaturation_);
         if (mobilityOutput_())
@@ -315,6 +310,24 @@ public:
         }
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        return
+            saturationOutput_() ||
+            mobilityOutput_() ||
+            relativePermeabilityOutput_() ||
+            porosityOutput_() ||
+            intrinsicPermeabilityOutput_() ||
+            volumeFractionOutput_() ||
+            velocityOutput_();
+    }
+
 private:
     static bool saturationOutput_()
     {
@@ -175,11 +175,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (solidInternalEnergyOutput_())
             this->commitScalarBuffer_(baseWriter, "internalEnergySolid", solidInternalEnergy_);
         if (thermalConductivityOutput_())
@@ -191,6 +186,21 @@ public:
             this->commitPhaseBuffer_(baseWriter, "internalEnergy_%s", internalEnergy_);
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        return
+            solidInternalEnergyOutput_() ||
+            thermalConductivityOutput_() ||
+            enthalpyOutput_() ||
+            internalEnergyOutput_();
+    }
+
 private:
     static bool solidInternalEnergyOutput_()
     {
@@ -154,6 +154,7 @@ class VtkMultiPhaseModule : public BaseOutputModule<TypeTag>
 public:
     VtkMultiPhaseModule(const Simulator& simulator)
         : ParentType(simulator)
+        , useRetainedFluxes_(false)
     {}
 
     /*!
@@ -205,6 +206,14 @@ public:
         if (porosityOutput_()) this->resizeScalarBuffer_(porosity_);
         if (intrinsicPermeabilityOutput_()) this->resizeTensorBuffer_(intrinsicPermeability_);
 
+        // the velocities can be taken from the fluxes kept by the last linearization
+        // unless the output is prepared concurrently to the simulation, which might
+        // modify them at the same time
+        useRetainedFluxes_ =
+            velocityOutput_()
+            && !this->concurrentOutput()
+            && this->simulator_.model().hasRetainedFluxes();
+
         if (velocityOutput_()) {
             size_t nDof = this->simulator_.model().numGridDof();
             for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
@@ -299,7 +308,19 @@ public:
             } // end for all faces
         }
 
-        if (velocityOutput_()) {
+        if (velocityOutput_() && useRetainedFluxes_) {
+            // use the fluxes of the last linearization
+            const auto& faceFluxes = this->simulator_.model().retainedFluxes(elemCtx.element());
+            for (const auto& flux : faceFluxes)
+                for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+                    addVelocity_(flux.interiorDofIdx,
+                                 flux.exteriorDofIdx,
+                                 phaseIdx,
+                                 flux.volumeFlux[phaseIdx],
+                                 flux.extrusionFactor,
+                                 flux.filterVelocity[phaseIdx]);
+        }
+        else if (velocityOutput_()) {
             // calculate velocities if requested
             for (unsigned faceIdx = 0; faceIdx < elemCtx.numInteriorFaces(/*timeIdx=*/0); ++ faceIdx) {
                 const auto& extQuants = elemCtx.extensiveQuantities(faceIdx, /*timeIdx=*/0);
@@ -311,25 +332,15 @@ public:
                 unsigned J = elemCtx.globalSpaceIndex(j, /*timeIdx=*/0);
 
                 for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
-                    Scalar weight = std::max<Scalar>(1e-16,
-                                                     std::abs(getValue(extQuants.volumeFlux(phaseIdx))));
-                    Valgrind::CheckDefined(extQuants.extrusionFactor());
-                    assert(extQuants.extrusionFactor() > 0);
-                    weight *= extQuants.extrusionFactor();
-
                     const auto& inputV = extQuants.filterVelocity(phaseIdx);
                     DimVector v;
                     for (unsigned k = 0; k < dimWorld; ++k)
                         v[k] = getValue(inputV[k]);
-                    if (v.two_norm() > 1e-20)
-                        weight /= v.two_norm();
-                    v *= weight;
-
-                    velocity_[phaseIdx][I] += v;
-                    velocity_[phaseIdx][J] += v;
 
-                    velocityWeight_[phaseIdx][I] += weight;
-                    velocityWeight_[phaseIdx][J] += weight;
+                    addVelocity_(I, J, phaseIdx,
+                                 getValue(extQuants.volumeFlux(phaseIdx)),
+                                 extQuants.extrusionFactor(),
+                                 v);
                 } // end for all phases
             } // end for all faces
         }
@@ -340,10 +351,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter)
-            return;
-
         if (extrusionFactorOutput_())
             this->commitScalarBuffer_(baseWriter, "extrusionFactor", extrusionFactor_);
         if (pressureOutput_())
@@ -410,11 +417,67 @@ public:
      * slows down writing the output fields.
      */
     virtual bool needExtensiveQuantities() const final
+    {
+        return (velocityOutput_() && !useRetainedFluxes_) || potentialGradientOutput_();
+    }
+
+    /*!
+     * \copydoc BaseOutputModule::writesNeighborDofs()
+     */
+    virtual bool writesNeighborDofs() const final
     {
         return velocityOutput_() || potentialGradientOutput_();
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        return
+            extrusionFactorOutput_() ||
+            pressureOutput_() ||
+            densityOutput_() ||
+            saturationOutput_() ||
+            mobilityOutput_() ||
+            relativePermeabilityOutput_() ||
+            viscosityOutput_() ||
+            averageMolarMassOutput_() ||
+            porosityOutput_() ||
+            intrinsicPermeabilityOutput_() ||
+            velocityOutput_() ||
+            potentialGradientOutput_();
+    }
+
 private:
+    // add the filter velocity of a phase at a face to the degrees of freedom on both
+    // sides. the velocities are weighted by the magnitude of the volumetric flux.
+    void addVelocity_(unsigned I,
+                      unsigned J,
+                      unsigned phaseIdx,
+                      Scalar volumeFlux,
+                      Scalar extrusionFactor,
+                      DimVector v)
+    {
+        Scalar weight = std::max<Scalar>(1e-16, std::abs(volumeFlux));
+        Valgrind::CheckDefined(extrusionFactor);
+        assert(extrusionFactor > 0);
+        weight *= extrusionFactor;
+
+        if (v.two_norm() > 1e-20)
+            weight /= v.two_norm();
+        v *= weight;
+
+        velocity_[phaseIdx][I] += v;
+        velocity_[phaseIdx][J] += v;
+
+        velocityWeight_[phaseIdx][I] += weight;
+        velocityWeight_[phaseIdx][J] += weight;
+    }
+
     static bool extrusionFactorOutput_()
     {
         static bool val = EWOMS_GET_PARAM(TypeTag, bool, VtkWriteExtrusionFactor);
@@ -501,6 +564,7 @@ private:
 
     PhaseVectorBuffer velocity_;
     PhaseBuffer velocityWeight_;
+    bool useRetainedFluxes_;
 
     PhaseVectorBuffer potentialGradient_;
     PhaseBuffer potentialWeight_;
@@ -31,8 +31,10 @@
 #include "vtkscalarfunction.hh"
 #include "vtkvectorfunction.hh"
 #include "vtktensorfunction.hh"
+#include "vtkcornerindextable.hh"
 
 #include <opm/models/io/baseoutputwriter.hh>
+#include <opm/models/io/xdmfwriter.hh>
 #include <opm/models/parallel/tasklets.hh>
 
 #include <opm/common/utility/FileSystem.hpp>
@@ -48,11 +50,14 @@
 #include <mpi.h>
 #endif
 
+#include <algorithm>
 #include <list>
+#include <memory>
 #include <string>
 #include <limits>
 #include <sstream>
 #include <fstream>
+#include <stdexcept>
 
 namespace Opm {
 /*!
@@ -80,10 +85,10 @@ class VtkMultiWriter : public BaseOutputWriter
                 fileName = multiWriter_.curWriter_->pwrite(/*name=*/multiWriter_.curOutFileName_,
                                                            /*path=*/multiWriter_.outputDir_,
                                                            /*extendPath=*/"",
-                                                           static_cast<Dune::VTK::OutputType>(vtkFormat));
+                                                           multiWriter_.outputType_);
             else
                 fileName = multiWriter_.curWriter_->write(/*name=*/multiWriter_.outputDir_ + "/" + multiWriter_.curOutFileName_,
-                                                          static_cast<Dune::VTK::OutputType>(vtkFormat));
+                                                          multiWriter_.outputType_);
 
             // determine name to write into the multi-file for the
             // current time step
@@ -103,6 +108,7 @@ class VtkMultiWriter : public BaseOutputWriter
 
     using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
     using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using CornerIndexTable = VtkCornerIndexTable<GridView, ElementMapper, VertexMapper>;
 
 public:
     using Scalar = BaseOutputWriter::Scalar;
@@ -123,8 +129,11 @@ public:
         : gridView_(gridView)
         , elementMapper_(gridView, Dune::mcmgElementLayout())
         , vertexMapper_(gridView, Dune::mcmgVertexLayout())
+        , cornerIndexTable_(elementMapper_, vertexMapper_)
+        , cornerIndicesValid_(false)
         , curWriter_(nullptr)
         , curWriterNum_(0)
+        , outputType_(static_cast<Dune::VTK::OutputType>(vtkFormat))
         , taskletRunner_(/*numThreads=*/asyncWriting?1:0)
     {
         outputDir_ = outputDir;
@@ -144,6 +153,10 @@ public:
     {
         taskletRunner_.barrier();
         releaseBuffers_();
+        clearBufferPool_();
+        if (xdmfWriter_)
+            return;
+
         finishMultiFile_();
 
         if (commRank_ == 0)
@@ -154,7 +167,66 @@ public:
      * \brief Returns the number of the current VTK file.
      */
     int curWriterNum() const
-    { return curWriterNum_; }
+    { return xdmfWriter_ ? xdmfWriter_->curWriterNum() : curWriterNum_; }
+
+    /*!
+     * \brief Write all subsequent data sets using the collective XDMF writer instead
+     *        of writing VTK files.
+     *
+     * This avoids writing a separate file for each process and time step for MPI
+     * parallel simulations. Also, the mesh is only written once per grid instead of
+     * for each time step. \see XdmfWriter
+     */
+    void enableXdmfOutput()
+    {
+        taskletRunner_.barrier();
+        xdmfWriter_.reset(new XdmfWriter<GridView>(gridView_, outputDir_, simName_));
+    }
+
+    /*!
+     * \brief Returns true if the data sets are written by the collective XDMF writer.
+     */
+    bool xdmfOutputEnabled() const
+    { return static_cast<bool>(xdmfWriter_); }
+
+    /*!
+     * \brief Returns the format in which the data sets are written.
+     */
+    Dune::VTK::OutputType outputType() const
+    { return outputType_; }
+
+    /*!
+     * \brief Change the format in which the data sets are written.
+     *
+     * By default, the format specified by the template argument is used. Binary
+     * formats considerably reduce the size of the output files and the time needed to
+     * write them. This method must not be called while a data set is being written.
+     */
+    void setOutputType(Dune::VTK::OutputType outputType)
+    {
+        taskletRunner_.barrier();
+        outputType_ = outputType;
+    }
+
+    /*!
+     * \brief Converts the name of a VTK output type to the corresponding enum value.
+     *
+     * Valid names are "ascii", "base64", "appended-raw" and "appended-base64".
+     */
+    static Dune::VTK::OutputType outputTypeFromString(const std::string& name)
+    {
+        if (name == "ascii")
+            return Dune::VTK::ascii;
+        else if (name == "base64")
+            return Dune::VTK::base64;
+        else if (name == "appended-raw")
+            return Dune::VTK::appendedraw;
+        else if (name == "appended-base64")
+            return Dune::VTK::appendedbase64;
+
+        throw std::runtime_error("Unknown VTK output type '"+name+"'. Valid types are "
+                                 "'ascii', 'base64', 'appended-raw' and 'appended-base64'");
+    }
 
     /*!
      * \brief Updates the internal data structures after mesh
@@ -167,6 +239,12 @@ public:
     {
         elementMapper_.update();
         vertexMapper_.update();
+        cornerIndicesValid_ = false;
+
+        // the pooled buffers are most likely of the wrong size now
+        clearBufferPool_();
+        if (xdmfWriter_)
+            xdmfWriter_->gridChanged();
     }
 
     /*!
@@ -174,6 +252,12 @@ public:
      */
     void beginWrite(double t)
     {
+        if (xdmfWriter_) {
+            releaseBuffers_();
+            xdmfWriter_->beginWrite(t);
+            return;
+        }
+
         if (!multiFile_.is_open()) {
             startMultiFile_(multiFileName_);
         }
@@ -194,11 +278,17 @@ public:
      * \brief Allocate a managed buffer for a scalar field
      *
      * The buffer will be deleted automatically after the data has
-     * been written by to disk.
+     * been written by to disk. Its entries are initialized to zero.
      */
     ScalarBuffer *allocateManagedScalarBuffer(size_t numEntities)
     {
-        ScalarBuffer *buf = new ScalarBuffer(numEntities);
+        ScalarBuffer *buf = takeFromPool_(pooledScalarBuffers_,
+                                          [numEntities](const ScalarBuffer& b)
+                                          { return b.size() == numEntities; });
+        if (buf)
+            std::fill(buf->begin(), buf->end(), 0.0);
+        else
+            buf = new ScalarBuffer(numEntities);
         managedScalarBuffers_.push_back(buf);
         return buf;
     }
@@ -207,13 +297,22 @@ public:
      * \brief Allocate a managed buffer for a vector field
      *
      * The buffer will be deleted automatically after the data has
-     * been written by to disk.
+     * been written by to disk. Its entries are initialized to zero.
      */
     VectorBuffer *allocateManagedVectorBuffer(size_t numOuter, size_t numInner)
     {
-        VectorBuffer *buf = new VectorBuffer(numOuter);
-        for (size_t i = 0; i < numOuter; ++ i)
-            (*buf)[i].resize(numInner);
+        VectorBuffer *buf = takeFromPool_(pooledVectorBuffers_,
+                                          [numOuter, numInner](const VectorBuffer& b)
+                                          { return b.size() == numOuter && (numOuter == 0 || b[0].size() == numInner); });
+        if (buf) {
+            for (auto& v : *buf)
+                v = 0.0;
+        }
+        else {
+            buf = new VectorBuffer(numOuter);
+            for (size_t i = 0; i < numOuter; ++ i)
+                (*buf)[i].resize(numInner);
+        }
 
         managedVectorBuffers_.push_back(buf);
         return buf;
@@ -237,6 +336,11 @@ public:
      */
     void attachScalarVertexData(ScalarBuffer& buf, std::string name)
     {
+        if (xdmfWriter_) {
+            xdmfWriter_->attachScalarVertexData(buf, name);
+            return;
+        }
+
         sanitizeScalarBuffer_(buf);
 
         using VtkFn = VtkScalarFunction<GridView, VertexMapper>;
@@ -244,7 +348,8 @@ public:
                                     gridView_,
                                     vertexMapper_,
                                     buf,
-                                    /*codim=*/dim));
+                                    /*codim=*/dim,
+                                    &cornerIndices_()));
         curWriter_->addVertexData(fnPtr);
     }
 
@@ -265,6 +370,11 @@ public:
      */
     void attachScalarElementData(ScalarBuffer& buf, std::string name)
     {
+        if (xdmfWriter_) {
+            xdmfWriter_->attachScalarElementData(buf, name);
+            return;
+        }
+
         sanitizeScalarBuffer_(buf);
 
         using VtkFn = VtkScalarFunction<GridView, ElementMapper>;
@@ -294,6 +404,11 @@ public:
      */
     void attachVectorVertexData(VectorBuffer& buf, std::string name)
     {
+        if (xdmfWriter_) {
+            xdmfWriter_->attachVectorVertexData(buf, name);
+            return;
+        }
+
         sanitizeVectorBuffer_(buf);
 
         using VtkFn = VtkVectorFunction<GridView, VertexMapper>;
@@ -301,7 +416,8 @@ public:
                                     gridView_,
                                     vertexMapper_,
                                     buf,
-                                    /*codim=*/dim));
+                                    /*codim=*/dim,
+                                    &cornerIndices_()));
         curWriter_->addVertexData(fnPtr);
     }
 
@@ -310,6 +426,11 @@ public:
      */
     void attachTensorVertexData(TensorBuffer& buf, std::string name)
     {
+        if (xdmfWriter_) {
+            xdmfWriter_->attachTensorVertexData(buf, name);
+            return;
+        }
+
         using VtkFn = VtkTensorFunction<GridView, VertexMapper>;
 
         for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
@@ -321,7 +442,8 @@ public:
                                         vertexMapper_,
                                         buf,
                                         /*codim=*/dim,
-                                        colIdx));
+                                        colIdx,
+                                        &cornerIndices_()));
             curWriter_->addVertexData(fnPtr);
         }
     }
@@ -343,6 +465,11 @@ public:
      */
     void attachVectorElementData(VectorBuffer& buf, std::string name)
     {
+        if (xdmfWriter_) {
+            xdmfWriter_->attachVectorElementData(buf, name);
+            return;
+        }
+
         sanitizeVectorBuffer_(buf);
 
         using VtkFn = VtkVectorFunction<GridView, ElementMapper>;
@@ -359,6 +486,11 @@ public:
      */
     void attachTensorElementData(TensorBuffer& buf, std::string name)
     {
+        if (xdmfWriter_) {
+            xdmfWriter_->attachTensorElementData(buf, name);
+            return;
+        }
+
         using VtkFn = VtkTensorFunction<GridView, ElementMapper>;
 
         for (unsigned colIdx = 0; colIdx < buf[0].N(); ++colIdx) {
@@ -384,8 +516,14 @@ public:
      */
     void endWrite(bool onlyDiscard = false)
     {
+        if (xdmfWriter_) {
+            xdmfWriter_->endWrite(onlyDiscard);
+            return;
+        }
+
         if (!onlyDiscard) {
             auto tasklet = std::make_shared<WriteDataTasklet>(*this);
+            tasklet->setPriority(TaskletInterface::Priority::Low);
             taskletRunner_.dispatch(tasklet);
         }
         else
@@ -403,6 +541,11 @@ public:
     template <class Restarter>
     void serialize(Restarter& res)
     {
+        if (xdmfWriter_) {
+            xdmfWriter_->serialize(res);
+            return;
+        }
+
         res.serializeSectionBegin("VTKMultiWriter");
         res.serializeStream() << curWriterNum_ << "\n";
 
@@ -437,6 +580,11 @@ public:
     template <class Restarter>
     void deserialize(Restarter& res)
     {
+        if (xdmfWriter_) {
+            xdmfWriter_->deserialize(res);
+            return;
+        }
+
         res.deserializeSectionBegin("VTKMultiWriter");
         res.deserializeStream() >> curWriterNum_;
 
@@ -523,25 +671,60 @@ private:
         // nothing to do: this is done by VtkVectorFunction
     }
 
-    // release the memory occupied by all buffer objects managed by the multi-writer
+    // discard the current VTK writer and return the buffers managed by the multi-writer
+    // to the pool. the buffers are not freed because the next data set usually needs
+    // buffers of the same sizes
     void releaseBuffers_()
     {
-        // discard managed objects and the current VTK writer
         delete curWriter_;
         curWriter_ = nullptr;
-        while (managedScalarBuffers_.begin() != managedScalarBuffers_.end()) {
-            delete managedScalarBuffers_.front();
-            managedScalarBuffers_.pop_front();
+        pooledScalarBuffers_.splice(pooledScalarBuffers_.end(), managedScalarBuffers_);
+        pooledVectorBuffers_.splice(pooledVectorBuffers_.end(), managedVectorBuffers_);
+    }
+
+    // free the memory of the pooled buffers
+    void clearBufferPool_()
+    {
+        for (auto* buf : pooledScalarBuffers_)
+            delete buf;
+        pooledScalarBuffers_.clear();
+
+        for (auto* buf : pooledVectorBuffers_)
+            delete buf;
+        pooledVectorBuffers_.clear();
+    }
+
+    // remove the first buffer from a pool for which fits(buffer) is true. returns a null
+    // pointer if there is no such buffer
+    template <class Buffer, class Predicate>
+    static Buffer *takeFromPool_(std::list<Buffer *>& pool, const Predicate& fits)
+    {
+        for (auto it = pool.begin(); it != pool.end(); ++it) {
+            if (fits(**it)) {
+                Buffer *buf = *it;
+                pool.erase(it);
+                return buf;
+            }
         }
-        while (managedVectorBuffers_.begin() != managedVectorBuffers_.end()) {
-            delete managedVectorBuffers_.front();
-            managedVectorBuffers_.pop_front();
+        return nullptr;
+    }
+
+    // returns the vertex indices of the corners of the elements. they are only
+    // determined if vertex centered fields are written for the current grid.
+    const CornerIndexTable& cornerIndices_()
+    {
+        if (!cornerIndicesValid_) {
+            cornerIndexTable_.update(gridView_);
+            cornerIndicesValid_ = true;
         }
+        return cornerIndexTable_;
     }
 
     const GridView gridView_;
     ElementMapper elementMapper_;
     VertexMapper vertexMapper_;
+    CornerIndexTable cornerIndexTable_;
+    bool cornerIndicesValid_;
 
     std::string outputDir_;
     std::string simName_;
@@ -555,10 +738,18 @@ private:
     double curTime_;
     std::string curOutFileName_;
     int curWriterNum_;
+    Dune::VTK::OutputType outputType_;
 
     std::list<ScalarBuffer *> managedScalarBuffers_;
     std::list<VectorBuffer *> managedVectorBuffers_;
 
+    // buffers of previous data sets which can be reused
+    std::list<ScalarBuffer *> pooledScalarBuffers_;
+    std::list<VectorBuffer *> pooledVectorBuffers_;
+
+    // if set, all data sets are written by this writer instead
+    std::unique_ptr<XdmfWriter<GridView>> xdmfWriter_;
+
     TaskletRunner taskletRunner_;
 };
 } // namespace Opm
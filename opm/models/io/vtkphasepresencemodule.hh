@@ -121,15 +121,22 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (phasePresenceOutput_())
             this->commitScalarBuffer_(baseWriter, "phase presence", phasePresence_);
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        return
+            phasePresenceOutput_();
+    }
+
 private:
     static bool phasePresenceOutput_()
     {
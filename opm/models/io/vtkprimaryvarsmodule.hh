@@ -149,11 +149,6 @@ public:
      */
     void commitBuffers(BaseOutputWriter& baseWriter)
     {
-        VtkMultiWriter *vtkWriter = dynamic_cast<VtkMultiWriter*>(&baseWriter);
-        if (!vtkWriter) {
-            return;
-        }
-
         if (primaryVarsOutput_())
             this->commitPriVarsBuffer_(baseWriter, "PV_%s", primaryVars_);
         if (processRankOutput_())
@@ -165,6 +160,20 @@ public:
             this->commitScalarBuffer_(baseWriter, "DOF index", dofIndex_);
     }
 
+    /*!
+     * \copydoc BaseOutputModule::hasEnabledFields()
+     */
+    virtual bool hasEnabledFields() const final
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput))
+            return false;
+
+        return
+            primaryVarsOutput_() ||
+            processRankOutput_() ||
+            dofIndexOutput_();
+    }
+
 private:
     static bool primaryVarsOutput_()
     {
@@ -28,6 +28,7 @@
 #define VTK_TENSOR_FUNCTION_HH
 
 #include <opm/models/io/baseoutputwriter.hh>
+#include <opm/models/io/vtkcornerindextable.hh>
 
 #include <dune/grid/io/file/vtk/function.hh>
 #include <dune/common/fvector.hh>
@@ -42,7 +43,8 @@ namespace Opm {
 /*!
  * \brief Provides a tensor-valued function using Dune::FieldMatrix objects as elements.
  */
-template <class GridView, class Mapper>
+template <class GridView, class Mapper,
+          class CornerIndexTable = VtkCornerIndexTable<GridView, Mapper, Mapper> >
 class VtkTensorFunction : public Dune::VTKFunction<GridView>
 {
     enum { dim = GridView::dimension };
@@ -57,13 +59,15 @@ public:
                       const Mapper& mapper,
                       const TensorBuffer& buf,
                       unsigned codim,
-                      unsigned matrixColumnIdx)
+                      unsigned matrixColumnIdx,
+                      const CornerIndexTable* cornerIndices = nullptr)
         : name_(name)
         , gridView_(gridView)
         , mapper_(mapper)
         , buf_(buf)
         , codim_(codim)
         , matrixColumnIdx_(matrixColumnIdx)
+        , cornerIndices_(cornerIndices)
     { assert(int(buf_.size()) == int(mapper_.size())); }
 
     virtual std::string name() const
@@ -81,6 +85,10 @@ public:
             // cells. map element to the index
             idx = static_cast<size_t>(mapper_.index(e));
         }
+        else if (codim_ == dim && cornerIndices_) {
+            // the vertex indices of the corners have been determined in advance
+            idx = cornerIndices_->vertexIndex(e, xi);
+        }
         else if (codim_ == dim) {
             // find vertex which is closest to xi in local
             // coordinates. This code is based on Dune::P1VTKFunction
@@ -118,6 +126,7 @@ private:
     const TensorBuffer& buf_;
     unsigned codim_;
     unsigned matrixColumnIdx_;
+    const CornerIndexTable* cornerIndices_;
 };
 
 } // namespace Opm
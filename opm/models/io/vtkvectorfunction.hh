@@ -28,6 +28,7 @@
 #define VTK_VECTOR_FUNCTION_HH
 
 #include <opm/models/io/baseoutputwriter.hh>
+#include <opm/models/io/vtkcornerindextable.hh>
 
 #include <dune/grid/io/file/vtk/function.hh>
 #include <dune/istl/bvector.hh>
@@ -46,7 +47,8 @@ namespace Opm {
  * \brief Provides a vector-valued function using Dune::FieldVectors
  *        as elements.
  */
-template <class GridView, class Mapper>
+template <class GridView, class Mapper,
+          class CornerIndexTable = VtkCornerIndexTable<GridView, Mapper, Mapper> >
 class VtkVectorFunction : public Dune::VTKFunction<GridView>
 {
     enum { dim = GridView::dimension };
@@ -60,12 +62,14 @@ public:
                       const GridView& gridView,
                       const Mapper& mapper,
                       const VectorBuffer& buf,
-                      unsigned codim)
+                      unsigned codim,
+                      const CornerIndexTable* cornerIndices = nullptr)
         : name_(name)
         , gridView_(gridView)
         , mapper_(mapper)
         , buf_(buf)
         , codim_(codim)
+        , cornerIndices_(cornerIndices)
     { assert(int(buf_.size()) == int(mapper_.size())); }
 
     virtual std::string name() const
@@ -83,6 +87,10 @@ public:
             // cells. map element to the index
             idx = static_cast<unsigned>(mapper_.index(e));
         }
+        else if (codim_ == dim && cornerIndices_) {
+            // the vertex indices of the corners have been determined in advance
+            idx = cornerIndices_->vertexIndex(e, xi);
+        }
         else if (codim_ == dim) {
             // find vertex which is closest to xi in local
             // coordinates. This code is based on Dune::P1VTKFunction
@@ -117,6 +125,7 @@ private:
     const Mapper& mapper_;
     const VectorBuffer& buf_;
     unsigned codim_;
+    const CornerIndexTable* cornerIndices_;
 };
 
 } // namespace Opm
@@ -0,0 +1,648 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::XdmfWriter
+ */
+#ifndef EWOMS_XDMF_WRITER_HH
+#define EWOMS_XDMF_WRITER_HH
+
+#include <opm/models/io/baseoutputwriter.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/geometry/type.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/partitionset.hh>
+#include <dune/grid/common/rangegenerators.hh>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Writes the visualization output of all processes into a single file per time
+ *        step.
+ *
+ * In contrast to the VTK output, where each process writes a separate file for each time
+ * step, the processes write their part of the grid and of the attached fields into
+ * disjoint regions of a common raw binary file using collective MPI-IO. This keeps the
+ * number of files independent of the number of processes. An XDMF file which describes
+ * the data sets of all time steps is maintained by the first process and can be opened
+ * by ParaView or VisIt.
+ *
+ * Since the grid usually does not change between time steps, the coordinates of the
+ * vertices and the connectivity of the elements are written to a separate file which is
+ * referenced by all time steps until gridChanged() is called. The files of the time steps
+ * only contain the attached fields.
+ *
+ * The vertices of each process are written separately, i.e. vertices on the process
+ * borders are duplicated, and only the interior elements of each process are written.
+ * All elements of the grid must be of the same type.
+ */
+template <class GridView>
+class XdmfWriter : public BaseOutputWriter
+{
+    enum { dim = GridView::dimension };
+    enum { dimWorld = GridView::dimensionworld };
+
+    using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+
+    enum FieldCenter { VertexCenter, ElementCenter };
+
+    struct ScalarField {
+        const ScalarBuffer* buf;
+        std::string name;
+        FieldCenter center;
+    };
+
+    struct VectorField {
+        const VectorBuffer* buf;
+        std::string name;
+        FieldCenter center;
+    };
+
+public:
+    using Scalar = BaseOutputWriter::Scalar;
+    using ScalarBuffer = BaseOutputWriter::ScalarBuffer;
+    using VectorBuffer = BaseOutputWriter::VectorBuffer;
+    using TensorBuffer = BaseOutputWriter::TensorBuffer;
+
+    XdmfWriter(const GridView& gridView,
+               const std::string& outputDir,
+               const std::string& simName = "")
+        : gridView_(gridView)
+        , elementMapper_(gridView, Dune::mcmgElementLayout())
+        , vertexMapper_(gridView, Dune::mcmgVertexLayout())
+        , curWriterNum_(0)
+    {
+        outputDir_ = outputDir;
+        if (outputDir == "")
+            outputDir_ = ".";
+
+        simName_ = (simName.empty()) ? "sim" : simName;
+        commRank_ = gridView.comm().rank();
+        commSize_ = gridView.comm().size();
+    }
+
+    /*!
+     * \brief Returns the number of the current output file.
+     */
+    int curWriterNum() const
+    { return curWriterNum_; }
+
+    /*!
+     * \brief Updates the internal data structures after the grid was modified.
+     *
+     * This causes the mesh to be written again for the next time step.
+     */
+    void gridChanged()
+    {
+        elementMapper_.update();
+        vertexMapper_.update();
+        meshXml_.clear();
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::beginWrite
+     */
+    void beginWrite(double t)
+    {
+        curTime_ = t;
+
+        std::ostringstream oss;
+        oss << simName_ << "-" << std::setw(5) << std::setfill('0') << curWriterNum_ << ".bin";
+        curFileName_ = oss.str();
+        ++curWriterNum_;
+
+        scalarFields_.clear();
+        vectorFields_.clear();
+        tensorColumns_.clear();
+    }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarVertexData
+     *
+     * The buffer must exist at least until endWrite() returns.
+     */
+    void attachScalarVertexData(ScalarBuffer& buf, std::string name)
+    { scalarFields_.push_back(ScalarField{&buf, name, VertexCenter}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachScalarElementData
+     *
+     * The buffer must exist at least until endWrite() returns.
+     */
+    void attachScalarElementData(ScalarBuffer& buf, std::string name)
+    { scalarFields_.push_back(ScalarField{&buf, name, ElementCenter}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorVertexData
+     *
+     * The buffer must exist at least until endWrite() returns.
+     */
+    void attachVectorVertexData(VectorBuffer& buf, std::string name)
+    { vectorFields_.push_back(VectorField{&buf, name, VertexCenter}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachVectorElementData
+     *
+     * The buffer must exist at least until endWrite() returns.
+     */
+    void attachVectorElementData(VectorBuffer& buf, std::string name)
+    { vectorFields_.push_back(VectorField{&buf, name, ElementCenter}); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorVertexData
+     *
+     * Like for the VTK output, each column of the tensors is written as a separate
+     * vector field.
+     */
+    void attachTensorVertexData(TensorBuffer& buf, std::string name)
+    { attachTensorData_(buf, name, VertexCenter); }
+
+    /*!
+     * \copydoc BaseOutputWriter::attachTensorElementData
+     *
+     * Like for the VTK output, each column of the tensors is written as a separate
+     * vector field.
+     */
+    void attachTensorElementData(TensorBuffer& buf, std::string name)
+    { attachTensorData_(buf, name, ElementCenter); }
+
+    /*!
+     * \copydoc BaseOutputWriter::endWrite
+     *
+     * This method must be called by all processes.
+     */
+    void endWrite(bool onlyDiscard = false)
+    {
+        if (onlyDiscard) {
+            --curWriterNum_;
+            scalarFields_.clear();
+            vectorFields_.clear();
+            tensorColumns_.clear();
+            return;
+        }
+
+        // the mesh is written to a file of its own which is referenced by all time steps
+        // until the grid changes
+        if (meshXml_.empty()) {
+            std::ostringstream meshFileName;
+            meshFileName << simName_ << "-mesh-" << std::setw(5) << std::setfill('0')
+                         << curWriterNum_ - 1 << ".bin";
+            std::ostringstream meshXml;
+            openFile_(meshFileName.str());
+            writeMesh_(meshXml);
+            closeFile_();
+            meshXml_ = meshXml.str();
+        }
+
+        std::ostringstream gridXml;
+        gridXml << meshXml_;
+        openFile_(curFileName_);
+
+        for (const auto& field : scalarFields_)
+            writeScalarField_(gridXml, field);
+        for (const auto& field : vectorFields_)
+            writeVectorField_(gridXml, field);
+        closeFile_();
+
+        scalarFields_.clear();
+        vectorFields_.clear();
+        tensorColumns_.clear();
+
+        if (commRank_ == 0) {
+            std::ostringstream entry;
+            entry.precision(16);
+            entry << "   <Grid Name=\"" << curFileName_ << "\" GridType=\"Uniform\">\n"
+                  << "    <Time Value=\"" << curTime_ << "\"/>\n"
+                  << gridXml.str()
+                  << "   </Grid>\n";
+            timeStepEntries_ += entry.str();
+            writeIndexFile_();
+        }
+    }
+
+    /*!
+     * \brief Write the writer's state to a restart file.
+     */
+    template <class Restarter>
+    void serialize(Restarter& res)
+    {
+        res.serializeSectionBegin("XdmfWriter");
+        res.serializeStream() << curWriterNum_ << "\n";
+        if (commRank_ == 0) {
+            res.serializeStream() << timeStepEntries_.size() << "\n";
+            res.serializeStream().write(timeStepEntries_.data(),
+                                        static_cast<std::streamsize>(timeStepEntries_.size()));
+        }
+        res.serializeSectionEnd();
+    }
+
+    /*!
+     * \brief Read the writer's state from a restart file.
+     */
+    template <class Restarter>
+    void deserialize(Restarter& res)
+    {
+        res.deserializeSectionBegin("XdmfWriter");
+        res.deserializeStream() >> curWriterNum_;
+
+        std::string dummy;
+        std::getline(res.deserializeStream(), dummy);
+        if (commRank_ == 0) {
+            size_t len;
+            res.deserializeStream() >> len;
+            std::getline(res.deserializeStream(), dummy);
+            timeStepEntries_.resize(len);
+            res.deserializeStream().read(&timeStepEntries_[0], static_cast<std::streamsize>(len));
+        }
+        res.deserializeSectionEnd();
+    }
+
+private:
+    void attachTensorData_(TensorBuffer& buf, const std::string& name, FieldCenter center)
+    {
+        if (buf.empty())
+            return;
+
+        // extract the columns of the tensors into vector buffers which are kept until
+        // the data has been written
+        tensorColumns_.emplace_back();
+        auto& columns = tensorColumns_.back();
+        columns.resize(buf[0].M());
+        for (unsigned colIdx = 0; colIdx < buf[0].M(); ++colIdx) {
+            auto& colBuf = columns[colIdx];
+            colBuf.resize(buf.size());
+            for (size_t i = 0; i < buf.size(); ++i) {
+                colBuf[i].resize(buf[i].N());
+                for (unsigned rowIdx = 0; rowIdx < buf[i].N(); ++rowIdx)
+                    colBuf[i][rowIdx] = buf[i][rowIdx][colIdx];
+            }
+
+            std::ostringstream oss;
+            oss << name << "[" << colIdx << "]";
+            vectorFields_.push_back(VectorField{&colBuf, oss.str(), center});
+        }
+    }
+
+    // determine the XDMF topology of the grid and the order in which XDMF expects the
+    // vertices of an element
+    void determineTopology_(std::string& topologyAttributes,
+                            std::vector<unsigned>& vertexOrder) const
+    {
+        // make sure that all processes agree on the element type, even if some of them
+        // do not have any interior elements
+        int localTypeId = 0;
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            int typeId = elem.type().isSimplex() ? 1 : (elem.type().isCube() ? 2 : 3);
+            if (localTypeId != 0 && localTypeId != typeId)
+                localTypeId = 3;
+            else
+                localTypeId = typeId;
+        }
+        int typeId = gridView_.comm().max(localTypeId);
+        int minTypeId = gridView_.comm().min(localTypeId == 0 ? typeId : localTypeId);
+        if (typeId == 3 || (typeId != 0 && minTypeId != typeId))
+            throw std::runtime_error("The XDMF output only supports grids which consist of "
+                                     "simplices or of cubes");
+
+        if (dim == 1) {
+            topologyAttributes = "TopologyType=\"Polyline\" NodesPerElement=\"2\"";
+            vertexOrder = {0, 1};
+        }
+        else if (dim == 2 && typeId == 1) {
+            topologyAttributes = "TopologyType=\"Triangle\"";
+            vertexOrder = {0, 1, 2};
+        }
+        else if (dim == 2) {
+            topologyAttributes = "TopologyType=\"Quadrilateral\"";
+            vertexOrder = {0, 1, 3, 2};
+        }
+        else if (dim == 3 && typeId == 1) {
+            topologyAttributes = "TopologyType=\"Tetrahedron\"";
+            vertexOrder = {0, 1, 2, 3};
+        }
+        else if (dim == 3) {
+            topologyAttributes = "TopologyType=\"Hexahedron\"";
+            vertexOrder = {0, 1, 3, 2, 4, 5, 7, 6};
+        }
+        else
+            throw std::runtime_error("The XDMF output only supports grids of dimension 1 to 3");
+    }
+
+    void writeMesh_(std::ostream& gridXml)
+    {
+        std::string topologyAttributes;
+        std::vector<unsigned> vertexOrder;
+        determineTopology_(topologyAttributes, vertexOrder);
+
+        // the elements written by the local process. these also determine the order in
+        // which the element centered fields are written
+        writtenElements_.clear();
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior))
+            writtenElements_.push_back(static_cast<unsigned>(elementMapper_.index(elem)));
+
+        size_t numLocalVertices = static_cast<size_t>(vertexMapper_.size());
+        numGlobalVertices_ = globalSizeAndOffset_(numLocalVertices, vertexOffset_);
+        size_t elementOffset;
+        numGlobalElements_ = globalSizeAndOffset_(writtenElements_.size(), elementOffset);
+
+        // vertex coordinates. XDMF always wants three of them
+        std::vector<float> coords(3*numLocalVertices, 0.0f);
+        for (const auto& vertex : vertices(gridView_)) {
+            size_t vertIdx = static_cast<size_t>(vertexMapper_.index(vertex));
+            const auto& pos = vertex.geometry().corner(0);
+            for (unsigned i = 0; i < dimWorld && i < 3; ++i)
+                coords[3*vertIdx + i] = static_cast<float>(pos[i]);
+        }
+        size_t coordsOffset = writeDataset_(coords.data(), sizeof(float), 3*numLocalVertices, 3*vertexOffset_, 3*numGlobalVertices_);
+
+        // connectivity in terms of the global vertex indices of the file
+        std::vector<int64_t> connectivity;
+        connectivity.reserve(vertexOrder.size()*writtenElements_.size());
+        for (const auto& elem : elements(gridView_, Dune::Partitions::interior)) {
+            for (unsigned localVertIdx : vertexOrder) {
+                size_t vertIdx = static_cast<size_t>(vertexMapper_.subIndex(elem, static_cast<int>(localVertIdx), dim));
+                connectivity.push_back(static_cast<int64_t>(vertexOffset_ + vertIdx));
+            }
+        }
+        size_t n = vertexOrder.size();
+        size_t connectivityOffset = writeDataset_(connectivity.data(), sizeof(int64_t), n*writtenElements_.size(), n*elementOffset, n*numGlobalElements_);
+        elementOffset_ = elementOffset;
+
+        gridXml << "    <Topology " << topologyAttributes << " NumberOfElements=\"" << numGlobalElements_ << "\">\n"
+                << "     " << dataItem_(numGlobalElements_, n, "Int", sizeof(int64_t), connectivityOffset) << "\n"
+                << "    </Topology>\n"
+                << "    <Geometry GeometryType=\"XYZ\">\n"
+                << "     " << dataItem_(numGlobalVertices_, 3, "Float", sizeof(float), coordsOffset) << "\n"
+                << "    </Geometry>\n";
+    }
+
+    void writeScalarField_(std::ostream& gridXml, const ScalarField& field)
+    {
+        std::vector<float> values;
+        size_t numGlobal = collectValues_(values, field.center, 1,
+                                          [&field](size_t idx, unsigned)
+                                          { return (*field.buf)[idx]; });
+        size_t offset = writeFieldValues_(values, field.center, 1);
+
+        gridXml << "    <Attribute Name=\"" << field.name << "\" AttributeType=\"Scalar\" Center=\""
+                << (field.center == VertexCenter ? "Node" : "Cell") << "\">\n"
+                << "     " << dataItem_(numGlobal, 1, "Float", sizeof(float), offset) << "\n"
+                << "    </Attribute>\n";
+    }
+
+    void writeVectorField_(std::ostream& gridXml, const VectorField& field)
+    {
+        // XDMF vectors have exactly three components
+        std::vector<float> values;
+        size_t numGlobal = collectValues_(values, field.center, 3,
+                                          [&field](size_t idx, unsigned compIdx)
+                                          {
+                                              const auto& v = (*field.buf)[idx];
+                                              return compIdx < v.size() ? v[compIdx] : 0.0;
+                                          });
+        size_t offset = writeFieldValues_(values, field.center, 3);
+
+        gridXml << "    <Attribute Name=\"" << field.name << "\" AttributeType=\"Vector\" Center=\""
+                << (field.center == VertexCenter ? "Node" : "Cell") << "\">\n"
+                << "     " << dataItem_(numGlobal, 3, "Float", sizeof(float), offset) << "\n"
+                << "    </Attribute>\n";
+    }
+
+    // copy the values of a field which are written by the local process into a buffer
+    // and return the number of entities written by all processes
+    template <class ValueFn>
+    size_t collectValues_(std::vector<float>& values,
+                          FieldCenter center,
+                          unsigned numComponents,
+                          const ValueFn& valueFn) const
+    {
+        if (center == VertexCenter) {
+            size_t numLocal = static_cast<size_t>(vertexMapper_.size());
+            values.resize(numComponents*numLocal);
+            for (size_t i = 0; i < numLocal; ++i)
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    values[numComponents*i + compIdx] = static_cast<float>(valueFn(i, compIdx));
+            return numGlobalVertices_;
+        }
+
+        values.resize(numComponents*writtenElements_.size());
+        for (size_t i = 0; i < writtenElements_.size(); ++i)
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                values[numComponents*i + compIdx] = static_cast<float>(valueFn(writtenElements_[i], compIdx));
+        return numGlobalElements_;
+    }
+
+    size_t writeFieldValues_(const std::vector<float>& values, FieldCenter center, unsigned numComponents)
+    {
+        if (center == VertexCenter)
+            return writeDataset_(values.data(), sizeof(float), values.size(),
+                                 numComponents*vertexOffset_, numComponents*numGlobalVertices_);
+        return writeDataset_(values.data(), sizeof(float), values.size(),
+                             numComponents*elementOffset_, numComponents*numGlobalElements_);
+    }
+
+    std::string dataItem_(size_t numEntities,
+                          size_t numComponents,
+                          const char* numberType,
+                          size_t precision,
+                          size_t seek) const
+    {
+        std::ostringstream oss;
+        oss << "<DataItem Dimensions=\"" << numEntities << " " << numComponents << "\""
+            << " NumberType=\"" << numberType << "\" Precision=\"" << precision << "\""
+            << " Format=\"Binary\" Endian=\"Native\" Seek=\"" << seek << "\">"
+            << openFileName_ << "</DataItem>";
+        return oss.str();
+    }
+
+    // compute the sum of a quantity over all processes and the sum over all processes
+    // with a smaller rank
+    size_t globalSizeAndOffset_(size_t localSize, size_t& offset) const
+    {
+        std::vector<unsigned long> sizes(static_cast<size_t>(commSize_));
+        unsigned long tmp = localSize;
+        gridView_.comm().allgather(&tmp, 1, sizes.data());
+
+        offset = 0;
+        size_t globalSize = 0;
+        for (int rank = 0; rank < commSize_; ++rank) {
+            if (rank < commRank_)
+                offset += sizes[static_cast<size_t>(rank)];
+            globalSize += sizes[static_cast<size_t>(rank)];
+        }
+        return globalSize;
+    }
+
+    // write a contiguous part of a data set which consists of the data of all processes
+    // and return the position of the data set within the file
+    size_t writeDataset_(const void* data,
+                         size_t entrySize,
+                         size_t numLocalEntries,
+                         size_t localOffset,
+                         size_t numGlobalEntries)
+    {
+        size_t datasetPos = filePos_;
+        size_t pos = datasetPos + localOffset*entrySize;
+        size_t numBytes = numLocalEntries*entrySize;
+
+#if HAVE_MPI
+        if (commSize_ > 1) {
+            // MPI uses int to specify the number of bytes, so the data is written in
+            // chunks if necessary
+            const char* bytes = static_cast<const char*>(data);
+            const size_t maxChunkSize = 1UL << 30;
+            size_t numChunks = (numBytes + maxChunkSize - 1)/maxChunkSize;
+            numChunks = gridView_.comm().max(numChunks);
+            for (size_t chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx) {
+                size_t begin = std::min(numBytes, chunkIdx*maxChunkSize);
+                size_t end = std::min(numBytes, begin + maxChunkSize);
+                MPI_File_write_at_all(mpiFile_,
+                                      static_cast<MPI_Offset>(pos + begin),
+                                      const_cast<char*>(bytes + begin),
+                                      static_cast<int>(end - begin),
+                                      MPI_BYTE,
+                                      MPI_STATUS_IGNORE);
+            }
+        }
+        else
+#endif
+        {
+            file_.seekp(static_cast<std::streamoff>(pos));
+            file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(numBytes));
+        }
+
+        filePos_ += numGlobalEntries*entrySize;
+        return datasetPos;
+    }
+
+    void openFile_(const std::string& localFileName)
+    {
+        const std::string fileName = outputDir_ + "/" + localFileName;
+        openFileName_ = localFileName;
+        filePos_ = 0;
+#if HAVE_MPI
+        if (commSize_ > 1) {
+            MPI_Comm comm = Dune::MPIHelper::getCommunicator();
+            // remove a file which may be left over from a previous run: MPI does not
+            // truncate existing files
+            if (commRank_ == 0)
+                MPI_File_delete(const_cast<char*>(fileName.c_str()), MPI_INFO_NULL);
+            MPI_Barrier(comm);
+
+            int err = MPI_File_open(comm,
+                                    const_cast<char*>(fileName.c_str()),
+                                    MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                                    MPI_INFO_NULL,
+                                    &mpiFile_);
+            if (err != MPI_SUCCESS)
+                throw std::runtime_error("Could not open file '"+fileName+"' for writing");
+            return;
+        }
+#endif
+        file_.open(fileName, std::ios::binary | std::ios::trunc);
+        if (!file_)
+            throw std::runtime_error("Could not open file '"+fileName+"' for writing");
+    }
+
+    void closeFile_()
+    {
+#if HAVE_MPI
+        if (commSize_ > 1) {
+            MPI_File_close(&mpiFile_);
+            return;
+        }
+#endif
+        file_.close();
+    }
+
+    // the index file is rewritten completely for each time step so that it can always
+    // be opened, even if the simulation is aborted
+    void writeIndexFile_() const
+    {
+        std::ofstream indexFile(outputDir_ + "/" + simName_ + ".xmf");
+        indexFile << "<?xml version=\"1.0\"?>\n"
+                  << "<Xdmf Version=\"3.0\">\n"
+                  << " <Domain>\n"
+                  << "  <Grid Name=\"" << simName_ << "\" GridType=\"Collection\" CollectionType=\"Temporal\">\n"
+                  << timeStepEntries_
+                  << "  </Grid>\n"
+                  << " </Domain>\n"
+                  << "</Xdmf>\n";
+    }
+
+    const GridView gridView_;
+    ElementMapper elementMapper_;
+    VertexMapper vertexMapper_;
+
+    std::string outputDir_;
+    std::string simName_;
+    int commSize_; // number of processes in the communicator
+    int commRank_; // rank of the current process in the communicator
+
+    double curTime_;
+    std::string curFileName_;
+    int curWriterNum_;
+
+    std::vector<ScalarField> scalarFields_;
+    std::vector<VectorField> vectorFields_;
+    std::list<std::vector<VectorBuffer>> tensorColumns_;
+
+    // the XDMF elements of all time steps written so far. only used by the first process
+    std::string timeStepEntries_;
+
+    // the XDMF description of the mesh of the current grid. empty if the mesh needs to
+    // be written
+    std::string meshXml_;
+
+    // the state of the file which is currently written
+    std::string openFileName_;
+    std::vector<unsigned> writtenElements_;
+    size_t numGlobalVertices_;
+    size_t numGlobalElements_;
+    size_t vertexOffset_;
+    size_t elementOffset_;
+    size_t filePos_;
+    std::ofstream file_;
+#if HAVE_MPI
+    MPI_File mpiFile_;
+#endif
+};
+} // namespace Opm
+
+#endif
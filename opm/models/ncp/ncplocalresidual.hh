@@ -32,6 +32,7 @@
 
 #include <opm/models/common/diffusionmodule.hh>
 #include <opm/models/common/energymodule.hh>
+#include <opm/models/utils/parametersystem.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -71,6 +72,21 @@ class NcpLocalResidual : public GetPropType<TypeTag, Properties::DiscLocalResidu
     using Toolbox = Opm::MathToolbox<Evaluation>;
 
 public:
+    NcpLocalResidual()
+    { useFischerBurmeister_ = EWOMS_GET_PARAM(TypeTag, bool, NcpUseFischerBurmeister); }
+
+    /*!
+     * \brief Register all run-time parameters for the local residual.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NcpUseFischerBurmeister,
+                             "Use the Fischer-Burmeister function instead of the minimum "
+                             "function for the phase presence conditions");
+    }
+
     /*!
      * \copydoc ImmiscibleLocalResidual::addPhaseStorage
      */
@@ -140,6 +156,10 @@ public:
 
         unsigned focusDofIdx = elemCtx.focusDofIndex();
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            // immobile phases do not transport anything
+            if (extQuants.phaseIsImmobile(phaseIdx))
+                continue;
+
             // data attached to upstream and the downstream DOFs
             // of the current phase
             unsigned upIdx = static_cast<unsigned>(extQuants.upstreamIndex(phaseIdx));
@@ -209,6 +229,13 @@ public:
 
     /*!
      * \brief Returns the value of the NCP-function for a phase.
+     *
+     * This is either the minimum of the inequalities for the phase being present and
+     * not being present, or the Fischer-Burmeister function of the two,
+     * \f[ \phi(a, b) = a + b - \sqrt{a^2 + b^2} \;. \f]
+     * Unlike the minimum function, the latter also couples the inequality which is
+     * not active to the Newton update, which usually leads to fewer iterations if the
+     * phase presence changes.
      */
     template <class LhsEval = Evaluation>
     LhsEval phaseNcp(const ElementContext& elemCtx,
@@ -223,7 +250,12 @@ public:
 
         const LhsEval& a = phaseNotPresentIneq_<FluidState, LhsEval>(fluidState, phaseIdx);
         const LhsEval& b = phasePresentIneq_<FluidState, LhsEval>(fluidState, phaseIdx);
-        return LhsToolbox::min(a, b);
+        if (!useFischerBurmeister_)
+            return LhsToolbox::min(a, b);
+
+        // the tiny regularization keeps the function differentiable if both
+        // inequalities are zero
+        return a + b - LhsToolbox::sqrt(a*a + b*b + 1e-20);
     }
 
 private:
@@ -254,6 +286,8 @@ private:
             a -= FsToolbox::template decay<LhsEval>(fluidState.moleFraction(phaseIdx, i));
         return a;
     }
+
+    bool useFischerBurmeister_;
 };
 
 } // namespace Opm
@@ -144,6 +144,10 @@ struct NcpFugacitiesBaseWeight<TypeTag, TTag::NcpModel>
     static constexpr type value = 1.0e-6;
 };
 
+//! Use the minimum function for the complementarity conditions by default
+template<class TypeTag>
+struct NcpUseFischerBurmeister<TypeTag, TTag::NcpModel> { static constexpr bool value = false; };
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -230,6 +234,7 @@ class NcpModel
 
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
@@ -342,6 +347,30 @@ public:
         return oss.str();
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::extrapolationAllowed_
+     */
+    bool extrapolationAllowed_(const PrimaryVariables& priVars,
+                               const PrimaryVariables& prevPriVars) const
+    {
+        // the saturations are not clamped, i.e., they are not positive for absent
+        // phases. we do not extrapolate across the appearance or disappearance of a
+        // phase because the complementarity conditions are not smooth there.
+        Scalar sumSat = 0.0;
+        Scalar prevSumSat = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases - 1; ++phaseIdx) {
+            Scalar S = priVars[saturation0Idx + phaseIdx];
+            Scalar prevS = prevPriVars[saturation0Idx + phaseIdx];
+            if ((S > 0.0) != (prevS > 0.0))
+                return false;
+
+            sumSat += S;
+            prevSumSat += prevS;
+        }
+
+        return (sumSat < 1.0) == (prevSumSat < 1.0);
+    }
+
     /*!
      * \copydoc FvBaseDiscretization::updateBegin
      */
@@ -460,6 +489,15 @@ public:
     Scalar minActivityCoeff(unsigned globalDofIdx, unsigned compIdx) const
     { return minActivityCoeff_[globalDofIdx][compIdx]; }
 
+    /*!
+     * \brief Returns the smallest activity coefficients of all components for the
+     *        most current solution at a vertex.
+     *
+     * \param globalDofIdx The global index of the vertex (i.e. finite volume) of interest.
+     */
+    const ComponentVector& minActivityCoeff(unsigned globalDofIdx) const
+    { return minActivityCoeff_[globalDofIdx]; }
+
     /*!
      * \internal
      */
@@ -31,6 +31,7 @@
 #include "ncpproperties.hh"
 
 #include <opm/models/nonlinear/newtonmethod.hh>
+#include <opm/models/parallel/blockvectorkernels.hh>
 
 #include <opm/material/common/Unused.hpp>
 #include <opm/material/common/Exceptions.hpp>
@@ -83,45 +84,36 @@ protected:
     friend ParentType;
     friend NewtonMethod<TypeTag>;
 
-    void preSolve_(const SolutionVector& currentSolution OPM_UNUSED,
-                   const GlobalEqVector& currentResidual)
+    /*!
+     * \copydoc NewtonMethod::residualError_
+     *
+     * The residuals of the NCP equations are not considered for the error.
+     */
+    Scalar residualError_(const GlobalEqVector& residual) const
     {
         const auto& constraintsMap = this->model().linearizer().constraintsMap();
-        this->lastError_ = this->error_;
-
-        // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
-        this->error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= this->model().numGridDof() || this->model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (this->enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
-                    continue;
-            }
 
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
-                if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
-                    continue;
-                this->error_ =
-                    std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
-                             this->error_);
-            }
-        }
+        // calculate the error as the maximum weighted tolerance of the solution's
+        // residual. auxiliary DOFs, which are located after the ones of the grid, and
+        // DOFs which are constraint are not considered.
+        Scalar error =
+            BlockVectorKernels::weightedMaxNorm(residual,
+                                                this->model().numGridDof(),
+                                                [this](unsigned dofIdx, unsigned eqIdx)
+                                                {
+                                                    if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
+                                                        return Scalar(0.0);
+                                                    return Scalar(this->model().eqWeight(dofIdx, eqIdx));
+                                                },
+                                                [&](unsigned dofIdx)
+                                                {
+                                                    return this->model().dofTotalVolume(dofIdx) <= 0.0
+                                                        || (this->enableConstraints_()
+                                                            && constraintsMap.count(dofIdx) > 0);
+                                                });
 
         // take the other processes into account
-        this->error_ = this->comm_.max(this->error_);
-
-        // make sure that the error never grows beyond the maximum
-        // allowed one
-        if (this->error_ > EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))
-            throw Opm::NumericalIssue("Newton: Error "+std::to_string(double(this->error_))+
-                                        +" is larger than maximum allowed error of "
-                                        +std::to_string(double(EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))));
+        return this->comm_.max(error);
     }
 
     /*!
@@ -165,16 +157,19 @@ protected:
                     currentValue[pressure0Idx]*0.8,
                     currentValue[pressure0Idx]*1.2);
 
+        // get the minimum activity coefficients of all components (i.e., the activity
+        // coefficient of the phase for which the component has the highest affinity)
+        // once, they are required by all limiters of the fugacities
+        const auto& minActivityCoeffs = this->problem().model().minActivityCoeff(globalDofIdx);
+
         // fugacities
+        Scalar minMinPhi = 0.001*currentValue[pressure0Idx];
         for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
             Scalar& val = nextValue[fugacity0Idx + compIdx];
             Scalar oldVal = currentValue[fugacity0Idx + compIdx];
 
-            // get the minimum activity coefficient for the component (i.e., the activity
-            // coefficient of the phase for which the component has the highest affinity)
-            Scalar minPhi = this->problem().model().minActivityCoeff(globalDofIdx, compIdx);
             // Make sure that the activity coefficient does not get too small.
-            minPhi = std::max(0.001*currentValue[pressure0Idx], minPhi);
+            Scalar minPhi = std::max(minMinPhi, minActivityCoeffs[compIdx]);
 
             // allow the mole fraction of the component to change at most 70% in any
             // phase (assuming composition independent fugacity coefficients).
@@ -192,7 +187,7 @@ protected:
             for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
                 Scalar& val = nextValue[fugacity0Idx + compIdx];
                 Scalar oldVal = currentValue[fugacity0Idx + compIdx];
-                Scalar minPhi = this->problem().model().minActivityCoeff(globalDofIdx, compIdx);
+                Scalar minPhi = minActivityCoeffs[compIdx];
                 if (oldVal < 1.0*minPhi && val > 1.0*minPhi)
                     val = 1.0*minPhi;
                 else if (oldVal > 0.0 && val < 0.0)
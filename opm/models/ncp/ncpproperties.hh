@@ -47,6 +47,11 @@ struct NcpSaturationsBaseWeight { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct NcpFugacitiesBaseWeight { using type = UndefinedProperty; };
 
+//! Use the Fischer-Burmeister function instead of the minimum function for the
+//! complementarity conditions of the phase presence
+template<class TypeTag, class MyTypeTag>
+struct NcpUseFischerBurmeister { using type = UndefinedProperty; };
+
 //! The themodynamic constraint solver which calculates the
 //! composition of any phase given all component fugacities.
 template<class TypeTag, class MyTypeTag>
@@ -32,8 +32,13 @@
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/timer.hh>
+#include <opm/models/utils/eventtracer.hh>
+#include <opm/models/utils/perfcounters.hh>
 #include <opm/models/utils/timerguard.hh>
+#include <opm/models/parallel/nonblockingsum.hh>
+#include <opm/models/parallel/blockvectorkernels.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
+#include <opm/simulators/linalg/flexiblegmressolver.hh>
 
 #include <opm/material/densead/Math.hpp>
 #include <opm/material/common/Unused.hpp>
@@ -45,8 +50,14 @@
 #include <dune/common/version.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <sstream>
+#include <vector>
 
 #include <unistd.h>
 
@@ -125,6 +136,100 @@ struct NewtonTargetIterations { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct NewtonMaxIterations { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specifies whether the linear systems of the Newton method are solved without
+ *        using the assembled Jacobian as the linear operator.
+ *
+ * If this is enabled, the directional derivatives of the residual are approximated
+ * using finite differences while the assembled Jacobian is only used as preconditioner.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonJacobianFree { using type = UndefinedProperty; };
+
+//! The number of Newton iterations after which the Jacobian which is used to
+//! precondition the Jacobian-free linear solver is reassembled
+template<class TypeTag, class MyTypeTag>
+struct NewtonJacobianRebuildInterval { using type = UndefinedProperty; };
+
+//! The reduction of the residual which the Jacobian-free linear solver needs to achieve
+template<class TypeTag, class MyTypeTag>
+struct NewtonJacobianFreeTolerance { using type = UndefinedProperty; };
+
+//! The maximum number of iterations of the Jacobian-free linear solver
+template<class TypeTag, class MyTypeTag>
+struct NewtonJacobianFreeMaxIterations { using type = UndefinedProperty; };
+
+/*!
+ * \brief The maximum number of consecutive Newton iterations which reuse the most
+ *        recently assembled Jacobian and its preconditioner.
+ *
+ * A value of 0 disables these "chord" iterations, i.e., the Jacobian is reassembled for
+ * each iteration.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonChordIterations { using type = UndefinedProperty; };
+
+//! The maximum ratio of the errors of two consecutive Newton iterations for which the
+//! Jacobian is not reassembled during the chord iterations
+template<class TypeTag, class MyTypeTag>
+struct NewtonChordMaxErrorRatio { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specifies whether the tolerance of the linear solver is adapted to the
+ *        convergence of the Newton method.
+ *
+ * If this is enabled, the residual reduction which is required from the linear solver
+ * is determined using the forcing terms proposed by Eisenstat and Walker. The
+ * LinearSolverTolerance parameter then specifies the tightest tolerance used.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonAdaptiveLinearTolerance { using type = UndefinedProperty; };
+
+//! The loosest tolerance of the linear solver if it is adapted to the convergence of
+//! the Newton method
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxLinearTolerance { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specifies whether the update of the Newton method is damped using a
+ *        backtracking line search.
+ *
+ * If this is enabled, the update is halved until the error of the solution decreases
+ * sufficiently or the maximum number of line search iterations is reached.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonLineSearch { using type = UndefinedProperty; };
+
+//! The maximum number of times the update of a Newton iteration gets halved by the
+//! line search
+template<class TypeTag, class MyTypeTag>
+struct NewtonLineSearchMaxIterations { using type = UndefinedProperty; };
+
+/*!
+ * \brief The maximum number of local Newton iterations on the subdomain of each process
+ *        before each global Newton iteration.
+ *
+ * If this is larger than zero, the Newton method uses a nonlinear domain decomposition:
+ * The boundary values of the subdomains are kept fixed while their residuals are
+ * reduced locally, so the global iterations are only required to resolve the coupling
+ * between the subdomains. A value of 0 disables the local iterations.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonSubdomainIterations { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specifies whether the Newton method predicts its convergence from the errors of
+ *        the previous iterations.
+ *
+ * If this is enabled, the Newton method gives up early if even the fastest convergence
+ * rate observed in the last two iterations does not reach the tolerance within the
+ * maximum number of iterations. It also accepts the solution of an iteration without
+ * linearizing the system again if the iterations converge quadratically and the
+ * predicted error of the solution is well below the tolerance.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonPredictConvergence { using type = UndefinedProperty; };
+
 // set default values for the properties
 template<class TypeTag>
 struct NewtonMethod<TypeTag, TTag::NewtonMethod> { using type = ::Opm::NewtonMethod<TypeTag>; };
@@ -152,6 +257,42 @@ template<class TypeTag>
 struct NewtonTargetIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 10; };
 template<class TypeTag>
 struct NewtonMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 18; };
+template<class TypeTag>
+struct NewtonJacobianFree<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
+template<class TypeTag>
+struct NewtonJacobianRebuildInterval<TypeTag, TTag::NewtonMethod> { static constexpr int value = 3; };
+template<class TypeTag>
+struct NewtonJacobianFreeTolerance<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-4;
+};
+template<class TypeTag>
+struct NewtonJacobianFreeMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 50; };
+template<class TypeTag>
+struct NewtonChordIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NewtonChordMaxErrorRatio<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.5;
+};
+template<class TypeTag>
+struct NewtonAdaptiveLinearTolerance<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
+template<class TypeTag>
+struct NewtonMaxLinearTolerance<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.1;
+};
+template<class TypeTag>
+struct NewtonLineSearch<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
+template<class TypeTag>
+struct NewtonLineSearchMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 5; };
+template<class TypeTag>
+struct NewtonSubdomainIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NewtonPredictConvergence<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
 
 } // namespace Opm::Properties
 
@@ -176,6 +317,7 @@ class NewtonMethod
     using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using Constraints = GetPropType<TypeTag, Properties::Constraints>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
     using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
     using LinearSolverBackend = GetPropType<TypeTag, Properties::LinearSolverBackend>;
@@ -193,10 +335,34 @@ public:
         , convergenceWriter_(asImp_())
     {
         lastError_ = 1e100;
+        secondLastError_ = 1e100;
         error_ = 1e100;
+        updateError_ = 0.0;
         tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonTolerance);
+        jacobianFree_ = EWOMS_GET_PARAM(TypeTag, bool, NewtonJacobianFree);
+        jacobianRebuildInterval_ = EWOMS_GET_PARAM(TypeTag, int, NewtonJacobianRebuildInterval);
+        chordIterations_ = EWOMS_GET_PARAM(TypeTag, int, NewtonChordIterations);
+        chordMaxErrorRatio_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonChordMaxErrorRatio);
+        numJacobianReuses_ = 0;
+        adaptiveLinearTolerance_ = EWOMS_GET_PARAM(TypeTag, bool, NewtonAdaptiveLinearTolerance);
+        minLinearTolerance_ = linearSolver_.tolerance();
+        maxLinearTolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxLinearTolerance);
+        lastLinearTolerance_ = maxLinearTolerance_;
+        lineSearch_ = EWOMS_GET_PARAM(TypeTag, bool, NewtonLineSearch);
+        lineSearchMaxIterations_ = EWOMS_GET_PARAM(TypeTag, int, NewtonLineSearchMaxIterations);
+        subdomainIterations_ = EWOMS_GET_PARAM(TypeTag, int, NewtonSubdomainIterations);
+        predictConvergence_ = EWOMS_GET_PARAM(TypeTag, bool, NewtonPredictConvergence);
+        convergencePredicted_ = false;
+        jacobianFreeMaxIterations_ = EWOMS_GET_PARAM(TypeTag, int, NewtonJacobianFreeMaxIterations);
+        jacobianFreeTolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonJacobianFreeTolerance);
+        maxError_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError);
+        numTargetIterations_ = EWOMS_GET_PARAM(TypeTag, int, NewtonTargetIterations);
+        numMaxIterations_ = EWOMS_GET_PARAM(TypeTag, int, NewtonMaxIterations);
+        isVerbose_ = EWOMS_GET_PARAM(TypeTag, bool, NewtonVerbose) && (comm_.rank() == 0);
+        writeConvergenceFields_ = EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence);
 
         numIterations_ = 0;
+        resetIterationChecks_();
     }
 
     /*!
@@ -205,13 +371,14 @@ public:
     static void registerParameters()
     {
         LinearSolverBackend::registerParameters();
+        ConvergenceWriter::registerParameters();
 
         EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonVerbose,
                              "Specify whether the Newton method should inform "
                              "the user about its progress or not");
         EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonWriteConvergence,
                              "Write the convergence behaviour of the Newton "
-                             "method to a VTK file");
+                             "method to disk");
         EWOMS_REGISTER_PARAM(TypeTag, int, NewtonTargetIterations,
                              "The 'optimum' number of Newton iterations per "
                              "time step");
@@ -225,6 +392,53 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxError,
                              "The maximum error tolerated by the Newton "
                              "method to which does not cause an abort");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonJacobianFree,
+                             "Solve the linear systems using finite difference "
+                             "approximations of the Jacobian-vector products and only "
+                             "use the assembled Jacobian as preconditioner. This is only "
+                             "possible for sequential runs of problems without auxiliary "
+                             "equations and constraints");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonJacobianRebuildInterval,
+                             "The number of Newton iterations after which the Jacobian "
+                             "is reassembled if the Jacobian-free mode is used");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonJacobianFreeTolerance,
+                             "The residual reduction of the linear solver if the "
+                             "Jacobian-free mode is used");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonJacobianFreeMaxIterations,
+                             "The maximum number of linear iterations if the "
+                             "Jacobian-free mode is used");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonChordIterations,
+                             "The maximum number of consecutive Newton iterations which "
+                             "reuse the Jacobian of a previous iteration (0: always "
+                             "reassemble the Jacobian). This is only possible for "
+                             "sequential runs of problems without auxiliary equations and "
+                             "constraints");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonChordMaxErrorRatio,
+                             "The Jacobian is reassembled if the ratio of the errors of "
+                             "two consecutive Newton iterations exceeds this value");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonAdaptiveLinearTolerance,
+                             "Adapt the tolerance of the linear solver to the convergence "
+                             "of the Newton method using Eisenstat-Walker forcing terms");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxLinearTolerance,
+                             "The loosest tolerance of the linear solver if it is adapted "
+                             "to the convergence of the Newton method");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonLineSearch,
+                             "Damp the updates of the Newton method using a backtracking "
+                             "line search. This is only possible for sequential runs of "
+                             "problems without auxiliary equations and constraints");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonLineSearchMaxIterations,
+                             "The maximum number of times the update of a Newton "
+                             "iteration is halved by the line search");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonSubdomainIterations,
+                             "The maximum number of local Newton iterations on the "
+                             "subdomain of each process before each global Newton "
+                             "iteration (0: no nonlinear domain decomposition)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonPredictConvergence,
+                             "Predict the convergence of the Newton method from the errors "
+                             "of the previous iterations: Give up early if the tolerance "
+                             "will not be reached within the maximum number of iterations "
+                             "and accept the solution of an iteration without linearizing "
+                             "again if the iterations converge quadratically");
     }
 
     /*!
@@ -239,9 +453,22 @@ public:
     /*!
      * \brief Returns true if the error of the solution is below the
      *        tolerance.
+     *
+     * If the convergence is predicted, this is also the case if the solution was
+     * accepted because its predicted error is below the tolerance.
      */
     bool converged() const
-    { return error_ <= tolerance(); }
+    { return error_ <= tolerance() || convergencePredicted_; }
+
+    /*!
+     * \brief Returns the maximum of the weighted changes of the primary variables of
+     *        the last Newton update on the local process.
+     *
+     * The weights are the ones of the model's primaryVarWeight() method. Degrees of
+     * freedom which are constraint are not considered.
+     */
+    Scalar updateError() const
+    { return updateError_; }
 
     /*!
      * \brief Returns a reference to the object describing the current physical problem.
@@ -274,6 +501,13 @@ public:
     int numIterations() const
     { return numIterations_; }
 
+    /*!
+     * \brief Returns the number of iterations since the Newton method was invoked for
+     *        which the Jacobian of a previous iteration has been reused.
+     */
+    int numJacobianReuses() const
+    { return numJacobianReuses_; }
+
     /*!
      * \brief Set the index of current iteration.
      *
@@ -320,12 +554,18 @@ public:
         linearizeTimer_.halt();
         solveTimer_.halt();
         updateTimer_.halt();
+        intensiveQuantitiesTimer_.halt();
+
+        asImp_().resetIterationChecks_();
 
         SolutionVector& nextSolution = model().solution(/*historyIdx=*/0);
         SolutionVector currentSolution(nextSolution);
         GlobalEqVector solutionUpdate(nextSolution.size());
 
         Linearizer& linearizer = model().linearizer();
+        int lastJacobianIteration = -1;
+        Scalar lastErrorRatio = 0.0;
+        numJacobianReuses_ = 0;
 
         TimerGuard prePostProcessTimerGuard(prePostProcessTimer_);
 
@@ -339,10 +579,19 @@ public:
             TimerGuard linearizeTimerGuard(linearizeTimer_);
             TimerGuard updateTimerGuard(updateTimer_);
             TimerGuard solveTimerGuard(solveTimer_);
+            TimerGuard intensiveQuantitiesTimerGuard(intensiveQuantitiesTimer_);
 
             // execute the method as long as the implementation thinks
             // that we should do another iteration
             while (asImp_().proceed_()) {
+                // reduce the residual of each subdomain with fixed boundary values
+                // before the next global iteration
+                if (numIterations_ > 0 && asImp_().useSubdomainSolves_()) {
+                    linearizeTimer_.start();
+                    asImp_().solveSubdomains_(nextSolution);
+                    linearizeTimer_.stop();
+                }
+
                 // linearize the problem at the current solution
 
                 // notify the implementation that we're about to start
@@ -351,6 +600,19 @@ public:
                 asImp_().beginIteration_();
                 prePostProcessTimer_.stop();
 
+                // bring the secondary quantities up to date with the current solution
+                intensiveQuantitiesTimer_.start();
+                auto traceBegin = EventTracer::now();
+                asImp_().updateIntensiveQuantities_();
+                EventTracer::record("intensive quantities", "newton", traceBegin);
+                intensiveQuantitiesTimer_.stop();
+
+                // the checks of the previous iteration and of the pre-processing were
+                // reduced over all processes while the intensive quantities were updated
+                prePostProcessTimer_.start();
+                asImp_().finishIterationChecks_();
+                prePostProcessTimer_.stop();
+
                 // make the current solution to the old one
                 currentSolution = nextSolution;
 
@@ -360,28 +622,72 @@ public:
                               << std::flush;
                 }
 
-                // do the actual linearization
+                // do the actual linearization. in Jacobian-free mode, the Jacobian is
+                // only reassembled periodically because it is only used as
+                // preconditioner. for chord iterations, the Jacobian of a previous
+                // iteration is reused as long as the error decreases fast enough. if
+                // the Jacobian is not reassembled, it suffices to evaluate the residual.
+                bool jacobianFree = asImp_().useJacobianFree_();
+                bool assembleJacobian = true;
+                if (lastJacobianIteration >= 0) {
+                    int age = numIterations_ - lastJacobianIteration;
+                    if (jacobianFree)
+                        assembleJacobian = age >= jacobianRebuildInterval_;
+                    else if (asImp_().useChordIterations_())
+                        assembleJacobian =
+                            age > chordIterations_
+                            || lastErrorRatio > chordMaxErrorRatio_;
+                }
+
                 linearizeTimer_.start();
-                asImp_().linearizeDomain_();
-                asImp_().linearizeAuxiliaryEquations_();
+                PerfCounters::begin(PerfCounters::linearizationPhase);
+                traceBegin = EventTracer::now();
+                if (assembleJacobian) {
+                    asImp_().linearizeDomain_();
+                    asImp_().linearizeAuxiliaryEquations_();
+                    lastJacobianIteration = numIterations_;
+                }
+                else {
+                    linearizer.evaluateResidual();
+                    if (!jacobianFree) {
+                        ++numJacobianReuses_;
+                        endIterMsg() << ", reused Jacobian";
+                    }
+                }
+                EventTracer::record("linearization", "newton", traceBegin);
+                PerfCounters::end(PerfCounters::linearizationPhase);
                 linearizeTimer_.stop();
 
                 solveTimer_.start();
+                PerfCounters::begin(PerfCounters::linearSolvePhase);
                 auto& residual = linearizer.residual();
                 const auto& jacobian = linearizer.jacobian();
                 linearSolver_.prepare(jacobian, residual);
                 linearSolver_.setResidual(residual);
                 linearSolver_.getResidual(residual);
+                PerfCounters::end(PerfCounters::linearSolvePhase);
                 solveTimer_.stop();
 
                 // The preSolve_() method usually computes the errors, but it can do
                 // something else in addition. TODO: should its costs be counted to
                 // the linearization or to the update?
                 updateTimer_.start();
+                PerfCounters::begin(PerfCounters::updatePhase);
+                model().updatePrimaryVarWeights();
                 asImp_().preSolve_(currentSolution, residual);
+                lastErrorRatio = error_/lastError_;
+                PerfCounters::end(PerfCounters::updatePhase);
                 updateTimer_.stop();
 
-                if (!asImp_().proceed_()) {
+                bool convergenceHopeless = asImp_().convergenceHopeless_();
+                if (convergenceHopeless) {
+                    if (asImp_().verbose_())
+                        std::cout << "Newton: The tolerance is not expected to be reached "
+                                  << "within " << asImp_().maxIterations_() << " iterations, "
+                                  << "giving up\n" << std::flush;
+                }
+
+                if (convergenceHopeless || !asImp_().proceed_()) {
                     if (asImp_().verbose_() && isatty(fileno(stdout)))
                         std::cout << clearRemainingLine
                                   << std::flush;
@@ -402,11 +708,22 @@ public:
                 }
 
                 solveTimer_.start();
+                PerfCounters::begin(PerfCounters::linearSolvePhase);
+                traceBegin = EventTracer::now();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
                 // update of the solution
-                linearSolver_.setMatrix(jacobian);
-                solutionUpdate = 0.0;
-                bool converged = linearSolver_.solve(solutionUpdate);
+                if (assembleJacobian)
+                    linearSolver_.setMatrix(jacobian);
+                if (adaptiveLinearTolerance_)
+                    linearSolver_.setTolerance(asImp_().linearTolerance_());
+                BlockVectorKernels::fill(solutionUpdate, 0.0);
+                bool converged;
+                if (jacobianFree)
+                    converged = asImp_().solveJacobianFree_(currentSolution, residual, solutionUpdate);
+                else
+                    converged = asImp_().solveLinear_(currentSolution, residual, solutionUpdate);
+                EventTracer::record("linear solve", "newton", traceBegin);
+                PerfCounters::end(PerfCounters::linearSolvePhase);
                 solveTimer_.stop();
 
                 if (!converged) {
@@ -415,6 +732,7 @@ public:
                         std::cout << "Newton: Linear solver did not converge\n" << std::flush;
 
                     prePostProcessTimer_.start();
+                    asImp_().resetIterationChecks_();
                     asImp_().failed_();
                     prePostProcessTimer_.stop();
 
@@ -431,10 +749,14 @@ public:
                 // update the current solution (i.e. uOld) with the delta
                 // (i.e. u). The result is stored in u
                 updateTimer_.start();
+                PerfCounters::begin(PerfCounters::updatePhase);
+                traceBegin = EventTracer::now();
                 asImp_().postSolve_(currentSolution,
                                     residual,
                                     solutionUpdate);
                 asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                EventTracer::record("update", "newton", traceBegin);
+                PerfCounters::end(PerfCounters::updatePhase);
                 updateTimer_.stop();
 
                 if (asImp_().verbose_() && isatty(fileno(stdout)))
@@ -446,6 +768,27 @@ public:
                 prePostProcessTimer_.start();
                 asImp_().endIteration_(nextSolution, currentSolution);
                 prePostProcessTimer_.stop();
+
+                // if the updated solution is expected to be converged, it is accepted
+                // without linearizing the system again
+                if (asImp_().convergenceExpected_()) {
+                    convergencePredicted_ = true;
+                    endIterMsg() << ", accepted by prediction";
+                }
+            }
+
+            // evaluate the checks of the last iteration
+            prePostProcessTimer_.start();
+            iterationChecks_.start(comm_);
+            asImp_().finishIterationChecks_();
+            prePostProcessTimer_.stop();
+
+            // the intensive quantities are usually brought up to date by the
+            // linearization, which was skipped for a solution accepted by prediction
+            if (convergencePredicted_) {
+                intensiveQuantitiesTimer_.start();
+                model().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+                intensiveQuantitiesTimer_.stop();
             }
         }
         catch (const Dune::Exception& e)
@@ -455,6 +798,7 @@ public:
                           << e.what() << "\"\n" << std::flush;
 
             prePostProcessTimer_.start();
+            asImp_().resetIterationChecks_();
             asImp_().failed_();
             prePostProcessTimer_.stop();
 
@@ -467,6 +811,7 @@ public:
                           << e.what() << "\"\n" << std::flush;
 
             prePostProcessTimer_.start();
+            asImp_().resetIterationChecks_();
             asImp_().failed_();
             prePostProcessTimer_.stop();
 
@@ -486,10 +831,13 @@ public:
         // print the timing summary of the time step
         if (asImp_().verbose_()) {
             Scalar elapsedTot =
-                linearizeTimer_.realTimeElapsed()
+                intensiveQuantitiesTimer_.realTimeElapsed()
+                + linearizeTimer_.realTimeElapsed()
                 + solveTimer_.realTimeElapsed()
                 + updateTimer_.realTimeElapsed();
-            std::cout << "Linearization/solve/update time: "
+            std::cout << "Intensive quantities/linearization/solve/update time: "
+                      << intensiveQuantitiesTimer_.realTimeElapsed() << "("
+                      << 100 * intensiveQuantitiesTimer_.realTimeElapsed()/elapsedTot << "%)/"
                       << linearizeTimer_.realTimeElapsed() << "("
                       << 100 * linearizeTimer_.realTimeElapsed()/elapsedTot << "%)/"
                       << solveTimer_.realTimeElapsed() << "("
@@ -497,6 +845,9 @@ public:
                       << updateTimer_.realTimeElapsed() << "("
                       << 100 * updateTimer_.realTimeElapsed()/elapsedTot << "%)"
                       << "\n" << std::flush;
+            if (asImp_().useChordIterations_())
+                std::cout << "Reused the Jacobian for " << numJacobianReuses_ << " of "
+                          << numIterations_ << " Newton iterations\n" << std::flush;
         }
 
 
@@ -581,14 +932,15 @@ public:
     const Timer& updateTimer() const
     { return updateTimer_; }
 
+    const Timer& intensiveQuantitiesTimer() const
+    { return intensiveQuantitiesTimer_; }
+
 protected:
     /*!
      * \brief Returns true if the Newton method ought to be chatty.
      */
     bool verbose_() const
-    {
-        return EWOMS_GET_PARAM(TypeTag, bool, NewtonVerbose) && (comm_.rank() == 0);
-    }
+    { return isVerbose_; }
 
     /*!
      * \brief Called before the Newton method is applied to an
@@ -599,8 +951,9 @@ protected:
     void begin_(const SolutionVector& u  OPM_UNUSED)
     {
         numIterations_ = 0;
+        convergencePredicted_ = false;
 
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
+        if (writeConvergenceFields_)
             convergenceWriter_.beginTimeStep();
     }
 
@@ -609,9 +962,6 @@ protected:
      */
     void beginIteration_()
     {
-        // start with a clean message stream
-        endIterMsgStream_.str("");
-        const auto& comm = simulator_.gridView().comm();
         bool succeeded = true;
         try {
             problem().beginIteration();
@@ -624,14 +974,393 @@ protected:
                       << "\n"  << std::flush;
         }
 
-        succeeded = comm.min(succeeded);
+        // the outcome only needs to be known once the intensive quantities have been
+        // updated, so the reduction of all checks runs in the background until then
+        beginIterationFailedSlot_ = static_cast<int>(iterationChecks_.add(succeeded ? 0 : 1));
+        iterationChecks_.start(comm_);
+
+        secondLastError_ = lastError_;
+        lastError_ = error_;
+    }
 
-        if (!succeeded)
+    /*!
+     * \brief Evaluate the checks which need to be done on all processes.
+     *
+     * The checks of the post-processing and the update of a Newton iteration as well
+     * as of the pre-processing of the next one are reduced over all processes using a
+     * single non-blocking reduction. This method completes it after the intensive
+     * quantities of the next iteration have been updated, or at the end of the Newton
+     * method, and throws a NumericalIssue if any of the checks failed on any
+     * process. Models which add their own checks must evaluate them here.
+     */
+    void finishIterationChecks_()
+    {
+        iterationChecks_.finish();
+
+        auto failed = [this](int slotIdx) -> bool
+                      {
+                          return slotIdx >= 0
+                              && iterationChecks_.value(static_cast<unsigned>(slotIdx)) > 0;
+                      };
+        bool postSolveFailed = failed(postSolveFailedSlot_);
+        bool endIterationFailed = failed(endIterationFailedSlot_);
+        bool beginIterationFailed = failed(beginIterationFailedSlot_);
+        asImp_().resetIterationChecks_();
+
+        if (postSolveFailed)
+            throw NumericalIssue("post processing of an auxilary equation failed");
+        if (endIterationFailed)
+            throw NumericalIssue("post processing of the problem failed");
+
+        if (iterationEnded_ && asImp_().verbose_()) {
+            std::cout << "Newton iteration " << numIterations_ << ""
+                      << " error: " << error_
+                      << endIterMsg().str() << "\n" << std::flush;
+        }
+        iterationEnded_ = false;
+        endIterMsgStream_.str("");
+
+        if (beginIterationFailed)
             throw NumericalIssue("pre processing of the problem failed");
+    }
 
-        lastError_ = error_;
+    // complete an outstanding reduction and remove all checks
+    void resetIterationChecks_()
+    {
+        iterationChecks_.reset();
+        postSolveFailedSlot_ = -1;
+        endIterationFailedSlot_ = -1;
+        beginIterationFailedSlot_ = -1;
+        iterationEnded_ = false;
+    }
+
+    /*!
+     * \brief Update the secondary quantities of the model for the current solution.
+     *
+     * This is called after beginIteration_() and before the system of equations gets
+     * linearized. The generic Newton method does not know about secondary quantities,
+     * so it does nothing.
+     */
+    void updateIntensiveQuantities_()
+    { }
+
+    /*!
+     * \brief Returns true if the linear systems of the current Newton iteration ought to
+     *        be solved without using the assembled Jacobian as the linear operator.
+     *
+     * The Jacobian-free mode evaluates the global residual of the model directly, so it
+     * is not used for parallel runs and for problems with auxiliary equations or
+     * constraints.
+     */
+    bool useJacobianFree_() const
+    { return jacobianFree_ && asImp_().canEvaluateResidualOnly_(); }
+
+    /*!
+     * \brief Returns true if the Jacobian of a previous Newton iteration may be reused
+     *        for the linear system of the current one.
+     *
+     * Like for the Jacobian-free mode, only the global residual of the model is
+     * evaluated if the Jacobian is reused.
+     */
+    bool useChordIterations_() const
+    { return chordIterations_ > 0 && asImp_().canEvaluateResidualOnly_(); }
+
+    /*!
+     * \brief Returns true if the residual of the linearization may be evaluated on its
+     *        own.
+     *
+     * This is not the case for parallel runs and for problems with auxiliary equations
+     * or constraints because the residual is then not fully determined by the
+     * elements of the local process' grid partition.
+     */
+    bool canEvaluateResidualOnly_() const
+    {
+        return comm_.size() == 1
+            && model().numAuxiliaryModules() == 0
+            && model().linearizer().constraintsMap().empty();
     }
 
+    /*!
+     * \brief Returns the residual reduction which the linear solver needs to achieve
+     *        for the current Newton iteration.
+     *
+     * This implements the second forcing term proposed by Eisenstat and Walker (SIAM J.
+     * Sci. Comput. 17, 1996) using the errors of the last two Newton iterations instead
+     * of the norms of the residuals: The tolerance is loose as long as the Newton method
+     * is far from the solution and it is tightened as quadratic convergence sets in.
+     */
+    Scalar linearTolerance_()
+    {
+        const Scalar gamma = 0.9;
+
+        Scalar tolerance = maxLinearTolerance_;
+        if (numIterations_ > 0 && lastError_ > 0.0) {
+            Scalar errorRatio = error_/lastError_;
+            tolerance = gamma*errorRatio*errorRatio;
+
+            // do not tighten the tolerance too quickly if the previous one was loose
+            Scalar safeguard = gamma*lastLinearTolerance_*lastLinearTolerance_;
+            if (safeguard > 0.1)
+                tolerance = std::max(tolerance, safeguard);
+        }
+
+        tolerance = std::min(std::max(tolerance, minLinearTolerance_), maxLinearTolerance_);
+        lastLinearTolerance_ = tolerance;
+        return tolerance;
+    }
+
+    /*!
+     * \brief Solve the linear system of a Newton iteration without using the assembled
+     *        Jacobian as the linear operator.
+     *
+     * The product of the Jacobian with a vector v is approximated by the finite
+     * difference (r(u + eps v) - r(u))/eps of the global residual, and the system is
+     * solved using flexible GMRES. The linear solver of the Newton method is used as
+     * preconditioner, which means that it solves a system for the most recently
+     * assembled Jacobian at each GMRES iteration.
+     *
+     * \param u The solution at which the Jacobian ought to be evaluated
+     * \param b The residual of the solution
+     * \param x The solution of the linear system
+     */
+    bool solveJacobianFree_(const SolutionVector& u, const GlobalEqVector& b, GlobalEqVector& x)
+    {
+        // the residual is computed using the same code as for the perturbed solutions
+        // so that the differences only stem from the perturbation
+        GlobalEqVector r0(b.size());
+        model().globalResidual(r0, u);
+
+        // the primary variables may vary by many orders of magnitude, so their weights
+        // are taken into account when determining the size of the perturbation. the
+        // weights of the auxiliary degrees of freedom are not cached.
+        unsigned numGridDof = static_cast<unsigned>(model().numGridDof());
+        auto weightedNorm = [this, numGridDof](const auto& v) {
+            Scalar result = 0.0;
+            for (unsigned dofIdx = 0; dofIdx < v.size(); ++dofIdx) {
+                for (unsigned pvIdx = 0; pvIdx < v[dofIdx].size(); ++pvIdx) {
+                    Scalar weight =
+                        (dofIdx < numGridDof)
+                        ? model().cachedPrimaryVarWeight(dofIdx, pvIdx)
+                        : model().primaryVarWeight(dofIdx, pvIdx);
+                    Scalar tmp = v[dofIdx][pvIdx]*weight;
+                    result += tmp*tmp;
+                }
+            }
+            return std::sqrt(result);
+        };
+        Scalar uNorm = weightedNorm(u);
+
+        SolutionVector perturbedSolution(u);
+        auto applyJacobian = [&](const GlobalEqVector& v, GlobalEqVector& y) {
+            Scalar vNorm = weightedNorm(v);
+            if (vNorm == 0.0) {
+                y = 0.0;
+                return;
+            }
+
+            Scalar eps = std::sqrt(std::numeric_limits<Scalar>::epsilon())*(1.0 + uNorm)/vNorm;
+            BlockVectorKernels::copy(perturbedSolution, u);
+            BlockVectorKernels::axpy(perturbedSolution, eps, v);
+
+            // the cached intensive quantities do not correspond to the perturbed solution
+            model().invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+            model().globalResidual(y, perturbedSolution);
+            BlockVectorKernels::axpy(y, -1.0, r0);
+            BlockVectorKernels::scale(y, 1.0/eps);
+        };
+
+        auto applyPreconditioner = [this](const GlobalEqVector& d, GlobalEqVector& v) {
+            linearSolver_.setResidual(d);
+            v = 0.0;
+            linearSolver_.solve(v);
+        };
+
+        Linear::FlexibleGmresSolver<GlobalEqVector>
+            solver(/*restart=*/30,
+                   static_cast<unsigned>(jacobianFreeMaxIterations_),
+                   jacobianFreeTolerance_);
+        bool converged = solver.solve(applyJacobian, applyPreconditioner, x, b);
+
+        // bring the cached intensive quantities back to the unperturbed solution
+        model().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+
+        if (verbose_())
+            endIterMsg() << ", " << solver.iterations() << " Jacobian-free linear iterations";
+
+        return converged;
+    }
+
+    /*!
+     * \brief Returns true if local Newton iterations ought to be done on the subdomain
+     *        of each process before the global Newton iterations.
+     *
+     * This requires the rows of the linearization which belong to the degrees of
+     * freedom of a process to be complete, which the generic Newton method cannot
+     * know. Implementations for which this holds can enable the nonlinear domain
+     * decomposition by overloading this method.
+     */
+    bool useSubdomainSolves_() const
+    { return false; }
+
+    /*!
+     * \brief Do local Newton iterations on the subdomain of each process.
+     *
+     * The subdomain of a process consists of the degrees of freedom which it owns. All
+     * other degrees of freedom are kept at their current values, i.e., they act as
+     * Dirichlet conditions for the local problem. The linear systems of the subdomains
+     * are solved using GMRES preconditioned by the inverted diagonal blocks of the
+     * Jacobian, without any communication. The processes whose subdomains are already
+     * converged still take part in the linearizations, which are collective
+     * operations, so all processes do the same number of local iterations.
+     *
+     * \param solution The solution which is updated for the degrees of freedom of the
+     *                 subdomain
+     */
+    void solveSubdomains_(SolutionVector& solution)
+    {
+        const auto& constraintsMap = model().linearizer().constraintsMap();
+        size_t numGridDof = model().numGridDof();
+        size_t numDof = model().numTotalDof();
+
+        std::vector<unsigned char> isFixed(numDof, 1);
+        for (size_t dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            unsigned globalDofIdx = static_cast<unsigned>(dofIdx);
+            isFixed[dofIdx] =
+                !model().isLocalDof(globalDofIdx)
+                || (enableConstraints_() && constraintsMap.count(globalDofIdx) > 0);
+        }
+
+        SolutionVector currentSolution(solution);
+        GlobalEqVector subdomainUpdate(numDof);
+        int numLocalIterations = 0;
+        for (; numLocalIterations < subdomainIterations_; ++numLocalIterations) {
+            model().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+            asImp_().linearizeDomain_();
+            model().updatePrimaryVarWeights();
+
+            const auto& residual = model().linearizer().residual();
+            Scalar error =
+                BlockVectorKernels::weightedMaxNorm(residual,
+                                                    numGridDof,
+                                                    [this](unsigned dofIdx, unsigned eqIdx)
+                                                    { return model().eqWeight(dofIdx, eqIdx); },
+                                                    [&isFixed](unsigned dofIdx)
+                                                    { return isFixed[dofIdx] != 0; });
+
+            // the first entry is the number of subdomains which are not converged, the
+            // second one the number of processes on which the local update failed
+            int status[2] = { error > tolerance() ? 1 : 0, 0 };
+            if (status[0]) {
+                try {
+                    const auto& jacobian = model().linearizer().jacobian().istlMatrix();
+                    if (asImp_().solveSubdomainLinear_(jacobian, residual, subdomainUpdate, isFixed)) {
+                        BlockVectorKernels::copy(currentSolution, solution);
+                        asImp_().applyUpdate_(solution, currentSolution, subdomainUpdate, residual);
+                    }
+                    else
+                        // leave the subdomain to the global iteration
+                        status[0] = 0;
+                }
+                catch (const NumericalIssue&) {
+                    status[1] = 1;
+                }
+            }
+
+            comm_.sum(status, 2);
+            if (status[1] > 0)
+                throw NumericalIssue("The local Newton iteration of a subdomain failed");
+            if (status[0] == 0)
+                break;
+        }
+
+        // the intensive quantities need to be recalculated after the overlap has been
+        // synchronized by the next global iteration
+        model().invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+
+        if (verbose_())
+            endIterMsg() << ", " << numLocalIterations << " subdomain iterations";
+    }
+
+    /*!
+     * \brief Solve the linear system of a subdomain for the degrees of freedom which are
+     *        not fixed.
+     *
+     * The update of the fixed degrees of freedom is zero.
+     *
+     * \return true if the linear solver converged
+     */
+    template <class Matrix>
+    bool solveSubdomainLinear_(const Matrix& jacobian,
+                               const GlobalEqVector& residual,
+                               GlobalEqVector& x,
+                               const std::vector<unsigned char>& isFixed)
+    {
+        using MatrixBlock = typename Matrix::block_type;
+
+        size_t numDof = residual.size();
+        std::vector<MatrixBlock> invDiagonal(numDof);
+        for (size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+            if (isFixed[dofIdx])
+                continue;
+            invDiagonal[dofIdx] = jacobian[dofIdx][dofIdx];
+            invDiagonal[dofIdx].invert();
+        }
+
+        GlobalEqVector b(residual);
+        for (size_t dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            if (isFixed[dofIdx])
+                b[dofIdx] = 0.0;
+
+        auto applyOperator = [&](const GlobalEqVector& v, GlobalEqVector& y) {
+            for (size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                y[dofIdx] = 0.0;
+                if (isFixed[dofIdx])
+                    continue;
+
+                const auto& row = jacobian[dofIdx];
+                const auto& endColIt = row.end();
+                for (auto colIt = row.begin(); colIt != endColIt; ++colIt)
+                    if (!isFixed[colIt.index()])
+                        colIt->umv(v[colIt.index()], y[dofIdx]);
+            }
+        };
+
+        auto applyPreconditioner = [&](const GlobalEqVector& d, GlobalEqVector& v) {
+            for (size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                if (isFixed[dofIdx])
+                    v[dofIdx] = 0.0;
+                else
+                    invDiagonal[dofIdx].mv(d[dofIdx], v[dofIdx]);
+            }
+        };
+
+        Linear::FlexibleGmresSolver<GlobalEqVector>
+            solver(/*restart=*/30, /*maxIterations=*/200, /*tolerance=*/1e-2);
+        bool converged = solver.solve(applyOperator, applyPreconditioner, x, b);
+
+        // make sure not to swallow non-finite values at this point
+        if (!std::isfinite(BlockVectorKernels::oneNorm(x)))
+            throw NumericalIssue("Non-finite update of a subdomain!");
+
+        return converged;
+    }
+
+    /*!
+     * \brief Solve the linearized system of equations of a Newton iteration.
+     *
+     * The Jacobian matrix and the residual have already been handed to the linear
+     * solver when this method is called. Newton methods which solve the linear system
+     * in a different way can overload this method.
+     *
+     * \param u The solution at which the system of equations was linearized
+     * \param b The residual of the solution
+     * \param x The solution of the linear system
+     */
+    bool solveLinear_(const SolutionVector& u OPM_UNUSED,
+                      const GlobalEqVector& b OPM_UNUSED,
+                      GlobalEqVector& x)
+    { return linearSolver_.solve(x); }
+
     /*!
      * \brief Linearize the global non-linear system of equations associated with the
      *        spatial domain.
@@ -650,31 +1379,10 @@ protected:
     void preSolve_(const SolutionVector& currentSolution  OPM_UNUSED,
                    const GlobalEqVector& currentResidual)
     {
-        const auto& constraintsMap = model().linearizer().constraintsMap();
         lastError_ = error_;
-        Scalar newtonMaxError = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError);
-
-        // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
-        error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
+        Scalar newtonMaxError = maxError_;
 
-            // also do not consider DOFs which are constraint
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
-                    continue;
-            }
-
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
-        }
-
-        // take the other processes into account
-        error_ = comm_.max(error_);
+        error_ = asImp_().residualError_(currentResidual);
 
         // make sure that the error never grows beyond the maximum
         // allowed one
@@ -684,6 +1392,36 @@ protected:
                                   +std::to_string(double(newtonMaxError)));
     }
 
+    /*!
+     * \brief Returns the error of a residual.
+     *
+     * For our purposes, the error is the maximum of the weighted residual of all
+     * degrees of freedom of the grid which are not constraint.
+     *
+     * \param residual The residual for which the error ought to be computed
+     */
+    Scalar residualError_(const GlobalEqVector& residual) const
+    {
+        const auto& constraintsMap = model().linearizer().constraintsMap();
+
+        // auxiliary DOFs are not considered for the error because they are located
+        // after the ones of the grid, and neither are DOFs which are constraint
+        Scalar error =
+            BlockVectorKernels::weightedMaxNorm(residual,
+                                                model().numGridDof(),
+                                                [this](unsigned dofIdx, unsigned eqIdx)
+                                                { return model().eqWeight(dofIdx, eqIdx); },
+                                                [&](unsigned dofIdx)
+                                                {
+                                                    return model().dofTotalVolume(dofIdx) <= 0.0
+                                                        || (enableConstraints_()
+                                                            && constraintsMap.count(dofIdx) > 0);
+                                                });
+
+        // take the other processes into account
+        return comm_.max(error);
+    }
+
     /*!
      * \brief Update the error of the solution given the previous
      *        iteration.
@@ -703,11 +1441,10 @@ protected:
         // loop over the auxiliary modules and ask them to post process the solution
         // vector.
         auto& model = simulator_.model();
-        const auto& comm = simulator_.gridView().comm();
-        for (unsigned i = 0; i < model.numAuxiliaryModules(); ++i) {
+        bool succeeded = true;
+        for (unsigned i = 0; i < model.numAuxiliaryModules() && succeeded; ++i) {
             auto& auxMod = *model.auxiliaryModule(i);
 
-            bool succeeded = true;
             try {
                 auxMod.postSolve(solutionUpdate);
             }
@@ -718,12 +1455,10 @@ protected:
                           << " caught an exception while post processing an auxiliary module:" << e.what()
                           << "\n"  << std::flush;
             }
-
-            succeeded = comm.min(succeeded);
-
-            if (!succeeded)
-                throw NumericalIssue("post processing of an auxilary equation failed");
         }
+
+        // whether this succeeded on all processes is checked by finishIterationChecks_()
+        postSolveFailedSlot_ = static_cast<int>(iterationChecks_.add(succeeded ? 0 : 1));
     }
 
     /*!
@@ -745,40 +1480,95 @@ protected:
                  const GlobalEqVector& solutionUpdate,
                  const GlobalEqVector& currentResidual)
     {
-        const auto& constraintsMap = model().linearizer().constraintsMap();
-
         // first, write out the current solution to make convergence
         // analysis possible
         asImp_().writeConvergence_(currentSolution, solutionUpdate);
 
         // make sure not to swallow non-finite values at this point
-        if (!std::isfinite(solutionUpdate.one_norm()))
+        if (!std::isfinite(BlockVectorKernels::oneNorm(solutionUpdate)))
             throw NumericalIssue("Non-finite update!");
 
+        asImp_().applyUpdate_(nextSolution, currentSolution, solutionUpdate, currentResidual);
+
+        if (lineSearch_ && asImp_().canEvaluateResidualOnly_())
+            asImp_().lineSearch_(nextSolution, currentSolution, solutionUpdate, currentResidual);
+    }
+
+    /*!
+     * \brief Compute the next solution by applying an update to the current one.
+     *
+     * \param nextSolution The solution vector at the end of the current iteration
+     * \param currentSolution The solution vector at the beginning of the current iteration
+     * \param solutionUpdate The delta which is subtracted from the current solution
+     * \param currentResidual The residual (i.e., right-hand-side) of the current
+     *                        iteration's solution.
+     */
+    void applyUpdate_(SolutionVector& nextSolution,
+                      const SolutionVector& currentSolution,
+                      const GlobalEqVector& solutionUpdate,
+                      const GlobalEqVector& currentResidual)
+    {
+        const auto& constraintsMap = model().linearizer().constraintsMap();
+
+        // the degrees of freedom are updated independently of each other, so they are
+        // statically partitioned amongst the threads. implementations which collect
+        // statistics in updatePrimaryVariables_() must thus do this per thread. the
+        // weighted change of the primary variables is determined in the same pass.
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::mutex updateErrorLock;
+        Scalar updateError = 0.0;
         size_t numGridDof = model().numGridDof();
-        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0) {
-                    const auto& constraints = constraintsMap.at(dofIdx);
-                    asImp_().updateConstraintDof_(dofIdx,
-                                                  nextSolution[dofIdx],
-                                                  constraints);
-                }
-                else
-                    asImp_().updatePrimaryVariables_(dofIdx,
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            size_t beginIdx, endIdx;
+            ThreadManager::threadRange(numGridDof, ThreadManager::threadId(), beginIdx, endIdx);
+            Scalar threadUpdateError = 0.0;
+            try {
+                for (size_t dofIdx = beginIdx; dofIdx < endIdx; ++dofIdx) {
+                    unsigned globalDofIdx = static_cast<unsigned>(dofIdx);
+                    if (enableConstraints_() && constraintsMap.count(globalDofIdx) > 0) {
+                        const auto& constraints = constraintsMap.at(globalDofIdx);
+                        asImp_().updateConstraintDof_(globalDofIdx,
+                                                      nextSolution[dofIdx],
+                                                      constraints);
+                        continue;
+                    }
+
+                    asImp_().updatePrimaryVariables_(globalDofIdx,
                                                      nextSolution[dofIdx],
                                                      currentSolution[dofIdx],
                                                      solutionUpdate[dofIdx],
                                                      currentResidual[dofIdx]);
+
+                    const auto& nextValue = nextSolution[dofIdx];
+                    const auto& currentValue = currentSolution[dofIdx];
+                    for (unsigned pvIdx = 0; pvIdx < nextValue.size(); ++pvIdx) {
+                        Scalar delta = std::abs(nextValue[pvIdx] - currentValue[pvIdx]);
+                        threadUpdateError =
+                            std::max(threadUpdateError,
+                                     delta*model().cachedPrimaryVarWeight(globalDofIdx, pvIdx));
+                    }
+                }
             }
-            else
-                asImp_().updatePrimaryVariables_(dofIdx,
-                                                 nextSolution[dofIdx],
-                                                 currentSolution[dofIdx],
-                                                 solutionUpdate[dofIdx],
-                                                 currentResidual[dofIdx]);
+            // exceptions must not leave the parallel block, so the one of the last
+            // failing thread is rethrown after all threads are done
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> guard(updateErrorLock);
+            updateError = std::max(updateError, threadUpdateError);
         }
 
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
+        updateError_ = updateError;
+
         // update the DOFs of the auxiliary equations
         size_t numDof = model().numTotalDof();
         for (size_t dofIdx = numGridDof; dofIdx < numDof; ++dofIdx) {
@@ -787,6 +1577,48 @@ protected:
         }
     }
 
+    /*!
+     * \brief Damp the update of the current iteration using a backtracking line search.
+     *
+     * The update is halved until the error of the next solution is sufficiently smaller
+     * than the one of the current solution (i.e., the Armijo condition holds). Only the
+     * residual is evaluated for the trial solutions, the system of equations is not
+     * linearized.
+     *
+     * \param nextSolution The solution vector at the end of the current iteration
+     * \param currentSolution The solution vector at the beginning of the current iteration
+     * \param solutionUpdate The undamped delta as calculated by the linear solver
+     * \param currentResidual The residual (i.e., right-hand-side) of the current
+     *                        iteration's solution.
+     */
+    void lineSearch_(SolutionVector& nextSolution,
+                     const SolutionVector& currentSolution,
+                     const GlobalEqVector& solutionUpdate,
+                     const GlobalEqVector& currentResidual)
+    {
+        const Scalar sufficientDecrease = 1e-4;
+        int maxIterations = lineSearchMaxIterations_;
+
+        GlobalEqVector trialResidual(currentResidual.size());
+        GlobalEqVector dampedUpdate(solutionUpdate);
+        Scalar lambda = 1.0;
+        for (int lsIter = 0; lsIter < maxIterations; ++lsIter) {
+            model().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+            model().linearizer().evaluateResidual(trialResidual);
+            Scalar trialError = asImp_().residualError_(trialResidual);
+            if (trialError <= (1.0 - sufficientDecrease*lambda)*error_)
+                break;
+
+            lambda /= 2;
+            BlockVectorKernels::copy(dampedUpdate, solutionUpdate);
+            BlockVectorKernels::scale(dampedUpdate, lambda);
+            asImp_().applyUpdate_(nextSolution, currentSolution, dampedUpdate, currentResidual);
+        }
+
+        if (lambda < 1.0)
+            endIterMsg() << ", line search step " << lambda;
+    }
+
     /*!
      * \brief Update the primary variables for a degree of freedom which is constraint.
      */
@@ -817,7 +1649,7 @@ protected:
     void writeConvergence_(const SolutionVector& currentSolution,
                            const GlobalEqVector& solutionUpdate)
     {
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence)) {
+        if (writeConvergenceFields_) {
             convergenceWriter_.beginIteration();
             convergenceWriter_.writeFields(currentSolution, solutionUpdate);
             convergenceWriter_.endIteration();
@@ -835,7 +1667,6 @@ protected:
     {
         ++numIterations_;
 
-        const auto& comm = simulator_.gridView().comm();
         bool succeeded = true;
         try {
             problem().endIteration();
@@ -848,16 +1679,10 @@ protected:
                       << "\n"  << std::flush;
         }
 
-        succeeded = comm.min(succeeded);
-
-        if (!succeeded)
-            throw NumericalIssue("post processing of the problem failed");
-
-        if (asImp_().verbose_()) {
-            std::cout << "Newton iteration " << numIterations_ << ""
-                      << " error: " << error_
-                      << endIterMsg().str() << "\n" << std::flush;
-        }
+        // whether this succeeded on all processes is checked by finishIterationChecks_(),
+        // which also prints the message about the iteration
+        endIterationFailedSlot_ = static_cast<int>(iterationChecks_.add(succeeded ? 0 : 1));
+        iterationEnded_ = true;
     }
 
     /*!
@@ -883,13 +1708,73 @@ protected:
         return true;
     }
 
+    /*!
+     * \brief Returns true if the errors of the previous iterations indicate that the
+     *        tolerance will not be reached within the maximum number of iterations.
+     *
+     * This is called after the error of the current iteration has been determined. The
+     * prediction is optimistic: The fastest linear and quadratic convergence rates of
+     * the last two iterations are assumed for all remaining ones. If the error was
+     * reduced by a factor of at least 4 in the last iteration, the Newton method may
+     * proceed beyond the maximum number of iterations, so it is never given up.
+     */
+    bool convergenceHopeless_() const
+    {
+        int numIter = asImp_().numIterations();
+        if (!predictConvergence_ || numIter < 2 || asImp_().converged())
+            return false;
+        if (!(lastError_ > 0.0) || !(secondLastError_ > 0.0) || error_ * 4.0 < lastError_)
+            return false;
+
+        Scalar rate = std::min(error_/lastError_, lastError_/secondLastError_);
+        Scalar quadraticRate = std::min(error_/(lastError_*lastError_),
+                                        lastError_/(secondLastError_*secondLastError_));
+        Scalar predictedError = error_;
+        for (int iterIdx = numIter; iterIdx < asImp_().maxIterations_(); ++iterIdx) {
+            predictedError = std::min(rate*predictedError,
+                                      quadraticRate*predictedError*predictedError);
+            if (predictedError <= tolerance())
+                return false;
+        }
+
+        return true;
+    }
+
+    /*!
+     * \brief Returns true if the solution of the update which was just applied is
+     *        expected to be below the tolerance.
+     *
+     * This requires that the errors of the last three iterations decreased
+     * quadratically with a consistent rate. The error of the updated solution is then
+     * predicted pessimistically using the larger of the last two rates, and it must be
+     * below a tenth of the tolerance.
+     */
+    bool convergenceExpected_() const
+    {
+        static constexpr Scalar safetyFactor = 0.1;
+
+        // the iteration counter was already incremented for the update
+        if (!predictConvergence_ || asImp_().numIterations() < 3)
+            return false;
+        if (!(error_ < lastError_) || !(lastError_ < secondLastError_) || !(error_ > 0.0))
+            return false;
+
+        Scalar quadraticRate = error_/(lastError_*lastError_);
+        Scalar lastQuadraticRate = lastError_/(secondLastError_*secondLastError_);
+        if (quadraticRate > 2*lastQuadraticRate)
+            return false;
+
+        Scalar predictedError = std::max(quadraticRate, lastQuadraticRate)*error_*error_;
+        return predictedError <= safetyFactor*tolerance();
+    }
+
     /*!
      * \brief Indicates that we're done solving the non-linear system
      *        of equations.
      */
     void end_()
     {
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
+        if (writeConvergenceFields_)
             convergenceWriter_.endTimeStep();
     }
 
@@ -911,10 +1796,10 @@ protected:
 
     // optimal number of iterations we want to achieve
     int targetIterations_() const
-    { return EWOMS_GET_PARAM(TypeTag, int, NewtonTargetIterations); }
+    { return numTargetIterations_; }
     // maximum number of iterations we do before giving up
     int maxIterations_() const
-    { return EWOMS_GET_PARAM(TypeTag, int, NewtonMaxIterations); }
+    { return numMaxIterations_; }
 
     static bool enableConstraints_()
     { return getPropValue<TypeTag, Properties::EnableConstraints>(); }
@@ -925,12 +1810,36 @@ protected:
     Timer linearizeTimer_;
     Timer solveTimer_;
     Timer updateTimer_;
+    Timer intensiveQuantitiesTimer_;
 
     std::ostringstream endIterMsgStream_;
 
     Scalar error_;
     Scalar lastError_;
+    Scalar secondLastError_;
+    Scalar updateError_;
     Scalar tolerance_;
+    bool jacobianFree_;
+    int jacobianRebuildInterval_;
+    int chordIterations_;
+    Scalar chordMaxErrorRatio_;
+    int numJacobianReuses_;
+    bool adaptiveLinearTolerance_;
+    Scalar minLinearTolerance_;
+    Scalar maxLinearTolerance_;
+    Scalar lastLinearTolerance_;
+    bool lineSearch_;
+    int lineSearchMaxIterations_;
+    int subdomainIterations_;
+    bool predictConvergence_;
+    bool convergencePredicted_;
+    int jacobianFreeMaxIterations_;
+    Scalar jacobianFreeTolerance_;
+    Scalar maxError_;
+    int numTargetIterations_;
+    int numMaxIterations_;
+    bool isVerbose_;
+    bool writeConvergenceFields_;
 
     // actual number of iterations done so far
     int numIterations_;
@@ -942,6 +1851,14 @@ protected:
     // or MPI)
     CollectiveCommunication comm_;
 
+    // the number of processes on which each of the checks of the current Newton
+    // iteration failed, and the indices of the checks (-1 if they were not done yet)
+    NonBlockingSum<int> iterationChecks_;
+    int postSolveFailedSlot_;
+    int endIterationFailedSlot_;
+    int beginIterationFailedSlot_;
+    bool iterationEnded_;
+
     // the object which writes the convergence behaviour of the Newton
     // method to disk
     ConvergenceWriter convergenceWriter_;
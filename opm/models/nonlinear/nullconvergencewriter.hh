@@ -57,6 +57,12 @@ public:
     NullConvergenceWriter(NewtonMethod& method  OPM_UNUSED)
     {}
 
+    /*!
+     * \brief Register all run-time parameters of the convergence writer.
+     */
+    static void registerParameters()
+    {}
+
     /*!
      * \brief Called by the Newton method before the actual algorithm
      *        is started for any given timestep.
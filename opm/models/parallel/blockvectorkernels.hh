@@ -0,0 +1,347 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BlockVectorKernels
+ */
+#ifndef EWOMS_BLOCK_VECTOR_KERNELS_HH
+#define EWOMS_BLOCK_VECTOR_KERNELS_HH
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <opm/models/parallel/threadphases.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Threaded kernels for the arithmetic on the global block vectors, i.e., on
+ *        the solution and residual vectors.
+ *
+ * The blocks of a vector are partitioned amongst the threads in the same way as by
+ * ThreadManager::threadRange(), so the kernels always access the memory which was
+ * first touched by the current thread in the other loops over all degrees of freedom.
+ * If the blocks of a vector only consist of their entries (i.e., they are plain
+ * Dune::FieldVectors), the kernels operate on the contiguous array of entries to make
+ * them vectorizable. Otherwise, for example for primary variables which also store
+ * their meaning, only the entries of the blocks are accessed.
+ *
+ * Reductions only consider the local process.
+ */
+class BlockVectorKernels
+{
+public:
+    /*!
+     * \brief Set all entries of a vector to a value.
+     */
+    template <class Vector>
+    static void fill(Vector& v, typename Vector::field_type value)
+    {
+        forEachRange_(v.size(), [&](size_t beginIdx, size_t endIdx) {
+            if constexpr (isFlat_<Vector>()) {
+                auto* vv = entries_(v, beginIdx);
+                size_t n = (endIdx - beginIdx)*blockSize_<Vector>();
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+                for (size_t i = 0; i < n; ++i)
+                    vv[i] = value;
+            }
+            else {
+                for (size_t blockIdx = beginIdx; blockIdx < endIdx; ++blockIdx)
+                    for (size_t i = 0; i < blockSize_<Vector>(); ++i)
+                        v[blockIdx][i] = value;
+            }
+        });
+    }
+
+    /*!
+     * \brief Copy the blocks of a vector to another one of the same size.
+     *
+     * In contrast to fill() and friends, the blocks are assigned, i.e., any additional
+     * data which they store is copied as well.
+     */
+    template <class Vector>
+    static void copy(Vector& dst, const Vector& src)
+    {
+        assert(dst.size() == src.size());
+        forEachRange_(src.size(), [&](size_t beginIdx, size_t endIdx) {
+            for (size_t blockIdx = beginIdx; blockIdx < endIdx; ++blockIdx)
+                dst[blockIdx] = src[blockIdx];
+        });
+    }
+
+    /*!
+     * \brief Multiply all entries of a vector by a scalar.
+     */
+    template <class Vector>
+    static void scale(Vector& v, typename Vector::field_type alpha)
+    {
+        forEachRange_(v.size(), [&](size_t beginIdx, size_t endIdx) {
+            if constexpr (isFlat_<Vector>()) {
+                auto* vv = entries_(v, beginIdx);
+                size_t n = (endIdx - beginIdx)*blockSize_<Vector>();
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+                for (size_t i = 0; i < n; ++i)
+                    vv[i] *= alpha;
+            }
+            else {
+                for (size_t blockIdx = beginIdx; blockIdx < endIdx; ++blockIdx)
+                    for (size_t i = 0; i < blockSize_<Vector>(); ++i)
+                        v[blockIdx][i] *= alpha;
+            }
+        });
+    }
+
+    /*!
+     * \brief Add a multiple of a vector to another one, i.e., y += alpha*x.
+     *
+     * The blocks of both vectors must have the same number of entries, but the
+     * vectors may be of different types, e.g. a solution and a residual vector.
+     */
+    template <class VectorY, class VectorX>
+    static void axpy(VectorY& y, typename VectorY::field_type alpha, const VectorX& x)
+    {
+        static_assert(blockSize_<VectorY>() == blockSize_<VectorX>(),
+                      "The blocks of both vectors must be of the same size");
+        assert(y.size() == x.size());
+        forEachRange_(y.size(), [&](size_t beginIdx, size_t endIdx) {
+            if constexpr (isFlat_<VectorY>() && isFlat_<VectorX>()) {
+                auto* yy = entries_(y, beginIdx);
+                const auto* xx = entries_(x, beginIdx);
+                size_t n = (endIdx - beginIdx)*blockSize_<VectorY>();
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+                for (size_t i = 0; i < n; ++i)
+                    yy[i] += alpha*xx[i];
+            }
+            else {
+                for (size_t blockIdx = beginIdx; blockIdx < endIdx; ++blockIdx)
+                    for (size_t i = 0; i < blockSize_<VectorY>(); ++i)
+                        y[blockIdx][i] += alpha*x[blockIdx][i];
+            }
+        });
+    }
+
+    /*!
+     * \brief Returns the scalar product of two vectors.
+     */
+    template <class Vector>
+    static typename Vector::field_type dot(const Vector& x, const Vector& y)
+    {
+        using Scalar = typename Vector::field_type;
+
+        assert(x.size() == y.size());
+        return reduce_<Scalar>(x.size(), /*identity=*/0.0,
+                               [&](size_t beginIdx, size_t endIdx) {
+            Scalar result = 0.0;
+            if constexpr (isFlat_<Vector>()) {
+                const auto* xx = entries_(x, beginIdx);
+                const auto* yy = entries_(y, beginIdx);
+                size_t n = (endIdx - beginIdx)*blockSize_<Vector>();
+#ifdef _OPENMP
+#pragma omp simd reduction(+:result)
+#endif
+                for (size_t i = 0; i < n; ++i)
+                    result += xx[i]*yy[i];
+            }
+            else {
+                for (size_t blockIdx = beginIdx; blockIdx < endIdx; ++blockIdx)
+                    for (size_t i = 0; i < blockSize_<Vector>(); ++i)
+                        result += x[blockIdx][i]*y[blockIdx][i];
+            }
+            return result;
+        },
+        [](Scalar a, Scalar b) { return a + b; });
+    }
+
+    /*!
+     * \brief Returns the sum of the absolute values of all entries of a vector.
+     */
+    template <class Vector>
+    static typename Vector::field_type oneNorm(const Vector& v)
+    {
+        using Scalar = typename Vector::field_type;
+
+        return reduce_<Scalar>(v.size(), /*identity=*/0.0,
+                               [&](size_t beginIdx, size_t endIdx) {
+            Scalar result = 0.0;
+            if constexpr (isFlat_<Vector>()) {
+                const auto* vv = entries_(v, beginIdx);
+                size_t n = (endIdx - beginIdx)*blockSize_<Vector>();
+#ifdef _OPENMP
+#pragma omp simd reduction(+:result)
+#endif
+                for (size_t i = 0; i < n; ++i)
+                    result += std::abs(vv[i]);
+            }
+            else {
+                for (size_t blockIdx = beginIdx; blockIdx < endIdx; ++blockIdx)
+                    for (size_t i = 0; i < blockSize_<Vector>(); ++i)
+                        result += std::abs(v[blockIdx][i]);
+            }
+            return result;
+        },
+        [](Scalar a, Scalar b) { return a + b; });
+    }
+
+    /*!
+     * \brief Returns the maximum of the weighted absolute values of the entries of the
+     *        first blocks of a vector.
+     *
+     * The weight of an entry is given by weight(blockIdx, entryIdx). Blocks for which
+     * skipBlock(blockIdx) returns true are not considered.
+     *
+     * \param v The vector for which the norm ought to be computed
+     * \param numBlocks The number of blocks at the beginning of the vector which are
+     *                  considered
+     * \param weight The weight of an entry
+     * \param skipBlock Returns true for blocks which ought to be ignored
+     */
+    template <class Vector, class Weight, class SkipBlock>
+    static typename Vector::field_type weightedMaxNorm(const Vector& v,
+                                                       size_t numBlocks,
+                                                       const Weight& weight,
+                                                       const SkipBlock& skipBlock)
+    {
+        using Scalar = typename Vector::field_type;
+
+        assert(numBlocks <= v.size());
+        return reduce_<Scalar>(numBlocks, /*identity=*/0.0,
+                               [&](size_t beginIdx, size_t endIdx) {
+            Scalar result = 0.0;
+            for (size_t blockIdx = beginIdx; blockIdx < endIdx; ++blockIdx) {
+                unsigned globalIdx = static_cast<unsigned>(blockIdx);
+                if (skipBlock(globalIdx))
+                    continue;
+
+                for (unsigned i = 0; i < blockSize_<Vector>(); ++i)
+                    result = std::max(result, std::abs(v[blockIdx][i]*weight(globalIdx, i)));
+            }
+            return result;
+        },
+        [](Scalar a, Scalar b) { return std::max(a, b); });
+    }
+
+private:
+    template <class Vector>
+    static constexpr size_t blockSize_()
+    { return static_cast<size_t>(Vector::block_type::dimension); }
+
+    // returns true if the entries of all blocks of a vector form a contiguous array
+    template <class Vector>
+    static constexpr bool isFlat_()
+    {
+        using Block = typename Vector::block_type;
+        using Field = typename Vector::field_type;
+        return sizeof(Block) == blockSize_<Vector>()*sizeof(Field);
+    }
+
+    template <class Vector>
+    static auto* entries_(Vector& v, size_t blockIdx)
+    { return &v[blockIdx][0]; }
+
+    // the range of blocks of the current thread, see ThreadManager::threadRange()
+    static void threadRange_(size_t n, size_t& beginIdx, size_t& endIdx)
+    {
+#ifdef _OPENMP
+        size_t numThreads = static_cast<size_t>(omp_get_num_threads());
+        size_t threadIdx = static_cast<size_t>(omp_get_thread_num());
+        beginIdx = n*threadIdx/numThreads;
+        endIdx = n*(threadIdx + 1)/numThreads;
+#else
+        beginIdx = 0;
+        endIdx = n;
+#endif
+    }
+
+    // the kernels are memory bound, so they may saturate the memory bandwidth with
+    // fewer threads than the process has, see ThreadPhases
+    static unsigned phaseIdx_()
+    {
+        static const unsigned phaseIdx = ThreadPhases::phaseIndex("vector kernels", false);
+        return phaseIdx;
+    }
+
+    template <class Functor>
+    static void forEachRange_(size_t n, const Functor& f)
+    {
+        ThreadPhases::Scope phase(phaseIdx_(), n);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(phase.numThreads())
+#endif
+        {
+            size_t beginIdx, endIdx;
+            threadRange_(n, beginIdx, endIdx);
+            if (beginIdx < endIdx)
+                f(beginIdx, endIdx);
+        }
+    }
+
+    // the partial results of the threads are combined in a fixed order to make the
+    // result independent of the scheduling of the threads
+    template <class Result, class Functor, class Combine>
+    static Result reduce_(size_t n, Result identity, const Functor& f, const Combine& combine)
+    {
+#ifdef _OPENMP
+        std::vector<Result> threadResults(static_cast<size_t>(omp_get_max_threads()), identity);
+#else
+        std::vector<Result> threadResults(1, identity);
+#endif
+
+        ThreadPhases::Scope phase(phaseIdx_(), n);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(phase.numThreads())
+#endif
+        {
+            size_t beginIdx, endIdx;
+            threadRange_(n, beginIdx, endIdx);
+            if (beginIdx < endIdx) {
+#ifdef _OPENMP
+                threadResults[static_cast<size_t>(omp_get_thread_num())] = f(beginIdx, endIdx);
+#else
+                threadResults[0] = f(beginIdx, endIdx);
+#endif
+            }
+        }
+
+        Result result = identity;
+        for (const auto& threadResult : threadResults)
+            result = combine(result, threadResult);
+        return result;
+    }
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,333 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ChunkedEntityIterator
+ */
+#ifndef EWOMS_CHUNKED_ENTITY_ITERATOR_HH
+#define EWOMS_CHUNKED_ENTITY_ITERATOR_HH
+
+#include <opm/models/utils/hilbertcurve.hh>
+
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Stores the seeds of all entities of a given codimension of a GridView.
+ *
+ * In contrast to grid iterators, the entities can be accessed by their index in the
+ * list, which allows to partition the grid into chunks for multi-threaded loops. The
+ * list must be updated whenever the grid changes.
+ *
+ * Besides the seeds, the list stores the index of each entity for the
+ * Dune::MultipleCodimMultipleGeomTypeMapper of the codimension and its partition type.
+ * Loops which only need these do not have to create the entities, which is expensive
+ * for grids like ALUGrid or UGGrid.
+ */
+template <class GridView, int codim>
+class EntitySeedList
+{
+    using Entity = typename GridView::template Codim<codim>::Entity;
+    using EntitySeed = typename Entity::EntitySeed;
+
+public:
+    EntitySeedList(const GridView& gridView)
+        : gridView_(gridView)
+    { update(gridView); }
+
+    /*!
+     * \brief Re-create the list of entity seeds, e.g. after the grid was changed.
+     */
+    void update(const GridView& gridView)
+    {
+        gridView_ = gridView;
+
+        Dune::MultipleCodimMultipleGeomTypeMapper<GridView>
+            mapper(gridView_, Dune::mcmgLayout(Dune::Codim<codim>()));
+
+        size_t numEntities = static_cast<size_t>(gridView_.size(codim));
+        seeds_.clear();
+        seeds_.reserve(numEntities);
+        indices_.clear();
+        indices_.reserve(numEntities);
+        partitionTypes_.clear();
+        partitionTypes_.reserve(numEntities);
+        auto it = gridView_.template begin<codim>();
+        const auto& endIt = gridView_.template end<codim>();
+        for (; it != endIt; ++it) {
+            seeds_.push_back(it->seed());
+            indices_.push_back(static_cast<unsigned>(mapper.index(*it)));
+            partitionTypes_.push_back(it->partitionType());
+        }
+    }
+
+    /*!
+     * \brief Sort the entities along the Hilbert space-filling curve through the
+     *        centers of their bounding boxes.
+     *
+     * This makes entities which are adjacent in the list also close to each other in
+     * space, which improves the locality of the data accessed by loops over the list if
+     * the grid does not already provide such an order.
+     */
+    void sortByHilbertCurve()
+    {
+        static constexpr unsigned dimWorld = GridView::dimensionworld;
+        using CoordScalar = typename GridView::ctype;
+        using Coords = std::array<CoordScalar, dimWorld>;
+
+        size_t numEntities = seeds_.size();
+        if (numEntities < 2)
+            return;
+
+        // compute the centers of the entities and the bounding box of the grid
+        std::vector<Coords> centers(numEntities);
+        Coords minCoords, maxCoords;
+        minCoords.fill(std::numeric_limits<CoordScalar>::max());
+        maxCoords.fill(std::numeric_limits<CoordScalar>::lowest());
+        for (size_t idx = 0; idx < numEntities; ++idx) {
+            const auto& center = entity(idx).geometry().center();
+            for (unsigned i = 0; i < dimWorld; ++i) {
+                centers[idx][i] = center[i];
+                minCoords[i] = std::min(minCoords[i], centers[idx][i]);
+                maxCoords[i] = std::max(maxCoords[i], centers[idx][i]);
+            }
+        }
+
+        // map the centers to the points of an integer lattice and sort them by their
+        // position on the curve
+        static constexpr unsigned numBits = std::min(32u, 64u/dimWorld);
+        const CoordScalar maxLatticeCoord = static_cast<CoordScalar>((std::uint64_t(1) << numBits) - 1);
+        std::vector<std::uint64_t> keys(numEntities);
+        for (size_t idx = 0; idx < numEntities; ++idx) {
+            std::array<std::uint32_t, dimWorld> latticeCoords;
+            for (unsigned i = 0; i < dimWorld; ++i) {
+                CoordScalar extent = maxCoords[i] - minCoords[i];
+                CoordScalar relCoord = extent > 0 ? (centers[idx][i] - minCoords[i])/extent : 0;
+                latticeCoords[i] = static_cast<std::uint32_t>(relCoord*maxLatticeCoord);
+            }
+            keys[idx] = hilbertIndex<dimWorld>(latticeCoords, numBits);
+        }
+
+        std::vector<size_t> order(numEntities);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+        std::vector<EntitySeed> sortedSeeds;
+        std::vector<unsigned> sortedIndices;
+        std::vector<Dune::PartitionType> sortedPartitionTypes;
+        sortedSeeds.reserve(numEntities);
+        sortedIndices.reserve(numEntities);
+        sortedPartitionTypes.reserve(numEntities);
+        for (size_t idx : order) {
+            sortedSeeds.push_back(seeds_[idx]);
+            sortedIndices.push_back(indices_[idx]);
+            sortedPartitionTypes.push_back(partitionTypes_[idx]);
+        }
+        seeds_.swap(sortedSeeds);
+        indices_.swap(sortedIndices);
+        partitionTypes_.swap(sortedPartitionTypes);
+    }
+
+    /*!
+     * \brief Returns the number of entities in the list.
+     */
+    size_t size() const
+    { return seeds_.size(); }
+
+    /*!
+     * \brief Returns the seed of the entity with a given index in the list.
+     */
+    const EntitySeed& seed(size_t idx) const
+    { return seeds_[idx]; }
+
+    /*!
+     * \brief Returns the entity with a given index in the list.
+     */
+    Entity entity(size_t idx) const
+    { return gridView_.grid().entity(seeds_[idx]); }
+
+    /*!
+     * \brief Returns the mapper index of the entity with a given index in the list.
+     */
+    unsigned index(size_t idx) const
+    { return indices_[idx]; }
+
+    /*!
+     * \brief Returns the partition type of the entity with a given index in the list.
+     */
+    Dune::PartitionType partitionType(size_t idx) const
+    { return partitionTypes_[idx]; }
+
+    /*!
+     * \brief Returns true if the entity with a given index in the list is in the
+     *        interior of the process' grid partition.
+     */
+    bool isInterior(size_t idx) const
+    { return partitionTypes_[idx] == Dune::InteriorEntity; }
+
+private:
+    GridView gridView_;
+    std::vector<EntitySeed> seeds_;
+    std::vector<unsigned> indices_;
+    std::vector<Dune::PartitionType> partitionTypes_;
+};
+
+/*!
+ * \brief Distributes the entities of an EntitySeedList amongst the threads of an
+ *        OpenMP parallel region in chunks of consecutive entities.
+ *
+ * In contrast to ThreadedEntityIterator, no lock needs to be taken: A thread grabs the
+ * next chunk by an atomic increment of a counter, i.e., there is only one atomic
+ * operation per chunk instead of one locked section per entity.
+ *
+ * Usage:
+ *
+ * \code
+ * ChunkedEntityIterator<GridView, 0> chunkedElemIt(seedList, chunkSize);
+ * #pragma omp parallel
+ * {
+ *     size_t beginIdx, endIdx;
+ *     while (chunkedElemIt.nextChunk(beginIdx, endIdx))
+ *         for (size_t idx = beginIdx; idx < endIdx; ++idx)
+ *             doSomething(seedList.entity(idx));
+ * }
+ * \endcode
+ *
+ * Alternatively, the entities can be partitioned statically: Each thread then works on
+ * the chunks of the contiguous range which is assigned to it by
+ * ThreadManager::threadRange(). This sacrifices the dynamic load balancing, but a given
+ * entity is always processed by the same thread.
+ *
+ * ATTENTION: This class must be instantiated in a sequential context!
+ */
+template <class GridView, int codim>
+class ChunkedEntityIterator
+{
+public:
+    using SeedList = EntitySeedList<GridView, codim>;
+
+    ChunkedEntityIterator(const SeedList& seedList, size_t chunkSize, bool staticPartition = false)
+        : seedList_(seedList)
+        , chunkSize_(std::max<size_t>(chunkSize, 1))
+        , nextIdx_(0)
+    {
+        if (staticPartition) {
+#ifdef _OPENMP
+            threadNextIdx_.resize(static_cast<size_t>(omp_get_max_threads()));
+#else
+            threadNextIdx_.resize(1);
+#endif
+        }
+    }
+
+    ChunkedEntityIterator(const ChunkedEntityIterator&) = delete;
+
+    /*!
+     * \brief Returns the list of entity seeds over which is iterated.
+     */
+    const SeedList& seedList() const
+    { return seedList_; }
+
+    /*!
+     * \brief Retrieve the next chunk of entity indices which are not yet worked on by
+     *        any thread.
+     *
+     * The range of the chunk is [beginIdx, endIdx). If all entities have already been
+     * handed out, false is returned.
+     */
+    bool nextChunk(size_t& beginIdx, size_t& endIdx)
+    {
+        if (!threadNextIdx_.empty())
+            return nextStaticChunk_(beginIdx, endIdx);
+
+        size_t numEntities = seedList_.size();
+        beginIdx = nextIdx_.fetch_add(chunkSize_, std::memory_order_relaxed);
+        if (beginIdx >= numEntities)
+            return false;
+
+        endIdx = std::min(beginIdx + chunkSize_, numEntities);
+        return true;
+    }
+
+    /*!
+     * \brief Make sure that no further chunks are handed out.
+     */
+    void setFinished()
+    { nextIdx_.store(seedList_.size(), std::memory_order_relaxed); }
+
+private:
+    // the next entity of a thread, padded to a cache line to avoid false sharing
+    struct alignas(64) ThreadIndex
+    { size_t value = std::numeric_limits<size_t>::max(); };
+
+    bool nextStaticChunk_(size_t& beginIdx, size_t& endIdx)
+    {
+        size_t numEntities = seedList_.size();
+        if (nextIdx_.load(std::memory_order_relaxed) >= numEntities)
+            return false; // setFinished() was called
+
+#ifdef _OPENMP
+        size_t threadIdx = static_cast<size_t>(omp_get_thread_num());
+        size_t numThreads = static_cast<size_t>(omp_get_num_threads());
+#else
+        size_t threadIdx = 0;
+        size_t numThreads = 1;
+#endif
+        size_t& threadNextIdx = threadNextIdx_[threadIdx].value;
+        if (threadNextIdx == std::numeric_limits<size_t>::max())
+            threadNextIdx = numEntities*threadIdx/numThreads;
+
+        size_t threadEndIdx = numEntities*(threadIdx + 1)/numThreads;
+        if (threadNextIdx >= threadEndIdx)
+            return false;
+
+        beginIdx = threadNextIdx;
+        endIdx = std::min(beginIdx + chunkSize_, threadEndIdx);
+        threadNextIdx = endIdx;
+        return true;
+    }
+
+    const SeedList& seedList_;
+    size_t chunkSize_;
+    std::atomic<size_t> nextIdx_;
+    std::vector<ThreadIndex> threadNextIdx_;
+};
+
+} // namespace Opm
+
+#endif
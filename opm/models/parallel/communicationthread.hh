@@ -0,0 +1,153 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::CommunicationThread
+ */
+#ifndef EWOMS_COMMUNICATION_THREAD_HH
+#define EWOMS_COMMUNICATION_THREAD_HH
+
+#include <opm/models/parallel/tasklets.hh>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <memory>
+#include <mutex>
+
+namespace Opm {
+
+/*!
+ * \brief A thread of the process which is dedicated to drive the communication with
+ *        the peer processes.
+ *
+ * Many MPI implementations only make progress on non-blocking operations while the
+ * process is inside of an MPI call. If the communication is interleaved with
+ * computations, the messages are thus often only transferred once the computation is
+ * finished and the request is waited for. To really hide the latency, the code which
+ * exchanges data with the peers can be dispatched to this thread instead, which then
+ * blocks inside MPI while the remaining threads compute.
+ *
+ * The thread only exists if it was started explicitly. Since the MPI calls are not
+ * made by the main thread anymore, this requires that MPI has been initialized with
+ * support for at least MPI_THREAD_SERIALIZED; the users of the communication thread
+ * must make sure that the main thread does not call MPI while communication work is
+ * outstanding.
+ */
+class CommunicationThread
+{
+public:
+    /*!
+     * \brief The level of thread support which MPI must provide.
+     */
+#if HAVE_MPI
+    static constexpr int requiredMpiThreadLevel = MPI_THREAD_SERIALIZED;
+#endif
+
+    /*!
+     * \brief Returns true if the MPI library supports the communication thread.
+     */
+    static bool mpiSupportsThread()
+    {
+#if HAVE_MPI
+        int isInitialized = 0;
+        MPI_Initialized(&isInitialized);
+        if (!isInitialized)
+            return false;
+
+        int provided;
+        MPI_Query_thread(&provided);
+        return provided >= requiredMpiThreadLevel;
+#else
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Create the communication thread.
+     *
+     * If it already exists, this is a no-op.
+     */
+    static void start()
+    {
+        std::lock_guard<std::mutex> guard(state_().mutex);
+        if (!state_().runner)
+            state_().runner.reset(new TaskletRunner(/*numWorkers=*/1));
+    }
+
+    /*!
+     * \brief Complete all outstanding work and terminate the communication thread.
+     */
+    static void stop()
+    {
+        std::lock_guard<std::mutex> guard(state_().mutex);
+        state_().runner.reset();
+    }
+
+    /*!
+     * \brief Returns true if the communication thread exists.
+     */
+    static bool enabled()
+    { return state_().runner != nullptr; }
+
+    /*!
+     * \brief Run a function in the communication thread.
+     *
+     * The returned tasklet can be used to wait until the function has been completed.
+     * If the communication thread does not exist, it is run immediately by the calling
+     * thread.
+     */
+    template <class Fn>
+    static std::shared_ptr<FunctionRunnerTasklet<Fn> > dispatch(Fn& fn)
+    {
+        auto& runner = state_().runner;
+        if (!runner) {
+            TaskletRunner synchronousRunner(/*numWorkers=*/0);
+            return synchronousRunner.dispatchFunction(fn);
+        }
+
+        // the progress of the communication is latency-critical
+        auto tasklet = std::make_shared<FunctionRunnerTasklet<Fn> >(/*numInvocations=*/1, fn);
+        tasklet->setPriority(TaskletInterface::Priority::High);
+        runner->dispatch(tasklet);
+        return tasklet;
+    }
+
+private:
+    struct State
+    {
+        std::mutex mutex;
+        std::unique_ptr<TaskletRunner> runner;
+    };
+
+    static State& state_()
+    {
+        static State state;
+        return state;
+    }
+};
+
+} // namespace Opm
+
+#endif
@@ -32,8 +32,13 @@
 #include <opm/material/common/Unused.hpp>
 
 #include <dune/grid/common/datahandleif.hh>
+#include <dune/common/densevector.hh>
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 namespace Opm {
 
 /*!
@@ -151,6 +156,79 @@ private:
     Container& container_;
 };
 
+/*!
+ * \brief Data handle for parallel communication which sets the values of ghost and
+ *        overlap DOFs from their respective master processes, but only transfers the
+ *        values which changed since the last synchronization.
+ *
+ * The handle requires the values of all DOFs at the end of the last synchronization.
+ * For each DOF, the master process compares the current value to it and only sends
+ * the DOF if the two differ. The receiving process restores the value of the last
+ * synchronization for the DOFs which it does not receive. This is required because
+ * the values of the ghost DOFs are also modified locally, e.g., by the Newton update.
+ * After the communication, the values of the last synchronization must be set to the
+ * current values on all processes.
+ */
+template <class FieldType, class Container, class EntityMapper, unsigned commCodim>
+class GridCommHandleChangedGhostSync
+    : public Dune::CommDataHandleIF<GridCommHandleChangedGhostSync<FieldType, Container,
+                                                                   EntityMapper, commCodim>,
+                                    FieldType>
+{
+public:
+    GridCommHandleChangedGhostSync(Container& container,
+                                   const Container& lastSynced,
+                                   const EntityMapper& mapper)
+        : mapper_(mapper), container_(container), lastSynced_(lastSynced)
+    {
+    }
+
+    bool contains(int dim OPM_UNUSED, int codim) const
+    {
+        // return true if the codim is the same as the codim which we
+        // are asked to communicate with.
+        return codim == commCodim;
+    }
+
+    bool fixedsize(int dim OPM_UNUSED, int codim OPM_UNUSED) const
+    {
+        // unchanged DOFs are not communicated at all
+        return false;
+    }
+
+    template <class EntityType>
+    size_t size(const EntityType& e) const
+    {
+        // the values are compared bitwise, so that any additional state of the field
+        // type is also considered
+        unsigned dofIdx = static_cast<unsigned>(mapper_.index(e));
+        return std::memcmp(&container_[dofIdx], &lastSynced_[dofIdx], sizeof(FieldType)) != 0;
+    }
+
+    template <class MessageBufferImp, class EntityType>
+    void gather(MessageBufferImp& buff, const EntityType& e) const
+    {
+        unsigned dofIdx = static_cast<unsigned>(mapper_.index(e));
+        if (size(e) > 0)
+            buff.write(container_[dofIdx]);
+    }
+
+    template <class MessageBufferImp, class EntityType>
+    void scatter(MessageBufferImp& buff, const EntityType& e, size_t n)
+    {
+        unsigned dofIdx = static_cast<unsigned>(mapper_.index(e));
+        if (n > 0)
+            buff.read(container_[dofIdx]);
+        else
+            container_[dofIdx] = lastSynced_[dofIdx];
+    }
+
+private:
+    const EntityMapper& mapper_;
+    Container& container_;
+    const Container& lastSynced_;
+};
+
 /*!
  * \brief Data handle for parallel communication which takes the
  *        maximum of all values that are attached to DOFs
@@ -265,6 +343,150 @@ private:
     Container& container_;
 };
 
+/*!
+ * \brief Data handle for parallel communication which exchanges the values of several
+ *        containers in a single communication round.
+ *
+ * The containers are registered using addField(), each with the operation which is
+ * used to combine the received values with the local ones. The entries of a container
+ * are either scalars or dense vectors of scalars; all entries of a container must be of
+ * the same size. The values of all registered containers which are attached to an
+ * entity are packed into a single message, so the number of messages does not depend
+ * on the number of fields.
+ *
+ * The handle only stores references to the registered containers, i.e., they must not
+ * be resized or destroyed before the communication is finished.
+ */
+template <class Scalar, class EntityMapper, int commCodim>
+class GridCommHandleMultiField
+    : public Dune::CommDataHandleIF<GridCommHandleMultiField<Scalar, EntityMapper, commCodim>,
+                                    Scalar>
+{
+public:
+    enum class Operation {
+        Sum, //!< add the values of the peer processes to the local ones
+        Max, //!< take the maximum of the local value and the ones of the peer processes
+        Min, //!< take the minimum of the local value and the ones of the peer processes
+        Copy //!< overwrite the local value, e.g. to synchronize ghost DOFs
+    };
+
+    GridCommHandleMultiField(const EntityMapper& mapper)
+        : mapper_(mapper), numScalars_(0)
+    {}
+
+    /*!
+     * \brief Register a container whose values are communicated.
+     *
+     * \param container The container which is indexed by the DOFs
+     * \param op The operation which combines the received values with the local ones
+     */
+    template <class Container>
+    void addField(Container& container, Operation op)
+    {
+        Field field;
+        field.container = &container;
+        field.width = (container.size() == 0) ? 0 : entrySize_(container[0]);
+        field.op = op;
+        field.entry = [](void* c, unsigned dofIdx) -> Scalar*
+            { return entryData_((*static_cast<Container*>(c))[dofIdx]); };
+
+        fields_.push_back(field);
+        numScalars_ += field.width;
+    }
+
+    /*!
+     * \brief Returns the number of registered containers.
+     */
+    size_t numFields() const
+    { return fields_.size(); }
+
+    bool contains(int dim OPM_UNUSED, int codim) const
+    {
+        // return true if the codim is the same as the codim which we
+        // are asked to communicate with.
+        return codim == commCodim;
+    }
+
+    bool fixedsize(int dim OPM_UNUSED, int codim OPM_UNUSED) const
+    {
+        // all entries of a container are of the same size
+        return true;
+    }
+
+    template <class EntityType>
+    size_t size(const EntityType& e OPM_UNUSED) const
+    {
+        // communicate the scalars of all fields per entity
+        return numScalars_;
+    }
+
+    template <class MessageBufferImp, class EntityType>
+    void gather(MessageBufferImp& buff, const EntityType& e) const
+    {
+        unsigned dofIdx = static_cast<unsigned>(mapper_.index(e));
+        for (const auto& field : fields_) {
+            const Scalar* values = field.entry(field.container, dofIdx);
+            for (unsigned i = 0; i < field.width; ++i)
+                buff.write(values[i]);
+        }
+    }
+
+    template <class MessageBufferImp, class EntityType>
+    void scatter(MessageBufferImp& buff, const EntityType& e, size_t n OPM_UNUSED)
+    {
+        unsigned dofIdx = static_cast<unsigned>(mapper_.index(e));
+        for (const auto& field : fields_) {
+            Scalar* values = field.entry(field.container, dofIdx);
+            for (unsigned i = 0; i < field.width; ++i) {
+                Scalar tmp;
+                buff.read(tmp);
+                switch (field.op) {
+                case Operation::Sum:
+                    values[i] += tmp;
+                    break;
+                case Operation::Max:
+                    values[i] = std::max(values[i], tmp);
+                    break;
+                case Operation::Min:
+                    values[i] = std::min(values[i], tmp);
+                    break;
+                case Operation::Copy:
+                    values[i] = tmp;
+                    break;
+                }
+            }
+        }
+    }
+
+private:
+    struct Field
+    {
+        void* container;
+        unsigned width;
+        Operation op;
+        // returns a pointer to the scalars of the entry of a DOF
+        Scalar* (*entry)(void*, unsigned);
+    };
+
+    static unsigned entrySize_(const Scalar& value OPM_UNUSED)
+    { return 1; }
+
+    template <class Vector>
+    static unsigned entrySize_(const Dune::DenseVector<Vector>& value)
+    { return static_cast<unsigned>(value.size()); }
+
+    static Scalar* entryData_(Scalar& value)
+    { return &value; }
+
+    template <class Vector>
+    static Scalar* entryData_(Dune::DenseVector<Vector>& value)
+    { return &value[0]; }
+
+    const EntityMapper& mapper_;
+    std::vector<Field> fields_;
+    size_t numScalars_;
+};
+
 } // namespace Opm
 
 #endif
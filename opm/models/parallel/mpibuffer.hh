@@ -35,11 +35,116 @@
 
 #include <type_traits>
 #include <cassert>
+#include <vector>
 
 namespace Opm {
 
+/*!
+ * \brief An MPI data type which selects a set of objects in memory.
+ *
+ * This allows to communicate the entries of a vector or a matrix in place, i.e.,
+ * without packing them into a contiguous buffer first. The data type stores the
+ * positions of the objects relative to a base address, so it only needs to be created
+ * once per communication pattern. If the positions are specified by indices, it can be
+ * used for any array which exhibits the same pattern.
+ */
+template <class DataType>
+class MpiIndexedType
+{
+public:
+    /*!
+     * \brief Select the objects of an array which have the given indices.
+     */
+    template <class IndexType>
+    MpiIndexedType(const std::vector<IndexType>& indices)
+        : size_(indices.size())
+    {
+#if HAVE_MPI
+        std::vector<MPI_Aint> displacements(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+            displacements[i] = static_cast<MPI_Aint>(indices[i])*static_cast<MPI_Aint>(sizeof(DataType));
+        create_(displacements);
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Select arbitrary objects which are located relative to a base object.
+     *
+     * The objects do not need to be part of the same array.
+     */
+    MpiIndexedType(const DataType* base, const std::vector<const DataType*>& objects)
+        : size_(objects.size())
+    {
+#if HAVE_MPI
+        MPI_Aint baseAddress = 0;
+        if (base)
+            MPI_Get_address(const_cast<DataType*>(base), &baseAddress);
+        std::vector<MPI_Aint> displacements(objects.size());
+        for (size_t i = 0; i < objects.size(); ++i) {
+            MPI_Get_address(const_cast<DataType*>(objects[i]), &displacements[i]);
+            displacements[i] -= baseAddress;
+        }
+        create_(displacements);
+#endif // HAVE_MPI
+    }
+
+    MpiIndexedType(const MpiIndexedType&) = delete;
+    MpiIndexedType& operator=(const MpiIndexedType&) = delete;
+
+    ~MpiIndexedType()
+    {
+#if HAVE_MPI
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (!finalized)
+            MPI_Type_free(&mpiDataType_);
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Returns the number of selected objects.
+     */
+    size_t size() const
+    { return size_; }
+
+#if HAVE_MPI
+    /*!
+     * \brief Returns the MPI data type.
+     */
+    MPI_Datatype mpiDataType() const
+    { return mpiDataType_; }
+#endif // HAVE_MPI
+
+private:
+#if HAVE_MPI
+    void create_(std::vector<MPI_Aint>& displacements)
+    {
+        // the objects are transferred as bytes like the ones of MpiBuffers for
+        // non-primitive types
+        MPI_Datatype objectType;
+        MPI_Type_contiguous(static_cast<int>(sizeof(DataType)), MPI_BYTE, &objectType);
+
+        std::vector<int> blockLengths(displacements.size(), 1);
+        MPI_Type_create_hindexed(static_cast<int>(displacements.size()),
+                                 blockLengths.data(),
+                                 displacements.data(),
+                                 objectType,
+                                 &mpiDataType_);
+        MPI_Type_commit(&mpiDataType_);
+        MPI_Type_free(&objectType);
+    }
+
+    MPI_Datatype mpiDataType_;
+#endif // HAVE_MPI
+    size_t size_;
+};
+
 /*!
  * \brief Simplifies handling of buffers to be used in conjunction with MPI
+ *
+ * Besides communicating its own contents, a buffer can communicate objects which are
+ * located elsewhere in memory using a persistent request and an MpiIndexedType. In
+ * this case, the buffer itself may be empty.
  */
 template <class DataType>
 class MpiBuffer
@@ -49,7 +154,9 @@ public:
     {
         data_ = NULL;
         dataSize_ = 0;
+        boundData_ = NULL;
 
+        initRequest_();
         setMpiDataType_();
         updateMpiDataSize_();
     }
@@ -58,7 +165,9 @@ public:
     {
         data_ = new DataType[size];
         dataSize_ = size;
+        boundData_ = NULL;
 
+        initRequest_();
         setMpiDataType_();
         updateMpiDataSize_();
     }
@@ -66,13 +175,19 @@ public:
     MpiBuffer(const MpiBuffer&) = default;
 
     ~MpiBuffer()
-    { delete[] data_; }
+    {
+        freePersistentRequest_();
+        delete[] data_;
+    }
 
     /*!
      * \brief Set the size of the buffer
+     *
+     * This invalidates persistent requests which were created for the buffer.
      */
     void resize(size_t newSize)
     {
+        freePersistentRequest_();
         delete[] data_;
         data_ = new DataType[newSize];
         dataSize_ = newSize;
@@ -85,6 +200,7 @@ public:
     void send([[maybe_unused]] unsigned peerRank)
     {
 #if HAVE_MPI
+        freePersistentRequest_();
         MPI_Isend(data_,
                   static_cast<int>(mpiDataSize_),
                   mpiDataType_,
@@ -96,7 +212,142 @@ public:
     }
 
     /*!
-     * \brief Wait until the buffer was send to the peer completely.
+     * \brief Create a persistent request which sends the buffer to a peer process.
+     *
+     * This sets up the communication once. Then, each call to start() sends the current
+     * contents of the buffer to the peer without having to negotiate the communication
+     * anew. The persistent request stays valid until the buffer is resized or send(),
+     * asyncReceive() or one of the persistent init methods is called.
+     */
+    void initPersistentSend([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        freePersistentRequest_();
+        MPI_Send_init(data_,
+                      static_cast<int>(mpiDataSize_),
+                      mpiDataType_,
+                      static_cast<int>(peerRank),
+                      0, // tag
+                      MPI_COMM_WORLD,
+                      &mpiRequest_);
+        persistent_ = true;
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Create a persistent request which receives the buffer from a peer
+     *        process.
+     *
+     * \copydetails initPersistentSend()
+     */
+    void initPersistentReceive([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        freePersistentRequest_();
+        MPI_Recv_init(data_,
+                      static_cast<int>(mpiDataSize_),
+                      mpiDataType_,
+                      static_cast<int>(peerRank),
+                      0, // tag
+                      MPI_COMM_WORLD,
+                      &mpiRequest_);
+        persistent_ = true;
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Create a persistent request which sends objects located relative to an
+     *        address to a peer process.
+     *
+     * In contrast to initPersistentSend(unsigned), the objects are taken directly from
+     * their location in memory when start() is called, i.e., they do not need to be
+     * copied into the buffer first. The request must be created anew if the objects
+     * are moved.
+     *
+     * \param data The base address of the objects
+     * \param type The data type which selects the objects relative to the base address
+     * \param peerRank The rank of the process to which the objects are sent
+     */
+    void initPersistentSend(const DataType* data,
+                            [[maybe_unused]] const MpiIndexedType<DataType>& type,
+                            [[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        freePersistentRequest_();
+        MPI_Send_init(const_cast<DataType*>(data),
+                      1,
+                      type.mpiDataType(),
+                      static_cast<int>(peerRank),
+                      0, // tag
+                      MPI_COMM_WORLD,
+                      &mpiRequest_);
+        persistent_ = true;
+#endif // HAVE_MPI
+        boundData_ = data;
+    }
+
+    /*!
+     * \brief Create a persistent request which receives objects located relative to an
+     *        address from a peer process.
+     *
+     * \copydetails initPersistentSend(const DataType*, const MpiIndexedType<DataType>&, unsigned)
+     */
+    void initPersistentReceive(DataType* data,
+                               [[maybe_unused]] const MpiIndexedType<DataType>& type,
+                               [[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        freePersistentRequest_();
+        MPI_Recv_init(data,
+                      1,
+                      type.mpiDataType(),
+                      static_cast<int>(peerRank),
+                      0, // tag
+                      MPI_COMM_WORLD,
+                      &mpiRequest_);
+        persistent_ = true;
+#endif // HAVE_MPI
+        boundData_ = data;
+    }
+
+    /*!
+     * \brief Returns the base address of the objects which are communicated by the
+     *        persistent request.
+     *
+     * This is NULL if the persistent request communicates the contents of the buffer.
+     */
+    const DataType* boundData() const
+    { return boundData_; }
+
+    /*!
+     * \brief Returns true if a persistent request was created for the buffer.
+     */
+    bool persistent() const
+    {
+#if HAVE_MPI
+        return persistent_;
+#else
+        return false;
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Start the communication of the buffer's persistent request.
+     *
+     * Like for send() and asyncReceive(), wait() must be called before the contents of
+     * the buffer may be accessed again.
+     */
+    void start()
+    {
+#if HAVE_MPI
+        assert(persistent_);
+        MPI_Start(&mpiRequest_);
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Wait until the buffer was send to the peer completely or, if
+     *        asyncReceive() was called, until it was received completely.
      */
     void wait()
     {
@@ -122,18 +373,37 @@ public:
 #endif // HAVE_MPI
     }
 
+    /*!
+     * \brief Start receiving the buffer asyncronously from a peer rank.
+     *
+     * The data is only available after the wait() method has been called.
+     */
+    void asyncReceive([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        freePersistentRequest_();
+        MPI_Irecv(data_,
+                  static_cast<int>(mpiDataSize_),
+                  mpiDataType_,
+                  static_cast<int>(peerRank),
+                  0, // tag
+                  MPI_COMM_WORLD,
+                  &mpiRequest_);
+#endif // HAVE_MPI
+    }
+
 #if HAVE_MPI
     /*!
      * \brief Returns the current MPI_Request object.
      *
-     * This object is only well defined after the send() method.
+     * This object is only well defined after the send() and asyncReceive() methods.
      */
     MPI_Request& request()
     { return mpiRequest_; }
     /*!
      * \brief Returns the current MPI_Request object.
      *
-     * This object is only well defined after the send() method.
+     * This object is only well defined after the send() and asyncReceive() methods.
      */
     const MPI_Request& request() const
     { return mpiRequest_; }
@@ -179,6 +449,30 @@ public:
     }
 
 private:
+    void initRequest_()
+    {
+#if HAVE_MPI
+        mpiRequest_ = MPI_REQUEST_NULL;
+        persistent_ = false;
+#endif // HAVE_MPI
+    }
+
+    void freePersistentRequest_()
+    {
+        boundData_ = NULL;
+#if HAVE_MPI
+        if (persistent_) {
+            // buffers which outlive MPI do not need to clean up
+            int finalized;
+            MPI_Finalized(&finalized);
+            if (!finalized)
+                MPI_Request_free(&mpiRequest_);
+        }
+        mpiRequest_ = MPI_REQUEST_NULL;
+        persistent_ = false;
+#endif // HAVE_MPI
+    }
+
     void setMpiDataType_()
     {
 #if HAVE_MPI
@@ -226,11 +520,13 @@ private:
 
     DataType *data_;
     size_t dataSize_;
+    const DataType *boundData_;
 #if HAVE_MPI
     size_t mpiDataSize_;
     MPI_Datatype mpiDataType_;
     MPI_Request mpiRequest_;
     MPI_Status mpiStatus_;
+    bool persistent_;
 #endif // HAVE_MPI
 };
 
@@ -0,0 +1,157 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::MpmcQueue
+ */
+#ifndef EWOMS_MPMC_QUEUE_HH
+#define EWOMS_MPMC_QUEUE_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace Opm {
+
+/*!
+ * \brief A bounded lock-free queue for multiple producers and multiple consumers.
+ *
+ * The objects are dequeued in the order in which they were enqueued. Each slot of the
+ * ring buffer carries a sequence number which tells producers and consumers whether the
+ * slot is ready for them, so pushing and popping an object only costs a single
+ * compare-and-swap operation if there is no contention. This is the algorithm of
+ * D. Vyukov: "Bounded MPMC queue", 2010.
+ */
+template <class T>
+class MpmcQueue
+{
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    // the size of a cache line on all contemporary architectures
+    static constexpr size_t cacheLineSize = 64;
+
+public:
+    /*!
+     * \brief Create a queue which is able to hold at least a given number of objects.
+     *
+     * The capacity is rounded up to the next power of two.
+     */
+    explicit MpmcQueue(size_t minCapacity)
+    {
+        size_t capacity = 2;
+        while (capacity < minCapacity)
+            capacity *= 2;
+
+        mask_ = capacity - 1;
+        cells_.reset(new Cell[capacity]);
+        for (size_t i = 0; i < capacity; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        enqueuePos_.store(0, std::memory_order_relaxed);
+        dequeuePos_.store(0, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+
+    /*!
+     * \brief Returns the maximum number of objects which can be held by the queue.
+     */
+    size_t capacity() const
+    { return mask_ + 1; }
+
+    /*!
+     * \brief Append an object to the queue.
+     *
+     * If the queue is full, false is returned and the queue is not modified.
+     */
+    bool tryPush(T value)
+    {
+        Cell* cell;
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false; // full
+            else
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Remove the oldest object from the queue.
+     *
+     * If the queue is empty, false is returned and the value is not modified.
+     */
+    bool tryPop(T& value)
+    {
+        Cell* cell;
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false; // empty
+            else
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+        }
+
+        value = std::move(cell->data);
+        // release the resources held by the object before the slot is reused
+        cell->data = T();
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+
+    // the positions are modified by different threads, so we keep them in separate
+    // cache lines
+    alignas(cacheLineSize) std::atomic<size_t> enqueuePos_;
+    alignas(cacheLineSize) std::atomic<size_t> dequeuePos_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,169 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::NonBlockingSum
+ */
+#ifndef EWOMS_NON_BLOCKING_SUM_HH
+#define EWOMS_NON_BLOCKING_SUM_HH
+
+#if HAVE_MPI
+#include <mpi.h>
+#include <dune/common/parallel/mpitraits.hh>
+#endif
+
+#include <cassert>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Sums up a vector of values over all processes using a single non-blocking
+ *        reduction.
+ *
+ * The values are added one by one by the code which requires them to be reduced. Once
+ * all are known, the reduction is started using start() and it is completed by the
+ * first call to finish(). In between, the processes can do work which does not depend
+ * on the result. Conditions which must be checked on all processes can be included as
+ * well by adding the number of local failures.
+ */
+template <class T>
+class NonBlockingSum
+{
+public:
+    NonBlockingSum()
+    {
+#if HAVE_MPI
+        request_ = MPI_REQUEST_NULL;
+#endif
+    }
+
+    NonBlockingSum(const NonBlockingSum&) = delete;
+
+    ~NonBlockingSum()
+    { finish(); }
+
+    /*!
+     * \brief Remove all values, completing an outstanding reduction first.
+     */
+    void reset()
+    {
+        finish();
+        localValues_.clear();
+        globalValues_.clear();
+    }
+
+    /*!
+     * \brief Add a local value and return the index of its slot.
+     */
+    unsigned add(const T& value)
+    {
+        assert(!pending());
+        localValues_.push_back(value);
+        return static_cast<unsigned>(localValues_.size() - 1);
+    }
+
+    /*!
+     * \brief Start the reduction of all values added so far.
+     */
+    template <class CollectiveCommunication>
+    void start(const CollectiveCommunication& comm)
+    {
+        finish();
+        globalValues_.resize(localValues_.size());
+#if HAVE_MPI
+        if (comm.size() > 1 && !localValues_.empty()) {
+            MPI_Iallreduce(localValues_.data(),
+                           globalValues_.data(),
+                           static_cast<int>(localValues_.size()),
+                           Dune::MPITraits<T>::getType(),
+                           MPI_SUM,
+                           static_cast<MPI_Comm>(comm),
+                           &request_);
+            return;
+        }
+#else
+        (void) comm;
+#endif
+        globalValues_ = localValues_;
+    }
+
+    /*!
+     * \brief Returns true if the reduction has been started but not yet completed.
+     */
+    bool pending() const
+    {
+#if HAVE_MPI
+        return request_ != MPI_REQUEST_NULL;
+#else
+        return false;
+#endif
+    }
+
+    /*!
+     * \brief Wait until the reduction has been completed.
+     *
+     * Calling this method if no reduction is outstanding is a no-op.
+     */
+    void finish()
+    {
+#if HAVE_MPI
+        if (pending())
+            MPI_Wait(&request_, MPI_STATUS_IGNORE);
+#endif
+    }
+
+    /*!
+     * \brief Returns the number of values.
+     */
+    size_t size() const
+    { return localValues_.size(); }
+
+    /*!
+     * \brief Returns the local value of a slot.
+     */
+    const T& localValue(unsigned slotIdx) const
+    { return localValues_[slotIdx]; }
+
+    /*!
+     * \brief Returns the sum of the values of a slot over all processes.
+     *
+     * This requires the reduction to be completed.
+     */
+    const T& value(unsigned slotIdx) const
+    {
+        assert(!pending());
+        return globalValues_[slotIdx];
+    }
+
+private:
+    std::vector<T> localValues_;
+    std::vector<T> globalValues_;
+#if HAVE_MPI
+    MPI_Request request_;
+#endif
+};
+
+} // namespace Opm
+
+#endif
@@ -27,26 +27,55 @@
 #ifndef EWOMS_TASKLETS_HH
 #define EWOMS_TASKLETS_HH
 
+#include <opm/models/parallel/mpmcqueue.hh>
+#include <opm/models/utils/eventtracer.hh>
+
+#include <algorithm>
+#include <atomic>
 #include <stdexcept>
 #include <cassert>
 #include <thread>
-#include <queue>
+#include <memory>
 #include <mutex>
+#include <vector>
 #include <iostream>
 #include <condition_variable>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace Opm {
 
+class TaskletRunner;
+
 /*!
  * \brief The base class for tasklets.
  *
  * Tasklets are a generic mechanism for potentially running work in a separate thread.
+ * A tasklet may depend on other tasklets, i.e., it is only run after all invocations of
+ * these have been completed. This allows to express the dependencies of the work
+ * dispatched to a TaskletRunner as a directed acyclic graph.
  */
 class TaskletInterface
 {
+    friend class TaskletRunner;
+
 public:
+    /*!
+     * \brief The priority of a tasklet.
+     *
+     * Workers always run the queued tasklets of the highest priority first, i.e.,
+     * tasklets of low priority, e.g. bulk output, do not delay latency-critical ones.
+     */
+    enum class Priority { Low = 0, Normal = 1, High = 2 };
+    static constexpr unsigned numPriorities = 3;
+
     TaskletInterface(int refCount = 1)
         : referenceCount_(refCount)
+        , numUnfinished_(refCount)
+        , priority_(Priority::Normal)
     {}
     virtual ~TaskletInterface() {}
     virtual void run() = 0;
@@ -58,8 +87,81 @@ public:
     int referenceCount() const
     { return referenceCount_; }
 
+    /*!
+     * \brief Specify that the tasklet must not be run before all invocations of another
+     *        tasklet have been completed.
+     *
+     * The other tasklet must be dispatched before this one and it must be dispatched
+     * to the same tasklet runner. Dependencies must be added before the tasklet is
+     * dispatched.
+     */
+    void addDependency(std::shared_ptr<TaskletInterface> tasklet)
+    {
+        if (tasklet)
+            dependencies_.push_back(tasklet);
+    }
+
+    /*!
+     * \brief Specify the priority of the tasklet.
+     *
+     * This must be done before the tasklet is dispatched. A tasklet must not depend on
+     * a tasklet of lower priority.
+     */
+    void setPriority(Priority priority)
+    { priority_ = priority; }
+
+    /*!
+     * \brief Returns the priority of the tasklet.
+     */
+    Priority priority() const
+    { return priority_; }
+
+    /*!
+     * \brief Returns true if all invocations of the tasklet have been completed.
+     */
+    bool isFinished() const
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex_);
+        return numUnfinished_ <= 0;
+    }
+
+    /*!
+     * \brief Block the calling thread until all invocations of the tasklet have been
+     *        completed.
+     */
+    void waitUntilFinished()
+    {
+        std::unique_lock<std::mutex> lock(finishedMutex_);
+        finishedCondition_.wait(lock, [this]() { return numUnfinished_ <= 0; });
+    }
+
 private:
-    int referenceCount_;
+    // run one invocation of the tasklet after all tasklets on which it depends have
+    // been completed. exceptions are not handled here.
+    void runInvocation_()
+    {
+        for (auto& dependency : dependencies_)
+            dependency->waitUntilFinished();
+
+        run();
+    }
+
+    void invocationFinished_()
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex_);
+        if (-- numUnfinished_ <= 0) {
+            // the tasklets on which this one depends are not required anymore
+            dependencies_.clear();
+            finishedCondition_.notify_all();
+        }
+    }
+
+    std::atomic<int> referenceCount_;
+    int numUnfinished_;
+    Priority priority_;
+    std::vector<std::shared_ptr<TaskletInterface> > dependencies_;
+    mutable std::mutex finishedMutex_;
+    std::condition_variable finishedCondition_;
 };
 
 /*!
@@ -82,8 +184,6 @@ private:
     const Fn& fn_;
 };
 
-class TaskletRunner;
-
 // this class stores the thread local static attributes for the TaskletRunner class. we
 // cannot put them directly into TaskletRunner because defining static members for
 // non-template classes in headers leads the linker to choke in case multiple compile
@@ -106,60 +206,37 @@ thread_local int TaskletRunnerHelper_<Dummy>::workerThreadIndex_ = -1;
  *
  * Depending on the number of worker threads, a tasklet can either be run in a separate
  * worker thread or by the main thread.
+ *
+ * Each worker thread has one lock-free queue per tasklet priority: Dispatched tasklets
+ * are distributed amongst the queues of their priority in a round-robin fashion and a
+ * worker which runs out of work steals the oldest tasklet from the queue of another
+ * worker. The queues of higher priority are always considered first. The mutexes of the
+ * class are thus only taken if a worker thread goes to sleep, if the main thread waits
+ * in a barrier or if it waits because too many tasklets of a priority are pending.
+ * Since all queues are FIFO, work is only stolen by workers which do not have any
+ * work of their own and tasklets only depend on tasklets of the same or of a higher
+ * priority, a tasklet never needs to wait for a tasklet which is queued behind it,
+ * i.e., dependencies between tasklets cannot cause deadlocks as long as each dependency
+ * has been dispatched before the tasklets which depend on it.
+ *
+ * The number of pending invocations of the tasklets of a priority can be limited
+ * (setMaxPending()). Dispatching a tasklet then blocks until the workers have caught
+ * up, so that e.g. output which is slower than the simulation does not accumulate
+ * in memory.
  */
 class TaskletRunner
 {
-    /// \brief Implements a barrier. This class can only be used in the asynchronous case.
-    class BarrierTasklet : public TaskletInterface
-    {
-    public:
-        BarrierTasklet(unsigned numWorkers)
-            : TaskletInterface(/*refCount=*/numWorkers)
-        {
-            numWorkers_ = numWorkers;
-            numWaiting_ = 0;
-        }
-
-        void run()
-        { wait(); }
-
-        void wait()
-        {
-            std::unique_lock<std::mutex> lock(barrierMutex_);
-
-            numWaiting_ += 1;
-            if (numWaiting_ >= numWorkers_ + 1) {
-                lock.unlock();
-                barrierCondition_.notify_all();
-            }
-            else {
-                const auto& areAllWaiting =
-                    [this]() -> bool
-                    { return this->numWaiting_ >= this->numWorkers_ + 1; };
-
-                barrierCondition_.wait(lock, /*predicate=*/areAllWaiting);
-            }
-        }
-
-    private:
-        unsigned numWorkers_;
-        unsigned numWaiting_;
+    // the number of tasklet invocations which each queue can hold. If all queues are
+    // full, dispatching a tasklet waits until one of the workers has made room.
+    static constexpr size_t queueCapacity_ = 1024;
 
-        std::condition_variable barrierCondition_;
-        std::mutex barrierMutex_;
-    };
+    // the number of times a worker thread looks for work before it goes to sleep
+    static constexpr int numSpinRounds_ = 64;
 
-    /// \brief TerminateThreadTasklet class
-    /// Empty tasklet marking thread termination.
-    class TerminateThreadTasklet : public TaskletInterface
-    {
-    public:
-        void run()
-        { }
-
-        bool isEndMarker() const
-        { return true; }
-    };
+    using TaskletPtr = std::shared_ptr<TaskletInterface>;
+    using Queue = MpmcQueue<TaskletPtr>;
+    using Priority = TaskletInterface::Priority;
+    static constexpr unsigned numPriorities_ = TaskletInterface::numPriorities;
 
 public:
     // prohibit copying of tasklet runners
@@ -172,7 +249,21 @@ public:
      * thread (synchronous mode).
      */
     TaskletRunner(unsigned numWorkers)
+        : nextQueueIdx_(0)
+        , numQueued_(0)
+        , numUnfinished_(0)
+        , numSleeping_(0)
+        , numBarrierWaiters_(0)
+        , numBackpressureWaiters_(0)
+        , terminate_(false)
     {
+        for (unsigned priorityIdx = 0; priorityIdx < numPriorities_; ++priorityIdx) {
+            for (unsigned i = 0; i < numWorkers; ++i)
+                queues_[priorityIdx].emplace_back(new Queue(queueCapacity_));
+            numPending_[priorityIdx] = 0;
+            maxPending_[priorityIdx] = 0;
+        }
+
         threads_.resize(numWorkers);
         for (unsigned i = 0; i < numWorkers; ++i)
             // create a worker thread
@@ -189,8 +280,12 @@ public:
     ~TaskletRunner()
     {
         if (threads_.size() > 0) {
-            // dispatch a tasklet which will terminate the worker thread
-            dispatch(std::make_shared<TerminateThreadTasklet>());
+            // tell the worker threads to terminate as soon as all queues are empty
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex_);
+                terminate_ = true;
+            }
+            workAvailableCondition_.notify_all();
 
             // wait until all worker threads have terminated
             for (auto& thread : threads_)
@@ -216,6 +311,47 @@ public:
     int numWorkerThreads() const
     { return threads_.size(); }
 
+    /*!
+     * \brief Limit the number of invocations of the tasklets of a priority which have
+     *        been dispatched but not completed.
+     *
+     * If the limit is reached, dispatching a tasklet of this priority blocks until the
+     * workers have completed enough invocations. Tasklets dispatched by the workers
+     * themselves are exempt from this to avoid deadlocks. 0 means that the number is
+     * not limited, which is the default.
+     */
+    void setMaxPending(Priority priority, size_t maxPending)
+    { maxPending_[static_cast<unsigned>(priority)] = maxPending; }
+
+    /*!
+     * \brief Bind all worker threads to a set of CPUs.
+     *
+     * This allows to keep e.g. the threads which write output away from the CPUs which
+     * do the computations. This is only supported on Linux.
+     *
+     * \return true if the affinity of all workers was changed successfully.
+     */
+    bool setWorkerAffinity(const std::vector<int>& cpus)
+    {
+#ifdef __linux__
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (int cpuIdx : cpus)
+            if (0 <= cpuIdx && cpuIdx < CPU_SETSIZE)
+                CPU_SET(cpuIdx, &cpuSet);
+        if (CPU_COUNT(&cpuSet) == 0)
+            return false;
+
+        bool success = true;
+        for (auto& thread : threads_)
+            success = success
+                && pthread_setaffinity_np(thread->native_handle(), sizeof(cpuSet), &cpuSet) == 0;
+        return success;
+#else
+        return cpus.empty();
+#endif
+    }
+
     /*!
      * \brief Add a new tasklet.
      *
@@ -223,12 +359,17 @@ public:
      */
     void dispatch(std::shared_ptr<TaskletInterface> tasklet)
     {
+        for (const auto& dependency : tasklet->dependencies_)
+            if (dependency->priority() < tasklet->priority() && !dependency->isFinished())
+                throw std::logic_error("A tasklet must not depend on a tasklet of lower "
+                                       "priority");
+
         if (threads_.empty()) {
             // run the tasklet immediately in synchronous mode.
             while (tasklet->referenceCount() > 0) {
                 tasklet->dereference();
                 try {
-                    tasklet->run();
+                    tasklet->runInvocation_();
                 }
                 catch (const std::exception& e) {
                     std::cerr << "ERROR: Uncaught std::exception when running tasklet: " << e.what() << ". Trying to continue.\n";
@@ -236,19 +377,20 @@ public:
                 catch (...) {
                     std::cerr << "ERROR: Uncaught exception (general type) when running tasklet. Trying to continue.\n";
                 }
+                tasklet->invocationFinished_();
             }
         }
         else {
-            // lock mutex for the tasklet queue to make sure that nobody messes with the
-            // task queue
-            taskletQueueMutex_.lock();
-
-            // add the tasklet to the queue
-            taskletQueue_.push(tasklet);
-
-            taskletQueueMutex_.unlock();
-
-            workAvailableCondition_.notify_all();
+            // each invocation of the tasklet gets its own queue entry, so that
+            // multiple workers can run it concurrently
+            int numInvocations = tasklet->referenceCount();
+            size_t n = static_cast<size_t>(std::max(numInvocations, 0));
+            unsigned priorityIdx = static_cast<unsigned>(tasklet->priority());
+            waitForBackpressure_(priorityIdx, n);
+            numPending_[priorityIdx] += n;
+            numUnfinished_ += n;
+            for (int i = 0; i < numInvocations; ++i)
+                push_(tasklet);
         }
     }
 
@@ -269,16 +411,18 @@ public:
      */
     void barrier()
     {
-        unsigned numWorkers = threads_.size();
-        if (numWorkers == 0)
+        if (threads_.empty())
             // nothing needs to be done to implement a barrier in synchronous mode
             return;
 
-        // dispatch a barrier tasklet and wait until it has been run by the worker thread
-        auto barrierTasklet = std::make_shared<BarrierTasklet>(numWorkers);
-        dispatch(barrierTasklet);
-
-        barrierTasklet->wait();
+        // wait until the number of tasklet invocations which have not been completed
+        // drops to zero. The worker which completes the last one wakes us up.
+        ++ numBarrierWaiters_;
+        {
+            std::unique_lock<std::mutex> lock(barrierMutex_);
+            barrierCondition_.wait(lock, [this]() { return numUnfinished_ == 0; });
+        }
+        -- numBarrierWaiters_;
     }
 
 protected:
@@ -288,46 +432,114 @@ protected:
         TaskletRunnerHelper_<void>::taskletRunner_ = taskletRunner;
         TaskletRunnerHelper_<void>::workerThreadIndex_ = workerThreadIndex;
 
-        taskletRunner->run_();
+        taskletRunner->run_(static_cast<unsigned>(workerThreadIndex));
     }
 
-    //! do the work until the queue received an end tasklet
-    void run_()
+    // block the dispatching thread while too many invocations of the tasklets of a
+    // priority are pending. a single tasklet with more invocations than the limit is
+    // admitted once nothing of its priority is pending anymore.
+    void waitForBackpressure_(unsigned priorityIdx, size_t numInvocations)
     {
+        size_t maxPending = maxPending_[priorityIdx];
+        if (maxPending == 0 || workerThreadIndex() >= 0)
+            return;
+
+        auto admissible = [this, priorityIdx, numInvocations, maxPending]() {
+            size_t pending = numPending_[priorityIdx];
+            return pending == 0 || pending + numInvocations <= maxPending;
+        };
+        if (admissible())
+            return;
+
+        EventTracer::Scope traceScope("tasklet backpressure", "tasklets");
+        ++ numBackpressureWaiters_;
+        {
+            std::unique_lock<std::mutex> lock(backpressureMutex_);
+            backpressureCondition_.wait(lock, admissible);
+        }
+        -- numBackpressureWaiters_;
+    }
+
+    // put a tasklet invocation into one of the queues of its priority and wake up a
+    // worker if necessary
+    void push_(const TaskletPtr& tasklet)
+    {
+        // the counter is incremented first, so that it never underflows. the flipside is
+        // that the workers may briefly see work which cannot be popped yet.
+        ++ numQueued_;
+
+        auto& queues = queues_[static_cast<unsigned>(tasklet->priority())];
+        size_t numQueues = queues.size();
+        size_t queueIdx = nextQueueIdx_++ % numQueues;
         while (true) {
-            // wait until tasklets have been pushed to the queue. first we need to lock
-            // mutex for access to taskletQueue_
-            std::unique_lock<std::mutex> lock(taskletQueueMutex_);
-
-            const auto& workIsAvailable =
-                [this]() -> bool
-                { return !taskletQueue_.empty(); };
-
-            if (!workIsAvailable())
-                workAvailableCondition_.wait(lock, /*predicate=*/workIsAvailable);
-
-            // remove tasklet from queue
-            std::shared_ptr<TaskletInterface> tasklet = taskletQueue_.front();
-
-            // if tasklet is an end marker, terminate the thread and DO NOT remove the
-            // tasklet.
-            if (tasklet->isEndMarker()) {
-                if(taskletQueue_.size() > 1)
-                    throw std::logic_error("TaskletRunner: Not all queued tasklets were executed");
-                taskletQueueMutex_.unlock();
-                return;
+            bool pushed = false;
+            for (size_t i = 0; i < numQueues && !pushed; ++i)
+                pushed = queues[(queueIdx + i) % numQueues]->tryPush(tasklet);
+            if (pushed)
+                break;
+
+            // all queues are full. let the workers make some progress
+            std::this_thread::yield();
+        }
+
+        if (numSleeping_ > 0) {
+            // take the lock to make sure that the worker either sees the new work
+            // before it goes to sleep or that it receives the notification
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            workAvailableCondition_.notify_one();
+        }
+    }
+
+    // get the next tasklet invocation for a worker: for each priority, starting with
+    // the highest one, its own queue is considered first, then the oldest entries of the
+    // queues of the other workers are stolen
+    bool pop_(unsigned workerIdx, TaskletPtr& tasklet)
+    {
+        for (unsigned i = 0; i < numPriorities_; ++i) {
+            auto& queues = queues_[numPriorities_ - 1 - i];
+            size_t numQueues = queues.size();
+            for (size_t j = 0; j < numQueues; ++j) {
+                if (queues[(workerIdx + j) % numQueues]->tryPop(tasklet)) {
+                    -- numQueued_;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    //! do the work until the runner is destroyed and all tasklets have been run
+    void run_(unsigned workerIdx)
+    {
+        TaskletPtr tasklet;
+        while (true) {
+            if (!pop_(workerIdx, tasklet)) {
+                // spin for a while before going to sleep: if small tasklets are
+                // dispatched in quick succession, waking up the thread every time would
+                // be expensive
+                for (int i = 0; i < numSpinRounds_ && numQueued_ == 0 && !terminate_; ++i)
+                    std::this_thread::yield();
+
+                if (numQueued_ > 0)
+                    continue;
+
+                std::unique_lock<std::mutex> lock(sleepMutex_);
+                if (terminate_ && numQueued_ == 0)
+                    return;
+
+                ++ numSleeping_;
+                workAvailableCondition_.wait(lock,
+                                             [this]() { return numQueued_ > 0 || terminate_; });
+                -- numSleeping_;
+                continue;
             }
 
             tasklet->dereference();
-            if (tasklet->referenceCount() == 0)
-                // remove tasklets from the queue as soon as their reference count
-                // reaches zero, i.e. the tasklet has been run often enough.
-                taskletQueue_.pop();
-            lock.unlock();
 
             // execute tasklet
             try {
-                tasklet->run();
+                EventTracer::Scope traceScope("tasklet", "tasklets");
+                tasklet->runInvocation_();
             }
             catch (const std::exception& e) {
                 std::cerr << "ERROR: Uncaught std::exception when running tasklet: " << e.what() << ". Trying to continue.\n";
@@ -335,13 +547,49 @@ protected:
             catch (...) {
                 std::cerr << "ERROR: Uncaught exception when running tasklet. Trying to continue.\n";
             }
+            tasklet->invocationFinished_();
+            unsigned priorityIdx = static_cast<unsigned>(tasklet->priority());
+            tasklet.reset();
+
+            -- numPending_[priorityIdx];
+            if (numBackpressureWaiters_ > 0) {
+                std::lock_guard<std::mutex> lock(backpressureMutex_);
+                backpressureCondition_.notify_all();
+            }
+
+            if (-- numUnfinished_ == 0 && numBarrierWaiters_ > 0) {
+                std::lock_guard<std::mutex> lock(barrierMutex_);
+                barrierCondition_.notify_all();
+            }
         }
     }
 
     std::vector<std::unique_ptr<std::thread> > threads_;
-    std::queue<std::shared_ptr<TaskletInterface> > taskletQueue_;
-    std::mutex taskletQueueMutex_;
+    std::vector<std::unique_ptr<Queue> > queues_[numPriorities_];
+    std::atomic<size_t> nextQueueIdx_;
+
+    // the number of tasklet invocations in the queues
+    std::atomic<size_t> numQueued_;
+    // the number of tasklet invocations which have been dispatched but not completed
+    std::atomic<size_t> numUnfinished_;
+
+    std::atomic<int> numSleeping_;
+    std::mutex sleepMutex_;
     std::condition_variable workAvailableCondition_;
+
+    std::atomic<int> numBarrierWaiters_;
+    std::mutex barrierMutex_;
+    std::condition_variable barrierCondition_;
+
+    // the number of dispatched but not completed invocations per priority and their
+    // limits
+    std::atomic<size_t> numPending_[numPriorities_];
+    size_t maxPending_[numPriorities_];
+    std::atomic<int> numBackpressureWaiters_;
+    std::mutex backpressureMutex_;
+    std::condition_variable backpressureCondition_;
+
+    std::atomic<bool> terminate_;
 };
 
 } // end namespace Opm
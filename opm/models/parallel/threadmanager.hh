@@ -31,11 +31,23 @@
 #include <omp.h>
 #endif
 
+#include <opm/models/parallel/threadphases.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/propertysystem.hh>
 
 #include <dune/common/version.hh>
 
+#if defined(_OPENMP) && defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace Opm {
 
 /*!
@@ -62,6 +74,32 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, int, ThreadsPerProcess,
                              "The maximum number of threads to be instantiated per process "
                              "('-1' means 'automatic')");
+        EWOMS_REGISTER_PARAM(TypeTag, int, AsyncThreadsPerProcess,
+                             "The number of the threads of a process which do asynchronous "
+                             "work like overlapped output if it is enabled. They are not "
+                             "used by the multi-threaded computations unless there is only "
+                             "a single thread");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, PinThreads,
+                             "Bind each thread to one of the CPUs on which the process is "
+                             "allowed to run");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, AsyncThreadCpus,
+                             "A comma separated list of the CPUs to which the threads for "
+                             "asynchronous work are bound, e.g. to keep them away from the "
+                             "CPUs which do the computations (default: not bound)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableCommunicationThread,
+                             "Dedicate one of the threads of each process to the "
+                             "communication with the peer processes in parallel "
+                             "simulations");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, ThreadPhaseSettings,
+                             "A comma separated list of the number of threads and the "
+                             "OpenMP schedules of individual parallel phases in the form "
+                             "'phase=threads[:schedule[:chunk]]', e.g. "
+                             "'constraints=2,colored linearization=0:dynamic:16'. Zero "
+                             "threads means all threads of the process");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, AutoTuneThreadPhases,
+                             "Determine the number of threads and the schedules of the "
+                             "parallel phases which are not configured explicitly by "
+                             "measuring their first executions");
     }
 
     static void init()
@@ -94,7 +132,85 @@ public:
             omp_set_num_threads(numThreads_);
 
         numThreads_ = omp_get_max_threads();
+
+        if (EWOMS_GET_PARAM(TypeTag, bool, PinThreads))
+            pinThreads_();
 #endif
+
+        configurePhases_();
+    }
+
+    /*!
+     * \brief Take threads from the budget of the current process for asynchronous work.
+     *
+     * The work is done outside of OpenMP parallel regions, e.g., by the worker threads
+     * of a TaskletRunner. To avoid oversubscribing the cores, the number of OpenMP
+     * threads is reduced accordingly, but at least one thread is left. This must be
+     * called before any objects which depend on the number of threads are created.
+     *
+     * \return The number of threads which must be used for the asynchronous work.
+     */
+    static unsigned reserveAsyncThreads()
+    {
+        int numAsync = std::max(0, EWOMS_GET_PARAM(TypeTag, int, AsyncThreadsPerProcess));
+#ifdef _OPENMP
+        if (numAsync > 0 && numThreads_ > 1) {
+            numThreads_ = std::max(1, numThreads_ - numAsync);
+            omp_set_num_threads(numThreads_);
+            configurePhases_();
+        }
+#endif
+        return static_cast<unsigned>(numAsync);
+    }
+
+    /*!
+     * \brief Take a thread from the budget of the current process for the communication
+     *        with the peer processes if this was requested.
+     *
+     * Like reserveAsyncThreads(), this reduces the number of OpenMP threads unless
+     * there is only a single thread and it must be called before any objects which
+     * depend on the number of threads are created.
+     *
+     * \return true if a communication thread ought to be created.
+     */
+    static bool reserveCommunicationThread()
+    {
+        if (!EWOMS_GET_PARAM(TypeTag, bool, EnableCommunicationThread))
+            return false;
+
+#ifdef _OPENMP
+        if (numThreads_ > 1) {
+            -- numThreads_;
+            omp_set_num_threads(numThreads_);
+            configurePhases_();
+        }
+#endif
+        return true;
+    }
+
+    /*!
+     * \brief Returns the CPUs to which the threads for asynchronous work ought to be
+     *        bound.
+     *
+     * The list is empty if they are not supposed to be bound.
+     */
+    static std::vector<int> asyncThreadCpus()
+    {
+        std::vector<int> cpus;
+        std::istringstream is(EWOMS_GET_PARAM(TypeTag, std::string, AsyncThreadCpus));
+        std::string cpu;
+        while (std::getline(is, cpu, ',')) {
+            if (cpu.find_first_not_of(" ") == std::string::npos)
+                continue;
+            try {
+                cpus.push_back(std::stoi(cpu));
+            }
+            catch (const std::exception&) {
+                throw std::invalid_argument("Invalid CPU '"+cpu+"' in the list of the CPUs for "
+                                            "the asynchronous threads");
+            }
+        }
+        return cpus;
     }
 
     /*!
@@ -115,7 +231,59 @@ public:
 #endif
     }
 
+    /*!
+     * \brief Return the contiguous range of indices which is assigned to a thread if n
+     *        indices are statically partitioned amongst all threads.
+     *
+     * The range is [beginIdx, endIdx). Loops which use the same partition always
+     * access the same data in the same thread, i.e., data which is first touched in
+     * such a loop is located in the memory of the NUMA node on which the thread runs.
+     */
+    static void threadRange(size_t n, unsigned threadIdx, size_t& beginIdx, size_t& endIdx)
+    {
+        size_t numThreads = static_cast<size_t>(numThreads_);
+        beginIdx = n*threadIdx/numThreads;
+        endIdx = n*(threadIdx + 1)/numThreads;
+    }
+
 private:
+    // the thread counts of the parallel phases are limited by the number of threads of
+    // the process, so they must be reconfigured whenever the latter changes
+    static void configurePhases_()
+    {
+        ThreadPhases::configure(numThreads_,
+                                EWOMS_GET_PARAM(TypeTag, std::string, ThreadPhaseSettings),
+                                EWOMS_GET_PARAM(TypeTag, bool, AutoTuneThreadPhases));
+    }
+
+    // bind the threads of the OpenMP thread pool to the CPUs on which the process may
+    // run in a round-robin fashion. this only has an effect if the OpenMP runtime
+    // reuses its threads, which all common implementations do.
+    static void pinThreads_()
+    {
+#if defined(_OPENMP) && defined(__linux__)
+        cpu_set_t processCpus;
+        CPU_ZERO(&processCpus);
+        if (sched_getaffinity(/*pid=*/0, sizeof(processCpus), &processCpus) != 0)
+            return;
+
+        std::vector<int> cpus;
+        for (int cpuIdx = 0; cpuIdx < CPU_SETSIZE; ++cpuIdx)
+            if (CPU_ISSET(cpuIdx, &processCpus))
+                cpus.push_back(cpuIdx);
+        if (cpus.empty())
+            return;
+
+#pragma omp parallel
+        {
+            cpu_set_t threadCpu;
+            CPU_ZERO(&threadCpu);
+            CPU_SET(cpus[static_cast<size_t>(omp_get_thread_num()) % cpus.size()], &threadCpu);
+            sched_setaffinity(/*pid=*/0, sizeof(threadCpu), &threadCpu);
+        }
+#endif
+    }
+
     static int numThreads_;
 };
 
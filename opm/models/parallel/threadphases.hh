@@ -0,0 +1,419 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ThreadPhases
+ */
+#ifndef EWOMS_THREAD_PHASES_HH
+#define EWOMS_THREAD_PHASES_HH
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Selects the number of threads and the OpenMP schedule of individual parallel
+ *        regions.
+ *
+ * Small parallel regions, e.g. the application of the constraints, and memory bound
+ * ones, e.g. the kernels on the global vectors, often run faster with fewer threads or
+ * a different distribution of the iterations than the element loops. Each such region
+ * belongs to a named phase. The configuration of a phase is either specified
+ * explicitly, or it is tuned automatically: In this case, the candidate
+ * configurations are tried in turn during the first executions of the phase, and the
+ * fastest one is used afterwards.
+ *
+ * The settings are given as a comma separated list of entries of the form
+ * 'phase=threads[:schedule[:chunk]]', where the schedule is either 'static', 'dynamic'
+ * or 'guided'. A thread count of zero means all threads of the process.
+ *
+ * Usage:
+ * \code
+ * static const unsigned phaseIdx = Opm::ThreadPhases::phaseIndex("my phase", true);
+ * Opm::ThreadPhases::Scope phase(phaseIdx, n);
+ * #pragma omp parallel for num_threads(phase.numThreads()) schedule(runtime)
+ * for (int i = 0; i < n; ++i)
+ *     ...
+ * \endcode
+ */
+class ThreadPhases
+{
+public:
+    enum class Schedule { Static, Dynamic, Guided };
+
+    struct Config
+    {
+        int numThreads = 0;
+        Schedule schedule = Schedule::Static;
+        int chunkSize = 0;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // the number of executions which are measured for each candidate configuration
+    static constexpr unsigned numTrials = 3;
+
+    struct Phase
+    {
+        std::string name;
+        bool scheduled = false;
+        bool fixed = false;
+        Config config;
+
+        // the state of the automatic tuning
+        std::vector<Config> candidates;
+        std::vector<double> bestTimes;
+        unsigned candidateIdx = 0;
+        unsigned trialIdx = 0;
+    };
+
+    struct State
+    {
+        std::mutex mutex;
+#ifdef _OPENMP
+        // until configure() is called, all threads are used
+        int maxThreads = omp_get_max_threads();
+#else
+        int maxThreads = 1;
+#endif
+        bool autoTune = false;
+        std::string settings;
+        std::vector<Phase> phases;
+    };
+
+public:
+    /*!
+     * \brief A parallel region of a phase.
+     *
+     * The constructor sets the OpenMP schedule of the phase for loops with
+     * schedule(runtime). If the phase is tuned, the time until the destructor is
+     * measured.
+     */
+    class Scope
+    {
+    public:
+        /*!
+         * \param phaseIdx The index of the phase as returned by phaseIndex()
+         * \param workSize The amount of work of the region, e.g., the number of loop
+         *                 iterations. The measured times are divided by it.
+         */
+        Scope(unsigned phaseIdx, std::size_t workSize)
+            : phaseIdx_(phaseIdx)
+            , workSize_(workSize)
+        {
+            Config config = ThreadPhases::begin_(phaseIdx_, tuning_);
+            numThreads_ = config.numThreads;
+#ifdef _OPENMP
+            omp_sched_t kind = omp_sched_static;
+            if (config.schedule == Schedule::Dynamic)
+                kind = omp_sched_dynamic;
+            else if (config.schedule == Schedule::Guided)
+                kind = omp_sched_guided;
+            omp_set_schedule(kind, config.chunkSize);
+#endif
+            if (tuning_)
+                begin_ = Clock::now();
+        }
+
+        ~Scope()
+        {
+            if (tuning_) {
+                double dt = std::chrono::duration<double>(Clock::now() - begin_).count();
+                ThreadPhases::end_(phaseIdx_, dt/static_cast<double>(std::max<std::size_t>(workSize_, 1)));
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /*!
+         * \brief The number of threads which ought to execute the region.
+         */
+        int numThreads() const
+        { return numThreads_; }
+
+    private:
+        unsigned phaseIdx_;
+        std::size_t workSize_;
+        int numThreads_;
+        bool tuning_;
+        Clock::time_point begin_;
+    };
+
+    /*!
+     * \brief Specify the configuration of the phases.
+     *
+     * \param maxThreads The number of threads of the process
+     * \param settings The explicit configurations of the phases, see the description of
+     *                 the class
+     * \param autoTune Tune the phases which are not configured explicitly
+     */
+    static void configure(int maxThreads, const std::string& settings, bool autoTune)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        state.maxThreads = std::max(1, maxThreads);
+        state.settings = settings;
+        state.autoTune = autoTune;
+
+        // check the syntax right away
+        std::istringstream is(settings);
+        std::string entry;
+        while (std::getline(is, entry, ','))
+            if (entry.find_first_not_of(" ") != std::string::npos)
+                parseEntry_(entry);
+
+        for (auto& phase : state.phases)
+            initPhase_(state, phase);
+    }
+
+    /*!
+     * \brief Returns the index of a phase, the phase is registered if it is unknown.
+     *
+     * \param name The name of the phase
+     * \param scheduled True if the regions of the phase are loops whose schedule can be
+     *                  chosen, false if only the number of threads can be chosen
+     */
+    static unsigned phaseIndex(const std::string& name, bool scheduled)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        for (unsigned phaseIdx = 0; phaseIdx < state.phases.size(); ++phaseIdx)
+            if (state.phases[phaseIdx].name == name)
+                return phaseIdx;
+
+        state.phases.emplace_back();
+        Phase& phase = state.phases.back();
+        phase.name = name;
+        phase.scheduled = scheduled;
+        initPhase_(state, phase);
+        return static_cast<unsigned>(state.phases.size() - 1);
+    }
+
+    /*!
+     * \brief Print the configuration of all phases if any of them was configured
+     *        explicitly or tuned.
+     */
+    static void printSummary(std::ostream& os)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        if (state.phases.empty() || (!state.autoTune && state.settings.empty()))
+            return;
+
+        os << "Configuration of the parallel phases (" << (state.autoTune ? "" : "not ")
+           << "tuned automatically):\n";
+        for (const auto& phase : state.phases) {
+            os << "    " << phase.name << "=" << phase.config.numThreads;
+            if (phase.scheduled)
+                os << ":" << scheduleName_(phase.config.schedule)
+                   << ":" << phase.config.chunkSize;
+            if (!phase.fixed)
+                os << " (still being tuned)";
+            os << "\n";
+        }
+    }
+
+private:
+    static State& state_()
+    {
+        static State state;
+        return state;
+    }
+
+    static const char* scheduleName_(Schedule schedule)
+    {
+        switch (schedule) {
+        case Schedule::Dynamic: return "dynamic";
+        case Schedule::Guided: return "guided";
+        default: return "static";
+        }
+    }
+
+    // parse an entry of the settings. returns the name of the phase
+    static std::string parseEntry_(const std::string& entry, Config* config = nullptr)
+    {
+        std::size_t eqPos = entry.find('=');
+        if (eqPos == std::string::npos)
+            throw std::invalid_argument("Invalid configuration '"+entry+"' of a parallel "
+                                        "phase (expected 'phase=threads[:schedule[:chunk]]')");
+
+        std::string name = entry.substr(0, eqPos);
+        name.erase(0, name.find_first_not_of(" "));
+        name.erase(name.find_last_not_of(" ") + 1);
+
+        std::vector<std::string> fields;
+        std::istringstream is(entry.substr(eqPos + 1));
+        std::string field;
+        while (std::getline(is, field, ':'))
+            fields.push_back(field);
+
+        Config result;
+        try {
+            if (fields.empty() || fields.size() > 3)
+                throw std::invalid_argument("");
+            result.numThreads = std::stoi(fields[0]);
+            if (result.numThreads < 0)
+                throw std::invalid_argument("");
+            if (fields.size() > 1) {
+                std::string schedule = fields[1];
+                schedule.erase(0, schedule.find_first_not_of(" "));
+                schedule.erase(schedule.find_last_not_of(" ") + 1);
+                if (schedule == "static")
+                    result.schedule = Schedule::Static;
+                else if (schedule == "dynamic")
+                    result.schedule = Schedule::Dynamic;
+                else if (schedule == "guided")
+                    result.schedule = Schedule::Guided;
+                else
+                    throw std::invalid_argument("");
+            }
+            if (fields.size() > 2)
+                result.chunkSize = std::stoi(fields[2]);
+        }
+        catch (const std::exception&) {
+            throw std::invalid_argument("Invalid configuration '"+entry+"' of a parallel "
+                                        "phase (expected 'phase=threads[:schedule[:chunk]]')");
+        }
+
+        if (config)
+            *config = result;
+        return name;
+    }
+
+    static void initPhase_(const State& state, Phase& phase)
+    {
+        phase.config = Config();
+        phase.config.numThreads = state.maxThreads;
+        phase.fixed = true;
+        phase.candidates.clear();
+        phase.bestTimes.clear();
+        phase.candidateIdx = 0;
+        phase.trialIdx = 0;
+
+        // the last explicit configuration of the phase takes precedence
+        bool explicitConfig = false;
+        std::istringstream is(state.settings);
+        std::string entry;
+        while (std::getline(is, entry, ',')) {
+            if (entry.find_first_not_of(" ") == std::string::npos)
+                continue;
+            Config config;
+            if (parseEntry_(entry, &config) == phase.name) {
+                phase.config = config;
+                explicitConfig = true;
+            }
+        }
+
+        if (explicitConfig) {
+            if (phase.config.numThreads == 0 || phase.config.numThreads > state.maxThreads)
+                phase.config.numThreads = state.maxThreads;
+            return;
+        }
+
+        if (!state.autoTune)
+            return;
+
+        // the candidates are all powers of two of the number of threads and, for loops,
+        // the kinds of schedules
+        std::vector<int> threadCounts;
+        for (int n = state.maxThreads; n > 1; n /= 2)
+            threadCounts.push_back(n);
+        threadCounts.push_back(1);
+
+        for (int n : threadCounts) {
+            Config config;
+            config.numThreads = n;
+            phase.candidates.push_back(config);
+            if (phase.scheduled && n > 1) {
+                config.schedule = Schedule::Dynamic;
+                config.chunkSize = 64;
+                phase.candidates.push_back(config);
+                config.schedule = Schedule::Guided;
+                config.chunkSize = 0;
+                phase.candidates.push_back(config);
+            }
+        }
+
+        phase.bestTimes.assign(phase.candidates.size(), std::numeric_limits<double>::max());
+        phase.fixed = phase.candidates.size() < 2;
+        if (!phase.fixed)
+            phase.config = phase.candidates[0];
+    }
+
+    static Config begin_(unsigned phaseIdx, bool& tuning)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        const Phase& phase = state.phases[phaseIdx];
+        tuning = !phase.fixed;
+        return phase.config;
+    }
+
+    // record the time of an execution of a phase and move on to the next candidate if
+    // the current one has been measured often enough. the fastest of the executions of
+    // a candidate is considered to be insensitive to noise.
+    static void end_(unsigned phaseIdx, double timePerWork)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        Phase& phase = state.phases[phaseIdx];
+        if (phase.fixed)
+            return;
+
+        double& bestTime = phase.bestTimes[phase.candidateIdx];
+        bestTime = std::min(bestTime, timePerWork);
+        if (++phase.trialIdx < numTrials)
+            return;
+
+        phase.trialIdx = 0;
+        if (++phase.candidateIdx < phase.candidates.size()) {
+            phase.config = phase.candidates[phase.candidateIdx];
+            return;
+        }
+
+        auto bestIt = std::min_element(phase.bestTimes.begin(), phase.bestTimes.end());
+        phase.config = phase.candidates[static_cast<std::size_t>(bestIt - phase.bestTimes.begin())];
+        phase.fixed = true;
+        phase.candidates.clear();
+        phase.bestTimes.clear();
+    }
+};
+
+} // namespace Opm
+
+#endif
@@ -101,9 +101,14 @@ public:
                         unsigned dofIdx,
                         unsigned timeIdx) const
     {
+        // the saturations of the phases which are not present are constant zero, so
+        // they do neither contribute to the storage term nor to its derivatives
+        const auto& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
+
         storage = 0.0;
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
-            addPhaseStorage(storage, elemCtx, dofIdx, timeIdx, phaseIdx);
+            if (priVars.phaseIsPresent(phaseIdx))
+                addPhaseStorage(storage, elemCtx, dofIdx, timeIdx, phaseIdx);
 
         EnergyModule::addSolidEnergyStorage(storage, elemCtx.intensiveQuantities(dofIdx, timeIdx));
     }
@@ -136,6 +141,10 @@ public:
 
         unsigned focusDofIdx = elemCtx.focusDofIndex();
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            // immobile phases do not transport anything
+            if (extQuants.phaseIsImmobile(phaseIdx))
+                continue;
+
             // data attached to upstream and the downstream DOFs
             // of the current phase
             unsigned upIdx = static_cast<unsigned>(extQuants.upstreamIndex(phaseIdx));
@@ -360,6 +360,16 @@ public:
         numSwitched_ = 0;
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::extrapolationAllowed_
+     */
+    bool extrapolationAllowed_(const PrimaryVariables& priVars,
+                               const PrimaryVariables& prevPriVars) const
+    {
+        // the meaning of the primary variables depends on the present phases
+        return priVars.phasePresence() == prevPriVars.phasePresence();
+    }
+
     /*!
      * \copydoc FvBaseDiscretization::updateBegin
      */
@@ -449,8 +459,8 @@ public:
     /*!
      * \copydoc FvBaseDiscretization::serializeEntity
      */
-    template <class DofEntity>
-    void serializeEntity(std::ostream& outstream, const DofEntity& dofEntity)
+    template <class Stream, class DofEntity>
+    void serializeEntity(Stream& outstream, const DofEntity& dofEntity)
     {
         // write primary variables
         ParentType::serializeEntity(outstream, dofEntity);
@@ -465,8 +475,8 @@ public:
     /*!
      * \copydoc FvBaseDiscretization::deserializeEntity
      */
-    template <class DofEntity>
-    void deserializeEntity(std::istream& instream, const DofEntity& dofEntity)
+    template <class Stream, class DofEntity>
+    void deserializeEntity(Stream& instream, const DofEntity& dofEntity)
     {
         // read primary variables
         ParentType::deserializeEntity(instream, dofEntity);
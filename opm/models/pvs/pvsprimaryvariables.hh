@@ -259,15 +259,9 @@ public:
             // non-present phases have saturation 0
             return 0.0;
 
+        // the saturations of previous time levels do not carry any derivatives
         unsigned varIdx = switch0Idx + phaseIdx - 1;
-        if (std::is_same<Evaluation, Scalar>::value)
-            return (*this)[varIdx]; // finite differences
-        else {
-            // automatic differentiation
-            if (timeIdx != 0)
-                Toolbox::createConstant((*this)[varIdx]);
-            return Toolbox::createVariable((*this)[varIdx], varIdx);
-        }
+        return this->makeEvaluation(varIdx, timeIdx);
     }
 
     /*!
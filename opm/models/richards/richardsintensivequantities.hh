@@ -142,9 +142,10 @@ public:
         // relperms
         MaterialLaw::relativePermeabilities(relativePermeability_, materialParams, fluidState_);
 
-        // mobilities
-        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
-            mobility_[phaseIdx] = relativePermeability_[phaseIdx]/fluidState_.viscosity(phaseIdx);
+        // mobilities. only the one of the liquid phase is required because the
+        // gas phase is not considered by the model
+        mobility_[liquidPhaseIdx] = relativePermeability_[liquidPhaseIdx]/mu;
+        mobility_[gasPhaseIdx] = 0.0;
 
         // porosity
         porosity_ = problem.porosity(elemCtx, dofIdx, timeIdx);
@@ -110,6 +110,32 @@ struct GridGlobalRefinements { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct ParameterFile { using type = UndefinedProperty; };
 
+//! Property provides the name of the file which specifies the members of an
+//! ensemble of simulations which are run in the same process
+template<class TypeTag, class MyTypeTag>
+struct EnsembleFile { using type = UndefinedProperty; };
+
+//! The name of the file which specifies the levels of a multi-level Monte Carlo
+//! estimation
+template<class TypeTag, class MyTypeTag>
+struct MlmcLevelsFile { using type = UndefinedProperty; };
+
+//! The name of the parameter which receives the index of a Monte Carlo sample
+template<class TypeTag, class MyTypeTag>
+struct MlmcSampleParameter { using type = UndefinedProperty; };
+
+//! The targeted standard deviation of the multi-level Monte Carlo estimator
+template<class TypeTag, class MyTypeTag>
+struct MlmcTargetError { using type = UndefinedProperty; };
+
+//! The number of samples per level used to estimate its variance and cost
+template<class TypeTag, class MyTypeTag>
+struct MlmcInitialSamples { using type = UndefinedProperty; };
+
+//! The maximum number of samples per level
+template<class TypeTag, class MyTypeTag>
+struct MlmcMaxSamples { using type = UndefinedProperty; };
+
 /*!
  * \brief Print all properties on startup?
  *
@@ -140,10 +166,76 @@ struct InitialTimeStepSize { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct RestartTime { using type = UndefinedProperty; };
 
+//! Write restart files using the binary format which is shared by all processes
+template<class TypeTag, class MyTypeTag>
+struct EnableBinaryRestart { using type = UndefinedProperty; };
+
+//! Write binary restart files in a separate thread while the simulation continues
+template<class TypeTag, class MyTypeTag>
+struct EnableAsyncRestartOutput { using type = UndefinedProperty; };
+
+//! The maximum number of asynchronous output tasklets which have not been completed
+template<class TypeTag, class MyTypeTag>
+struct MaxPendingOutputTasklets { using type = UndefinedProperty; };
+
+//! The number of delta restart files which are written after each full binary one
+template<class TypeTag, class MyTypeTag>
+struct DeltaRestartInterval { using type = UndefinedProperty; };
+
 //! The name of the file with a number of forced time step lengths
 template<class TypeTag, class MyTypeTag>
 struct PredeterminedTimeStepsFile { using type = UndefinedProperty; };
 
+//! Record the time spent in the instrumented regions of the code
+template<class TypeTag, class MyTypeTag>
+struct EnableInstrumentation { using type = UndefinedProperty; };
+
+//! Record a timeline of the phases of the simulation for each thread
+template<class TypeTag, class MyTypeTag>
+struct EnableEventTrace { using type = UndefinedProperty; };
+
+//! The name of the file to which the timeline of the simulation is written
+template<class TypeTag, class MyTypeTag>
+struct EventTraceFile { using type = UndefinedProperty; };
+
+//! The maximum number of events of the timeline which are kept per thread
+template<class TypeTag, class MyTypeTag>
+struct EventTraceBufferSize { using type = UndefinedProperty; };
+
+//! Compile the lightweight timers into the code which is supposed to be timed at a
+//! fine granularity
+template<class TypeTag, class MyTypeTag>
+struct EnableLightweightTimers { using type = UndefinedProperty; };
+
+//! Count hardware events like cycles and cache misses for the phases of the Newton
+//! method
+template<class TypeTag, class MyTypeTag>
+struct EnablePerfCounters { using type = UndefinedProperty; };
+
+//! The name of the file to which the results of the instrumentation are written
+template<class TypeTag, class MyTypeTag>
+struct InstrumentationOutputFile { using type = UndefinedProperty; };
+
+//! The number of time slices of the Parareal algorithm
+template<class TypeTag, class MyTypeTag>
+struct PararealSlices { using type = UndefinedProperty; };
+
+//! The maximum number of Parareal iterations
+template<class TypeTag, class MyTypeTag>
+struct PararealMaxIterations { using type = UndefinedProperty; };
+
+//! The relative change of the slice states at which Parareal is converged
+template<class TypeTag, class MyTypeTag>
+struct PararealTolerance { using type = UndefinedProperty; };
+
+//! The number of time steps per slice of the coarse Parareal propagator
+template<class TypeTag, class MyTypeTag>
+struct PararealCoarseTimeSteps { using type = UndefinedProperty; };
+
+//! The factor by which the Newton tolerance of the coarse Parareal propagator is larger
+template<class TypeTag, class MyTypeTag>
+struct PararealCoarseToleranceFactor { using type = UndefinedProperty; };
+
 //! domain size
 template<class TypeTag, class MyTypeTag>
 struct DomainSizeX { using type = UndefinedProperty; };
@@ -164,6 +256,14 @@ struct CellsZ { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct GridFile { using type = UndefinedProperty; };
 
+//! Cache the grid read from the grid file in a binary file to speed up later runs
+template<class TypeTag, class MyTypeTag>
+struct EnableGridCache { using type = UndefinedProperty; };
+
+//! The relative cost of elements cut by a fracture used for load balancing
+template<class TypeTag, class MyTypeTag>
+struct FractureElementLoadWeight { using type = UndefinedProperty; };
+
 //! level of the grid view
 template<class TypeTag, class MyTypeTag>
 struct GridViewLevel { using type = UndefinedProperty; };
@@ -210,6 +310,18 @@ struct ModelParameterGroup<TypeTag, TTag::NumericModel> { static constexpr auto
 template<class TypeTag>
 struct GridFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
 
+//! Do not cache grids by default, this requires a grid with an unstructured grid factory
+template<class TypeTag>
+struct EnableGridCache<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! Elements cut by fractures are as expensive as all others by default
+template<class TypeTag>
+struct FractureElementLoadWeight<TypeTag, TTag::NumericModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1.0;
+};
+
 #if HAVE_DUNE_FEM
 template<class TypeTag>
 struct GridPart<TypeTag, TTag::NumericModel>
@@ -233,6 +345,26 @@ struct GridView<TypeTag, TTag::NumericModel> { using type = typename GetPropType
 template<class TypeTag>
 struct ParameterFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
 
+//! By default, a single simulation is run
+template<class TypeTag>
+struct EnsembleFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
+
+//! By default, no multi-level Monte Carlo estimation is done
+template<class TypeTag>
+struct MlmcLevelsFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
+
+template<class TypeTag>
+struct MlmcSampleParameter<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
+
+template<class TypeTag>
+struct MlmcTargetError<TypeTag, TTag::NumericModel> { static constexpr double value = 1e-2; };
+
+template<class TypeTag>
+struct MlmcInitialSamples<TypeTag, TTag::NumericModel> { static constexpr unsigned value = 10; };
+
+template<class TypeTag>
+struct MlmcMaxSamples<TypeTag, TTag::NumericModel> { static constexpr unsigned value = 10000; };
+
 //! Set the number of refinement levels of the grid to 0. This does not belong
 //! here, strictly speaking.
 template<class TypeTag>
@@ -270,10 +402,78 @@ struct RestartTime<TypeTag, TTag::NumericModel>
     static constexpr type value = -1e35;
 };
 
+//! By default, restart files are written using the text format
+template<class TypeTag>
+struct EnableBinaryRestart<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, restart files are written by the main thread
+template<class TypeTag>
+struct EnableAsyncRestartOutput<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, the simulation waits once four output tasklets are pending
+template<class TypeTag>
+struct MaxPendingOutputTasklets<TypeTag, TTag::NumericModel> { static constexpr unsigned value = 4; };
+
+//! By default, all restart files are complete
+template<class TypeTag>
+struct DeltaRestartInterval<TypeTag, TTag::NumericModel> { static constexpr unsigned value = 0; };
+
 //! By default, do not force any time steps
 template<class TypeTag>
 struct PredeterminedTimeStepsFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
 
+//! By default, the code is not instrumented
+template<class TypeTag>
+struct EnableInstrumentation<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, no timeline is recorded
+template<class TypeTag>
+struct EnableEventTrace<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, the timeline is written to a file named after the problem
+template<class TypeTag>
+struct EventTraceFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
+
+//! By default, the last 65536 events of each thread are kept
+template<class TypeTag>
+struct EventTraceBufferSize<TypeTag, TTag::NumericModel> { static constexpr unsigned value = 65536; };
+
+//! By default, the lightweight timers are compiled out
+template<class TypeTag>
+struct EnableLightweightTimers<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, no hardware events are counted
+template<class TypeTag>
+struct EnablePerfCounters<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
+//! By default, the results of the instrumentation are only printed to the terminal
+template<class TypeTag>
+struct InstrumentationOutputFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
+
+//! By default, the simulation is not parallelized in time
+template<class TypeTag>
+struct PararealSlices<TypeTag, TTag::NumericModel> { static constexpr unsigned value = 1; };
+
+template<class TypeTag>
+struct PararealMaxIterations<TypeTag, TTag::NumericModel> { static constexpr unsigned value = 5; };
+
+template<class TypeTag>
+struct PararealTolerance<TypeTag, TTag::NumericModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1e-4;
+};
+
+template<class TypeTag>
+struct PararealCoarseTimeSteps<TypeTag, TTag::NumericModel> { static constexpr unsigned value = 1; };
+
+template<class TypeTag>
+struct PararealCoarseToleranceFactor<TypeTag, TTag::NumericModel>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 10.0;
+};
+
 
 } // namespace Opm::Properties
 
@@ -0,0 +1,248 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::CompressedBlockVector
+ */
+#ifndef EWOMS_COMPRESSED_BLOCK_VECTOR_HH
+#define EWOMS_COMPRESSED_BLOCK_VECTOR_HH
+
+#include <dune/common/fvector.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \ingroup Common
+ *
+ * \brief Keeps a copy of a block vector in a compressed form.
+ *
+ * Two kinds of compression are available:
+ *
+ * - Float: The entries of the blocks are rounded to single precision. Any data of the
+ *   blocks besides the entries, e.g. the meaning of the primary variables, is kept
+ *   exactly.
+ * - Delta: Lossless. Each 64 bit word of a block is XOR-ed with the corresponding word
+ *   of the preceding block and only the bytes which are not zero after this are
+ *   stored. This works well if the blocks vary smoothly along the vector.
+ *
+ * The blocks must be trivially copyable because their bytes are copied directly.
+ */
+template <class BlockVector>
+class CompressedBlockVector
+{
+    using Block = typename BlockVector::block_type;
+    using Scalar = typename Block::field_type;
+    static constexpr unsigned numEntries = Block::dimension;
+
+    // the entries of a block are followed by the remaining data of the block, e.g. the
+    // meaning of the primary variables
+    static constexpr size_t valueBytes = sizeof(Dune::FieldVector<Scalar, numEntries>);
+    static constexpr size_t tailBytes = sizeof(Block) - valueBytes;
+
+public:
+    enum class Mode { Float, Delta };
+
+    /*!
+     * \brief Returns true if blocks of the vector's type can be compressed.
+     */
+    static constexpr bool supported()
+    { return std::is_trivially_copyable<Block>::value; }
+
+    /*!
+     * \brief Convert the name of a compression mode to the mode.
+     */
+    static Mode modeFromString(const std::string& name)
+    {
+        if (name == "float")
+            return Mode::Float;
+        if (name == "delta")
+            return Mode::Delta;
+        throw std::invalid_argument("Unknown compression mode '"+name+"' (expected "
+                                    "'float' or 'delta')");
+    }
+
+    /*!
+     * \brief Replace the contents by the compressed copy of a block vector.
+     */
+    void compress(const BlockVector& src, Mode mode)
+    {
+        static_assert(supported(), "The blocks must be trivially copyable");
+
+        clear();
+        mode_ = mode;
+        size_ = src.size();
+        if (mode_ == Mode::Float)
+            values_.reserve(size_*numEntries);
+
+        Block zero;
+        std::memset(static_cast<void*>(&zero), 0, sizeof(Block));
+        const Block* prev = &zero;
+        for (size_t blockIdx = 0; blockIdx < size_; ++blockIdx) {
+            const Block& cur = src[blockIdx];
+            if (mode_ == Mode::Float) {
+                for (unsigned i = 0; i < numEntries; ++i)
+                    values_.push_back(static_cast<float>(cur[i]));
+                encode_(bytes_(cur) + valueBytes, bytes_(*prev) + valueBytes, tailBytes);
+            }
+            else
+                encode_(bytes_(cur), bytes_(*prev), sizeof(Block));
+            prev = &cur;
+        }
+
+        values_.shrink_to_fit();
+        headers_.shrink_to_fit();
+        payload_.shrink_to_fit();
+    }
+
+    /*!
+     * \brief Restore the block vector from the compressed copy.
+     *
+     * The destination vector is resized to the size of the compressed one.
+     */
+    void decompress(BlockVector& dst) const
+    {
+        dst.resize(size_);
+
+        size_t wordIdx = 0;
+        size_t payloadIdx = 0;
+        Block zero;
+        std::memset(static_cast<void*>(&zero), 0, sizeof(Block));
+        const Block* prev = &zero;
+        for (size_t blockIdx = 0; blockIdx < size_; ++blockIdx) {
+            Block& cur = dst[blockIdx];
+            if (mode_ == Mode::Float) {
+                decode_(bytes_(cur) + valueBytes, bytes_(*prev) + valueBytes, tailBytes,
+                        wordIdx, payloadIdx);
+                for (unsigned i = 0; i < numEntries; ++i)
+                    cur[i] = values_[blockIdx*numEntries + i];
+            }
+            else
+                decode_(bytes_(cur), bytes_(*prev), sizeof(Block), wordIdx, payloadIdx);
+            prev = &cur;
+        }
+    }
+
+    /*!
+     * \brief Release the compressed data.
+     */
+    void clear()
+    {
+        size_ = 0;
+        std::vector<float>().swap(values_);
+        std::vector<std::uint8_t>().swap(headers_);
+        std::vector<std::uint8_t>().swap(payload_);
+        numWords_ = 0;
+    }
+
+    /*!
+     * \brief Returns the number of blocks of the compressed vector.
+     */
+    size_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Returns the number of bytes held by the compressed data.
+     */
+    size_t memoryUsage() const
+    {
+        return values_.capacity()*sizeof(float)
+            + headers_.capacity()
+            + payload_.capacity();
+    }
+
+private:
+    static const unsigned char* bytes_(const Block& block)
+    { return reinterpret_cast<const unsigned char*>(&block); }
+
+    static unsigned char* bytes_(Block& block)
+    { return reinterpret_cast<unsigned char*>(&block); }
+
+    // store the words of a byte range XOR-ed with the ones of a reference. for each
+    // word, the number of its significant bytes is stored in a half byte of the
+    // headers, followed by these bytes in the payload.
+    void encode_(const unsigned char* cur, const unsigned char* ref, size_t numBytes)
+    {
+        for (size_t offset = 0; offset < numBytes; offset += 8) {
+            size_t wordBytes = std::min<size_t>(8, numBytes - offset);
+            std::uint64_t curWord = 0, refWord = 0;
+            std::memcpy(&curWord, cur + offset, wordBytes);
+            std::memcpy(&refWord, ref + offset, wordBytes);
+            std::uint64_t delta = curWord ^ refWord;
+
+            unsigned numSignificant = 0;
+            for (std::uint64_t tmp = delta; tmp != 0; tmp >>= 8)
+                ++numSignificant;
+
+            if (numWords_%2 == 0)
+                headers_.push_back(static_cast<std::uint8_t>(numSignificant));
+            else
+                headers_.back() |= static_cast<std::uint8_t>(numSignificant << 4);
+            ++numWords_;
+
+            for (unsigned i = 0; i < numSignificant; ++i)
+                payload_.push_back(static_cast<std::uint8_t>(delta >> (8*i)));
+        }
+    }
+
+    void decode_(unsigned char* cur,
+                 const unsigned char* ref,
+                 size_t numBytes,
+                 size_t& wordIdx,
+                 size_t& payloadIdx) const
+    {
+        for (size_t offset = 0; offset < numBytes; offset += 8) {
+            size_t wordBytes = std::min<size_t>(8, numBytes - offset);
+            unsigned numSignificant = (headers_[wordIdx/2] >> (4*(wordIdx%2))) & 0xf;
+            ++wordIdx;
+
+            std::uint64_t delta = 0;
+            for (unsigned i = 0; i < numSignificant; ++i)
+                delta |= static_cast<std::uint64_t>(payload_[payloadIdx++]) << (8*i);
+
+            std::uint64_t refWord = 0;
+            std::memcpy(&refWord, ref + offset, wordBytes);
+            std::uint64_t curWord = refWord ^ delta;
+            std::memcpy(cur + offset, &curWord, wordBytes);
+        }
+    }
+
+    Mode mode_ = Mode::Delta;
+    size_t size_ = 0;
+    size_t numWords_ = 0;
+    std::vector<float> values_;
+    std::vector<std::uint8_t> headers_;
+    std::vector<std::uint8_t> payload_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,95 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::DeferredConstructionAllocator
+ */
+#ifndef EWOMS_DEFERRED_CONSTRUCTION_ALLOCATOR_HH
+#define EWOMS_DEFERRED_CONSTRUCTION_ALLOCATOR_HH
+
+#include <opm/models/utils/alignedallocator.hh>
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace Opm {
+
+/*!
+ * \brief An aligned allocator which does not default construct the objects of a
+ *        container.
+ *
+ * If the size of a std::vector which uses this allocator is increased by resize(), the
+ * new objects are not constructed. Instead, the user must construct each of them
+ * afterwards via constructDeferred(). This allows to construct the objects in the
+ * threads which later work on them, i.e., the memory pages of large arrays get
+ * "first-touched" by these threads and thus on multi-socket machines they are placed
+ * in the memory of the NUMA node on which the threads run.
+ *
+ * All other ways of constructing objects (copying, moving, etc.) are not affected.
+ */
+template <class T, std::size_t Alignment>
+class DeferredConstructionAllocator : public aligned_allocator<T, Alignment>
+{
+public:
+    template<class U>
+    struct rebind {
+        using other = DeferredConstructionAllocator<U, Alignment>;
+    };
+
+    DeferredConstructionAllocator() noexcept = default;
+
+    template<class U>
+    DeferredConstructionAllocator(const DeferredConstructionAllocator<U, Alignment>&) noexcept
+    { }
+
+    using aligned_allocator<T, Alignment>::construct;
+
+    template<class U>
+    void construct(U*)
+    { /* deferred, see constructDeferred() */ }
+
+    /*!
+     * \brief Default construct an object for which the construction was deferred.
+     */
+    template<class U>
+    static void constructDeferred(U* ptr)
+    {
+        void* p = ptr;
+        ::new(p) U();
+    }
+};
+
+template<class T1, class T2, std::size_t Alignment>
+inline bool operator==(const DeferredConstructionAllocator<T1, Alignment>&,
+                       const DeferredConstructionAllocator<T2, Alignment>&) noexcept
+{ return true; }
+
+template<class T1, class T2, std::size_t Alignment>
+inline bool operator!=(const DeferredConstructionAllocator<T1, Alignment>&,
+                       const DeferredConstructionAllocator<T2, Alignment>&) noexcept
+{ return false; }
+
+} // namespace Opm
+
+#endif
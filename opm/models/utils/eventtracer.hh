@@ -0,0 +1,257 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::EventTracer
+ */
+#ifndef EWOMS_EVENT_TRACER_HH
+#define EWOMS_EVENT_TRACER_HH
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \ingroup Common
+ *
+ * \brief Records the begin and the end of events on a timeline and writes them in the
+ *        trace event format of Chrome and Perfetto.
+ *
+ * In contrast to the Instrumentation, which accumulates the time spent in regions, the
+ * tracer keeps the individual events of each thread, so the order of the events, the
+ * idle time of the threads and the load imbalance between them become visible.
+ *
+ * Each thread writes its events into a ring buffer of its own, so recording an event
+ * does not involve any locks. If a buffer is full, the oldest events of the thread are
+ * overwritten. The names and the categories of the events must be string literals
+ * because only the pointers are stored.
+ *
+ * The tracer is disabled by default. In this case, recording an event only costs a
+ * single check of a flag.
+ *
+ * Usage:
+ * \code
+ * {
+ *     Opm::EventTracer::Scope traceScope("my event", "my category");
+ *     // code which should show up on the timeline
+ * }
+ * \endcode
+ */
+class EventTracer
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        Clock::time_point begin;
+        Clock::time_point end;
+    };
+
+    struct ThreadBuffer
+    {
+        std::vector<Event> events;
+        std::atomic<std::uint64_t> numRecorded{0};
+    };
+
+    struct State
+    {
+        std::atomic<bool> enabled{false};
+        std::mutex mutex;
+        std::size_t bufferSize = 65536;
+        Clock::time_point startTime = Clock::now();
+        std::vector<std::unique_ptr<ThreadBuffer> > threadBuffers;
+    };
+
+public:
+    using TimePoint = Clock::time_point;
+
+    /*!
+     * \brief Records an event which lasts from its construction to its destruction.
+     */
+    class Scope
+    {
+    public:
+        Scope(const char* name, const char* category)
+            : name_(name)
+            , category_(category)
+            , begin_(EventTracer::now())
+        { }
+
+        ~Scope()
+        { EventTracer::record(name_, category_, begin_); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name_;
+        const char* category_;
+        TimePoint begin_;
+    };
+
+    /*!
+     * \brief Returns true if events are recorded.
+     */
+    static bool enabled()
+    { return state_().enabled.load(std::memory_order_relaxed); }
+
+    /*!
+     * \brief Enable or disable recording events.
+     */
+    static void setEnabled(bool yesno)
+    { state_().enabled = yesno; }
+
+    /*!
+     * \brief Set the number of events which are kept per thread.
+     *
+     * This only affects the threads which did not record any event yet.
+     */
+    static void setBufferSize(std::size_t numEvents)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        state.bufferSize = std::max<std::size_t>(numEvents, 1);
+    }
+
+    /*!
+     * \brief Returns the current time if events are recorded.
+     *
+     * The result is supposed to be passed to record() as the begin of an event.
+     */
+    static TimePoint now()
+    { return enabled() ? Clock::now() : TimePoint(); }
+
+    /*!
+     * \brief Record an event of the calling thread which started at a given point in
+     *        time and ends now.
+     *
+     * \param name The name of the event, must be a string literal
+     * \param category The category of the event, must be a string literal
+     * \param begin The point in time at which the event began as returned by now()
+     */
+    static void record(const char* name, const char* category, TimePoint begin)
+    {
+        if (!enabled() || begin == TimePoint())
+            return;
+
+        ThreadBuffer& buffer = threadBuffer_();
+        std::uint64_t eventIdx = buffer.numRecorded.load(std::memory_order_relaxed);
+        Event& event = buffer.events[eventIdx % buffer.events.size()];
+        event.name = name;
+        event.category = category;
+        event.begin = begin;
+        event.end = Clock::now();
+        buffer.numRecorded.store(eventIdx + 1, std::memory_order_release);
+    }
+
+    /*!
+     * \brief Forget all recorded events.
+     *
+     * This must not be called while any other thread records events.
+     */
+    static void reset()
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        for (auto& buffer : state.threadBuffers)
+            buffer->numRecorded = 0;
+        state.startTime = Clock::now();
+    }
+
+    /*!
+     * \brief Write all recorded events in the JSON trace event format of Chrome and
+     *        Perfetto.
+     *
+     * This must not be called while any other thread records events.
+     *
+     * \param os The stream to which the trace is written
+     * \param processIdx The index of the process, e.g. its MPI rank
+     */
+    static void writeChromeTrace(std::ostream& os, int processIdx = 0)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+
+        bool first = true;
+        os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        for (unsigned threadIdx = 0; threadIdx < state.threadBuffers.size(); ++threadIdx) {
+            os << (first ? "" : ",") << "\n  {\"name\": \"thread_name\", \"ph\": \"M\", "
+               << "\"pid\": " << processIdx << ", \"tid\": " << threadIdx << ", "
+               << "\"args\": {\"name\": \"thread " << threadIdx << "\"}}";
+            first = false;
+
+            const auto& buffer = *state.threadBuffers[threadIdx];
+            std::uint64_t numRecorded = buffer.numRecorded.load(std::memory_order_acquire);
+            std::uint64_t capacity = buffer.events.size();
+            std::uint64_t firstIdx = (numRecorded > capacity) ? numRecorded - capacity : 0;
+            for (std::uint64_t eventIdx = firstIdx; eventIdx < numRecorded; ++eventIdx) {
+                const Event& event = buffer.events[eventIdx % capacity];
+                os << ",\n  {\"name\": \"" << event.name << "\", "
+                   << "\"cat\": \"" << event.category << "\", \"ph\": \"X\", "
+                   << "\"ts\": " << microseconds_(event.begin - state.startTime) << ", "
+                   << "\"dur\": " << microseconds_(event.end - event.begin) << ", "
+                   << "\"pid\": " << processIdx << ", \"tid\": " << threadIdx << "}";
+            }
+        }
+        os << "\n]}\n";
+    }
+
+private:
+    static State& state_()
+    {
+        static State state;
+        return state;
+    }
+
+    static double microseconds_(Clock::duration dt)
+    { return std::chrono::duration<double, std::micro>(dt).count(); }
+
+    // returns the ring buffer of the calling thread. it is created and registered on
+    // the first call of each thread.
+    static ThreadBuffer& threadBuffer_()
+    {
+        static thread_local ThreadBuffer* threadBuffer = nullptr;
+        if (!threadBuffer) {
+            auto& state = state_();
+            std::lock_guard<std::mutex> guard(state.mutex);
+            state.threadBuffers.emplace_back(new ThreadBuffer);
+            threadBuffer = state.threadBuffers.back().get();
+            threadBuffer->events.resize(state.bufferSize);
+        }
+        return *threadBuffer;
+    }
+};
+
+} // namespace Opm
+
+#endif
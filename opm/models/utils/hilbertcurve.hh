@@ -0,0 +1,101 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+/*!
+ * \file
+ * \copydoc Opm::hilbertIndex
+ */
+#ifndef EWOMS_HILBERT_CURVE_HH
+#define EWOMS_HILBERT_CURVE_HH
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+namespace Opm {
+
+/*!
+ * \brief Returns the position of a point of an integer lattice on the Hilbert
+ *        space-filling curve.
+ *
+ * The lattice has 2^numBits points in each of its dim directions. Points which are close
+ * to each other on the curve are also close to each other in space, so sorting objects
+ * by the Hilbert index of their position improves the locality of the data accessed by
+ * loops over these objects.
+ *
+ * This uses the algorithm of J. Skilling: "Programming the Hilbert curve", AIP Conf.
+ * Proc. 707, 2004.
+ *
+ * \param coords The coordinates of the lattice point. Each coordinate must be smaller
+ *               than 2^numBits.
+ * \param numBits The number of bits used for each coordinate. dim*numBits must not
+ *                exceed 64.
+ */
+template <unsigned dim>
+std::uint64_t hilbertIndex(std::array<std::uint32_t, dim> coords, unsigned numBits)
+{
+    assert(0 < numBits && numBits <= 32 && dim*numBits <= 64);
+
+    if (dim == 1)
+        return coords[0];
+
+    // convert the coordinates to the "transposed" Hilbert index
+    const std::uint32_t highestBit = std::uint32_t(1) << (numBits - 1);
+    for (std::uint32_t q = highestBit; q > 1; q >>= 1) {
+        std::uint32_t p = q - 1;
+        for (unsigned i = 0; i < dim; ++i) {
+            if (coords[i] & q)
+                // invert
+                coords[0] ^= p;
+            else {
+                // exchange
+                std::uint32_t t = (coords[0] ^ coords[i]) & p;
+                coords[0] ^= t;
+                coords[i] ^= t;
+            }
+        }
+    }
+
+    // Gray encode
+    for (unsigned i = 1; i < dim; ++i)
+        coords[i] ^= coords[i - 1];
+    std::uint32_t t = 0;
+    for (std::uint32_t q = highestBit; q > 1; q >>= 1)
+        if (coords[dim - 1] & q)
+            t ^= q - 1;
+    for (unsigned i = 0; i < dim; ++i)
+        coords[i] ^= t;
+
+    // interleave the bits of the transposed index
+    std::uint64_t result = 0;
+    for (int bitIdx = static_cast<int>(numBits) - 1; bitIdx >= 0; --bitIdx)
+        for (unsigned i = 0; i < dim; ++i)
+            result = (result << 1) | ((coords[i] >> bitIdx) & 1);
+
+    return result;
+}
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,378 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::Instrumentation
+ */
+#ifndef EWOMS_INSTRUMENTATION_HH
+#define EWOMS_INSTRUMENTATION_HH
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \ingroup Common
+ *
+ * \brief Lightweight instrumentation of named code regions.
+ *
+ * Each region accumulates the wall clock time spent in it and the number of times it
+ * was entered. Regions may also be used as plain event counters using addCount(), in
+ * which case no time is accumulated. The accumulators are kept separately for each thread, so instrumented
+ * code does not need any synchronization; they are merged when the results are
+ * collected. Regions may be nested, and the time of a region always includes the time
+ * of the regions nested within it.
+ *
+ * The instrumentation is disabled by default. In this case, entering a region only
+ * costs a single check of a flag.
+ *
+ * Usage:
+ * \code
+ * static const unsigned myRegionIdx = Opm::Instrumentation::regionIndex("my region");
+ * ...
+ * {
+ *     Opm::Instrumentation::Region region(myRegionIdx);
+ *     // code which should be measured
+ * }
+ * \endcode
+ */
+class Instrumentation
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Accumulator
+    {
+        double time = 0.0;
+        std::uint64_t count = 0;
+    };
+
+    struct ThreadData
+    {
+        std::vector<Accumulator> accumulators;
+    };
+
+    struct State
+    {
+        // the names of the built-in regions in the order of BuiltinRegion
+        State()
+            : regionNames{"intensive quantities",
+                          "flux computation",
+                          "local linearization",
+                          "global scatter",
+                          "preconditioner setup",
+                          "linear solver",
+                          "overlap synchronization",
+                          "overlap setup"}
+        { }
+
+        std::atomic<bool> enabled{false};
+        std::mutex mutex;
+        std::vector<std::string> regionNames;
+        std::vector<std::unique_ptr<ThreadData> > threadData;
+    };
+
+public:
+    /*!
+     * \brief The regions which are instrumented by the framework itself.
+     */
+    enum BuiltinRegion : unsigned {
+        intensiveQuantitiesRegion,
+        fluxRegion,
+        localLinearizationRegion,
+        globalScatterRegion,
+        preconditionerSetupRegion,
+        linearSolverRegion,
+        overlapSyncRegion,
+        overlapSetupRegion,
+        numBuiltinRegions
+    };
+
+    /*!
+     * \brief The merged results of a region.
+     */
+    struct RegionResult
+    {
+        std::string name;
+        double time;
+        std::uint64_t count;
+        std::vector<double> threadTime;
+        std::vector<std::uint64_t> threadCount;
+    };
+
+    /*!
+     * \brief Measures the time between its construction and its destruction.
+     */
+    class Region
+    {
+    public:
+        explicit Region(unsigned regionIdx)
+            : regionIdx_(regionIdx)
+            , active_(Instrumentation::enabled())
+        {
+            if (active_)
+                startTime_ = Clock::now();
+        }
+
+        ~Region()
+        {
+            if (active_) {
+                std::chrono::duration<double> dt = Clock::now() - startTime_;
+                Instrumentation::add(regionIdx_, dt.count());
+            }
+        }
+
+        Region(const Region&) = delete;
+        Region& operator=(const Region&) = delete;
+
+    private:
+        unsigned regionIdx_;
+        bool active_;
+        Clock::time_point startTime_;
+    };
+
+    /*!
+     * \brief Returns true if the time spent in regions is recorded.
+     */
+    static bool enabled()
+    { return state_().enabled.load(std::memory_order_relaxed); }
+
+    /*!
+     * \brief Enable or disable recording the time spent in regions.
+     */
+    static void setEnabled(bool yesno)
+    { state_().enabled = yesno; }
+
+    /*!
+     * \brief Returns the index of the region with a given name.
+     *
+     * If no such region exists yet, it is created. This method is thread safe, but it
+     * involves a lock, so its result should be stored, e.g., in a static variable.
+     */
+    static unsigned regionIndex(const std::string& name)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        for (unsigned regionIdx = 0; regionIdx < state.regionNames.size(); ++regionIdx)
+            if (state.regionNames[regionIdx] == name)
+                return regionIdx;
+
+        state.regionNames.push_back(name);
+        return static_cast<unsigned>(state.regionNames.size() - 1);
+    }
+
+    /*!
+     * \brief Returns the number of regions which have been created so far.
+     */
+    static unsigned numRegions()
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        return static_cast<unsigned>(state.regionNames.size());
+    }
+
+    /*!
+     * \brief Adds a time span to the accumulator of the calling thread for a region.
+     *
+     * \param regionIdx The index of the region as returned by regionIndex()
+     * \param seconds The wall clock time to be added
+     */
+    static void add(unsigned regionIdx, double seconds)
+    {
+        auto& accumulators = threadData_().accumulators;
+        if (accumulators.size() <= regionIdx)
+            accumulators.resize(regionIdx + 1);
+
+        accumulators[regionIdx].time += seconds;
+        ++ accumulators[regionIdx].count;
+    }
+
+    /*!
+     * \brief Adds a number of events to the accumulator of the calling thread for a
+     *        region without accounting any time.
+     *
+     * \param regionIdx The index of the region as returned by regionIndex()
+     * \param n The number of events
+     */
+    static void addCount(unsigned regionIdx, std::uint64_t n)
+    {
+        auto& accumulators = threadData_().accumulators;
+        if (accumulators.size() <= regionIdx)
+            accumulators.resize(regionIdx + 1);
+
+        accumulators[regionIdx].count += n;
+    }
+
+    /*!
+     * \brief Merge the accumulators of all threads.
+     *
+     * This must not be called while any other thread is within an instrumented region.
+     */
+    static std::vector<RegionResult> collect()
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+
+        size_t numThreads = state.threadData.size();
+        std::vector<RegionResult> results(state.regionNames.size());
+        for (unsigned regionIdx = 0; regionIdx < results.size(); ++regionIdx) {
+            auto& result = results[regionIdx];
+            result.name = state.regionNames[regionIdx];
+            result.time = 0.0;
+            result.count = 0;
+            result.threadTime.resize(numThreads, 0.0);
+            result.threadCount.resize(numThreads, 0);
+
+            for (unsigned threadIdx = 0; threadIdx < numThreads; ++threadIdx) {
+                const auto& accumulators = state.threadData[threadIdx]->accumulators;
+                if (regionIdx >= accumulators.size())
+                    continue;
+
+                result.threadTime[threadIdx] = accumulators[regionIdx].time;
+                result.threadCount[threadIdx] = accumulators[regionIdx].count;
+                result.time += accumulators[regionIdx].time;
+                result.count += accumulators[regionIdx].count;
+            }
+        }
+
+        return results;
+    }
+
+    /*!
+     * \brief Reset the accumulators of all threads.
+     *
+     * This must not be called while any other thread is within an instrumented region.
+     */
+    static void reset()
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        for (auto& threadData : state.threadData)
+            threadData->accumulators.clear();
+    }
+
+    /*!
+     * \brief Print a human readable summary of all regions which were entered.
+     */
+    static void printSummary(std::ostream& os)
+    {
+        const auto& results = collect();
+        os << "------------------ Instrumented regions ------------------\n";
+        for (const auto& result : results) {
+            if (result.count == 0)
+                continue;
+
+            if (result.time == 0.0) {
+                // event counters
+                os << "    " << result.name << ": " << result.count << " events\n";
+                continue;
+            }
+
+            os << "    " << result.name << ": " << result.time << " seconds in "
+               << result.count << " calls";
+            if (result.threadTime.size() > 1) {
+                os << " (per thread:";
+                for (double t : result.threadTime)
+                    os << " " << t;
+                os << ")";
+            }
+            os << "\n";
+        }
+        os << "Note: Times are wall clock times summed over all threads\n"
+           << "----------------------------------------------------------\n";
+    }
+
+    /*!
+     * \brief Write the results of all regions in the CSV format.
+     *
+     * There is one line per region and thread, plus one line with the merged results
+     * of all threads per region, for which the thread column is empty.
+     */
+    static void writeCsv(std::ostream& os)
+    {
+        const auto& results = collect();
+        os << "region,thread,time,count\n";
+        for (const auto& result : results) {
+            os << "\"" << result.name << "\",," << result.time << "," << result.count << "\n";
+            for (unsigned threadIdx = 0; threadIdx < result.threadTime.size(); ++threadIdx)
+                os << "\"" << result.name << "\"," << threadIdx << ","
+                   << result.threadTime[threadIdx] << ","
+                   << result.threadCount[threadIdx] << "\n";
+        }
+    }
+
+    /*!
+     * \brief Write the results of all regions in the JSON format.
+     */
+    static void writeJson(std::ostream& os)
+    {
+        const auto& results = collect();
+        os << "{\n  \"regions\": [";
+        for (unsigned regionIdx = 0; regionIdx < results.size(); ++regionIdx) {
+            const auto& result = results[regionIdx];
+            os << (regionIdx > 0 ? "," : "") << "\n    {"
+               << "\"name\": \"" << result.name << "\", "
+               << "\"time\": " << result.time << ", "
+               << "\"count\": " << result.count << ", "
+               << "\"threadTime\": [";
+            for (unsigned threadIdx = 0; threadIdx < result.threadTime.size(); ++threadIdx)
+                os << (threadIdx > 0 ? ", " : "") << result.threadTime[threadIdx];
+            os << "], \"threadCount\": [";
+            for (unsigned threadIdx = 0; threadIdx < result.threadCount.size(); ++threadIdx)
+                os << (threadIdx > 0 ? ", " : "") << result.threadCount[threadIdx];
+            os << "]}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+private:
+    static State& state_()
+    {
+        static State state;
+        return state;
+    }
+
+    // returns the accumulators of the calling thread. they are created and registered
+    // on the first call of each thread.
+    static ThreadData& threadData_()
+    {
+        static thread_local ThreadData* threadData = nullptr;
+        if (!threadData) {
+            auto& state = state_();
+            std::lock_guard<std::mutex> guard(state.mutex);
+            state.threadData.emplace_back(new ThreadData);
+            threadData = state.threadData.back().get();
+        }
+        return *threadData;
+    }
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,210 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::LightweightTimer
+ */
+#ifndef EWOMS_LIGHTWEIGHT_TIMER_HH
+#define EWOMS_LIGHTWEIGHT_TIMER_HH
+
+#include <chrono>
+#include <ctime>
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief A timer which is cheap enough to be used within per-element loops.
+ *
+ * In contrast to Opm::Timer, starting and stopping this timer only reads the monotonic
+ * wall clock (which does not involve a system call on common platforms). Optionally, the
+ * CPU time of the calling thread is measured as well; unlike std::clock(), this is not
+ * affected by the other threads of the process. The timer is not thread safe, i.e., each
+ * thread needs to use its own timer objects.
+ *
+ * If the template argument is false, all methods are no-ops which the compiler removes
+ * entirely. This is supposed to be controlled by the EnableLightweightTimers property:
+ * \code
+ * using ElementTimer = Opm::LightweightTimer<getPropValue<TypeTag, Properties::EnableLightweightTimers>()>;
+ * \endcode
+ */
+template <bool enabled = true>
+class LightweightTimer
+{
+    using Clock = std::chrono::steady_clock;
+
+public:
+    /*!
+     * \param measureCpuTime Specifies whether the CPU time of the calling thread should
+     *                       be measured in addition to the wall clock time
+     */
+    explicit LightweightTimer(bool measureCpuTime = false)
+        : measureCpuTime_(measureCpuTime)
+    { halt(); }
+
+    /*!
+     * \brief Start counting the time.
+     */
+    void start()
+    {
+        isStopped_ = false;
+        startTime_ = Clock::now();
+        if (measureCpuTime_)
+            startCpuTime_ = threadCpuTime_();
+    }
+
+    /*!
+     * \brief Stop counting the time.
+     *
+     * Returns the wall clock time the timer was active since the last reset.
+     */
+    double stop()
+    {
+        if (!isStopped_) {
+            std::chrono::duration<double> dt = Clock::now() - startTime_;
+            realTimeElapsed_ += dt.count();
+            if (measureCpuTime_)
+                cpuTimeElapsed_ += threadCpuTime_() - startCpuTime_;
+        }
+
+        isStopped_ = true;
+        return realTimeElapsed_;
+    }
+
+    /*!
+     * \brief Stop the measurement and reset all timing values.
+     */
+    void halt()
+    {
+        isStopped_ = true;
+        realTimeElapsed_ = 0.0;
+        cpuTimeElapsed_ = 0.0;
+    }
+
+    /*!
+     * \brief Make the current point in time t=0 but do not change the status of the timer.
+     */
+    void reset()
+    {
+        realTimeElapsed_ = 0.0;
+        cpuTimeElapsed_ = 0.0;
+        if (!isStopped_)
+            start();
+    }
+
+    /*!
+     * \brief Return the wall clock time [s] elapsed during the periods the timer was
+     *        active since the last reset.
+     */
+    double realTimeElapsed() const
+    {
+        if (isStopped_)
+            return realTimeElapsed_;
+
+        std::chrono::duration<double> dt = Clock::now() - startTime_;
+        return realTimeElapsed_ + dt.count();
+    }
+
+    /*!
+     * \brief Return the CPU time [s] used by the calling thread during the periods the
+     *        timer was active since the last reset.
+     *
+     * This is always zero if the CPU time is not measured.
+     */
+    double cpuTimeElapsed() const
+    {
+        if (isStopped_ || !measureCpuTime_)
+            return cpuTimeElapsed_;
+
+        return cpuTimeElapsed_ + threadCpuTime_() - startCpuTime_;
+    }
+
+    /*!
+     * \brief Adds the time of another timer to the current one.
+     */
+    LightweightTimer& operator+=(const LightweightTimer& other)
+    {
+        realTimeElapsed_ += other.realTimeElapsed();
+        cpuTimeElapsed_ += other.cpuTimeElapsed();
+        return *this;
+    }
+
+private:
+    static double threadCpuTime_()
+    {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<double>(ts.tv_sec) + 1e-9*static_cast<double>(ts.tv_nsec);
+#else
+        return static_cast<double>(std::clock())/CLOCKS_PER_SEC;
+#endif
+    }
+
+    bool measureCpuTime_;
+    bool isStopped_;
+    double realTimeElapsed_;
+    double cpuTimeElapsed_;
+    Clock::time_point startTime_;
+    double startCpuTime_;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief A lightweight timer which has been compiled out.
+ */
+template <>
+class LightweightTimer<false>
+{
+public:
+    explicit LightweightTimer(bool measureCpuTime = false)
+    { (void) measureCpuTime; }
+
+    void start()
+    {}
+
+    double stop()
+    { return 0.0; }
+
+    void halt()
+    {}
+
+    void reset()
+    {}
+
+    double realTimeElapsed() const
+    { return 0.0; }
+
+    double cpuTimeElapsed() const
+    { return 0.0; }
+
+    LightweightTimer& operator+=(const LightweightTimer&)
+    { return *this; }
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,181 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::MappedArray
+ */
+#ifndef EWOMS_MAPPED_ARRAY_HH
+#define EWOMS_MAPPED_ARRAY_HH
+
+#if defined(__unix__) || defined(__APPLE__)
+#define EWOMS_HAVE_MAPPED_ARRAY 1
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdlib.h>
+#else
+#define EWOMS_HAVE_MAPPED_ARRAY 0
+#endif
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \ingroup Common
+ *
+ * \brief A read-only array whose values are kept in a memory-mapped file.
+ *
+ * The values are written to a file in a given directory which is removed from the
+ * directory right away, i.e., the file vanishes once the array is cleared or the
+ * process terminates. Since the pages of the mapping are backed by the file, the
+ * operating system can evict them from the main memory if it is scarce and read them
+ * back on demand. This is intended for large arrays which are only read after the
+ * setup of a simulation. If the kernel supports it, transparent huge pages are
+ * requested for the mapping to reduce the pressure on the TLB.
+ *
+ * Mapping files is only supported on POSIX systems.
+ */
+template <class T>
+class MappedArray
+{
+public:
+    MappedArray() = default;
+
+    MappedArray(const MappedArray&) = delete;
+    MappedArray& operator=(const MappedArray&) = delete;
+
+    ~MappedArray()
+    { clear(); }
+
+    /*!
+     * \brief Returns true if arrays can be mapped on the current platform.
+     */
+    static constexpr bool supported()
+    { return EWOMS_HAVE_MAPPED_ARRAY; }
+
+    /*!
+     * \brief Replace the contents of the array by a copy of some values.
+     *
+     * \param values The values which are copied to the file
+     * \param directory The directory in which the file is created
+     */
+    void assign(const std::vector<T>& values, const std::string& directory)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Only trivially copyable values can be stored in a file");
+
+        clear();
+        if (values.empty())
+            return;
+
+#if EWOMS_HAVE_MAPPED_ARRAY
+        std::string fileTemplate = directory + "/ewoms-mapped-XXXXXX";
+        std::vector<char> fileName(fileTemplate.begin(), fileTemplate.end());
+        fileName.push_back('\0');
+        int fd = ::mkstemp(fileName.data());
+        if (fd < 0)
+            throw std::runtime_error("Could not create a file in '"+directory+"': "
+                                     + std::strerror(errno));
+        ::unlink(fileName.data());
+
+        size_t numBytes = values.size()*sizeof(T);
+        const char* src = reinterpret_cast<const char*>(values.data());
+        for (size_t offset = 0; offset < numBytes; ) {
+            ssize_t n = ::write(fd, src + offset, numBytes - offset);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0) {
+                int err = errno;
+                ::close(fd);
+                throw std::runtime_error("Could not write a file in '"+directory+"': "
+                                         + std::strerror(err));
+            }
+            offset += static_cast<size_t>(n);
+        }
+
+        void* addr = ::mmap(nullptr, numBytes, PROT_READ, MAP_SHARED, fd, 0);
+        int err = errno;
+        // the mapping keeps the file alive
+        ::close(fd);
+        if (addr == MAP_FAILED)
+            throw std::runtime_error("Could not map a file in '"+directory+"': "
+                                     + std::strerror(err));
+
+#ifdef MADV_HUGEPAGE
+        // this is only a hint which is not supported by all file systems
+        ::madvise(addr, numBytes, MADV_HUGEPAGE);
+#endif
+
+        data_ = static_cast<const T*>(addr);
+        size_ = values.size();
+#else
+        static_cast<void>(directory);
+        throw std::runtime_error("Memory-mapped arrays are not supported on this platform");
+#endif
+    }
+
+    /*!
+     * \brief Unmap the array.
+     */
+    void clear()
+    {
+#if EWOMS_HAVE_MAPPED_ARRAY
+        if (data_)
+            ::munmap(const_cast<T*>(data_), size_*sizeof(T));
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    /*!
+     * \brief Returns the value at a given index.
+     */
+    const T& operator[](size_t idx) const
+    { return data_[idx]; }
+
+    /*!
+     * \brief Returns the number of values.
+     */
+    size_t size() const
+    { return size_; }
+
+    /*!
+     * \brief Returns true if the array does not hold any values.
+     */
+    bool empty() const
+    { return size_ == 0; }
+
+private:
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,160 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::MemoryAccounting
+ */
+#ifndef EWOMS_MEMORY_ACCOUNTING_HH
+#define EWOMS_MEMORY_ACCOUNTING_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \ingroup Common
+ *
+ * \brief Keeps track of the memory held by the major data structures of a simulation.
+ *
+ * The owners of the data structures record the number of bytes they currently hold
+ * for a named subsystem, e.g. "Jacobian matrix". For each subsystem, the value at the
+ * end of the setup of the simulation and the high-water mark, i.e., the maximum of all
+ * recorded values, are kept. The values are only as current as the last time they were
+ * recorded; the simulator records them at the end of the setup and after each time
+ * step.
+ */
+class MemoryAccounting
+{
+    struct Entry
+    {
+        std::string name;
+        std::size_t current = 0;
+        std::size_t setup = 0;
+        std::size_t highWater = 0;
+    };
+
+    struct State
+    {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+    };
+
+public:
+    /*!
+     * \brief Record the number of bytes which are currently held by a subsystem.
+     */
+    static void record(const std::string& name, std::size_t bytes)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        Entry& entry = entry_(state, name);
+        entry.current = bytes;
+        entry.highWater = std::max(entry.highWater, bytes);
+    }
+
+    /*!
+     * \brief Take the currently recorded values as the ones at the end of the setup.
+     */
+    static void endSetup()
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        for (auto& entry : state.entries)
+            entry.setup = entry.current;
+    }
+
+    /*!
+     * \brief Returns the high-water mark of a subsystem in bytes.
+     */
+    static std::size_t highWater(const std::string& name)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        for (const auto& entry : state.entries)
+            if (entry.name == name)
+                return entry.highWater;
+        return 0;
+    }
+
+    /*!
+     * \brief Forget all recorded values.
+     */
+    static void reset()
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        state.entries.clear();
+    }
+
+    /*!
+     * \brief Print a human readable summary of all subsystems.
+     */
+    static void printSummary(std::ostream& os)
+    {
+        auto& state = state_();
+        std::lock_guard<std::mutex> guard(state.mutex);
+        const double mb = 1024.0*1024.0;
+        std::size_t totalSetup = 0;
+        std::size_t totalHighWater = 0;
+        os << "------------------------ Memory accounting ---------------------\n";
+        for (const auto& entry : state.entries) {
+            if (entry.highWater == 0)
+                continue;
+
+            os << "    " << entry.name << ": " << entry.setup/mb << " MB after setup, "
+               << entry.highWater/mb << " MB high-water mark\n";
+            totalSetup += entry.setup;
+            totalHighWater += entry.highWater;
+        }
+        os << "Sum of the first process' subsystems: " << totalSetup/mb
+           << " MB after setup, " << totalHighWater/mb << " MB high-water mark\n"
+           << "----------------------------------------------------------------\n";
+    }
+
+private:
+    static State& state_()
+    {
+        static State state;
+        return state;
+    }
+
+    static Entry& entry_(State& state, const std::string& name)
+    {
+        for (auto& entry : state.entries)
+            if (entry.name == name)
+                return entry;
+
+        state.entries.emplace_back();
+        state.entries.back().name = name;
+        return state.entries.back();
+    }
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,312 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::MultilevelMonteCarlo
+ */
+#ifndef EWOMS_MULTILEVEL_MONTE_CARLO_HH
+#define EWOMS_MULTILEVEL_MONTE_CARLO_HH
+
+#include <opm/models/utils/basicproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+#include <opm/models/utils/timer.hh>
+
+#include <dune/common/parametertree.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Estimates the expected values of the quantities of a time series using the
+ *        multi-level Monte Carlo method.
+ *
+ * Each level is specified by a set of parameter assignments (usually the number of
+ * cells of the grid), ordered from the coarsest to the finest one. A sample of the
+ * finest level is the result of a simulation at the end time, i.e., the values of
+ * all quantities and regions of the time series output (see TimeSeriesOutput). The
+ * expected value is estimated by the telescoping sum
+ *
+ * \f[ E[Q_L] = E[Q_0] + \sum_{l=1}^L E[Q_l - Q_{l-1}] \f]
+ *
+ * where both simulations of a difference use the same sample, i.e., the same value of
+ * the run-time parameter which is named by MlmcSampleParameter. The problem is
+ * supposed to use it to seed the random parts of its input.
+ *
+ * Starting with MlmcInitialSamples samples per level, the number of samples of each
+ * level is chosen from the measured variances V_l and the measured costs C_l such that
+ * the variance of the estimator is below MlmcTargetError squared at minimal cost, i.e.,
+ *
+ * \f[ N_l = \left\lceil 2 \epsilon^{-2} \sqrt{V_l/C_l} \sum_k \sqrt{V_k C_k} \right\rceil \f]
+ *
+ * where the variances are summed over all quantities. The number of samples of each
+ * level is limited to MlmcMaxSamples. The bias of the finest level is not estimated.
+ *
+ * Like the members of an ensemble, the simulations are run one after another by all
+ * processes because the grids are always distributed over all of them.
+ */
+template <class TypeTag>
+class MultilevelMonteCarlo
+{
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+    using Assignments = std::vector<std::pair<std::string, std::string> >;
+
+    struct LevelStatistics
+    {
+        unsigned numSamples = 0;
+        unsigned targetSamples = 0;
+        std::vector<double> sum;
+        std::vector<double> sumSquares;
+        double cost = 0.0;
+
+        double variance() const
+        {
+            if (numSamples < 2)
+                return 0.0;
+
+            double result = 0.0;
+            for (size_t i = 0; i < sum.size(); ++i) {
+                double mean = sum[i]/numSamples;
+                result += std::max(0.0, sumSquares[i]/numSamples - mean*mean);
+            }
+            return result*numSamples/(numSamples - 1);
+        }
+
+        double costPerSample() const
+        { return (numSamples > 0) ? cost/numSamples : 0.0; }
+    };
+
+public:
+    /*!
+     * \param levels The parameter assignments of the levels, coarsest first
+     * \param myRank The rank of the process in the communicator of the grids
+     */
+    MultilevelMonteCarlo(std::vector<Assignments> levels, int myRank)
+        : levels_(std::move(levels))
+        , myRank_(myRank)
+        , nextSampleIdx_(0)
+    {
+        sampleParam_ = EWOMS_GET_PARAM(TypeTag, std::string, MlmcSampleParameter);
+        targetError_ = EWOMS_GET_PARAM(TypeTag, double, MlmcTargetError);
+        initialSamples_ = std::max(2u, EWOMS_GET_PARAM(TypeTag, unsigned, MlmcInitialSamples));
+        maxSamples_ = std::max(initialSamples_, EWOMS_GET_PARAM(TypeTag, unsigned, MlmcMaxSamples));
+
+        if (!sampleParam_.empty()
+            && ParamsMeta::registry().find(sampleParam_) == ParamsMeta::registry().end())
+            throw std::runtime_error("Unknown parameter '"+sampleParam_+"' specified for "
+                                     "the samples of the multi-level Monte Carlo method");
+        if (!(targetError_ > 0.0))
+            throw std::runtime_error("The target error of the multi-level Monte Carlo "
+                                     "method must be positive");
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the multi-level Monte Carlo method.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, MlmcLevelsFile,
+                             "A file which specifies the levels of a multi-level Monte "
+                             "Carlo estimation, one per line and coarsest first");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, MlmcSampleParameter,
+                             "The name of the parameter which receives the index of the "
+                             "sample of the multi-level Monte Carlo method");
+        EWOMS_REGISTER_PARAM(TypeTag, double, MlmcTargetError,
+                             "The targeted standard deviation of the multi-level Monte "
+                             "Carlo estimator");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, MlmcInitialSamples,
+                             "The number of samples of each level which are used to "
+                             "estimate its variance and its cost");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, MlmcMaxSamples,
+                             "The maximum number of samples of each level");
+    }
+
+    /*!
+     * \brief Run the samples of all levels until the target error is reached.
+     */
+    void run()
+    {
+        baseParams_ = ParamsMeta::tree();
+
+        std::vector<LevelStatistics> stats(levels_.size());
+        for (auto& levelStats : stats)
+            levelStats.targetSamples = initialSamples_;
+
+        while (true) {
+            bool sampled = false;
+            for (unsigned levelIdx = 0; levelIdx < levels_.size(); ++levelIdx) {
+                auto& levelStats = stats[levelIdx];
+                while (levelStats.numSamples < levelStats.targetSamples) {
+                    runSample_(levelStats, levelIdx);
+                    sampled = true;
+                }
+            }
+
+            if (!sampled || !updateTargetSamples_(stats))
+                break;
+        }
+
+        Parameters::overwriteParams<TypeTag>(baseParams_);
+        printSummary_(stats);
+    }
+
+private:
+    // run the simulations of a sample for a level and add their difference to the
+    // statistics of the level
+    void runSample_(LevelStatistics& levelStats, unsigned levelIdx)
+    {
+        unsigned sampleIdx = nextSampleIdx_++;
+
+        Timer timer;
+        timer.start();
+        std::vector<double> values = simulate_(levelIdx, sampleIdx);
+        if (levelIdx > 0) {
+            std::vector<double> coarseValues = simulate_(levelIdx - 1, sampleIdx);
+            for (size_t i = 0; i < values.size(); ++i)
+                values[i] -= coarseValues[i];
+        }
+        levelStats.cost += timer.stop();
+
+        if (levelStats.sum.empty()) {
+            levelStats.sum.resize(values.size(), 0.0);
+            levelStats.sumSquares.resize(values.size(), 0.0);
+        }
+        if (values.size() != levelStats.sum.size())
+            throw std::runtime_error("The number of quantities of the time series output "
+                                     "differs between the levels");
+
+        for (size_t i = 0; i < values.size(); ++i) {
+            levelStats.sum[i] += values[i];
+            levelStats.sumSquares[i] += values[i]*values[i];
+        }
+        ++levelStats.numSamples;
+    }
+
+    // run the simulation of a level for a sample and return the reduced quantities of
+    // the time series at the end time
+    std::vector<double> simulate_(unsigned levelIdx, unsigned sampleIdx)
+    {
+        Dune::ParameterTree params(baseParams_);
+        for (const auto& assignment : levels_[levelIdx])
+            params[assignment.first] = assignment.second;
+        if (!sampleParam_.empty())
+            params[sampleParam_] = std::to_string(sampleIdx);
+        params["EnableTimeSeriesOutput"] = "true";
+        Parameters::overwriteParams<TypeTag>(params);
+
+        if (myRank_ == 0)
+            std::cout << "# [multi-level Monte Carlo: level " << levelIdx
+                      << ", sample " << sampleIdx << "]\n" << std::flush;
+
+        ThreadManager::init();
+
+        Simulator simulator;
+        simulator.run();
+
+        auto* timeSeries = simulator.problem().timeSeriesOutput();
+        timeSeries->update(simulator.time());
+
+        std::vector<double> values;
+        for (unsigned qIdx = 0; qIdx < timeSeries->numQuantities(); ++qIdx)
+            for (unsigned regionIdx = 0; regionIdx < timeSeries->numRegions(); ++regionIdx)
+                values.push_back(static_cast<double>(timeSeries->value(qIdx, regionIdx)));
+        return values;
+    }
+
+    // determine the number of samples of each level which is optimal for the current
+    // estimates of the variances and costs. returns true if more samples are required.
+    bool updateTargetSamples_(std::vector<LevelStatistics>& stats) const
+    {
+        double sumSqrtVarCost = 0.0;
+        for (const auto& levelStats : stats)
+            sumSqrtVarCost += std::sqrt(levelStats.variance()*levelStats.costPerSample());
+
+        bool needMore = false;
+        for (auto& levelStats : stats) {
+            double cost = std::max(levelStats.costPerSample(), 1e-12);
+            double optimal =
+                2.0/(targetError_*targetError_)*std::sqrt(levelStats.variance()/cost)*sumSqrtVarCost;
+
+            unsigned target = static_cast<unsigned>(std::min<double>(std::ceil(optimal), maxSamples_));
+            levelStats.targetSamples = std::max(levelStats.numSamples, target);
+            needMore = needMore || levelStats.targetSamples > levelStats.numSamples;
+        }
+
+        return needMore;
+    }
+
+    void printSummary_(const std::vector<LevelStatistics>& stats) const
+    {
+        if (myRank_ != 0)
+            return;
+
+        std::cout << "# [multi-level Monte Carlo summary]\n";
+        double estimatorVariance = 0.0;
+        std::vector<double> expectedValues;
+        for (unsigned levelIdx = 0; levelIdx < stats.size(); ++levelIdx) {
+            const auto& levelStats = stats[levelIdx];
+            std::cout << "level " << levelIdx << ": " << levelStats.numSamples
+                      << " samples, variance " << levelStats.variance()
+                      << ", " << levelStats.costPerSample() << " seconds per sample\n";
+
+            if (levelStats.numSamples == 0)
+                continue;
+
+            estimatorVariance += levelStats.variance()/levelStats.numSamples;
+            expectedValues.resize(levelStats.sum.size(), 0.0);
+            for (size_t i = 0; i < levelStats.sum.size(); ++i)
+                expectedValues[i] += levelStats.sum[i]/levelStats.numSamples;
+        }
+
+        std::cout << "standard deviation of the estimator: " << std::sqrt(estimatorVariance) << "\n"
+                  << "expected values:";
+        for (double value : expectedValues)
+            std::cout << " " << value;
+        std::cout << "\n" << std::flush;
+    }
+
+    std::vector<Assignments> levels_;
+    int myRank_;
+    unsigned nextSampleIdx_;
+
+    Dune::ParameterTree baseParams_;
+    std::string sampleParam_;
+    double targetError_;
+    unsigned initialSamples_;
+    unsigned maxSamples_;
+};
+
+} // namespace Opm
+
+#endif
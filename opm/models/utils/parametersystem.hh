@@ -43,7 +43,9 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parametertree.hh>
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <set>
 #include <list>
 #include <sstream>
@@ -117,6 +119,29 @@
     (::Opm::Parameters::get<TypeTag, ParamType>(#ParamName, #ParamName, \
                                                 getPropValue<TypeTag, Properties::ParamName>()))
 
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Retrieve a runtime parameter once and return a handle to its value.
+ *
+ * In contrast to \c EWOMS_GET_PARAM, accessing the value of the handle does not
+ * involve looking up the parameter by its name. This is intended for code which is
+ * called very often, e.g., for each degree of freedom or each face. The handle must
+ * only be created after all parameters have been registered. Handles cannot be
+ * copied, so they are usually stored as function-local static variables or as
+ * members which are initialized in the constructor.
+ *
+ * Example:
+ *
+ * \code
+ * static const auto upwindWeight = EWOMS_GET_PARAM_HANDLE(TypeTag, Scalar, UpwindWeight);
+ * Scalar w = *upwindWeight;
+ * \endcode
+ */
+#define EWOMS_GET_PARAM_HANDLE(TypeTag, ParamType, ParamName)           \
+    (::Opm::Parameters::Handle<TypeTag, ParamType>(#ParamName,          \
+                                                   getPropValue<TypeTag, Properties::ParamName>()))
+
 //!\cond SKIP_THIS
 #define EWOMS_GET_PARAM_(TypeTag, ParamType, ParamName)                 \
     (::Opm::Parameters::get<TypeTag, ParamType>(#ParamName, #ParamName, \
@@ -255,12 +280,23 @@ struct ParameterMetaData<TypeTag, TTag::ParameterSystem>
     static bool& registrationOpen()
     { return storage_().registrationOpen; }
 
+    static std::map<std::string, std::atomic<unsigned long> >& lookupCounts()
+    { return storage_().lookupCounts; }
+
+    static unsigned generation()
+    { return storage_().generation; }
+
+    static void invalidateHandles()
+    { ++storage_().generation; }
+
     static void clear()
     {
         storage_().tree.reset(new Dune::ParameterTree());
         storage_().finalizers.clear();
         storage_().registrationOpen = true;
         storage_().registry.clear();
+        storage_().lookupCounts.clear();
+        ++storage_().generation;
     }
 
 private:
@@ -273,12 +309,19 @@ private:
         {
             tree.reset(new Dune::ParameterTree());
             registrationOpen = true;
+            generation = 0;
         }
 
         std::unique_ptr<Dune::ParameterTree> tree;
         std::map<std::string, ::Opm::Parameters::ParamInfo> registry;
         std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > finalizers;
+        // number of times each registered parameter was looked up by its name. this
+        // is only updated if debugging code is enabled.
+        std::map<std::string, std::atomic<unsigned long> > lookupCounts;
         bool registrationOpen;
+        // incremented whenever the parameters are reset or replaced, so stale
+        // handles can be detected
+        unsigned generation;
     };
     static Storage_& storage_() {
         static Storage_ obj;
@@ -1085,6 +1128,17 @@ private:
                                          +" without prior registration is not allowed.");
         }
 
+#ifndef NDEBUG
+        // record the lookup so that parameters which are retrieved by name in
+        // performance critical code can be found. the map is not modified after
+        // the registration has been closed, so this is thread safe.
+        if (!ParamsMeta::registrationOpen()) {
+            auto countIt = ParamsMeta::lookupCounts().find(paramName);
+            if (countIt != ParamsMeta::lookupCounts().end())
+                ++ countIt->second;
+        }
+#endif
+
         // prefix the parameter name by the model's GroupName. E.g. If
         // the model specifies its group name to be 'Stokes', in an
         // INI file this would result in something like:
@@ -1112,6 +1166,119 @@ const ParamType get(const char *propTagName, const char *paramName, const ParamT
     return Param<TypeTag>::template get<ParamType>(propTagName, paramName, defaultValue, errorIfNotRegistered);
 }
 
+/*!
+ * \ingroup Parameter
+ *
+ * \brief A handle to the value of a run-time parameter.
+ *
+ * The value is retrieved from the parameter tree when the handle is constructed, so
+ * accessing it is as cheap as accessing a plain variable. If the parameters are
+ * replaced afterwards (see overwriteParams()), the value is retrieved again the
+ * next time it is accessed. Handles are usually created using the
+ * \c EWOMS_GET_PARAM_HANDLE macro.
+ */
+template <class TypeTag, class ParamType>
+class Handle
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+public:
+    Handle(const char *paramName, const ParamType& defaultValue)
+        : paramName_(paramName)
+        , defaultValue_(defaultValue)
+        , value_(get<TypeTag, ParamType>(paramName, paramName, defaultValue))
+        , generation_(ParamsMeta::generation())
+    { }
+
+    /*!
+     * \brief Returns the value of the parameter.
+     */
+    const ParamType& operator*() const
+    {
+        if (generation_.load(std::memory_order_acquire) != ParamsMeta::generation())
+            update_();
+        return value_;
+    }
+
+    operator const ParamType&() const
+    { return **this; }
+
+private:
+    void update_() const
+    {
+        // the handle may be accessed from multiple threads at the same time
+        std::lock_guard<std::mutex> lock(mutex_);
+        unsigned generation = ParamsMeta::generation();
+        if (generation_.load(std::memory_order_relaxed) == generation)
+            return;
+
+        value_ = get<TypeTag, ParamType>(paramName_, paramName_, defaultValue_);
+        generation_.store(generation, std::memory_order_release);
+    }
+
+    const char *paramName_;
+    ParamType defaultValue_;
+    mutable ParamType value_;
+    mutable std::atomic<unsigned> generation_;
+    mutable std::mutex mutex_;
+};
+
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Replace the values of all run-time parameters.
+ *
+ * This is intended to run several simulations with different parameters in the
+ * same process. It must not be called while a simulation is running.
+ *
+ * \param tree The new values of the run-time parameters
+ */
+template <class TypeTag>
+void overwriteParams(const Dune::ParameterTree& tree)
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+    ParamsMeta::tree() = tree;
+    ParamsMeta::invalidateHandles();
+}
+
+/*!
+ * \ingroup Parameter
+ * \brief Print the run-time parameters which have been looked up by their name
+ *        at least a given number of times.
+ *
+ * This indicates that \c EWOMS_GET_PARAM is used in performance critical code,
+ * where a \c EWOMS_GET_PARAM_HANDLE or a cached value should be used instead. The
+ * lookups are only counted if debugging code is enabled, nothing is printed
+ * otherwise.
+ *
+ * \param os The \c std::ostream on which the message should be printed
+ * \param threshold The minimum number of lookups of a parameter to be reported
+ *
+ * \return true if something was printed
+ */
+template <class TypeTag>
+bool printFrequentLookups(std::ostream& os, unsigned long threshold)
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+    bool printedHeader = false;
+    for (const auto& count : ParamsMeta::lookupCounts()) {
+        unsigned long numLookups = count.second.load();
+        if (numLookups < threshold)
+            continue;
+
+        if (!printedHeader) {
+            os << "# [run-time parameters which were frequently looked up by name]\n";
+            printedHeader = true;
+        }
+        os << count.first << ": " << numLookups << " lookups\n";
+    }
+    os << std::flush;
+
+    return printedHeader;
+}
+
 template <class TypeTag, class Container>
 void getLists(Container& usedParams, Container& unusedParams)
 {
@@ -1186,6 +1353,7 @@ void registerParam(const char *paramName, const char *propertyName, const ParamT
     }
 
     ParamsMeta::mutableRegistry()[paramName] = paramInfo;
+    ParamsMeta::lookupCounts()[paramName] = 0;
 }
 
 template <class TypeTag, class ParamType>
@@ -1222,6 +1390,10 @@ void endParamRegistration()
     for (; pIt != pEndIt; ++pIt)
         (*pIt)->retrieve();
     ParamsMeta::registrationFinalizers().clear();
+
+    // the lookups above are not interesting
+    for (auto& count : ParamsMeta::lookupCounts())
+        count.second = 0;
 }
 //! \endcond
 
@@ -0,0 +1,296 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::PararealDriver
+ */
+#ifndef EWOMS_PARAREAL_DRIVER_HH
+#define EWOMS_PARAREAL_DRIVER_HH
+
+#include <opm/models/utils/basicproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Integrates a simulation in time using the Parareal algorithm.
+ *
+ * The simulated period is split into PararealSlices time slices of equal length. A
+ * coarse propagator, which uses PararealCoarseTimeSteps time steps per slice and a
+ * Newton tolerance that is PararealCoarseToleranceFactor times larger than the
+ * normal one, provides a first guess of the state at the end of each slice. Then, the
+ * fine propagator, i.e., the normal time integration, is applied to all slices
+ * starting from their current initial states and the state at the end of each slice
+ * is corrected by
+ *
+ * \f[ U_{n+1}^{k+1} = G(U_n^{k+1}) + F(U_n^k) - G(U_n^k) \f]
+ *
+ * until the relative change of the states at the ends of the slices drops below
+ * PararealTolerance or PararealMaxIterations iterations have been done. After k
+ * iterations, the first k slices are identical to the result of the fine propagator,
+ * so their fine integrations are not repeated.
+ *
+ * The fine integrations of the slices of an iteration are independent of each other.
+ * Running them concurrently would require a separate spatial decomposition for each
+ * slice, which the grid managers do not support, so they are done one after another
+ * on the simulator's processes. The states are transferred between the slices using
+ * in-memory snapshots of the simulator, see Simulator::saveSnapshot().
+ *
+ * The corrections are applied to the values of the primary variables, i.e., models
+ * which switch the meaning of their primary variables keep the meaning determined by
+ * the fine propagator. Episodes are not considered, so the problem must not rely on
+ * beginEpisode() and endEpisode() being called during the simulated period. Output is
+ * written for the initial state and for the converged states at the ends of the
+ * slices.
+ */
+template <class TypeTag>
+class PararealDriver
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
+
+public:
+    PararealDriver(Simulator& simulator)
+        : simulator_(simulator)
+    {
+        numSlices_ = std::max(1u, EWOMS_GET_PARAM(TypeTag, unsigned, PararealSlices));
+        maxIterations_ = EWOMS_GET_PARAM(TypeTag, unsigned, PararealMaxIterations);
+        tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, PararealTolerance);
+        numCoarseSteps_ = std::max(1u, EWOMS_GET_PARAM(TypeTag, unsigned, PararealCoarseTimeSteps));
+        coarseToleranceFactor_ = EWOMS_GET_PARAM(TypeTag, Scalar, PararealCoarseToleranceFactor);
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the Parareal driver.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, PararealSlices,
+                             "The number of time slices used by the Parareal algorithm. "
+                             "If this is one, the simulation is run normally");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, PararealMaxIterations,
+                             "The maximum number of Parareal iterations");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PararealTolerance,
+                             "The maximum relative change of the states at the ends of "
+                             "the time slices at which the Parareal iteration is "
+                             "considered to be converged");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, PararealCoarseTimeSteps,
+                             "The number of time steps per time slice used by the "
+                             "coarse propagator of the Parareal algorithm");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PararealCoarseToleranceFactor,
+                             "The factor by which the Newton tolerance of the coarse "
+                             "propagator of the Parareal algorithm is larger than the "
+                             "normal one");
+    }
+
+    /*!
+     * \brief Run the simulation from the initial solution to the end time.
+     */
+    void run()
+    {
+        if (EWOMS_GET_PARAM(TypeTag, Scalar, RestartTime) > -1e30)
+            throw std::runtime_error("The Parareal driver does not support restarting "
+                                     "simulations");
+
+        auto& model = simulator_.model();
+        auto& problem = simulator_.problem();
+        bool verbose = simulator_.gridView().comm().rank() == 0;
+
+        Scalar oldTimeStepSize = simulator_.timeStepSize();
+        simulator_.setTimeStepSize(0.0);
+        model.applyInitialSolution();
+        if (problem.shouldWriteOutput())
+            problem.writeOutput();
+        simulator_.setTimeStepSize(oldTimeStepSize);
+
+        // all propagations start from this snapshot. it provides the state which is
+        // not described by the primary variables
+        initialSnapshot_ = simulator_.saveSnapshot();
+        initialTimeStepSize_ = oldTimeStepSize;
+        fineTolerance_ = model.newtonMethod().tolerance();
+
+        Scalar startTime = simulator_.time();
+        Scalar sliceLength = (simulator_.endTime() - startTime)/numSlices_;
+        std::vector<Scalar> sliceTimes(numSlices_ + 1);
+        for (unsigned sliceIdx = 0; sliceIdx <= numSlices_; ++sliceIdx)
+            sliceTimes[sliceIdx] = startTime + sliceIdx*sliceLength;
+        sliceTimes[numSlices_] = simulator_.endTime();
+
+        // U: the current initial states of the slices, G: the results of the coarse
+        // propagator for them, F: the results of the fine propagator
+        std::vector<SolutionVector> U(numSlices_ + 1, model.solution(/*timeIdx=*/0));
+        std::vector<SolutionVector> G(numSlices_ + 1, model.solution(/*timeIdx=*/0));
+        std::vector<SolutionVector> F(numSlices_ + 1, model.solution(/*timeIdx=*/0));
+
+        for (unsigned sliceIdx = 0; sliceIdx < numSlices_; ++sliceIdx) {
+            propagate_(G[sliceIdx + 1], U[sliceIdx],
+                       sliceTimes[sliceIdx], sliceTimes[sliceIdx + 1], /*coarse=*/true);
+            U[sliceIdx + 1] = G[sliceIdx + 1];
+        }
+
+        SolutionVector coarseResult(U[0]);
+        for (unsigned iterIdx = 0; iterIdx < maxIterations_ && iterIdx < numSlices_; ++iterIdx) {
+            // the slices before the current iteration index start from states which
+            // are already converged
+            for (unsigned sliceIdx = iterIdx; sliceIdx < numSlices_; ++sliceIdx)
+                propagate_(F[sliceIdx + 1], U[sliceIdx],
+                           sliceTimes[sliceIdx], sliceTimes[sliceIdx + 1], /*coarse=*/false);
+
+            // the state at the end of the first unconverged slice is now exact
+            Scalar change = relativeChange_(F[iterIdx + 1], U[iterIdx + 1]);
+            U[iterIdx + 1] = F[iterIdx + 1];
+
+            for (unsigned sliceIdx = iterIdx + 1; sliceIdx < numSlices_; ++sliceIdx) {
+                propagate_(coarseResult, U[sliceIdx],
+                           sliceTimes[sliceIdx], sliceTimes[sliceIdx + 1], /*coarse=*/true);
+
+                SolutionVector& next = U[sliceIdx + 1];
+                SolutionVector corrected(F[sliceIdx + 1]);
+                corrected += coarseResult;
+                corrected -= G[sliceIdx + 1];
+                change = std::max(change, relativeChange_(corrected, next));
+
+                next = corrected;
+                G[sliceIdx + 1] = coarseResult;
+            }
+
+            if (verbose)
+                std::cout << "Parareal iteration " << iterIdx + 1 << ": maximum relative "
+                          << "change of the slice states: " << change << "\n" << std::flush;
+
+            if (change <= tolerance_)
+                break;
+        }
+
+        // write the results at the ends of the slices
+        for (unsigned sliceIdx = 1; sliceIdx <= numSlices_; ++sliceIdx) {
+            setState_(U[sliceIdx], sliceTimes[sliceIdx]);
+            simulator_.setTimeStepIndex(sliceIdx);
+            if (problem.shouldWriteOutput())
+                problem.writeOutput();
+        }
+
+        model.newtonMethod().setTolerance(fineTolerance_);
+        problem.finalize();
+    }
+
+private:
+    // go back to the initial snapshot and replace the primary variables and the time
+    void setState_(const SolutionVector& state, Scalar time)
+    {
+        simulator_.restoreSnapshot(initialSnapshot_);
+
+        auto& model = simulator_.model();
+        model.solution(/*timeIdx=*/0) = state;
+        model.solution(/*timeIdx=*/1) = state;
+        model.invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+        model.invalidateIntensiveQuantitiesCache(/*timeIdx=*/1);
+
+        simulator_.setTime(time, /*stepIdx=*/0);
+    }
+
+    // integrate from a state at the beginning of a slice to its end
+    void propagate_(SolutionVector& result,
+                    const SolutionVector& state,
+                    Scalar beginTime,
+                    Scalar endTime,
+                    bool coarse)
+    {
+        setState_(state, beginTime);
+
+        auto& problem = simulator_.problem();
+        auto& newtonMethod = simulator_.model().newtonMethod();
+        newtonMethod.setTolerance(coarse ? coarseToleranceFactor_*fineTolerance_ : fineTolerance_);
+
+        Scalar coarseTimeStepSize = (endTime - beginTime)/numCoarseSteps_;
+        Scalar dt = coarse ? coarseTimeStepSize : initialTimeStepSize_;
+        const Scalar eps = std::numeric_limits<Scalar>::epsilon()*1e3;
+        while (simulator_.time() < endTime*(1.0 - eps) - eps) {
+            simulator_.setTimeStepSize(std::min(dt, endTime - simulator_.time()));
+
+            problem.beginTimeStep();
+            problem.timeIntegration();
+            problem.endTimeStep();
+
+            Scalar stepSize = simulator_.timeStepSize();
+            problem.advanceTimeLevel();
+            simulator_.setTime(simulator_.time() + stepSize,
+                               static_cast<unsigned>(simulator_.timeStepIndex() + 1));
+
+            if (coarse)
+                dt = coarseTimeStepSize;
+            else
+                dt = std::min(simulator_.maxTimeStepSize(), problem.nextTimeStepSize());
+        }
+
+        result = simulator_.model().solution(/*timeIdx=*/0);
+    }
+
+    // the maximum change of the primary variables between two states. changes of
+    // primary variables larger than one in magnitude are taken relative to them.
+    Scalar relativeChange_(const SolutionVector& newState, const SolutionVector& oldState) const
+    {
+        const auto& model = simulator_.model();
+
+        Scalar result = 0.0;
+        for (unsigned dofIdx = 0; dofIdx < newState.size(); ++dofIdx) {
+            if (!model.isLocalDof(dofIdx))
+                continue;
+
+            for (unsigned pvIdx = 0; pvIdx < newState[dofIdx].size(); ++pvIdx) {
+                Scalar delta = std::abs(newState[dofIdx][pvIdx] - oldState[dofIdx][pvIdx]);
+                Scalar scale = std::max<Scalar>(1.0, std::abs(oldState[dofIdx][pvIdx]));
+                result = std::max(result, delta/scale);
+            }
+        }
+
+        return simulator_.gridView().comm().max(result);
+    }
+
+    Simulator& simulator_;
+
+    unsigned numSlices_;
+    unsigned maxIterations_;
+    Scalar tolerance_;
+    unsigned numCoarseSteps_;
+    Scalar coarseToleranceFactor_;
+
+    std::string initialSnapshot_;
+    Scalar initialTimeStepSize_;
+    Scalar fineTolerance_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,324 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::PerfCounters
+ */
+#ifndef EWOMS_PERF_COUNTERS_HH
+#define EWOMS_PERF_COUNTERS_HH
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <iostream>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Opm {
+/*!
+ * \ingroup Common
+ *
+ * \brief Collects hardware performance counters for the phases of the Newton method.
+ *
+ * The counters are read using the perf_event interface of the Linux kernel. When they
+ * are enabled, each thread of the OpenMP thread pool opens its own set of counters
+ * which also includes the threads it creates later on, so the values are the sums for
+ * all threads of the process. Phases must only be entered and left by the main thread.
+ *
+ * Besides the raw counts, the summary reports the number of instructions per cycle, the
+ * cache miss rate and an estimate of the memory bandwidth, which assumes that each
+ * last level cache miss transfers one cache line of 64 bytes. On platforms other than
+ * Linux, or if the kernel does not allow to access the counters (see
+ * /proc/sys/kernel/perf_event_paranoid), the counters stay disabled.
+ */
+class PerfCounters
+{
+public:
+    /*!
+     * \brief The phases for which the counters are accumulated.
+     */
+    enum Phase : unsigned {
+        linearizationPhase,
+        linearSolvePhase,
+        updatePhase,
+        numPhases
+    };
+
+    /*!
+     * \brief The hardware events which are counted.
+     */
+    enum Event : unsigned {
+        cyclesEvent,
+        instructionsEvent,
+        cacheReferencesEvent,
+        cacheMissesEvent,
+        branchMissesEvent,
+        numEvents
+    };
+
+    /*!
+     * \brief Returns true if the counters are collected.
+     */
+    static bool enabled()
+    { return state_().enabled; }
+
+    /*!
+     * \brief Enable or disable the collection of the counters.
+     *
+     * Enabling the counters opens them for all threads of the OpenMP thread pool. If
+     * this is not possible, a warning is printed and the counters stay disabled.
+     *
+     * \return true if the counters are enabled afterwards
+     */
+    static bool setEnabled(bool yesno)
+    {
+        auto& state = state_();
+        if (yesno == state.enabled)
+            return state.enabled;
+
+        if (!yesno) {
+            closeCounters_();
+            state.enabled = false;
+            return false;
+        }
+
+        reset();
+        if (!openCounters_()) {
+            closeCounters_();
+            std::cerr << "Warning: Hardware performance counters are not available on this "
+                      << "system. They will not be collected.\n";
+            return false;
+        }
+
+        state.enabled = true;
+        return true;
+    }
+
+    /*!
+     * \brief Start counting for a phase.
+     */
+    static void begin(Phase phase)
+    {
+        auto& state = state_();
+        if (!state.enabled)
+            return;
+
+        for (unsigned eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+            state.startValues[phase][eventIdx] = read_(static_cast<Event>(eventIdx));
+    }
+
+    /*!
+     * \brief Stop counting for a phase and add the counts to its accumulators.
+     */
+    static void end(Phase phase)
+    {
+        auto& state = state_();
+        if (!state.enabled)
+            return;
+
+        for (unsigned eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+            state.values[phase][eventIdx] +=
+                read_(static_cast<Event>(eventIdx)) - state.startValues[phase][eventIdx];
+    }
+
+    /*!
+     * \brief Returns the accumulated count of an event for a phase.
+     */
+    static double value(Phase phase, Event event)
+    { return state_().values[phase][event]; }
+
+    /*!
+     * \brief Returns true if an event could be counted.
+     */
+    static bool available(Event event)
+    { return !state_().fds[event].empty(); }
+
+    /*!
+     * \brief Reset the accumulated counts of all phases.
+     */
+    static void reset()
+    {
+        auto& state = state_();
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            for (unsigned eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+                state.values[phaseIdx][eventIdx] = 0.0;
+    }
+
+    /*!
+     * \brief Print a human readable summary of the counters of all phases.
+     *
+     * \param os The stream to which the summary is written
+     * \param phaseTimes The wall clock time spent in each phase, which is required to
+     *                   estimate the memory bandwidth
+     */
+    static void printSummary(std::ostream& os, const double (&phaseTimes)[numPhases])
+    {
+        static const char* phaseNames[numPhases] =
+            { "Linearization", "Linear solve", "Newton update" };
+
+        os << "------------------ Hardware counters ------------------\n";
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            Phase phase = static_cast<Phase>(phaseIdx);
+            double cycles = value(phase, cyclesEvent);
+            double instructions = value(phase, instructionsEvent);
+            double references = value(phase, cacheReferencesEvent);
+            double misses = value(phase, cacheMissesEvent);
+
+            os << phaseNames[phaseIdx] << ":\n"
+               << "    Cycles: " << cycles << "\n";
+            if (available(instructionsEvent))
+                os << "    Instructions: " << instructions
+                   << " (" << ((cycles > 0) ? instructions/cycles : 0.0) << " per cycle)\n";
+            if (available(cacheMissesEvent)) {
+                os << "    Cache misses: " << misses;
+                if (available(cacheReferencesEvent) && references > 0)
+                    os << " (" << 100*misses/references << "% of the references)";
+                os << "\n";
+                if (phaseTimes[phaseIdx] > 0)
+                    os << "    Estimated memory bandwidth: "
+                       << misses*64/phaseTimes[phaseIdx]/1e9 << " GB/s\n";
+            }
+            if (available(branchMissesEvent))
+                os << "    Branch misses: " << value(phase, branchMissesEvent) << "\n";
+        }
+        os << "Note: The counters are the sums over all threads of the first process\n"
+           << "-------------------------------------------------------\n";
+    }
+
+private:
+    struct State
+    {
+        bool enabled = false;
+        std::vector<int> fds[numEvents];
+        double startValues[numPhases][numEvents] = {};
+        double values[numPhases][numEvents] = {};
+    };
+
+    static State& state_()
+    {
+        static State state;
+        return state;
+    }
+
+    // open the counters of all events for all threads of the thread pool. returns false
+    // if not even the cycles can be counted.
+    static bool openCounters_()
+    {
+#ifdef __linux__
+        auto& state = state_();
+        std::mutex fdMutex;
+        bool cyclesAvailable = true;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            int fds[numEvents];
+            for (unsigned eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+                fds[eventIdx] = openCounter_(static_cast<Event>(eventIdx));
+
+            std::lock_guard<std::mutex> guard(fdMutex);
+            cyclesAvailable = cyclesAvailable && fds[cyclesEvent] >= 0;
+            for (unsigned eventIdx = 0; eventIdx < numEvents; ++eventIdx)
+                if (fds[eventIdx] >= 0)
+                    state.fds[eventIdx].push_back(fds[eventIdx]);
+        }
+
+        return cyclesAvailable;
+#else
+        return false;
+#endif
+    }
+
+    static void closeCounters_()
+    {
+        auto& state = state_();
+        for (unsigned eventIdx = 0; eventIdx < numEvents; ++eventIdx) {
+#ifdef __linux__
+            for (int fd : state.fds[eventIdx])
+                close(fd);
+#endif
+            state.fds[eventIdx].clear();
+        }
+    }
+
+#ifdef __linux__
+    // open the counter of an event for the calling thread and the threads which it
+    // creates later
+    static int openCounter_(Event event)
+    {
+        static const std::uint64_t configs[numEvents] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_REFERENCES,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[event];
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr,
+                                        /*pid=*/0, /*cpu=*/-1, /*groupFd=*/-1, /*flags=*/0));
+    }
+#endif
+
+    // returns the sum of the counts of an event for all threads. if the kernel had to
+    // multiplex the counters, the counts are extrapolated to the full time.
+    static double read_(Event event)
+    {
+        double result = 0.0;
+#ifdef __linux__
+        for (int fd : state_().fds[event]) {
+            std::uint64_t buf[3];
+            if (::read(fd, buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)))
+                continue;
+
+            double count = static_cast<double>(buf[0]);
+            if (buf[2] > 0 && buf[2] < buf[1])
+                count *= static_cast<double>(buf[1])/static_cast<double>(buf[2]);
+            result += count;
+        }
+#else
+        (void) event;
+#endif
+        return result;
+    }
+};
+
+} // namespace Opm
+
+#endif
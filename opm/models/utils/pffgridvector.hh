@@ -40,9 +40,14 @@ namespace Opm {
  *        freedom in a prefetch friendly manner.
  *
  * This container often reduces the number of cache faults considerably, thus improving
- * performance. On the flipside data cannot be written to on an individual basis and it
- * requires significantly more memory than a plain array. PffVector stands for "PreFetch
- * Friendly Grid Vector".
+ * performance. On the flipside it requires significantly more memory than a plain
+ * array because the data of a degree of freedom is stored once for each element whose
+ * stencil contains it. PffVector stands for "PreFetch Friendly Grid Vector".
+ *
+ * The entries can be written to, but the container does not keep the copies of a
+ * degree of freedom consistent. Instead, refresh() is intended to re-gather all entries
+ * from a vector which is indexed by the global DOF indices. Since the entries of
+ * different elements do not overlap in memory, they can be modified concurrently.
  */
 template <class GridView, class Stencil, class Data, class DofMapper>
 class PffGridVector
@@ -62,71 +67,117 @@ public:
     void update(const DistFn& distFn)
     {
         unsigned numElements = gridView_.size(/*codim=*/0);
-        unsigned numLocalDofs = computeNumLocalDofs_();
-
-        elemData_.resize(numElements);
-        data_.resize(numLocalDofs);
 
-        // update the pointers for the element data: for this, we need to loop over the
-        // whole grid and update a stencil for each element
-        Data *curElemDataPtr = &data_[0];
+        // update the offsets for the element data: for this, we need to loop over the
+        // whole grid and update a stencil for each element. the element index is used
+        // to make sure that the data of elements with adjacent indices are adjacent in
+        // memory, too.
+        elemOffset_.resize(numElements + 1);
+        std::vector<unsigned> numElemDofs(numElements, 0);
         Stencil stencil(gridView_, dofMapper_);
         auto elemIt = gridView_.template begin</*codim=*/0>();
         const auto& elemEndIt = gridView_.template end</*codim=*/0>();
         for (; elemIt != elemEndIt; ++elemIt) {
-            // set the DOF data pointer for the current element
+            stencil.update(*elemIt);
+            numElemDofs[elementMapper_.index(*elemIt)] = stencil.numDof();
+        }
+
+        elemOffset_[0] = 0;
+        for (unsigned elemIdx = 0; elemIdx < numElements; ++ elemIdx)
+            elemOffset_[elemIdx + 1] = elemOffset_[elemIdx] + numElemDofs[elemIdx];
+
+        size_t numLocalDofs = elemOffset_[numElements];
+        data_.resize(numLocalDofs);
+        dofIndex_.resize(numLocalDofs);
+
+        elemIt = gridView_.template begin</*codim=*/0>();
+        for (; elemIt != elemEndIt; ++elemIt) {
             const auto& elem = *elemIt;
-            unsigned elemIdx = elementMapper_.index(elem);
-            elemData_[elemIdx] = curElemDataPtr;
+            size_t offset = elemOffset_[elementMapper_.index(elem)];
+            Data *elemData = &data_[offset];
+            unsigned *elemDofIndex = &dofIndex_[offset];
 
             stencil.update(elem);
             unsigned numDof = stencil.numDof();
-            for (unsigned localDofIdx = 0; localDofIdx < numDof; ++ localDofIdx)
-                distFn(curElemDataPtr[localDofIdx], stencil, localDofIdx);
-
-            // update the element data pointer to make it point to the beginning of the
-            // data for DOFs of the next element
-            curElemDataPtr += numDof;
+            for (unsigned localDofIdx = 0; localDofIdx < numDof; ++ localDofIdx) {
+                elemDofIndex[localDofIdx] = stencil.globalSpaceIndex(localDofIdx);
+                distFn(elemData[localDofIdx], stencil, localDofIdx);
+            }
         }
     }
 
+    /*!
+     * \brief Re-gather all entries of the container.
+     *
+     * The layout of the container must have been established by update() before. Since
+     * the stencils do not need to be recomputed, this is considerably cheaper.
+     *
+     * \param gatherFn A function object which is called as gatherFn(Data& dest, unsigned
+     *                 globalDofIdx) for each entry. It may be called concurrently.
+     */
+    template <class GatherFn>
+    void refresh(const GatherFn& gatherFn)
+    {
+        size_t numEntries = data_.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (size_t entryIdx = 0; entryIdx < numEntries; ++ entryIdx)
+            gatherFn(data_[entryIdx], dofIndex_[entryIdx]);
+    }
+
     void prefetch(const Element& elem) const
     {
         unsigned elemIdx = elementMapper_.index(elem);
 
         // we use 0 as the temporal locality, because it is reasonable to assume that an
         // entry will only be accessed once.
-        ::Opm::prefetch</*temporalLocality=*/0>(elemData_[elemIdx]);
+        size_t offset = elemOffset_[elemIdx];
+        unsigned n = static_cast<unsigned>(elemOffset_[elemIdx + 1] - offset);
+        if (n > 0)
+            ::Opm::prefetch</*temporalLocality=*/0>(data_[offset], n);
     }
 
     const Data& get(const Element& elem, unsigned localDofIdx) const
+    { return elementData(elem)[localDofIdx]; }
+
+    Data& get(const Element& elem, unsigned localDofIdx)
+    { return elementData(elem)[localDofIdx]; }
+
+    /*!
+     * \brief Returns a pointer to the entries of all degrees of freedom in the stencil of
+     *        an element.
+     *
+     * The entries are ordered like the local DOF indices of the element's stencil.
+     */
+    const Data* elementData(const Element& elem) const
+    { return &data_[elemOffset_[elementMapper_.index(elem)]]; }
+
+    Data* elementData(const Element& elem)
+    { return &data_[elemOffset_[elementMapper_.index(elem)]]; }
+
+    /*!
+     * \brief Returns the number of degrees of freedom in the stencil of an element.
+     */
+    unsigned numDof(const Element& elem) const
     {
         unsigned elemIdx = elementMapper_.index(elem);
-        return elemData_[elemIdx][localDofIdx];
+        return static_cast<unsigned>(elemOffset_[elemIdx + 1] - elemOffset_[elemIdx]);
     }
 
-private:
-    unsigned computeNumLocalDofs_() const
-    {
-        unsigned result = 0;
-
-        // loop over the whole grid and sum up the number of local DOFs of all Stencils
-        Stencil stencil(gridView_, dofMapper_);
-        auto elemIt = gridView_.template begin</*codim=*/0>();
-        const auto& elemEndIt = gridView_.template end</*codim=*/0>();
-        for (; elemIt != elemEndIt; ++elemIt) {
-            stencil.update(*elemIt);
-            result += stencil.numDof();
-        }
-
-        return result;
-    }
+    /*!
+     * \brief Returns the number of elements for which the layout has been established.
+     */
+    size_t numElements() const
+    { return elemOffset_.empty() ? 0 : elemOffset_.size() - 1; }
 
+private:
     GridView gridView_;
     ElementMapper elementMapper_;
     const DofMapper& dofMapper_;
     std::vector<Data> data_;
-    std::vector<Data*> elemData_;
+    std::vector<unsigned> dofIndex_;
+    std::vector<size_t> elemOffset_;
 };
 
 } // namespace Opm
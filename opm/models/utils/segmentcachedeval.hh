@@ -0,0 +1,113 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::segmentCachedEval
+ */
+#ifndef EWOMS_SEGMENT_CACHED_EVAL_HH
+#define EWOMS_SEGMENT_CACHED_EVAL_HH
+
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <cassert>
+#include <type_traits>
+
+namespace Opm {
+
+/*!
+ * \brief Evaluate a piecewise linear tabulated function using a remembered segment.
+ *
+ * Tabulated1DFunction::eval() determines the segment which contains the argument using
+ * a binary search for each call. Since the arguments passed for a given degree of
+ * freedom usually change only a little between Newton iterations, this function first
+ * checks the segment which was used by the previous call with the same \c segmentIdx
+ * and its two neighbors. Only if none of them contains the argument, the binary search
+ * is done. The result is the same as the one of
+ * <tt>fn.eval(x, /\*extrapolate=*\/true)</tt>.
+ *
+ * \param fn The tabulated function. It must exhibit at least two sampling points.
+ * \param x The argument of the function
+ * \param segmentIdx The index of the segment which was used by the last call. It is
+ *                   updated to the segment used for \c x.
+ */
+template <class TabulatedFunction, class Evaluation>
+Evaluation segmentCachedEval(const TabulatedFunction& fn,
+                             const Evaluation& x,
+                             unsigned& segmentIdx)
+{
+    using Scalar = std::decay_t<decltype(fn.xAt(0))>;
+
+    const unsigned numSamples = static_cast<unsigned>(fn.numSamples());
+    assert(numSamples >= 2);
+
+    const Scalar xValue = scalarValue(x);
+    unsigned i = segmentIdx;
+    if (i > numSamples - 2)
+        i = 0;
+
+    if (xValue < fn.xAt(i)) {
+        if (i > 0 && xValue >= fn.xAt(i - 1))
+            --i;
+        else
+            i = static_cast<unsigned>(-1);
+    }
+    else if (xValue > fn.xAt(i + 1)) {
+        if (i + 2 < numSamples && xValue <= fn.xAt(i + 2))
+            ++i;
+        else
+            i = static_cast<unsigned>(-1);
+    }
+
+    if (i == static_cast<unsigned>(-1)) {
+        // the argument moved by more than one segment: do a binary search. arguments
+        // outside of the range of the table are extrapolated from the outermost
+        // segments.
+        if (!(xValue > fn.xAt(0)))
+            i = 0;
+        else if (!(xValue < fn.xAt(numSamples - 1)))
+            i = numSamples - 2;
+        else {
+            unsigned lowIdx = 0;
+            unsigned highIdx = numSamples - 1;
+            while (lowIdx + 1 < highIdx) {
+                unsigned midIdx = (lowIdx + highIdx)/2;
+                if (xValue < fn.xAt(midIdx))
+                    highIdx = midIdx;
+                else
+                    lowIdx = midIdx;
+            }
+            i = lowIdx;
+        }
+    }
+    segmentIdx = i;
+
+    const Scalar x0 = fn.xAt(i);
+    const Scalar x1 = fn.xAt(i + 1);
+    const Scalar y0 = fn.yAt(i);
+    const Scalar y1 = fn.yAt(i + 1);
+    return y0 + (y1 - y0)/(x1 - x0)*(x - x0);
+}
+
+} // namespace Opm
+
+#endif
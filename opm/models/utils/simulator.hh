@@ -34,7 +34,14 @@
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
+#include <opm/models/utils/eventtracer.hh>
+#include <opm/models/utils/instrumentation.hh>
+#include <opm/models/utils/memoryaccounting.hh>
+#include <opm/models/utils/perfcounters.hh>
 #include <opm/models/parallel/mpiutil.hh>
+#include <opm/models/parallel/tasklets.hh>
+#include <opm/models/parallel/threadphases.hh>
+#include <opm/models/parallel/communicationthread.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 
 #include <dune/common/version.hh>
@@ -44,6 +51,7 @@
 #include <fstream>
 #include <iomanip>
 #include <vector>
+#include <utility>
 #include <string>
 #include <memory>
 
@@ -94,6 +102,7 @@ class Simulator
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Model = GetPropType<TypeTag, Properties::Model>;
     using Problem = GetPropType<TypeTag, Properties::Problem>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
 public:
     // do not allow to copy simulators around
@@ -104,11 +113,14 @@ public:
         TimerGuard setupTimerGuard(setupTimer_);
 
         setupTimer_.start();
+        Timer phaseTimer;
+        phaseTimer.start();
 
         const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
         verbose_ = verbose && comm.rank() == 0;
 
         timeStepIdx_ = 0;
+        numNewtonIterations_ = 0;
         startTime_ = 0.0;
         time_ = 0.0;
         endTime_ = EWOMS_GET_PARAM(TypeTag, Scalar, EndTime);
@@ -131,6 +143,61 @@ public:
 
         finished_ = false;
 
+        // only the data of binary restart files can be written by the processes without
+        // communicating with each other
+        asyncRestartOutput_ =
+            EWOMS_GET_PARAM(TypeTag, bool, EnableAsyncRestartOutput)
+            && EWOMS_GET_PARAM(TypeTag, bool, EnableBinaryRestart);
+
+        // delta restart files refer to a full binary restart file
+        deltaRestartInterval_ = 0;
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableBinaryRestart))
+            deltaRestartInterval_ = EWOMS_GET_PARAM(TypeTag, unsigned, DeltaRestartInterval);
+        numDeltaRestarts_ = 0;
+
+        // the asynchronous work of the simulation is done by a single tasklet runner
+        // whose threads are taken from the budget of the process. this needs to happen
+        // before the model is created, because it allocates per-thread data.
+        bool overlappedOutput =
+            EWOMS_GET_PARAM(TypeTag, bool, EnableVtkOutput)
+            && EWOMS_GET_PARAM(TypeTag, bool, EnableAsyncVtkOutput)
+            && EWOMS_GET_PARAM(TypeTag, bool, EnableOverlappedVtkOutput)
+            && comm.size() == 1;
+        unsigned numAsyncThreads = 0;
+        if (asyncRestartOutput_ || overlappedOutput)
+            numAsyncThreads = ThreadManager::reserveAsyncThreads();
+        taskletRunner_.reset(new TaskletRunner(numAsyncThreads));
+
+        // output is dispatched with low priority. limit the number of pending output
+        // tasklets, so that the data of the time steps does not pile up in memory if
+        // writing it is slower than the simulation
+        taskletRunner_->setMaxPending(TaskletInterface::Priority::Low,
+                                      EWOMS_GET_PARAM(TypeTag, unsigned, MaxPendingOutputTasklets));
+        const auto& asyncThreadCpus = ThreadManager::asyncThreadCpus();
+        if (!asyncThreadCpus.empty() && !taskletRunner_->setWorkerAffinity(asyncThreadCpus)
+            && verbose_)
+            std::cout << "Warning: Could not bind the asynchronous threads to the "
+                      << "specified CPUs\n" << std::flush;
+
+        // in parallel simulations, a thread can be dedicated to the exchange of data
+        // with the peer processes. this also needs to happen before the model is created
+        ownsCommunicationThread_ = false;
+        if (comm.size() > 1 && EWOMS_GET_PARAM(TypeTag, bool, EnableCommunicationThread)) {
+            if (!CommunicationThread::mpiSupportsThread()) {
+                if (verbose_)
+                    std::cout << "Warning: MPI does not provide the thread support required by "
+                              << "the communication thread. Not using it.\n" << std::flush;
+            }
+            else if (ThreadManager::reserveCommunicationThread()
+                     && !CommunicationThread::enabled())
+            {
+                CommunicationThread::start();
+                ownsCommunicationThread_ = true;
+            }
+        }
+
+        recordSetupPhase_("Preparation", phaseTimer);
+
         if (verbose_)
             std::cout << "Allocating the simulation vanguard\n" << std::flush;
 
@@ -153,6 +220,7 @@ public:
             assert(!all_what.empty());
             throw std::runtime_error("Allocating the simulation vanguard failed: " + all_what.front());
         }
+        recordSetupPhase_("Grid creation", phaseTimer);
 
         if (verbose_)
             std::cout << "Distributing the vanguard's data\n" << std::flush;
@@ -174,6 +242,7 @@ public:
             assert(!all_what.empty());
             throw std::runtime_error("Could not distribute the vanguard data: " + all_what.front());
         }
+        recordSetupPhase_("Load balancing", phaseTimer);
 
         if (verbose_)
             std::cout << "Allocating the model\n" << std::flush;
@@ -182,6 +251,7 @@ public:
         if (verbose_)
             std::cout << "Allocating the problem\n" << std::flush;
         problem_.reset(new Problem(*this));
+        recordSetupPhase_("Model and problem allocation", phaseTimer);
 
         if (verbose_)
             std::cout << "Initializing the model\n" << std::flush;
@@ -203,6 +273,7 @@ public:
             assert(!all_what.empty());
             throw std::runtime_error("Could not initialize the model: " + all_what.front());
         }
+        recordSetupPhase_("Model initialization", phaseTimer);
 
         if (verbose_)
             std::cout << "Initializing the problem\n" << std::flush;
@@ -224,6 +295,7 @@ public:
             assert(!all_what.empty());
             throw std::runtime_error("Could not initialize the problem: " + all_what.front());
         }
+        recordSetupPhase_("Problem initialization", phaseTimer);
 
         setupTimer_.stop();
 
@@ -231,6 +303,12 @@ public:
             std::cout << "Simulator successfully set up\n" << std::flush;
     }
 
+    ~Simulator()
+    {
+        if (ownsCommunicationThread_)
+            CommunicationThread::stop();
+    }
+
     /*!
      * \brief Registers all runtime parameters used by the simulation.
      */
@@ -242,9 +320,44 @@ public:
                              "The size of the initial time step [s]");
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, RestartTime,
                              "The simulation time at which a restart should be attempted [s]");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableBinaryRestart,
+                             "Write restart files using a binary format which is shared by "
+                             "all processes. Both formats can be read.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableAsyncRestartOutput,
+                             "Write binary restart files in a separate thread while the "
+                             "simulation continues");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, MaxPendingOutputTasklets,
+                             "The maximum number of output tasklets which are run "
+                             "asynchronously but have not been completed yet. If it is "
+                             "reached, the simulation waits for the output (0: unlimited)");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, DeltaRestartInterval,
+                             "The number of binary restart files which are written as deltas "
+                             "of the last full one, i.e., which only store the data of the "
+                             "entities that changed since then (0: always write full files)");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, PredeterminedTimeStepsFile,
                              "A file with a list of predetermined time step sizes (one "
                              "time step per line)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableInstrumentation,
+                             "Record the time spent in the instrumented regions of the code");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, InstrumentationOutputFile,
+                             "The file to which the results of the instrumentation are "
+                             "written. Files ending in '.csv' use the CSV format, all others "
+                             "JSON. If multiple processes are used, the rank is appended "
+                             "to the name");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableEventTrace,
+                             "Record a timeline of the phases of the simulation for each "
+                             "thread and write it in the trace event format of Chrome and "
+                             "Perfetto");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, EventTraceFile,
+                             "The file to which the timeline is written (default: the "
+                             "name of the problem with the '.trace.json' extension). If "
+                             "multiple processes are used, the rank is appended to the name");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, EventTraceBufferSize,
+                             "The maximum number of events which are kept per thread. If "
+                             "more are recorded, the oldest ones are discarded");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnablePerfCounters,
+                             "Count hardware events like cycles and cache misses for the "
+                             "phases of the Newton method (Linux only)");
 
         Vanguard::registerParameters();
         Model::registerParameters();
@@ -263,6 +376,17 @@ public:
     const Vanguard& vanguard() const
     { return *vanguard_; }
 
+    /*!
+     * \brief Return the tasklet runner which does the asynchronous work of the
+     *        simulation.
+     *
+     * Its worker threads are taken from the threads of the process (see
+     * ThreadManager::reserveAsyncThreads()). If no asynchronous work is enabled, it
+     * does not have any worker threads, i.e., tasklets are run immediately.
+     */
+    TaskletRunner& taskletRunner()
+    { return *taskletRunner_; }
+
     /*!
      * \brief Return the grid view for which the simulation is done
      */
@@ -362,6 +486,28 @@ public:
     const Timer& setupTimer() const
     { return setupTimer_; }
 
+    /*!
+     * \brief Returns the names and the wall clock times [s] of the phases of the setup
+     *        in the order in which they were done.
+     *
+     * The times of the phases add up to the time of the setupTimer() except for the
+     * negligible bookkeeping in between.
+     */
+    const std::vector<std::pair<std::string, Scalar> >& setupPhaseTimes() const
+    { return setupPhaseTimes_; }
+
+    /*!
+     * \brief Account for a phase of the setup which was done before the simulator was
+     *        constructed, e.g. parsing the parameters.
+     *
+     * The time of the phase is added to the setupTimer().
+     */
+    void addPreSetupPhase(const std::string& name, const Timer& timer)
+    {
+        setupTimer_ += timer;
+        setupPhaseTimes_.emplace(setupPhaseTimes_.begin(), name, timer.realTimeElapsed());
+    }
+
     /*!
      * \brief Returns a reference to the timer object which measures the time needed to
      *        run the simulation
@@ -406,6 +552,13 @@ public:
     const Timer& writeTimer() const
     { return writeTimer_; }
 
+    /*!
+     * \brief Returns the total number of Newton iterations which were required by the
+     *        time steps of the simulation so far
+     */
+    unsigned numNewtonIterations() const
+    { return numNewtonIterations_; }
+
     /*!
      * \brief Set the current time step size to a given value.
      *
@@ -630,7 +783,18 @@ public:
         TimerGuard prePostProcessTimerGuard(prePostProcessTimer_);
         TimerGuard writeTimerGuard(writeTimer_);
 
+        Instrumentation::setEnabled(EWOMS_GET_PARAM(TypeTag, bool, EnableInstrumentation));
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableEventTrace)) {
+            EventTracer::setBufferSize(EWOMS_GET_PARAM(TypeTag, unsigned, EventTraceBufferSize));
+            EventTracer::reset();
+            EventTracer::setEnabled(true);
+        }
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnablePerfCounters))
+            PerfCounters::setEnabled(true);
+
         setupTimer_.start();
+        Timer phaseTimer;
+        phaseTimer.start();
         Scalar restartTime = EWOMS_GET_PARAM(TypeTag, Scalar, RestartTime);
         if (restartTime > -1e30) {
             // try to restart a previous simulation
@@ -650,6 +814,7 @@ public:
                           << " Time step index: " << timeStepIndex()
                           << " Episode index: " << episodeIndex()
                           << "\n" << std::flush;
+            recordSetupPhase_("Restart deserialization", phaseTimer);
         }
         else {
             // if no restart is done, apply the initial solution
@@ -663,16 +828,22 @@ public:
             timeStepIdx_ = -1;
 
             EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(model_->applyInitialSolution());
+            recordSetupPhase_("Initial solution", phaseTimer);
 
             // write initial condition
-            if (problem_->shouldWriteOutput())
+            if (problem_->shouldWriteOutput()) {
                 EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->writeOutput());
+                recordSetupPhase_("Initial output", phaseTimer);
+            }
 
             timeStepSize_ = oldTimeStepSize;
             timeStepIdx_ = oldTimeStepIdx;
         }
         setupTimer_.stop();
 
+        model_->recordMemoryUsage();
+        MemoryAccounting::endSetup();
+
         executionTimer_.start();
         bool episodeBegins = episodeIsOver() || (timeStepIdx_ == 0);
         // do the time steps
@@ -727,6 +898,7 @@ public:
                 linearizeTimer_ += model.linearizeTimer();
                 solveTimer_ += model.solveTimer();
                 updateTimer_ += model.updateTimer();
+                numNewtonIterations_ += static_cast<unsigned>(model.newtonMethod().numIterations());
 
                 throw;
             }
@@ -736,6 +908,8 @@ public:
             linearizeTimer_ += model.linearizeTimer();
             solveTimer_ += model.solveTimer();
             updateTimer_ += model.updateTimer();
+            numNewtonIterations_ += static_cast<unsigned>(model.newtonMethod().numIterations());
+            model.recordMemoryUsage();
 
             // post-process the current solution
             prePostProcessTimer_.start();
@@ -744,8 +918,10 @@ public:
 
             // write the result to disk
             writeTimer_.start();
-            if (problem_->shouldWriteOutput())
+            if (problem_->shouldWriteOutput()) {
+                EventTracer::Scope traceScope("write output", "output");
                 EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->writeOutput());
+            }
             writeTimer_.stop();
 
             // do the next time integration
@@ -786,13 +962,42 @@ public:
 
             // write restart file if mandated by the problem
             writeTimer_.start();
-            if (problem_->shouldWriteRestartFile())
-                EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(serialize());
+            if (problem_->shouldWriteRestartFile()) {
+                EventTracer::Scope traceScope("write restart file", "output");
+                EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(serializeOverlapped_());
+            }
             writeTimer_.stop();
         }
         executionTimer_.stop();
 
+        // make sure that all restart files are on disk
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(checkRestartOutput_(/*wait=*/true));
+
         EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->finalize());
+
+        model_->recordMemoryUsage();
+        if (verbose_) {
+            MemoryAccounting::printSummary(std::cout);
+            ThreadPhases::printSummary(std::cout);
+        }
+
+        if (Instrumentation::enabled())
+            writeInstrumentation_();
+
+        if (EventTracer::enabled())
+            writeEventTrace_();
+
+        if (PerfCounters::enabled()) {
+            if (verbose_) {
+                const double phaseTimes[PerfCounters::numPhases] = {
+                    linearizeTimer_.realTimeElapsed(),
+                    solveTimer_.realTimeElapsed(),
+                    updateTimer_.realTimeElapsed()
+                };
+                PerfCounters::printSummary(std::cout, phaseTimes);
+            }
+            PerfCounters::setEnabled(false);
+        }
     }
 
     /*!
@@ -883,22 +1088,55 @@ public:
      * The file will start with the prefix returned by the name()
      * method, has the current time of the simulation clock in it's
      * name and uses the extension <tt>.ers</tt>. (Ewoms ReStart
-     * file.)  See Opm::Restart for details.
+     * file.) If binary restart files are enabled, a single file with the
+     * extension <tt>.erb</tt> is written by all processes instead. See
+     * Opm::Restart for details.
      */
     void serialize()
     {
-        using Restarter = Restart;
-        Restarter res;
+        Restart res(EWOMS_GET_PARAM(TypeTag, bool, EnableBinaryRestart));
+        serializeSections_(res);
+        res.serializeEnd();
+    }
+
+    /*!
+     * \brief Capture the state of the simulation in memory.
+     *
+     * The snapshot contains the state of the simulator and of the model which is
+     * also written to binary restart files, plus the size of the next time step and
+     * the primary variables of the auxiliary modules. Nothing is written to or read
+     * from disk. In particular, the state of the output writers is not part of the
+     * snapshot, i.e., output files which are written after the snapshot has been
+     * taken are kept if it is restored. Snapshots must be taken between two time
+     * steps and can only be restored by the same process for the same grid.
+     */
+    std::string saveSnapshot()
+    {
+        Restart res(/*binary=*/true);
         res.serializeBegin(*this);
-        if (gridView().comm().rank() == 0)
-            std::cout << "Serialize to file '" << res.fileName() << "'"
-                      << ", next time step size: " << timeStepSize()
-                      << "\n" << std::flush;
+        res.serializeBinarySection("Simulator", [this](auto& stream) {
+            stream << episodeIdx_ << episodeStartTime_ << episodeLength_
+                   << startTime_ << time_ << timeStepIdx_ << timeStepSize_;
+        });
+        model_->serializeSnapshot(res);
+        return res.releaseSnapshot();
+    }
 
-        this->serialize(res);
-        problem_->serialize(res);
-        model_->serialize(res);
-        res.serializeEnd();
+    /*!
+     * \brief Go back to the state of the simulation which is captured by a snapshot.
+     *
+     * \param snapshot The data returned by saveSnapshot()
+     */
+    void restoreSnapshot(std::string snapshot)
+    {
+        Restart res;
+        res.deserializeSnapshotBegin(*this, std::move(snapshot));
+        res.deserializeBinarySection("Simulator", [this](auto& stream) {
+            stream >> episodeIdx_ >> episodeStartTime_ >> episodeLength_
+                   >> startTime_ >> time_ >> timeStepIdx_ >> timeStepSize_;
+        });
+        model_->deserializeSnapshot(res);
+        res.deserializeEnd();
     }
 
     /*!
@@ -944,6 +1182,172 @@ public:
     }
 
 private:
+    // record the time of a phase of the setup and restart the timer for the next one
+    void recordSetupPhase_(const std::string& name, Timer& phaseTimer)
+    {
+        setupPhaseTimes_.emplace_back(name, phaseTimer.stop());
+        phaseTimer.halt();
+        phaseTimer.start();
+    }
+
+    // print the results of the instrumented regions and write them to the output file
+    void writeInstrumentation_()
+    {
+        const auto& comm = gridView().comm();
+        if (verbose_)
+            Instrumentation::printSummary(std::cout);
+
+        std::string fileName = EWOMS_GET_PARAM(TypeTag, std::string, InstrumentationOutputFile);
+        if (fileName.empty())
+            return;
+
+        bool writeCsv =
+            fileName.size() >= 4 && fileName.compare(fileName.size() - 4, 4, ".csv") == 0;
+        if (comm.size() > 1)
+            fileName += "." + std::to_string(comm.rank());
+
+        std::ofstream os(fileName);
+        if (!os)
+            throw std::runtime_error("Could not open file '"+fileName+"' for writing "
+                                     "the results of the instrumentation");
+        os << std::setprecision(9);
+        if (writeCsv)
+            Instrumentation::writeCsv(os);
+        else
+            Instrumentation::writeJson(os);
+    }
+
+    // write the timeline of the events recorded by the threads of this process
+    void writeEventTrace_()
+    {
+        // the worker threads of the tasklet runners must not record any events while
+        // the trace is written
+        EventTracer::setEnabled(false);
+
+        const auto& comm = gridView().comm();
+        std::string fileName = EWOMS_GET_PARAM(TypeTag, std::string, EventTraceFile);
+        if (fileName.empty())
+            fileName = problem_->name() + ".trace.json";
+        if (comm.size() > 1)
+            fileName += "." + std::to_string(comm.rank());
+
+        std::ofstream os(fileName);
+        if (!os)
+            throw std::runtime_error("Could not open file '"+fileName+"' for writing "
+                                     "the event trace");
+        os << std::setprecision(9);
+        EventTracer::writeChromeTrace(os, comm.rank());
+
+        if (verbose_)
+            std::cout << "Event trace written to '" << fileName << "'\n" << std::flush;
+    }
+
+    // writes a restart file which has been serialized into memory
+    class RestartOutputTasklet_ : public TaskletInterface
+    {
+    public:
+        explicit RestartOutputTasklet_(std::shared_ptr<Restart> res)
+            : res_(res)
+        {}
+
+        void run() override
+        {
+            try {
+                res_->writeBinaryBlock();
+            }
+            catch (const std::exception& e) {
+                errorMessage_ = e.what();
+            }
+            res_.reset();
+        }
+
+        // the reason why writing the restart file failed (empty if it succeeded)
+        const std::string& errorMessage() const
+        { return errorMessage_; }
+
+    private:
+        std::shared_ptr<Restart> res_;
+        std::string errorMessage_;
+    };
+
+    // serialize the state of the simulation into a restart object. this does not
+    // finish the restart file.
+    void serializeSections_(Restart& res)
+    {
+        // every (deltaRestartInterval_ + 1)-th binary restart file is a full one, the
+        // others only store the changes relative to it
+        bool recordDeltaBase = false;
+        if (res.binary() && deltaRestartInterval_ > 0) {
+            if (restartDeltaBase_ && numDeltaRestarts_ < deltaRestartInterval_) {
+                res.setDeltaBase(restartDeltaBase_);
+                ++numDeltaRestarts_;
+            }
+            else {
+                res.setRecordDeltaBase(true);
+                recordDeltaBase = true;
+            }
+        }
+
+        res.serializeBegin(*this);
+        if (gridView().comm().rank() == 0)
+            std::cout << "Serialize to file '" << res.fileName() << "'"
+                      << ", next time step size: " << timeStepSize()
+                      << "\n" << std::flush;
+
+        this->serialize(res);
+        problem_->serialize(res);
+        model_->serialize(res);
+
+        if (recordDeltaBase) {
+            restartDeltaBase_ = res.recordedDeltaBase();
+            numDeltaRestarts_ = 0;
+        }
+    }
+
+    // write a restart file. if asynchronous restart output is enabled, the state is
+    // serialized into memory and the file is written by a separate thread while the
+    // simulation continues. the restart files are written in order.
+    void serializeOverlapped_()
+    {
+        if (!asyncRestartOutput_) {
+            serialize();
+            return;
+        }
+
+        checkRestartOutput_(/*wait=*/false);
+
+        auto res = std::make_shared<Restart>(/*binary=*/true);
+        serializeSections_(*res);
+
+        // the layout of the file is determined collectively, the data of the processes
+        // is then written independently
+        res->prepareBinaryFile();
+
+        auto tasklet = std::make_shared<RestartOutputTasklet_>(res);
+        tasklet->addDependency(lastRestartTasklet_);
+        tasklet->setPriority(TaskletInterface::Priority::Low);
+        taskletRunner_->dispatch(tasklet);
+        lastRestartTasklet_ = tasklet;
+    }
+
+    // throw if writing a restart file asynchronously failed. if 'wait' is true, this
+    // blocks until all restart files have been written.
+    void checkRestartOutput_(bool wait)
+    {
+        if (!lastRestartTasklet_)
+            return;
+
+        if (wait)
+            lastRestartTasklet_->waitUntilFinished();
+
+        if (lastRestartTasklet_->isFinished()) {
+            std::string errorMessage = lastRestartTasklet_->errorMessage();
+            lastRestartTasklet_.reset();
+            if (!errorMessage.empty())
+                throw std::runtime_error("Could not write restart file: "+errorMessage);
+        }
+    }
+
     std::unique_ptr<Vanguard> vanguard_;
     std::unique_ptr<Model> model_;
     std::unique_ptr<Problem> problem_;
@@ -953,12 +1357,14 @@ private:
     Scalar episodeLength_;
 
     Timer setupTimer_;
+    std::vector<std::pair<std::string, Scalar> > setupPhaseTimes_;
     Timer executionTimer_;
     Timer prePostProcessTimer_;
     Timer linearizeTimer_;
     Timer solveTimer_;
     Timer updateTimer_;
     Timer writeTimer_;
+    unsigned numNewtonIterations_;
 
     std::vector<Scalar> forcedTimeSteps_;
     Scalar startTime_;
@@ -970,6 +1376,21 @@ private:
 
     bool finished_;
     bool verbose_;
+
+    bool asyncRestartOutput_;
+    std::shared_ptr<RestartOutputTasklet_> lastRestartTasklet_;
+
+    // the full restart file which the delta restart files refer to
+    unsigned deltaRestartInterval_;
+    unsigned numDeltaRestarts_;
+    std::shared_ptr<const Restart::DeltaBase> restartDeltaBase_;
+
+    bool ownsCommunicationThread_;
+
+    // the threads which do the asynchronous work. this must be destroyed before
+    // everything else, so that all tasklets get completed while the objects they
+    // work on still exist.
+    std::unique_ptr<TaskletRunner> taskletRunner_;
 };
 
 namespace Properties {
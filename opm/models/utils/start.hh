@@ -35,7 +35,10 @@
 #include "parametersystem.hh"
 
 #include <opm/models/utils/simulator.hh>
+#include <opm/models/utils/multilevelmontecarlo.hh>
+#include <opm/models/utils/pararealdriver.hh>
 #include <opm/models/utils/timer.hh>
+#include <opm/models/parallel/communicationthread.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -50,11 +53,14 @@
 #include <dune/fem/misc/mpimanager.hh>
 #endif
 
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <locale>
+#include <utility>
+#include <vector>
 
 #include <stdio.h>
 #include <unistd.h>
@@ -81,6 +87,10 @@ static inline void registerAllParameters_(bool finalizeRegistration = true)
     EWOMS_REGISTER_PARAM(TypeTag, std::string, ParameterFile,
                          "An .ini file which contains a set of run-time "
                          "parameters");
+    EWOMS_REGISTER_PARAM(TypeTag, std::string, EnsembleFile,
+                         "A file which specifies the members of an ensemble of "
+                         "simulations, one per line, which are run one after another "
+                         "in the same process");
     EWOMS_REGISTER_PARAM(TypeTag, int, PrintProperties,
                          "Print the values of the compile time properties at "
                          "the start of the simulation");
@@ -89,6 +99,8 @@ static inline void registerAllParameters_(bool finalizeRegistration = true)
                          "start of the simulation");
 
     Simulator::registerParameters();
+    PararealDriver<TypeTag>::registerParameters();
+    MultilevelMonteCarlo<TypeTag>::registerParameters();
     ThreadManager::registerParameters();
 
     if (finalizeRegistration)
@@ -263,6 +275,156 @@ static inline void resetTerminal_(int signum)
     // after we did our best to clean the pedestrian way, re-raise the signal
     raise(signum);
 }
+
+#if HAVE_MPI
+/*!
+ * \brief Initialize MPI with the thread support required by the communication thread.
+ *
+ * Dune::MPIHelper neither initializes nor finalizes MPI if it has already been
+ * initialized, so MPI is finalized at exit.
+ */
+static inline void initThreadedMpi_(int& argc, char**& argv)
+{
+    int isInitialized = 0;
+    MPI_Initialized(&isInitialized);
+    if (isInitialized)
+        return;
+
+    int provided;
+    MPI_Init_thread(&argc, &argv, CommunicationThread::requiredMpiThreadLevel, &provided);
+    std::atexit([]()
+                {
+                    int isFinalized = 0;
+                    MPI_Finalized(&isFinalized);
+                    if (!isFinalized)
+                        MPI_Finalize();
+                });
+}
+#endif
+
+/*!
+ * \brief Read the members of an ensemble of simulations from a file.
+ *
+ * Each line of the file describes a member and consists of white-space separated
+ * assignments of the form 'ParamName=value'. Everything after a '#' is a comment and
+ * lines which do not contain any assignments are ignored.
+ */
+template <class TypeTag>
+static inline std::vector<std::vector<std::pair<std::string, std::string> > >
+readEnsemble_(const std::string& fileName)
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+    std::ifstream is(fileName);
+    if (!is.is_open())
+        throw std::runtime_error("Ensemble file \""+fileName+"\" does not exist or is not "
+                                 "readable");
+
+    std::vector<std::vector<std::pair<std::string, std::string> > > members;
+    std::string line;
+    unsigned lineIdx = 0;
+    while (std::getline(is, line)) {
+        ++lineIdx;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream iss(line);
+        std::vector<std::pair<std::string, std::string> > assignments;
+        std::string assignment;
+        while (iss >> assignment) {
+            size_t eqPos = assignment.find('=');
+            if (eqPos == std::string::npos || eqPos == 0)
+                throw std::runtime_error(fileName+":"+std::to_string(lineIdx)+": Expected "
+                                         "'ParamName=value' but got '"+assignment+"'");
+
+            std::string paramName = assignment.substr(0, eqPos);
+            if (ParamsMeta::registry().find(paramName) == ParamsMeta::registry().end())
+                throw std::runtime_error(fileName+":"+std::to_string(lineIdx)+": Unknown "
+                                         "parameter '"+paramName+"'");
+
+            assignments.emplace_back(paramName, assignment.substr(eqPos + 1));
+        }
+
+        if (!assignments.empty())
+            members.push_back(std::move(assignments));
+    }
+
+    return members;
+}
+
+/*!
+ * \brief Run the members of an ensemble of simulations one after another.
+ *
+ * The parameters of each member are the ones specified on the command line and by
+ * the parameter file, overwritten by the assignments of the member. Compared with
+ * starting a process for each member, this avoids the costs of starting up and of
+ * initializing MPI. A member which fails does not abort the remaining ones.
+ *
+ * \return The number of members which failed.
+ */
+template <class TypeTag>
+static inline unsigned runEnsemble_(const std::string& ensembleFileName, int myRank)
+{
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+    const auto& members = readEnsemble_<TypeTag>(ensembleFileName);
+    const Dune::ParameterTree baseParams = ParamsMeta::tree();
+
+    std::vector<double> wallTimes(members.size(), 0.0);
+    std::vector<bool> succeeded(members.size(), false);
+    for (size_t memberIdx = 0; memberIdx < members.size(); ++memberIdx) {
+        Dune::ParameterTree memberParams(baseParams);
+        for (const auto& assignment : members[memberIdx])
+            memberParams[assignment.first] = assignment.second;
+        Parameters::overwriteParams<TypeTag>(memberParams);
+
+        if (myRank == 0) {
+            std::cout << "# [ensemble member " << memberIdx + 1 << " of " << members.size() << ":";
+            for (const auto& assignment : members[memberIdx])
+                std::cout << " " << assignment.first << "=" << assignment.second;
+            std::cout << "]\n" << std::flush;
+        }
+
+        // the number of threads may be different for each member and the previous
+        // member may have taken some of them for asynchronous work
+        ThreadManager::init();
+
+        Timer timer;
+        timer.start();
+        try {
+            Simulator simulator;
+            simulator.run();
+            succeeded[memberIdx] = true;
+        }
+        catch (const std::exception& e) {
+            if (myRank == 0)
+                std::cout << "Ensemble member " << memberIdx + 1 << " failed: " << e.what()
+                          << "\n" << std::flush;
+        }
+        wallTimes[memberIdx] = timer.stop();
+    }
+
+    Parameters::overwriteParams<TypeTag>(baseParams);
+
+    unsigned numFailed = 0;
+    if (myRank == 0)
+        std::cout << "# [ensemble summary]\n";
+    for (size_t memberIdx = 0; memberIdx < members.size(); ++memberIdx) {
+        if (!succeeded[memberIdx])
+            ++numFailed;
+
+        if (myRank == 0)
+            std::cout << "member " << memberIdx + 1 << ": "
+                      << (succeeded[memberIdx] ? "succeeded" : "failed")
+                      << " after " << wallTimes[memberIdx] << " seconds\n";
+    }
+    if (myRank == 0)
+        std::cout << numFailed << " of " << members.size() << " members failed\n"
+                  << std::flush;
+
+    return numFailed;
+}
 //! \endcond
 
 /*!
@@ -301,7 +463,10 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
     int myRank = 0;
     try
     {
+        Timer parameterTimer;
+        parameterTimer.start();
         int paramStatus = setupParameters_<TypeTag>(argc, const_cast<const char**>(argv), registerParams);
+        parameterTimer.stop();
         if (paramStatus == 1)
             return 1;
         if (paramStatus == 2)
@@ -314,6 +479,10 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
         Dune::Fem::MPIManager::initialize(argc, argv);
         myRank = Dune::Fem::MPIManager::rank();
 #else
+#if HAVE_MPI
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableCommunicationThread))
+            initThreadedMpi_(argc, argv);
+#endif
         myRank = Dune::MPIHelper::instance(argc, argv).rank();
 #endif
 
@@ -386,11 +555,33 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
                 Properties::printValues<TypeTag>();
         }
 
+        const std::string& ensembleFileName = EWOMS_GET_PARAM(TypeTag, std::string, EnsembleFile);
+        if (!ensembleFileName.empty())
+            return (runEnsemble_<TypeTag>(ensembleFileName, myRank) > 0) ? 1 : 0;
+
+        const std::string& mlmcFileName = EWOMS_GET_PARAM(TypeTag, std::string, MlmcLevelsFile);
+        if (!mlmcFileName.empty()) {
+            MultilevelMonteCarlo<TypeTag> mlmc(readEnsemble_<TypeTag>(mlmcFileName), myRank);
+            mlmc.run();
+            return 0;
+        }
+
         // instantiate and run the concrete problem. make sure to
         // deallocate the problem and before the time manager and the
         // grid
         Simulator simulator;
-        simulator.run();
+        simulator.addPreSetupPhase("Parameter parsing", parameterTimer);
+        if (EWOMS_GET_PARAM(TypeTag, unsigned, PararealSlices) > 1)
+            PararealDriver<TypeTag>(simulator).run();
+        else
+            simulator.run();
+
+#ifndef NDEBUG
+        // point out the parameters which are looked up by name in performance
+        // critical code
+        if (myRank == 0)
+            Parameters::printFrequentLookups<TypeTag>(std::cout, /*threshold=*/10000);
+#endif
 
         if (myRank == 0) {
             std::cout << "eWoms reached the destination. If it is not the one that was intended, "
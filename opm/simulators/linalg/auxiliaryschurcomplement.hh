@@ -0,0 +1,127 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::AuxiliarySchurComplement
+ */
+#ifndef EWOMS_AUXILIARY_SCHUR_COMPLEMENT_HH
+#define EWOMS_AUXILIARY_SCHUR_COMPLEMENT_HH
+
+#include "linalgproperties.hh"
+#include "overlaptypes.hh"
+
+#include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <dune/istl/operators.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief The linear operator which applies the Schur complements of all eliminated
+ *        auxiliary modules of a model to overlapping vectors.
+ *
+ * For each eliminated module, this computes y -= B D^-1 C x, where B and C are the
+ * couplings of the auxiliary equations to the grid and D is their own Jacobian. It is
+ * used as the correction of the overlapping operator, so the Krylov solvers see the
+ * reduced system A - B D^-1 C while the preconditioners only operate on the sparse
+ * matrix A. This keeps dense rows and columns of auxiliary equations which couple to
+ * many degrees of freedom out of the matrix.
+ */
+template <class TypeTag, class OverlappingVector>
+class AuxiliarySchurComplement
+    : public Dune::LinearOperator<OverlappingVector, OverlappingVector>
+{
+    using Model = GetPropType<TypeTag, Properties::Model>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using AuxiliaryModule = BaseAuxiliaryModule<TypeTag>;
+    using Overlap = GetPropType<TypeTag, Properties::Overlap>;
+    using field_type = typename OverlappingVector::field_type;
+
+public:
+    AuxiliarySchurComplement(const Model& model, const Overlap& overlap)
+        : overlap_(overlap)
+    {
+        for (unsigned auxModIdx = 0; auxModIdx < model.numAuxiliaryModules(); ++auxModIdx) {
+            const AuxiliaryModule* auxMod = model.auxiliaryModule(auxModIdx);
+            if (auxMod->isEliminated())
+                modules_.push_back(auxMod);
+        }
+    }
+
+    /*!
+     * \brief Returns true if the model does not have any eliminated auxiliary modules.
+     */
+    bool empty() const
+    { return modules_.empty(); }
+
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::overlapping; }
+
+    //! compute y = - B D^-1 C x
+    void apply(const OverlappingVector& x, OverlappingVector& y) const override
+    {
+        y = 0.0;
+        applyscaleadd(1.0, x, y);
+    }
+
+    //! compute y += - alpha B D^-1 C x
+    void applyscaleadd(field_type alpha, const OverlappingVector& x, OverlappingVector& y) const override
+    {
+        x.assignTo(nativeX_);
+        nativeY_.resize(nativeX_.size());
+        nativeY_ = 0.0;
+        for (const AuxiliaryModule* auxMod : modules_)
+            auxMod->applySchurComplement(nativeX_, nativeY_);
+
+        size_t numNative = overlap_.numNative();
+        for (unsigned nativeRowIdx = 0; nativeRowIdx < numNative; ++nativeRowIdx) {
+            Index domRowIdx = overlap_.nativeToDomestic(static_cast<Index>(nativeRowIdx));
+            if (domRowIdx >= 0)
+                y[static_cast<unsigned>(domRowIdx)].axpy(alpha, nativeY_[nativeRowIdx]);
+        }
+
+        // the coupled degrees of freedom are interior, i.e., the peer processes only
+        // need to get the values of their overlap from their master processes
+        if (!overlap_.peerSet().empty())
+            y.sync();
+    }
+
+private:
+    const Overlap& overlap_;
+    std::vector<const AuxiliaryModule*> modules_;
+
+    mutable GlobalEqVector nativeX_;
+    mutable GlobalEqVector nativeY_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
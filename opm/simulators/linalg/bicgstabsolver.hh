@@ -36,6 +36,8 @@
 
 #include <opm/material/common/Exceptions.hpp>
 
+#include <algorithm>
+#include <array>
 #include <memory>
 
 namespace Opm {
@@ -48,8 +50,23 @@ namespace Linear {
  *
  * See https://en.wikipedia.org/wiki/Biconjugate_gradient_stabilized_method, (article
  * date: December 19, 2016)
+ *
+ * In parallel, each scalar product requires a global reduction, i.e., a synchronization
+ * of all processes. If the reductions are fused (see setFuseReductions()), the scalar
+ * products which are required to compute omega and the rho of the next iteration are
+ * computed using a single reduction. This is possible because (r0hat, r_i) = (r0hat, s) -
+ * omega*(r0hat, t). As a result, an iteration only requires two instead of four global
+ * reductions for the scalar products. To take advantage of this, the scalar product
+ * needs to provide a dots() method like OverlappingScalarProduct does. Otherwise, the
+ * scalar products are computed one after the other.
+ *
+ * If the convergence criterion supports it (see
+ * ConvergenceCriterion::supportsPartialUpdates()), it is evaluated chunk by chunk
+ * within the loops which update the solution and the residual, so that each block of
+ * the residual only needs to be read from main memory once per update.
  */
-template <class LinearOperator, class Vector, class Preconditioner>
+template <class LinearOperator, class Vector, class Preconditioner,
+          class ScalarProduct = Dune::ScalarProduct<Vector> >
 class BiCGStabSolver
 {
     using ConvergenceCriterion = Opm::Linear::ConvergenceCriterion<Vector>;
@@ -58,7 +75,7 @@ class BiCGStabSolver
 public:
     BiCGStabSolver(Preconditioner& preconditioner,
                    ConvergenceCriterion& convergenceCriterion,
-                   Dune::ScalarProduct<Vector>& scalarProduct)
+                   ScalarProduct& scalarProduct)
         : preconditioner_(preconditioner)
         , convergenceCriterion_(convergenceCriterion)
         , scalarProduct_(scalarProduct)
@@ -67,6 +84,7 @@ public:
         b_ = nullptr;
 
         maxIterations_ = 1000;
+        fuseReductions_ = false;
     }
 
     /*!
@@ -83,6 +101,23 @@ public:
     unsigned maxIterations() const
     { return maxIterations_; }
 
+    /*!
+     * \brief Specify whether the scalar products of an iteration should be computed
+     *        using as few global reductions as possible.
+     *
+     * The results are mathematically equivalent, but they may slightly differ due to
+     * rounding.
+     */
+    void setFuseReductions(bool value)
+    { fuseReductions_ = value; }
+
+    /*!
+     * \brief Return whether the scalar products of an iteration are computed using as
+     *        few global reductions as possible.
+     */
+    bool fuseReductions() const
+    { return fuseReductions_; }
+
     /*!
      * \brief Set the verbosity level of the linear solver
      *
@@ -192,9 +227,21 @@ public:
         Vector& t(y);
         unsigned n = x.size();
 
+        // the number of blocks which are processed at once if the convergence criterion
+        // is evaluated within the vector updates. this is chosen such that the chunks of
+        // all involved vectors fit into the L1 cache for typical block sizes.
+        const unsigned chunkSize = 256;
+        const bool partialUpdates = convergenceCriterion_.supportsPartialUpdates();
+
+        // if the reductions are fused, rho_i is computed at the end of the previous
+        // iteration
+        Scalar nextRho = 0.0;
+        if (fuseReductions_)
+            nextRho = scalarProduct_.dot(r0hat, r);
+
         for (; report_.iterations() < maxIterations_; report_.increment()) {
             // rho_i = (r0hat,r_(i-1))
-            Scalar rho_i = scalarProduct_.dot(r0hat, r);
+            Scalar rho_i = fuseReductions_ ? nextRho : scalarProduct_.dot(r0hat, r);
 
             // beta = (rho_i/rho_(i-1))*(alpha/omega_(i-1))
             if (std::abs(rho) <= breakdownEps || std::abs(omega) <= breakdownEps)
@@ -237,20 +284,35 @@ public:
 
             // h = x_(i-1) + alpha*y
             // s = r_(i-1) - alpha*v_i
-            for (unsigned i = 0; i < n; ++i) {
-                auto tmp = y[i];
-                tmp *= alpha;
-                tmp += x[i];
-                h[i] = tmp;
-
-                //s[i] = r[i]; // not necessary because r and s are the same object
-                tmp = v[i];
-                tmp *= alpha;
-                s[i] -= tmp;
+            //
+            // if possible, the convergence criterion is updated for each chunk of the
+            // vectors right after it has been computed
+            if (partialUpdates)
+                convergenceCriterion_.beginUpdate();
+            for (unsigned chunkBegin = 0; chunkBegin < n; chunkBegin += chunkSize) {
+                unsigned chunkEnd = std::min(n, chunkBegin + chunkSize);
+                for (unsigned i = chunkBegin; i < chunkEnd; ++i) {
+                    auto tmp = y[i];
+                    tmp *= alpha;
+                    tmp += x[i];
+                    h[i] = tmp;
+
+                    //s[i] = r[i]; // not necessary because r and s are the same object
+                    tmp = v[i];
+                    tmp *= alpha;
+                    s[i] -= tmp;
+                }
+
+                if (partialUpdates)
+                    convergenceCriterion_.updatePartial(/*curSol=*/h, /*delta=*/y, s,
+                                                        chunkBegin, chunkEnd);
             }
 
             // do convergence check and print terminal output
-            convergenceCriterion_.update(/*curSol=*/h, /*delta=*/y, s);
+            if (partialUpdates)
+                convergenceCriterion_.endUpdate();
+            else
+                convergenceCriterion_.update(/*curSol=*/h, /*delta=*/y, s);
             if (convergenceCriterion_.converged()) {
                 if (verbosity_ > 0) {
                     convergenceCriterion_.print(report_.iterations() + 0.5);
@@ -284,19 +346,51 @@ public:
             A_->apply(z, t);
 
             // omega_i = (t*s)/(t*t)
-            denom = scalarProduct_.dot(t, t);
-            if (std::abs(denom) <= breakdownEps)
-                throw Opm::NumericalIssue("Breakdown of the BiCGStab solver (division by zero)");
-            omega = scalarProduct_.dot(t, s)/denom;
+            if (fuseReductions_) {
+                // compute (t,t), (t,s), (r0hat,s) and (r0hat,t) using a single reduction
+                const auto& d = dots_<4>({ &t, &t, &r0hat, &r0hat },
+                                         { &t, &s, &s, &t });
+                denom = d[0];
+                if (std::abs(denom) <= breakdownEps)
+                    throw Opm::NumericalIssue("Breakdown of the BiCGStab solver (division by zero)");
+                omega = d[1]/denom;
+
+                // rho_(i+1) = (r0hat,r_i) = (r0hat,s) - omega_i*(r0hat,t)
+                nextRho = d[2] - omega*d[3];
+            }
+            else {
+                denom = scalarProduct_.dot(t, t);
+                if (std::abs(denom) <= breakdownEps)
+                    throw Opm::NumericalIssue("Breakdown of the BiCGStab solver (division by zero)");
+                omega = scalarProduct_.dot(t, s)/denom;
+            }
             if (std::abs(omega) <= breakdownEps)
                 throw Opm::NumericalIssue("Breakdown of the BiCGStab solver (stagnation detected)");
 
             // x_i = h + omega_i*z
             // x = h; // not necessary because x and h are the same object
-            x.axpy(/*a=*/omega, /*y=*/z);
+            if (partialUpdates) {
+                convergenceCriterion_.beginUpdate();
+                for (unsigned chunkBegin = 0; chunkBegin < n; chunkBegin += chunkSize) {
+                    unsigned chunkEnd = std::min(n, chunkBegin + chunkSize);
+                    for (unsigned i = chunkBegin; i < chunkEnd; ++i) {
+                        auto tmp = z[i];
+                        tmp *= omega;
+                        x[i] += tmp;
+                    }
+
+                    convergenceCriterion_.updatePartial(/*curSol=*/x, /*delta=*/z, r,
+                                                        chunkBegin, chunkEnd);
+                }
+            }
+            else
+                x.axpy(/*a=*/omega, /*y=*/z);
 
             // do convergence check and print terminal output
-            convergenceCriterion_.update(/*curSol=*/x, /*delta=*/z, r);
+            if (partialUpdates)
+                convergenceCriterion_.endUpdate();
+            else
+                convergenceCriterion_.update(/*curSol=*/x, /*delta=*/z, r);
             if (convergenceCriterion_.converged()) {
                 if (verbosity_ > 0) {
                     convergenceCriterion_.print(1.0 + report_.iterations());
@@ -338,16 +432,43 @@ public:
     { return report_; }
 
 private:
+    template <size_t numDots>
+    std::array<Scalar, numDots> dots_(const std::array<const Vector*, numDots>& xs,
+                                      const std::array<const Vector*, numDots>& ys)
+    { return dotsImpl_<numDots>(scalarProduct_, xs, ys, /*preferFused=*/0); }
+
+    // use the fused scalar products if the scalar product object provides them
+    template <size_t numDots, class SP>
+    static auto dotsImpl_(SP& scalarProduct,
+                          const std::array<const Vector*, numDots>& xs,
+                          const std::array<const Vector*, numDots>& ys,
+                          int)
+        -> decltype(scalarProduct.template dots<numDots>(xs, ys))
+    { return scalarProduct.template dots<numDots>(xs, ys); }
+
+    template <size_t numDots, class SP>
+    static std::array<Scalar, numDots> dotsImpl_(SP& scalarProduct,
+                                                 const std::array<const Vector*, numDots>& xs,
+                                                 const std::array<const Vector*, numDots>& ys,
+                                                 long)
+    {
+        std::array<Scalar, numDots> result;
+        for (unsigned k = 0; k < numDots; ++k)
+            result[k] = scalarProduct.dot(*xs[k], *ys[k]);
+        return result;
+    }
+
     const LinearOperator* A_;
     const Vector* b_;
 
     Preconditioner& preconditioner_;
     ConvergenceCriterion& convergenceCriterion_;
-    Dune::ScalarProduct<Vector>& scalarProduct_;
+    ScalarProduct& scalarProduct_;
     Opm::Linear::SolverReport report_;
 
     unsigned maxIterations_;
     unsigned verbosity_;
+    bool fuseReductions_;
 };
 
 } // namespace Linear
@@ -38,12 +38,17 @@
 
 #include <iostream>
 #include <algorithm>
+#include <map>
+#include <vector>
 
 namespace Opm {
 namespace Linear {
 /*!
  * \brief Expresses which degrees of freedom are blacklisted for the parallel linear
  *        solvers and which domestic indices they correspond to.
+ *
+ * Native indices are dense, so the blacklisted indices and their domestic counterparts
+ * are stored in flat arrays which are indexed by the native index.
  */
 class BlackList
 {
@@ -61,17 +66,25 @@ public:
     BlackList(const BlackList&) = default;
 
     bool hasIndex(Index nativeIdx) const
-    { return nativeBlackListedIndices_.count(nativeIdx) > 0; }
+    {
+        return nativeIdx >= 0
+            && static_cast<size_t>(nativeIdx) < isBlackListed_.size()
+            && isBlackListed_[static_cast<size_t>(nativeIdx)];
+    }
 
     void addIndex(Index nativeIdx)
-    { nativeBlackListedIndices_.insert(nativeIdx); }
+    {
+        size_t idx = static_cast<size_t>(nativeIdx);
+        if (idx >= isBlackListed_.size())
+            isBlackListed_.resize(idx + 1, false);
+        isBlackListed_[idx] = true;
+    }
 
     Index nativeToDomestic(Index nativeIdx) const
     {
-        auto it = nativeToDomesticMap_.find(nativeIdx);
-        if (it == nativeToDomesticMap_.end())
+        if (nativeIdx < 0 || static_cast<size_t>(nativeIdx) >= nativeToDomesticMap_.size())
             return -1;
-        return it->second;
+        return nativeToDomesticMap_[static_cast<size_t>(nativeIdx)];
     }
 
     void setPeerList(ProcessRank peerRank, const PeerBlackList& peerBlackList)
@@ -105,11 +118,10 @@ public:
     void print() const
     {
         std::cout << "my own blacklisted indices:\n";
-        auto idxIt = nativeBlackListedIndices_.begin();
-        const auto& idxEndIt = nativeBlackListedIndices_.end();
-        for (; idxIt != idxEndIt; ++idxIt)
-            std::cout << " (native index: " << *idxIt
-                      << ", domestic index: " << nativeToDomestic(*idxIt) << ")\n";
+        for (size_t idx = 0; idx < isBlackListed_.size(); ++idx)
+            if (isBlackListed_[idx])
+                std::cout << " (native index: " << idx
+                          << ", domestic index: " << nativeToDomestic(static_cast<Index>(idx)) << ")\n";
         std::cout << "blacklisted indices of the peers in my own domain:\n";
         auto peerListIt = peerBlackLists_.begin();
         const auto& peerListEndIt = peerBlackLists_.end();
@@ -163,15 +175,17 @@ private:
         globalIdxBuf.receive(peerRank);
         for (unsigned i = 0; i < numIndices; ++i) {
             Index globalIdx = globalIdxBuf[2*i + 0];
-            Index nativeIdx = globalIdxBuf[2*i + 1];
+            size_t nativeIdx = static_cast<size_t>(globalIdxBuf[2*i + 1]);
 
+            if (nativeIdx >= nativeToDomesticMap_.size())
+                nativeToDomesticMap_.resize(std::max(nativeIdx + 1, isBlackListed_.size()), -1);
             nativeToDomesticMap_[nativeIdx] = domesticOverlap.globalToDomestic(globalIdx);
         }
     }
 #endif // HAVE_MPI
 
-    std::set<Index> nativeBlackListedIndices_;
-    std::map<Index, Index> nativeToDomesticMap_;
+    std::vector<bool> isBlackListed_;
+    std::vector<Index> nativeToDomesticMap_;
 #if HAVE_MPI
     std::map<ProcessRank, MpiBuffer<unsigned>> numGlobalIdxSendBuff_;
     std::map<ProcessRank, MpiBuffer<Index>> globalIdxSendBuff_;
@@ -29,6 +29,7 @@
 
 #include "convergencecriterion.hh"
 
+#include <array>
 #include <iostream>
 
 namespace Opm {
@@ -131,6 +132,59 @@ public:
     void update(const Vector& curSol, const Vector& changeIndicator, const Vector& curResid) override
     { updateErrors_(curSol, changeIndicator, curResid);  }
 
+    /*!
+     * \copydoc ConvergenceCriterion::supportsPartialUpdates()
+     */
+    bool supportsPartialUpdates() const override
+    { return true; }
+
+    /*!
+     * \copydoc ConvergenceCriterion::beginUpdate()
+     */
+    void beginUpdate() override
+    {
+        lastResidualError_ = residualError_;
+        residualError_ = 0.0;
+        stagnates_ = true;
+    }
+
+    /*!
+     * \copydoc ConvergenceCriterion::updatePartial()
+     */
+    void updatePartial(const Vector& curSol OPM_UNUSED,
+                       const Vector& changeIndicator,
+                       const Vector& curResid,
+                       size_t beginIdx,
+                       size_t endIdx) override
+    {
+        for (size_t i = beginIdx; i < endIdx; ++i) {
+            for (unsigned j = 0; j < BlockType::dimension; ++j) {
+                residualError_ =
+                    std::max<Scalar>(residualError_,
+                                     std::abs(curResid[i][j]));
+
+                if (stagnates_ && changeIndicator[i][j] != 0.0)
+                    // only stagnation means that we've failed!
+                    stagnates_ = false;
+            }
+        }
+    }
+
+    /*!
+     * \copydoc ConvergenceCriterion::endUpdate()
+     */
+    void endUpdate() override
+    {
+        // the maximum residual and the stagnation flag are reduced at once. the linear
+        // solver only stagnates if all processes stagnate, i.e., if no process has
+        // seen a change of the solution.
+        std::array<Scalar, 2> values = { residualError_, stagnates_ ? 0.0 : 1.0 };
+        comm_.max(values.data(), values.size());
+
+        residualError_ = values[0];
+        stagnates_ = (values[1] == 0.0);
+    }
+
     /*!
      * \copydoc ConvergenceCriterion::converged()
      */
@@ -184,28 +238,12 @@ public:
     }
 
 private:
-    // update the weighted absolute residual
-    void updateErrors_(const Vector& curSol OPM_UNUSED, const Vector& changeIndicator,  const Vector& curResid)
+    // update the absolute residual
+    void updateErrors_(const Vector& curSol, const Vector& changeIndicator,  const Vector& curResid)
     {
-        lastResidualError_ = residualError_;
-        residualError_ = 0.0;
-        stagnates_ = true;
-        for (size_t i = 0; i < curResid.size(); ++i) {
-            for (unsigned j = 0; j < BlockType::dimension; ++j) {
-                residualError_ =
-                    std::max<Scalar>(residualError_,
-                                     std::abs(curResid[i][j]));
-
-                if (stagnates_ && changeIndicator[i][j] != 0.0)
-                    // only stagnation means that we've failed!
-                    stagnates_ = false;
-            }
-        }
-
-        residualError_ = comm_.max(residualError_);
-
-        // the linear solver only stagnates if all processes stagnate
-        stagnates_ = comm_.min(stagnates_);
+        beginUpdate();
+        updatePartial(curSol, changeIndicator, curResid, /*beginIdx=*/0, curResid.size());
+        endUpdate();
     }
 
     const CollectiveCommunication& comm_;
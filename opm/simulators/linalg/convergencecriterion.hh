@@ -104,6 +104,57 @@ public:
      */
     virtual void update(const Vector& curSol, const Vector& changeIndicator, const Vector& curResid) = 0;
 
+    /*!
+     * \brief Returns true if the criterion can be updated piecewise.
+     *
+     * If this is the case, a linear solver may call beginUpdate(), then updatePartial()
+     * for consecutive ranges of blocks which cover the whole vectors and finally
+     * endUpdate() instead of calling update(). This allows the solver to evaluate the
+     * criterion in the same sweep that computes the residual, i.e., while the blocks of
+     * the residual are still in the cache. All global reductions are done by
+     * endUpdate().
+     */
+    virtual bool supportsPartialUpdates() const
+    { return false; }
+
+    /*!
+     * \brief Start a piecewise update of the convergence criterion.
+     *
+     * This is only called if supportsPartialUpdates() returns true.
+     */
+    virtual void beginUpdate()
+    {}
+
+    /*!
+     * \brief Account for a consecutive range of blocks of the current iterative
+     *        solution.
+     *
+     * This is only called if supportsPartialUpdates() returns true.
+     *
+     * \param curSol The current iterative solution of the linear system
+     *               of equations
+     * \param changeIndicator A vector where all non-zero values indicate that the
+     *                        solution has changed since the last iteration.
+     * \param curResid The residual vector of the current iterative
+     *                 solution of the linear system of equations
+     * \param beginIdx The index of the first block of the range
+     * \param endIdx The index after the last block of the range
+     */
+    virtual void updatePartial(const Vector& curSol OPM_UNUSED,
+                               const Vector& changeIndicator OPM_UNUSED,
+                               const Vector& curResid OPM_UNUSED,
+                               size_t beginIdx OPM_UNUSED,
+                               size_t endIdx OPM_UNUSED)
+    {}
+
+    /*!
+     * \brief Finish a piecewise update of the convergence criterion.
+     *
+     * This is only called if supportsPartialUpdates() returns true.
+     */
+    virtual void endUpdate()
+    {}
+
     /*!
      * \brief Returns true if and only if the convergence criterion is
      *        met.
@@ -0,0 +1,270 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::CprPreconditioner
+ */
+#ifndef EWOMS_CPR_PRECONDITIONER_HH
+#define EWOMS_CPR_PRECONDITIONER_HH
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/paamg/amg.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/version.hh>
+
+#include <memory>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A two-stage constrained pressure residual (CPR) preconditioner.
+ *
+ * The first stage approximately solves for the pressure. For this, a scalar pressure
+ * system is extracted from the block matrix by multiplying each block row with a vector
+ * of weights and taking the column of the pressure unknown. This system is then solved
+ * approximately using a single V-cycle of an algebraic multi-grid (AMG)
+ * preconditioner. The second stage applies ILU(0) to the residual of the full system
+ * which remains after the pressure correction.
+ *
+ * The weights are of the "quasi-IMPES" kind: For each row, they are chosen such that the
+ * diagonal block of the weighted equation only couples to the pressure, i.e., the
+ * transposed diagonal block D_i is used to solve D_i^T w_i = e_p. Since the diagonal
+ * blocks are dominated by the derivatives of the storage terms, this decouples the
+ * pressure from the remaining unknowns in a similar way as the "true-IMPES" weights do.
+ *
+ * The preconditioner works for all models which use the pressure as one of their
+ * primary variables (e.g., the black-oil model), but it only pays off if the system
+ * exhibits the typical elliptic-hyperbolic nature of multi-phase flow problems.
+ */
+template <class Matrix, class Vector>
+class CprPreconditioner : public Dune::Preconditioner<Vector, Vector>
+{
+    using Scalar = typename Matrix::field_type;
+    using MatrixBlock = typename Matrix::block_type;
+    static constexpr int numEq = MatrixBlock::rows;
+
+    using WeightVector = Dune::FieldVector<Scalar, numEq>;
+
+    using PressureMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, 1, 1> >;
+    using PressureVector = Dune::BlockVector<Dune::FieldVector<Scalar, 1> >;
+    using PressureOperator = Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector>;
+    using PressureSmoother = Dune::SeqSSOR<PressureMatrix, PressureVector, PressureVector>;
+    using PressureAmg = Dune::Amg::AMG<PressureOperator, PressureVector, PressureSmoother>;
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
+    using FineSmoother = Dune::SeqILU<Matrix, Vector, Vector>;
+#else
+    using FineSmoother = Dune::SeqILU0<Matrix, Vector, Vector>;
+#endif
+
+public:
+    using domain_type = Vector;
+    using range_type = Vector;
+    using field_type = Scalar;
+
+    /*!
+     * \brief Set up the preconditioner for a given matrix.
+     *
+     * \param A The matrix of the linear system of equations
+     * \param pressureIdx The index of the pressure in the blocks of the matrix
+     * \param relaxationFactor The relaxation factor of the ILU(0) stage
+     * \param coarsenTarget The target number of unknowns for the coarsest level of the AMG
+     */
+    CprPreconditioner(const Matrix& A,
+                      unsigned pressureIdx,
+                      Scalar relaxationFactor,
+                      int coarsenTarget)
+        : A_(A)
+        , pressureIdx_(pressureIdx)
+        , fineSmoother_(A, relaxationFactor)
+    {
+        computeWeights_();
+        extractPressureMatrix_();
+        setupPressureAmg_(coarsenTarget);
+
+        pressureRhs_.resize(A_.N());
+        pressureSol_.resize(A_.N());
+    }
+
+    //! the kind of computations supported by the preconditioner
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    void pre([[maybe_unused]] Vector& x, [[maybe_unused]] Vector& b) override
+    {
+        PressureVector px(A_.N());
+        PressureVector pb(A_.N());
+        px = 0.0;
+        pb = 0.0;
+        pressureAmg_->pre(px, pb);
+    }
+
+    void apply(Vector& v, const Vector& d) override
+    {
+        size_t n = A_.N();
+
+        // first stage: restrict the residual to the pressure equation and solve it
+        // approximately
+        for (unsigned i = 0; i < n; ++i)
+            pressureRhs_[i] = weights_[i]*d[i];
+
+        pressureSol_ = 0.0;
+        pressureAmg_->apply(pressureSol_, pressureRhs_);
+
+        // prolongate the pressure correction to the full system
+        for (unsigned i = 0; i < n; ++i) {
+            v[i] = 0.0;
+            v[i][pressureIdx_] = pressureSol_[i][0];
+        }
+
+        // second stage: apply ILU(0) to the remaining residual of the full system
+        if (residual_.size() != n) {
+            residual_ = d;
+            correction_ = d;
+        }
+        for (unsigned i = 0; i < n; ++i)
+            residual_[i] = d[i];
+        A_.mmv(v, residual_);
+
+        correction_ = 0.0;
+        fineSmoother_.apply(correction_, residual_);
+        v += correction_;
+    }
+
+    void post([[maybe_unused]] Vector& x) override
+    {
+        PressureVector px(A_.N());
+        px = 0.0;
+        pressureAmg_->post(px);
+    }
+
+private:
+    void computeWeights_()
+    {
+        size_t n = A_.N();
+        weights_.resize(n);
+
+        WeightVector unitVector(0.0);
+        unitVector[pressureIdx_] = 1.0;
+        for (unsigned rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const auto& diag = A_[rowIdx][rowIdx];
+
+            Dune::FieldMatrix<Scalar, numEq, numEq> diagT;
+            for (int i = 0; i < numEq; ++i)
+                for (int j = 0; j < numEq; ++j)
+                    diagT[i][j] = diag[j][i];
+
+            try {
+                diagT.solve(weights_[rowIdx], unitVector);
+            }
+            catch (const Dune::FMatrixError&) {
+                // the diagonal block is singular. fall back to taking the sum of all
+                // equations
+                weights_[rowIdx] = 1.0;
+            }
+
+            // normalize the weights so that the scaling of the pressure system does not
+            // depend on the magnitude of the diagonal
+            Scalar maxWeight = weights_[rowIdx].infinity_norm();
+            if (maxWeight > 0.0)
+                weights_[rowIdx] /= maxWeight;
+        }
+    }
+
+    void extractPressureMatrix_()
+    {
+        size_t n = A_.N();
+        pressureMatrix_ = std::make_unique<PressureMatrix>(n, n, A_.nonzeroes(), PressureMatrix::row_wise);
+
+        // the sparsity pattern of the pressure matrix is the same as the one of the full
+        // system
+        auto rowIt = pressureMatrix_->createbegin();
+        const auto& rowEndIt = pressureMatrix_->createend();
+        for (; rowIt != rowEndIt; ++rowIt) {
+            const auto& row = A_[rowIt.index()];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt)
+                rowIt.insert(colIt.index());
+        }
+
+        // p_ij = w_i^T A_ij e_p
+        for (unsigned rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const auto& row = A_[rowIdx];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt) {
+                Scalar value = 0.0;
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    value += weights_[rowIdx][eqIdx]*(*colIt)[eqIdx][pressureIdx_];
+                (*pressureMatrix_)[rowIdx][colIt.index()] = value;
+            }
+        }
+    }
+
+    void setupPressureAmg_(int coarsenTarget)
+    {
+        using SmootherArgs = typename Dune::Amg::SmootherTraits<PressureSmoother>::Arguments;
+        SmootherArgs smootherArgs;
+        smootherArgs.iterations = 1;
+        smootherArgs.relaxationFactor = 1.0;
+
+        using CoarsenCriterion = Dune::Amg::
+            CoarsenCriterion<Dune::Amg::SymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal> >;
+        CoarsenCriterion coarsenCriterion(/*maxLevel=*/15, coarsenTarget);
+        coarsenCriterion.setDefaultValuesIsotropic(/*dim=*/3, /*aggregateSizePerDim=*/2);
+        coarsenCriterion.setDebugLevel(0); // make the AMG shut up
+        coarsenCriterion.setMinCoarsenRate(1.05);
+        coarsenCriterion.setAccumulate(Dune::Amg::atOnceAccu);
+        coarsenCriterion.setSkipIsolated(false);
+
+        pressureOperator_ = std::make_unique<PressureOperator>(*pressureMatrix_);
+        pressureAmg_ = std::make_unique<PressureAmg>(*pressureOperator_, coarsenCriterion, smootherArgs);
+    }
+
+    const Matrix& A_;
+    unsigned pressureIdx_;
+
+    std::vector<WeightVector> weights_;
+    std::unique_ptr<PressureMatrix> pressureMatrix_;
+    std::unique_ptr<PressureOperator> pressureOperator_;
+    std::unique_ptr<PressureAmg> pressureAmg_;
+    FineSmoother fineSmoother_;
+
+    PressureVector pressureRhs_;
+    PressureVector pressureSol_;
+    Vector residual_;
+    Vector correction_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -87,6 +87,14 @@ public:
         blackList_.updateNativeToDomesticMap(*this);
 
         setupDebugMapping_();
+
+        // without peers and black-listed indices, the domestic indices are usually
+        // identical to the native ones
+        nativeLayout_ = peerSet_.empty() && numDomestic() == numNative();
+        for (size_t nativeIdx = 0; nativeLayout_ && nativeIdx < numNative(); ++nativeIdx) {
+            Index idx = static_cast<Index>(nativeIdx);
+            nativeLayout_ = nativeToDomestic(idx) == idx;
+        }
     }
 
     void check() const
@@ -138,6 +146,16 @@ public:
     unsigned worldSize() const
     { return worldSize_; }
 
+    /*!
+     * \brief Returns true if the domestic indices are identical to the native ones and
+     *        if there are no peer processes.
+     *
+     * In this case, overlapping objects can be converted from and to native ones
+     * without any index translation or communication.
+     */
+    bool hasNativeLayout() const
+    { return nativeLayout_; }
+
     /*!
      * \brief Return the set of process ranks which share an overlap
      *        with the current process.
@@ -384,6 +402,12 @@ protected:
         domesticOverlapByIndex_.resize(numLocal());
         borderDistance_.resize(numLocal(), 0);
 
+#if HAVE_MPI && MPI_VERSION >= 3
+        // exchange the overlap with all peers at once using a neighborhood
+        // collective. this only involves the peer processes, so its cost does not
+        // depend on the total number of processes
+        exchangeIndicesWithPeers_();
+#else
         PeerSet::const_iterator peerIt;
         PeerSet::const_iterator peerEndIt = peerSet_.end();
 
@@ -407,7 +431,77 @@ protected:
             ProcessRank peerRank = *peerIt;
             waitSendIndices_(peerRank);
         }
+#endif
+    }
+
+#if HAVE_MPI && MPI_VERSION >= 3
+    void exchangeIndicesWithPeers_()
+    {
+        // the overlap relation is symmetric, i.e., the set of peers is the set of
+        // processes we send to as well as the one we receive from
+        std::vector<int> peers(peerSet_.begin(), peerSet_.end());
+        int numPeers = static_cast<int>(peers.size());
+
+        MPI_Comm peerComm;
+        MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD,
+                                       numPeers, peers.data(), MPI_UNWEIGHTED,
+                                       numPeers, peers.data(), MPI_UNWEIGHTED,
+                                       MPI_INFO_NULL,
+                                       /*reorder=*/0,
+                                       &peerComm);
+
+        // collect the indices of the foreign overlap of all peers in a single
+        // buffer
+        std::vector<IndexDistanceNpeers> sendBuff;
+        std::vector<int> sendCounts(peers.size());
+        std::vector<int> sendOffsets(peers.size());
+        for (unsigned i = 0; i < peers.size(); ++i) {
+            const auto& foreignOverlap =
+                foreignOverlap_.foreignOverlapWithPeer(static_cast<ProcessRank>(peers[i]));
+
+            sendOffsets[i] = static_cast<int>(sendBuff.size()*sizeof(IndexDistanceNpeers));
+            sendCounts[i] = static_cast<int>(foreignOverlap.size()*sizeof(IndexDistanceNpeers));
+            for (const auto& overlapEntry : foreignOverlap) {
+                Index localIdx = overlapEntry.index;
+
+                IndexDistanceNpeers tmp;
+                tmp.index = globalIndices_.domesticToGlobal(localIdx);
+                tmp.borderDistance = overlapEntry.borderDistance;
+                tmp.numPeers =
+                    static_cast<unsigned>(foreignOverlap_.foreignOverlapByLocalIndex(localIdx).size());
+                sendBuff.push_back(tmp);
+            }
+        }
+
+        // tell the peers how much they will receive
+        std::vector<int> recvCounts(peers.size());
+        MPI_Neighbor_alltoall(sendCounts.data(), 1, MPI_INT,
+                              recvCounts.data(), 1, MPI_INT,
+                              peerComm);
+
+        std::vector<int> recvOffsets(peers.size());
+        size_t recvBytes = 0;
+        for (unsigned i = 0; i < peers.size(); ++i) {
+            recvOffsets[i] = static_cast<int>(recvBytes);
+            recvBytes += static_cast<size_t>(recvCounts[i]);
+        }
+
+        // exchange the indices themselfs
+        std::vector<IndexDistanceNpeers> recvBuff(recvBytes/sizeof(IndexDistanceNpeers));
+        MPI_Neighbor_alltoallv(sendBuff.data(), sendCounts.data(), sendOffsets.data(), MPI_BYTE,
+                               recvBuff.data(), recvCounts.data(), recvOffsets.data(), MPI_BYTE,
+                               peerComm);
+        MPI_Comm_free(&peerComm);
+
+        // add the received indices to the domestic overlap. this is done in the
+        // order of the peer ranks, so the domestic indices are the same as the ones
+        // which are created by the point-to-point code path
+        for (unsigned i = 0; i < peers.size(); ++i)
+            addIndicesFromPeer_(static_cast<ProcessRank>(peers[i]),
+                                recvBuff.data() + recvOffsets[i]/sizeof(IndexDistanceNpeers),
+                                static_cast<size_t>(recvCounts[i])/sizeof(IndexDistanceNpeers));
     }
+#endif // HAVE_MPI && MPI_VERSION >= 3
 
     void updateMasterRanks_()
     {
@@ -501,9 +595,21 @@ protected:
         // receive the additional indices themselfs
         MpiBuffer<IndexDistanceNpeers> recvBuff(static_cast<size_t>(numIndices));
         recvBuff.receive(peerRank);
-        for (unsigned i = 0; i < static_cast<unsigned>(numIndices); ++i) {
-            Index globalIdx = recvBuff[i].index;
-            BorderDistance borderDistance = recvBuff[i].borderDistance;
+        if (numIndices > 0)
+            addIndicesFromPeer_(peerRank, &recvBuff[0], static_cast<size_t>(numIndices));
+#endif // HAVE_MPI
+    }
+
+    // add the indices of the foreign overlap of a peer process to the domestic
+    // overlap
+    void addIndicesFromPeer_([[maybe_unused]] ProcessRank peerRank,
+                             [[maybe_unused]] const IndexDistanceNpeers* indices,
+                             [[maybe_unused]] size_t numIndices)
+    {
+#if HAVE_MPI
+        for (size_t i = 0; i < numIndices; ++i) {
+            Index globalIdx = indices[i].index;
+            BorderDistance borderDistance = indices[i].borderDistance;
 
             // if the index is not already known, add it to the
             // domestic indices
@@ -575,6 +681,7 @@ protected:
     std::map<ProcessRank, MpiBuffer<IndexDistanceNpeers> *> indicesSendBuffer_;
     GlobalIndices globalIndices_;
     PeerSet peerSet_;
+    bool nativeLayout_;
 };
 
 } // namespace Linear
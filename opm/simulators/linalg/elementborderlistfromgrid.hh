@@ -34,12 +34,15 @@
 
 #include <dune/grid/common/datahandleif.hh>
 #include <dune/grid/common/gridenums.hh>
+#include <dune/grid/common/partitionset.hh>
+#include <dune/grid/common/rangegenerators.hh>
 #include <dune/istl/bcrsmatrix.hh>
 #include <dune/istl/scalarproducts.hh>
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
 #include <algorithm>
+#include <set>
 
 namespace Opm {
 namespace Linear {
@@ -47,6 +50,9 @@ namespace Linear {
  * \brief Uses communication on the grid to find the initial seed list
  *        of indices for methods which use element-based degrees of
  *        freedom.
+ *
+ * The border list and the black lists of the peers are determined by a single
+ * communication on the grid.
  */
 template <class GridView, class ElementMapper>
 class ElementBorderListFromGrid
@@ -57,28 +63,24 @@ class ElementBorderListFromGrid
 
     using Element = typename GridView::template Codim<0>::Entity;
 
+    // exchanges the rank and the index of each element with the processes which see it.
+    // this yields the black list of the peers and, for the elements which are adjacent
+    // to an interior one, the border list. both are determined by a single
+    // communication.
     class BorderListHandle_
-        : public Dune::CommDataHandleIF<BorderListHandle_, ProcessRank>
+        : public Dune::CommDataHandleIF<BorderListHandle_, int>
     {
     public:
         BorderListHandle_(const GridView& gridView,
                           const ElementMapper& map,
-                          BlackList& blackList,
-                          BorderList& borderList)
+                          BorderList& borderList,
+                          PeerBlackLists& peerBlackLists)
             : gridView_(gridView)
             , map_(map)
-            , blackList_(blackList)
+            , myRank_(gridView.comm().rank())
             , borderList_(borderList)
-        {
-            auto elemIt = gridView_.template begin<0>();
-            const auto& elemEndIt = gridView_.template end<0>();
-            for (; elemIt != elemEndIt; ++elemIt) {
-                if (elemIt->partitionType() != Dune::InteriorEntity) {
-                    Index elemIdx = static_cast<Index>(map_.index(*elemIt));
-                    blackList_.addIndex(elemIdx);
-                }
-            }
-        }
+            , peerBlackLists_(peerBlackLists)
+        {}
 
         // data handle methods
         bool contains(int dim OPM_UNUSED, int codim) const
@@ -94,9 +96,8 @@ class ElementBorderListFromGrid
         template <class MessageBufferImp, class EntityType>
         void gather(MessageBufferImp& buff, const EntityType& e) const
         {
-            unsigned myIdx = static_cast<unsigned>(map_.index(e));
-            buff.write(static_cast<unsigned>(gridView_.comm().rank()));
-            buff.write(myIdx);
+            buff.write(myRank_);
+            buff.write(static_cast<int>(map_.index(e)));
         }
 
         template <class MessageBufferImp>
@@ -104,14 +105,24 @@ class ElementBorderListFromGrid
                      const Element& e,
                      size_t n OPM_UNUSED)
         {
-            // discard the index if it is not on the process boundary
+            int peerRank;
+            int peerIdx;
+            buff.read(peerRank);
+            buff.read(peerIdx);
+            Index localIdx = static_cast<Index>(map_.index(e));
+
+            PeerBlackListedEntry pIdx;
+            pIdx.nativeIndexOfPeer = static_cast<Index>(peerIdx);
+            pIdx.myOwnNativeIndex = localIdx;
+            peerBlackLists_[static_cast<ProcessRank>(peerRank)].push_back(pIdx);
+
+            // discard the index for the border list if it is not on the process
+            // boundary
             bool isInteriorNeighbor = false;
-            auto isIt = gridView_.ibegin(e);
-            const auto& isEndIt = gridView_.iend(e);
-            for (; isIt != isEndIt; ++isIt) {
-                if (!isIt->neighbor())
-                    continue;
-                else if (isIt->outside().partitionType() == Dune::InteriorEntity) {
+            for (const auto& intersection : intersections(gridView_, e)) {
+                if (intersection.neighbor()
+                    && intersection.outside().partitionType() == Dune::InteriorEntity)
+                {
                     isInteriorNeighbor = true;
                     break;
                 }
@@ -120,22 +131,13 @@ class ElementBorderListFromGrid
                 return;
 
             BorderIndex bIdx;
-
-            bIdx.localIdx = static_cast<Index>(map_.index(e));
-            {
-                ProcessRank tmp;
-                buff.read(tmp);
-                bIdx.peerRank = tmp;
-                peerSet_.insert(tmp);
-            }
-            {
-                unsigned tmp;
-                buff.read(tmp);
-                bIdx.peerIdx = static_cast<Index>(tmp);
-            }
+            bIdx.localIdx = localIdx;
+            bIdx.peerRank = static_cast<ProcessRank>(peerRank);
+            bIdx.peerIdx = static_cast<Index>(peerIdx);
             bIdx.borderDistance = 1;
-
             borderList_.push_back(bIdx);
+
+            peerSet_.insert(static_cast<ProcessRank>(peerRank));
         }
 
         // this template method is needed because the above one only works for codim-0
@@ -153,66 +155,10 @@ class ElementBorderListFromGrid
     private:
         GridView gridView_;
         const ElementMapper& map_;
+        int myRank_;
         std::set<ProcessRank> peerSet_;
-        BlackList& blackList_;
         BorderList& borderList_;
-    };
-
-    class PeerBlackListHandle_
-        : public Dune::CommDataHandleIF<PeerBlackListHandle_, int>
-    {
-    public:
-        PeerBlackListHandle_(const GridView& gridView,
-                             const ElementMapper& map,
-                             PeerBlackLists& peerBlackLists)
-            : gridView_(gridView)
-            , map_(map)
-            , peerBlackLists_(peerBlackLists)
-        {}
-
-        // data handle methods
-        bool contains(int dim OPM_UNUSED, int codim) const
-        { return codim == 0; }
-
-        bool fixedsize(int dim OPM_UNUSED, int codim OPM_UNUSED) const
-        { return true; }
-
-        template <class EntityType>
-        size_t size(const EntityType& e OPM_UNUSED) const
-        { return 2; }
-
-        template <class MessageBufferImp, class EntityType>
-        void gather(MessageBufferImp& buff, const EntityType& e) const
-        {
-            buff.write(static_cast<int>(gridView_.comm().rank()));
-            buff.write(static_cast<int>(map_.index(e)));
-        }
-
-        template <class MessageBufferImp, class EntityType>
-        void scatter(MessageBufferImp& buff, const EntityType& e, size_t n OPM_UNUSED)
-        {
-            int peerRank;
-            int peerIdx;
-            Index localIdx;
-
-            buff.read(peerRank);
-            buff.read(peerIdx);
-            localIdx = static_cast<Index>(map_.index(e));
-
-            PeerBlackListedEntry pIdx;
-            pIdx.nativeIndexOfPeer = static_cast<Index>(peerIdx);
-            pIdx.myOwnNativeIndex = static_cast<Index>(localIdx);
-
-            peerBlackLists_[static_cast<ProcessRank>(peerRank)].push_back(pIdx);
-        }
-
-        const PeerBlackList& peerBlackList(ProcessRank peerRank) const
-        { return peerBlackLists_.at(peerRank); }
-
-    private:
-        GridView gridView_;
-        const ElementMapper& map_;
-        PeerBlackLists peerBlackLists_;
+        PeerBlackLists& peerBlackLists_;
     };
 
 public:
@@ -220,21 +166,19 @@ public:
         : gridView_(gridView)
         , map_(map)
     {
-        BorderListHandle_ blh(gridView, map, blackList_, borderList_);
-        gridView.communicate(blh,
-                             Dune::InteriorBorder_All_Interface,
-                             Dune::BackwardCommunication);
+        // the elements which are not interior are black-listed
+        for (const auto& elem : elements(gridView, Dune::Partitions::all)) {
+            if (elem.partitionType() != Dune::InteriorEntity)
+                blackList_.addIndex(static_cast<Index>(map_.index(elem)));
+        }
 
-        PeerBlackListHandle_ pblh(gridView, map, peerBlackLists_);
-        gridView.communicate(pblh,
+        BorderListHandle_ blh(gridView, map, borderList_, peerBlackLists_);
+        gridView.communicate(blh,
                              Dune::InteriorBorder_All_Interface,
                              Dune::BackwardCommunication);
 
-        auto peerIt = blh.peerSet().begin();
-        const auto& peerEndIt = blh.peerSet().end();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            blackList_.setPeerList(*peerIt, pblh.peerBlackList(*peerIt));
-        }
+        for (const auto peerRank : blh.peerSet())
+            blackList_.setPeerList(peerRank, peerBlackLists_.at(peerRank));
     }
 
     // Access to the border list.
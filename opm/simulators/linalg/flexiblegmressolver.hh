@@ -0,0 +1,186 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::FlexibleGmresSolver
+ */
+#ifndef EWOMS_FLEXIBLE_GMRES_SOLVER_HH
+#define EWOMS_FLEXIBLE_GMRES_SOLVER_HH
+
+#include <cmath>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A restarted flexible GMRES solver for linear operators which are only given as
+ *        functions.
+ *
+ * In contrast to the solvers of dune-istl, neither the linear operator nor the
+ * preconditioner need to be represented by objects of a specific class: Both are
+ * callables of the form <tt>void(const Vector& v, Vector& y)</tt> which compute y = A v
+ * and y = M^-1 v. This allows to solve systems whose matrix is not available (e.g.,
+ * for Jacobian-free Newton-Krylov methods). Since the preconditioned vectors are stored,
+ * the preconditioner may change between iterations, e.g., if it is an iterative solver
+ * itself.
+ *
+ * The scalar products are computed using the dot() method of the vectors, i.e., the
+ * solver only works for sequential problems.
+ */
+template <class Vector>
+class FlexibleGmresSolver
+{
+    using Scalar = typename Vector::field_type;
+
+public:
+    /*!
+     * \brief Create a solver.
+     *
+     * \param restart The number of iterations after which the Krylov space is discarded
+     * \param maxIterations The maximum number of iterations
+     * \param tolerance The reduction of the residual which is required for convergence
+     */
+    FlexibleGmresSolver(unsigned restart, unsigned maxIterations, Scalar tolerance)
+        : restart_(restart)
+        , maxIterations_(maxIterations)
+        , tolerance_(tolerance)
+        , iterations_(0)
+    {}
+
+    /*!
+     * \brief Solve A x = b, starting with x = 0.
+     *
+     * \return true if the residual was reduced by the tolerance
+     */
+    template <class Operator, class Preconditioner>
+    bool solve(const Operator& applyOperator,
+               const Preconditioner& applyPreconditioner,
+               Vector& x,
+               const Vector& b)
+    {
+        iterations_ = 0;
+        x = 0.0;
+
+        Vector r(b);
+        Scalar beta = r.two_norm();
+        if (beta == 0.0)
+            return true;
+        Scalar targetResid = tolerance_*beta;
+
+        std::vector<Vector> V(restart_ + 1, b);
+        std::vector<Vector> Z(restart_, b);
+        std::vector<std::vector<Scalar> > H(restart_ + 1, std::vector<Scalar>(restart_, 0.0));
+        std::vector<Scalar> g(restart_ + 1);
+        std::vector<Scalar> cs(restart_);
+        std::vector<Scalar> sn(restart_);
+        std::vector<Scalar> y(restart_);
+
+        while (iterations_ < maxIterations_) {
+            V[0] = r;
+            V[0] *= 1.0/beta;
+            std::fill(g.begin(), g.end(), 0.0);
+            g[0] = beta;
+
+            unsigned k = 0;
+            bool converged = false;
+            for (unsigned j = 0; j < restart_ && iterations_ < maxIterations_; ++j) {
+                applyPreconditioner(V[j], Z[j]);
+                applyOperator(Z[j], V[j + 1]);
+
+                // modified Gram-Schmidt orthogonalization
+                Vector& w = V[j + 1];
+                for (unsigned i = 0; i <= j; ++i) {
+                    H[i][j] = w.dot(V[i]);
+                    w.axpy(-H[i][j], V[i]);
+                }
+                H[j + 1][j] = w.two_norm();
+                if (H[j + 1][j] > 0.0)
+                    w *= 1.0/H[j + 1][j];
+
+                // apply the previous Givens rotations to the new column of the Hessenberg
+                // matrix and compute a new one which eliminates its subdiagonal entry
+                for (unsigned i = 0; i < j; ++i) {
+                    Scalar tmp = cs[i]*H[i][j] + sn[i]*H[i + 1][j];
+                    H[i + 1][j] = -sn[i]*H[i][j] + cs[i]*H[i + 1][j];
+                    H[i][j] = tmp;
+                }
+                Scalar denom = std::sqrt(H[j][j]*H[j][j] + H[j + 1][j]*H[j + 1][j]);
+                cs[j] = (denom > 0.0) ? H[j][j]/denom : 1.0;
+                sn[j] = (denom > 0.0) ? H[j + 1][j]/denom : 0.0;
+                H[j][j] = denom;
+                H[j + 1][j] = 0.0;
+                g[j + 1] = -sn[j]*g[j];
+                g[j] = cs[j]*g[j];
+
+                ++iterations_;
+                k = j + 1;
+                converged = std::abs(g[j + 1]) <= targetResid;
+                if (converged || denom == 0.0)
+                    break;
+            }
+
+            // solve the upper triangular system and update the solution
+            for (int i = static_cast<int>(k) - 1; i >= 0; --i) {
+                y[i] = g[i];
+                for (unsigned l = static_cast<unsigned>(i) + 1; l < k; ++l)
+                    y[i] -= H[i][l]*y[l];
+                // a vanishing diagonal entry means that the Krylov space does not
+                // contain any further information
+                y[i] = (H[i][i] != 0.0) ? y[i]/H[i][i] : 0.0;
+            }
+            for (unsigned i = 0; i < k; ++i)
+                x.axpy(y[i], Z[i]);
+
+            if (converged)
+                return true;
+
+            // restart using the true residual
+            applyOperator(x, r);
+            r *= -1.0;
+            r += b;
+            beta = r.two_norm();
+            if (beta <= targetResid)
+                return true;
+        }
+
+        return false;
+    }
+
+    /*!
+     * \brief Returns the number of iterations used by the last call of solve().
+     */
+    unsigned iterations() const
+    { return iterations_; }
+
+private:
+    unsigned restart_;
+    unsigned maxIterations_;
+    Scalar tolerance_;
+    unsigned iterations_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
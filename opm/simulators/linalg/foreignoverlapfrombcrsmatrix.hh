@@ -90,8 +90,9 @@ public:
         // Computes the local <-> native index maps
         createLocalIndices_();
 
-        // calculate the set of local indices on the border (beware:
-        // _not_ the native ones)
+        // flag the local indices on the border (beware: _not_ the
+        // native ones)
+        isLocalBorderIndex_.resize(numLocal_, /*value=*/0);
         auto it = borderList.begin();
         const auto& endIt = borderList.end();
         for (; it != endIt; ++it) {
@@ -99,7 +100,7 @@ public:
             if (localIdx < 0)
                 continue;
 
-            localBorderIndices_.insert(localIdx);
+            isLocalBorderIndex_[static_cast<unsigned>(localIdx)] = 1;
         }
 
         // compute the set of processes which are neighbors of the
@@ -149,7 +150,11 @@ public:
      * \brief Returns true iff a local index is a border index.
      */
     bool isBorder(Index localIdx) const
-    { return localBorderIndices_.count(localIdx) > 0; }
+    {
+        return localIdx >= 0
+            && static_cast<size_t>(localIdx) < isLocalBorderIndex_.size()
+            && isLocalBorderIndex_[static_cast<unsigned>(localIdx)];
+    }
 
     /*!
      * \brief Returns true iff a local index is a border index shared with a
@@ -206,7 +211,7 @@ public:
      * \brief Return the map of (peer rank, border distance) for a given local
      * index.
      */
-    const std::map<ProcessRank, BorderDistance> &
+    const IndexOverlap&
     foreignOverlapByLocalIndex(Index localIdx) const
     {
         assert(isLocal(localIdx));
@@ -681,9 +686,9 @@ protected:
     // index
     std::vector<ProcessRank> masterRank_;
 
-    // set of all local indices which are on the border of some remote
-    // process
-    std::set<Index> localBorderIndices_;
+    // flags all local indices which are on the border of some remote
+    // process. this is queried for every row, so it is not a set
+    std::vector<unsigned char> isLocalBorderIndex_;
 
     // stores the set of process ranks which are in the overlap for a
     // given row index "owned" by the current rank. The second value
@@ -0,0 +1,258 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::Linear::FractureBlockPreconditioner
+ */
+#ifndef EWOMS_FRACTURE_BLOCK_PRECONDITIONER_HH
+#define EWOMS_FRACTURE_BLOCK_PRECONDITIONER_HH
+
+#include <opm/simulators/linalg/cprpreconditioner.hh>
+#include <opm/simulators/linalg/umfpackbackend.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <dune/common/version.hh>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A block preconditioner which treats the rows of the degrees of freedom that
+ *        are cut by fractures separately from the ones of the rock matrix.
+ *
+ * The couplings of the fracture degrees of freedom are orders of magnitude stronger
+ * than the ones of the matrix, which makes ILU and AMG applied to the combined system
+ * converge poorly. Instead, the unknowns are split into a fracture block F and a matrix
+ * block M and one symmetric block Gauss-Seidel sweep is done:
+ *
+ * - x_F = A_FF^-1 d_F
+ * - x_M = P_MM^-1 (d_M - A_MF x_F)
+ * - x_F = A_FF^-1 (d_F - A_FM x_M)
+ *
+ * The fracture block is small and is thus factorized exactly by UMFPACK if it is
+ * available, or by ILU(0) otherwise. P_MM is the CPR preconditioner of the matrix
+ * block, i.e., AMG for the matrix pressure followed by ILU(0).
+ */
+template <class Matrix, class Vector>
+class FractureBlockPreconditioner : public Dune::Preconditioner<Vector, Vector>
+{
+    using Scalar = typename Matrix::field_type;
+    using MatrixBlock = typename Matrix::block_type;
+    using VectorBlock = typename Vector::block_type;
+
+    using BlockMatrix = Dune::BCRSMatrix<MatrixBlock>;
+    using BlockVector = Dune::BlockVector<VectorBlock>;
+
+    using MatrixPreconditioner = CprPreconditioner<BlockMatrix, BlockVector>;
+#if HAVE_SUITESPARSE_UMFPACK
+    using FractureSolver = BlockUmfPack<BlockMatrix, BlockVector>;
+#elif DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
+    using FractureSolver = Dune::SeqILU<BlockMatrix, BlockVector, BlockVector>;
+#else
+    using FractureSolver = Dune::SeqILU0<BlockMatrix, BlockVector, BlockVector>;
+#endif
+
+public:
+    using domain_type = Vector;
+    using range_type = Vector;
+    using field_type = Scalar;
+
+    /*!
+     * \brief Set up the preconditioner for a given matrix.
+     *
+     * \param A The matrix of the linear system of equations
+     * \param isFractureRow Specifies for each row of the matrix whether its degree of
+     *                      freedom is cut by a fracture
+     * \param relaxationFactor The relaxation factor of the ILU(0) stages
+     * \param coarsenTarget The target number of unknowns for the coarsest level of the
+     *                      AMG of the matrix block
+     */
+    FractureBlockPreconditioner(const Matrix& A,
+                                const std::vector<bool>& isFractureRow,
+                                Scalar relaxationFactor,
+                                int coarsenTarget)
+        : A_(A)
+    {
+        size_t n = A_.N();
+        isFractureRow_.resize(n, false);
+        localIdx_.resize(n);
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx) {
+            isFractureRow_[rowIdx] = rowIdx < isFractureRow.size() && isFractureRow[rowIdx];
+            auto& rows = isFractureRow_[rowIdx] ? fractureRows_ : matrixRows_;
+            localIdx_[rowIdx] = rows.size();
+            rows.push_back(rowIdx);
+        }
+
+        if (!fractureRows_.empty()) {
+            extractBlock_(fractureMatrix_, fractureRows_, /*fracture=*/true);
+#if HAVE_SUITESPARSE_UMFPACK
+            fractureSolver_ = std::make_unique<FractureSolver>(fractureMatrix_);
+#else
+            fractureSolver_ = std::make_unique<FractureSolver>(fractureMatrix_, relaxationFactor);
+#endif
+            fractureRhs_.resize(fractureRows_.size());
+            fractureSol_.resize(fractureRows_.size());
+        }
+
+        if (!matrixRows_.empty()) {
+            extractBlock_(matrixMatrix_, matrixRows_, /*fracture=*/false);
+            matrixPreconditioner_ = std::make_unique<MatrixPreconditioner>(matrixMatrix_,
+                                                                           /*pressureIdx=*/0,
+                                                                           relaxationFactor,
+                                                                           coarsenTarget);
+            matrixRhs_.resize(matrixRows_.size());
+            matrixSol_.resize(matrixRows_.size());
+        }
+    }
+
+    //! the kind of computations supported by the preconditioner
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    void pre([[maybe_unused]] Vector& x, [[maybe_unused]] Vector& b) override
+    {
+        if (matrixPreconditioner_)
+            matrixPreconditioner_->pre(matrixSol_, matrixRhs_);
+    }
+
+    void apply(Vector& v, const Vector& d) override
+    {
+        fractureSol_ = 0.0;
+        matrixSol_ = 0.0;
+
+        // forward sweep: fractures first, then the matrix with the fracture correction
+        if (fractureSolver_) {
+            restrictResidual_(fractureRhs_, fractureRows_, d, matrixSol_, /*fracture=*/true);
+            solveFractures_();
+        }
+
+        if (matrixPreconditioner_) {
+            restrictResidual_(matrixRhs_, matrixRows_, d, fractureSol_, /*fracture=*/false);
+            matrixPreconditioner_->apply(matrixSol_, matrixRhs_);
+        }
+
+        // backward sweep: update the fractures using the matrix correction
+        if (fractureSolver_ && matrixPreconditioner_) {
+            restrictResidual_(fractureRhs_, fractureRows_, d, matrixSol_, /*fracture=*/true);
+            solveFractures_();
+        }
+
+        for (size_t i = 0; i < fractureRows_.size(); ++i)
+            v[fractureRows_[i]] = fractureSol_[i];
+        for (size_t i = 0; i < matrixRows_.size(); ++i)
+            v[matrixRows_[i]] = matrixSol_[i];
+    }
+
+    void post([[maybe_unused]] Vector& x) override
+    {
+        if (matrixPreconditioner_)
+            matrixPreconditioner_->post(matrixSol_);
+    }
+
+private:
+    // copy the couplings between the rows of one kind into a separate matrix
+    void extractBlock_(BlockMatrix& block, const std::vector<size_t>& rows, bool fracture)
+    {
+        size_t numNonZeros = 0;
+        for (size_t rowIdx : rows)
+            for (auto colIt = A_[rowIdx].begin(); colIt != A_[rowIdx].end(); ++colIt)
+                if (isFractureRow_[colIt.index()] == fracture)
+                    ++numNonZeros;
+
+        block.setSize(rows.size(), rows.size(), numNonZeros);
+        block.setBuildMode(BlockMatrix::row_wise);
+        auto blockRowIt = block.createbegin();
+        for (size_t rowIdx : rows) {
+            for (auto colIt = A_[rowIdx].begin(); colIt != A_[rowIdx].end(); ++colIt)
+                if (isFractureRow_[colIt.index()] == fracture)
+                    blockRowIt.insert(localIdx_[colIt.index()]);
+            ++blockRowIt;
+        }
+
+        for (size_t i = 0; i < rows.size(); ++i) {
+            const auto& row = A_[rows[i]];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                if (isFractureRow_[colIt.index()] == fracture)
+                    block[i][localIdx_[colIt.index()]] = *colIt;
+        }
+    }
+
+    // restrict the residual to the rows of one kind, taking the correction of the other
+    // kind of rows into account
+    void restrictResidual_(BlockVector& rhs,
+                           const std::vector<size_t>& rows,
+                           const Vector& d,
+                           const BlockVector& otherSol,
+                           bool fracture) const
+    {
+        for (size_t i = 0; i < rows.size(); ++i) {
+            rhs[i] = d[rows[i]];
+            const auto& row = A_[rows[i]];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                if (isFractureRow_[colIt.index()] != fracture)
+                    colIt->mmv(otherSol[localIdx_[colIt.index()]], rhs[i]);
+        }
+    }
+
+    void solveFractures_()
+    {
+#if HAVE_SUITESPARSE_UMFPACK
+        fractureSolver_->solve(fractureSol_, fractureRhs_);
+#else
+        fractureSol_ = 0.0;
+        fractureSolver_->apply(fractureSol_, fractureRhs_);
+#endif
+    }
+
+    const Matrix& A_;
+
+    std::vector<bool> isFractureRow_;
+    std::vector<size_t> localIdx_;
+    std::vector<size_t> fractureRows_;
+    std::vector<size_t> matrixRows_;
+
+    BlockMatrix fractureMatrix_;
+    BlockMatrix matrixMatrix_;
+    std::unique_ptr<FractureSolver> fractureSolver_;
+    std::unique_ptr<MatrixPreconditioner> matrixPreconditioner_;
+
+    BlockVector fractureRhs_;
+    BlockVector fractureSol_;
+    BlockVector matrixRhs_;
+    BlockVector matrixSol_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
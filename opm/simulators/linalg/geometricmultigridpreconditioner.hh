@@ -0,0 +1,417 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::GeometricMultigridPreconditioner
+ */
+#ifndef EWOMS_GEOMETRIC_MULTIGRID_PRECONDITIONER_HH
+#define EWOMS_GEOMETRIC_MULTIGRID_PRECONDITIONER_HH
+
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A geometric multigrid preconditioner for linear systems whose unknowns form a
+ *        Cartesian lattice.
+ *
+ * The rows of the matrix must be numbered lexicographically on the lattice (the first
+ * direction running fastest), which is the case for element centered discretizations
+ * on YaspGrid (see Opm::EcfvStructuredLayout). The coarse levels are created by
+ * merging pairs of adjacent lattice points in each direction which exhibits more than
+ * one point, i.e., directions which cannot be coarsened anymore are skipped
+ * (semi-coarsening). The transfer operators are the piecewise constant prolongation
+ * and its transpose, so they follow from index arithmetic and the coarse matrices are
+ * simply obtained by summing up the blocks of the finer ones. The coarse matrices are
+ * stored using the structured (2*dim + 1)-point layout. Contrary to algebraic
+ * multigrid, no graph of the matrix needs to be analyzed, so the setup is cheap.
+ *
+ * Each application of the preconditioner performs a V-cycle which uses a forward block
+ * Gauss-Seidel sweep for pre-smoothing and a backward one for post-smoothing. Entries
+ * of the finest matrix which do not couple adjacent lattice points (e.g. of auxiliary
+ * equations) are considered by the smoother on the finest level, but they are ignored
+ * by the coarse levels. If no lattice is specified, the preconditioner only applies the
+ * smoother.
+ */
+template <class Matrix, class Vector>
+class GeometricMultigridPreconditioner : public Dune::Preconditioner<Vector, Vector>
+{
+    using Scalar = typename Matrix::field_type;
+    using VectorBlock = typename Vector::block_type;
+    static constexpr int numEq = VectorBlock::dimension;
+    using Block = Dune::FieldMatrix<Scalar, numEq, numEq>;
+
+    // a level of the multigrid hierarchy. the matrix of the coarse levels uses the
+    // structured layout, i.e., it consists of the diagonal blocks and the blocks of the
+    // lower and the upper neighbor in each direction.
+    struct Level
+    {
+        std::vector<unsigned> dims;
+        std::vector<size_t> strides;
+        size_t size;
+
+        std::vector<Block> diag;
+        std::vector<Block> offDiag; // indexed by 2*(size*dirIdx + cellIdx) + isUpper
+        std::vector<Block> invDiag;
+
+        std::vector<VectorBlock> x;
+        std::vector<VectorBlock> b;
+        std::vector<VectorBlock> r;
+    };
+
+public:
+    using domain_type = Vector;
+    using range_type = Vector;
+    using field_type = Scalar;
+
+    /*!
+     * \brief Set up the preconditioner for a given matrix.
+     *
+     * \param A The matrix of the linear system of equations
+     * \param dims The number of lattice points in each direction. If this is empty or
+     *             if the number of lattice points does not match the size of the
+     *             matrix, only the smoother is applied.
+     * \param relaxationFactor The relaxation factor of the Gauss-Seidel smoother
+     * \param coarsenTarget The maximum number of lattice points of the coarsest level
+     * \param numCoarseSweeps The number of symmetric Gauss-Seidel sweeps which are
+     *                        used to solve the system of the coarsest level
+     */
+    GeometricMultigridPreconditioner(const Matrix& A,
+                                     const std::vector<unsigned>& dims,
+                                     Scalar relaxationFactor,
+                                     size_t coarsenTarget,
+                                     unsigned numCoarseSweeps = 10)
+        : A_(A)
+        , relaxationFactor_(relaxationFactor)
+        , numCoarseSweeps_(numCoarseSweeps)
+    {
+        size_t n = A_.N();
+        fineInvDiag_.resize(n);
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx) {
+            fineInvDiag_[rowIdx] = A_[rowIdx][rowIdx];
+            fineInvDiag_[rowIdx].invert();
+        }
+        fineResidual_.resize(n);
+
+        size_t numLatticePoints = dims.empty() ? 0 : 1;
+        for (unsigned d : dims)
+            numLatticePoints *= d;
+        if (numLatticePoints != n)
+            return;
+
+        fineLevel_.dims = dims;
+        setStrides_(fineLevel_);
+
+        // create the coarse levels until the target size is reached or no direction
+        // can be coarsened anymore
+        const Level* finerLevel = &fineLevel_;
+        while (finerLevel->size > coarsenTarget) {
+            Level coarseLevel;
+            if (!coarsenDims_(*finerLevel, coarseLevel.dims))
+                break;
+            setStrides_(coarseLevel);
+            allocate_(coarseLevel);
+            levels_.push_back(std::move(coarseLevel));
+            finerLevel = &levels_.back();
+        }
+
+        if (levels_.empty())
+            return;
+
+        // the matrix of the first coarse level is computed from the finest matrix, the
+        // ones of the other levels from the next finer level
+        restrictFineMatrix_(levels_[0]);
+        for (size_t levelIdx = 1; levelIdx < levels_.size(); ++levelIdx)
+            restrictMatrix_(levels_[levelIdx - 1], levels_[levelIdx]);
+
+        for (auto& level : levels_) {
+            for (size_t cellIdx = 0; cellIdx < level.size; ++cellIdx) {
+                level.invDiag[cellIdx] = level.diag[cellIdx];
+                level.invDiag[cellIdx].invert();
+            }
+        }
+    }
+
+    //! the kind of computations supported by the preconditioner
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    void pre(Vector&, Vector&) override
+    {}
+
+    void apply(Vector& v, const Vector& d) override
+    {
+        size_t n = A_.N();
+        for (size_t i = 0; i < n; ++i)
+            v[i] = 0.0;
+
+        fineGaussSeidel_(v, d, /*forward=*/true);
+        if (!levels_.empty()) {
+            // restrict the residual of the finest level
+            computeFineResidual_(v, d);
+            Level& coarseLevel = levels_[0];
+            std::fill(coarseLevel.b.begin(), coarseLevel.b.end(), VectorBlock(0.0));
+            for (size_t cellIdx = 0; cellIdx < n; ++cellIdx)
+                coarseLevel.b[coarseIndex_(fineLevel_, coarseLevel, cellIdx)] += fineResidual_[cellIdx];
+
+            vCycle_(/*levelIdx=*/0);
+
+            // prolongate the correction
+            for (size_t cellIdx = 0; cellIdx < n; ++cellIdx)
+                v[cellIdx] += coarseLevel.x[coarseIndex_(fineLevel_, coarseLevel, cellIdx)];
+        }
+        fineGaussSeidel_(v, d, /*forward=*/false);
+    }
+
+    void post(Vector&) override
+    {}
+
+    /*!
+     * \brief Returns the number of levels including the finest one.
+     */
+    size_t numLevels() const
+    { return levels_.size() + 1; }
+
+private:
+    static void setStrides_(Level& level)
+    {
+        size_t dimSize = level.dims.size();
+        level.strides.resize(dimSize);
+        level.size = 1;
+        for (size_t dirIdx = 0; dirIdx < dimSize; ++dirIdx) {
+            level.strides[dirIdx] = level.size;
+            level.size *= level.dims[dirIdx];
+        }
+    }
+
+    static void allocate_(Level& level)
+    {
+        level.diag.assign(level.size, Block(0.0));
+        level.offDiag.assign(2*level.dims.size()*level.size, Block(0.0));
+        level.invDiag.resize(level.size);
+        level.x.resize(level.size);
+        level.b.resize(level.size);
+        level.r.resize(level.size);
+    }
+
+    // merge pairs of lattice points in all directions which have more than one
+    static bool coarsenDims_(const Level& fineLevel, std::vector<unsigned>& coarseDims)
+    {
+        bool coarsened = false;
+        coarseDims = fineLevel.dims;
+        for (auto& d : coarseDims) {
+            if (d > 1) {
+                d = (d + 1)/2;
+                coarsened = true;
+            }
+        }
+        return coarsened;
+    }
+
+    // the index of the coarse lattice point which contains a fine one
+    static size_t coarseIndex_(const Level& fineLevel, const Level& coarseLevel, size_t fineIdx)
+    {
+        size_t coarseIdx = 0;
+        for (size_t dirIdx = 0; dirIdx < fineLevel.dims.size(); ++dirIdx) {
+            size_t pos = (fineIdx/fineLevel.strides[dirIdx]) % fineLevel.dims[dirIdx];
+            if (coarseLevel.dims[dirIdx] < fineLevel.dims[dirIdx])
+                pos /= 2;
+            coarseIdx += pos*coarseLevel.strides[dirIdx];
+        }
+        return coarseIdx;
+    }
+
+    // add a block which couples two coarse lattice points to the structured matrix.
+    // couplings of points which are not adjacent are dropped.
+    static void addCoupling_(Level& level, size_t rowIdx, size_t colIdx, const Block& block)
+    {
+        if (rowIdx == colIdx) {
+            level.diag[rowIdx] += block;
+            return;
+        }
+
+        for (size_t dirIdx = 0; dirIdx < level.dims.size(); ++dirIdx) {
+            size_t stride = level.strides[dirIdx];
+            size_t pos = (rowIdx/stride) % level.dims[dirIdx];
+            if (pos > 0 && colIdx == rowIdx - stride) {
+                level.offDiag[2*(level.size*dirIdx + rowIdx)] += block;
+                return;
+            }
+            if (pos + 1 < level.dims[dirIdx] && colIdx == rowIdx + stride) {
+                level.offDiag[2*(level.size*dirIdx + rowIdx) + 1] += block;
+                return;
+            }
+        }
+    }
+
+    void restrictFineMatrix_(Level& coarseLevel) const
+    {
+        for (size_t rowIdx = 0; rowIdx < A_.N(); ++rowIdx) {
+            size_t coarseRowIdx = coarseIndex_(fineLevel_, coarseLevel, rowIdx);
+            const auto& row = A_[rowIdx];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt) {
+                size_t coarseColIdx = coarseIndex_(fineLevel_, coarseLevel, colIt.index());
+                addCoupling_(coarseLevel, coarseRowIdx, coarseColIdx, *colIt);
+            }
+        }
+    }
+
+    static void restrictMatrix_(const Level& fineLevel, Level& coarseLevel)
+    {
+        for (size_t cellIdx = 0; cellIdx < fineLevel.size; ++cellIdx) {
+            size_t coarseRowIdx = coarseIndex_(fineLevel, coarseLevel, cellIdx);
+            coarseLevel.diag[coarseRowIdx] += fineLevel.diag[cellIdx];
+            forEachNeighbor_(fineLevel, cellIdx, [&](size_t neighborIdx, const Block& block) {
+                size_t coarseColIdx = coarseIndex_(fineLevel, coarseLevel, neighborIdx);
+                addCoupling_(coarseLevel, coarseRowIdx, coarseColIdx, block);
+            });
+        }
+    }
+
+    // call a function for the neighbors of a lattice point and the corresponding
+    // off-diagonal blocks of the matrix
+    template <class Functor>
+    static void forEachNeighbor_(const Level& level, size_t cellIdx, Functor func)
+    {
+        for (size_t dirIdx = 0; dirIdx < level.dims.size(); ++dirIdx) {
+            size_t stride = level.strides[dirIdx];
+            size_t pos = (cellIdx/stride) % level.dims[dirIdx];
+            const Block* blocks = &level.offDiag[2*(level.size*dirIdx + cellIdx)];
+            if (pos > 0)
+                func(cellIdx - stride, blocks[0]);
+            if (pos + 1 < level.dims[dirIdx])
+                func(cellIdx + stride, blocks[1]);
+        }
+    }
+
+    void fineGaussSeidel_(Vector& x, const Vector& b, bool forward) const
+    {
+        size_t n = A_.N();
+        for (size_t i = 0; i < n; ++i) {
+            size_t rowIdx = forward ? i : n - 1 - i;
+            VectorBlock r = b[rowIdx];
+            const auto& row = A_[rowIdx];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt)
+                if (colIt.index() != rowIdx)
+                    colIt->mmv(x[colIt.index()], r);
+
+            VectorBlock newX;
+            fineInvDiag_[rowIdx].mv(r, newX);
+            x[rowIdx] *= 1.0 - relaxationFactor_;
+            x[rowIdx].axpy(relaxationFactor_, newX);
+        }
+    }
+
+    void computeFineResidual_(const Vector& x, const Vector& b)
+    {
+        for (size_t rowIdx = 0; rowIdx < A_.N(); ++rowIdx) {
+            fineResidual_[rowIdx] = b[rowIdx];
+            const auto& row = A_[rowIdx];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt)
+                colIt->mmv(x[colIt.index()], fineResidual_[rowIdx]);
+        }
+    }
+
+    void gaussSeidel_(Level& level, bool forward) const
+    {
+        for (size_t i = 0; i < level.size; ++i) {
+            size_t cellIdx = forward ? i : level.size - 1 - i;
+            VectorBlock r = level.b[cellIdx];
+            forEachNeighbor_(level, cellIdx, [&](size_t neighborIdx, const Block& block)
+                             { block.mmv(level.x[neighborIdx], r); });
+
+            VectorBlock newX;
+            level.invDiag[cellIdx].mv(r, newX);
+            level.x[cellIdx] *= 1.0 - relaxationFactor_;
+            level.x[cellIdx].axpy(relaxationFactor_, newX);
+        }
+    }
+
+    // apply a V-cycle to a coarse level. the right hand side must be set.
+    void vCycle_(size_t levelIdx)
+    {
+        Level& level = levels_[levelIdx];
+        std::fill(level.x.begin(), level.x.end(), VectorBlock(0.0));
+
+        if (levelIdx + 1 == levels_.size()) {
+            // approximately solve the system of the coarsest level
+            for (unsigned sweepIdx = 0; sweepIdx < numCoarseSweeps_; ++sweepIdx) {
+                gaussSeidel_(level, /*forward=*/true);
+                gaussSeidel_(level, /*forward=*/false);
+            }
+            return;
+        }
+
+        gaussSeidel_(level, /*forward=*/true);
+
+        // restrict the residual
+        Level& coarseLevel = levels_[levelIdx + 1];
+        std::fill(coarseLevel.b.begin(), coarseLevel.b.end(), VectorBlock(0.0));
+        for (size_t cellIdx = 0; cellIdx < level.size; ++cellIdx) {
+            VectorBlock& r = level.r[cellIdx];
+            r = level.b[cellIdx];
+            level.diag[cellIdx].mmv(level.x[cellIdx], r);
+            forEachNeighbor_(level, cellIdx, [&](size_t neighborIdx, const Block& block)
+                             { block.mmv(level.x[neighborIdx], r); });
+            coarseLevel.b[coarseIndex_(level, coarseLevel, cellIdx)] += r;
+        }
+
+        vCycle_(levelIdx + 1);
+
+        // prolongate the correction
+        for (size_t cellIdx = 0; cellIdx < level.size; ++cellIdx)
+            level.x[cellIdx] += coarseLevel.x[coarseIndex_(level, coarseLevel, cellIdx)];
+
+        gaussSeidel_(level, /*forward=*/false);
+    }
+
+    const Matrix& A_;
+    Scalar relaxationFactor_;
+    unsigned numCoarseSweeps_;
+
+    std::vector<Block> fineInvDiag_;
+    std::vector<VectorBlock> fineResidual_;
+
+    // the lattice of the finest level. its matrix is the one passed to the constructor
+    Level fineLevel_;
+    std::vector<Level> levels_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
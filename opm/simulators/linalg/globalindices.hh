@@ -34,9 +34,10 @@
 
 #include <algorithm>
 #include <set>
-#include <map>
 #include <iostream>
 #include <tuple>
+#include <unordered_map>
+#include <vector>
 
 #if HAVE_MPI
 #include <mpi.h>
@@ -56,8 +57,10 @@ class GlobalIndices
 {
     GlobalIndices(const GlobalIndices& ) = delete;
 
-    using GlobalToDomesticMap = std::map<Index, Index>;
-    using DomesticToGlobalMap = std::map<Index, Index>;
+    // the domestic indices are contiguous, so the domestic->global map is a plain
+    // array. the global indices of a process are scattered, so they are hashed.
+    using GlobalToDomesticMap = std::unordered_map<Index, Index>;
+    using DomesticToGlobalMap = std::vector<Index>;
 
 public:
     GlobalIndices(const ForeignOverlap& foreignOverlap)
@@ -87,9 +90,11 @@ public:
      */
     Index domesticToGlobal(Index domesticIdx) const
     {
-        assert(domesticToGlobal_.find(domesticIdx) != domesticToGlobal_.end());
+        assert(0 <= domesticIdx
+               && static_cast<size_t>(domesticIdx) < domesticToGlobal_.size());
+        assert(domesticToGlobal_[static_cast<size_t>(domesticIdx)] >= 0);
 
-        return domesticToGlobal_.find(domesticIdx)->second;
+        return domesticToGlobal_[static_cast<size_t>(domesticIdx)];
     }
 
     /*!
@@ -126,11 +131,20 @@ public:
      */
     void addIndex(Index domesticIdx, Index globalIdx)
     {
-        domesticToGlobal_[domesticIdx] = globalIdx;
+        assert(domesticIdx >= 0);
+        size_t domIdx = static_cast<size_t>(domesticIdx);
+        if (domIdx >= domesticToGlobal_.size())
+            domesticToGlobal_.resize(domIdx + 1, /*value=*/-1);
+
+        assert(domesticToGlobal_[domIdx] < 0 || domesticToGlobal_[domIdx] == globalIdx);
+        if (domesticToGlobal_[domIdx] < 0)
+            ++numMapped_;
+
+        domesticToGlobal_[domIdx] = globalIdx;
         globalToDomestic_[globalIdx] = domesticIdx;
-        numDomestic_ = domesticToGlobal_.size();
+        numDomestic_ = numMapped_;
 
-        assert(domesticToGlobal_.size() == globalToDomestic_.size());
+        assert(numMapped_ == globalToDomestic_.size());
     }
 
     /*!
@@ -192,7 +206,7 @@ public:
         std::cout << "(domestic index, global index, domestic->global->domestic)"
                   << " list for rank " << myRank_ << "\n";
 
-        for (size_t domIdx = 0; domIdx < domesticToGlobal_.size(); ++domIdx)
+        for (Index domIdx = 0; static_cast<size_t>(domIdx) < numDomestic_; ++domIdx)
             std::cout << "(" << domIdx << ", " << domesticToGlobal(domIdx)
                       << ", " << globalToDomestic(domesticToGlobal(domIdx)) << ") ";
         std::cout << "\n" << std::flush;
@@ -203,51 +217,48 @@ protected:
     // global index list
     void buildGlobalIndices_()
     {
+        numMapped_ = 0;
 #if HAVE_MPI
         numDomestic_ = 0;
+
+        // all local indices get a global one, the domestic overlap usually adds a
+        // few more
+        domesticToGlobal_.reserve(foreignOverlap_.numLocal());
+        globalToDomestic_.reserve(foreignOverlap_.numLocal());
 #else
         numDomestic_ = foreignOverlap_.numLocal();
 #endif
 
 #if HAVE_MPI
-        if (myRank_ == 0) {
-            // the first rank starts at index zero
+        // the offset of a process is the number of master indices of all
+        // processes with lower rank. (instead of passing the offset from one rank to
+        // the next, a prefix sum is used because it does not serialize the ranks.)
+        int numMaster = 0;
+        for (unsigned i = 0; i < foreignOverlap_.numLocal(); ++i)
+            if (foreignOverlap_.iAmMasterOf(static_cast<Index>(i)))
+                ++numMaster;
+
+        domesticOffset_ = 0;
+        MPI_Exscan(&numMaster,       // send buffer
+                   &domesticOffset_, // receive buffer
+                   1,                // count
+                   MPI_INT,          // data type
+                   MPI_SUM,          // operation
+                   MPI_COMM_WORLD);  // communicator
+        if (myRank_ == 0)
+            // the receive buffer of the first rank is undefined
             domesticOffset_ = 0;
-        }
-        else {
-            // all other ranks retrieve their offset from the next
-            // lower rank
-            MPI_Recv(&domesticOffset_, // buffer
-                     1,                // count
-                     MPI_INT,          // data type
-                     static_cast<int>(myRank_ - 1), // peer rank
-                     0,                // tag
-                     MPI_COMM_WORLD,   // communicator
-                     MPI_STATUS_IGNORE);
-        }
 
         // create maps for all indices for which the current process
         // is the master
-        int numMaster = 0;
+        int masterIdx = 0;
         for (unsigned i = 0; i < foreignOverlap_.numLocal(); ++i) {
             if (!foreignOverlap_.iAmMasterOf(static_cast<Index>(i)))
                 continue;
 
             addIndex(static_cast<Index>(i),
-                     static_cast<Index>(domesticOffset_ + numMaster));
-            ++numMaster;
-        }
-
-        if (myRank_ < mpiSize_ - 1) {
-            // send the domestic offset plus the number of master
-            // indices to the process which is one rank higher
-            int tmp = domesticOffset_ + numMaster;
-            MPI_Send(&tmp,            // buff
-                     1,               // count
-                     MPI_INT,         // data type
-                     static_cast<int>(myRank_ + 1), // peer rank
-                     0,               // tag
-                     MPI_COMM_WORLD); // communicator
+                     static_cast<Index>(domesticOffset_ + masterIdx));
+            ++masterIdx;
         }
 
         typename PeerSet::const_iterator peerIt;
@@ -337,6 +348,7 @@ protected:
 
     int domesticOffset_;
     size_t numDomestic_;
+    size_t numMapped_;
     const ForeignOverlap& foreignOverlap_;
 
     GlobalToDomesticMap globalToDomestic_;
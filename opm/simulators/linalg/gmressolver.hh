@@ -0,0 +1,441 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::GmresSolver
+ */
+#ifndef EWOMS_GMRES_SOLVER_HH
+#define EWOMS_GMRES_SOLVER_HH
+
+#include "linearsolverreport.hh"
+
+#include <opm/models/utils/timer.hh>
+#include <opm/models/utils/timerguard.hh>
+
+#include <opm/material/common/Exceptions.hpp>
+
+#include <dune/istl/scalarproducts.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief The methods which can be used to orthogonalize the Krylov basis of the GMRES
+ *        solver.
+ */
+enum class GmresOrthogonalization {
+    //! Classical Gram-Schmidt with one reorthogonalization step. This needs three global
+    //! reductions per iteration regardless of the size of the basis.
+    ClassicalGramSchmidt,
+
+    //! Modified Gram-Schmidt, which needs one global reduction for each basis vector.
+    ModifiedGramSchmidt
+};
+
+/*!
+ * \brief Convert the name of an orthogonalization method to the enum.
+ *
+ * The accepted names are "cgs2" and "mgs".
+ */
+inline GmresOrthogonalization gmresOrthogonalizationFromString(const std::string& name)
+{
+    if (name == "cgs2")
+        return GmresOrthogonalization::ClassicalGramSchmidt;
+    else if (name == "mgs")
+        return GmresOrthogonalization::ModifiedGramSchmidt;
+
+    throw std::runtime_error("Unknown orthogonalization method '"+name+"' for the GMRES "
+                             "solver. Possible values are 'cgs2' and 'mgs'");
+}
+
+/*!
+ * \brief Implements a restarted GMRES linear solver with right preconditioning.
+ *
+ * This solves a linear system of equations Ax = b, where the matrix A is sparse and may
+ * be unsymmetric.
+ *
+ * In contrast to the GMRES solver of dune-istl, the Krylov basis and all other
+ * temporary vectors are kept between solves, so they are only allocated if the layout
+ * of the vectors or the restart length changes. For this, the solver object is supposed
+ * to be kept by the linear solver backend, the linear operator, the preconditioner and
+ * the scalar product are passed for each linear system.
+ *
+ * In parallel, each scalar product requires a global reduction. With modified
+ * Gram-Schmidt orthogonalization, iteration j thus needs j + 2 reductions. Classical
+ * Gram-Schmidt computes all scalar products with the basis at once, but it is only
+ * stable if the orthogonalization is repeated once. Together with the norm of the new
+ * basis vector, this results in three reductions per iteration. To take advantage of
+ * this, the scalar product needs to provide a multiDot() method like
+ * OverlappingScalarProduct does. Otherwise, the scalar products are computed one after
+ * the other.
+ */
+template <class LinearOperator, class Vector, class Preconditioner,
+          class ScalarProduct = Dune::ScalarProduct<Vector> >
+class GmresSolver
+{
+    using Scalar = typename LinearOperator::field_type;
+
+public:
+    GmresSolver()
+    {
+        A_ = nullptr;
+        b_ = nullptr;
+        preconditioner_ = nullptr;
+        scalarProduct_ = nullptr;
+
+        restart_ = 20;
+        maxIterations_ = 1000;
+        verbosity_ = 0;
+        tolerance_ = 1e-8;
+        absTolerance_ = 0.0;
+        orthogonalization_ = GmresOrthogonalization::ClassicalGramSchmidt;
+    }
+
+    /*!
+     * \brief Set the number of iterations after which the Krylov basis is discarded.
+     */
+    void setRestart(unsigned value)
+    { restart_ = std::max(1u, value); }
+
+    /*!
+     * \brief Return the number of iterations after which the Krylov basis is
+     *        discarded.
+     */
+    unsigned restart() const
+    { return restart_; }
+
+    /*!
+     * \brief Set the maximum number of iterations before we give up without achieving
+     *        convergence.
+     */
+    void setMaxIterations(unsigned value)
+    { maxIterations_ = value; }
+
+    /*!
+     * \brief Return the maximum number of iterations before we give up without achieving
+     *        convergence.
+     */
+    unsigned maxIterations() const
+    { return maxIterations_; }
+
+    /*!
+     * \brief Set the reduction of the two-norm of the residual which is required for
+     *        convergence.
+     */
+    void setTolerance(Scalar value)
+    { tolerance_ = value; }
+
+    /*!
+     * \brief Set the two-norm of the residual below which the solution is considered to
+     *        be converged regardless of the reduction.
+     */
+    void setAbsTolerance(Scalar value)
+    { absTolerance_ = value; }
+
+    /*!
+     * \brief Select the method which is used to orthogonalize the Krylov basis.
+     */
+    void setOrthogonalization(GmresOrthogonalization value)
+    { orthogonalization_ = value; }
+
+    /*!
+     * \brief Return the method which is used to orthogonalize the Krylov basis.
+     */
+    GmresOrthogonalization orthogonalization() const
+    { return orthogonalization_; }
+
+    /*!
+     * \brief Set the verbosity level of the linear solver
+     *
+     * The levels correspont to those used by the dune-istl solvers:
+     *
+     * - 0: no output
+     * - 1: summary output at the end of the solution proceedure (if no exception was
+     *      thrown)
+     * - 2: detailed output after each iteration
+     */
+    void setVerbosity(unsigned value)
+    { verbosity_ = value; }
+
+    /*!
+     * \brief Return the verbosity level of the linear solver.
+     */
+    unsigned verbosity() const
+    { return verbosity_; }
+
+    /*!
+     * \brief Set the matrix "A" of the linear system.
+     */
+    void setLinearOperator(const LinearOperator* A)
+    { A_ = A; }
+
+    /*!
+     * \brief Set the right hand side "b" of the linear system.
+     */
+    void setRhs(const Vector* b)
+    { b_ = b; }
+
+    /*!
+     * \brief Set the preconditioner which is applied from the right.
+     */
+    void setPreconditioner(Preconditioner* preconditioner)
+    { preconditioner_ = preconditioner; }
+
+    /*!
+     * \brief Set the object which computes the scalar products.
+     */
+    void setScalarProduct(ScalarProduct* scalarProduct)
+    { scalarProduct_ = scalarProduct; }
+
+    /*!
+     * \brief Discard the Krylov basis and all other temporary vectors.
+     */
+    void releaseWorkspace()
+    {
+        basis_.clear();
+        tmp_.reset();
+        correction_.reset();
+    }
+
+    /*!
+     * \brief Run the GMRES solver and store the result into the "x" vector.
+     */
+    bool apply(Vector& x)
+    {
+        report_.reset();
+        Opm::TimerGuard reportTimerGuard(report_.timer());
+        report_.timer().start();
+
+        x = 0.0;
+        allocateWorkspace_();
+
+        Vector& r = *tmp_;
+        r = *b_;
+        preconditioner_->pre(x, r);
+
+        Scalar beta = scalarProduct_->norm(r);
+        Scalar targetResid = std::max(tolerance_*beta, absTolerance_);
+        if (verbosity_ > 0)
+            std::cout << "-------- GmresSolver --------\n"
+                      << std::setw(20) << "iteration " << std::setw(20) << "residual\n"
+                      << std::setw(20) << 0 << " " << std::setw(20) << beta << "\n";
+
+        bool converged = beta <= targetResid;
+        while (!converged && report_.iterations() < maxIterations_) {
+            basis_[0] = r;
+            basis_[0] *= 1.0/beta;
+            std::fill(g_.begin(), g_.end(), 0.0);
+            g_[0] = beta;
+
+            unsigned k = 0;
+            bool breakdown = false;
+            for (unsigned j = 0; j < restart_ && report_.iterations() < maxIterations_; ++j) {
+                // v_(j+1) = A M^-1 v_j
+                Vector& z = *correction_;
+                z = 0.0;
+                preconditioner_->apply(z, basis_[j]);
+                A_->apply(z, basis_[j + 1]);
+
+                orthogonalize_(j);
+
+                // apply the previous Givens rotations to the new column of the Hessenberg
+                // matrix and compute a new one which eliminates its subdiagonal entry
+                auto& H = H_;
+                for (unsigned i = 0; i < j; ++i) {
+                    Scalar tmp = cs_[i]*H[i][j] + sn_[i]*H[i + 1][j];
+                    H[i + 1][j] = -sn_[i]*H[i][j] + cs_[i]*H[i + 1][j];
+                    H[i][j] = tmp;
+                }
+                Scalar denom = std::sqrt(H[j][j]*H[j][j] + H[j + 1][j]*H[j + 1][j]);
+                cs_[j] = (denom > 0.0) ? H[j][j]/denom : 1.0;
+                sn_[j] = (denom > 0.0) ? H[j + 1][j]/denom : 0.0;
+                H[j][j] = denom;
+                H[j + 1][j] = 0.0;
+                g_[j + 1] = -sn_[j]*g_[j];
+                g_[j] = cs_[j]*g_[j];
+
+                report_.increment();
+                k = j + 1;
+                converged = std::abs(g_[j + 1]) <= targetResid;
+                if (verbosity_ > 1)
+                    std::cout << std::setw(20) << report_.iterations() << " "
+                              << std::setw(20) << std::abs(g_[j + 1]) << "\n";
+                breakdown = (denom == 0.0);
+                if (converged || breakdown)
+                    break;
+            }
+
+            // solve the upper triangular system
+            for (int i = static_cast<int>(k) - 1; i >= 0; --i) {
+                y_[i] = g_[i];
+                for (unsigned l = static_cast<unsigned>(i) + 1; l < k; ++l)
+                    y_[i] -= H_[i][l]*y_[l];
+                // a vanishing diagonal entry means that the Krylov space does not
+                // contain any further information
+                y_[i] = (H_[i][i] != 0.0) ? y_[i]/H_[i][i] : 0.0;
+            }
+
+            // x = x + M^-1 V y. the preconditioner is linear, so it only needs to be
+            // applied once per cycle
+            r = 0.0;
+            for (unsigned i = 0; i < k; ++i)
+                r.axpy(y_[i], basis_[i]);
+            Vector& z = *correction_;
+            z = 0.0;
+            preconditioner_->apply(z, r);
+            x += z;
+
+            // restart using the true residual
+            r = *b_;
+            A_->applyscaleadd(-1.0, x, r);
+            beta = scalarProduct_->norm(r);
+            converged = beta <= targetResid;
+
+            if (breakdown && !converged)
+                throw Opm::NumericalIssue("Breakdown of the GMRES solver (lucky breakdown "
+                                          "without convergence)");
+        }
+
+        preconditioner_->post(x);
+
+        if (verbosity_ > 0) {
+            std::cout << "GmresSolver " << (converged ? "converged" : "did not converge")
+                      << " after " << report_.iterations() << " iterations, residual: "
+                      << beta << "\n"
+                      << "-------- /GmresSolver --------" << std::endl;
+        }
+
+        report_.setConverged(converged);
+        return report_.converged();
+    }
+
+    const Opm::Linear::SolverReport& report() const
+    { return report_; }
+
+private:
+    // make sure that all temporary vectors and dense matrices are allocated. this only
+    // does something if the restart length or the layout of the vectors has changed
+    void allocateWorkspace_()
+    {
+        if (basis_.size() != restart_ + 1 || basis_[0].size() != b_->size()) {
+            basis_.assign(restart_ + 1, *b_);
+            tmp_ = std::make_unique<Vector>(*b_);
+            correction_ = std::make_unique<Vector>(*b_);
+
+            H_.assign(restart_ + 1, std::vector<Scalar>(restart_, 0.0));
+            g_.resize(restart_ + 1);
+            cs_.resize(restart_);
+            sn_.resize(restart_);
+            y_.resize(restart_);
+            basisPtrs_.reserve(restart_ + 1);
+        }
+    }
+
+    // orthogonalize the basis vector j + 1 against all previous ones and normalize it.
+    // the coefficients are stored in column j of the Hessenberg matrix.
+    void orthogonalize_(unsigned j)
+    {
+        Vector& w = basis_[j + 1];
+        if (orthogonalization_ == GmresOrthogonalization::ModifiedGramSchmidt) {
+            for (unsigned i = 0; i <= j; ++i) {
+                H_[i][j] = scalarProduct_->dot(basis_[i], w);
+                w.axpy(-H_[i][j], basis_[i]);
+            }
+        }
+        else {
+            basisPtrs_.clear();
+            for (unsigned i = 0; i <= j; ++i)
+                basisPtrs_.push_back(&basis_[i]);
+
+            // classical Gram-Schmidt, repeated once to regain the orthogonality which is
+            // lost due to rounding
+            for (unsigned i = 0; i <= j; ++i)
+                H_[i][j] = 0.0;
+            for (unsigned pass = 0; pass < 2; ++pass) {
+                multiDot_(*scalarProduct_, w, coeffs_, /*preferFused=*/0);
+                for (unsigned i = 0; i <= j; ++i) {
+                    w.axpy(-coeffs_[i], basis_[i]);
+                    H_[i][j] += coeffs_[i];
+                }
+            }
+        }
+
+        H_[j + 1][j] = scalarProduct_->norm(w);
+        if (H_[j + 1][j] > 0.0)
+            w *= 1.0/H_[j + 1][j];
+    }
+
+    // use the fused scalar products if the scalar product object provides them
+    template <class SP>
+    auto multiDot_(SP& scalarProduct, const Vector& w, std::vector<Scalar>& result, int)
+        -> decltype(scalarProduct.multiDot(std::declval<const std::vector<const Vector*>&>(), w, result))
+    { return scalarProduct.multiDot(basisPtrs_, w, result); }
+
+    template <class SP>
+    void multiDot_(SP& scalarProduct, const Vector& w, std::vector<Scalar>& result, long)
+    {
+        result.resize(basisPtrs_.size());
+        for (unsigned k = 0; k < basisPtrs_.size(); ++k)
+            result[k] = scalarProduct.dot(*basisPtrs_[k], w);
+    }
+
+    const LinearOperator* A_;
+    const Vector* b_;
+    Preconditioner* preconditioner_;
+    ScalarProduct* scalarProduct_;
+    Opm::Linear::SolverReport report_;
+
+    unsigned restart_;
+    unsigned maxIterations_;
+    unsigned verbosity_;
+    Scalar tolerance_;
+    Scalar absTolerance_;
+    GmresOrthogonalization orthogonalization_;
+
+    // the workspace which is kept between solves
+    std::vector<Vector> basis_;
+    std::unique_ptr<Vector> tmp_;
+    std::unique_ptr<Vector> correction_;
+    std::vector<const Vector*> basisPtrs_;
+    std::vector<std::vector<Scalar> > H_;
+    std::vector<Scalar> g_;
+    std::vector<Scalar> cs_;
+    std::vector<Scalar> sn_;
+    std::vector<Scalar> y_;
+    std::vector<Scalar> coeffs_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
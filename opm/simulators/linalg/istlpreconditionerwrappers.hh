@@ -40,6 +40,23 @@
  * - \c SOR: A successive overrelaxation (SOR) preconditioner
  * - \c ILUn: An ILU(n) preconditioner
  * - \c ILU0: A specialized (and optimized) ILU(0) preconditioner
+ * - \c CPR: A two-stage constrained pressure residual preconditioner which combines
+ *           AMG for the pressure with ILU(0) for the full system (see
+ *           Opm::Linear::CprPreconditioner)
+ * - \c ThreadedILU0: ILU(0) which uses OpenMP threads for the factorization and the
+ *                    triangular solves (see Opm::Linear::ThreadedIlu0Preconditioner)
+ * - \c MixedPrecisionILU0: ILU(0) which stores its factors in single precision
+ * - \c MixedPrecisionCPR: The CPR preconditioner using single precision for all matrices
+ *                         it stores
+ * - \c GeometricMultigrid: A geometric multigrid preconditioner for element centered
+ *                          discretizations on Cartesian grids (see
+ *                          Opm::Linear::GeometricMultigridPreconditioner)
+ * - \c FractureBlock: A block preconditioner for the discrete fracture model which
+ *                     solves for the degrees of freedom that are cut by fractures
+ *                     separately from the ones of the rock matrix (see
+ *                     Opm::Linear::FractureBlockPreconditioner)
+ * - \c AutoTuned: Selects one of several preconditioners at run time based on the
+ *                 measured performance of the linear solves
  */
 #ifndef EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 #define EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
@@ -47,11 +64,27 @@
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
+#include <opm/simulators/linalg/cprpreconditioner.hh>
+#include <opm/simulators/linalg/fractureblockpreconditioner.hh>
+#include <opm/simulators/linalg/geometricmultigridpreconditioner.hh>
+#include <opm/simulators/linalg/linearsolverreport.hh>
+#include <opm/simulators/linalg/mixedprecisionpreconditioner.hh>
+#include <opm/simulators/linalg/threadedilu0preconditioner.hh>
 
 #include <dune/istl/preconditioners.hh>
 
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 #define EWOMS_WRAP_ISTL_PRECONDITIONER(PREC_NAME, ISTL_PREC_TYPE)               \
@@ -193,6 +226,565 @@ EWOMS_WRAP_ISTL_SIMPLE_PRECONDITIONER(ILU0, Dune::SeqILU0)
 EWOMS_WRAP_ISTL_PRECONDITIONER(ILUn, Dune::SeqILUn)
 #endif
 
+/*!
+ * \brief Wraps the constrained pressure residual (CPR) preconditioner.
+ *
+ * This assumes that the pressure is the first primary variable, which is the case for
+ * all models which use pressures as primary variables.
+ */
+template <class TypeTag>
+class PreconditionerWrapperCPR
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using SequentialPreconditioner = CprPreconditioner<OverlappingMatrix, OverlappingVector>;
+
+    PreconditionerWrapperCPR()
+    {}
+
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PreconditionerRelaxation,
+                             "The relaxation factor of the preconditioner");
+        EWOMS_REGISTER_PARAM(TypeTag, int, CprCoarsenTarget,
+                             "The coarsening target for the AMG which is used for the "
+                             "pressure stage of the CPR preconditioner");
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);
+        int coarsenTarget = EWOMS_GET_PARAM(TypeTag, int, CprCoarsenTarget);
+
+        seqPreCond_ = new SequentialPreconditioner(matrix,
+                                                   /*pressureIdx=*/0,
+                                                   relaxationFactor,
+                                                   coarsenTarget);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    SequentialPreconditioner *seqPreCond_;
+};
+
+/*!
+ * \brief Wraps the ILU(0) preconditioner which applies the triangular solves using
+ *        multiple threads.
+ */
+template <class TypeTag>
+class PreconditionerWrapperThreadedILU0
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using SequentialPreconditioner = ThreadedIlu0Preconditioner<OverlappingMatrix, OverlappingVector>;
+
+    PreconditionerWrapperThreadedILU0()
+    {}
+
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PreconditionerRelaxation,
+                             "The relaxation factor of the preconditioner");
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);
+
+        seqPreCond_ = new SequentialPreconditioner(matrix, relaxationFactor);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    SequentialPreconditioner *seqPreCond_;
+};
+
+/*!
+ * \brief Wraps an ILU(0) preconditioner which operates on a single precision copy of the
+ *        matrix.
+ *
+ * The linear solver still uses the precision of the matrix, see
+ * Opm::Linear::MixedPrecisionPreconditioner.
+ */
+template <class TypeTag>
+class PreconditionerWrapperMixedPrecisionILU0
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+    using FloatMatrix = typename MixedPrecisionTraits<OverlappingMatrix, OverlappingVector>::FloatMatrix;
+    using FloatVector = typename MixedPrecisionTraits<OverlappingMatrix, OverlappingVector>::FloatVector;
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
+    using FloatPreconditioner = Dune::SeqILU<FloatMatrix, FloatVector, FloatVector>;
+#else
+    using FloatPreconditioner = Dune::SeqILU0<FloatMatrix, FloatVector, FloatVector>;
+#endif
+
+public:
+    using SequentialPreconditioner = MixedPrecisionPreconditioner<OverlappingMatrix,
+                                                                  OverlappingVector,
+                                                                  FloatPreconditioner>;
+
+    PreconditionerWrapperMixedPrecisionILU0()
+    {}
+
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PreconditionerRelaxation,
+                             "The relaxation factor of the preconditioner");
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        float relaxationFactor =
+            static_cast<float>(EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation));
+
+        seqPreCond_ = new SequentialPreconditioner(matrix,
+                                                   [relaxationFactor](const FloatMatrix& floatMatrix)
+                                                   { return std::make_unique<FloatPreconditioner>(floatMatrix, relaxationFactor); });
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    SequentialPreconditioner *seqPreCond_;
+};
+
+/*!
+ * \brief Wraps the constrained pressure residual (CPR) preconditioner which operates on a
+ *        single precision copy of the matrix.
+ *
+ * \copydetails PreconditionerWrapperCPR
+ */
+template <class TypeTag>
+class PreconditionerWrapperMixedPrecisionCPR
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+    using FloatMatrix = typename MixedPrecisionTraits<OverlappingMatrix, OverlappingVector>::FloatMatrix;
+    using FloatVector = typename MixedPrecisionTraits<OverlappingMatrix, OverlappingVector>::FloatVector;
+    using FloatPreconditioner = CprPreconditioner<FloatMatrix, FloatVector>;
+
+public:
+    using SequentialPreconditioner = MixedPrecisionPreconditioner<OverlappingMatrix,
+                                                                  OverlappingVector,
+                                                                  FloatPreconditioner>;
+
+    PreconditionerWrapperMixedPrecisionCPR()
+    {}
+
+    static void registerParameters()
+    { PreconditionerWrapperCPR<TypeTag>::registerParameters(); }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        float relaxationFactor =
+            static_cast<float>(EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation));
+        int coarsenTarget = EWOMS_GET_PARAM(TypeTag, int, CprCoarsenTarget);
+
+        seqPreCond_ = new SequentialPreconditioner(matrix,
+                                                   [relaxationFactor, coarsenTarget](const FloatMatrix& floatMatrix)
+                                                   {
+                                                       return std::make_unique<FloatPreconditioner>(floatMatrix,
+                                                                                                    /*pressureIdx=*/0,
+                                                                                                    relaxationFactor,
+                                                                                                    coarsenTarget);
+                                                   });
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    SequentialPreconditioner *seqPreCond_;
+};
+
+/*!
+ * \brief Wraps the geometric multigrid preconditioner.
+ *
+ * The lattice is taken from the structured layout of the discretization. If the
+ * elements of the grid do not form a Cartesian lattice or if the rows of the matrix
+ * are not numbered like the elements (i.e., in parallel runs), only the smoother of the
+ * preconditioner is applied.
+ */
+template <class TypeTag>
+class PreconditionerWrapperGeometricMultigrid
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using SequentialPreconditioner = GeometricMultigridPreconditioner<OverlappingMatrix, OverlappingVector>;
+
+    PreconditionerWrapperGeometricMultigrid()
+        : simulator_(nullptr)
+    {}
+
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PreconditionerRelaxation,
+                             "The relaxation factor of the preconditioner");
+        EWOMS_REGISTER_PARAM(TypeTag, int, MultigridCoarsenTarget,
+                             "The maximum number of unknowns of the coarsest level of the "
+                             "geometric multigrid preconditioner");
+    }
+
+    void init(const Simulator& simulator)
+    { simulator_ = &simulator; }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);
+        int coarsenTarget = EWOMS_GET_PARAM(TypeTag, int, MultigridCoarsenTarget);
+
+        std::vector<unsigned> dims;
+        const auto& layout = simulator_->model().structuredLayout();
+        if (layout.isStructured() && matrix.overlap().hasNativeLayout()) {
+            const auto& layoutDims = layout.dimensions();
+            dims.assign(layoutDims.begin(), layoutDims.end());
+        }
+
+        seqPreCond_ = new SequentialPreconditioner(matrix,
+                                                   dims,
+                                                   relaxationFactor,
+                                                   static_cast<size_t>(std::max(coarsenTarget, 1)));
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    const Simulator* simulator_;
+    SequentialPreconditioner *seqPreCond_;
+};
+
+/*!
+ * \brief Wraps the block preconditioner which separates the degrees of freedom that
+ *        are cut by fractures from the ones of the rock matrix.
+ *
+ * The fracture degrees of freedom are determined using the fracture mapper of the
+ * problem, so this only works for the discrete fracture model. Rows of the matrix
+ * which do not correspond to a degree of freedom of the local process are treated
+ * like rock matrix.
+ */
+template <class TypeTag>
+class PreconditionerWrapperFractureBlock
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using SequentialPreconditioner = FractureBlockPreconditioner<OverlappingMatrix, OverlappingVector>;
+
+    PreconditionerWrapperFractureBlock()
+        : simulator_(nullptr)
+    {}
+
+    static void registerParameters()
+    { PreconditionerWrapperCPR<TypeTag>::registerParameters(); }
+
+    void init(const Simulator& simulator)
+    { simulator_ = &simulator; }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);
+        int coarsenTarget = EWOMS_GET_PARAM(TypeTag, int, CprCoarsenTarget);
+
+        const auto& overlap = matrix.overlap();
+        const auto& fractureMapper = simulator_->problem().fractureMapper();
+        std::vector<bool> isFractureRow(matrix.N(), false);
+        for (size_t rowIdx = 0; rowIdx < matrix.N(); ++rowIdx) {
+            auto nativeIdx = overlap.domesticToNative(static_cast<int>(rowIdx));
+            isFractureRow[rowIdx] =
+                nativeIdx >= 0 && fractureMapper.isFractureVertex(static_cast<unsigned>(nativeIdx));
+        }
+
+        seqPreCond_ = new SequentialPreconditioner(matrix,
+                                                   isFractureRow,
+                                                   relaxationFactor,
+                                                   coarsenTarget);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { delete seqPreCond_; }
+
+private:
+    const Simulator* simulator_;
+    SequentialPreconditioner *seqPreCond_;
+};
+
+/*!
+ * \brief Selects the sequential preconditioner at run time based on the measured
+ *        performance of the linear solves.
+ *
+ * The candidates are given by the AutoTunePreconditioners parameter as a comma
+ * separated list of \c ILU0 (the threaded one), \c SSOR, \c Jacobi and \c CPR. Each
+ * candidate is used for AutoTuneTrials linear solves, after which the one which needed
+ * the least time for setting up the preconditioner and solving is kept. The candidates
+ * are evaluated again after AutoTuneInterval solves, if a solve fails or if it needs
+ * more iterations than the selected preconditioner needed during its evaluation times
+ * AutoTuneIterationFactor. The cost of a candidate is the one of the slowest process,
+ * so all processes select the same preconditioner.
+ *
+ * The backend reports the outcome of each solve via recordSolve(). If a candidate does
+ * not get to that point, e.g., because its construction failed, it is considered to
+ * have failed once the preconditioner is prepared for the next matrix.
+ */
+template <class TypeTag>
+class PreconditionerWrapperAutoTuned
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using SequentialPreconditioner = Dune::Preconditioner<OverlappingVector, OverlappingVector>;
+
+private:
+    using Factory = std::function<std::unique_ptr<SequentialPreconditioner>(OverlappingMatrix&)>;
+
+public:
+    PreconditionerWrapperAutoTuned()
+        : simulator_(nullptr)
+        , curIdx_(0)
+        , evaluating_(false)
+        , solvePending_(false)
+        , numTrials_(0)
+        , numSolvesSinceEvaluation_(0)
+        , referenceIterations_(0.0)
+    {}
+
+    static void registerParameters()
+    {
+        PreconditionerWrapperCPR<TypeTag>::registerParameters();
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, AutoTunePreconditioners,
+                             "The comma separated list of preconditioners which are "
+                             "evaluated by the auto-tuning (ILU0, SSOR, Jacobi, CPR)");
+        EWOMS_REGISTER_PARAM(TypeTag, int, AutoTuneTrials,
+                             "The number of linear solves for which each candidate "
+                             "preconditioner is evaluated");
+        EWOMS_REGISTER_PARAM(TypeTag, int, AutoTuneInterval,
+                             "The number of linear solves after which the candidate "
+                             "preconditioners are evaluated again (0: only if the "
+                             "convergence deteriorates)");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, AutoTuneIterationFactor,
+                             "Evaluate the candidate preconditioners again if the number of "
+                             "linear iterations exceeds the one of the selected preconditioner "
+                             "during its evaluation by this factor");
+    }
+
+    void init(const Simulator& simulator)
+    {
+        simulator_ = &simulator;
+
+        std::istringstream iss(EWOMS_GET_PARAM(TypeTag, std::string, AutoTunePreconditioners));
+        std::string name;
+        while (std::getline(iss, name, ',')) {
+            name.erase(0, name.find_first_not_of(" \t"));
+            name.erase(name.find_last_not_of(" \t") + 1);
+            if (!name.empty())
+                addCandidate_(name);
+        }
+        if (factories_.empty())
+            throw std::invalid_argument("No candidates for the auto-tuned preconditioner specified");
+
+        startEvaluation_();
+    }
+
+    void prepare(OverlappingMatrix& matrix)
+    {
+        // the solve with the previous preconditioner did not complete
+        if (solvePending_)
+            recordSolve_(std::numeric_limits<double>::infinity(), /*iterations=*/0, /*converged=*/false);
+
+        solvePending_ = true;
+        seqPreCond_ = factories_[curIdx_](matrix);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    { seqPreCond_.reset(); }
+
+    /*!
+     * \brief Account for the performance of a linear solve.
+     *
+     * This must be called by all processes after each solve.
+     */
+    void recordSolve(const SolverReport& report)
+    {
+        double cost = std::numeric_limits<double>::infinity();
+        if (report.converged())
+            cost = report.setupTimer().realTimeElapsed() + report.timer().realTimeElapsed();
+        cost = simulator_->gridView().comm().max(cost);
+
+        solvePending_ = false;
+        recordSolve_(cost, report.iterations(), report.converged());
+    }
+
+    /*!
+     * \brief Returns the name of the preconditioner which is currently used.
+     */
+    const std::string& currentName() const
+    { return names_[curIdx_]; }
+
+private:
+    void addCandidate_(const std::string& name)
+    {
+        Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);
+        Factory factory;
+        if (name == "ILU0")
+            factory = [relaxationFactor](OverlappingMatrix& matrix)
+                      -> std::unique_ptr<SequentialPreconditioner>
+                      {
+                          using Precond = ThreadedIlu0Preconditioner<OverlappingMatrix, OverlappingVector>;
+                          return std::make_unique<Precond>(matrix, relaxationFactor);
+                      };
+        else if (name == "SSOR")
+            factory = [relaxationFactor](OverlappingMatrix& matrix)
+                      -> std::unique_ptr<SequentialPreconditioner>
+                      {
+                          using Precond = Dune::SeqSSOR<OverlappingMatrix, OverlappingVector, OverlappingVector>;
+                          return std::make_unique<Precond>(matrix, /*iterations=*/1, relaxationFactor);
+                      };
+        else if (name == "Jacobi")
+            factory = [relaxationFactor](OverlappingMatrix& matrix)
+                      -> std::unique_ptr<SequentialPreconditioner>
+                      {
+                          using Precond = Dune::SeqJac<OverlappingMatrix, OverlappingVector, OverlappingVector>;
+                          return std::make_unique<Precond>(matrix, /*iterations=*/1, relaxationFactor);
+                      };
+        else if (name == "CPR") {
+            int coarsenTarget = EWOMS_GET_PARAM(TypeTag, int, CprCoarsenTarget);
+            factory = [relaxationFactor, coarsenTarget](OverlappingMatrix& matrix)
+                      -> std::unique_ptr<SequentialPreconditioner>
+                      {
+                          using Precond = CprPreconditioner<OverlappingMatrix, OverlappingVector>;
+                          return std::make_unique<Precond>(matrix,
+                                                           /*pressureIdx=*/0,
+                                                           relaxationFactor,
+                                                           coarsenTarget);
+                      };
+        }
+        else
+            throw std::invalid_argument("Unknown candidate for the auto-tuned preconditioner: '"
+                                        + name + "'");
+
+        names_.push_back(name);
+        factories_.push_back(factory);
+    }
+
+    void startEvaluation_()
+    {
+        curIdx_ = 0;
+        numTrials_ = 0;
+        costs_.assign(factories_.size(), 0.0);
+        iterations_.assign(factories_.size(), 0.0);
+
+        // there is nothing to choose from with a single candidate
+        evaluating_ = factories_.size() > 1;
+        numSolvesSinceEvaluation_ = 0;
+        referenceIterations_ = 0.0;
+    }
+
+    void recordSolve_(double cost, unsigned iterations, bool converged)
+    {
+        if (evaluating_) {
+            costs_[curIdx_] += cost;
+            iterations_[curIdx_] += iterations;
+
+            int numTrials = std::max(EWOMS_GET_PARAM(TypeTag, int, AutoTuneTrials), 1);
+            if (++numTrials_ < numTrials)
+                return;
+
+            numTrials_ = 0;
+            if (curIdx_ + 1 < factories_.size()) {
+                ++curIdx_;
+                return;
+            }
+
+            // all candidates have been evaluated, so keep the cheapest one
+            curIdx_ = static_cast<size_t>(std::min_element(costs_.begin(), costs_.end()) - costs_.begin());
+            evaluating_ = false;
+            numSolvesSinceEvaluation_ = 0;
+            referenceIterations_ = iterations_[curIdx_]/numTrials;
+
+            int verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+            if (verbosity > 0 && simulator_->gridView().comm().rank() == 0)
+                std::cout << "Auto-tuning selected the " << names_[curIdx_]
+                          << " preconditioner\n" << std::flush;
+            return;
+        }
+
+        ++numSolvesSinceEvaluation_;
+        int interval = EWOMS_GET_PARAM(TypeTag, int, AutoTuneInterval);
+        Scalar factor = EWOMS_GET_PARAM(TypeTag, Scalar, AutoTuneIterationFactor);
+        if (!converged
+            || (interval > 0 && numSolvesSinceEvaluation_ >= interval)
+            || iterations > factor*std::max(referenceIterations_, 1.0))
+            startEvaluation_();
+    }
+
+    const Simulator* simulator_;
+
+    std::vector<std::string> names_;
+    std::vector<Factory> factories_;
+    std::unique_ptr<SequentialPreconditioner> seqPreCond_;
+
+    // the index of the candidate which is currently used
+    size_t curIdx_;
+    bool evaluating_;
+    // true if the preconditioner was prepared but the outcome of the solve is unknown
+    bool solvePending_;
+
+    // the accumulated costs and iterations of the candidates during the evaluation
+    std::vector<double> costs_;
+    std::vector<double> iterations_;
+    int numTrials_;
+
+    int numSolvesSinceEvaluation_;
+    double referenceIterations_;
+};
+
 #undef EWOMS_WRAP_ISTL_PRECONDITIONER
 }} // namespace Linear, Opm
 
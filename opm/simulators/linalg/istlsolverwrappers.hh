@@ -40,6 +40,7 @@
  * - \c BiCGStab: A stabilized bi-conjugated gradients solver
  * - \c MinRes: A solver based on the  minimized residual algorithm
  * - \c RestartedGMRes: A restarted GMRES solver
+ * - \c RecyclingGMRes: A restarted GMRES solver which recycles a subspace between solves
  */
 #ifndef EWOMS_ISTL_SOLVER_WRAPPERS_HH
 #define EWOMS_ISTL_SOLVER_WRAPPERS_HH
@@ -47,6 +48,7 @@
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
+#include <opm/simulators/linalg/recyclinggmressolver.hh>
 
 #include <dune/istl/solvers.hh>
 
@@ -75,10 +77,9 @@ namespace Opm::Linear {
         template <class LinearOperator, class ScalarProduct, class Preconditioner> \
         std::shared_ptr<RawSolver> get(LinearOperator& parOperator,                \
                                        ScalarProduct& parScalarProduct,            \
-                                       Preconditioner& parPreCond)                 \
+                                       Preconditioner& parPreCond,                 \
+                                       Scalar tolerance)                           \
         {                                                                          \
-            Scalar tolerance = EWOMS_GET_PARAM(TypeTag, Scalar,                    \
-                                               LinearSolverTolerance);             \
             int maxIter = EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations);\
                                                                                    \
             int verbosity = 0;                                                     \
@@ -131,9 +132,9 @@ public:
     template <class LinearOperator, class ScalarProduct, class Preconditioner>
     std::shared_ptr<RawSolver> get(LinearOperator& parOperator,
                                    ScalarProduct& parScalarProduct,
-                                   Preconditioner& parPreCond)
+                                   Preconditioner& parPreCond,
+                                   Scalar tolerance)
     {
-        Scalar tolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
         int maxIter = EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations);
 
         int verbosity = 0;
@@ -158,6 +159,78 @@ private:
     std::shared_ptr<RawSolver> solver_;
 };
 
+/*!
+ * \brief Solver wrapper for the GMRES solver which recycles the solutions of previous
+ *        linear systems.
+ *
+ * The recycled space is owned by the solver backend, which passes it to the wrapper
+ * using setRecycleSpace() before get() is called.
+ */
+template <class TypeTag>
+class SolverWrapperRecyclingGMRes
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using RawSolver = RecyclingGmresSolver<Dune::LinearOperator<OverlappingVector, OverlappingVector>,
+                                           OverlappingVector,
+                                           Dune::ScalarProduct<OverlappingVector>,
+                                           Dune::Preconditioner<OverlappingVector, OverlappingVector> >;
+    using RecycleSpace = typename RawSolver::RecycleSpace;
+
+    SolverWrapperRecyclingGMRes()
+        : recycleSpace_(nullptr)
+    {}
+
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, int, GMResRestart,
+                             "Number of iterations after which the GMRES linear solver is restarted");
+        EWOMS_REGISTER_PARAM(TypeTag, int, GMResRecycleSize,
+                             "Maximum number of solutions of previous linear systems which are "
+                             "deflated by the recycling GMRES linear solver");
+    }
+
+    void setRecycleSpace(RecycleSpace& space)
+    { recycleSpace_ = &space; }
+
+    template <class LinearOperator, class ScalarProduct, class Preconditioner>
+    std::shared_ptr<RawSolver> get(LinearOperator& parOperator,
+                                   ScalarProduct& parScalarProduct,
+                                   Preconditioner& parPreCond,
+                                   Scalar tolerance)
+    {
+        int maxIter = EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations);
+
+        int verbosity = 0;
+        if (parOperator.overlap().myRank() == 0)
+            verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+        int restartAfter = EWOMS_GET_PARAM(TypeTag, int, GMResRestart);
+        solver_ = std::make_shared<RawSolver>(parOperator,
+                                              parScalarProduct,
+                                              parPreCond,
+                                              tolerance,
+                                              static_cast<unsigned>(restartAfter),
+                                              static_cast<unsigned>(maxIter),
+                                              verbosity);
+
+        if (recycleSpace_) {
+            recycleSpace_->setMaxSize(static_cast<unsigned>(EWOMS_GET_PARAM(TypeTag, int, GMResRecycleSize)));
+            solver_->setRecycleSpace(recycleSpace_);
+        }
+
+        return solver_;
+    }
+
+    void cleanup()
+    { solver_.reset(); }
+
+private:
+    std::shared_ptr<RawSolver> solver_;
+    RecycleSpace* recycleSpace_;
+};
+
 #undef EWOMS_WRAP_ISTL_SOLVER
 
 } // namespace Opm::Linear
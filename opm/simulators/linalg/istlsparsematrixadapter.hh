@@ -31,6 +31,9 @@
 #include <dune/common/fmatrix.hh>
 #include <dune/common/version.hh>
 
+#include <cassert>
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 
@@ -72,32 +75,61 @@ public:
 
     /*!
      * \brief Allocate matrix structure give a sparsity pattern.
+     *
+     * The sets of the sparsity pattern must iterate over the column indices in
+     * ascending order (which is the case for std::set). This allows to build the matrix
+     * row by row, which avoids sorting the column indices of each row.
      */
     template <class Set>
     void reserve(const std::vector<Set>& sparsityPattern)
     {
-        // allocate raw matrix
-        istlMatrix_.reset(new IstlMatrix(rows_, columns_, IstlMatrix::random));
-
         // make sure sparsityPattern is consistent with number of rows
         assert(rows_ == sparsityPattern.size());
 
-        // allocate space for the rows of the matrix
+        size_t numNonZeros = 0;
         for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx)
-            istlMatrix_->setrowsize(dofIdx, sparsityPattern[dofIdx].size());
+            numNonZeros += sparsityPattern[dofIdx].size();
 
-        istlMatrix_->endrowsizes();
+        // allocate raw matrix
+        istlMatrix_.reset(new IstlMatrix(rows_, columns_, numNonZeros, IstlMatrix::row_wise));
 
         // fill the rows with indices. each degree of freedom talks to
         // all of its neighbors. (it also talks to itself since
         // degrees of freedom are sometimes quite egocentric.)
-        for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx) {
-            auto nIt    = sparsityPattern[dofIdx].begin();
-            auto nEndIt = sparsityPattern[dofIdx].end();
+        auto rowIt = istlMatrix_->createbegin();
+        const auto& rowEndIt = istlMatrix_->createend();
+        for (; rowIt != rowEndIt; ++rowIt) {
+            const auto& neighbors = sparsityPattern[rowIt.index()];
+            auto nIt    = neighbors.begin();
+            auto nEndIt = neighbors.end();
             for (; nIt != nEndIt; ++nIt)
-                istlMatrix_->addindex(dofIdx, *nIt);
+                rowIt.insert(*nIt);
+        }
+    }
+
+    /*!
+     * \brief Allocate matrix structure given a sparsity pattern in compressed row format.
+     *
+     * The column indices of row i are stored at the positions rowOffsets[i] to
+     * rowOffsets[i + 1] - 1 of the columnIndices array. Within each row, the column
+     * indices must be sorted in ascending order and must be unique.
+     */
+    void reserve(const std::vector<size_t>& rowOffsets,
+                 const std::vector<unsigned>& columnIndices)
+    {
+        // make sure the sparsity pattern is consistent with number of rows
+        assert(rows_ + 1 == rowOffsets.size());
+
+        // allocate raw matrix
+        istlMatrix_.reset(new IstlMatrix(rows_, columns_, columnIndices.size(), IstlMatrix::row_wise));
+
+        auto rowIt = istlMatrix_->createbegin();
+        const auto& rowEndIt = istlMatrix_->createend();
+        for (; rowIt != rowEndIt; ++rowIt) {
+            size_t rowIdx = rowIt.index();
+            for (size_t i = rowOffsets[rowIdx]; i < rowOffsets[rowIdx + 1]; ++i)
+                rowIt.insert(columnIndices[i]);
         }
-        istlMatrix_->endindices();
     }
 
     /*!
@@ -167,6 +199,16 @@ public:
     void addToBlock(const size_t rowIdx, const size_t colIdx, const MatrixBlock& value)
     { (*istlMatrix_)[rowIdx][colIdx] += value; }
 
+    /*!
+     * \brief Return the address of a non-zero block of the matrix.
+     *
+     * Unlike the other block accessors, this does not search the row for the column
+     * index once the address is known. The address stays valid until the matrix
+     * structure is recreated by reserve().
+     */
+    MatrixBlock* blockAddress(const size_t rowIdx, const size_t colIdx)
+    { return &(*istlMatrix_)[rowIdx][colIdx]; }
+
     /*!
      * \brief Commit matrix from local caches into matrix native structure.
      *
@@ -82,6 +82,16 @@ struct LinearSolverVerbosity { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverMaxIterations { using type = UndefinedProperty; };
 
+/*!
+ * \brief Maximum number of steps of iterative refinement after the linear solve.
+ *
+ * Each step computes the residual of the solution using the floating point type of
+ * the linearization and solves for a correction using the one of the linear solver.
+ * This is only useful if the linear solver uses a less precise type than the model.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverRefinementSteps { using type = UndefinedProperty; };
+
 //! The order of the sequential preconditioner
 template<class TypeTag, class MyTypeTag>
 struct PreconditionerOrder { using type = UndefinedProperty; };
@@ -90,13 +100,74 @@ struct PreconditionerOrder { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct PreconditionerRelaxation { using type = UndefinedProperty; };
 
+//! The coarsening target of the AMG used by the pressure stage of the CPR preconditioner
+template<class TypeTag, class MyTypeTag>
+struct CprCoarsenTarget { using type = UndefinedProperty; };
+
+//! The maximum number of unknowns of the coarsest level of the geometric multigrid
+//! preconditioner
+template<class TypeTag, class MyTypeTag>
+struct MultigridCoarsenTarget { using type = UndefinedProperty; };
+
+//! The comma separated list of candidates of the auto-tuned preconditioner
+template<class TypeTag, class MyTypeTag>
+struct AutoTunePreconditioners { using type = UndefinedProperty; };
+
+//! The number of linear solves for which each candidate of the auto-tuned
+//! preconditioner is evaluated
+template<class TypeTag, class MyTypeTag>
+struct AutoTuneTrials { using type = UndefinedProperty; };
+
+//! The number of linear solves after which the auto-tuned preconditioner evaluates
+//! its candidates again (0: only if the convergence deteriorates)
+template<class TypeTag, class MyTypeTag>
+struct AutoTuneInterval { using type = UndefinedProperty; };
+
+/*!
+ * \brief The auto-tuned preconditioner evaluates its candidates again if the number of
+ *        linear iterations exceeds the one of the selected candidate during its
+ *        evaluation by this factor.
+ */
+template<class TypeTag, class MyTypeTag>
+struct AutoTuneIterationFactor { using type = UndefinedProperty; };
+
+//! Add a coarse correction with one aggregate per process to the parallel
+//! preconditioner, i.e., use a two-level additive Schwarz method
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverCoarseSpace { using type = UndefinedProperty; };
+
+//! The initial guess of the linear solver: "zero", "previous" (a multiple of the
+//! solution of the previous solve) or "extrapolated" (a multiple of the linear
+//! extrapolation of the solutions of the two previous solves)
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverInitialGuess { using type = UndefinedProperty; };
+
 //! number of iterations between solver restarts for the GMRES solver
 template<class TypeTag, class MyTypeTag>
 struct GMResRestart { using type = UndefinedProperty; };
 
+//! maximum number of solution vectors which the recycling GMRES solver keeps between
+//! solves
+template<class TypeTag, class MyTypeTag>
+struct GMResRecycleSize { using type = UndefinedProperty; };
+
+//! The method used to orthogonalize the Krylov basis of the native GMRES solver ("cgs2"
+//! or "mgs")
+template<class TypeTag, class MyTypeTag>
+struct GMResOrthogonalization { using type = UndefinedProperty; };
+
+//! The preconditioner of the linear solver which runs on an offloading device ("ilu0" or
+//! "jacobi")
+template<class TypeTag, class MyTypeTag>
+struct OffloadPreconditioner { using type = UndefinedProperty; };
+
 //! The class that allows to manipulate sparse matrices
 template<class TypeTag, class MyTypeTag>
 struct SparseMatrixAdapter { using type = UndefinedProperty; };
+//! The pattern of the entries of the Jacobian's blocks which are always zero, see
+//! Opm::DenseBlockSparsity
+template<class TypeTag, class MyTypeTag>
+struct JacobianBlockSparsity { using type = UndefinedProperty; };
 
 //! Vector containing a quantity of for equation for each DOF of the whole grid
 template<class TypeTag, class MyTypeTag>
@@ -104,8 +175,32 @@ struct GlobalEqVector { using type = UndefinedProperty; };
 
 template<class TypeTag, class MyTypeTag>
 struct AmgCoarsenTarget { using type = UndefinedProperty; };
+
+/*!
+ * \brief The maximum number of linear solves for which the hierarchy of the AMG
+ *        preconditioner is reused.
+ *
+ * If the hierarchy is reused, only the matrices of the coarse levels are recomputed
+ * using the same aggregates. A value of 1 means that the hierarchy is rebuilt for every
+ * linear solve, 0 means that it is only rebuilt if the convergence of the linear solver
+ * deteriorates.
+ */
+template<class TypeTag, class MyTypeTag>
+struct AmgRebuildInterval { using type = UndefinedProperty; };
+
+/*!
+ * \brief The hierarchy of the AMG preconditioner is rebuilt if the number of
+ *        iterations of the linear solver exceeds the one of the first solve after the
+ *        last rebuild by this factor.
+ */
+template<class TypeTag, class MyTypeTag>
+struct AmgRebuildIterationFactor { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverMaxError { using type = UndefinedProperty; };
+//! Compute the scalar products of an iteration of the linear solver using as few global
+//! reductions as possible
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverFuseReductions { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverWrapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
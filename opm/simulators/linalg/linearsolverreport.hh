@@ -47,8 +47,11 @@ public:
     void reset()
     {
         timer_.halt();
+        setupTimer_.halt();
         iterations_ = 0;
         converged_ = 0;
+        recycleSpaceSize_ = 0;
+        savedIterations_ = 0;
     }
 
     const Opm::Timer& timer() const
@@ -57,6 +60,18 @@ public:
     Opm::Timer& timer()
     { return timer_; }
 
+    /*!
+     * \brief The timer for setting up the preconditioner.
+     *
+     * In contrast to timer(), this does not include the time spent for applying the
+     * preconditioner and the Krylov iterations.
+     */
+    const Opm::Timer& setupTimer() const
+    { return setupTimer_; }
+
+    Opm::Timer& setupTimer()
+    { return setupTimer_; }
+
     unsigned iterations() const
     { return iterations_; }
 
@@ -72,10 +87,34 @@ public:
     void setConverged(bool value)
     { converged_ = value; }
 
+    /*!
+     * \brief The dimension of the subspace which was recycled from previous solves.
+     */
+    unsigned recycleSpaceSize() const
+    { return recycleSpaceSize_; }
+
+    void setRecycleSpaceSize(unsigned value)
+    { recycleSpaceSize_ = value; }
+
+    /*!
+     * \brief The number of iterations which the solver needed less than for the last
+     *        solve without a recycled subspace.
+     *
+     * This may be negative if recycling did not pay off.
+     */
+    int savedIterations() const
+    { return savedIterations_; }
+
+    void setSavedIterations(int value)
+    { savedIterations_ = value; }
+
 private:
     Opm::Timer timer_;
+    Opm::Timer setupTimer_;
     unsigned iterations_;
     bool converged_;
+    unsigned recycleSpaceSize_;
+    int savedIterations_;
 };
 
 }} // end namespace Linear, Opm
@@ -0,0 +1,192 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::MixedPrecisionPreconditioner
+ */
+#ifndef EWOMS_MIXED_PRECISION_PRECONDITIONER_HH
+#define EWOMS_MIXED_PRECISION_PRECONDITIONER_HH
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/preconditioner.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <memory>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief The single precision matrix and vector types which correspond to a given matrix
+ *        and vector type.
+ */
+template <class Matrix, class Vector>
+struct MixedPrecisionTraits
+{
+    using MatrixBlock = typename Matrix::block_type;
+    using VectorBlock = typename Vector::block_type;
+
+    using FloatMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<float, MatrixBlock::rows, MatrixBlock::cols> >;
+    using FloatVector = Dune::BlockVector<Dune::FieldVector<float, VectorBlock::dimension> >;
+};
+
+/*!
+ * \brief Applies a preconditioner which is built on a single precision copy of a matrix.
+ *
+ * Applying preconditioners like ILU is usually limited by the memory bandwidth, so
+ * storing the matrix and all data derived from it using float instead of double roughly
+ * halves the time required to apply them. The linear solver itself, i.e., the residual
+ * and the solution, still uses the precision of the original matrix. Since the
+ * preconditioner is only an approximate inverse anyway, the reduced precision usually
+ * does not affect the convergence of the linear solver.
+ *
+ * \tparam Matrix The type of the matrix of the linear system
+ * \tparam Vector The type of the vectors used by the linear solver
+ * \tparam FloatPreconditioner The type of the preconditioner which operates on the
+ *                             FloatMatrix and FloatVector types of MixedPrecisionTraits
+ */
+template <class Matrix, class Vector, class FloatPreconditioner>
+class MixedPrecisionPreconditioner : public Dune::Preconditioner<Vector, Vector>
+{
+    using MatrixBlock = typename Matrix::block_type;
+    using VectorBlock = typename Vector::block_type;
+
+public:
+    using FloatMatrix = typename MixedPrecisionTraits<Matrix, Vector>::FloatMatrix;
+    using FloatVector = typename MixedPrecisionTraits<Matrix, Vector>::FloatVector;
+
+    using domain_type = Vector;
+    using range_type = Vector;
+    using field_type = typename Vector::field_type;
+
+    /*!
+     * \brief Create a single precision copy of a matrix and the preconditioner for it.
+     *
+     * \param A The matrix of the linear system of equations
+     * \param createPreconditioner A callable object which creates the preconditioner
+     *                             for a given FloatMatrix and returns a std::unique_ptr
+     *                             to it
+     */
+    template <class PreconditionerCreator>
+    MixedPrecisionPreconditioner(const Matrix& A, PreconditionerCreator createPreconditioner)
+    {
+        copyMatrix_(A);
+        floatPreconditioner_ = createPreconditioner(static_cast<const FloatMatrix&>(*floatMatrix_));
+
+        floatSol_.resize(A.N());
+        floatRhs_.resize(A.N());
+    }
+
+    //! the kind of computations supported by the preconditioner
+    Dune::SolverCategory::Category category() const override
+    { return floatPreconditioner_->category(); }
+
+    void pre(Vector& x, Vector& b) override
+    {
+        copyToFloat_(floatSol_, x);
+        copyToFloat_(floatRhs_, b);
+        floatPreconditioner_->pre(floatSol_, floatRhs_);
+        copyFromFloat_(x, floatSol_);
+    }
+
+    void apply(Vector& v, const Vector& d) override
+    {
+        copyToFloat_(floatSol_, v);
+        copyToFloat_(floatRhs_, d);
+        floatPreconditioner_->apply(floatSol_, floatRhs_);
+        copyFromFloat_(v, floatSol_);
+    }
+
+    void post(Vector& x) override
+    {
+        copyToFloat_(floatSol_, x);
+        floatPreconditioner_->post(floatSol_);
+        copyFromFloat_(x, floatSol_);
+    }
+
+    /*!
+     * \brief Returns the single precision preconditioner.
+     */
+    FloatPreconditioner& floatPreconditioner()
+    { return *floatPreconditioner_; }
+
+private:
+    void copyMatrix_(const Matrix& A)
+    {
+        size_t n = A.N();
+        floatMatrix_ = std::make_unique<FloatMatrix>(n, A.M(), A.nonzeroes(), FloatMatrix::row_wise);
+
+        // copy the sparsity pattern
+        auto rowIt = floatMatrix_->createbegin();
+        const auto& rowEndIt = floatMatrix_->createend();
+        for (; rowIt != rowEndIt; ++rowIt) {
+            const auto& row = A[rowIt.index()];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt)
+                rowIt.insert(colIt.index());
+        }
+
+        // copy the values
+        for (unsigned rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const auto& row = A[rowIdx];
+            auto& floatRow = (*floatMatrix_)[rowIdx];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            for (; colIt != colEndIt; ++colIt) {
+                auto& floatBlock = floatRow[colIt.index()];
+                for (int i = 0; i < MatrixBlock::rows; ++i)
+                    for (int j = 0; j < MatrixBlock::cols; ++j)
+                        floatBlock[i][j] = static_cast<float>((*colIt)[i][j]);
+            }
+        }
+    }
+
+    static void copyToFloat_(FloatVector& dest, const Vector& src)
+    {
+        for (unsigned i = 0; i < src.size(); ++i)
+            for (int k = 0; k < VectorBlock::dimension; ++k)
+                dest[i][k] = static_cast<float>(src[i][k]);
+    }
+
+    static void copyFromFloat_(Vector& dest, const FloatVector& src)
+    {
+        for (unsigned i = 0; i < dest.size(); ++i)
+            for (int k = 0; k < VectorBlock::dimension; ++k)
+                dest[i][k] = src[i][k];
+    }
+
+    std::unique_ptr<FloatMatrix> floatMatrix_;
+    std::unique_ptr<FloatPreconditioner> floatPreconditioner_;
+
+    FloatVector floatSol_;
+    FloatVector floatRhs_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
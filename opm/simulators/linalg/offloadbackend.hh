@@ -0,0 +1,1014 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::OffloadBackend
+ */
+#ifndef EWOMS_OFFLOAD_BACKEND_HH
+#define EWOMS_OFFLOAD_BACKEND_HH
+
+#include <opm/simulators/linalg/istlsparsematrixadapter.hh>
+#include <opm/simulators/linalg/linalgproperties.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <opm/material/common/Unused.hpp>
+
+#include <dune/common/fmatrix.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// the computationally intensive loops are offloaded using OpenMP target
+// directives. if the compiler does not support offloading to a device, they are
+// executed on the host, if OpenMP is not enabled at all, they are executed serially.
+#ifdef _OPENMP
+#define EWOMS_OFFLOAD_PRAGMA(x) _Pragma(#x)
+#else
+#define EWOMS_OFFLOAD_PRAGMA(x)
+#endif
+
+namespace Opm::Properties::TTag {
+struct OffloadLinearSolver {};
+} // namespace Opm::Properties::TTag
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief An array which is mirrored in the memory of the offloading device.
+ *
+ * The host copy is only synchronized with the device copy by explicit calls of upload()
+ * and download().
+ */
+template <class T>
+class OffloadArray
+{
+public:
+    OffloadArray()
+        : mapped_(false)
+    {}
+
+    OffloadArray(const OffloadArray&) = delete;
+
+    ~OffloadArray()
+    { release_(); }
+
+    /*!
+     * \brief Change the number of entries of the array.
+     *
+     * The values of the array are undefined afterwards, both on the host and on the
+     * device.
+     */
+    void resize(size_t n)
+    {
+        if (mapped_ && n == values_.size())
+            return;
+
+        release_();
+        values_.resize(n);
+        if (n == 0)
+            return;
+
+        [[maybe_unused]] T* v = values_.data();
+        EWOMS_OFFLOAD_PRAGMA(omp target enter data map(alloc: v[0:n]))
+        mapped_ = true;
+    }
+
+    size_t size() const
+    { return values_.size(); }
+
+    /*!
+     * \brief Returns the address of the array in host memory.
+     *
+     * Inside of target regions, this is translated to the corresponding device address.
+     */
+    T* data()
+    { return values_.data(); }
+
+    const T* data() const
+    { return values_.data(); }
+
+    T& operator[](size_t i)
+    { return values_[i]; }
+
+    const T& operator[](size_t i) const
+    { return values_[i]; }
+
+    //! copy the host values to the device
+    void upload()
+    {
+        [[maybe_unused]] T* v = values_.data();
+        [[maybe_unused]] size_t n = values_.size();
+        EWOMS_OFFLOAD_PRAGMA(omp target update to(v[0:n]))
+    }
+
+    //! copy a contiguous range of host values to the device
+    void upload(size_t begin, size_t count)
+    {
+        [[maybe_unused]] T* v = values_.data() + begin;
+        EWOMS_OFFLOAD_PRAGMA(omp target update to(v[0:count]))
+    }
+
+    //! copy the device values to the host
+    void download()
+    {
+        [[maybe_unused]] T* v = values_.data();
+        [[maybe_unused]] size_t n = values_.size();
+        EWOMS_OFFLOAD_PRAGMA(omp target update from(v[0:n]))
+    }
+
+private:
+    void release_()
+    {
+        if (!mapped_)
+            return;
+
+        [[maybe_unused]] T* v = values_.data();
+        [[maybe_unused]] size_t n = values_.size();
+        EWOMS_OFFLOAD_PRAGMA(omp target exit data map(delete: v[0:n]))
+        mapped_ = false;
+    }
+
+    std::vector<T> values_;
+    bool mapped_;
+};
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A block matrix in compressed row storage which resides on an offloading device.
+ *
+ * The structure of the matrix is only uploaded if the sparsity pattern of the matrix
+ * changes. Otherwise, only its values are transferred.
+ */
+template <class Scalar, int blockSize>
+class OffloadBlockCsrMatrix
+{
+public:
+    static constexpr int blockEntries = blockSize*blockSize;
+
+    OffloadBlockCsrMatrix()
+        : numRows_(0)
+        , numNonZeros_(0)
+        , numTransferredRows_(0)
+        , valuesValid_(false)
+    {}
+
+    /*!
+     * \brief Returns true if the structure has been created for a block matrix with the
+     *        same number of rows and non-zero blocks.
+     */
+    template <class BlockMatrix>
+    bool patternMatches(const BlockMatrix& M) const
+    { return numRows_ > 0 && numRows_ == M.N() && numNonZeros_ == M.nonzeroes(); }
+
+    /*!
+     * \brief Create the sparsity pattern of the device matrix.
+     *
+     * The values are left undefined, call assignValues() to set them.
+     */
+    template <class BlockMatrix>
+    void createStructure(const BlockMatrix& M)
+    {
+        numRows_ = M.N();
+        numNonZeros_ = M.nonzeroes();
+
+        rowStart_.resize(numRows_ + 1);
+        colIndices_.resize(numNonZeros_);
+        diagIndices_.resize(numRows_);
+        values_.resize(numNonZeros_*blockEntries);
+        valuesValid_ = false;
+
+        size_t nzIdx = 0;
+        rowStart_[0] = 0;
+        for (auto rowIt = M.begin(); rowIt != M.end(); ++rowIt) {
+            size_t rowIdx = rowIt.index();
+            diagIndices_[rowIdx] = numNonZeros_;
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt) {
+                if (colIt.index() == rowIdx)
+                    diagIndices_[rowIdx] = nzIdx;
+                colIndices_[nzIdx++] = colIt.index();
+            }
+
+            if (diagIndices_[rowIdx] == numNonZeros_)
+                throw std::logic_error("The offloading linear solver requires that all "
+                                       "diagonal blocks of the matrix are non-zero");
+            rowStart_[rowIdx + 1] = nzIdx;
+        }
+
+        rowStart_.upload();
+        colIndices_.upload();
+        diagIndices_.upload();
+    }
+
+    /*!
+     * \brief Transfer the values of a block matrix which has the pattern for which the
+     *        structure has been created to the device.
+     *
+     * Only the block rows whose values differ from the ones of the previous call are
+     * transferred. Since consecutive Newton iterations often leave large parts of the
+     * Jacobian unchanged (e.g., if the linearization is partial), this avoids most of
+     * the traffic between the host and the device.
+     */
+    template <class BlockMatrix>
+    void assignValues(const BlockMatrix& M)
+    {
+        size_t nzIdx = 0;
+        size_t dirtyBegin = 0;
+        size_t dirtyEnd = 0;
+        numTransferredRows_ = 0;
+        for (auto rowIt = M.begin(); rowIt != M.end(); ++rowIt) {
+            bool rowChanged = !valuesValid_;
+            size_t rowBegin = nzIdx*blockEntries;
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt, ++nzIdx) {
+                const auto& block = *colIt;
+                Scalar* dest = values_.data() + nzIdx*blockEntries;
+                for (int i = 0; i < blockSize; ++i) {
+                    for (int j = 0; j < blockSize; ++j) {
+                        Scalar value = static_cast<Scalar>(block[i][j]);
+                        rowChanged = rowChanged || (dest[i*blockSize + j] != value);
+                        dest[i*blockSize + j] = value;
+                    }
+                }
+            }
+
+            if (!rowChanged)
+                continue;
+
+            // transfer contiguous ranges of changed rows at once
+            ++numTransferredRows_;
+            if (rowBegin != dirtyEnd) {
+                if (dirtyEnd > dirtyBegin)
+                    values_.upload(dirtyBegin, dirtyEnd - dirtyBegin);
+                dirtyBegin = rowBegin;
+            }
+            dirtyEnd = nzIdx*blockEntries;
+        }
+
+        if (dirtyEnd > dirtyBegin)
+            values_.upload(dirtyBegin, dirtyEnd - dirtyBegin);
+        valuesValid_ = true;
+    }
+
+    /*!
+     * \brief The number of block rows which have been transferred by the last call of
+     *        assignValues().
+     */
+    size_t numTransferredRows() const
+    { return numTransferredRows_; }
+
+    /*!
+     * \brief Compute y = A x on the device.
+     */
+    void mv(const OffloadArray<Scalar>& x, OffloadArray<Scalar>& y) const
+    {
+        const size_t* rowStart = rowStart_.data();
+        const size_t* colIndices = colIndices_.data();
+        const Scalar* values = values_.data();
+        const Scalar* xv = x.data();
+        Scalar* yv = y.data();
+        size_t n = numRows_;
+
+        EWOMS_OFFLOAD_PRAGMA(omp target teams distribute parallel for)
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx) {
+            Scalar tmp[blockSize];
+            for (int i = 0; i < blockSize; ++i)
+                tmp[i] = 0.0;
+
+            for (size_t nzIdx = rowStart[rowIdx]; nzIdx < rowStart[rowIdx + 1]; ++nzIdx) {
+                const Scalar* block = values + nzIdx*blockEntries;
+                const Scalar* xb = xv + colIndices[nzIdx]*blockSize;
+                for (int i = 0; i < blockSize; ++i)
+                    for (int j = 0; j < blockSize; ++j)
+                        tmp[i] += block[i*blockSize + j]*xb[j];
+            }
+
+            for (int i = 0; i < blockSize; ++i)
+                yv[rowIdx*blockSize + i] = tmp[i];
+        }
+    }
+
+    size_t numRows() const
+    { return numRows_; }
+
+    const OffloadArray<size_t>& rowStart() const
+    { return rowStart_; }
+
+    const OffloadArray<size_t>& colIndices() const
+    { return colIndices_; }
+
+    const OffloadArray<size_t>& diagIndices() const
+    { return diagIndices_; }
+
+    //! the values of the blocks, row-major within each block. the host copy is valid.
+    const OffloadArray<Scalar>& values() const
+    { return values_; }
+
+private:
+    size_t numRows_;
+    size_t numNonZeros_;
+    size_t numTransferredRows_;
+    bool valuesValid_;
+
+    OffloadArray<size_t> rowStart_;
+    OffloadArray<size_t> colIndices_;
+    OffloadArray<size_t> diagIndices_;
+    OffloadArray<Scalar> values_;
+};
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief Block Jacobi or block ILU(0) preconditioners which are applied on the
+ *        offloading device.
+ *
+ * The ILU(0) factorization is computed on the host, which is cheap compared to the
+ * iterations of the linear solver. Its triangular solves are done on the device: the
+ * rows are grouped into levels which only depend on the rows of previous levels, and the
+ * rows of each level are processed in parallel. The levels are only recomputed if the
+ * sparsity pattern of the matrix changes.
+ */
+template <class Scalar, int blockSize>
+class OffloadPreconditioner
+{
+    using Matrix = OffloadBlockCsrMatrix<Scalar, blockSize>;
+    using Block = Dune::FieldMatrix<Scalar, blockSize, blockSize>;
+
+    static constexpr int blockEntries = blockSize*blockSize;
+
+public:
+    enum class Type { Jacobi, Ilu0 };
+
+    OffloadPreconditioner(Type type)
+        : type_(type)
+    {}
+
+    /*!
+     * \brief Compute the preconditioner for the current values of a matrix.
+     *
+     * \param A The matrix. The host copy of its values must be valid.
+     * \param structureChanged Specifies whether the sparsity pattern of the matrix has
+     *                         changed since the last call.
+     */
+    void update(const Matrix& A, bool structureChanged)
+    {
+        if (type_ == Type::Jacobi)
+            updateJacobi_(A);
+        else
+            updateIlu0_(A, structureChanged);
+    }
+
+    /*!
+     * \brief Compute v = M^-1 d on the device.
+     */
+    void apply(const Matrix& A, const OffloadArray<Scalar>& d, OffloadArray<Scalar>& v) const
+    {
+        if (type_ == Type::Jacobi)
+            applyJacobi_(A, d, v);
+        else
+            applyIlu0_(A, d, v);
+    }
+
+private:
+    static Block loadBlock_(const Scalar* src)
+    {
+        Block result;
+        for (int i = 0; i < blockSize; ++i)
+            for (int j = 0; j < blockSize; ++j)
+                result[i][j] = src[i*blockSize + j];
+        return result;
+    }
+
+    static void storeBlock_(const Block& block, Scalar* dest)
+    {
+        for (int i = 0; i < blockSize; ++i)
+            for (int j = 0; j < blockSize; ++j)
+                dest[i*blockSize + j] = block[i][j];
+    }
+
+    void updateJacobi_(const Matrix& A)
+    {
+        size_t n = A.numRows();
+        values_.resize(n*blockEntries);
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const Scalar* diag = A.values().data() + A.diagIndices()[rowIdx]*blockEntries;
+            Block block = loadBlock_(diag);
+            block.invert();
+            storeBlock_(block, values_.data() + rowIdx*blockEntries);
+        }
+        values_.upload();
+    }
+
+    void applyJacobi_(const Matrix& A, const OffloadArray<Scalar>& d, OffloadArray<Scalar>& v) const
+    {
+        const Scalar* invDiag = values_.data();
+        const Scalar* dv = d.data();
+        Scalar* vv = v.data();
+        size_t n = A.numRows();
+
+        EWOMS_OFFLOAD_PRAGMA(omp target teams distribute parallel for)
+        for (size_t rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const Scalar* block = invDiag + rowIdx*blockEntries;
+            for (int i = 0; i < blockSize; ++i) {
+                Scalar tmp = 0.0;
+                for (int j = 0; j < blockSize; ++j)
+                    tmp += block[i*blockSize + j]*dv[rowIdx*blockSize + j];
+                vv[rowIdx*blockSize + i] = tmp;
+            }
+        }
+    }
+
+    void updateIlu0_(const Matrix& A, bool structureChanged)
+    {
+        size_t n = A.numRows();
+        const auto& rowStart = A.rowStart();
+        const auto& colIndices = A.colIndices();
+        const auto& diagIndices = A.diagIndices();
+
+        if (structureChanged || values_.size() != A.values().size())
+            computeLevels_(A);
+
+        // the factorization overwrites a copy of the matrix. the lower triangle stores
+        // L_ik = A_ik (A_kk)^-1 and the diagonal stores the inverse diagonal blocks of U
+        values_.resize(A.values().size());
+        std::copy(A.values().data(), A.values().data() + A.values().size(), values_.data());
+        Scalar* factor = values_.data();
+
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t ikIdx = rowStart[i]; ikIdx < diagIndices[i]; ++ikIdx) {
+                size_t k = colIndices[ikIdx];
+
+                Block Lik = loadBlock_(factor + ikIdx*blockEntries);
+                Lik.rightmultiply(loadBlock_(factor + diagIndices[k]*blockEntries));
+                storeBlock_(Lik, factor + ikIdx*blockEntries);
+
+                // A_ij -= L_ik A_kj for all j > k which exist in both rows
+                size_t ijIdx = ikIdx + 1;
+                for (size_t kjIdx = diagIndices[k] + 1; kjIdx < rowStart[k + 1]; ++kjIdx) {
+                    size_t j = colIndices[kjIdx];
+                    while (ijIdx < rowStart[i + 1] && colIndices[ijIdx] < j)
+                        ++ijIdx;
+                    if (ijIdx == rowStart[i + 1])
+                        break;
+                    if (colIndices[ijIdx] != j)
+                        continue;
+
+                    Block tmp(Lik);
+                    tmp.rightmultiply(loadBlock_(factor + kjIdx*blockEntries));
+                    Block Aij = loadBlock_(factor + ijIdx*blockEntries);
+                    Aij -= tmp;
+                    storeBlock_(Aij, factor + ijIdx*blockEntries);
+                }
+            }
+
+            Block Dii = loadBlock_(factor + diagIndices[i]*blockEntries);
+            Dii.invert();
+            storeBlock_(Dii, factor + diagIndices[i]*blockEntries);
+        }
+
+        values_.upload();
+    }
+
+    // group the rows into levels such that each row of the lower (upper) triangle only
+    // depends on rows of previous levels
+    void computeLevels_(const Matrix& A)
+    {
+        size_t n = A.numRows();
+        const auto& rowStart = A.rowStart();
+        const auto& colIndices = A.colIndices();
+        const auto& diagIndices = A.diagIndices();
+
+        std::vector<size_t> rowLevel(n);
+        auto groupRows = [n, &rowLevel](OffloadArray<size_t>& levelRows,
+                                        std::vector<size_t>& levelStart)
+        {
+            size_t numLevels = 0;
+            for (size_t i = 0; i < n; ++i)
+                numLevels = std::max(numLevels, rowLevel[i] + 1);
+
+            levelStart.assign(numLevels + 1, 0);
+            for (size_t i = 0; i < n; ++i)
+                ++levelStart[rowLevel[i] + 1];
+            for (size_t levelIdx = 0; levelIdx < numLevels; ++levelIdx)
+                levelStart[levelIdx + 1] += levelStart[levelIdx];
+
+            std::vector<size_t> fill(levelStart.begin(), levelStart.end() - 1);
+            levelRows.resize(n);
+            for (size_t i = 0; i < n; ++i)
+                levelRows[fill[rowLevel[i]]++] = i;
+            levelRows.upload();
+        };
+
+        for (size_t i = 0; i < n; ++i) {
+            rowLevel[i] = 0;
+            for (size_t nzIdx = rowStart[i]; nzIdx < diagIndices[i]; ++nzIdx)
+                rowLevel[i] = std::max(rowLevel[i], rowLevel[colIndices[nzIdx]] + 1);
+        }
+        groupRows(lowerLevelRows_, lowerLevelStart_);
+
+        for (size_t i = n; i-- > 0; ) {
+            rowLevel[i] = 0;
+            for (size_t nzIdx = diagIndices[i] + 1; nzIdx < rowStart[i + 1]; ++nzIdx)
+                rowLevel[i] = std::max(rowLevel[i], rowLevel[colIndices[nzIdx]] + 1);
+        }
+        groupRows(upperLevelRows_, upperLevelStart_);
+    }
+
+    void applyIlu0_(const Matrix& A, const OffloadArray<Scalar>& d, OffloadArray<Scalar>& v) const
+    {
+        const size_t* rowStart = A.rowStart().data();
+        const size_t* colIndices = A.colIndices().data();
+        const size_t* diagIndices = A.diagIndices().data();
+        const Scalar* factor = values_.data();
+        const Scalar* dv = d.data();
+        Scalar* vv = v.data();
+
+        // forward substitution, v = L^-1 d
+        const size_t* lowerRows = lowerLevelRows_.data();
+        for (size_t levelIdx = 0; levelIdx + 1 < lowerLevelStart_.size(); ++levelIdx) {
+            size_t levelBegin = lowerLevelStart_[levelIdx];
+            size_t levelEnd = lowerLevelStart_[levelIdx + 1];
+
+            EWOMS_OFFLOAD_PRAGMA(omp target teams distribute parallel for)
+            for (size_t idx = levelBegin; idx < levelEnd; ++idx) {
+                size_t rowIdx = lowerRows[idx];
+                Scalar tmp[blockSize];
+                for (int i = 0; i < blockSize; ++i)
+                    tmp[i] = dv[rowIdx*blockSize + i];
+
+                for (size_t nzIdx = rowStart[rowIdx]; nzIdx < diagIndices[rowIdx]; ++nzIdx) {
+                    const Scalar* block = factor + nzIdx*blockEntries;
+                    const Scalar* vb = vv + colIndices[nzIdx]*blockSize;
+                    for (int i = 0; i < blockSize; ++i)
+                        for (int j = 0; j < blockSize; ++j)
+                            tmp[i] -= block[i*blockSize + j]*vb[j];
+                }
+
+                for (int i = 0; i < blockSize; ++i)
+                    vv[rowIdx*blockSize + i] = tmp[i];
+            }
+        }
+
+        // backward substitution, v = U^-1 v
+        const size_t* upperRows = upperLevelRows_.data();
+        for (size_t levelIdx = 0; levelIdx + 1 < upperLevelStart_.size(); ++levelIdx) {
+            size_t levelBegin = upperLevelStart_[levelIdx];
+            size_t levelEnd = upperLevelStart_[levelIdx + 1];
+
+            EWOMS_OFFLOAD_PRAGMA(omp target teams distribute parallel for)
+            for (size_t idx = levelBegin; idx < levelEnd; ++idx) {
+                size_t rowIdx = upperRows[idx];
+                Scalar tmp[blockSize];
+                for (int i = 0; i < blockSize; ++i)
+                    tmp[i] = vv[rowIdx*blockSize + i];
+
+                for (size_t nzIdx = diagIndices[rowIdx] + 1; nzIdx < rowStart[rowIdx + 1]; ++nzIdx) {
+                    const Scalar* block = factor + nzIdx*blockEntries;
+                    const Scalar* vb = vv + colIndices[nzIdx]*blockSize;
+                    for (int i = 0; i < blockSize; ++i)
+                        for (int j = 0; j < blockSize; ++j)
+                            tmp[i] -= block[i*blockSize + j]*vb[j];
+                }
+
+                const Scalar* invDiag = factor + diagIndices[rowIdx]*blockEntries;
+                for (int i = 0; i < blockSize; ++i) {
+                    Scalar result = 0.0;
+                    for (int j = 0; j < blockSize; ++j)
+                        result += invDiag[i*blockSize + j]*tmp[j];
+                    vv[rowIdx*blockSize + i] = result;
+                }
+            }
+        }
+    }
+
+    Type type_;
+    OffloadArray<Scalar> values_;
+
+    OffloadArray<size_t> lowerLevelRows_;
+    std::vector<size_t> lowerLevelStart_;
+    OffloadArray<size_t> upperLevelRows_;
+    std::vector<size_t> upperLevelStart_;
+};
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A preconditioned BiCGStab solver whose iterations run entirely on an
+ *        offloading device.
+ *
+ * Only the right hand side and the solution are transferred between the host and the
+ * device for each solve; all vectors of the iteration reside on the device. The
+ * iteration stops as soon as the Euclidean norm of the residual has been reduced by
+ * the tolerance relative to the one of the right hand side.
+ */
+template <class Scalar, int blockSize>
+class OffloadBiCGStabSolver
+{
+    using Matrix = OffloadBlockCsrMatrix<Scalar, blockSize>;
+    using Preconditioner = OffloadPreconditioner<Scalar, blockSize>;
+    using Array = OffloadArray<Scalar>;
+
+public:
+    OffloadBiCGStabSolver()
+        : iterations_(0)
+    {}
+
+    /*!
+     * \brief Solve A x = b.
+     *
+     * \param A The matrix of the linear system of equations
+     * \param M The preconditioner
+     * \param x The host vector which receives the solution
+     * \param b The host vector of the right hand side
+     * \param tolerance The reduction of the residual which ought to be achieved
+     * \param maxIterations The maximum number of iterations
+     *
+     * \return true if the iteration converged
+     */
+    template <class Vector>
+    bool solve(const Matrix& A,
+               const Preconditioner& M,
+               Vector& x,
+               const Vector& b,
+               Scalar tolerance,
+               int maxIterations)
+    {
+        size_t n = A.numRows()*blockSize;
+        for (Array* v : { &x_, &b_, &r_, &r0_, &p_, &v_, &s_, &t_, &y_, &z_ })
+            v->resize(n);
+
+        for (size_t blockIdx = 0; blockIdx < b.size(); ++blockIdx)
+            for (int i = 0; i < blockSize; ++i)
+                b_[blockIdx*blockSize + i] = static_cast<Scalar>(b[blockIdx][i]);
+        b_.upload();
+
+        // the initial guess is zero, i.e., r = r0 = b
+        fill_(x_, 0.0);
+        fill_(p_, 0.0);
+        fill_(v_, 0.0);
+        axpby_(r_, 1.0, b_, 0.0, b_);
+        axpby_(r0_, 1.0, b_, 0.0, b_);
+
+        iterations_ = 0;
+        Scalar bNorm = std::sqrt(dot_(b_, b_));
+        bool converged = (bNorm == 0.0);
+        Scalar threshold = tolerance*bNorm;
+
+        Scalar rho = 1.0;
+        Scalar alpha = 1.0;
+        Scalar omega = 1.0;
+        while (!converged && iterations_ < maxIterations) {
+            ++iterations_;
+
+            Scalar rhoNew = dot_(r0_, r_);
+            if (rhoNew == 0.0 || !std::isfinite(rhoNew))
+                break;
+
+            // p = r + beta (p - omega v)
+            Scalar beta = (rhoNew/rho)*(alpha/omega);
+            updateSearchDirection_(p_, r_, v_, beta, omega);
+
+            M.apply(A, p_, y_);
+            A.mv(y_, v_);
+
+            Scalar r0v = dot_(r0_, v_);
+            if (r0v == 0.0 || !std::isfinite(r0v))
+                break;
+            alpha = rhoNew/r0v;
+
+            // s = r - alpha v
+            axpby_(s_, 1.0, r_, -alpha, v_);
+            if (std::sqrt(dot_(s_, s_)) <= threshold) {
+                axpy_(x_, alpha, y_);
+                converged = true;
+                break;
+            }
+
+            M.apply(A, s_, z_);
+            A.mv(z_, t_);
+
+            Scalar tt = dot_(t_, t_);
+            omega = (tt > 0.0) ? dot_(t_, s_)/tt : 0.0;
+            if (omega == 0.0 || !std::isfinite(omega))
+                break;
+
+            // x += alpha y + omega z, r = s - omega t
+            axpy_(x_, alpha, y_);
+            axpy_(x_, omega, z_);
+            axpby_(r_, 1.0, s_, -omega, t_);
+
+            converged = std::sqrt(dot_(r_, r_)) <= threshold;
+            rho = rhoNew;
+        }
+
+        x_.download();
+        bool finite = true;
+        for (size_t blockIdx = 0; blockIdx < x.size(); ++blockIdx) {
+            for (int i = 0; i < blockSize; ++i) {
+                Scalar value = x_[blockIdx*blockSize + i];
+                finite = finite && std::isfinite(value);
+                x[blockIdx][i] = value;
+            }
+        }
+
+        return converged && finite;
+    }
+
+    /*!
+     * \brief The number of iterations of the last solve.
+     */
+    int iterations() const
+    { return iterations_; }
+
+private:
+    static void fill_(Array& a, Scalar value)
+    {
+        Scalar* av = a.data();
+        size_t n = a.size();
+        EWOMS_OFFLOAD_PRAGMA(omp target teams distribute parallel for)
+        for (size_t i = 0; i < n; ++i)
+            av[i] = value;
+    }
+
+    // y += alpha x
+    static void axpy_(Array& y, Scalar alpha, const Array& x)
+    {
+        Scalar* yv = y.data();
+        const Scalar* xv = x.data();
+        size_t n = y.size();
+        EWOMS_OFFLOAD_PRAGMA(omp target teams distribute parallel for)
+        for (size_t i = 0; i < n; ++i)
+            yv[i] += alpha*xv[i];
+    }
+
+    // z = alpha x + beta y
+    static void axpby_(Array& z, Scalar alpha, const Array& x, Scalar beta, const Array& y)
+    {
+        Scalar* zv = z.data();
+        const Scalar* xv = x.data();
+        const Scalar* yv = y.data();
+        size_t n = z.size();
+        EWOMS_OFFLOAD_PRAGMA(omp target teams distribute parallel for)
+        for (size_t i = 0; i < n; ++i)
+            zv[i] = alpha*xv[i] + beta*yv[i];
+    }
+
+    // p = r + beta (p - omega v)
+    static void updateSearchDirection_(Array& p, const Array& r, const Array& v, Scalar beta, Scalar omega)
+    {
+        Scalar* pv = p.data();
+        const Scalar* rv = r.data();
+        const Scalar* vv = v.data();
+        size_t n = p.size();
+        EWOMS_OFFLOAD_PRAGMA(omp target teams distribute parallel for)
+        for (size_t i = 0; i < n; ++i)
+            pv[i] = rv[i] + beta*(pv[i] - omega*vv[i]);
+    }
+
+    static Scalar dot_(const Array& a, const Array& b)
+    {
+        const Scalar* av = a.data();
+        const Scalar* bv = b.data();
+        size_t n = a.size();
+        Scalar sum = 0.0;
+        EWOMS_OFFLOAD_PRAGMA(omp target teams distribute parallel for reduction(+:sum) map(tofrom:sum))
+        for (size_t i = 0; i < n; ++i)
+            sum += av[i]*bv[i];
+        return sum;
+    }
+
+    int iterations_;
+
+    Array x_;
+    Array b_;
+    Array r_;
+    Array r0_;
+    Array p_;
+    Array v_;
+    Array s_;
+    Array t_;
+    Array y_;
+    Array z_;
+};
+
+/*!
+ * \ingroup Linear
+ * \brief A linear solver backend which runs a preconditioned BiCGStab solver on an
+ *        offloading device, e.g., a GPU.
+ *
+ * The block matrix of the linearized system is mirrored on the device in block
+ * compressed row storage. Its structure is only transferred if the sparsity pattern
+ * changes, otherwise only the values of the blocks are copied for each new matrix.
+ * The preconditioner is either block Jacobi or block ILU(0), which is selected using
+ * the OffloadPreconditioner parameter.
+ *
+ * Offloading uses OpenMP target directives, so the compiler must be configured for the
+ * device (e.g., using -fopenmp -foffload=nvptx-none for GCC). Otherwise, the solver is
+ * executed on the host. This backend is only able to solve sequential problems.
+ */
+template <class TypeTag>
+class OffloadBackend
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using Vector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using Matrix = typename SparseMatrixAdapter::IstlMatrix;
+
+    static constexpr int blockSize = MatrixBlock::rows;
+
+    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
+                  "The offloading linear solver backend requires the IstlSparseMatrixAdapter");
+
+    using Preconditioner = OffloadPreconditioner<Scalar, blockSize>;
+
+public:
+    OffloadBackend(Simulator& simulator)
+        : preconditioner_(preconditionerType_())
+        , matrix_(nullptr)
+        , matrixChanged_(false)
+    {
+        if (simulator.gridView().comm().size() > 1)
+            throw std::logic_error("The offloading linear solver backend can only be used "
+                                   "for sequential simulations");
+
+        tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
+        maxIterations_ = EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations);
+        verbosity_ = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+    }
+
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, LinearSolverTolerance,
+                             "The maximum allowed error between of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverMaxIterations,
+                             "The maximum number of iterations of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverVerbosity,
+                             "The verbosity level of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, OffloadPreconditioner,
+                             "The preconditioner of the offloaded linear solver. Possible "
+                             "values: 'ilu0' and 'jacobi'");
+    }
+
+    /*!
+     * \brief Causes the solve() method to discard the structure of the linear system of
+     *        equations the next time it is called.
+     */
+    void eraseMatrix()
+    { structureValid_ = false; }
+
+    /*!
+     * \brief Set the reduction of the residual which the linear solver needs to achieve.
+     */
+    void setTolerance(Scalar tolerance)
+    { tolerance_ = tolerance; }
+
+    /*!
+     * \brief Return the reduction of the residual which the linear solver achieves.
+     */
+    Scalar tolerance() const
+    { return tolerance_; }
+
+    void prepare(const SparseMatrixAdapter& M OPM_UNUSED, const Vector& b OPM_UNUSED)
+    { }
+
+    /*!
+     * \brief Record the memory held by the linear solver with the MemoryAccounting.
+     *
+     * The linear system is stored in the memory of the device, which is not accounted
+     * for.
+     */
+    void recordMemoryUsage() const
+    { }
+
+    void setResidual(const Vector& b)
+    { b_ = &b; }
+
+    void getResidual(Vector& b) const
+    { b = *b_; }
+
+    /*!
+     * \brief Sets the values of the residual's Jacobian matrix.
+     *
+     * The matrix is transferred to the device by the next call of solve(). If this is
+     * not called between two solves, the matrix and preconditioner of the previous one
+     * are reused.
+     */
+    void setMatrix(const SparseMatrixAdapter& M)
+    {
+        matrix_ = &M.istlMatrix();
+        matrixChanged_ = true;
+    }
+
+    bool solve(Vector& x)
+    {
+        if (matrixChanged_) {
+            bool structureChanged = !structureValid_ || !deviceMatrix_.patternMatches(*matrix_);
+            if (structureChanged) {
+                deviceMatrix_.createStructure(*matrix_);
+                structureValid_ = true;
+            }
+            deviceMatrix_.assignValues(*matrix_);
+            if (structureChanged || deviceMatrix_.numTransferredRows() > 0)
+                preconditioner_.update(deviceMatrix_, structureChanged);
+            matrixChanged_ = false;
+        }
+
+        bool converged = solver_.solve(deviceMatrix_, preconditioner_, x, *b_, tolerance_, maxIterations_);
+        if (verbosity_ > 0)
+            std::cout << "Offloaded BiCGStab: " << deviceMatrix_.numTransferredRows()
+                      << " matrix rows transferred, " << solver_.iterations() << " iterations, "
+                      << (converged ? "converged" : "not converged") << "\n" << std::flush;
+
+        return converged;
+    }
+
+private:
+    static typename Preconditioner::Type preconditionerType_()
+    {
+        const std::string& name = EWOMS_GET_PARAM(TypeTag, std::string, OffloadPreconditioner);
+        if (name == "ilu0")
+            return Preconditioner::Type::Ilu0;
+        else if (name == "jacobi")
+            return Preconditioner::Type::Jacobi;
+
+        throw std::invalid_argument("Unknown preconditioner for the offloaded linear solver: '"
+                                    + name + "'");
+    }
+
+    OffloadBlockCsrMatrix<Scalar, blockSize> deviceMatrix_;
+    Preconditioner preconditioner_;
+    OffloadBiCGStabSolver<Scalar, blockSize> solver_;
+    bool structureValid_ = false;
+
+    const Matrix* matrix_;
+    const Vector* b_;
+    bool matrixChanged_;
+
+    Scalar tolerance_;
+    int maxIterations_;
+    int verbosity_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+namespace Opm::Properties {
+
+template<class TypeTag>
+struct SparseMatrixAdapter<TypeTag, TTag::OffloadLinearSolver>
+{
+private:
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    using Block = Opm::MatrixBlock<Scalar, numEq, numEq>;
+
+public:
+    using type = typename Opm::Linear::IstlSparseMatrixAdapter<Block>;
+};
+
+template<class TypeTag>
+struct LinearSolverVerbosity<TypeTag, TTag::OffloadLinearSolver> { static constexpr int value = 0; };
+template<class TypeTag>
+struct LinearSolverMaxIterations<TypeTag, TTag::OffloadLinearSolver> { static constexpr int value = 1000; };
+template<class TypeTag>
+struct OffloadPreconditioner<TypeTag, TTag::OffloadLinearSolver> { static constexpr auto value = "ilu0"; };
+template<class TypeTag>
+struct LinearSolverBackend<TypeTag, TTag::OffloadLinearSolver> { using type = Opm::Linear::OffloadBackend<TypeTag>; };
+
+} // namespace Opm::Properties
+
+#undef EWOMS_OFFLOAD_PRAGMA
+
+#endif
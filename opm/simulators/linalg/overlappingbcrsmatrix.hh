@@ -31,6 +31,7 @@
 #include <opm/simulators/linalg/globalindices.hh>
 #include <opm/simulators/linalg/blacklist.hh>
 #include <opm/models/parallel/mpibuffer.hh>
+#include <opm/models/utils/instrumentation.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -49,6 +50,9 @@ namespace Linear {
 
 /*!
  * \brief An overlap aware block-compressed row storage (BCRS) matrix.
+ *
+ * The entries of the overlap are sent directly from the storage of the matrix using
+ * indexed MPI data types, i.e., they are not packed into send buffers.
  */
 template <class BCRSMatrix>
 class OverlappingBCRSMatrix : public BCRSMatrix
@@ -78,7 +82,10 @@ public:
                           const BlackList& blackList,
                           unsigned overlapSize)
     {
-        overlap_ = std::make_shared<Overlap>(nativeMatrix, borderList, blackList, overlapSize);
+        {
+            Instrumentation::Region region(Instrumentation::overlapSetupRegion);
+            overlap_ = std::make_shared<Overlap>(nativeMatrix, borderList, blackList, overlapSize);
+        }
         myRank_ = 0;
 #if HAVE_MPI
         MPI_Comm_rank(MPI_COMM_WORLD, &myRank_);
@@ -87,6 +94,8 @@ public:
         // build the overlapping matrix from the non-overlapping
         // matrix and the overlap
         build_(nativeMatrix);
+
+        nativeStructure_ = overlap_->hasNativeLayout() && hasSameStructure_(nativeMatrix);
     }
 
     // this constructor is required to make the class compatible with the SeqILU class of
@@ -220,6 +229,13 @@ public:
     template <class NativeBCRSMatrix>
     void assignFromNative(const NativeBCRSMatrix& nativeMatrix)
     {
+        // if the matrix exhibits the same rows and columns as the native one, which is
+        // usually the case for sequential runs, the entries can be copied in order
+        if (nativeStructure_ && nativeMatrix.N() == this->N()) {
+            copyFromNative_(nativeMatrix);
+            return;
+        }
+
         // first, set everything to 0,
         BCRSMatrix::operator=(0.0);
 
@@ -264,17 +280,22 @@ public:
     // communicates and adds up the contents of overlapping rows
     void syncAdd()
     {
-        // first, send all entries to the peers
+        // first, start receiving the entries from the peers
         const PeerSet& peerSet = overlap_->peerSet();
         typename PeerSet::const_iterator peerIt = peerSet.begin();
         typename PeerSet::const_iterator peerEndIt = peerSet.end();
+        for (; peerIt != peerEndIt; ++peerIt)
+            entryValuesRecvBuff_[*peerIt]->start();
+
+        // then, send all entries to the peers
+        peerIt = peerSet.begin();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
 
             sendEntries_(peerRank);
         }
 
-        // then, receive entries from the peers
+        // next, wait for the entries of the peers
         peerIt = peerSet.begin();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
@@ -295,17 +316,22 @@ public:
     // the master
     void syncCopy()
     {
-        // first, send all entries to the peers
+        // first, start receiving the entries from the peers
         const PeerSet& peerSet = overlap_->peerSet();
         typename PeerSet::const_iterator peerIt = peerSet.begin();
         typename PeerSet::const_iterator peerEndIt = peerSet.end();
+        for (; peerIt != peerEndIt; ++peerIt)
+            entryValuesRecvBuff_[*peerIt]->start();
+
+        // then, send all entries to the peers
+        peerIt = peerSet.begin();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
 
             sendEntries_(peerRank);
         }
 
-        // then, receive entries from the peers
+        // next, wait for the entries of the peers
         peerIt = peerSet.begin();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
@@ -323,6 +349,53 @@ public:
     }
 
 private:
+    template <class NativeBCRSMatrix>
+    bool hasSameStructure_(const NativeBCRSMatrix& nativeMatrix) const
+    {
+        if (nativeMatrix.N() != this->N() || nativeMatrix.nonzeroes() != this->nonzeroes())
+            return false;
+
+        for (unsigned rowIdx = 0; rowIdx < nativeMatrix.N(); ++rowIdx) {
+            const auto& nativeRow = nativeMatrix[rowIdx];
+            const auto& row = (*this)[rowIdx];
+            if (nativeRow.size() != row.size())
+                return false;
+
+            auto colIt = row.begin();
+            auto nativeColIt = nativeRow.begin();
+            const auto& nativeColEndIt = nativeRow.end();
+            for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++colIt)
+                if (nativeColIt.index() != colIt.index())
+                    return false;
+        }
+
+        return true;
+    }
+
+    // copies the entries of a native matrix with the same structure
+    template <class NativeBCRSMatrix>
+    void copyFromNative_(const NativeBCRSMatrix& nativeMatrix)
+    {
+        int numRows = static_cast<int>(nativeMatrix.N());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const auto& nativeRow = nativeMatrix[static_cast<unsigned>(rowIdx)];
+            auto colIt = (*this)[static_cast<unsigned>(rowIdx)].begin();
+            auto nativeColIt = nativeRow.begin();
+            const auto& nativeColEndIt = nativeRow.end();
+            for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++colIt) {
+                // see assignFromNative() for why the blocks are not simply assigned
+                const auto& src = *nativeColIt;
+                auto& dest = *colIt;
+                for (unsigned i = 0; i < src.rows; ++i)
+                    for (unsigned j = 0; j < src.cols; ++j)
+                        dest[i][j] = static_cast<field_type>(src[i][j]);
+            }
+        }
+    }
+
     template <class NativeBCRSMatrix>
     void build_(const NativeBCRSMatrix& nativeMatrix)
     {
@@ -524,9 +597,11 @@ private:
         rowIndicesSendBuff_[peerRank]->send(peerRank);
         entryColIndicesSendBuff_[peerRank]->send(peerRank);
 
-        // create the send buffers for the values of the matrix
-        // entries
-        entryValuesSendBuff_[peerRank] = new MpiBuffer<block_type>(numEntries);
+        // the values of the matrix entries are sent directly from the storage of the
+        // matrix, so no send buffer is required. since the storage only exists once
+        // the structure of the matrix is complete, the persistent request is created by
+        // the first call to sendEntries_()
+        entryValuesSendBuff_[peerRank] = new MpiBuffer<block_type>();
 #endif // HAVE_MPI
     }
 
@@ -557,6 +632,7 @@ private:
         // create the buffer to store the column indices of the matrix entries
         entryColIndicesRecvBuff_[peerRank] = new MpiBuffer<Index>(totalIndices);
         entryValuesRecvBuff_[peerRank] = new MpiBuffer<block_type>(totalIndices);
+        entryValuesRecvBuff_[peerRank]->initPersistentReceive(peerRank);
 
         // communicate with the peer
         entryColIndicesRecvBuff_[peerRank]->receive(peerRank);
@@ -584,27 +660,33 @@ private:
 #if HAVE_MPI
         auto &mpiSendBuff = *entryValuesSendBuff_[peerRank];
 
-        auto &mpiRowIndicesSendBuff = *rowIndicesSendBuff_[peerRank];
-        auto &mpiRowSizesSendBuff = *rowSizesSendBuff_[peerRank];
-        auto &mpiColIndicesSendBuff = *entryColIndicesSendBuff_[peerRank];
-
-        // fill the send buffer
-        unsigned k = 0;
-        for (unsigned i = 0; i < mpiRowIndicesSendBuff.size(); ++i) {
-            Index domRowIdx = mpiRowIndicesSendBuff[i];
-
-            for (Index j = 0; j < static_cast<Index>(mpiRowSizesSendBuff[i]); ++j)
-            {
-                // move to the next column which is in the overlap
-                Index domColIdx = mpiColIndicesSendBuff[k];
-
-                // add the values of this column to the send buffer
-                mpiSendBuff[k] = (*this)[static_cast<unsigned>(domRowIdx)][static_cast<unsigned>(domColIdx)];
-                ++k;
+        // the blocks of the matrix do not move once its structure is complete, so the
+        // data type which selects the entries for the peer only needs to be created once
+        if (entryValuesSendType_.count(peerRank) == 0) {
+            auto &mpiRowIndicesSendBuff = *rowIndicesSendBuff_[peerRank];
+            auto &mpiRowSizesSendBuff = *rowSizesSendBuff_[peerRank];
+            auto &mpiColIndicesSendBuff = *entryColIndicesSendBuff_[peerRank];
+
+            std::vector<const block_type*> blocks;
+            blocks.reserve(mpiColIndicesSendBuff.size());
+            unsigned k = 0;
+            for (unsigned i = 0; i < mpiRowIndicesSendBuff.size(); ++i) {
+                Index domRowIdx = mpiRowIndicesSendBuff[i];
+
+                for (Index j = 0; j < static_cast<Index>(mpiRowSizesSendBuff[i]); ++j) {
+                    Index domColIdx = mpiColIndicesSendBuff[k];
+                    blocks.push_back(&(*this)[static_cast<unsigned>(domRowIdx)][static_cast<unsigned>(domColIdx)]);
+                    ++k;
+                }
             }
+
+            const block_type* base = blocks.empty() ? nullptr : blocks[0];
+            entryValuesSendType_[peerRank] =
+                std::make_unique<MpiIndexedType<block_type> >(base, blocks);
+            mpiSendBuff.initPersistentSend(base, *entryValuesSendType_[peerRank], peerRank);
         }
 
-        mpiSendBuff.send(peerRank);
+        mpiSendBuff.start();
 #endif // HAVE_MPI
     }
 
@@ -617,7 +699,7 @@ private:
         auto &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         auto &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
+        mpiRecvBuff.wait();
 
         // retrieve the values from the receive buffer
         unsigned k = 0;
@@ -645,7 +727,7 @@ private:
         MpiBuffer<unsigned> &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         MpiBuffer<Index> &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
+        mpiRecvBuff.wait();
 
         // retrieve the values from the receive buffer
         unsigned k = 0;
@@ -673,12 +755,14 @@ private:
     int myRank_;
     Entries entries_;
     std::shared_ptr<Overlap> overlap_;
+    bool nativeStructure_ = false;
 
     std::map<ProcessRank, MpiBuffer<unsigned> *> numRowsSendBuff_;
     std::map<ProcessRank, MpiBuffer<unsigned> *> rowSizesSendBuff_;
     std::map<ProcessRank, MpiBuffer<Index> *> rowIndicesSendBuff_;
     std::map<ProcessRank, MpiBuffer<Index> *> entryColIndicesSendBuff_;
     std::map<ProcessRank, MpiBuffer<block_type> *> entryValuesSendBuff_;
+    std::map<ProcessRank, std::unique_ptr<MpiIndexedType<block_type> > > entryValuesSendType_;
 
     std::map<ProcessRank, MpiBuffer<unsigned> > numRowsRecvBuff_;
     std::map<ProcessRank, MpiBuffer<unsigned> *> rowSizesRecvBuff_;
@@ -38,12 +38,24 @@
 #include <memory>
 #include <map>
 #include <iostream>
+#include <vector>
 
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware block vector.
+ *
+ * For synchronizations which copy the values from the master processes, only the
+ * entries which a peer is master of are sent to the current process, i.e., the
+ * preconditioner is applied as a restricted additive Schwarz method and most of the
+ * foreign overlap is not transferred. Only the additive synchronizations exchange all
+ * entries of the overlap.
+ *
+ * The entries are sent directly from the storage of the vector using indexed MPI data
+ * types which are created once per overlap (see MpiIndexedType), i.e., they are not
+ * packed into send buffers. The same applies to the entries which are received from
+ * their master process.
  */
 template <class FieldVector, class Overlap>
 class OverlappingBlockVector : public Dune::BlockVector<FieldVector>
@@ -57,7 +69,7 @@ public:
      *        block vector coherent to it.
      */
     OverlappingBlockVector(const Overlap& overlap)
-        : ParentType(overlap.numDomestic()), overlap_(&overlap)
+        : ParentType(overlap.numDomestic()), boundData_(nullptr), overlap_(&overlap)
     { createBuffers_(); }
 
     /*!
@@ -68,8 +80,11 @@ public:
         , numIndicesSendBuff_(obv.numIndicesSendBuff_)
         , indicesSendBuff_(obv.indicesSendBuff_)
         , indicesRecvBuff_(obv.indicesRecvBuff_)
-        , valuesSendBuff_(obv.valuesSendBuff_)
         , valuesRecvBuff_(obv.valuesRecvBuff_)
+        , sendType_(obv.sendType_)
+        , masterSendType_(obv.masterSendType_)
+        , masterRecvType_(obv.masterRecvType_)
+        , boundData_(nullptr)
         , overlap_(obv.overlap_)
     {}
 
@@ -77,6 +92,7 @@ public:
      * \brief Default constructor.
      */
     OverlappingBlockVector()
+        : boundData_(nullptr)
     {}
 
     //! \cond SKIP
@@ -92,11 +108,19 @@ public:
     OverlappingBlockVector& operator=(const OverlappingBlockVector& obv)
     {
         ParentType::operator=(obv);
+
+        // the requests of this vector only stay valid if the communication pattern
+        // remains the same
+        if (overlap_ != obv.overlap_)
+            boundData_ = nullptr;
+
         numIndicesSendBuff_ = obv.numIndicesSendBuff_;
         indicesSendBuff_ = obv.indicesSendBuff_;
         indicesRecvBuff_ = obv.indicesRecvBuff_;
-        valuesSendBuff_ = obv.valuesSendBuff_;
         valuesRecvBuff_ = obv.valuesRecvBuff_;
+        sendType_ = obv.sendType_;
+        masterSendType_ = obv.masterSendType_;
+        masterRecvType_ = obv.masterRecvType_;
         overlap_ = obv.overlap_;
         return *this;
     }
@@ -110,6 +134,13 @@ public:
     {
         size_t numDomestic = overlap_->numDomestic();
 
+        // without peers, the entries neither need to be translated nor added up
+        if (overlap_->hasNativeLayout()) {
+            for (unsigned rowIdx = 0; rowIdx < numDomestic; ++rowIdx)
+                (*this)[rowIdx] = nativeBlockVector[rowIdx];
+            return;
+        }
+
         // assign the local rows from the non-overlapping block vector
         for (unsigned domRowIdx = 0; domRowIdx < numDomestic; ++domRowIdx) {
             Index nativeRowIdx = overlap_->domesticToNative(static_cast<Index>(domRowIdx));
@@ -158,6 +189,12 @@ public:
         // assign the local rows
         size_t numNative = overlap_->numNative();
         nativeBlockVector.resize(numNative);
+        if (overlap_->hasNativeLayout()) {
+            for (unsigned rowIdx = 0; rowIdx < numNative; ++rowIdx)
+                nativeBlockVector[rowIdx] = (*this)[rowIdx];
+            return;
+        }
+
         for (unsigned nativeRowIdx = 0; nativeRowIdx < numNative; ++nativeRowIdx) {
             Index domRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
 
@@ -174,16 +211,60 @@ public:
      */
     void sync()
     {
-        // send all entries to all peers
+        startSync();
+        finishSync();
+    }
+
+    /*!
+     * \brief Start to syncronize the values of the block vector from their master
+     *        process.
+     *
+     * This only posts the send and receive operations. The rows which are sent to peer
+     * processes, i.e., the ones in the foreign overlap, must not be modified and the
+     * rows which are received from their master process must not be accessed until
+     * finishSync() was called, but the remaining rows can.
+     */
+    void startSync()
+    {
+        bindRequests_();
+
+        // start receiving the entries which the peers are master of
         for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+            masterRecvRequests_[peerRank]->start();
 
-        // recieve all entries to the peers
+        // send the entries which the peers need from us
+        for (const auto peerRank: overlap_->peerSet())
+            masterSendRequests_[peerRank]->start();
+    }
+
+    /*!
+     * \brief Wait until all messages of a synchronization which was initiated by
+     *        startSync() have been transferred.
+     *
+     * This may be called by a different thread while the rows of the block vector which
+     * are not involved in the communication are modified. finishSync() must be called
+     * afterwards nevertheless.
+     */
+    void waitSync()
+    {
         for (const auto peerRank: overlap_->peerSet())
-            receiveFromMaster_(peerRank);
+            masterRecvRequests_[peerRank]->wait();
+
+        waitSendFinished_(masterSendRequests_);
+    }
+
+    /*!
+     * \brief Complete syncronizing the values of the block vector from their master
+     *        process which was initiated by startSync().
+     */
+    void finishSync()
+    {
+        // the entries which the peers are master of are received in place
+        for (const auto peerRank: overlap_->peerSet())
+            masterRecvRequests_[peerRank]->wait();
 
         // wait until we have send everything
-        waitSendFinished_();
+        waitSendFinished_(masterSendRequests_);
     }
 
     /*!
@@ -192,16 +273,41 @@ public:
      */
     void syncAdd()
     {
+        startSyncAdd();
+        finishSyncAdd();
+    }
+
+    /*!
+     * \brief Start to syncronize the values of the block vector by adding up the
+     *        values of all peer ranks.
+     *
+     * \copydetails startSync()
+     */
+    void startSyncAdd()
+    {
+        bindRequests_();
+
+        // start receiving the entries from all peers
+        for (const auto peerRank: overlap_->peerSet())
+            valuesRecvBuff_[peerRank]->start();
+
         // send all entries to all peers
         for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+            sendRequests_[peerRank]->start();
+    }
 
+    /*!
+     * \brief Complete syncronizing the values of the block vector by adding up the
+     *        values of all peer ranks which was initiated by startSyncAdd().
+     */
+    void finishSyncAdd()
+    {
         // recieve all entries to the peers
         for (const auto peerRank: overlap_->peerSet())
             receiveAdd_(peerRank);
 
         // wait until we have send everything
-        waitSendFinished_();
+        waitSendFinished_(sendRequests_);
     }
 
     void print() const
@@ -228,7 +334,6 @@ private:
             size_t numEntries = overlap_->foreignOverlapSize(peerRank);
             numIndicesSendBuff_[peerRank] = std::make_shared<MpiBuffer<unsigned> >(1);
             indicesSendBuff_[peerRank] = std::make_shared<MpiBuffer<Index> >(numEntries);
-            valuesSendBuff_[peerRank] = std::make_shared<MpiBuffer<FieldVector> >(numEntries);
 
             // fill the indices buffer with global indices
             MpiBuffer<Index>& indicesSendBuff = *indicesSendBuff_[peerRank];
@@ -260,6 +365,7 @@ private:
                 new MpiBuffer<Index>(numRows));
             valuesRecvBuff_[peerRank] = std::shared_ptr<MpiBuffer<FieldVector> >(
                 new MpiBuffer<FieldVector>(numRows));
+            valuesRecvBuff_[peerRank]->initPersistentReceive(peerRank);
             MpiBuffer<Index>& indicesRecvBuff = *indicesRecvBuff_[peerRank];
 
             // next, receive the actual indices
@@ -284,52 +390,101 @@ private:
             // convert the global indices of the send buffer to
             // domestic ones
             MpiBuffer<Index>& indicesSendBuff = *indicesSendBuff_[peerRank];
+            std::vector<Index> indices(indicesSendBuff.size());
             for (unsigned i = 0; i < indicesSendBuff.size(); ++i) {
                 indicesSendBuff[i] = overlap_->globalToDomestic(indicesSendBuff[i]);
+                indices[i] = indicesSendBuff[i];
             }
+
+            // the values are sent directly from the vector
+            sendType_[peerRank] = std::make_shared<MpiIndexedType<FieldVector> >(indices);
         }
+
+        createMasterBuffers_();
 #endif // HAVE_MPI
     }
 
-    void sendEntries_(ProcessRank peerRank)
+    // the synchronizations which copy the values from their master only need the
+    // entries which the sending peer is master of. Since the receiving process decides
+    // which entries are taken, it tells each peer the positions in the list of the
+    // overlap which it needs.
+    void createMasterBuffers_()
     {
-        // copy the values into the send buffer
-        const MpiBuffer<Index>& indices = *indicesSendBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesSendBuff_[peerRank];
-        for (unsigned i = 0; i < indices.size(); ++i)
-            values[i] = (*this)[static_cast<unsigned>(indices[i])];
+#if HAVE_MPI
+        std::map<ProcessRank, std::shared_ptr<MpiBuffer<unsigned> > > numPositionsSendBuff;
+        std::map<ProcessRank, std::shared_ptr<MpiBuffer<unsigned> > > positionsSendBuff;
+        for (const auto peerRank: overlap_->peerSet()) {
+            const MpiBuffer<Index>& indicesRecvBuff = *indicesRecvBuff_[peerRank];
+            std::vector<unsigned> positions;
+            for (unsigned i = 0; i < indicesRecvBuff.size(); ++i)
+                if (overlap_->masterRank(indicesRecvBuff[i]) == peerRank)
+                    positions.push_back(i);
+
+            size_t numPositions = positions.size();
+            std::vector<Index> masterIndices(numPositions);
+            positionsSendBuff[peerRank] = std::make_shared<MpiBuffer<unsigned> >(numPositions);
+            for (unsigned i = 0; i < numPositions; ++i) {
+                masterIndices[i] = indicesRecvBuff[positions[i]];
+                (*positionsSendBuff[peerRank])[i] = positions[i];
+            }
+            masterRecvType_[peerRank] = std::make_shared<MpiIndexedType<FieldVector> >(masterIndices);
 
-        values.send(peerRank);
-    }
+            numPositionsSendBuff[peerRank] = std::make_shared<MpiBuffer<unsigned> >(1);
+            (*numPositionsSendBuff[peerRank])[0] = static_cast<unsigned>(numPositions);
+            numPositionsSendBuff[peerRank]->send(peerRank);
+            positionsSendBuff[peerRank]->send(peerRank);
+        }
 
-    void waitSendFinished_()
-    {
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
+        for (const auto peerRank: overlap_->peerSet()) {
+            MpiBuffer<unsigned> numPositionsRecvBuff(1);
+            numPositionsRecvBuff.receive(peerRank);
+            unsigned numPositions = numPositionsRecvBuff[0];
 
-        // send all entries to all peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            valuesSendBuff_[peerRank]->wait();
+            MpiBuffer<unsigned> positionsRecvBuff(numPositions);
+            positionsRecvBuff.receive(peerRank);
+
+            const MpiBuffer<Index>& indicesSendBuff = *indicesSendBuff_[peerRank];
+            std::vector<Index> masterIndices(numPositions);
+            for (unsigned i = 0; i < numPositions; ++i)
+                masterIndices[i] = indicesSendBuff[positionsRecvBuff[i]];
+            masterSendType_[peerRank] = std::make_shared<MpiIndexedType<FieldVector> >(masterIndices);
         }
+
+        for (const auto peerRank: overlap_->peerSet()) {
+            numPositionsSendBuff[peerRank]->wait();
+            positionsSendBuff[peerRank]->wait();
+        }
+#endif // HAVE_MPI
     }
 
-    void receiveFromMaster_(ProcessRank peerRank)
+    // the persistent requests which communicate the entries in place refer to the
+    // storage of this vector. since the data types are shared with the copies of the
+    // vector, the requests are not, i.e., they are created when the vector is
+    // synchronized for the first time or after its storage has been moved.
+    void bindRequests_()
     {
-        const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
-
-        // copy them into the block vector
-        for (unsigned j = 0; j < indices.size(); ++j) {
-            Index domRowIdx = indices[j];
-            if (overlap_->masterRank(domRowIdx) == peerRank) {
-                (*this)[static_cast<unsigned>(domRowIdx)] = values[j];
-            }
+        if (this->size() == 0)
+            return;
+
+        FieldVector* data = &(*this)[0];
+        if (boundData_ == data)
+            return;
+
+        for (const auto peerRank: overlap_->peerSet()) {
+            sendRequests_[peerRank] = std::make_unique<MpiBuffer<FieldVector> >();
+            sendRequests_[peerRank]->initPersistentSend(data, *sendType_[peerRank], peerRank);
+            masterSendRequests_[peerRank] = std::make_unique<MpiBuffer<FieldVector> >();
+            masterSendRequests_[peerRank]->initPersistentSend(data, *masterSendType_[peerRank], peerRank);
+            masterRecvRequests_[peerRank] = std::make_unique<MpiBuffer<FieldVector> >();
+            masterRecvRequests_[peerRank]->initPersistentReceive(data, *masterRecvType_[peerRank], peerRank);
         }
+        boundData_ = data;
+    }
+
+    void waitSendFinished_(std::map<ProcessRank, std::unique_ptr<MpiBuffer<FieldVector> > >& sendRequests)
+    {
+        for (const auto peerRank: overlap_->peerSet())
+            sendRequests[peerRank]->wait();
     }
 
     void receiveAdd_(ProcessRank peerRank)
@@ -337,8 +492,8 @@ private:
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
         MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
-        // receive the values from the peer
-        values.receive(peerRank);
+        // wait until the values of the peer have arrived
+        values.wait();
 
         // add up the values of rows on the shared boundary
         for (unsigned j = 0; j < indices.size(); ++j) {
@@ -350,9 +505,20 @@ private:
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<unsigned> > > numIndicesSendBuff_;
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<Index> > > indicesSendBuff_;
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<Index> > > indicesRecvBuff_;
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesSendBuff_;
     std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesRecvBuff_;
 
+    // the data types which select the entries of the vector for the additive
+    // synchronizations and for the ones which copy the values from their master
+    std::map<ProcessRank, std::shared_ptr<MpiIndexedType<FieldVector> > > sendType_;
+    std::map<ProcessRank, std::shared_ptr<MpiIndexedType<FieldVector> > > masterSendType_;
+    std::map<ProcessRank, std::shared_ptr<MpiIndexedType<FieldVector> > > masterRecvType_;
+
+    // the persistent requests which communicate the entries of this vector in place
+    std::map<ProcessRank, std::unique_ptr<MpiBuffer<FieldVector> > > sendRequests_;
+    std::map<ProcessRank, std::unique_ptr<MpiBuffer<FieldVector> > > masterSendRequests_;
+    std::map<ProcessRank, std::unique_ptr<MpiBuffer<FieldVector> > > masterRecvRequests_;
+    const FieldVector* boundData_;
+
     const Overlap *overlap_;
 };
 
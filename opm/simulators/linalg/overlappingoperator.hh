@@ -27,16 +27,41 @@
 #ifndef EWOMS_OVERLAPPING_OPERATOR_HH
 #define EWOMS_OVERLAPPING_OPERATOR_HH
 
+#include "overlaptypes.hh"
+#include "matrixblock.hh"
+
+#include <opm/models/parallel/communicationthread.hh>
+
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware linear operator usable by ISTL.
+ *
+ * To hide the latency of the communication with the peer processes, the rows of the
+ * result which need to be sent to the peers are computed first. Then, the communication
+ * is started and the remaining rows are computed while the data is in flight. If OpenMP
+ * is enabled, the rows are distributed over the threads of the ThreadManager. If a
+ * CommunicationThread exists, the messages are transferred by it, so that the
+ * communication also progresses if the MPI implementation does not do this in the
+ * background.
+ *
+ * Optionally, a correction operator can be specified whose result is added to the one
+ * of the matrix. This is used to apply the Schur complement of auxiliary equations which
+ * are not part of the matrix.
+ *
+ * The entries of the matrix blocks which are structural zeros according to the
+ * BlockSparsity pattern are skipped when the operator is applied. Preconditioners only
+ * see the full blocks of the matrix because the structural zeros are generally lost
+ * during a factorization.
  */
-template <class OverlappingMatrix, class DomainVector, class RangeVector>
+template <class OverlappingMatrix, class DomainVector, class RangeVector,
+          class BlockSparsity = DenseBlockSparsity>
 class OverlappingOperator
     : public Dune::AssembledLinearOperator<OverlappingMatrix, DomainVector, RangeVector>
 {
@@ -47,8 +72,28 @@ public:
     using domain_type = DomainVector;
     using field_type = typename domain_type::field_type;
 
-    OverlappingOperator(const OverlappingMatrix& A) : A_(A)
-    {}
+    OverlappingOperator(const OverlappingMatrix& A)
+        : A_(A)
+        , correction_(nullptr)
+    {
+        // determine the rows which are sent to the peer processes
+        const Overlap& overlap = A_.overlap();
+        std::vector<bool> isSendRow(A_.N(), false);
+        for (const auto peerRank: overlap.peerSet()) {
+            size_t numEntries = overlap.foreignOverlapSize(peerRank);
+            for (unsigned i = 0; i < numEntries; ++i) {
+                Index domRowIdx = overlap.foreignOverlapOffsetToDomesticIdx(peerRank, i);
+                isSendRow[static_cast<unsigned>(domRowIdx)] = true;
+            }
+        }
+
+        for (unsigned rowIdx = 0; rowIdx < isSendRow.size(); ++rowIdx) {
+            if (isSendRow[rowIdx])
+                sendRows_.push_back(rowIdx);
+            else
+                remainingRows_.push_back(rowIdx);
+        }
+    }
 
     //! the kind of computations supported by the operator. Either overlapping or non-overlapping
     Dune::SolverCategory::Category category() const override
@@ -57,16 +102,44 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
-        y.sync();
+        mvRows_(x, y, sendRows_);
+
+        if (CommunicationThread::enabled()) {
+            auto communicate = [&y]() { y.startSync(); y.waitSync(); };
+            auto tasklet = CommunicationThread::dispatch(communicate);
+            mvRows_(x, y, remainingRows_);
+            tasklet->waitUntilFinished();
+        }
+        else {
+            y.startSync();
+            mvRows_(x, y, remainingRows_);
+        }
+        y.finishSync();
+
+        if (correction_)
+            correction_->applyscaleadd(1.0, x, y);
     }
 
     //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
-        y.sync();
+        usmvRows_(alpha, x, y, sendRows_);
+
+        if (CommunicationThread::enabled()) {
+            auto communicate = [&y]() { y.startSync(); y.waitSync(); };
+            auto tasklet = CommunicationThread::dispatch(communicate);
+            usmvRows_(alpha, x, y, remainingRows_);
+            tasklet->waitUntilFinished();
+        }
+        else {
+            y.startSync();
+            usmvRows_(alpha, x, y, remainingRows_);
+        }
+        y.finishSync();
+
+        if (correction_)
+            correction_->applyscaleadd(alpha, x, y);
     }
 
     //! returns the matrix
@@ -76,8 +149,57 @@ public:
     const Overlap& overlap() const
     { return A_.overlap(); }
 
+    /*!
+     * \brief Specify an operator whose result is added to the one of the matrix.
+     *
+     * The correction operator is not considered by getmat(), i.e., preconditioners only
+     * see the matrix. Passing a null pointer removes the correction.
+     */
+    void setCorrection(const Dune::LinearOperator<DomainVector, RangeVector>* correction)
+    { correction_ = correction; }
+
 private:
+    // y[rowIdx] = (A x)[rowIdx] for a set of rows. the rows are independent of each
+    // other, so they are distributed over the threads.
+    void mvRows_(const DomainVector& x, RangeVector& y, const std::vector<unsigned>& rows) const
+    {
+        int numRows = static_cast<int>(rows.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < numRows; ++i) {
+            unsigned rowIdx = rows[static_cast<unsigned>(i)];
+            y[rowIdx] = 0.0;
+            usmvRow_(1.0, x, y, rowIdx);
+        }
+    }
+
+    // y[rowIdx] += alpha * (A x)[rowIdx] for a set of rows
+    void usmvRows_(field_type alpha, const DomainVector& x, RangeVector& y,
+                   const std::vector<unsigned>& rows) const
+    {
+        int numRows = static_cast<int>(rows.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int i = 0; i < numRows; ++i)
+            usmvRow_(alpha, x, y, rows[static_cast<unsigned>(i)]);
+    }
+
+    // y[rowIdx] += alpha * (A x)[rowIdx]
+    void usmvRow_(field_type alpha, const DomainVector& x, RangeVector& y, unsigned rowIdx) const
+    {
+        const auto& row = A_[rowIdx];
+        auto colIt = row.begin();
+        const auto& colEndIt = row.end();
+        for (; colIt != colEndIt; ++colIt)
+            colIt->template usmvSparse<BlockSparsity>(alpha, x[colIt.index()], y[rowIdx]);
+    }
+
     const OverlappingMatrix& A_;
+    const Dune::LinearOperator<DomainVector, RangeVector>* correction_;
+    std::vector<unsigned> sendRows_;
+    std::vector<unsigned> remainingRows_;
 };
 
 } // namespace Linear
@@ -35,13 +35,23 @@
 
 #include <dune/common/version.hh>
 
+#include <type_traits>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware preconditioner for any ISTL linear solver.
+ *
+ * The sequential preconditioner is applied to the overlapping domain of each process,
+ * i.e., this is a one-level Schwarz method. Its result is restricted to the rows which
+ * each process is master of, i.e., the overlap is synchronized by copying the values
+ * from their master instead of adding up the contributions of all processes
+ * (restricted additive Schwarz). If a coarse space is specified (e.g.
+ * SubdomainCoarseSpace), its correction is added to the result of the sequential
+ * preconditioner, which makes it a two-level additive Schwarz method.
  */
-template <class SeqPreCond, class Overlap>
+template <class SeqPreCond, class Overlap, class CoarseSpace = void>
 class OverlappingPreconditioner
     : public Dune::Preconditioner<typename SeqPreCond::domain_type,
                                   typename SeqPreCond::range_type>
@@ -55,9 +65,19 @@ public:
     { return Dune::SolverCategory::overlapping; }
 
     OverlappingPreconditioner(SeqPreCond& seqPreCond, const Overlap& overlap)
-        : seqPreCond_(seqPreCond), overlap_(&overlap)
+        : seqPreCond_(seqPreCond), overlap_(&overlap), coarseSpace_(nullptr)
     {}
 
+    /*!
+     * \brief Add the correction of a coarse space to the result of the sequential
+     *        preconditioner.
+     *
+     * The coarse space must have been updated for the current matrix. If it is a
+     * nullptr, the preconditioner is a one-level method.
+     */
+    void setCoarseSpace(CoarseSpace* coarseSpace)
+    { coarseSpace_ = coarseSpace; }
+
     void pre(domain_type& x, range_type& y) override
     {
 #if HAVE_MPI
@@ -138,6 +158,13 @@ public:
         else
 #endif // HAVE_MPI
             seqPreCond_.apply(x, d);
+
+        if constexpr (!std::is_void_v<CoarseSpace>) {
+            // the coarse correction is consistent on all processes, so it does not
+            // require the overlap to be synchronized again
+            if (coarseSpace_)
+                coarseSpace_->apply(x, d);
+        }
     }
 
     void post(domain_type& x) override
@@ -180,6 +207,7 @@ public:
 private:
     SeqPreCond& seqPreCond_;
     const Overlap *overlap_;
+    CoarseSpace *coarseSpace_;
 };
 
 } // namespace Linear
@@ -31,11 +31,17 @@
 #include <dune/common/parallel/mpihelper.hh>
 #include <dune/istl/scalarproducts.hh>
 
+#include <array>
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware ISTL scalar product.
+ *
+ * If OpenMP is enabled, the local part of the scalar products is computed by the threads
+ * of the ThreadManager.
  */
 template <class OverlappingBlockVector, class Overlap>
 class OverlappingScalarProduct
@@ -64,16 +70,106 @@ public:
 #endif
     {
         field_type sum = 0;
-        size_t numLocal = overlap_.numLocal();
-        for (unsigned localIdx = 0; localIdx < numLocal; ++localIdx) {
-            if (overlap_.iAmMasterOf(static_cast<int>(localIdx)))
-                sum += x[localIdx] * y[localIdx];
+        int numLocal = static_cast<int>(overlap_.numLocal());
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:sum)
+#endif
+        for (int localIdx = 0; localIdx < numLocal; ++localIdx) {
+            if (overlap_.iAmMasterOf(localIdx))
+                sum += x[static_cast<unsigned>(localIdx)] * y[static_cast<unsigned>(localIdx)];
         }
 
         // return the global sum
         return comm_.sum( sum );
     }
 
+    /*!
+     * \brief Compute several scalar products using a single global reduction.
+     *
+     * The k-th entry of the result is the scalar product of the vectors pointed to by
+     * xs[k] and ys[k].
+     */
+    template <size_t numDots>
+    std::array<field_type, numDots> dots(const std::array<const OverlappingBlockVector*, numDots>& xs,
+                                         const std::array<const OverlappingBlockVector*, numDots>& ys) const
+    {
+        std::array<field_type, numDots> sums;
+        sums.fill(0.0);
+        int numLocal = static_cast<int>(overlap_.numLocal());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            std::array<field_type, numDots> threadSums;
+            threadSums.fill(0.0);
+
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+            for (int localIdx = 0; localIdx < numLocal; ++localIdx) {
+                if (!overlap_.iAmMasterOf(localIdx))
+                    continue;
+
+                unsigned i = static_cast<unsigned>(localIdx);
+                for (unsigned k = 0; k < numDots; ++k)
+                    threadSums[k] += (*xs[k])[i] * (*ys[k])[i];
+            }
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            for (unsigned k = 0; k < numDots; ++k)
+                sums[k] += threadSums[k];
+        }
+
+        // compute the global sums
+        comm_.sum(sums.data(), static_cast<int>(numDots));
+        return sums;
+    }
+
+    /*!
+     * \brief Compute the scalar products of a vector with several other vectors using a
+     *        single global reduction.
+     *
+     * In contrast to dots(), the number of scalar products only needs to be known at
+     * run time. After the call, result[k] is the scalar product of *xs[k] and y.
+     */
+    void multiDot(const std::vector<const OverlappingBlockVector*>& xs,
+                  const OverlappingBlockVector& y,
+                  std::vector<field_type>& result) const
+    {
+        size_t numDots = xs.size();
+        result.assign(numDots, 0.0);
+        int numLocal = static_cast<int>(overlap_.numLocal());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            std::vector<field_type> threadSums(numDots, 0.0);
+
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+            for (int localIdx = 0; localIdx < numLocal; ++localIdx) {
+                if (!overlap_.iAmMasterOf(localIdx))
+                    continue;
+
+                unsigned i = static_cast<unsigned>(localIdx);
+                for (size_t k = 0; k < numDots; ++k)
+                    threadSums[k] += (*xs[k])[i] * y[i];
+            }
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            for (size_t k = 0; k < numDots; ++k)
+                result[k] += threadSums[k];
+        }
+
+        // compute the global sums
+        comm_.sum(result.data(), static_cast<int>(numDots));
+    }
+
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
     real_type norm(const OverlappingBlockVector& x) const override
 #else
@@ -29,10 +29,12 @@
 #ifndef EWOMS_OVERLAP_TYPES_HH
 #define EWOMS_OVERLAP_TYPES_HH
 
+#include <algorithm>
 #include <set>
 #include <list>
 #include <vector>
 #include <map>
+#include <utility>
 #include <cstddef>
 
 namespace Opm {
@@ -170,10 +172,78 @@ using OverlapWithPeer = std::vector<IndexDistanceNpeers>;
  */
 using OverlapByRank = std::map<ProcessRank, OverlapWithPeer>;
 
+/*!
+ * \brief Maps the ranks of the peer processes which see an index to the distance of
+ *        the index from their border.
+ *
+ * An index is usually only seen by a handful of processes, so this is a vector of
+ * (rank, distance) pairs which is kept sorted by rank instead of a std::map. The
+ * interface is the subset of the one of std::map which is used by the overlap
+ * classes.
+ */
+class IndexOverlap
+{
+    using Entry = std::pair<ProcessRank, BorderDistance>;
+    using Storage = std::vector<Entry>;
+
+public:
+    using iterator = Storage::iterator;
+    using const_iterator = Storage::const_iterator;
+
+    iterator begin()
+    { return entries_.begin(); }
+
+    iterator end()
+    { return entries_.end(); }
+
+    const_iterator begin() const
+    { return entries_.begin(); }
+
+    const_iterator end() const
+    { return entries_.end(); }
+
+    size_t size() const
+    { return entries_.size(); }
+
+    bool empty() const
+    { return entries_.empty(); }
+
+    const_iterator find(ProcessRank peerRank) const
+    {
+        auto it = lowerBound_(peerRank);
+        if (it == entries_.end() || it->first != peerRank)
+            return entries_.end();
+        return it;
+    }
+
+    size_t count(ProcessRank peerRank) const
+    { return (find(peerRank) == end()) ? 0 : 1; }
+
+    BorderDistance& operator[](ProcessRank peerRank)
+    {
+        auto it = std::lower_bound(entries_.begin(), entries_.end(), peerRank,
+                                   [](const Entry& entry, ProcessRank rank)
+                                   { return entry.first < rank; });
+        if (it == entries_.end() || it->first != peerRank)
+            it = entries_.insert(it, Entry(peerRank, BorderDistance(0)));
+        return it->second;
+    }
+
+private:
+    const_iterator lowerBound_(ProcessRank peerRank) const
+    {
+        return std::lower_bound(entries_.begin(), entries_.end(), peerRank,
+                                [](const Entry& entry, ProcessRank rank)
+                                { return entry.first < rank; });
+    }
+
+    Storage entries_;
+};
+
 /*!
  * \brief Maps each index to a list of processes .
  */
-using OverlapByIndex = std::vector<std::map<ProcessRank, BorderDistance> >;
+using OverlapByIndex = std::vector<IndexOverlap>;
 
 /*!
  * \brief The list of domestic indices are owned by peer rank.
@@ -40,6 +40,8 @@
 
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace Opm::Linear {
@@ -59,6 +61,17 @@ struct ParallelAmgLinearSolver { using InheritsFrom = std::tuple<ParallelBaseLin
 template<class TypeTag>
 struct AmgCoarsenTarget<TypeTag, TTag::ParallelAmgLinearSolver> { static constexpr int value = 5000; };
 
+//! By default, the AMG hierarchy is rebuilt for each linear solve
+template<class TypeTag>
+struct AmgRebuildInterval<TypeTag, TTag::ParallelAmgLinearSolver> { static constexpr int value = 1; };
+
+template<class TypeTag>
+struct AmgRebuildIterationFactor<TypeTag, TTag::ParallelAmgLinearSolver>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 1.5;
+};
+
 template<class TypeTag>
 struct LinearSolverMaxError<TypeTag, TTag::ParallelAmgLinearSolver>
 {
@@ -79,6 +92,14 @@ namespace Linear {
  *
  * \brief Provides a linear solver backend using the parallel
  *        algebraic multi-grid (AMG) linear solver from DUNE-ISTL.
+ *
+ * Setting up the AMG hierarchy is expensive. Since the Jacobian matrix often changes
+ * only slowly between Newton iterations and time steps, the hierarchy can optionally be
+ * reused for several linear solves (see the AmgRebuildInterval parameter). In this case,
+ * only the Galerkin products of the coarse levels are recomputed using the aggregates of
+ * the last full setup. The hierarchy is rebuilt from scratch if the number of iterations
+ * of the linear solver deteriorates too much, if the reuse interval is exhausted or if the
+ * structure of the linear system changes.
  */
 template <class TypeTag>
 class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
@@ -149,6 +170,9 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
 public:
     ParallelAmgBackend(const Simulator& simulator)
         : ParentType(simulator)
+        , numSolvesSinceRebuild_(0)
+        , referenceIterations_(-1)
+        , lastAmgIterations_(-1)
     { }
 
     static void registerParameters()
@@ -161,6 +185,38 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, int, AmgCoarsenTarget,
                              "The coarsening target for the agglomerations of "
                              "the AMG preconditioner");
+        EWOMS_REGISTER_PARAM(TypeTag, int, AmgRebuildInterval,
+                             "The maximum number of linear solves for which the hierarchy of "
+                             "the AMG preconditioner is reused. (1: rebuild for each solve, "
+                             "0: only rebuild if the convergence deteriorates)");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, AmgRebuildIterationFactor,
+                             "Rebuild the hierarchy of the AMG preconditioner if the number of "
+                             "linear iterations exceeds the one of the first solve after the "
+                             "last rebuild by this factor");
+    }
+
+    /*!
+     * \copydoc ParallelBaseBackend::recordMemoryUsage
+     *
+     * In addition, the memory of the AMG hierarchy is recorded. Since dune-istl does not
+     * expose the matrices of the coarse levels, their memory is estimated from the one
+     * of the fine level matrix assuming that the aggregates consist of 3^dim degrees of
+     * freedom as requested from the coarsening criterion.
+     */
+    void recordMemoryUsage() const
+    {
+        ParentType::recordMemoryUsage();
+
+        double hierarchyMemory = 0.0;
+        if (amg_ && this->overlappingMatrix_) {
+            double levelMemory = static_cast<double>(this->matrixMemory_(*this->overlappingMatrix_));
+            const double coarseningFactor = std::pow(3.0, GridView::dimension);
+            for (size_t levelIdx = 1; levelIdx < amg_->levels(); ++levelIdx) {
+                levelMemory /= coarseningFactor;
+                hierarchyMemory += levelMemory;
+            }
+        }
+        MemoryAccounting::record("AMG hierarchy", static_cast<size_t>(hierarchyMemory));
     }
 
 protected:
@@ -168,6 +224,19 @@ protected:
 
     std::shared_ptr<AMG> preparePreconditioner_()
     {
+        if (amg_ && !this->matrixChanged_)
+            // the matrix has not been modified since the last solve
+            return amg_;
+
+        if (amg_ && !needsRebuild_()) {
+            // the aggregates and the communication patterns stay the same, so only the
+            // matrices of the coarse levels need to be updated. (the smoothers reference
+            // these matrices.)
+            amg_->recalculateHierarchy();
+            ++numSolvesSinceRebuild_;
+            return amg_;
+        }
+
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
         // using the domestic overlap
@@ -184,6 +253,8 @@ protected:
 #endif
 
         setupAmg_();
+        numSolvesSinceRebuild_ = 1;
+        referenceIterations_ = -1;
 
         return amg_;
     }
@@ -191,6 +262,19 @@ protected:
     void cleanupPreconditioner_()
     { /* nothing to do */ }
 
+    void cleanup_()
+    {
+        // the AMG hierarchy refers to the overlapping matrix, i.e., it must be rebuilt if
+        // the matrix is recreated
+        amg_.reset();
+        fineOperator_.reset();
+#if HAVE_MPI
+        istlComm_.reset();
+#endif
+
+        ParentType::cleanup_();
+    }
+
     std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
                                                     ParallelScalarProduct& parScalarProduct,
                                                     AMG& parPreCond)
@@ -198,7 +282,7 @@ protected:
         const auto& gridView = this->simulator_.gridView();
         using CCC = CombinedCriterion<OverlappingVector, decltype(gridView.comm())>;
 
-        Scalar linearSolverTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
+        Scalar linearSolverTolerance = this->tolerance_;
         Scalar linearSolverAbsTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverAbsTolerance);
         if(linearSolverAbsTolerance < 0.0)
             linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance()/100.0;
@@ -225,9 +309,31 @@ protected:
     std::pair<bool,int> runSolver_(std::shared_ptr<RawLinearSolver> solver)
     {
         bool converged = solver->apply(*this->overlappingx_);
+
+        lastAmgIterations_ = converged ? int(solver->report().iterations()) : -1;
+        if (referenceIterations_ < 0)
+            referenceIterations_ = lastAmgIterations_;
+
         return std::make_pair(converged, int(solver->report().iterations()));
     }
 
+    // returns true if the AMG hierarchy cannot be reused for the next linear solve. the
+    // number of iterations is the same on all processes, so all of them come to the same
+    // conclusion.
+    bool needsRebuild_() const
+    {
+        int rebuildInterval = EWOMS_GET_PARAM(TypeTag, int, AmgRebuildInterval);
+        if (rebuildInterval > 0 && numSolvesSinceRebuild_ >= rebuildInterval)
+            return true;
+
+        // the last solve did not converge
+        if (lastAmgIterations_ < 0)
+            return true;
+
+        Scalar factor = EWOMS_GET_PARAM(TypeTag, Scalar, AmgRebuildIterationFactor);
+        return lastAmgIterations_ > factor*std::max(referenceIterations_, 1);
+    }
+
     void cleanupSolver_()
     { /* nothing to do */ }
 
@@ -310,6 +416,13 @@ protected:
     std::shared_ptr<FineOperator> fineOperator_;
     std::shared_ptr<AMG> amg_;
 
+    // the number of linear solves which used the current AMG hierarchy
+    int numSolvesSinceRebuild_;
+    // the number of linear iterations used by the first solve after the last rebuild
+    int referenceIterations_;
+    // the number of linear iterations used by the last solve (-1 if it failed)
+    int lastAmgIterations_;
+
 #if HAVE_MPI
     std::shared_ptr<OwnerOverlapCopyCommunication> istlComm_;
 #endif
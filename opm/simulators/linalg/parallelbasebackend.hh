@@ -27,6 +27,7 @@
 #ifndef EWOMS_PARALLEL_BASE_BACKEND_HH
 #define EWOMS_PARALLEL_BASE_BACKEND_HH
 
+#include <opm/simulators/linalg/auxiliaryschurcomplement.hh>
 #include <opm/simulators/linalg/istlsparsematrixadapter.hh>
 #include <opm/simulators/linalg/overlappingbcrsmatrix.hh>
 #include <opm/simulators/linalg/overlappingblockvector.hh>
@@ -35,8 +36,13 @@
 #include <opm/simulators/linalg/overlappingoperator.hh>
 #include <opm/simulators/linalg/parallelbasebackend.hh>
 #include <opm/simulators/linalg/istlpreconditionerwrappers.hh>
+#include <opm/simulators/linalg/linearsolverreport.hh>
+#include <opm/simulators/linalg/recyclinggmressolver.hh>
+#include <opm/simulators/linalg/subdomaincoarsespace.hh>
 
 #include <opm/models/utils/genericguard.hh>
+#include <opm/models/utils/instrumentation.hh>
+#include <opm/models/utils/memoryaccounting.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
@@ -47,7 +53,12 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <memory>
 #include <iostream>
 
@@ -123,23 +134,41 @@ protected:
     using PreconditionerWrapper = GetPropType<TypeTag, Properties::PreconditionerWrapper>;
     using SequentialPreconditioner = typename PreconditionerWrapper::SequentialPreconditioner;
 
-    using ParallelPreconditioner = Opm::Linear::OverlappingPreconditioner<SequentialPreconditioner, Overlap>;
+    using CoarseSpace = Opm::Linear::SubdomainCoarseSpace<OverlappingMatrix, OverlappingVector>;
+    using ParallelPreconditioner = Opm::Linear::OverlappingPreconditioner<SequentialPreconditioner,
+                                                                          Overlap,
+                                                                          CoarseSpace>;
     using ParallelScalarProduct = Opm::Linear::OverlappingScalarProduct<OverlappingVector, Overlap>;
+    using JacobianBlockSparsity = GetPropType<TypeTag, Properties::JacobianBlockSparsity>;
     using ParallelOperator = Opm::Linear::OverlappingOperator<OverlappingMatrix,
                                                               OverlappingVector,
-                                                              OverlappingVector>;
+                                                              OverlappingVector,
+                                                              JacobianBlockSparsity>;
+    using RecycleSpace = Opm::Linear::KrylovRecycleSpace<OverlappingVector>;
+    using SchurComplement = Opm::Linear::AuxiliarySchurComplement<TypeTag, OverlappingVector>;
 
     enum { dimWorld = GridView::dimensionworld };
 
+    enum class InitialGuess { Zero, Previous, Extrapolated };
+
 public:
     ParallelBaseBackend(const Simulator& simulator)
         : simulator_(simulator)
         , gridSequenceNumber_( -1 )
         , lastIterations_( -1 )
+        , matrixChanged_( true )
     {
+        tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
+        refinementSteps_ = EWOMS_GET_PARAM(TypeTag, int, LinearSolverRefinementSteps);
+        useCoarseSpace_ = EWOMS_GET_PARAM(TypeTag, bool, LinearSolverCoarseSpace);
+        initialGuess_ = initialGuessFromString_(EWOMS_GET_PARAM(TypeTag, std::string, LinearSolverInitialGuess));
+        numPrevSolutions_ = 0;
+        nativeMatrix_ = nullptr;
         overlappingMatrix_ = nullptr;
         overlappingb_ = nullptr;
         overlappingx_ = nullptr;
+
+        initPreconditionerWrapper_(precWrapper_, /*dummy=*/0);
     }
 
     ~ParallelBaseBackend()
@@ -160,6 +189,19 @@ public:
                              "The maximum number of iterations of the linear solver");
         EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverVerbosity,
                              "The verbosity level of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverRefinementSteps,
+                             "The maximum number of iterative refinement steps which compute "
+                             "the residual of the solution of the linear solver using the "
+                             "precision of the linearization");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, LinearSolverCoarseSpace,
+                             "Add a coarse correction with one aggregate per process to the "
+                             "preconditioner of parallel runs");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, LinearSolverInitialGuess,
+                             "The initial guess of the linear solver. Possible values are "
+                             "'zero', 'previous' (a multiple of the previous solution) and "
+                             "'extrapolated' (a multiple of the extrapolation of the two "
+                             "previous solutions). The guess is only used if it reduces the "
+                             "residual compared to a zero guess");
 
         PreconditionerWrapper::registerParameters();
     }
@@ -171,6 +213,22 @@ public:
     void eraseMatrix()
     { cleanup_(); }
 
+    /*!
+     * \brief Set the reduction of the residual which the linear solver needs to achieve.
+     *
+     * This overrides the value of the LinearSolverTolerance parameter for all subsequent
+     * calls of solve().
+     */
+    void setTolerance(Scalar tolerance)
+    { tolerance_ = tolerance; }
+
+    /*!
+     * \brief Return the reduction of the residual which the linear solver needs to
+     *        achieve.
+     */
+    Scalar tolerance() const
+    { return tolerance_; }
+
     /*!
      * \brief Set up the internal data structures required for the linear solver.
      *
@@ -214,6 +272,11 @@ public:
      */
     void setResidual(const Vector& b)
     {
+        // the residual is synchronized by the caller afterwards, so keep the unsynchronized
+        // one for the iterative refinement
+        if (refinementSteps_ > 0)
+            nativeResidual_ = b;
+
         // copy the interior values of the non-overlapping residual vector to the
         // overlapping one
         overlappingb_->assignAddBorder(b);
@@ -238,13 +301,24 @@ public:
      */
     void setMatrix(const SparseMatrixAdapter& M)
     {
+        nativeMatrix_ = &M;
         overlappingMatrix_->assignFromNative(M.istlMatrix());
         overlappingMatrix_->syncAdd();
+        matrixChanged_ = true;
     }
 
     /*!
      * \brief Actually solve the linear system of equations.
      *
+     * If the matrix has not been changed using setMatrix() since the last call, the
+     * preconditioner of the last solve is reused.
+     *
+     * Depending on the LinearSolverInitialGuess parameter, the solver is started from a
+     * guess which is based on the solutions of the previous solves, e.g. the previous
+     * Newton updates. The reduction of the residual which the solver needs to achieve is
+     * then relaxed by the reduction achieved by the guess, i.e., the linear system is
+     * solved to the same absolute residual as for a zero initial guess.
+     *
      * \return true if the residual reduction could be achieved, else false.
      */
     bool solve(Vector& x)
@@ -255,8 +329,16 @@ public:
 #endif
 
         (*overlappingx_) = 0.0;
-
-        auto parPreCond = asImp_().preparePreconditioner_();
+        report_.reset();
+
+        decltype(asImp_().preparePreconditioner_()) parPreCond;
+        {
+            Instrumentation::Region precondRegion(Instrumentation::preconditionerSetupRegion);
+            Opm::TimerGuard setupTimerGuard(report_.setupTimer());
+            report_.setupTimer().start();
+            parPreCond = asImp_().preparePreconditioner_();
+            matrixChanged_ = false;
+        }
         auto precondCleanupFn = [this]() -> void
                                 { this->asImp_().cleanupPreconditioner_(); };
         auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
@@ -264,10 +346,25 @@ public:
         ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
         ParallelOperator parOperator(*overlappingMatrix_);
 
+        // the auxiliary equations which are not part of the matrix are considered by
+        // the operator via their Schur complement
+        SchurComplement schurComplement(simulator_.model(), overlappingMatrix_->overlap());
+        if (!schurComplement.empty())
+            parOperator.setCorrection(&schurComplement);
+
+        // the tolerance only needs to be adapted while the solver is prepared
+        Scalar origTolerance = tolerance_;
+        auto restoreToleranceFn = [this, origTolerance]() -> void
+                                  { this->tolerance_ = origTolerance; };
+        auto restoreToleranceGuard = Opm::make_guard(restoreToleranceFn);
+        Scalar guessReduction = seedInitialGuess_(parOperator, parScalarProduct);
+        tolerance_ = origTolerance/guessReduction;
+
         // retrieve the linear solver
         auto solver = asImp_().prepareSolver_(parOperator,
                                               parScalarProduct,
                                               *parPreCond);
+        tolerance_ = origTolerance;
 
         auto cleanupSolverFn =
             [this]() -> void
@@ -275,13 +372,72 @@ public:
         GenericGuard<decltype(cleanupSolverFn)> solverGuard(cleanupSolverFn);
 
         // run the linear solver and have some fun
-        auto result = asImp_().runSolver_(solver);
+        std::pair<bool, int> result;
+        {
+            Instrumentation::Region solverRegion(Instrumentation::linearSolverRegion);
+            Opm::TimerGuard solverTimerGuard(report_.timer());
+            report_.timer().start();
+            result = asImp_().runSolver_(solver);
+        }
         // store number of iterations used
         lastIterations_ = result.second;
 
         // copy the result back to the non-overlapping vector
         overlappingx_->assignTo(x);
 
+        // if the linear solver works with less precise numbers than the linearization,
+        // the accuracy of its solution is limited by its floating point type and not by
+        // the tolerance. Iterative refinement recovers the lost digits by solving for
+        // corrections of residuals which are computed using the precise type. Since
+        // the residual only considers the Jacobian matrix, this is not possible if
+        // auxiliary equations are present.
+        if (refinementSteps_ > 0 && result.first && schurComplement.empty()
+            && nativeMatrix_ && nativeResidual_.size() == x.size())
+        {
+            // leave the residual of the linear system untouched for getResidual()
+            OverlappingVector b0(*overlappingb_);
+
+            Vector dx(x.size());
+            for (int stepIdx = 0; stepIdx < refinementSteps_; ++stepIdx) {
+                Vector r(nativeResidual_);
+                computeResidual_(r, x);
+                overlappingb_->assignAddBorder(r);
+
+                (*overlappingx_) = 0.0;
+                {
+                    Instrumentation::Region solverRegion(Instrumentation::linearSolverRegion);
+                    Opm::TimerGuard solverTimerGuard(report_.timer());
+                    report_.timer().start();
+                    result = asImp_().runSolver_(solver);
+                }
+                lastIterations_ += result.second;
+                if (!result.first)
+                    break;
+
+                overlappingx_->assignTo(dx);
+                x += dx;
+            }
+
+            *overlappingb_ = b0;
+        }
+
+        // keep the solutions for the initial guesses of the next solves. the next
+        // system is probably not related to the one of a failed solve.
+        if (initialGuess_ != InitialGuess::Zero) {
+            if (result.first) {
+                std::swap(prevSolution_, prevPrevSolution_);
+                prevSolution_ = x;
+                numPrevSolutions_ = std::min(numPrevSolutions_ + 1, 2u);
+            }
+            else
+                numPrevSolutions_ = 0;
+        }
+
+        for (size_t i = 0; i < lastIterations_; ++i)
+            report_.increment();
+        report_.setConverged(result.first);
+        recordSolve_(precWrapper_, /*dummy=*/0);
+
         // return the result of the solver
         return result.first;
     }
@@ -292,15 +448,86 @@ public:
     size_t iterations () const
     { return lastIterations_; }
 
+    /*!
+     * \brief Return the summary of the last solve.
+     *
+     * The time spent for setting up the preconditioner is reported separately from
+     * the time spent by the linear solver.
+     */
+    const SolverReport& report() const
+    { return report_; }
+
+    /*!
+     * \brief Return the subspace which Krylov solvers that support recycling keep
+     *        between solves.
+     *
+     * It is discarded together with the overlapping matrix, i.e., if the grid changes
+     * or if eraseMatrix() is called.
+     */
+    RecycleSpace& recycleSpace()
+    { return recycleSpace_; }
+
+    /*!
+     * \brief Record the memory held by the overlapping linear system of equations with
+     *        the MemoryAccounting.
+     */
+    void recordMemoryUsage() const
+    {
+        size_t vectorMemory = 0;
+        if (overlappingb_)
+            vectorMemory += overlappingb_->size()*sizeof(typename OverlappingVector::block_type);
+        if (overlappingx_)
+            vectorMemory += overlappingx_->size()*sizeof(typename OverlappingVector::block_type);
+        vectorMemory +=
+            (prevSolution_.capacity() + prevPrevSolution_.capacity())*sizeof(typename Vector::block_type);
+
+        MemoryAccounting::record("overlapping matrix",
+                                 overlappingMatrix_ ? matrixMemory_(*overlappingMatrix_) : 0);
+        MemoryAccounting::record("overlapping vectors", vectorMemory);
+    }
+
 protected:
+    // the number of bytes held by a block compressed row storage matrix
+    template <class BCRSMatrix>
+    static size_t matrixMemory_(const BCRSMatrix& matrix)
+    {
+        return matrix.nonzeroes()*(sizeof(typename BCRSMatrix::block_type)
+                                   + sizeof(typename BCRSMatrix::size_type))
+            + matrix.N()*sizeof(typename BCRSMatrix::row_type);
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
 
     const Implementation& asImp_() const
     { return *static_cast<const Implementation *>(this); }
 
+    // computes r -= A*x using the floating point type of the linearization
+    void computeResidual_(Vector& r, const Vector& x) const
+    {
+        const auto& A = nativeMatrix_->istlMatrix();
+        const auto rowEndIt = A.end();
+        for (auto rowIt = A.begin(); rowIt != rowEndIt; ++rowIt) {
+            auto& rRow = r[rowIt.index()];
+            const auto colEndIt = rowIt->end();
+            for (auto colIt = rowIt->begin(); colIt != colEndIt; ++colIt) {
+                const auto& block = *colIt;
+                const auto& xCol = x[colIt.index()];
+                for (unsigned i = 0; i < rRow.size(); ++i) {
+                    Scalar sum = 0.0;
+                    for (unsigned j = 0; j < xCol.size(); ++j)
+                        sum += static_cast<Scalar>(block[i][j])*xCol[j];
+                    rRow[i] -= sum;
+                }
+            }
+        }
+    }
+
     void cleanup_()
     {
+        // the preconditioner refers to the overlapping matrix
+        releasePreconditioner_();
+
         // create the overlapping Jacobian matrix and vectors
         delete overlappingMatrix_;
         delete overlappingb_;
@@ -308,11 +535,110 @@ protected:
 
         overlappingMatrix_ = 0;
         overlappingb_ = 0;
+        nativeMatrix_ = nullptr;
         overlappingx_ = 0;
+        matrixChanged_ = true;
+
+        // the recycled vectors use the layout of the old overlapping vectors
+        recycleSpace_.clear();
+
+        // the previous solutions may belong to a different grid
+        numPrevSolutions_ = 0;
+    }
+
+    static InitialGuess initialGuessFromString_(const std::string& name)
+    {
+        if (name == "zero")
+            return InitialGuess::Zero;
+        else if (name == "previous")
+            return InitialGuess::Previous;
+        else if (name == "extrapolated")
+            return InitialGuess::Extrapolated;
+
+        throw std::runtime_error("Unknown initial guess '"+name+"' for the linear solver. "
+                                 "Possible values are 'zero', 'previous' and 'extrapolated'");
+    }
+
+    // set the overlapping solution to a multiple of the previous solution or of the
+    // extrapolation of the two previous ones. The factor minimizes the norm of the
+    // residual of the guess. Returns the ratio of the norms of the residuals for the
+    // guess and for a zero guess, or 1 if the zero guess is kept. Iterative refinement
+    // would solve for the corrections with the relaxed tolerance, so it does not use a
+    // guess.
+    Scalar seedInitialGuess_(const ParallelOperator& parOperator,
+                             const ParallelScalarProduct& parScalarProduct)
+    {
+        // the guess is only used if it reduces the residual noticeably, because it
+        // requires an additional application of the operator
+        static constexpr Scalar maxReduction = 0.9;
+
+        if (initialGuess_ == InitialGuess::Zero || numPrevSolutions_ == 0 || refinementSteps_ > 0)
+            return 1.0;
+
+        Vector guess(prevSolution_);
+        if (initialGuess_ == InitialGuess::Extrapolated && numPrevSolutions_ > 1) {
+            guess *= 2.0;
+            guess -= prevPrevSolution_;
+        }
+
+        OverlappingVector d(*overlappingx_);
+        d.assign(guess);
+        OverlappingVector Ad(d);
+        parOperator.apply(d, Ad);
+
+        const OverlappingVector& b = *overlappingb_;
+        const auto dots = parScalarProduct.template dots<3>({&b, &b, &Ad}, {&b, &Ad, &Ad});
+        Scalar bNorm = std::sqrt(static_cast<Scalar>(dots[0]));
+        Scalar bAd = static_cast<Scalar>(dots[1]);
+        Scalar AdAd = static_cast<Scalar>(dots[2]);
+        if (!(AdAd > 0.0) || !(bNorm > 0.0))
+            return 1.0;
+
+        // the norm of b - s*A*d is minimal for s = (b, A*d)/(A*d, A*d). the norm of the
+        // residual is calculated explicitly because it determines the tolerance
+        Scalar s = bAd/AdAd;
+        OverlappingVector r(b);
+        r.axpy(-s, Ad);
+        Scalar reduction = static_cast<Scalar>(parScalarProduct.norm(r))/bNorm;
+        if (!std::isfinite(reduction) || reduction > maxReduction)
+            return 1.0;
+
+        d *= s;
+        *overlappingx_ = d;
+        return reduction;
     }
 
+    // preconditioner wrappers which exploit the grid (e.g. the geometric multigrid one)
+    // get access to the simulator if they provide an init() method
+    template <class Wrapper>
+    auto initPreconditionerWrapper_(Wrapper& wrapper, int)
+        -> decltype(wrapper.init(std::declval<const Simulator&>()), void())
+    { wrapper.init(simulator_); }
+
+    template <class Wrapper>
+    void initPreconditionerWrapper_(Wrapper&, long)
+    {}
+
+    // preconditioner wrappers which adapt themselves to the performance of the linear
+    // solver are informed about the outcome of each solve
+    template <class Wrapper>
+    auto recordSolve_(Wrapper& wrapper, int)
+        -> decltype(wrapper.recordSolve(std::declval<const SolverReport&>()), void())
+    { wrapper.recordSolve(report_); }
+
+    template <class Wrapper>
+    void recordSolve_(Wrapper&, long)
+    {}
+
     std::shared_ptr<ParallelPreconditioner> preparePreconditioner_()
     {
+        if (parPreCond_ && !matrixChanged_)
+            // the matrix is still the same as for the last solve, so there is no need
+            // to recompute the preconditioner
+            return parPreCond_;
+
+        releasePreconditioner_();
+
         int preconditionerIsReady = 1;
         try {
             // update sequential preconditioner
@@ -332,11 +658,24 @@ protected:
             throw Opm::NumericalIssue("Creating the preconditioner failed");
 
         // create the parallel preconditioner
-        return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+        parPreCond_ = std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+        if (useCoarseSpace_) {
+            coarseSpace_.update(*overlappingMatrix_);
+            if (coarseSpace_.active())
+                parPreCond_->setCoarseSpace(&coarseSpace_);
+        }
+        return parPreCond_;
     }
 
     void cleanupPreconditioner_()
+    { /* the preconditioner is kept until the matrix changes */ }
+
+    void releasePreconditioner_()
     {
+        if (!parPreCond_)
+            return;
+
+        parPreCond_.reset();
         precWrapper_.cleanup();
     }
 
@@ -380,12 +719,31 @@ protected:
     const Simulator& simulator_;
     int gridSequenceNumber_;
     size_t lastIterations_;
+    SolverReport report_;
+    bool matrixChanged_;
+    Scalar tolerance_;
+    int refinementSteps_;
+    bool useCoarseSpace_;
+
+    // the solutions of the previous solves which are used for the initial guess
+    InitialGuess initialGuess_;
+    Vector prevSolution_;
+    Vector prevPrevSolution_;
+    unsigned numPrevSolutions_;
+
+    // the linear system in the floating point type of the linearization
+    const SparseMatrixAdapter *nativeMatrix_;
+    Vector nativeResidual_;
 
     OverlappingMatrix *overlappingMatrix_;
     OverlappingVector *overlappingb_;
     OverlappingVector *overlappingx_;
 
     PreconditionerWrapper precWrapper_;
+    std::shared_ptr<ParallelPreconditioner> parPreCond_;
+    CoarseSpace coarseSpace_;
+
+    RecycleSpace recycleSpace_;
 };
 }} // namespace Linear, Opm
 
@@ -453,10 +811,16 @@ struct OverlappingLinearOperator<TypeTag, TTag::ParallelBaseLinearSolver>
 {
     using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
     using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+    using JacobianBlockSparsity = GetPropType<TypeTag, Properties::JacobianBlockSparsity>;
     using type = Opm::Linear::OverlappingOperator<OverlappingMatrix, OverlappingVector,
-                                                  OverlappingVector>;
+                                                  OverlappingVector, JacobianBlockSparsity>;
 };
 
+//! by default, the blocks of the Jacobian matrix do not exhibit any structural zeros
+template<class TypeTag>
+struct JacobianBlockSparsity<TypeTag, TTag::ParallelBaseLinearSolver>
+{ using type = Opm::DenseBlockSparsity; };
+
 #if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
 template<class TypeTag>
 struct PreconditionerWrapper<TypeTag, TTag::ParallelBaseLinearSolver>
@@ -467,6 +831,39 @@ struct PreconditionerWrapper<TypeTag, TTag::ParallelBaseLinearSolver>
 { using type = Opm::Linear::PreconditionerWrapperILU0<TypeTag>; };
 #endif
 
+//! the coarsening target of the AMG used by the CPR preconditioner (if it is selected)
+template<class TypeTag>
+struct CprCoarsenTarget<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 1200; };
+
+//! the coarsening target of the geometric multigrid preconditioner (if it is selected)
+template<class TypeTag>
+struct MultigridCoarsenTarget<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 64; };
+
+//! the candidates of the auto-tuned preconditioner (if it is selected)
+template<class TypeTag>
+struct AutoTunePreconditioners<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr auto value = "ILU0,SSOR,Jacobi"; };
+
+template<class TypeTag>
+struct AutoTuneTrials<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 2; };
+
+template<class TypeTag>
+struct AutoTuneInterval<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 200; };
+
+template<class TypeTag>
+struct AutoTuneIterationFactor<TypeTag, TTag::ParallelBaseLinearSolver>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 2.0;
+};
+
+//! use a one-level Schwarz method by default
+template<class TypeTag>
+struct LinearSolverCoarseSpace<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr bool value = false; };
+
+//! start the linear solver from zero by default
+template<class TypeTag>
+struct LinearSolverInitialGuess<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr auto value = "zero"; };
+
 //! set the default overlap size to 2
 template<class TypeTag>
 struct LinearSolverOverlapSize<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 2; };
@@ -475,6 +872,10 @@ struct LinearSolverOverlapSize<TypeTag, TTag::ParallelBaseLinearSolver> { static
 template<class TypeTag>
 struct LinearSolverMaxIterations<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 1000; };
 
+//! do not refine the solution of the linear solver by default
+template<class TypeTag>
+struct LinearSolverRefinementSteps<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 0; };
+
 } // namespace Opm::Properties
 
 #endif
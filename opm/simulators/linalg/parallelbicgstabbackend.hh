@@ -58,6 +58,9 @@ struct LinearSolverMaxError<TypeTag, TTag::ParallelBiCGStabLinearSolver>
     static constexpr type value = 1e7;
 };
 
+template<class TypeTag>
+struct LinearSolverFuseReductions<TypeTag, TTag::ParallelBiCGStabLinearSolver> { static constexpr bool value = false; };
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -107,7 +110,8 @@ class ParallelBiCGStabSolverBackend : public ParallelBaseBackend<TypeTag>
 
     using RawLinearSolver = BiCGStabSolver<ParallelOperator,
                                            OverlappingVector,
-                                           ParallelPreconditioner>;
+                                           ParallelPreconditioner,
+                                           ParallelScalarProduct>;
 
     static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
                   "The ParallelIstlSolverBackend linear solver backend requires the IstlSparseMatrixAdapter");
@@ -115,7 +119,15 @@ class ParallelBiCGStabSolverBackend : public ParallelBaseBackend<TypeTag>
 public:
     ParallelBiCGStabSolverBackend(const Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        // the solver is set up for each linear system, so avoid retrieving its
+        // parameters by name every time
+        absTolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverAbsTolerance);
+        maxError_ = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverMaxError);
+        verbosity_ = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+        maxIterations_ = EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations);
+        fuseReductions_ = EWOMS_GET_PARAM(TypeTag, bool, LinearSolverFuseReductions);
+    }
 
     static void registerParameters()
     {
@@ -124,6 +136,9 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, LinearSolverMaxError,
                              "The maximum residual error which the linear solver tolerates"
                              " without giving up");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, LinearSolverFuseReductions,
+                             "Compute the scalar products of a BiCGStab iteration using as few "
+                             "global reductions as possible");
     }
 
 protected:
@@ -136,24 +151,25 @@ protected:
         const auto& gridView = this->simulator_.gridView();
         using CCC = CombinedCriterion<OverlappingVector, decltype(gridView.comm())>;
 
-        Scalar linearSolverTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
-        Scalar linearSolverAbsTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverAbsTolerance);
+        Scalar linearSolverTolerance = this->tolerance_;
+        Scalar linearSolverAbsTolerance = absTolerance_;
         if(linearSolverAbsTolerance < 0.0)
             linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance() / 100.0;
 
         convCrit_.reset(new CCC(gridView.comm(),
                                 /*residualReductionTolerance=*/linearSolverTolerance,
                                 /*absoluteResidualTolerance=*/linearSolverAbsTolerance,
-                                EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverMaxError)));
+                                maxError_));
 
         auto bicgstabSolver =
             std::make_shared<RawLinearSolver>(parPreCond, *convCrit_, parScalarProduct);
 
         int verbosity = 0;
         if (parOperator.overlap().myRank() == 0)
-            verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+            verbosity = verbosity_;
         bicgstabSolver->setVerbosity(verbosity);
-        bicgstabSolver->setMaxIterations(EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations));
+        bicgstabSolver->setMaxIterations(maxIterations_);
+        bicgstabSolver->setFuseReductions(fuseReductions_);
         bicgstabSolver->setLinearOperator(&parOperator);
         bicgstabSolver->setRhs(this->overlappingb_);
 
@@ -170,6 +186,12 @@ protected:
     { /* nothing to do */ }
 
     std::unique_ptr<ConvergenceCriterion<OverlappingVector> > convCrit_;
+
+    Scalar absTolerance_;
+    Scalar maxError_;
+    int verbosity_;
+    int maxIterations_;
+    bool fuseReductions_;
 };
 
 }} // namespace Linear, Opm
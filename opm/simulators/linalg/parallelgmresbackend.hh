@@ -0,0 +1,192 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::ParallelGmresSolverBackend
+ */
+#ifndef EWOMS_PARALLEL_GMRES_BACKEND_HH
+#define EWOMS_PARALLEL_GMRES_BACKEND_HH
+
+#include "linalgproperties.hh"
+#include "parallelbasebackend.hh"
+#include "gmressolver.hh"
+#include "istlsparsematrixadapter.hh"
+
+#include <memory>
+
+namespace Opm::Linear {
+template <class TypeTag>
+class ParallelGmresSolverBackend;
+} // namespace Opm::Linear
+
+namespace Opm::Properties {
+
+// Create new type tags
+namespace TTag {
+struct ParallelGmresLinearSolver { using InheritsFrom = std::tuple<ParallelBaseLinearSolver>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct LinearSolverBackend<TypeTag, TTag::ParallelGmresLinearSolver>
+{ using type = Opm::Linear::ParallelGmresSolverBackend<TypeTag>; };
+
+//! set the GMRES restart parameter to 20 by default
+template<class TypeTag>
+struct GMResRestart<TypeTag, TTag::ParallelGmresLinearSolver> { static constexpr int value = 20; };
+
+//! use classical Gram-Schmidt with reorthogonalization by default
+template<class TypeTag>
+struct GMResOrthogonalization<TypeTag, TTag::ParallelGmresLinearSolver> { static constexpr auto value = "cgs2"; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+namespace Linear {
+/*!
+ * \ingroup Linear
+ *
+ * \brief A linear solver backend which uses the native restarted GMRES solver.
+ *
+ * The solver object and thus its Krylov basis is kept between the linear systems, so
+ * the work vectors are only allocated once for a given grid. The preconditioner is
+ * chosen using the "PreconditionerWrapper" property like for the other backends which
+ * are based on ParallelBaseBackend.
+ */
+template <class TypeTag>
+class ParallelGmresSolverBackend : public ParallelBaseBackend<TypeTag>
+{
+    using ParentType = ParallelBaseBackend<TypeTag>;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+
+    using ParallelOperator = typename ParentType::ParallelOperator;
+    using OverlappingVector = typename ParentType::OverlappingVector;
+    using ParallelPreconditioner = typename ParentType::ParallelPreconditioner;
+    using ParallelScalarProduct = typename ParentType::ParallelScalarProduct;
+
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+
+    using RawLinearSolver = GmresSolver<ParallelOperator,
+                                        OverlappingVector,
+                                        ParallelPreconditioner,
+                                        ParallelScalarProduct>;
+
+    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
+                  "The ParallelGmresSolverBackend linear solver backend requires the IstlSparseMatrixAdapter");
+
+public:
+    ParallelGmresSolverBackend(const Simulator& simulator)
+        : ParentType(simulator)
+    {
+        absTolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverAbsTolerance);
+        verbosity_ = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
+        maxIterations_ = EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations);
+        restart_ = EWOMS_GET_PARAM(TypeTag, int, GMResRestart);
+        orthogonalization_ =
+            gmresOrthogonalizationFromString(EWOMS_GET_PARAM(TypeTag, std::string, GMResOrthogonalization));
+    }
+
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, int, GMResRestart,
+                             "Number of iterations after which the GMRES linear solver is restarted");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, GMResOrthogonalization,
+                             "The method used to orthogonalize the Krylov basis of the GMRES "
+                             "linear solver. Possible values are 'cgs2' (classical Gram-Schmidt "
+                             "with reorthogonalization, needs less global reductions) and 'mgs' "
+                             "(modified Gram-Schmidt)");
+    }
+
+protected:
+    friend ParentType;
+
+    std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
+                                                    ParallelScalarProduct& parScalarProduct,
+                                                    ParallelPreconditioner& parPreCond)
+    {
+        if (!solver_) {
+            solver_ = std::make_shared<RawLinearSolver>();
+            solver_->setRestart(static_cast<unsigned>(restart_));
+            solver_->setMaxIterations(static_cast<unsigned>(maxIterations_));
+            solver_->setOrthogonalization(orthogonalization_);
+
+            int verbosity = 0;
+            if (parOperator.overlap().myRank() == 0)
+                verbosity = verbosity_;
+            solver_->setVerbosity(static_cast<unsigned>(verbosity));
+        }
+
+        Scalar linearSolverAbsTolerance = absTolerance_;
+        if (linearSolverAbsTolerance < 0.0)
+            linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance() / 100.0;
+
+        solver_->setTolerance(this->tolerance_);
+        solver_->setAbsTolerance(linearSolverAbsTolerance);
+        solver_->setLinearOperator(&parOperator);
+        solver_->setScalarProduct(&parScalarProduct);
+        solver_->setPreconditioner(&parPreCond);
+        solver_->setRhs(this->overlappingb_);
+
+        return solver_;
+    }
+
+    std::pair<bool,int> runSolver_(std::shared_ptr<RawLinearSolver> solver)
+    {
+        bool converged = solver->apply(*this->overlappingx_);
+        return std::make_pair(converged, int(solver->report().iterations()));
+    }
+
+    void cleanupSolver_()
+    {
+        // the operator, the scalar product and the preconditioner only live during
+        // solve(), but the workspace of the solver is kept
+        solver_->setLinearOperator(nullptr);
+        solver_->setScalarProduct(nullptr);
+        solver_->setPreconditioner(nullptr);
+    }
+
+    void cleanup_()
+    {
+        ParentType::cleanup_();
+
+        // the layout of the vectors changes if the grid changes
+        if (solver_)
+            solver_->releaseWorkspace();
+    }
+
+    std::shared_ptr<RawLinearSolver> solver_;
+
+    Scalar absTolerance_;
+    int verbosity_;
+    int maxIterations_;
+    int restart_;
+    GmresOrthogonalization orthogonalization_;
+};
+
+}} // namespace Linear, Opm
+
+#endif
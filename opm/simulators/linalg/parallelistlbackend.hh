@@ -61,6 +61,8 @@ namespace Opm::Linear {
  * - \c BiCGStab: A stabilized bi-conjugated gradients solver
  * - \c MinRes: A solver based on the  minimized residual algorithm
  * - \c RestartedGMRes: A restarted GMRES solver
+ * - \c RecyclingGMRes: A restarted GMRES solver which deflates the solutions of the
+ *                      previous linear systems
  *
  * Chosing the preconditioner works in an analogous way:
  * \code
@@ -120,9 +122,11 @@ protected:
                                                     ParallelScalarProduct& parScalarProduct,
                                                     ParallelPreconditioner& parPreCond)
     {
+        passRecycleSpace_(solverWrapper_, /*preferRecycling=*/0);
         return solverWrapper_.get(parOperator,
                                   parScalarProduct,
-                                  parPreCond);
+                                  parPreCond,
+                                  this->tolerance_);
     }
 
     void cleanupSolver_()
@@ -137,6 +141,16 @@ protected:
         return std::make_pair(result.converged, result.iterations);
     }
 
+    // hand the recycled space to the solver wrapper if it supports recycling
+    template <class Wrapper>
+    auto passRecycleSpace_(Wrapper& wrapper, int)
+        -> decltype(wrapper.setRecycleSpace(this->recycleSpace_))
+    { wrapper.setRecycleSpace(this->recycleSpace_); }
+
+    template <class Wrapper>
+    void passRecycleSpace_(Wrapper&, long)
+    { }
+
     LinearSolverWrapper solverWrapper_;
 };
 
@@ -166,6 +180,10 @@ struct PreconditionerWrapper<TypeTag, TTag::ParallelIstlLinearSolver>
 template<class TypeTag>
 struct GMResRestart<TypeTag, TTag::ParallelIstlLinearSolver> { static constexpr int value = 10; };
 
+//! keep the solutions of the last five linear systems for the recycling GMRES solver
+template<class TypeTag>
+struct GMResRecycleSize<TypeTag, TTag::ParallelIstlLinearSolver> { static constexpr int value = 5; };
+
 } // namespace Opm::Properties
 
 #endif
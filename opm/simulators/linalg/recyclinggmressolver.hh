@@ -0,0 +1,439 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::RecyclingGmresSolver
+ */
+#ifndef EWOMS_RECYCLING_GMRES_SOLVER_HH
+#define EWOMS_RECYCLING_GMRES_SOLVER_HH
+
+#include "linearsolverreport.hh"
+
+#include <opm/models/utils/timerguard.hh>
+
+#include <dune/istl/solver.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief Stores the subspace which is recycled by the RecyclingGmresSolver between
+ *        solves.
+ *
+ * The space is spanned by the solutions of the most recent linear systems. Since these
+ * are the updates of subsequent Newton iterations, they tend to point into similar
+ * directions, so deflating them speeds up the next solve. If the space is full, the
+ * oldest vector is discarded.
+ *
+ * The object is supposed to be owned by the linear solver backend, so that it survives
+ * the solver objects, which are created for each linear system. It must be cleared if
+ * the layout of the vectors changes, e.g., because the grid was adapted.
+ */
+template <class Vector>
+class KrylovRecycleSpace
+{
+public:
+    explicit KrylovRecycleSpace(unsigned maxSize = 0)
+        : maxSize_(maxSize)
+        , referenceIterations_(-1)
+    {}
+
+    /*!
+     * \brief Set the maximum number of vectors which are kept.
+     */
+    void setMaxSize(unsigned value)
+    {
+        maxSize_ = value;
+        while (vectors_.size() > maxSize_)
+            vectors_.pop_front();
+    }
+
+    /*!
+     * \brief Return the maximum number of vectors which are kept.
+     */
+    unsigned maxSize() const
+    { return maxSize_; }
+
+    /*!
+     * \brief Return the number of vectors which are currently stored.
+     */
+    unsigned size() const
+    { return static_cast<unsigned>(vectors_.size()); }
+
+    /*!
+     * \brief Discard all vectors.
+     */
+    void clear()
+    {
+        vectors_.clear();
+        referenceIterations_ = -1;
+    }
+
+    /*!
+     * \brief Add a vector to the space.
+     *
+     * If the space is already full, the oldest vector is discarded.
+     */
+    void push(const Vector& u)
+    {
+        if (maxSize_ == 0)
+            return;
+
+        if (vectors_.size() >= maxSize_)
+            vectors_.pop_front();
+        vectors_.push_back(u);
+    }
+
+    /*!
+     * \brief Return the vectors which span the space.
+     */
+    std::deque<Vector>& vectors()
+    { return vectors_; }
+
+    /*!
+     * \brief Set the number of iterations needed by the last solve without recycling.
+     *
+     * This is used as the reference which the savings of the subsequent solves are
+     * measured against.
+     */
+    void setReferenceIterations(int value)
+    { referenceIterations_ = value; }
+
+    /*!
+     * \brief Return the number of iterations needed by the last solve without
+     *        recycling or -1 if there was no such solve yet.
+     */
+    int referenceIterations() const
+    { return referenceIterations_; }
+
+private:
+    unsigned maxSize_;
+    int referenceIterations_;
+    std::deque<Vector> vectors_;
+};
+
+/*!
+ * \brief A flexible restarted GMRES solver which recycles a subspace of the solutions
+ *        of previous linear systems.
+ *
+ * This follows the GCRO approach of de Sturler: Given a matrix \f$U\f$ whose columns
+ * span the recycled space, \f$C = A U\f$ is orthonormalized and the part of the residual
+ * in the range of \f$C\f$ is eliminated before the first iteration. Then, the Arnoldi
+ * vectors are kept orthogonal to \f$C\f$, i.e., GMRES operates on the operator
+ * \f$(I - C C^T) A\f$, which has the recycled directions deflated. Since the matrix
+ * changes with each Newton iteration, \f$C\f$ is recomputed at the beginning of each
+ * solve, which costs one application of the operator per recycled vector.
+ *
+ * The preconditioned Arnoldi vectors are stored like in FlexibleGmresSolver, so the
+ * preconditioner is applied from the right and the residual norm which GMRES minimizes
+ * is the one of the unpreconditioned system.
+ */
+template <class LinearOperator, class Vector, class ScalarProduct, class Preconditioner>
+class RecyclingGmresSolver : public Dune::InverseOperator<Vector, Vector>
+{
+    using Scalar = typename Vector::field_type;
+
+public:
+    using RecycleSpace = KrylovRecycleSpace<Vector>;
+
+    RecyclingGmresSolver(LinearOperator& op,
+                         ScalarProduct& scalarProduct,
+                         Preconditioner& preconditioner,
+                         Scalar tolerance,
+                         unsigned restart,
+                         unsigned maxIterations,
+                         int verbosity)
+        : op_(op)
+        , scalarProduct_(scalarProduct)
+        , preconditioner_(preconditioner)
+        , tolerance_(tolerance)
+        , restart_(restart)
+        , maxIterations_(maxIterations)
+        , verbosity_(verbosity)
+        , recycleSpace_(nullptr)
+    {}
+
+    /*!
+     * \brief Set the object which stores the recycled space between solves.
+     *
+     * If no recycle space is set, the solver behaves like a flexible restarted GMRES
+     * solver.
+     */
+    void setRecycleSpace(RecycleSpace* space)
+    { recycleSpace_ = space; }
+
+    //! \copydoc Dune::InverseOperator::apply(X&, Y&, InverseOperatorResult&)
+    void apply(Vector& x, Vector& b, Dune::InverseOperatorResult& res) override
+    {
+        res.clear();
+        res.converged = solve_(x, b);
+        res.iterations = static_cast<int>(report_.iterations());
+        res.reduction = reduction_;
+        res.elapsed = report_.timer().realTimeElapsed();
+    }
+
+    //! \copydoc Dune::InverseOperator::apply(X&, Y&, double, InverseOperatorResult&)
+    void apply(Vector& x, Vector& b, double reduction, Dune::InverseOperatorResult& res) override
+    {
+        Scalar origTolerance = tolerance_;
+        tolerance_ = reduction;
+        apply(x, b, res);
+        tolerance_ = origTolerance;
+    }
+
+    //! the kind of computations supported by the solver
+    Dune::SolverCategory::Category category() const override
+    { return op_.category(); }
+
+    const Opm::Linear::SolverReport& report() const
+    { return report_; }
+
+private:
+    bool solve_(Vector& x, const Vector& b)
+    {
+        report_.reset();
+        Opm::TimerGuard reportTimerGuard(report_.timer());
+        report_.timer().start();
+
+        x = 0.0;
+        Vector r(b);
+        preconditioner_.pre(x, r);
+
+        Scalar initialDefect = scalarProduct_.norm(r);
+        reduction_ = 0.0;
+        if (initialDefect == 0.0) {
+            report_.setConverged(true);
+            return true;
+        }
+        Scalar targetDefect = tolerance_*initialDefect;
+
+        // eliminate the part of the residual which is in the range of the recycled
+        // space: x = U C^T r, r = r - C C^T r
+        unsigned k = prepareRecycleSpace_();
+        std::vector<Vector>& C = images_;
+        for (unsigned i = 0; i < k; ++i) {
+            Scalar alpha = scalarProduct_.dot(C[i], r);
+            x.axpy(alpha, U_(i));
+            r.axpy(-alpha, C[i]);
+        }
+        Scalar beta = scalarProduct_.norm(r);
+
+        std::vector<Vector> V(restart_ + 1, b);
+        std::vector<Vector> Z(restart_, b);
+        std::vector<std::vector<Scalar> > H(restart_ + 1, std::vector<Scalar>(restart_, 0.0));
+        std::vector<std::vector<Scalar> > B(k, std::vector<Scalar>(restart_, 0.0));
+        std::vector<Scalar> g(restart_ + 1);
+        std::vector<Scalar> cs(restart_);
+        std::vector<Scalar> sn(restart_);
+        std::vector<Scalar> y(restart_);
+
+        bool converged = beta <= targetDefect;
+        while (!converged && report_.iterations() < maxIterations_) {
+            V[0] = r;
+            V[0] *= 1.0/beta;
+            std::fill(g.begin(), g.end(), 0.0);
+            g[0] = beta;
+
+            unsigned m = 0;
+            for (unsigned j = 0; j < restart_ && report_.iterations() < maxIterations_; ++j) {
+                Z[j] = 0.0;
+                preconditioner_.apply(Z[j], V[j]);
+                op_.apply(Z[j], V[j + 1]);
+
+                // keep the Krylov space orthogonal to the range of the recycled space
+                Vector& w = V[j + 1];
+                for (unsigned i = 0; i < k; ++i) {
+                    B[i][j] = scalarProduct_.dot(C[i], w);
+                    w.axpy(-B[i][j], C[i]);
+                }
+
+                // modified Gram-Schmidt orthogonalization
+                for (unsigned i = 0; i <= j; ++i) {
+                    H[i][j] = scalarProduct_.dot(V[i], w);
+                    w.axpy(-H[i][j], V[i]);
+                }
+                H[j + 1][j] = scalarProduct_.norm(w);
+                if (H[j + 1][j] > 0.0)
+                    w *= 1.0/H[j + 1][j];
+
+                // apply the previous Givens rotations to the new column of the Hessenberg
+                // matrix and compute a new one which eliminates its subdiagonal entry
+                for (unsigned i = 0; i < j; ++i) {
+                    Scalar tmp = cs[i]*H[i][j] + sn[i]*H[i + 1][j];
+                    H[i + 1][j] = -sn[i]*H[i][j] + cs[i]*H[i + 1][j];
+                    H[i][j] = tmp;
+                }
+                Scalar denom = std::sqrt(H[j][j]*H[j][j] + H[j + 1][j]*H[j + 1][j]);
+                cs[j] = (denom > 0.0) ? H[j][j]/denom : 1.0;
+                sn[j] = (denom > 0.0) ? H[j + 1][j]/denom : 0.0;
+                H[j][j] = denom;
+                H[j + 1][j] = 0.0;
+                g[j + 1] = -sn[j]*g[j];
+                g[j] = cs[j]*g[j];
+
+                report_.increment();
+                m = j + 1;
+                converged = std::abs(g[j + 1]) <= targetDefect;
+                if (verbosity_ > 1)
+                    std::cout << "RecyclingGmresSolver: iteration " << report_.iterations()
+                              << ", defect " << std::abs(g[j + 1]) << "\n";
+                if (converged || denom == 0.0)
+                    break;
+            }
+
+            // solve the upper triangular system
+            for (int i = static_cast<int>(m) - 1; i >= 0; --i) {
+                y[i] = g[i];
+                for (unsigned l = static_cast<unsigned>(i) + 1; l < m; ++l)
+                    y[i] -= H[i][l]*y[l];
+                // a vanishing diagonal entry means that the Krylov space does not
+                // contain any further information
+                y[i] = (H[i][i] != 0.0) ? y[i]/H[i][i] : 0.0;
+            }
+
+            // x = x + Z y - U B y. the second term removes the components of A Z y which
+            // were projected onto the range of the recycled space
+            for (unsigned j = 0; j < m; ++j)
+                x.axpy(y[j], Z[j]);
+            for (unsigned i = 0; i < k; ++i) {
+                Scalar alpha = 0.0;
+                for (unsigned j = 0; j < m; ++j)
+                    alpha += B[i][j]*y[j];
+                x.axpy(-alpha, U_(i));
+            }
+
+            if (m == 0 || (!converged && H[m - 1][m - 1] == 0.0))
+                // breakdown: the Krylov space cannot be extended anymore
+                break;
+
+            // restart using the true residual
+            r = b;
+            op_.applyscaleadd(-1.0, x, r);
+            beta = scalarProduct_.norm(r);
+            converged = beta <= targetDefect;
+            reduction_ = beta/initialDefect;
+        }
+
+        if (converged && reduction_ == 0.0)
+            reduction_ = tolerance_;
+
+        preconditioner_.post(x);
+        updateRecycleSpace_(x, k);
+
+        report_.setConverged(converged);
+        return converged;
+    }
+
+    // compute the images of the recycled vectors under the current operator and
+    // orthonormalize them. the recycled vectors are transformed in the same way, so
+    // that C = A U still holds. vectors which are linearly dependent on the others are
+    // discarded.
+    unsigned prepareRecycleSpace_()
+    {
+        images_.clear();
+        if (!recycleSpace_)
+            return 0;
+
+        auto& U = recycleSpace_->vectors();
+        for (auto it = U.begin(); it != U.end();) {
+            Vector c(*it);
+            op_.apply(*it, c);
+
+            Scalar origNorm = scalarProduct_.norm(c);
+            for (unsigned i = 0; i < images_.size(); ++i) {
+                Scalar h = scalarProduct_.dot(images_[i], c);
+                c.axpy(-h, images_[i]);
+                it->axpy(-h, U[i]);
+            }
+
+            Scalar nrm = scalarProduct_.norm(c);
+            if (!(nrm > 1e3*std::numeric_limits<Scalar>::epsilon()*origNorm)) {
+                it = U.erase(it);
+                continue;
+            }
+
+            c *= 1.0/nrm;
+            *it *= 1.0/nrm;
+            images_.push_back(c);
+            ++it;
+        }
+
+        return static_cast<unsigned>(images_.size());
+    }
+
+    // add the solution to the recycled space and record the savings of the current
+    // solve
+    void updateRecycleSpace_(const Vector& x, unsigned k)
+    {
+        images_.clear();
+        if (!recycleSpace_)
+            return;
+
+        int iterations = static_cast<int>(report_.iterations());
+        report_.setRecycleSpaceSize(k);
+        if (k == 0)
+            recycleSpace_->setReferenceIterations(iterations);
+        else if (recycleSpace_->referenceIterations() >= 0)
+            report_.setSavedIterations(recycleSpace_->referenceIterations() - iterations);
+
+        if (verbosity_ > 0)
+            std::cout << "RecyclingGmresSolver: " << iterations << " iterations, "
+                      << "recycled space of dimension " << k << ", "
+                      << report_.savedIterations() << " iterations saved\n";
+
+        Scalar nrm = scalarProduct_.norm(x);
+        if (nrm > 0.0) {
+            recycleSpace_->push(x);
+            recycleSpace_->vectors().back() *= 1.0/nrm;
+        }
+    }
+
+    Vector& U_(unsigned i)
+    { return recycleSpace_->vectors()[i]; }
+
+    LinearOperator& op_;
+    ScalarProduct& scalarProduct_;
+    Preconditioner& preconditioner_;
+    Scalar tolerance_;
+    unsigned restart_;
+    unsigned maxIterations_;
+    int verbosity_;
+
+    RecycleSpace* recycleSpace_;
+    std::vector<Vector> images_;
+
+    Opm::Linear::SolverReport report_;
+    Scalar reduction_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -0,0 +1,165 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::ScalarCsrMatrix
+ */
+#ifndef EWOMS_SCALAR_CSR_MATRIX_HH
+#define EWOMS_SCALAR_CSR_MATRIX_HH
+
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief The scalar matrix which results from expanding the blocks of a BCRS matrix,
+ *        in compressed row storage.
+ *
+ * This is used to pass block matrices to direct solvers. The structure of the matrix
+ * only needs to be created once for a given sparsity pattern; afterwards, the values
+ * can be updated in place. The values are always stored in double precision.
+ *
+ * \tparam Index The integer type which the direct solver uses for indices
+ */
+template <class Index>
+class ScalarCsrMatrix
+{
+public:
+    ScalarCsrMatrix()
+        : numBlockRows_(0)
+        , numBlockNonZeros_(0)
+    {}
+
+    /*!
+     * \brief Returns true if the structure has been created for a block matrix
+     *        with the same number of rows and non-zero blocks.
+     */
+    template <class BlockMatrix>
+    bool patternMatches(const BlockMatrix& M) const
+    {
+        return !rowStart_.empty()
+            && numBlockRows_ == M.N()
+            && numBlockNonZeros_ == M.nonzeroes();
+    }
+
+    /*!
+     * \brief Create the sparsity pattern of the scalar matrix.
+     *
+     * The values are left undefined, call assignValues() to set them.
+     */
+    template <class BlockMatrix>
+    void createStructure(const BlockMatrix& M)
+    {
+        using MatrixBlock = typename BlockMatrix::block_type;
+        static constexpr int blockRows = MatrixBlock::rows;
+        static constexpr int blockCols = MatrixBlock::cols;
+
+        numBlockRows_ = M.N();
+        numBlockNonZeros_ = M.nonzeroes();
+
+        size_t numRows = numBlockRows_*blockRows;
+        size_t numNonZeros = numBlockNonZeros_*blockRows*blockCols;
+        rowStart_.resize(numRows + 1);
+        colIndices_.resize(numNonZeros);
+        values_.resize(numNonZeros);
+
+        size_t rowIdx = 0;
+        size_t nzIdx = 0;
+        rowStart_[0] = 0;
+        for (auto rowIt = M.begin(); rowIt != M.end(); ++rowIt) {
+            for (int i = 0; i < blockRows; ++i) {
+                for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt)
+                    for (int j = 0; j < blockCols; ++j)
+                        colIndices_[nzIdx++] = static_cast<Index>(colIt.index()*blockCols + j);
+                rowStart_[++rowIdx] = static_cast<Index>(nzIdx);
+            }
+        }
+    }
+
+    /*!
+     * \brief Copy the values of a block matrix which has the pattern for which the
+     *        structure has been created.
+     */
+    template <class BlockMatrix>
+    void assignValues(const BlockMatrix& M)
+    {
+        using MatrixBlock = typename BlockMatrix::block_type;
+        static constexpr int blockRows = MatrixBlock::rows;
+        static constexpr int blockCols = MatrixBlock::cols;
+
+        size_t nzIdx = 0;
+        for (auto rowIt = M.begin(); rowIt != M.end(); ++rowIt) {
+            for (int i = 0; i < blockRows; ++i) {
+                for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt) {
+                    const auto& block = *colIt;
+                    for (int j = 0; j < blockCols; ++j)
+                        values_[nzIdx++] = static_cast<double>(block[i][j]);
+                }
+            }
+        }
+    }
+
+    /*!
+     * \brief Discard the structure of the matrix.
+     */
+    void clear()
+    {
+        numBlockRows_ = 0;
+        numBlockNonZeros_ = 0;
+        rowStart_.clear();
+        colIndices_.clear();
+        values_.clear();
+    }
+
+    size_t numRows() const
+    { return rowStart_.empty() ? 0 : rowStart_.size() - 1; }
+
+    size_t numNonZeros() const
+    { return values_.size(); }
+
+    Index* rowStart()
+    { return rowStart_.data(); }
+
+    Index* colIndices()
+    { return colIndices_.data(); }
+
+    double* values()
+    { return values_.data(); }
+
+private:
+    size_t numBlockRows_;
+    size_t numBlockNonZeros_;
+
+    std::vector<Index> rowStart_;
+    std::vector<Index> colIndices_;
+    std::vector<double> values_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
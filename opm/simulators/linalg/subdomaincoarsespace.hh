@@ -0,0 +1,332 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::SubdomainCoarseSpace
+ */
+#ifndef EWOMS_SUBDOMAIN_COARSE_SPACE_HH
+#define EWOMS_SUBDOMAIN_COARSE_SPACE_HH
+
+#if HAVE_SUITESPARSE_UMFPACK
+#include <opm/simulators/linalg/umfpackbackend.hh>
+#endif
+
+#include <opm/material/common/Exceptions.hpp>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief The coarse space of a two-level additive Schwarz preconditioner which
+ *        consists of one aggregate per process.
+ *
+ * The restriction sums up the entries of all indices for which a process is master,
+ * i.e., each subdomain contributes a single block to the coarse problem. The coarse
+ * matrix is the Galerkin product of the overlapping matrix with these aggregates. It
+ * has one block row per process and is assembled and factorized redundantly on all
+ * processes, which only requires each process to communicate the couplings of its
+ * subdomain to its peers. UMFPACK is used for the factorization if it is available,
+ * otherwise the expanded coarse matrix is factorized as a dense matrix, which is only
+ * sensible for moderate numbers of processes.
+ *
+ * The coarse correction transports information across the whole domain in each
+ * application of the preconditioner, so that the number of iterations of the linear
+ * solver does not grow with the number of subdomains as it does for one-level Schwarz
+ * methods.
+ */
+template <class OverlappingMatrix, class OverlappingVector>
+class SubdomainCoarseSpace
+{
+    using Overlap = typename OverlappingMatrix::Overlap;
+    using VectorBlock = typename OverlappingVector::block_type;
+    using Scalar = typename VectorBlock::field_type;
+
+    static constexpr int blockSize = VectorBlock::dimension;
+
+    using CoarseBlock = Dune::FieldMatrix<Scalar, blockSize, blockSize>;
+    using CoarseMatrix = Dune::BCRSMatrix<CoarseBlock>;
+    using CoarseVector = Dune::BlockVector<VectorBlock>;
+
+public:
+    SubdomainCoarseSpace()
+        : overlap_(nullptr)
+        , numRanks_(1)
+    {}
+
+    /*!
+     * \brief Returns true if the coarse space has an effect.
+     *
+     * This is not the case for sequential runs because the one-level preconditioner is
+     * then applied to the whole domain.
+     */
+    bool active() const
+    { return numRanks_ > 1; }
+
+    /*!
+     * \brief Assemble and factorize the coarse matrix.
+     *
+     * This is a collective operation, i.e., it must be called on all processes.
+     *
+     * \param A The overlapping matrix whose rows are complete for all indices for which
+     *          the current process is master
+     */
+    void update(const OverlappingMatrix& A)
+    {
+        overlap_ = &A.overlap();
+        numRanks_ = 1;
+#if HAVE_MPI
+        MPI_Comm_size(MPI_COMM_WORLD, &numRanks_);
+#endif
+        if (!active())
+            return;
+
+        // the row of the coarse matrix which belongs to the current process
+        std::map<int, CoarseBlock> localCoarseRow;
+        localCoarseRow[overlap_->myRank()] = 0.0;
+        const auto& endRowIt = A.end();
+        for (auto rowIt = A.begin(); rowIt != endRowIt; ++rowIt) {
+            auto rowIdx = static_cast<typename Overlap::Index>(rowIt.index());
+            if (!overlap_->iAmMasterOf(rowIdx))
+                continue;
+
+            const auto& endColIt = rowIt->end();
+            for (auto colIt = rowIt->begin(); colIt != endColIt; ++colIt) {
+                auto colIdx = static_cast<typename Overlap::Index>(colIt.index());
+                auto it = localCoarseRow.find(overlap_->masterRank(colIdx));
+                if (it == localCoarseRow.end())
+                    it = localCoarseRow.emplace(overlap_->masterRank(colIdx), CoarseBlock(0.0)).first;
+                for (int i = 0; i < blockSize; ++i)
+                    for (int j = 0; j < blockSize; ++j)
+                        it->second[i][j] += (*colIt)[i][j];
+            }
+        }
+
+        // each entry is sent as the rank of its column followed by its values
+        constexpr int entrySize = 1 + blockSize*blockSize;
+        std::vector<double> sendBuffer;
+        sendBuffer.reserve(localCoarseRow.size()*entrySize);
+        for (const auto& [colRank, block] : localCoarseRow) {
+            sendBuffer.push_back(colRank);
+            for (int i = 0; i < blockSize; ++i)
+                for (int j = 0; j < blockSize; ++j)
+                    sendBuffer.push_back(static_cast<double>(block[i][j]));
+        }
+
+        std::vector<int> recvSizes(static_cast<size_t>(numRanks_));
+        std::vector<int> recvOffsets(static_cast<size_t>(numRanks_));
+        std::vector<double> recvBuffer;
+#if HAVE_MPI
+        int sendSize = static_cast<int>(sendBuffer.size());
+        MPI_Allgather(&sendSize, 1, MPI_INT, recvSizes.data(), 1, MPI_INT, MPI_COMM_WORLD);
+        std::exclusive_scan(recvSizes.begin(), recvSizes.end(), recvOffsets.begin(), 0);
+        recvBuffer.resize(static_cast<size_t>(recvOffsets.back() + recvSizes.back()));
+        MPI_Allgatherv(sendBuffer.data(), sendSize, MPI_DOUBLE,
+                       recvBuffer.data(), recvSizes.data(), recvOffsets.data(), MPI_DOUBLE,
+                       MPI_COMM_WORLD);
+#endif
+
+        // assemble the coarse matrix from the rows of all processes
+        size_t n = static_cast<size_t>(numRanks_);
+        coarseMatrix_ = CoarseMatrix(n, n, CoarseMatrix::random);
+        for (size_t rank = 0; rank < n; ++rank)
+            coarseMatrix_.setrowsize(rank, static_cast<size_t>(recvSizes[rank]/entrySize));
+        coarseMatrix_.endrowsizes();
+        for (size_t rank = 0; rank < n; ++rank)
+            for (int pos = recvOffsets[rank]; pos < recvOffsets[rank] + recvSizes[rank]; pos += entrySize)
+                coarseMatrix_.addindex(rank, static_cast<size_t>(recvBuffer[static_cast<size_t>(pos)]));
+        coarseMatrix_.endindices();
+        for (size_t rank = 0; rank < n; ++rank) {
+            for (int pos = recvOffsets[rank]; pos < recvOffsets[rank] + recvSizes[rank]; pos += entrySize) {
+                size_t colRank = static_cast<size_t>(recvBuffer[static_cast<size_t>(pos)]);
+                auto& block = coarseMatrix_[rank][colRank];
+                for (int i = 0; i < blockSize; ++i)
+                    for (int j = 0; j < blockSize; ++j)
+                        block[i][j] = static_cast<Scalar>(recvBuffer[static_cast<size_t>(pos + 1 + i*blockSize + j)]);
+            }
+        }
+
+        factorize_();
+        coarseRhs_.resize(n);
+        coarseSolution_.resize(n);
+    }
+
+    /*!
+     * \brief Add the coarse correction for a defect to a vector.
+     *
+     * This is a collective operation. The correction is consistent on all processes,
+     * so the overlap of the vector does not need to be synchronized afterwards.
+     */
+    void apply(OverlappingVector& x, const OverlappingVector& d)
+    {
+        if (!active())
+            return;
+
+        // restrict the defect to the aggregate of the current process
+        VectorBlock localRhs(0.0);
+        size_t numDomestic = static_cast<size_t>(overlap_->numDomestic());
+        for (size_t domIdx = 0; domIdx < numDomestic; ++domIdx)
+            if (overlap_->iAmMasterOf(static_cast<typename Overlap::Index>(domIdx)))
+                localRhs += d[domIdx];
+
+#if HAVE_MPI
+        double sendBuffer[blockSize];
+        std::vector<double> recvBuffer(static_cast<size_t>(numRanks_*blockSize));
+        for (int i = 0; i < blockSize; ++i)
+            sendBuffer[i] = static_cast<double>(localRhs[i]);
+        MPI_Allgather(sendBuffer, blockSize, MPI_DOUBLE,
+                      recvBuffer.data(), blockSize, MPI_DOUBLE,
+                      MPI_COMM_WORLD);
+        for (size_t rank = 0; rank < coarseRhs_.size(); ++rank)
+            for (int i = 0; i < blockSize; ++i)
+                coarseRhs_[rank][i] = static_cast<Scalar>(recvBuffer[rank*blockSize + static_cast<size_t>(i)]);
+#endif
+
+        if (!solve_())
+            throw Opm::NumericalIssue("The coarse problem of the two-level Schwarz "
+                                      "preconditioner could not be solved");
+
+        // prolongate the coarse solution, i.e., the correction of each index is the one
+        // of the aggregate of its master
+        for (size_t domIdx = 0; domIdx < numDomestic; ++domIdx) {
+            auto rank = overlap_->masterRank(static_cast<typename Overlap::Index>(domIdx));
+            x[domIdx] += coarseSolution_[static_cast<size_t>(rank)];
+        }
+    }
+
+private:
+#if HAVE_SUITESPARSE_UMFPACK
+    void factorize_()
+    {
+        if (!coarseSolver_)
+            coarseSolver_ = std::make_unique<BlockUmfPack<CoarseMatrix, CoarseVector> >();
+        coarseSolver_->setMatrix(coarseMatrix_);
+    }
+
+    bool solve_()
+    { return coarseSolver_->solve(coarseSolution_, coarseRhs_); }
+#else
+    // LU decomposition with partial pivoting of the expanded coarse matrix
+    void factorize_()
+    {
+        size_t n = coarseMatrix_.N()*blockSize;
+        luFactors_.assign(n*n, 0.0);
+        pivots_.resize(n);
+        const auto& endRowIt = coarseMatrix_.end();
+        for (auto rowIt = coarseMatrix_.begin(); rowIt != endRowIt; ++rowIt) {
+            const auto& endColIt = rowIt->end();
+            for (auto colIt = rowIt->begin(); colIt != endColIt; ++colIt)
+                for (int i = 0; i < blockSize; ++i)
+                    for (int j = 0; j < blockSize; ++j)
+                        luFactors_[(rowIt.index()*blockSize + i)*n + colIt.index()*blockSize + j] =
+                            (*colIt)[i][j];
+        }
+
+        for (size_t k = 0; k < n; ++k) {
+            size_t pivotIdx = k;
+            for (size_t i = k + 1; i < n; ++i)
+                if (std::abs(luFactors_[i*n + k]) > std::abs(luFactors_[pivotIdx*n + k]))
+                    pivotIdx = i;
+            pivots_[k] = pivotIdx;
+            if (pivotIdx != k)
+                for (size_t j = 0; j < n; ++j)
+                    std::swap(luFactors_[k*n + j], luFactors_[pivotIdx*n + j]);
+
+            Scalar pivot = luFactors_[k*n + k];
+            if (pivot == 0.0)
+                continue; // singular coarse matrix. this is detected when solving
+
+            for (size_t i = k + 1; i < n; ++i) {
+                Scalar factor = luFactors_[i*n + k] /= pivot;
+                if (factor == 0.0)
+                    continue;
+                for (size_t j = k + 1; j < n; ++j)
+                    luFactors_[i*n + j] -= factor*luFactors_[k*n + j];
+            }
+        }
+    }
+
+    bool solve_()
+    {
+        size_t n = pivots_.size();
+        std::vector<Scalar> y(n);
+        for (size_t i = 0; i < n; ++i)
+            y[i] = coarseRhs_[i/blockSize][i%blockSize];
+
+        // the rows of the factors have been swapped as a whole, so all permutations
+        // need to be applied before the forward substitution
+        for (size_t k = 0; k < n; ++k)
+            std::swap(y[k], y[pivots_[k]]);
+        for (size_t k = 0; k < n; ++k)
+            for (size_t i = k + 1; i < n; ++i)
+                y[i] -= luFactors_[i*n + k]*y[k];
+
+        bool finite = true;
+        for (size_t k = n; k-- > 0; ) {
+            for (size_t j = k + 1; j < n; ++j)
+                y[k] -= luFactors_[k*n + j]*y[j];
+            y[k] /= luFactors_[k*n + k];
+            finite = finite && std::isfinite(y[k]);
+        }
+
+        for (size_t i = 0; i < n; ++i)
+            coarseSolution_[i/blockSize][i%blockSize] = y[i];
+        return finite;
+    }
+#endif
+
+    const Overlap* overlap_;
+    int numRanks_;
+
+    CoarseMatrix coarseMatrix_;
+    CoarseVector coarseRhs_;
+    CoarseVector coarseSolution_;
+
+#if HAVE_SUITESPARSE_UMFPACK
+    std::unique_ptr<BlockUmfPack<CoarseMatrix, CoarseVector> > coarseSolver_;
+#else
+    std::vector<Scalar> luFactors_;
+    std::vector<size_t> pivots_;
+#endif
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
@@ -29,7 +29,8 @@
 
 #if HAVE_SUPERLU
 
-#include <opm/models/linear/istlsparsematrixbackend.hh>
+#include <opm/simulators/linalg/istlsparsematrixadapter.hh>
+#include <opm/simulators/linalg/scalarcsrmatrix.hh>
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 
@@ -39,18 +40,26 @@
 #include <dune/common/fmatrix.hh>
 #include <dune/common/version.hh>
 
+#include <cmath>
+#include <vector>
+
 namespace Opm::Properties::TTag {
 struct SuperLULinearSolver {};
 } // namespace Opm::Properties::TTag
 
 namespace Opm {
 namespace Linear {
-template <class Scalar, class TypeTag, class Matrix, class Vector>
-class SuperLUSolve_;
+template <class Matrix, class Vector>
+class SuperLUFactorization_;
 
 /*!
  * \ingroup Linear
  * \brief A linear solver backend for the SuperLU sparse matrix library.
+ *
+ * The sparsity pattern of the Jacobian matrix does not change between Newton
+ * iterations, so the column permutation and the symbolic factorization are only
+ * computed for the first linear system. For the following ones, the numeric
+ * factorization is redone using the permutations of the previous one.
  */
 template <class TypeTag>
 class SuperLUBackend
@@ -58,13 +67,16 @@ class SuperLUBackend
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
-    using Matrix = typename SparseMatrixAdapter::block_type;
+    using Vector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using Matrix = typename SparseMatrixAdapter::IstlMatrix;
 
-    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock>::value,
+    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
                   "The SuperLU linear solver backend requires the IstlSparseMatrixAdapter");
 
 public:
     SuperLUBackend(Simulator& simulator OPM_UNUSED)
+        : factorization_(EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity))
     {}
 
     static void registerParameters()
@@ -77,12 +89,34 @@ public:
      * \brief Causes the solve() method to discared the structure of the linear system of
      *        equations the next time it is called.
      *
-     * Since the SuperLU backend does not create any internal matrices, this is a no-op.
+     * This discards the permutations and the symbolic factorization of the matrix.
      */
     void eraseMatrix()
+    { factorization_.clear(); }
+
+    /*!
+     * \brief Set the reduction of the residual which the linear solver needs to achieve.
+     *
+     * SuperLU is a direct solver, so this is a no-op.
+     */
+    void setTolerance(Scalar tolerance OPM_UNUSED)
     { }
 
-    void prepare(const SparseMatrixAdapter& M, const Vector& b)
+    /*!
+     * \brief Return the reduction of the residual which the linear solver achieves.
+     */
+    Scalar tolerance() const
+    { return 0.0; }
+
+    void prepare(const SparseMatrixAdapter& M OPM_UNUSED, const Vector& b OPM_UNUSED)
+    { }
+
+    /*!
+     * \brief Record the memory held by the linear solver with the MemoryAccounting.
+     *
+     * The memory of the factorization is managed by SuperLU and is not accounted for.
+     */
+    void recordMemoryUsage() const
     { }
 
     void setResidual(const Vector& b)
@@ -91,81 +125,226 @@ public:
     void getResidual(Vector& b) const
     { b = *b_; }
 
+    /*!
+     * \brief Sets the values of the residual's Jacobian matrix.
+     *
+     * The matrix is factorized by the next call of solve(). If this is not called
+     * between two solves, the factorization of the previous one is reused.
+     */
     void setMatrix(const SparseMatrixAdapter& M)
-    { M_ = &M; }
+    { factorization_.setMatrix(M.istlMatrix()); }
 
     bool solve(Vector& x)
-    { return SuperLUSolve_<Scalar, TypeTag, Matrix, Vector>::solve_(*M_, x, *b_); }
+    { return factorization_.solve(x, *b_); }
 
 private:
-    const Matrix* M_;
-    Vector* b_;
+    SuperLUFactorization_<Matrix, Vector> factorization_;
+    const Vector* b_;
 };
 
-template <class Scalar, class TypeTag, class Matrix, class Vector>
-class SuperLUSolve_
+/*!
+ * \brief Keeps the LU factorization of a block matrix computed by SuperLU.
+ *
+ * The blocks are expanded to a scalar matrix in compressed row storage, which is
+ * passed to SuperLU as the compressed column storage of the transposed matrix. Since
+ * SuperLU is only used in double precision, all other number types are converted.
+ */
+template <class Matrix, class Vector>
+class SuperLUFactorization_
 {
+    using VectorBlock = typename Vector::block_type;
+    using Scalar = typename VectorBlock::field_type;
+
+    static constexpr int blockRows = VectorBlock::dimension;
+
 public:
-    static bool solve_(const Matrix& A, Vector& x, const Vector& b)
+    explicit SuperLUFactorization_(int verbosity)
+        : verbosity_(verbosity)
+        , haveStructure_(false)
+        , haveFactorization_(false)
+        , matrixChanged_(false)
+    {
+        set_default_options(&options_);
+        options_.Trans = TRANS;
+        options_.PrintStat = (verbosity_ > 0) ? YES : NO;
+    }
+
+    SuperLUFactorization_(const SuperLUFactorization_&) = delete;
+
+    ~SuperLUFactorization_()
+    { clear(); }
+
+    /*!
+     * \brief Discard the structure of the matrix and its factorization.
+     */
+    void clear()
+    {
+        freeFactorization_();
+        if (haveStructure_)
+            Destroy_SuperMatrix_Store(&A_);
+        haveStructure_ = false;
+        matrixChanged_ = false;
+    }
+
+    /*!
+     * \brief Copy the values of a matrix.
+     *
+     * If the number of rows and of non-zero blocks is the same as for the previous
+     * matrix, its sparsity pattern is assumed to be unchanged.
+     */
+    void setMatrix(const Matrix& M)
     {
-        Vector bTmp(b);
-
-        int verbosity = EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity);
-        Dune::InverseOperatorResult result;
-        Dune::SuperLU<Matrix> solver(A, verbosity > 0);
-        solver.apply(x, bTmp, result);
-
-        if (result.converged) {
-            // make sure that the result only contains finite values.
-            Scalar tmp = 0;
-            for (unsigned i = 0; i < x.size(); ++i) {
-                const auto& xi = x[i];
-                for (unsigned j = 0; j < Vector::block_type::dimension; ++j)
-                    tmp += xi[j];
+        if (!haveStructure_ || !csrMatrix_.patternMatches(M))
+            createStructure_(M);
+
+        csrMatrix_.assignValues(M);
+        matrixChanged_ = true;
+    }
+
+    /*!
+     * \brief Solve the linear system of equations for a given right hand side.
+     *
+     * If the matrix was changed since the last call, it is factorized first.
+     */
+    bool solve(Vector& x, const Vector& b)
+    {
+        if (!haveStructure_)
+            throw std::logic_error("SuperLU: solve() called before setMatrix()");
+
+        int n = static_cast<int>(rhs_.size());
+        for (size_t blockIdx = 0; blockIdx < b.size(); ++blockIdx)
+            for (int i = 0; i < blockRows; ++i)
+                rhs_[blockIdx*blockRows + i] = static_cast<double>(b[blockIdx][i]);
+
+        int info = 0;
+        if (matrixChanged_) {
+            // reuse the permutations and the structure of L and U if possible
+            options_.Fact = haveFactorization_ ? SamePattern_SameRowPerm : DOFACT;
+            info = gssvx_();
+            if (info > 0 && info <= n && options_.Fact == SamePattern_SameRowPerm) {
+                // the pivots of the previous factorization do not work for the new
+                // matrix anymore
+                freeFactorization_();
+                options_.Fact = DOFACT;
+                info = gssvx_();
+            }
+            // L and U are allocated unless SuperLU ran out of memory. if the
+            // matrix is singular, the next solve factorizes it again.
+            haveFactorization_ = info <= n + 1;
+            matrixChanged_ = info > 0 && info <= n;
+        }
+        else {
+            options_.Fact = FACTORED;
+            info = gssvx_();
+        }
+
+        // info == n + 1 means that the matrix is singular to working precision, but a
+        // solution has been computed anyway
+        if (info != 0 && info != n + 1)
+            return false;
+
+        bool finite = true;
+        for (size_t blockIdx = 0; blockIdx < x.size(); ++blockIdx) {
+            for (int i = 0; i < blockRows; ++i) {
+                double value = solution_[blockIdx*blockRows + i];
+                finite = finite && std::isfinite(value);
+                x[blockIdx][i] = static_cast<Scalar>(value);
             }
-            result.converged = std::isfinite(tmp);
         }
 
-        return result.converged;
+        return finite;
     }
-};
 
-// the following is required to make the SuperLU adapter of dune-istl happy with
-// quadruple precision math on Dune 2.4. this is because the most which SuperLU can
-// handle is double precision (i.e., the linear systems of equations are always solved
-// with at most double precision if chosing SuperLU as the linear solver...)
-#if HAVE_QUAD
-template <class TypeTag, class Matrix, class Vector>
-class SuperLUSolve_<__float128, TypeTag, Matrix, Vector>
-{
-public:
-    static bool solve_(const Matrix& A,
-                       Vector& x,
-                       const Vector& b)
+private:
+    void createStructure_(const Matrix& M)
     {
-        static const int numEq = getPropValue<TypeTag, Properties::NumEq>();
-        using DoubleEqVector = Dune::FieldVector<double, numEq>;
-        using DoubleEqMatrix = Dune::FieldMatrix<double, numEq, numEq>;
-        using DoubleVector = Dune::BlockVector<DoubleEqVector>;
-        using DoubleMatrix = Dune::BCRSMatrix<DoubleEqMatrix>;
-
-        // copy the inputs into the double precision data structures
-        DoubleVector bDouble(b);
-        DoubleVector xDouble(x);
-        DoubleMatrix ADouble(A);
-
-        bool res =
-            SuperLUSolve_<double, TypeTag, Matrix, Vector>::solve_(ADouble,
-                                                                   xDouble,
-                                                                   bDouble);
-
-        // copy the result back into the quadruple precision vector.
-        x = xDouble;
-
-        return res;
+        clear();
+        csrMatrix_.createStructure(M);
+
+        size_t numRows = csrMatrix_.numRows();
+        int n = static_cast<int>(numRows);
+        dCreate_CompCol_Matrix(&A_, n, n, static_cast<int>(csrMatrix_.numNonZeros()),
+                               csrMatrix_.values(), csrMatrix_.colIndices(), csrMatrix_.rowStart(),
+                               SLU_NC, SLU_D, SLU_GE);
+
+        permC_.resize(numRows);
+        permR_.resize(numRows);
+        etree_.resize(numRows);
+        rowScale_.resize(numRows);
+        colScale_.resize(numRows);
+        rhs_.resize(numRows);
+        solution_.resize(numRows);
+        haveStructure_ = true;
     }
-};
+
+    void freeFactorization_()
+    {
+        if (!haveFactorization_)
+            return;
+
+        Destroy_SuperNode_Matrix(&L_);
+        Destroy_CompCol_Matrix(&U_);
+        haveFactorization_ = false;
+    }
+
+    // call the expert driver of SuperLU. this factorizes the matrix unless
+    // options_.Fact is FACTORED, and solves the system for the right hand side
+    int gssvx_()
+    {
+        int n = static_cast<int>(rhs_.size());
+        SuperMatrix B;
+        SuperMatrix X;
+        dCreate_Dense_Matrix(&B, n, 1, rhs_.data(), n, SLU_DN, SLU_D, SLU_GE);
+        dCreate_Dense_Matrix(&X, n, 1, solution_.data(), n, SLU_DN, SLU_D, SLU_GE);
+
+        SuperLUStat_t stat;
+        StatInit(&stat);
+
+        double rpg, rcond, ferr, berr;
+        mem_usage_t memUsage;
+        int info = 0;
+        dgssvx(&options_, &A_, permC_.data(), permR_.data(), etree_.data(), &equed_,
+               rowScale_.data(), colScale_.data(), &L_, &U_, /*work=*/nullptr, /*lwork=*/0,
+               &B, &X, &rpg, &rcond, &ferr, &berr,
+#if SUPERLU_MIN_VERSION_5
+               &globalLU_,
+#endif
+               &memUsage, &stat, &info);
+
+        if (verbosity_ > 0)
+            StatPrint(&stat);
+        StatFree(&stat);
+
+        Destroy_SuperMatrix_Store(&B);
+        Destroy_SuperMatrix_Store(&X);
+
+        return info;
+    }
+
+    int verbosity_;
+    bool haveStructure_;
+    bool haveFactorization_;
+    bool matrixChanged_;
+
+    ScalarCsrMatrix<int> csrMatrix_;
+
+    std::vector<double> rhs_;
+    std::vector<double> solution_;
+
+    superlu_options_t options_;
+    SuperMatrix A_;
+    SuperMatrix L_;
+    SuperMatrix U_;
+#if SUPERLU_MIN_VERSION_5
+    GlobalLU_t globalLU_;
 #endif
+    std::vector<int> permC_;
+    std::vector<int> permR_;
+    std::vector<int> etree_;
+    std::vector<double> rowScale_;
+    std::vector<double> colScale_;
+    char equed_;
+};
 
 } // namespace Linear
 } // namespace Opm
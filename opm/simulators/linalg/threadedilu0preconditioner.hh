@@ -0,0 +1,288 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::ThreadedIlu0Preconditioner
+ */
+#ifndef EWOMS_THREADED_ILU0_PRECONDITIONER_HH
+#define EWOMS_THREADED_ILU0_PRECONDITIONER_HH
+
+#include <dune/istl/istlexception.hh>
+#include <dune/istl/preconditioner.hh>
+
+#include <algorithm>
+#include <exception>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief An ILU(0) preconditioner which uses multiple threads to compute the
+ *        factorization and to apply the triangular solves.
+ *
+ * The factorization is the same as the one of Dune::SeqILU, but it and the forward and
+ * backward substitutions are level scheduled: The rows are grouped into levels such
+ * that each row only depends on rows of previous levels. The rows of one level are then
+ * processed concurrently. Since the factorization of a row only depends on the rows
+ * referenced by its strictly lower part, it uses the levels of the forward
+ * substitution. For the sparsity patterns resulting from finite volume discretizations,
+ * the number of levels is much smaller than the number of rows, so this exploits the
+ * threads of the ThreadManager if OpenMP is enabled. The results are identical to the
+ * ones of the sequential ILU(0) preconditioner.
+ */
+template <class Matrix, class Vector>
+class ThreadedIlu0Preconditioner : public Dune::Preconditioner<Vector, Vector>
+{
+public:
+    using domain_type = Vector;
+    using range_type = Vector;
+    using field_type = typename Vector::field_type;
+
+    /*!
+     * \brief Factorize a matrix.
+     *
+     * \param A The matrix for which the preconditioner ought to be created
+     * \param relaxationFactor The factor by which the result of the preconditioner is
+     *                         scaled
+     */
+    ThreadedIlu0Preconditioner(const Matrix& A, field_type relaxationFactor)
+        : ilu_(A)
+        , relaxationFactor_(relaxationFactor)
+    {
+        // the levels only depend on the sparsity pattern, which is not changed by the
+        // factorization
+        computeLevels_();
+        factorize_();
+    }
+
+    //! the kind of computations supported by the preconditioner
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    void pre(Vector&, Vector&) override
+    {}
+
+    /*!
+     * \brief Solve (LU) v = d, where L and U are the factors of the incomplete
+     *        decomposition.
+     */
+    void apply(Vector& v, const Vector& d) override
+    {
+        // forward substitution: L y = d, where L has unit diagonal blocks. the result is
+        // stored in v.
+        for (size_t levelIdx = 0; levelIdx + 1 < lowerLevelOffsets_.size(); ++levelIdx) {
+            int beginIdx = static_cast<int>(lowerLevelOffsets_[levelIdx]);
+            int endIdx = static_cast<int>(lowerLevelOffsets_[levelIdx + 1]);
+#ifdef _OPENMP
+#pragma omp parallel for if(endIdx - beginIdx > minRowsPerThreadedLevel_)
+#endif
+            for (int i = beginIdx; i < endIdx; ++i) {
+                unsigned rowIdx = lowerRows_[static_cast<unsigned>(i)];
+                auto rhs = d[rowIdx];
+                const auto& row = ilu_[rowIdx];
+                auto colIt = row.begin();
+                for (; colIt.index() < rowIdx; ++colIt)
+                    colIt->mmv(v[colIt.index()], rhs);
+                v[rowIdx] = rhs;
+            }
+        }
+
+        // backward substitution: U v = y. the diagonal blocks of the factorization store
+        // their inverses
+        for (size_t levelIdx = 0; levelIdx + 1 < upperLevelOffsets_.size(); ++levelIdx) {
+            int beginIdx = static_cast<int>(upperLevelOffsets_[levelIdx]);
+            int endIdx = static_cast<int>(upperLevelOffsets_[levelIdx + 1]);
+#ifdef _OPENMP
+#pragma omp parallel for if(endIdx - beginIdx > minRowsPerThreadedLevel_)
+#endif
+            for (int i = beginIdx; i < endIdx; ++i) {
+                unsigned rowIdx = upperRows_[static_cast<unsigned>(i)];
+                auto rhs = v[rowIdx];
+                const auto& row = ilu_[rowIdx];
+                auto colIt = row.find(rowIdx);
+                const auto& diagIt = colIt;
+                const auto& colEndIt = row.end();
+                for (++colIt; colIt != colEndIt; ++colIt)
+                    colIt->mmv(v[colIt.index()], rhs);
+                diagIt->mv(rhs, v[rowIdx]);
+                v[rowIdx] *= relaxationFactor_;
+            }
+        }
+    }
+
+    void post(Vector&) override
+    {}
+
+    /*!
+     * \brief Returns the number of levels of the forward substitution.
+     */
+    size_t numLowerLevels() const
+    { return lowerLevelOffsets_.size() - 1; }
+
+    /*!
+     * \brief Returns the number of levels of the backward substitution.
+     */
+    size_t numUpperLevels() const
+    { return upperLevelOffsets_.size() - 1; }
+
+private:
+    // do not spawn threads for levels which only consist of a few rows
+    static constexpr int minRowsPerThreadedLevel_ = 64;
+
+    // the IKJ variant of the block ILU(0) decomposition of dune-istl, i.e., the
+    // diagonal blocks of the factorization store their inverses
+    void factorize_()
+    {
+        std::exception_ptr exception;
+        for (size_t levelIdx = 0; levelIdx + 1 < lowerLevelOffsets_.size(); ++levelIdx) {
+            int beginIdx = static_cast<int>(lowerLevelOffsets_[levelIdx]);
+            int endIdx = static_cast<int>(lowerLevelOffsets_[levelIdx + 1]);
+#ifdef _OPENMP
+#pragma omp parallel for if(endIdx - beginIdx > minRowsPerThreadedLevel_)
+#endif
+            for (int i = beginIdx; i < endIdx; ++i) {
+                // exceptions must not leave the threaded region, so the first one is
+                // rethrown after the level has been processed
+                try {
+                    factorizeRow_(lowerRows_[static_cast<unsigned>(i)]);
+                }
+                catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                    if (!exception)
+                        exception = std::current_exception();
+                }
+            }
+
+            if (exception)
+                std::rethrow_exception(exception);
+        }
+    }
+
+    void factorizeRow_(unsigned rowIdx)
+    {
+        auto& row = ilu_[rowIdx];
+        const auto& rowEndIt = row.end();
+        auto ijIt = row.begin();
+        for (; ijIt != rowEndIt && ijIt.index() < rowIdx; ++ijIt) {
+            // the rows referenced by the lower part belong to previous levels, i.e.,
+            // they are already factorized
+            const auto& rowJ = ilu_[ijIt.index()];
+            auto jkIt = rowJ.find(ijIt.index());
+            ijIt->rightmultiply(*jkIt);
+
+            const auto& rowJEndIt = rowJ.end();
+            auto ikIt = ijIt;
+            ++ikIt;
+            ++jkIt;
+            while (ikIt != rowEndIt && jkIt != rowJEndIt) {
+                if (ikIt.index() == jkIt.index()) {
+                    auto B = *jkIt;
+                    B.leftmultiply(*ijIt);
+                    *ikIt -= B;
+                    ++ikIt;
+                    ++jkIt;
+                }
+                else if (ikIt.index() < jkIt.index())
+                    ++ikIt;
+                else
+                    ++jkIt;
+            }
+        }
+
+        if (ijIt == rowEndIt || ijIt.index() != rowIdx)
+            DUNE_THROW(Dune::ISTLError, "Diagonal entry of row " << rowIdx << " is missing");
+
+        ijIt->invert();
+    }
+
+    void computeLevels_()
+    {
+        size_t n = ilu_.N();
+
+        // the level of a row in the forward substitution is one more than the maximum
+        // level of the rows it depends on
+        std::vector<unsigned> level(n, 0);
+        for (unsigned rowIdx = 0; rowIdx < n; ++rowIdx) {
+            const auto& row = ilu_[rowIdx];
+            auto colIt = row.begin();
+            const auto& colEndIt = row.end();
+            unsigned rowLevel = 0;
+            for (; colIt != colEndIt && colIt.index() < rowIdx; ++colIt)
+                rowLevel = std::max(rowLevel, level[colIt.index()] + 1);
+            level[rowIdx] = rowLevel;
+        }
+        sortByLevel_(level, lowerRows_, lowerLevelOffsets_);
+
+        // the same for the backward substitution, but starting at the last row
+        std::fill(level.begin(), level.end(), 0);
+        for (unsigned rowIdx = static_cast<unsigned>(n); rowIdx-- > 0; ) {
+            const auto& row = ilu_[rowIdx];
+            auto colIt = row.find(rowIdx);
+            const auto& colEndIt = row.end();
+            unsigned rowLevel = 0;
+            if (colIt == colEndIt)
+                continue; // the factorization complains about the missing diagonal
+            for (++colIt; colIt != colEndIt; ++colIt)
+                rowLevel = std::max(rowLevel, level[colIt.index()] + 1);
+            level[rowIdx] = rowLevel;
+        }
+        sortByLevel_(level, upperRows_, upperLevelOffsets_);
+    }
+
+    // sort the rows by their level using counting sort
+    static void sortByLevel_(const std::vector<unsigned>& level,
+                             std::vector<unsigned>& rows,
+                             std::vector<size_t>& levelOffsets)
+    {
+        unsigned numLevels = 0;
+        for (unsigned rowLevel : level)
+            numLevels = std::max(numLevels, rowLevel + 1);
+
+        levelOffsets.assign(numLevels + 1, 0);
+        for (unsigned rowLevel : level)
+            ++levelOffsets[rowLevel + 1];
+        for (unsigned levelIdx = 0; levelIdx < numLevels; ++levelIdx)
+            levelOffsets[levelIdx + 1] += levelOffsets[levelIdx];
+
+        rows.resize(level.size());
+        std::vector<size_t> pos(levelOffsets.begin(), levelOffsets.end() - 1);
+        for (unsigned rowIdx = 0; rowIdx < level.size(); ++rowIdx)
+            rows[pos[level[rowIdx]]++] = rowIdx;
+    }
+
+    Matrix ilu_;
+    field_type relaxationFactor_;
+
+    std::vector<unsigned> lowerRows_;
+    std::vector<size_t> lowerLevelOffsets_;
+    std::vector<unsigned> upperRows_;
+    std::vector<size_t> upperLevelOffsets_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
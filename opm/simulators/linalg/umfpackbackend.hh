@@ -0,0 +1,371 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::UmfPackBackend
+ */
+#ifndef EWOMS_UMFPACK_BACKEND_HH
+#define EWOMS_UMFPACK_BACKEND_HH
+
+#if HAVE_SUITESPARSE_UMFPACK
+
+#include <opm/simulators/linalg/istlsparsematrixadapter.hh>
+#include <opm/simulators/linalg/scalarcsrmatrix.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/simulators/linalg/linalgproperties.hh>
+
+#include <opm/material/common/Unused.hpp>
+
+#include <dune/istl/solver.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <umfpack.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Opm::Properties::TTag {
+struct UmfPackLinearSolver {};
+} // namespace Opm::Properties::TTag
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A direct solver for block matrices which uses the multifrontal method of
+ *        UMFPACK.
+ *
+ * The blocks are expanded to a scalar matrix in compressed row storage, which is
+ * passed to UMFPACK as the transposed matrix in compressed column storage. The
+ * symbolic analysis, i.e., the fill-reducing ordering and the structure of the frontal
+ * matrices, is only done if the sparsity pattern of the matrix changes. For all other
+ * matrices, only the numeric factorization is redone. The dense frontal matrices are
+ * factorized by the BLAS, so a multithreaded BLAS library makes the factorization use
+ * multiple cores.
+ *
+ * Since this is a Dune::InverseOperator, it can also be used to solve the systems of
+ * equations on the coarsest level of a multi-grid method.
+ */
+template <class Matrix, class Vector>
+class BlockUmfPack : public Dune::InverseOperator<Vector, Vector>
+{
+    using VectorBlock = typename Vector::block_type;
+    using Scalar = typename VectorBlock::field_type;
+    using Index = SuiteSparse_long;
+
+    static constexpr int blockRows = VectorBlock::dimension;
+
+public:
+    explicit BlockUmfPack(int verbosity = 0)
+        : verbosity_(verbosity)
+        , symbolic_(nullptr)
+        , numeric_(nullptr)
+    {
+        umfpack_dl_defaults(control_);
+        control_[UMFPACK_PRL] = (verbosity_ > 1) ? 2 : 0;
+    }
+
+    BlockUmfPack(const Matrix& M, int verbosity = 0)
+        : BlockUmfPack(verbosity)
+    { setMatrix(M); }
+
+    BlockUmfPack(const BlockUmfPack&) = delete;
+
+    ~BlockUmfPack()
+    { clear(); }
+
+    /*!
+     * \brief Discard the factorization and the structure of the matrix.
+     */
+    void clear()
+    {
+        if (numeric_)
+            umfpack_dl_free_numeric(&numeric_);
+        if (symbolic_)
+            umfpack_dl_free_symbolic(&symbolic_);
+        numeric_ = nullptr;
+        symbolic_ = nullptr;
+        csrMatrix_.clear();
+    }
+
+    /*!
+     * \brief Factorize a matrix.
+     *
+     * If the number of rows and of non-zero blocks is the same as for the previous
+     * matrix, its sparsity pattern is assumed to be unchanged and the symbolic
+     * analysis is reused.
+     */
+    void setMatrix(const Matrix& M)
+    {
+        if (!symbolic_ || !csrMatrix_.patternMatches(M)) {
+            clear();
+            csrMatrix_.createStructure(M);
+        }
+        csrMatrix_.assignValues(M);
+
+        if (numeric_)
+            umfpack_dl_free_numeric(&numeric_);
+
+        if (!symbolic_)
+            analyze_();
+
+        Index status = umfpack_dl_numeric(csrMatrix_.rowStart(),
+                                          csrMatrix_.colIndices(),
+                                          csrMatrix_.values(),
+                                          symbolic_,
+                                          &numeric_,
+                                          control_,
+                                          info_);
+        if (status != UMFPACK_OK) {
+            // the ordering of the previous analysis might not be suitable anymore
+            if (numeric_)
+                umfpack_dl_free_numeric(&numeric_);
+            umfpack_dl_free_symbolic(&symbolic_);
+            analyze_();
+            status = umfpack_dl_numeric(csrMatrix_.rowStart(),
+                                        csrMatrix_.colIndices(),
+                                        csrMatrix_.values(),
+                                        symbolic_,
+                                        &numeric_,
+                                        control_,
+                                        info_);
+        }
+
+        // a singular matrix is reported as a warning. its factorization can still be
+        // used, but the solution is not finite
+        if (status != UMFPACK_OK && status != UMFPACK_WARNING_singular_matrix)
+            throw std::runtime_error("UMFPACK: Numeric factorization failed with status "
+                                     +std::to_string(status));
+
+        if (verbosity_ > 0)
+            umfpack_dl_report_info(control_, info_);
+    }
+
+    /*!
+     * \brief Solve the linear system of equations for a given right hand side.
+     *
+     * \return true if the solution is finite
+     */
+    bool solve(Vector& x, const Vector& b)
+    {
+        if (!numeric_)
+            throw std::logic_error("UMFPACK: solve() called before setMatrix()");
+
+        size_t n = csrMatrix_.numRows();
+        rhs_.resize(n);
+        solution_.resize(n);
+        for (size_t blockIdx = 0; blockIdx < b.size(); ++blockIdx)
+            for (int i = 0; i < blockRows; ++i)
+                rhs_[blockIdx*blockRows + i] = static_cast<double>(b[blockIdx][i]);
+
+        // UMFPACK sees the transposed matrix, so the transposed system is solved
+        Index status = umfpack_dl_solve(UMFPACK_At,
+                                        csrMatrix_.rowStart(),
+                                        csrMatrix_.colIndices(),
+                                        csrMatrix_.values(),
+                                        solution_.data(),
+                                        rhs_.data(),
+                                        numeric_,
+                                        control_,
+                                        info_);
+        if (status != UMFPACK_OK && status != UMFPACK_WARNING_singular_matrix)
+            return false;
+
+        bool finite = true;
+        for (size_t blockIdx = 0; blockIdx < x.size(); ++blockIdx) {
+            for (int i = 0; i < blockRows; ++i) {
+                double value = solution_[blockIdx*blockRows + i];
+                finite = finite && std::isfinite(value);
+                x[blockIdx][i] = static_cast<Scalar>(value);
+            }
+        }
+
+        return finite;
+    }
+
+    //! \copydoc Dune::InverseOperator::apply(X&, Y&, InverseOperatorResult&)
+    void apply(Vector& x, Vector& b, Dune::InverseOperatorResult& res) override
+    {
+        res.clear();
+        res.iterations = 1;
+        res.converged = solve(x, b);
+        res.reduction = 0.0;
+
+        // the defect is not computed, so it is only valid to say that it is zero
+        b = 0.0;
+    }
+
+    //! \copydoc Dune::InverseOperator::apply(X&, Y&, double, InverseOperatorResult&)
+    void apply(Vector& x, Vector& b, double reduction OPM_UNUSED, Dune::InverseOperatorResult& res) override
+    { apply(x, b, res); }
+
+    //! the kind of computations supported by the solver
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+private:
+    void analyze_()
+    {
+        Index n = static_cast<Index>(csrMatrix_.numRows());
+        Index status = umfpack_dl_symbolic(n, n,
+                                           csrMatrix_.rowStart(),
+                                           csrMatrix_.colIndices(),
+                                           csrMatrix_.values(),
+                                           &symbolic_,
+                                           control_,
+                                           info_);
+        if (status != UMFPACK_OK)
+            throw std::runtime_error("UMFPACK: Symbolic analysis failed with status "
+                                     +std::to_string(status));
+    }
+
+    int verbosity_;
+    ScalarCsrMatrix<Index> csrMatrix_;
+    std::vector<double> rhs_;
+    std::vector<double> solution_;
+
+    void* symbolic_;
+    void* numeric_;
+    double control_[UMFPACK_CONTROL];
+    double info_[UMFPACK_INFO];
+};
+
+/*!
+ * \ingroup Linear
+ * \brief A linear solver backend which uses the UMFPACK direct solver.
+ *
+ * \copydetails BlockUmfPack
+ */
+template <class TypeTag>
+class UmfPackBackend
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using Vector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using Matrix = typename SparseMatrixAdapter::IstlMatrix;
+
+    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
+                  "The UMFPACK linear solver backend requires the IstlSparseMatrixAdapter");
+
+public:
+    UmfPackBackend(Simulator& simulator OPM_UNUSED)
+        : solver_(EWOMS_GET_PARAM(TypeTag, int, LinearSolverVerbosity))
+        , matrix_(nullptr)
+        , matrixChanged_(false)
+    {}
+
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverVerbosity,
+                             "The verbosity level of the linear solver");
+    }
+
+    /*!
+     * \brief Causes the solve() method to discard the structure of the linear system of
+     *        equations the next time it is called.
+     */
+    void eraseMatrix()
+    { solver_.clear(); }
+
+    /*!
+     * \brief Set the reduction of the residual which the linear solver needs to achieve.
+     *
+     * UMFPACK is a direct solver, so this is a no-op.
+     */
+    void setTolerance(Scalar tolerance OPM_UNUSED)
+    { }
+
+    /*!
+     * \brief Return the reduction of the residual which the linear solver achieves.
+     */
+    Scalar tolerance() const
+    { return 0.0; }
+
+    void prepare(const SparseMatrixAdapter& M OPM_UNUSED, const Vector& b OPM_UNUSED)
+    { }
+
+    /*!
+     * \brief Record the memory held by the linear solver with the MemoryAccounting.
+     *
+     * The memory of the factorization is managed by UMFPACK and is not accounted for.
+     */
+    void recordMemoryUsage() const
+    { }
+
+    void setResidual(const Vector& b)
+    { b_ = &b; }
+
+    void getResidual(Vector& b) const
+    { b = *b_; }
+
+    /*!
+     * \brief Sets the values of the residual's Jacobian matrix.
+     *
+     * The matrix is factorized by the next call of solve(). If this is not called
+     * between two solves, the factorization of the previous one is reused.
+     */
+    void setMatrix(const SparseMatrixAdapter& M)
+    {
+        matrix_ = &M.istlMatrix();
+        matrixChanged_ = true;
+    }
+
+    bool solve(Vector& x)
+    {
+        if (matrixChanged_) {
+            solver_.setMatrix(*matrix_);
+            matrixChanged_ = false;
+        }
+
+        return solver_.solve(x, *b_);
+    }
+
+private:
+    BlockUmfPack<Matrix, Vector> solver_;
+    const Matrix* matrix_;
+    const Vector* b_;
+    bool matrixChanged_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+namespace Opm::Properties {
+
+template<class TypeTag>
+struct LinearSolverVerbosity<TypeTag, TTag::UmfPackLinearSolver> { static constexpr int value = 0; };
+template<class TypeTag>
+struct LinearSolverBackend<TypeTag, TTag::UmfPackLinearSolver> { using type = Opm::Linear::UmfPackBackend<TypeTag>; };
+
+} // namespace Opm::Properties
+
+#endif // HAVE_SUITESPARSE_UMFPACK
+
+#endif
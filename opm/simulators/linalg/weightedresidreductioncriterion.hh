@@ -29,6 +29,7 @@
 
 #include "convergencecriterion.hh"
 
+#include <array>
 #include <iostream>
 
 namespace Opm {
@@ -192,6 +193,38 @@ public:
         updateErrors_(curSol, curResid);
     }
 
+    /*!
+     * \copydoc ConvergenceCriterion::supportsPartialUpdates()
+     */
+    bool supportsPartialUpdates() const
+    { return true; }
+
+    /*!
+     * \copydoc ConvergenceCriterion::beginUpdate()
+     */
+    void beginUpdate()
+    {
+        lastResidualError_ = residualError_;
+        residualError_ = 0.0;
+        fixPointError_ = 0.0;
+    }
+
+    /*!
+     * \copydoc ConvergenceCriterion::updatePartial()
+     */
+    void updatePartial(const Vector& curSol,
+                       const Vector& changeIndicator OPM_UNUSED,
+                       const Vector& curResid,
+                       size_t beginIdx,
+                       size_t endIdx)
+    { updateLocalErrors_(curSol, curResid, beginIdx, endIdx); }
+
+    /*!
+     * \copydoc ConvergenceCriterion::endUpdate()
+     */
+    void endUpdate()
+    { reduceErrors_(); }
+
     /*!
      * \copydoc ConvergenceCriterion::converged()
      */
@@ -256,7 +289,17 @@ private:
     {
         residualError_ = 0.0;
         fixPointError_ = 0.0;
-        for (size_t i = 0; i < curResid.size(); ++i) {
+        updateLocalErrors_(curSol, curResid, /*beginIdx=*/0, curResid.size());
+        reduceErrors_();
+    }
+
+    // update the errors of the local process for a range of blocks
+    void updateLocalErrors_(const Vector& curSol,
+                            const Vector& curResid,
+                            size_t beginIdx,
+                            size_t endIdx)
+    {
+        for (size_t i = beginIdx; i < endIdx; ++i) {
             for (unsigned j = 0; j < BlockType::dimension; ++j) {
                 residualError_ =
                     std::max<Scalar>(residualError_,
@@ -266,11 +309,18 @@ private:
                                      std::abs(curSol[i][j] - lastSolVec_[i][j])
                                      /std::max<Scalar>(1.0, curSol[i][j]));
             }
+            lastSolVec_[i] = curSol[i];
         }
-        lastSolVec_ = curSol;
+    }
+
+    // reduce both errors over all processes using a single collective operation
+    void reduceErrors_()
+    {
+        std::array<Scalar, 2> values = { residualError_, fixPointError_ };
+        comm_.max(values.data(), values.size());
 
-        residualError_ = comm_.max(residualError_);
-        fixPointError_ = comm_.max(fixPointError_);
+        residualError_ = values[0];
+        fixPointError_ = values[1];
     }
 
     const CollectiveCommunication& comm_;
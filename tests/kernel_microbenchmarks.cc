@@ -0,0 +1,288 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Measures the performance of the kernels which dominate the run time of the
+ *        simulators in isolation.
+ *
+ * For each kernel, the time per operation and the number of bytes per operation are
+ * printed. The latter is the size of the objects which are read or written by one
+ * operation, i.e., it is a lower bound of the memory traffic. The kernels of the models
+ * are measured for the initial solution of the lens problem (immiscible model) and of
+ * the reservoir problem (black-oil model).
+ *
+ * The program takes the minimum time in seconds which is spent per kernel as an
+ * optional argument.
+ */
+#include "config.h"
+
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <opm/models/blackoil/blackoilmodel.hh>
+#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
+#include <opm/models/parallel/tasklets.hh>
+#include <opm/models/utils/start.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/overlappingoperator.hh>
+
+#include "problems/reservoirproblem.hh"
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct ReservoirBlackOilEcfvProblem { using InheritsFrom = std::tuple<ReservoirBaseProblem, BlackOilModel>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct SpatialDiscretizationSplice<TypeTag, TTag::ReservoirBlackOilEcfvProblem> { using type = TTag::EcfvDiscretization; };
+
+template<class TypeTag>
+struct LocalLinearizerSplice<TypeTag, TTag::ReservoirBlackOilEcfvProblem> { using type = TTag::AutoDiffLocalLinearizer; };
+
+} // namespace Opm::Properties
+
+namespace {
+
+double minSeconds = 0.5;
+
+// call a kernel until the minimum time has been spent and print the time and the
+// number of bytes per operation. one call of the kernel performs numOps operations.
+template <class Kernel>
+void measure(const std::string& name, size_t numOps, double bytesPerOp, Kernel kernel)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // warm up the caches and let the kernel allocate its memory
+    kernel();
+
+    size_t numCalls = 0;
+    double elapsed = 0.0;
+    const auto startTime = Clock::now();
+    do {
+        kernel();
+        ++numCalls;
+        elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+    } while (elapsed < minSeconds);
+
+    double nsPerOp = elapsed*1e9/static_cast<double>(numCalls*std::max<size_t>(numOps, 1));
+    std::cout << std::left << std::setw(48) << name << std::right
+              << std::fixed << std::setprecision(1)
+              << std::setw(14) << nsPerOp << " ns/op"
+              << std::setw(12) << std::setprecision(0) << bytesPerOp << " bytes/op"
+              << std::setw(10) << std::setprecision(2) << bytesPerOp/nsPerOp << " GB/s\n"
+              << std::defaultfloat << std::flush;
+}
+
+template <unsigned n>
+void measureBlockInversion()
+{
+    using Block = Opm::MatrixBlock<double, n, n>;
+
+    // diagonally dominant blocks, so inverting them repeatedly is well conditioned
+    std::vector<Block> blocks(1024);
+    for (unsigned blockIdx = 0; blockIdx < blocks.size(); ++blockIdx) {
+        for (unsigned i = 0; i < n; ++i)
+            for (unsigned j = 0; j < n; ++j)
+                blocks[blockIdx][i][j] = (i == j) ? 10.0 + blockIdx%7 : 1.0/(1.0 + i + 2*j);
+    }
+
+    measure("MatrixBlock<double, " + std::to_string(n) + ", " + std::to_string(n) + ">::invert",
+            blocks.size(), 2.0*sizeof(Block),
+            [&blocks]()
+            {
+                for (auto& block : blocks)
+                    block.invert();
+            });
+}
+
+void measureTaskletDispatch(unsigned numWorkers)
+{
+    Opm::TaskletRunner runner(numWorkers);
+    const unsigned numTasklets = 1000;
+    auto noop = []() {};
+    measure("TaskletRunner::dispatch (" + std::to_string(numWorkers) + " workers)",
+            numTasklets, sizeof(Opm::FunctionRunnerTasklet<decltype(noop)>),
+            [&runner, &noop, numTasklets]()
+            {
+                for (unsigned i = 0; i < numTasklets; ++i)
+                    runner.dispatchFunction(noop);
+                runner.barrier();
+            });
+}
+
+// the kernels of a model. the simulator is set up for the initial solution of the
+// problem without running it.
+template <class TypeTag>
+int measureModel(const std::string& modelName, const char* programName)
+{
+    using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+    using ThreadManager = Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>;
+    using ElementContext = Opm::GetPropType<TypeTag, Opm::Properties::ElementContext>;
+    using IntensiveQuantities = Opm::GetPropType<TypeTag, Opm::Properties::IntensiveQuantities>;
+    using ExtensiveQuantities = Opm::GetPropType<TypeTag, Opm::Properties::ExtensiveQuantities>;
+    using PrimaryVariables = Opm::GetPropType<TypeTag, Opm::Properties::PrimaryVariables>;
+    using SparseMatrixAdapter = Opm::GetPropType<TypeTag, Opm::Properties::SparseMatrixAdapter>;
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using BorderListCreator = Opm::GetPropType<TypeTag, Opm::Properties::BorderListCreator>;
+    using OverlappingMatrix = Opm::GetPropType<TypeTag, Opm::Properties::OverlappingMatrix>;
+    using OverlappingVector = Opm::GetPropType<TypeTag, Opm::Properties::OverlappingVector>;
+    using Operator = Opm::Linear::OverlappingOperator<OverlappingMatrix,
+                                                      OverlappingVector,
+                                                      OverlappingVector>;
+    using GridView = Opm::GetPropType<TypeTag, Opm::Properties::GridView>;
+    using Element = typename GridView::template Codim<0>::Entity;
+
+    const char* argv[] = { programName,
+                           "--end-time=1e100",
+                           "--initial-time-step-size=100",
+                           "--enable-vtk-output=false",
+                           nullptr };
+    EWOMS_RESET_PARAMS_(TypeTag);
+    if (Opm::setupParameters_<TypeTag>(/*argc=*/4, argv, /*registerParams=*/true,
+                                       /*allowUnused=*/true, /*handleHelp=*/false) != 0)
+        return 1;
+    ThreadManager::init();
+
+    Simulator simulator(/*verbose=*/false);
+    auto& model = simulator.model();
+    model.applyInitialSolution();
+    model.linearizer().linearizeDomain();
+
+    // a sample of the elements of the grid, each with its own element context
+    std::vector<Element> allElements;
+    for (const auto& elem : elements(simulator.gridView()))
+        allElements.push_back(elem);
+    const size_t maxSamples = 512;
+    const size_t stride = std::max<size_t>(allElements.size()/maxSamples, 1);
+    std::vector<Element> sample;
+    std::vector<std::unique_ptr<ElementContext> > contexts;
+    for (size_t elemIdx = 0; elemIdx < allElements.size(); elemIdx += stride) {
+        sample.push_back(allElements[elemIdx]);
+        contexts.emplace_back(new ElementContext(simulator));
+        contexts.back()->updateStencil(allElements[elemIdx]);
+        contexts.back()->updateAllIntensiveQuantities();
+    }
+
+    std::cout << modelName << ": " << allElements.size() << " elements, "
+              << sample.size() << " sampled\n";
+
+    measure(modelName + " IntensiveQuantities::update",
+            contexts.size(), sizeof(IntensiveQuantities) + sizeof(PrimaryVariables),
+            [&contexts]()
+            {
+                for (auto& ctx : contexts)
+                    ctx->updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+            });
+
+    size_t numFaces = 0;
+    for (auto& ctx : contexts)
+        numFaces += ctx->numInteriorFaces(/*timeIdx=*/0);
+    measure(modelName + " ExtensiveQuantities::update (flux)",
+            numFaces, sizeof(ExtensiveQuantities) + 2*sizeof(IntensiveQuantities),
+            [&contexts]()
+            {
+                for (auto& ctx : contexts)
+                    ctx->updateAllExtensiveQuantities();
+            });
+
+    auto& localLinearizer = model.localLinearizer(/*threadId=*/0);
+    measure(modelName + " LocalLinearizer::linearize",
+            contexts.size(), sizeof(ElementContext),
+            [&contexts, &sample, &localLinearizer]()
+            {
+                for (size_t i = 0; i < contexts.size(); ++i)
+                    localLinearizer.linearize(*contexts[i], sample[i]);
+            });
+
+    // scatter the (zero) blocks into all non-zero entries of the global Jacobian
+    auto& jacobian = model.linearizer().jacobian();
+    const auto& istlMatrix = jacobian.istlMatrix();
+    MatrixBlock zeroBlock(0.0);
+    measure(modelName + " SparseMatrixAdapter::addToBlock",
+            istlMatrix.nonzeroes(), 2.0*sizeof(MatrixBlock),
+            [&jacobian, &istlMatrix, &zeroBlock]()
+            {
+                for (auto rowIt = istlMatrix.begin(); rowIt != istlMatrix.end(); ++rowIt)
+                    for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt)
+                        jacobian.addToBlock(rowIt.index(), colIt.index(), zeroBlock);
+            });
+
+    BorderListCreator borderListCreator(simulator.gridView(), model.dofMapper());
+    OverlappingMatrix overlappingMatrix(istlMatrix,
+                                        borderListCreator.borderList(),
+                                        borderListCreator.blackList(),
+                                        /*overlapSize=*/1);
+    overlappingMatrix.assignCopy(istlMatrix);
+    OverlappingVector x(overlappingMatrix.overlap());
+    OverlappingVector y(x);
+    x = 1.0;
+    Operator op(overlappingMatrix);
+    const size_t numRows = overlappingMatrix.N();
+    const double bytesPerRow =
+        (static_cast<double>(overlappingMatrix.nonzeroes())
+         *(sizeof(typename OverlappingMatrix::block_type) + sizeof(size_t))
+         + 2.0*numRows*sizeof(typename OverlappingVector::block_type))
+        /static_cast<double>(numRows);
+    measure(modelName + " OverlappingOperator::apply (per row)",
+            numRows, bytesPerRow,
+            [&op, &x, &y]()
+            { op.apply(x, y); });
+
+    return 0;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    if (argc > 1)
+        minSeconds = std::atof(argv[1]);
+
+    measureBlockInversion<2>();
+    measureBlockInversion<3>();
+    measureBlockInversion<4>();
+
+    measureTaskletDispatch(/*numWorkers=*/0);
+    measureTaskletDispatch(/*numWorkers=*/1);
+
+    if (measureModel<Opm::Properties::TTag::LensProblemEcfvAd>("immiscible", argv[0]) != 0)
+        return 1;
+    if (measureModel<Opm::Properties::TTag::ReservoirBlackOilEcfvProblem>("blackoil", argv[0]) != 0)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the Richards model using the ECFV discretization and the two-point
+ *        flux approximation.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
+
+#include "problems/richardslensproblem.hh"
+
+namespace Opm::Properties {
+
+// Create new type tags
+namespace TTag {
+struct RichardsLensEcfvTpfaProblem { using InheritsFrom = std::tuple<RichardsLensProblem>; };
+} // end namespace TTag
+template<class TypeTag>
+struct SpatialDiscretizationSplice<TypeTag, TTag::RichardsLensEcfvTpfaProblem> { using type = TTag::EcfvDiscretization; };
+
+//! Use automatic differentiation to linearize the system of PDEs
+template<class TypeTag>
+struct LocalLinearizerSplice<TypeTag, TTag::RichardsLensEcfvTpfaProblem> { using type = TTag::AutoDiffLocalLinearizer; };
+
+//! The permeabilities of the lens problem are isotropic, so the fluxes can be
+//! calculated using transmissibilities
+template<class TypeTag>
+struct UseTwoPointFluxApproximation<TypeTag, TTag::RichardsLensEcfvTpfaProblem> { static constexpr bool value = true; };
+
+} // namespace Opm::Properties
+
+int main(int argc, char **argv)
+{
+    using ProblemTypeTag = Opm::Properties::TTag::RichardsLensEcfvTpfaProblem;
+    return Opm::start<ProblemTypeTag>(argc, argv);
+}
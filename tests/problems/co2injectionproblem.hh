@@ -369,6 +369,17 @@ public:
         solidEnergyLawParams_.setSolidHeatCapacity(790.0 // specific heat capacity of granite [J / (kg K)]
                                                    * 2700.0); // density of granite [kg/m^3]
         solidEnergyLawParams_.finalize();
+
+        updateFineDofs_();
+    }
+
+    /*!
+     * \copydoc FvBaseProblem::gridChanged
+     */
+    void gridChanged()
+    {
+        ParentType::gridChanged();
+        updateFineDofs_();
     }
 
     /*!
@@ -467,8 +478,7 @@ public:
     const DimMatrix& intrinsicPermeability(const Context& context, unsigned spaceIdx,
                                            unsigned timeIdx) const
     {
-        const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
-        if (isFineMaterial_(pos))
+        if (fineDofs_.get(context, spaceIdx, timeIdx))
             return fineK_;
         return coarseK_;
     }
@@ -479,8 +489,7 @@ public:
     template <class Context>
     Scalar porosity(const Context& context, unsigned spaceIdx, unsigned timeIdx) const
     {
-        const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
-        if (isFineMaterial_(pos))
+        if (fineDofs_.get(context, spaceIdx, timeIdx))
             return finePorosity_;
         return coarsePorosity_;
     }
@@ -492,8 +501,7 @@ public:
     const MaterialLawParams& materialLawParams(const Context& context,
                                                unsigned spaceIdx, unsigned timeIdx) const
     {
-        const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
-        if (isFineMaterial_(pos))
+        if (fineDofs_.get(context, spaceIdx, timeIdx))
             return fineMaterialParams_;
         return coarseMaterialParams_;
     }
@@ -519,8 +527,7 @@ public:
                             unsigned spaceIdx,
                             unsigned timeIdx) const
     {
-        const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
-        if (isFineMaterial_(pos))
+        if (fineDofs_.get(context, spaceIdx, timeIdx))
             return fineThermalCondParams_;
         return coarseThermalCondParams_;
     }
@@ -573,6 +580,23 @@ public:
             values.setNoFlow();
     }
 
+    /*!
+     * \copydoc FvBaseProblem::boundaryDependsOnSolution
+     *
+     * The free flow boundary depends on the solution, and so does the enthalpy of the
+     * injected CO2 if the energy equation is considered.
+     */
+    template <class Context>
+    bool boundaryDependsOnSolution(const Context& context, unsigned spaceIdx, unsigned timeIdx) const
+    {
+        const auto& pos = context.pos(spaceIdx, timeIdx);
+        if (onLeftBoundary_(pos))
+            return true;
+        else if (onInlet_(pos))
+            return getPropValue<TypeTag, Properties::EnableEnergy>();
+        return false;
+    }
+
     // \}
 
     /*!
@@ -609,6 +633,15 @@ public:
                 unsigned timeIdx OPM_UNUSED) const
     { rate = Scalar(0.0); }
 
+    /*!
+     * \copydoc FvBaseProblem::sourceDependsOnSolution
+     */
+    template <class Context>
+    bool sourceDependsOnSolution(const Context& context OPM_UNUSED,
+                                 unsigned spaceIdx OPM_UNUSED,
+                                 unsigned timeIdx OPM_UNUSED) const
+    { return false; }
+
     //! \}
 
 private:
@@ -689,9 +722,19 @@ private:
     bool isFineMaterial_(const GlobalPosition& pos) const
     { return pos[dim - 1] > fineLayerBottom_; }
 
+    // the spatial parameters only depend on the layer in which a degree of freedom is
+    // located, so this is determined once for all of them
+    void updateFineDofs_()
+    {
+        fineDofs_.update(this->simulator(), [this](const auto& elemCtx, unsigned dofIdx) {
+            return static_cast<unsigned char>(isFineMaterial_(elemCtx.pos(dofIdx, /*timeIdx=*/0)));
+        });
+    }
+
     DimMatrix fineK_;
     DimMatrix coarseK_;
     Scalar fineLayerBottom_;
+    FvBaseDofParameterArray<TypeTag, unsigned char> fineDofs_;
 
     Scalar finePorosity_;
     Scalar coarsePorosity_;
@@ -354,6 +354,17 @@ public:
             this->gravity_ = 0;
             this->gravity_[1] = -9.81;
         }
+
+        updateLensDofs_();
+    }
+
+    /*!
+     * \copydoc FvBaseProblem::gridChanged
+     */
+    void gridChanged()
+    {
+        ParentType::gridChanged();
+        updateLensDofs_();
     }
 
     /*!
@@ -427,9 +438,7 @@ public:
     const DimMatrix& intrinsicPermeability(const Context& context, unsigned spaceIdx,
                                            unsigned timeIdx) const
     {
-        const GlobalPosition& globalPos = context.pos(spaceIdx, timeIdx);
-
-        if (isInLens_(globalPos))
+        if (lensDofs_.get(context, spaceIdx, timeIdx))
             return lensK_;
         return outerK_;
     }
@@ -450,9 +459,7 @@ public:
     const MaterialLawParams& materialLawParams(const Context& context,
                                                unsigned spaceIdx, unsigned timeIdx) const
     {
-        const GlobalPosition& globalPos = context.pos(spaceIdx, timeIdx);
-
-        if (isInLens_(globalPos))
+        if (lensDofs_.get(context, spaceIdx, timeIdx))
             return lensMaterialParams_;
         return outerMaterialParams_;
     }
@@ -662,6 +669,15 @@ public:
     //! \}
 
 private:
+    // the spatial parameters only depend on whether a degree of freedom is located
+    // within the lens, so this is determined once for all of them
+    void updateLensDofs_()
+    {
+        lensDofs_.update(this->simulator(), [this](const auto& elemCtx, unsigned dofIdx) {
+            return static_cast<unsigned char>(isInLens_(elemCtx.pos(dofIdx, /*timeIdx=*/0)));
+        });
+    }
+
     bool isInLens_(const GlobalPosition& pos) const
     {
         for (unsigned i = 0; i < dim; ++i) {
@@ -693,6 +709,7 @@ private:
 
     GlobalPosition lensLowerLeft_;
     GlobalPosition lensUpperRight_;
+    FvBaseDofParameterArray<TypeTag, unsigned char> lensDofs_;
 
     DimMatrix lensK_;
     DimMatrix outerK_;
@@ -229,7 +229,6 @@ class ReservoirProblem : public GetPropType<TypeTag, Properties::BaseProblem>
     enum { waterCompIdx = FluidSystem::waterCompIdx };
 
     using Model = GetPropType<TypeTag, Properties::Model>;
-    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
     using RateVector = GetPropType<TypeTag, Properties::RateVector>;
@@ -396,23 +395,7 @@ public:
         fineMaterialParams_.finalize();
         coarseMaterialParams_.finalize();
 
-        materialParams_.resize(this->model().numGridDof());
-        ElementContext elemCtx(this->simulator());
-        auto eIt = this->simulator().gridView().template begin<0>();
-        const auto& eEndIt = this->simulator().gridView().template end<0>();
-        for (; eIt != eEndIt; ++eIt) {
-            elemCtx.updateStencil(*eIt);
-            size_t nDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
-            for (unsigned dofIdx = 0; dofIdx < nDof; ++ dofIdx) {
-                unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-                const GlobalPosition& pos = elemCtx.pos(dofIdx, /*timeIdx=*/0);
-
-                if (isFineMaterial_(pos))
-                    materialParams_[globalDofIdx] = &fineMaterialParams_;
-                else
-                    materialParams_[globalDofIdx] = &coarseMaterialParams_;
-            }
-        }
+        updateFineDofs_();
 
         initFluidState_();
 
@@ -420,6 +403,15 @@ public:
         this->simulator().startNextEpisode(100.0*24*60*60);
     }
 
+    /*!
+     * \copydoc FvBaseProblem::gridChanged
+     */
+    void gridChanged()
+    {
+        ParentType::gridChanged();
+        updateFineDofs_();
+    }
+
     /*!
      * \copydoc FvBaseMultiPhaseProblem::registerParameters
      */
@@ -485,8 +477,7 @@ public:
     const DimMatrix& intrinsicPermeability(const Context& context, unsigned spaceIdx,
                                            unsigned timeIdx) const
     {
-        const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
-        if (isFineMaterial_(pos))
+        if (fineDofs_.get(context, spaceIdx, timeIdx))
             return fineK_;
         return coarseK_;
     }
@@ -497,8 +488,7 @@ public:
     template <class Context>
     Scalar porosity(const Context& context, unsigned spaceIdx, unsigned timeIdx) const
     {
-        const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
-        if (isFineMaterial_(pos))
+        if (fineDofs_.get(context, spaceIdx, timeIdx))
             return finePorosity_;
         return coarsePorosity_;
     }
@@ -511,11 +501,15 @@ public:
                                                unsigned spaceIdx, unsigned timeIdx) const
     {
         unsigned globalIdx = context.globalSpaceIndex(spaceIdx, timeIdx);
-        return *materialParams_[globalIdx];
+        return materialLawParams(globalIdx);
     }
 
     const MaterialLawParams& materialLawParams(unsigned globalIdx) const
-    { return *materialParams_[globalIdx]; }
+    {
+        if (fineDofs_[globalIdx])
+            return fineMaterialParams_;
+        return coarseMaterialParams_;
+    }
 
     /*!
      * \name Problem parameters
@@ -560,6 +554,15 @@ public:
         values.setNoFlow();
     }
 
+    /*!
+     * \copydoc FvBaseProblem::boundaryDependsOnSolution
+     */
+    template <class Context>
+    bool boundaryDependsOnSolution(const Context& context OPM_UNUSED,
+                                   unsigned spaceIdx OPM_UNUSED,
+                                   unsigned timeIdx OPM_UNUSED) const
+    { return false; }
+
     //! \}
 
     /*!
@@ -627,6 +630,15 @@ public:
                 unsigned timeIdx OPM_UNUSED) const
     { rate = Scalar(0.0); }
 
+    /*!
+     * \copydoc FvBaseProblem::sourceDependsOnSolution
+     */
+    template <class Context>
+    bool sourceDependsOnSolution(const Context& context OPM_UNUSED,
+                                 unsigned spaceIdx OPM_UNUSED,
+                                 unsigned timeIdx OPM_UNUSED) const
+    { return false; }
+
     //! \}
 
 private:
@@ -771,6 +783,15 @@ private:
     bool isFineMaterial_(const GlobalPosition& pos) const
     { return pos[dim - 1] > layerBottom_; }
 
+    // the spatial parameters only depend on the layer in which a degree of freedom is
+    // located, so this is determined once for all of them
+    void updateFineDofs_()
+    {
+        fineDofs_.update(this->simulator(), [this](const auto& elemCtx, unsigned dofIdx) {
+            return static_cast<unsigned char>(isFineMaterial_(elemCtx.pos(dofIdx, /*timeIdx=*/0)));
+        });
+    }
+
     DimMatrix fineK_;
     DimMatrix coarseK_;
     Scalar layerBottom_;
@@ -781,7 +802,7 @@ private:
 
     MaterialLawParams fineMaterialParams_;
     MaterialLawParams coarseMaterialParams_;
-    std::vector<const MaterialLawParams*> materialParams_;
+    FvBaseDofParameterArray<TypeTag, unsigned char> fineDofs_;
 
     InitialFluidState initialFluidState_;
     InitialFluidState injectorFluidState_;
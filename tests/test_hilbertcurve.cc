@@ -0,0 +1,84 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+/*!
+ * \file
+ *
+ * \brief This test checks that the Hilbert index visits each point of a lattice
+ *        exactly once and that consecutive points of the curve are neighbors.
+ */
+#include "config.h"
+
+#include <opm/models/utils/hilbertcurve.hh>
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+template <unsigned dim>
+void testHilbertCurve(unsigned numBits)
+{
+    std::uint32_t n = std::uint32_t(1) << numBits;
+    std::uint64_t numPoints = 1;
+    for (unsigned i = 0; i < dim; ++i)
+        numPoints *= n;
+
+    // the point of the lattice for each position on the curve
+    std::vector<std::array<std::uint32_t, dim> > curve(numPoints);
+    std::vector<bool> visited(numPoints, false);
+    for (std::uint64_t pointIdx = 0; pointIdx < numPoints; ++pointIdx) {
+        std::array<std::uint32_t, dim> coords;
+        std::uint64_t tmp = pointIdx;
+        for (unsigned i = 0; i < dim; ++i) {
+            coords[i] = static_cast<std::uint32_t>(tmp % n);
+            tmp /= n;
+        }
+
+        std::uint64_t curveIdx = Opm::hilbertIndex<dim>(coords, numBits);
+        assert(curveIdx < numPoints);
+        assert(!visited[curveIdx]);
+        visited[curveIdx] = true;
+        curve[curveIdx] = coords;
+    }
+
+    for (std::uint64_t curveIdx = 1; curveIdx < numPoints; ++curveIdx) {
+        long dist = 0;
+        for (unsigned i = 0; i < dim; ++i)
+            dist += std::labs(static_cast<long>(curve[curveIdx][i])
+                              - static_cast<long>(curve[curveIdx - 1][i]));
+        assert(dist == 1);
+    }
+}
+
+int main()
+{
+    testHilbertCurve<2>(/*numBits=*/1);
+    testHilbertCurve<2>(/*numBits=*/5);
+    testHilbertCurve<3>(/*numBits=*/1);
+    testHilbertCurve<3>(/*numBits=*/4);
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief This is a simple test for the instrumentation of code regions.
+ */
+#include "config.h"
+
+#include <opm/models/utils/instrumentation.hh>
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+void runRegions(unsigned regionIdx, int numCalls);
+void runRegions(unsigned regionIdx, int numCalls)
+{
+    for (int i = 0; i < numCalls; ++i) {
+        Opm::Instrumentation::Region outerRegion(regionIdx);
+        Opm::Instrumentation::Region innerRegion(Opm::Instrumentation::fluxRegion);
+    }
+}
+
+int main()
+{
+    using Opm::Instrumentation;
+
+    // the built-in regions always exist
+    assert(Instrumentation::numRegions() == Instrumentation::numBuiltinRegions);
+    assert(Instrumentation::regionIndex("flux computation") == Instrumentation::fluxRegion);
+
+    unsigned myRegionIdx = Instrumentation::regionIndex("my region");
+    assert(myRegionIdx == Instrumentation::numBuiltinRegions);
+    assert(Instrumentation::regionIndex("my region") == myRegionIdx);
+
+    // nothing is recorded as long as the instrumentation is disabled
+    runRegions(myRegionIdx, 10);
+    for (const auto& result : Instrumentation::collect())
+        assert(result.count == 0);
+
+    Instrumentation::setEnabled(true);
+
+    int numThreads = 4;
+    int numCalls = 100;
+    std::vector<std::thread> threads;
+    for (int threadIdx = 0; threadIdx < numThreads; ++threadIdx)
+        threads.emplace_back(runRegions, myRegionIdx, numCalls);
+    for (auto& thread : threads)
+        thread.join();
+
+    const auto& results = Instrumentation::collect();
+    assert(results.size() == Instrumentation::numBuiltinRegions + 1);
+
+    const auto& myResult = results[myRegionIdx];
+    assert(myResult.name == "my region");
+    assert(myResult.count == static_cast<std::uint64_t>(numThreads*numCalls));
+    assert(myResult.threadCount.size() == myResult.threadTime.size());
+    for (auto count : myResult.threadCount)
+        assert(count == 0 || count == static_cast<std::uint64_t>(numCalls));
+
+    // nested regions are included in the time of the enclosing region
+    const auto& fluxResult = results[Instrumentation::fluxRegion];
+    assert(fluxResult.count == myResult.count);
+    assert(fluxResult.time <= myResult.time);
+
+    // counters accumulate events without any time
+    unsigned counterIdx = Instrumentation::regionIndex("my counter");
+    Instrumentation::addCount(counterIdx, 3);
+    Instrumentation::addCount(counterIdx, 4);
+    const auto& counterResult = Instrumentation::collect()[counterIdx];
+    assert(counterResult.count == 7);
+    assert(counterResult.time == 0.0);
+
+    std::ostringstream json;
+    Instrumentation::writeJson(json);
+    assert(json.str().find("\"name\": \"my region\"") != std::string::npos);
+
+    std::ostringstream csv;
+    Instrumentation::writeCsv(csv);
+    assert(csv.str().find("region,thread,time,count") == 0);
+    assert(csv.str().find("\"my region\",,") != std::string::npos);
+
+    Instrumentation::printSummary(std::cout);
+
+    Instrumentation::reset();
+    for (const auto& result : Instrumentation::collect())
+        assert(result.count == 0);
+
+    return 0;
+}
@@ -25,12 +25,19 @@
  *
  * \brief This file serves as an example of how to use the tasklet mechanism for
  *        asynchronous work.
+ *
+ * If it is called with the '--benchmark' argument, the latency and the throughput of
+ * dispatching tasklets to a given number of worker threads (default: 4) is measured
+ * instead.
  */
 #include "config.h"
 
 #include <opm/models/parallel/tasklets.hh>
 
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 std::mutex outputMutex;
@@ -74,8 +81,106 @@ void sleepAndPrintFunction()
 
 int SleepTasklet::numInstantiated_ = 0;
 
-int main()
+std::atomic<int> numCompleted(0);
+
+// a tasklet which checks that the tasklets on which it depends have been completed
+class DependentTasklet : public Opm::TaskletInterface
+{
+public:
+    DependentTasklet(int mseconds, int expectedNumCompleted)
+        : mseconds_(mseconds)
+        , expectedNumCompleted_(expectedNumCompleted)
+    {}
+
+    void run()
+    {
+        assert(numCompleted >= expectedNumCompleted_);
+        std::this_thread::sleep_for(std::chrono::milliseconds(mseconds_));
+        ++ numCompleted;
+    }
+
+private:
+    int mseconds_;
+    int expectedNumCompleted_;
+};
+
+// a tasklet which does not do anything but counting its invocations
+class CountingTasklet : public Opm::TaskletInterface
+{
+public:
+    CountingTasklet(std::atomic<int>& counter, int numInvocations = 1)
+        : Opm::TaskletInterface(numInvocations)
+        , counter_(counter)
+    {}
+
+    void run()
+    { ++ counter_; }
+
+private:
+    std::atomic<int>& counter_;
+};
+
+// a tasklet which records the time at which it was started
+class TimestampTasklet : public Opm::TaskletInterface
 {
+public:
+    void run()
+    { startTime = std::chrono::steady_clock::now(); }
+
+    std::chrono::steady_clock::time_point startTime;
+};
+
+int benchmark(unsigned numWorkers);
+int benchmark(unsigned numWorkers)
+{
+    using Clock = std::chrono::steady_clock;
+    Opm::TaskletRunner benchRunner(numWorkers);
+
+    // latency: the time between dispatching a tasklet and a worker starting it. the
+    // workers are given some time to go idle before each tasklet.
+    const int numLatencySamples = 1000;
+    double totalLatency = 0.0;
+    double maxLatency = 0.0;
+    for (int i = 0; i < numLatencySamples; ++i) {
+        if (i % 10 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        auto tasklet = std::make_shared<TimestampTasklet>();
+        auto dispatchTime = Clock::now();
+        benchRunner.dispatch(tasklet);
+        tasklet->waitUntilFinished();
+
+        double latency = std::chrono::duration<double, std::micro>(tasklet->startTime - dispatchTime).count();
+        totalLatency += latency;
+        maxLatency = std::max(maxLatency, latency);
+    }
+
+    // throughput: the number of tiny tasklets per second which can be dispatched and run
+    const int numTasklets = 1000000;
+    std::atomic<int> counter(0);
+    auto startTime = Clock::now();
+    for (int i = 0; i < numTasklets; ++i)
+        benchRunner.dispatch(std::make_shared<CountingTasklet>(counter));
+    benchRunner.barrier();
+    double duration = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    if (counter != numTasklets) {
+        std::cerr << "Only " << counter << " of " << numTasklets << " tasklets were run\n";
+        return 1;
+    }
+
+    std::cout << "Worker threads: " << numWorkers << "\n"
+              << "Dispatch latency: " << totalLatency/numLatencySamples << " us on average, "
+              << maxLatency << " us at most\n"
+              << "Throughput: " << numTasklets/duration << " tasklets per second\n";
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::strcmp(argv[1], "--benchmark") == 0)
+        return benchmark(argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 4);
+
     int numWorkers = 2;
     runner = new Opm::TaskletRunner(numWorkers);
 
@@ -95,6 +200,31 @@ int main()
 
     runner->dispatchFunction(sleepAndPrintFunction);
     runner->dispatchFunction(sleepAndPrintFunction, /*numInvokations=*/6);
+    runner->barrier();
+
+    // a chain of tasklets which must be run in order although there are two workers
+    auto first = std::make_shared<DependentTasklet>(200, /*expectedNumCompleted=*/0);
+    auto second = std::make_shared<DependentTasklet>(0, /*expectedNumCompleted=*/1);
+    auto third = std::make_shared<DependentTasklet>(0, /*expectedNumCompleted=*/2);
+    second->addDependency(first);
+    third->addDependency(second);
+    runner->dispatch(first);
+    runner->dispatch(second);
+    runner->dispatch(third);
+    third->waitUntilFinished();
+    assert(first->isFinished() && second->isFinished());
+    assert(numCompleted == 3);
+    std::cout << "dependent tasklets completed in order" << std::endl;
+
+    // many small tasklets, some of which are invoked multiple times
+    std::atomic<int> counter(0);
+    int numInvocations = 0;
+    for (int i = 0; i < 10000; ++ i) {
+        runner->dispatch(std::make_shared<CountingTasklet>(counter, /*numInvocations=*/1 + i%3));
+        numInvocations += 1 + i%3;
+    }
+    runner->barrier();
+    assert(counter == numInvocations);
 
     delete runner;
 
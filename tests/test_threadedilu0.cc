@@ -0,0 +1,133 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the level scheduled ILU(0) preconditioner yields the same results
+ *        as the sequential one of dune-istl.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/threadedilu0preconditioner.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/version.hh>
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+using Block = Dune::FieldMatrix<double, 2, 2>;
+using Matrix = Dune::BCRSMatrix<Block>;
+using Vector = Dune::BlockVector<Dune::FieldVector<double, 2> >;
+
+// assemble a non-symmetric two-dimensional five point stencil
+Matrix createMatrix(unsigned nx, unsigned ny)
+{
+    unsigned n = nx*ny;
+    Matrix A(n, n, 5*n, Matrix::row_wise);
+    for (auto rowIt = A.createbegin(); rowIt != A.createend(); ++rowIt) {
+        unsigned i = static_cast<unsigned>(rowIt.index()) % nx;
+        unsigned j = static_cast<unsigned>(rowIt.index()) / nx;
+        if (j > 0)
+            rowIt.insert(rowIt.index() - nx);
+        if (i > 0)
+            rowIt.insert(rowIt.index() - 1);
+        rowIt.insert(rowIt.index());
+        if (i + 1 < nx)
+            rowIt.insert(rowIt.index() + 1);
+        if (j + 1 < ny)
+            rowIt.insert(rowIt.index() + nx);
+    }
+
+    for (unsigned rowIdx = 0; rowIdx < n; ++rowIdx) {
+        auto& row = A[rowIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+            Block& b = *colIt;
+            if (colIt.index() == rowIdx) {
+                b[0][0] = 4.5;
+                b[0][1] = 0.5;
+                b[1][0] = -0.3;
+                b[1][1] = 4.0;
+            }
+            else {
+                double c = (colIt.index() < rowIdx) ? -1.2 : -0.8;
+                b[0][0] = c;
+                b[0][1] = 0.1;
+                b[1][0] = 0.0;
+                b[1][1] = c;
+            }
+        }
+    }
+
+    return A;
+}
+
+int main()
+{
+    const unsigned nx = 37;
+    const unsigned ny = 23;
+    const double relaxationFactor = 0.9;
+
+    Matrix A = createMatrix(nx, ny);
+
+    Vector d(A.N());
+    for (unsigned i = 0; i < d.size(); ++i) {
+        d[i][0] = std::sin(0.1*i);
+        d[i][1] = std::cos(0.3*i);
+    }
+
+#if DUNE_VERSION_NEWER(DUNE_ISTL, 2,7)
+    Dune::SeqILU<Matrix, Vector, Vector> refIlu(A, relaxationFactor);
+#else
+    Dune::SeqILU0<Matrix, Vector, Vector> refIlu(A, relaxationFactor);
+#endif
+    Opm::Linear::ThreadedIlu0Preconditioner<Matrix, Vector> threadedIlu(A, relaxationFactor);
+
+    // for the five point stencil, the levels are the anti-diagonals of the grid
+    assert(threadedIlu.numLowerLevels() == nx + ny - 1);
+    assert(threadedIlu.numUpperLevels() == nx + ny - 1);
+
+    Vector refV(A.N());
+    Vector v(A.N());
+    refV = 0.0;
+    v = 0.0;
+    refIlu.apply(refV, d);
+    threadedIlu.apply(v, d);
+
+    for (unsigned i = 0; i < v.size(); ++i) {
+        for (unsigned k = 0; k < 2; ++k) {
+            if (std::abs(v[i][k] - refV[i][k]) > 1e-12*std::max(1.0, std::abs(refV[i][k]))) {
+                std::cout << "Result of the threaded ILU(0) differs in row " << i
+                          << ": " << v[i][k] << " != " << refV[i][k] << "\n";
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}